@@ -0,0 +1,192 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+// ------------------------------------------------------------
+// Per-frame memoization of aim traces.
+//
+// The aiming features (non-VR aim solution, aim laser / convergence point, visible aim line, friendly
+// fire guard, teammate HUD target, effective-range spread cone) each trace their own rays, and on a
+// typical frame several of them trace the same controller ray with the same filter. Query() returns a
+// result already traced this frame when a request matches one within tolerance, and only calls the
+// tracer otherwise.
+//
+// A cached ray answers a request when mask / filter / hull match exactly, the cached ray decides the
+// request's length (it is at least as long, or it hit something before its end, so a longer request
+// hits the same thing), and the two rays stay within maxDeviation of each other over the distance the
+// cached trace decides: |origin delta| + distance * sin(angle). The angular allowance therefore
+// shrinks with range; a hit 1000 units out only matches rays within ~0.014 degrees. The caller
+// rebuilds fraction / end position along its own ray (see AimQueryServe).
+//
+// Entries are only valid for the frame id they were traced in. No engine / Windows dependencies: the
+// result type and tracer are template parameters.
+// ------------------------------------------------------------
+
+struct AimQueryRay
+{
+	float start[3] = { 0.0f, 0.0f, 0.0f };
+	float dir[3] = { 1.0f, 0.0f, 0.0f };   // unit
+	float length = 0.0f;
+	float hullExtent = 0.0f;                // 0 = line trace
+	uint32_t mask = 0;
+	uint64_t filterKey = 0;                 // identifies the trace filter (skipped entities, group)
+
+	// Builds a ray from start / end points. False for a zero-length ray.
+	static bool FromPoints(const float s[3], const float e[3], AimQueryRay& out)
+	{
+		const float d[3] = { e[0] - s[0], e[1] - s[1], e[2] - s[2] };
+		const float len = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+		if (!(len > 1e-4f) || !std::isfinite(len))
+			return false;
+		for (int i = 0; i < 3; ++i)
+		{
+			out.start[i] = s[i];
+			out.dir[i] = d[i] / len;
+		}
+		out.length = len;
+		return true;
+	}
+};
+
+struct AimQueryTolerance
+{
+	float maxDeviation = 0.25f;        // game units, largest gap between the rays up to the decided distance
+	float lengthEpsilon = 0.5f;
+};
+
+// What Query hands back. hitDistance is along the cached ray (>= cachedLength means no hit), so the
+// caller can rebuild fraction / end position for its own length.
+template <typename Result>
+struct AimQueryServe
+{
+	const Result* result = nullptr;
+	float hitDistance = 0.0f;
+	float cachedLength = 0.0f;
+	bool fromCache = false;
+
+	bool Hit(float requestLength) const { return hitDistance < cachedLength && hitDistance <= requestLength; }
+};
+
+template <typename Result, size_t Capacity = 32>
+class AimQueryCache
+{
+public:
+	struct Counters
+	{
+		uint64_t requested = 0;
+		uint64_t executed = 0;
+		uint64_t served = 0;       // answered from the cache
+		uint64_t failed = 0;       // tracer returned false (not cached)
+	};
+
+	AimQueryTolerance m_Tolerance{};
+
+	// tracer: bool(const AimQueryRay&, Result& out, float& outHitDistance). outHitDistance is the
+	// distance to the hit, or ray.length when nothing was hit. Returns false if the trace failed.
+	template <typename Tracer>
+	AimQueryServe<Result> Query(uint64_t frameId, const AimQueryRay& ray, Tracer&& tracer)
+	{
+		if (frameId != m_FrameId)
+		{
+			m_FrameId = frameId;
+			m_Used = 0;
+			m_Next = 0;
+		}
+		++m_Counters.requested;
+
+		AimQueryServe<Result> serve;
+		for (size_t i = 0; i < m_Used; ++i)
+		{
+			const Entry& e = m_Entries[i];
+			if (!Matches(e, ray))
+				continue;
+			++m_Counters.served;
+			serve.result = &e.result;
+			serve.hitDistance = e.hitDistance;
+			serve.cachedLength = e.ray.length;
+			serve.fromCache = true;
+			return serve;
+		}
+
+		// Miss: trace, then keep it in the next slot (round robin once the frame's table is full).
+		++m_Counters.executed;
+		float hitDistance = ray.length;
+		if (!tracer(ray, m_Scratch, hitDistance))
+		{
+			++m_Counters.failed;
+			serve.result = &m_Scratch;
+			serve.hitDistance = ray.length;
+			serve.cachedLength = ray.length;
+			return serve;
+		}
+
+		Entry& e = m_Entries[m_Next];
+		e.ray = ray;
+		e.hitDistance = std::clamp(std::isfinite(hitDistance) ? hitDistance : ray.length, 0.0f, ray.length);
+		e.result = m_Scratch;
+		if (m_Next == m_Used)
+			++m_Used;
+		m_Next = (m_Next + 1) % Capacity;
+		serve.result = &e.result;
+		serve.hitDistance = e.hitDistance;
+		serve.cachedLength = ray.length;
+		return serve;
+	}
+
+	void Invalidate()
+	{
+		m_Used = 0;
+		m_Next = 0;
+	}
+
+	size_t Size() const { return m_Used; }
+	const Counters& GetCounters() const { return m_Counters; }
+	void ResetCounters() { m_Counters = Counters{}; }
+
+private:
+	struct Entry
+	{
+		AimQueryRay ray;
+		float hitDistance = 0.0f;
+		Result result{};
+	};
+
+	bool Matches(const Entry& e, const AimQueryRay& r) const
+	{
+		const AimQueryRay& c = e.ray;
+		if (c.mask != r.mask || c.filterKey != r.filterKey || c.hullExtent != r.hullExtent)
+			return false;
+
+		// The cached trace must decide the request: long enough, or it stopped on a hit first.
+		const bool cachedHit = e.hitDistance < c.length;
+		if (!cachedHit && r.length > c.length + m_Tolerance.lengthEpsilon)
+			return false;
+
+		const float dx = c.start[0] - r.start[0];
+		const float dy = c.start[1] - r.start[1];
+		const float dz = c.start[2] - r.start[2];
+		const float originDelta = std::sqrt(dx * dx + dy * dy + dz * dz);
+		if (originDelta > m_Tolerance.maxDeviation)
+			return false;
+
+		const float dot = c.dir[0] * r.dir[0] + c.dir[1] * r.dir[1] + c.dir[2] * r.dir[2];
+		if (dot <= 0.0f)
+			return false;
+		// |a x b| rather than sqrt(1 - dot^2): the dot of nearly parallel unit vectors rounds to 1.
+		const float cx = c.dir[1] * r.dir[2] - c.dir[2] * r.dir[1];
+		const float cy = c.dir[2] * r.dir[0] - c.dir[0] * r.dir[2];
+		const float cz = c.dir[0] * r.dir[1] - c.dir[1] * r.dir[0];
+		const float sinAngle = std::sqrt(cx * cx + cy * cy + cz * cz);
+		const float decided = cachedHit ? std::min(e.hitDistance, r.length) : r.length;
+		return originDelta + decided * sinAngle <= m_Tolerance.maxDeviation;
+	}
+
+	std::array<Entry, Capacity> m_Entries{};
+	Result m_Scratch{};
+	size_t m_Used = 0;
+	size_t m_Next = 0;
+	uint64_t m_FrameId = ~0ull;
+	Counters m_Counters{};
+};
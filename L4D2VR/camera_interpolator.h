@@ -0,0 +1,316 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// ------------------------------------------------------------
+// Engine camera interpolator.
+//
+// The engine moves its camera (third-person, and the setup origin in queued mode) at tick rate while
+// we render at headset rate. Blending only the last two samples over a fixed guess of the tick
+// length lags by a whole tick and steps whenever the guess is off. This keeps a short history instead:
+//  - samples are recorded when the camera actually changes; their timestamps are phase-locked to an
+//    online tick estimate (mean of recent intervals) so arrival jitter doesn't turn into speed noise,
+//  - a render-time pose is evaluated delayTicks behind now with a cubic Hermite through the
+//    neighbouring samples, and extrapolated from the last velocity for at most maxExtrapolateTicks,
+//  - a camera that stood still for a while restarts from rest, and a jump far beyond what the last
+//    velocity predicts (teleport, ledge grab, respawn) snaps instead of being smeared across a tick.
+// Angles are degrees (pitch, yaw, roll), unwrapped internally. Times are seconds from any steady
+// clock. No engine / Windows dependencies.
+// ------------------------------------------------------------
+
+struct CameraPose
+{
+	float origin[3] = { 0.0f, 0.0f, 0.0f };
+	float angles[3] = { 0.0f, 0.0f, 0.0f };
+};
+
+struct CameraInterpolatorSettings
+{
+	float delayTicks = 0.5f;            // evaluate this far behind now
+	float maxExtrapolateTicks = 0.5f;   // past the newest sample, follow its velocity at most this long
+	float snapDistance = 40.0f;         // units; jumps larger than this (and than the prediction) snap
+	float snapAngleDeg = 45.0f;
+	float changeDistance = 0.25f;       // smaller moves are the same engine sample
+	float changeAngleDeg = 0.25f;
+	float minTickSec = 1.0f / 240.0f;
+	float maxTickSec = 0.1f;
+};
+
+class CameraInterpolator
+{
+public:
+	void Configure(const CameraInterpolatorSettings& settings) { m_Settings = settings; }
+	const CameraInterpolatorSettings& GetSettings() const { return m_Settings; }
+
+	void Reset()
+	{
+		m_Count = 0;
+		m_IntervalCount = 0;
+		m_LastPushTime = -1.0;
+		m_AfterSnap = false;
+	}
+
+	bool IsValid() const { return m_Count > 0; }
+	float GetTickInterval() const { return m_Tick; }
+	float GetRenderInterval() const { return m_RenderInterval; }
+	uint32_t GetSnapCount() const { return m_Snaps; }
+
+	// Worth interpolating only when the engine updates slower than we render.
+	bool ShouldSmooth() const { return m_Count > 0 && m_Tick > m_RenderInterval * 1.2f; }
+
+	// Called every render with the engine's current camera. Returns true when it was a new sample.
+	bool Push(double now, const CameraPose& raw)
+	{
+		if (m_LastPushTime >= 0.0)
+		{
+			const float dt = static_cast<float>(now - m_LastPushTime);
+			if (dt > 0.0f && dt < 0.25f)
+				m_RenderInterval += (dt - m_RenderInterval) * 0.1f;
+		}
+		m_LastPushTime = now;
+
+		if (m_Count == 0)
+		{
+			Append(now, raw, false);
+			return true;
+		}
+
+		const Sample& last = Newest();
+		Sample s;
+		s.time = now;
+		for (int i = 0; i < 3; ++i)
+		{
+			s.origin[i] = raw.origin[i];
+			s.angles[i] = last.angles[i] + WrapDeg(raw.angles[i] - last.angles[i]);
+		}
+
+		float moveSq = 0.0f;
+		float turn = 0.0f;
+		for (int i = 0; i < 3; ++i)
+		{
+			const float d = s.origin[i] - last.origin[i];
+			moveSq += d * d;
+			turn = std::max(turn, std::fabs(s.angles[i] - last.angles[i]));
+		}
+		if (moveSq <= m_Settings.changeDistance * m_Settings.changeDistance && turn <= m_Settings.changeAngleDeg)
+			return false;
+
+		const double sinceLast = now - last.time;
+		const bool resumed = sinceLast > 2.5 * m_Tick;
+		if (!resumed && sinceLast > 0.0)
+		{
+			m_Intervals[m_IntervalHead] = std::clamp(static_cast<float>(sinceLast), m_Settings.minTickSec, m_Settings.maxTickSec);
+			m_IntervalHead = (m_IntervalHead + 1) % m_Intervals.size();
+			m_IntervalCount = std::min(m_IntervalCount + 1, m_Intervals.size());
+			m_Tick = MeanInterval();
+		}
+
+		if (!m_AfterSnap && IsSnap(s, sinceLast))
+		{
+			++m_Snaps;
+			m_Count = 0;
+			Append(now, s, false);
+			m_AfterSnap = true;
+			return true;
+		}
+		// The sample after a snap only re-establishes the velocity (a fast fall keeps jumping far).
+		m_AfterSnap = false;
+
+		if (resumed)
+		{
+			// Stood still until about a tick ago: start the move from rest rather than easing in
+			// over the whole idle stretch.
+			Sample rest = last;
+			rest.time = now - m_Tick;
+			Append(rest.time, rest, false);
+		}
+		else
+		{
+			// Phase-lock: expected one tick after the previous sample, nudged toward the arrival time.
+			const double expected = last.time + m_Tick;
+			double t = expected + (now - expected) * 0.1;
+			t = std::clamp(t, now - m_Tick, now);
+			s.time = std::max(t, last.time + 0.25 * m_Tick);
+		}
+		Append(s.time, s, true);
+		return true;
+	}
+
+	CameraPose Evaluate(double now) const
+	{
+		CameraPose out;
+		if (m_Count == 0)
+			return out;
+
+		const Sample& newest = Newest();
+		if (m_Count == 1)
+			return ToPose(newest);
+
+		const double target = now - static_cast<double>(m_Settings.delayTicks) * m_Tick;
+		if (target >= newest.time)
+		{
+			const Sample& prev = At(m_Count - 2);
+			const double span = newest.time - prev.time;
+			const double ahead = std::min(target - newest.time, static_cast<double>(m_Settings.maxExtrapolateTicks) * m_Tick);
+			for (int i = 0; i < 3; ++i)
+			{
+				const float vo = span > 0.0 ? static_cast<float>((newest.origin[i] - prev.origin[i]) / span) : 0.0f;
+				const float va = span > 0.0 ? static_cast<float>((newest.angles[i] - prev.angles[i]) / span) : 0.0f;
+				out.origin[i] = newest.origin[i] + vo * static_cast<float>(ahead);
+				out.angles[i] = WrapDeg(newest.angles[i] + va * static_cast<float>(ahead));
+			}
+			return out;
+		}
+
+		size_t seg = m_Count - 2;
+		while (seg > 0 && At(seg).time > target)
+			--seg;
+		const Sample& p0 = At(seg);
+		const Sample& p1 = At(seg + 1);
+		if (target <= p0.time)
+			return ToPose(p0);
+
+		const double h = p1.time - p0.time;
+		const float u = h > 0.0 ? static_cast<float>((target - p0.time) / h) : 1.0f;
+		const Sample* before = seg > 0 ? &At(seg - 1) : nullptr;
+		const Sample* after = seg + 2 < m_Count ? &At(seg + 2) : nullptr;
+
+		// Cubic Hermite basis.
+		const float u2 = u * u;
+		const float u3 = u2 * u;
+		const float h00 = 2.0f * u3 - 3.0f * u2 + 1.0f;
+		const float h10 = u3 - 2.0f * u2 + u;
+		const float h01 = -2.0f * u3 + 3.0f * u2;
+		const float h11 = u3 - u2;
+		for (int i = 0; i < 3; ++i)
+		{
+			const float m0o = Tangent(before, p0, &p1, i, false);
+			const float m1o = Tangent(&p0, p1, after, i, false);
+			const float m0a = Tangent(before, p0, &p1, i, true);
+			const float m1a = Tangent(&p0, p1, after, i, true);
+			const float hs = static_cast<float>(h);
+			out.origin[i] = h00 * p0.origin[i] + h10 * hs * m0o + h01 * p1.origin[i] + h11 * hs * m1o;
+			out.angles[i] = WrapDeg(h00 * p0.angles[i] + h10 * hs * m0a + h01 * p1.angles[i] + h11 * hs * m1a);
+		}
+		return out;
+	}
+
+	static float WrapDeg(float deg)
+	{
+		return deg - 360.0f * std::floor((deg + 180.0f) / 360.0f);
+	}
+
+private:
+	struct Sample
+	{
+		double time = 0.0;
+		float origin[3] = { 0.0f, 0.0f, 0.0f };
+		float angles[3] = { 0.0f, 0.0f, 0.0f };
+		bool moving = false;    // arrived through a tick step, not a reset / snap / rest
+	};
+
+	static constexpr size_t kHistory = 8;
+
+	const Sample& At(size_t i) const { return m_History[(m_Head + kHistory - m_Count + i) % kHistory]; }
+	const Sample& Newest() const { return At(m_Count - 1); }
+
+	static CameraPose ToPose(const Sample& s)
+	{
+		CameraPose pose;
+		for (int i = 0; i < 3; ++i)
+		{
+			pose.origin[i] = s.origin[i];
+			pose.angles[i] = WrapDeg(s.angles[i]);
+		}
+		return pose;
+	}
+
+	void Append(double time, const CameraPose& pose, bool moving)
+	{
+		Sample s;
+		s.time = time;
+		s.moving = moving;
+		for (int i = 0; i < 3; ++i)
+		{
+			s.origin[i] = pose.origin[i];
+			s.angles[i] = pose.angles[i];
+		}
+		Append(time, s, moving);
+	}
+
+	void Append(double time, Sample s, bool moving)
+	{
+		s.time = time;
+		s.moving = moving;
+		m_History[m_Head] = s;
+		m_Head = (m_Head + 1) % kHistory;
+		m_Count = std::min(m_Count + 1, kHistory);
+	}
+
+	// Slope at b from its neighbours (Catmull-Rom style); one-sided at the ends, zero where the
+	// camera starts from rest.
+	static float Tangent(const Sample* a, const Sample& b, const Sample* c, int i, bool angles)
+	{
+		auto value = [angles, i](const Sample& s) { return angles ? s.angles[i] : s.origin[i]; };
+		if (!b.moving)
+			return 0.0f;
+		const Sample& from = a ? *a : b;
+		const Sample& to = c ? *c : b;
+		const double span = to.time - from.time;
+		return span > 0.0 ? static_cast<float>((value(to) - value(from)) / span) : 0.0f;
+	}
+
+	bool IsSnap(const Sample& s, double sinceLast) const
+	{
+		const Sample& last = Newest();
+		float moveSq = 0.0f;
+		float turn = 0.0f;
+		float predictedSq = 0.0f;
+		float predictedTurn = 0.0f;
+		const bool haveVelocity = m_Count >= 2 && last.moving;
+		const Sample* prev = haveVelocity ? &At(m_Count - 2) : nullptr;
+		const double span = prev ? last.time - prev->time : 0.0;
+		const double step = std::max(sinceLast, static_cast<double>(m_Tick));
+		for (int i = 0; i < 3; ++i)
+		{
+			const float d = s.origin[i] - last.origin[i];
+			moveSq += d * d;
+			turn = std::max(turn, std::fabs(s.angles[i] - last.angles[i]));
+			if (prev && span > 0.0)
+			{
+				const float pd = static_cast<float>((last.origin[i] - prev->origin[i]) / span * step);
+				predictedSq += pd * pd;
+				predictedTurn = std::max(predictedTurn, static_cast<float>(std::fabs(last.angles[i] - prev->angles[i]) / span * step));
+			}
+		}
+		const bool jump = moveSq > m_Settings.snapDistance * m_Settings.snapDistance && moveSq > 9.0f * predictedSq;
+		const bool spin = turn > m_Settings.snapAngleDeg && turn > 3.0f * predictedTurn;
+		return jump || spin;
+	}
+
+	// Mean, not median: when the tick doesn't divide the render rate, arrivals alternate between
+	// one and two render frames apart and the median flips between them.
+	float MeanInterval() const
+	{
+		float sum = 0.0f;
+		for (size_t i = 0; i < m_IntervalCount; ++i)
+			sum += m_Intervals[i];
+		return sum / static_cast<float>(m_IntervalCount);
+	}
+
+	CameraInterpolatorSettings m_Settings;
+	std::array<Sample, kHistory> m_History{};
+	size_t m_Head = 0;
+	size_t m_Count = 0;
+	std::array<float, 16> m_Intervals{};
+	size_t m_IntervalHead = 0;
+	size_t m_IntervalCount = 0;
+	float m_Tick = 1.0f / 30.0f;
+	float m_RenderInterval = 1.0f / 90.0f;
+	double m_LastPushTime = -1.0;
+	uint32_t m_Snaps = 0;
+	bool m_AfterSnap = false;
+};
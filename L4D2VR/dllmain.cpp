@@ -462,7 +462,7 @@ BOOL APIENTRY DllMain(HMODULE hModule,
     case DLL_THREAD_DETACH:
         break;
     case DLL_PROCESS_DETACH:
-        Game::UninstallVertexFormatWarningFilter();
+        Game::UninstallSpewFilter();
         break;
     }
     return TRUE;
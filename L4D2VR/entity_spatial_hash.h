@@ -0,0 +1,384 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// ------------------------------------------------------------
+// Uniform-grid spatial hash over entity origins.
+//
+// Proximity features (melee fan target search, special infected warnings) used to walk the whole
+// client entity list and distance-check every entity each frame; on finale maps with 100+ commons
+// that's most of the list for a handful of nearby hits. Instead:
+//  - the grid is refreshed once per client tick with Update() per live entity; an entity only
+//    relinks when it crosses a cell boundary, and EndUpdate() drops the ones not seen this pass,
+//  - radius / cone / k-nearest queries only visit the cells overlapping the query; with few live
+//    entities (m_LinearScanMax) they just walk the live list, which beats hashing the cells,
+//  - results come back sorted by distance so callers can spend line-of-sight traces on the first
+//    few candidates only.
+//
+// Cells are 2D (x / y columns, Z is up); heights are still checked exactly by the radius queries.
+// Cell coordinates are hashed into a fixed power-of-two bucket table, so the map size doesn't matter.
+// Storage is allocated by the constructor / Configure; updates and queries don't allocate except to
+// grow the caller's output vector. No engine / Windows dependencies.
+// ------------------------------------------------------------
+
+struct SpatialHashVec3
+{
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+};
+
+struct EntitySpatialHit
+{
+	int index = -1;
+	float distance = 0.0f;      // 3D for radius / nearest queries, planar for planar cones
+	float dot = 1.0f;           // cone queries: cosine to the cone axis
+};
+
+struct EntitySpatialCone
+{
+	SpatialHashVec3 origin;
+	SpatialHashVec3 dir;        // unit (planar cones ignore z and renormalize)
+	float minDot = 0.0f;        // cos(half angle)
+	float minDistance = 0.0f;
+	float maxDistance = 0.0f;
+	bool planar = false;        // measure distance and angle in the x / y plane only
+	float slack = 0.0f;         // also accept entities within this distance of the cone (positions up
+	                            // to a tick old); callers recheck the exact position
+};
+
+class EntitySpatialHash
+{
+public:
+	struct Counters
+	{
+		uint64_t updates = 0;
+		uint64_t relinks = 0;       // cell changes (incl. inserts)
+		uint64_t removals = 0;
+		uint64_t queries = 0;
+		uint64_t visited = 0;       // entities distance-tested by queries
+	};
+
+	// At or below this many live entities queries scan the live list instead of visiting cells.
+	size_t m_LinearScanMax = 24;
+
+	explicit EntitySpatialHash(int maxEntities = 4096, float cellSize = 256.0f, int bucketBits = 10)
+	{
+		Configure(maxEntities, cellSize, bucketBits);
+	}
+
+	// Resizes / re-grids. Drops every entity.
+	void Configure(int maxEntities, float cellSize, int bucketBits = 10)
+	{
+		m_MaxEntities = std::max(1, maxEntities);
+		m_CellSize = std::max(8.0f, std::isfinite(cellSize) ? cellSize : 256.0f);
+		m_InvCellSize = 1.0f / m_CellSize;
+		bucketBits = std::clamp(bucketBits, 4, 16);
+		m_BucketMask = (1u << bucketBits) - 1u;
+
+		m_Heads.assign(static_cast<size_t>(m_BucketMask) + 1, -1);
+		m_Slots.assign(static_cast<size_t>(m_MaxEntities), Slot{});
+		m_Live.clear();
+		m_Live.reserve(static_cast<size_t>(m_MaxEntities));
+		m_Stamp = 1;
+	}
+
+	float GetCellSize() const { return m_CellSize; }
+	int GetMaxEntities() const { return m_MaxEntities; }
+	size_t Size() const { return m_Live.size(); }
+
+	// Refresh pass: BeginUpdate, Update() every live entity, EndUpdate.
+	void BeginUpdate() { ++m_Stamp; }
+
+	// Inserts or moves an entity. tags is caller-defined (queries filter on tagMask). False for an
+	// out-of-range index or a non-finite position.
+	bool Update(int index, const SpatialHashVec3& pos, uint32_t tags)
+	{
+		if (index < 0 || index >= m_MaxEntities || !std::isfinite(pos.x) || !std::isfinite(pos.y) || !std::isfinite(pos.z))
+			return false;
+
+		++m_Counters.updates;
+		Slot& s = m_Slots[index];
+		const int32_t cx = CellCoord(pos.x);
+		const int32_t cy = CellCoord(pos.y);
+		if (!s.present)
+		{
+			s.present = true;
+			s.livePos = static_cast<int>(m_Live.size());
+			m_Live.push_back(index);
+			s.cx = cx;
+			s.cy = cy;
+			Link(index);
+			++m_Counters.relinks;
+		}
+		else if (s.cx != cx || s.cy != cy)
+		{
+			Unlink(index);
+			s.cx = cx;
+			s.cy = cy;
+			Link(index);
+			++m_Counters.relinks;
+		}
+		s.pos = pos;
+		s.tags = tags;
+		s.stamp = m_Stamp;
+		return true;
+	}
+
+	// Removes everything not updated since BeginUpdate. Returns how many were removed.
+	int EndUpdate()
+	{
+		int removed = 0;
+		for (size_t i = 0; i < m_Live.size();)
+		{
+			const int index = m_Live[i];
+			if (m_Slots[index].stamp != m_Stamp)
+			{
+				Remove(index);
+				++removed;
+				continue;   // Remove swapped another entity into position i
+			}
+			++i;
+		}
+		return removed;
+	}
+
+	void Remove(int index)
+	{
+		if (index < 0 || index >= m_MaxEntities || !m_Slots[index].present)
+			return;
+		Unlink(index);
+		Slot& s = m_Slots[index];
+		const int last = m_Live.back();
+		m_Live[s.livePos] = last;
+		m_Slots[last].livePos = s.livePos;
+		m_Live.pop_back();
+		s.present = false;
+		s.livePos = -1;
+		++m_Counters.removals;
+	}
+
+	void Clear()
+	{
+		std::fill(m_Heads.begin(), m_Heads.end(), -1);
+		for (int index : m_Live)
+			m_Slots[index] = Slot{};
+		m_Live.clear();
+	}
+
+	bool Contains(int index) const { return index >= 0 && index < m_MaxEntities && m_Slots[index].present; }
+
+	bool GetPosition(int index, SpatialHashVec3& out) const
+	{
+		if (!Contains(index))
+			return false;
+		out = m_Slots[index].pos;
+		return true;
+	}
+
+	uint32_t GetTags(int index) const { return Contains(index) ? m_Slots[index].tags : 0u; }
+
+	// Every entity within radius of center (3D), sorted nearest first. Returns the count.
+	int QueryRadius(const SpatialHashVec3& center, float radius, uint32_t tagMask, std::vector<EntitySpatialHit>& out)
+	{
+		out.clear();
+		++m_Counters.queries;
+		if (!(radius > 0.0f) || !std::isfinite(radius))
+			return 0;
+		const float r2 = radius * radius;
+		ForEachCandidate(center.x, center.y, radius, tagMask, [&](int index, const Slot& s)
+			{
+				const float dx = s.pos.x - center.x;
+				const float dy = s.pos.y - center.y;
+				const float dz = s.pos.z - center.z;
+				const float d2 = dx * dx + dy * dy + dz * dz;
+				if (d2 <= r2)
+					out.push_back({ index, std::sqrt(d2), 1.0f });
+			});
+		SortByDistance(out);
+		return static_cast<int>(out.size());
+	}
+
+	// Every entity inside the cone, sorted nearest first. Returns the count.
+	int QueryCone(const EntitySpatialCone& cone, uint32_t tagMask, std::vector<EntitySpatialHit>& out)
+	{
+		out.clear();
+		++m_Counters.queries;
+		if (!(cone.maxDistance > 0.0f) || !std::isfinite(cone.maxDistance))
+			return 0;
+
+		SpatialHashVec3 axis = cone.dir;
+		if (cone.planar)
+			axis.z = 0.0f;
+		const float axisLen = std::sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+		if (!(axisLen > 1e-6f))
+			return 0;
+		axis = { axis.x / axisLen, axis.y / axisLen, axis.z / axisLen };
+
+		const float slack = std::max(0.0f, cone.slack);
+		const float maxD = cone.maxDistance + slack;
+		const float maxD2 = maxD * maxD;
+		const float minD = std::max(0.0f, cone.minDistance - slack);
+		const float minD2 = minD * minD;
+		const float halfAngle = std::acos(std::clamp(cone.minDot, -1.0f, 1.0f));
+		ForEachCandidate(cone.origin.x, cone.origin.y, maxD, tagMask, [&](int index, const Slot& s)
+			{
+				const float dx = s.pos.x - cone.origin.x;
+				const float dy = s.pos.y - cone.origin.y;
+				const float dz = cone.planar ? 0.0f : s.pos.z - cone.origin.z;
+				const float d2 = dx * dx + dy * dy + dz * dz;
+				if (d2 > maxD2 || d2 <= minD2 || d2 <= 0.0f)
+					return;
+				const float d = std::sqrt(d2);
+				const float dot = (dx * axis.x + dy * axis.y + dz * axis.z) / d;
+				if (dot < cone.minDot)
+				{
+					// A ball of radius slack around the entity reaches into the cone if its angular
+					// radius covers the gap.
+					if (slack <= 0.0f)
+						return;
+					if (d > slack && std::acos(std::clamp(dot, -1.0f, 1.0f)) > halfAngle + std::asin(slack / d))
+						return;
+				}
+				out.push_back({ index, d, dot });
+			});
+		SortByDistance(out);
+		return static_cast<int>(out.size());
+	}
+
+	// The k entities nearest to center within maxRadius, nearest first. The search radius starts at
+	// one cell and doubles, so a dense neighbourhood never visits far cells.
+	int QueryNearest(const SpatialHashVec3& center, int k, float maxRadius, uint32_t tagMask, std::vector<EntitySpatialHit>& out)
+	{
+		out.clear();
+		if (k <= 0 || !(maxRadius > 0.0f))
+			return 0;
+		float radius = std::min(m_CellSize, maxRadius);
+		for (;;)
+		{
+			// Everything within radius is found, so once k are in hand they're the k nearest.
+			QueryRadius(center, radius, tagMask, out);
+			if (static_cast<int>(out.size()) >= k || radius >= maxRadius || !std::isfinite(radius))
+				break;
+			radius = std::min(radius * 2.0f, maxRadius);
+		}
+		if (static_cast<int>(out.size()) > k)
+			out.resize(static_cast<size_t>(k));
+		return static_cast<int>(out.size());
+	}
+
+	const Counters& GetCounters() const { return m_Counters; }
+	void ResetCounters() { m_Counters = Counters{}; }
+
+private:
+	struct Slot
+	{
+		SpatialHashVec3 pos;
+		uint32_t tags = 0;
+		uint32_t stamp = 0;
+		int32_t cx = 0;
+		int32_t cy = 0;
+		int prev = -1;
+		int next = -1;
+		int livePos = -1;
+		bool present = false;
+	};
+
+	// floor() by truncation: std::floor is a library call without SSE4.1, and this runs twice per
+	// Update() for every live entity.
+	int32_t CellCoord(float v) const
+	{
+		const float c = std::clamp(v * m_InvCellSize, -1.0e9f, 1.0e9f);
+		const int32_t t = static_cast<int32_t>(c);
+		return (static_cast<float>(t) > c) ? t - 1 : t;
+	}
+
+	uint32_t Bucket(int32_t cx, int32_t cy) const
+	{
+		const uint32_t h = static_cast<uint32_t>(cx) * 73856093u ^ static_cast<uint32_t>(cy) * 19349663u;
+		return (h ^ (h >> 15)) & m_BucketMask;
+	}
+
+	void Link(int index)
+	{
+		Slot& s = m_Slots[index];
+		int& head = m_Heads[Bucket(s.cx, s.cy)];
+		s.prev = -1;
+		s.next = head;
+		if (head >= 0)
+			m_Slots[head].prev = index;
+		head = index;
+	}
+
+	void Unlink(int index)
+	{
+		Slot& s = m_Slots[index];
+		if (s.prev >= 0)
+			m_Slots[s.prev].next = s.next;
+		else
+			m_Heads[Bucket(s.cx, s.cy)] = s.next;
+		if (s.next >= 0)
+			m_Slots[s.next].prev = s.prev;
+		s.prev = s.next = -1;
+	}
+
+	// Calls fn(index, slot) for each tagged entity in the cells overlapping the x / y square around
+	// (x, y). Buckets are shared between cells, so entries are checked against the cell being visited.
+	// A query wider than the bucket table, or a grid holding only a few entities, just walks the live list.
+	template <typename Fn>
+	void ForEachCandidate(float x, float y, float radius, uint32_t tagMask, Fn&& fn)
+	{
+		const int32_t x0 = CellCoord(x - radius);
+		const int32_t x1 = CellCoord(x + radius);
+		const int32_t y0 = CellCoord(y - radius);
+		const int32_t y1 = CellCoord(y + radius);
+		const double cells = (static_cast<double>(x1) - x0 + 1.0) * (static_cast<double>(y1) - y0 + 1.0);
+		if (m_Live.size() <= m_LinearScanMax || cells > static_cast<double>(m_BucketMask) + 1.0 || cells > static_cast<double>(m_Live.size()))
+		{
+			for (int index : m_Live)
+			{
+				const Slot& s = m_Slots[index];
+				++m_Counters.visited;
+				if (s.tags & tagMask)
+					fn(index, s);
+			}
+			return;
+		}
+
+		for (int32_t cy = y0; cy <= y1; ++cy)
+		{
+			for (int32_t cx = x0; cx <= x1; ++cx)
+			{
+				for (int index = m_Heads[Bucket(cx, cy)]; index >= 0; index = m_Slots[index].next)
+				{
+					const Slot& s = m_Slots[index];
+					if (s.cx != cx || s.cy != cy)
+						continue;
+					++m_Counters.visited;
+					if (s.tags & tagMask)
+						fn(index, s);
+				}
+			}
+		}
+	}
+
+	static void SortByDistance(std::vector<EntitySpatialHit>& hits)
+	{
+		std::sort(hits.begin(), hits.end(), [](const EntitySpatialHit& a, const EntitySpatialHit& b)
+			{
+				return a.distance < b.distance || (a.distance == b.distance && a.index < b.index);
+			});
+	}
+
+	std::vector<int> m_Heads;
+	std::vector<Slot> m_Slots;
+	std::vector<int> m_Live;
+	float m_CellSize = 256.0f;
+	float m_InvCellSize = 1.0f / 256.0f;
+	uint32_t m_BucketMask = 1023;
+	uint32_t m_Stamp = 1;
+	int m_MaxEntities = 0;
+	Counters m_Counters{};
+};
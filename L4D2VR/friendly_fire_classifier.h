@@ -0,0 +1,248 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// ------------------------------------------------------------
+// Friendly-fire spread classifier.
+//
+// The fire guard used to decide from the center ray alone, which lets shotgun pellets and
+// spread shots through when the crosshair is just beside a teammate. Instead:
+//  - FriendlyFirePattern holds a fixed set of directions on the unit disc (area-uniform, so every
+//    sample stands for the same share of the cone), stretched to the weapon's spread per shot,
+//  - teammates are capsules from the caller's census of player positions and every sample ray is
+//    intersected with them analytically, so no engine traces are spent,
+//  - world occlusion is a single distance from the caller's center-ray trace: samples stop there.
+// The result is the chance a shot (all of its pellets) touches a teammate.
+//
+// Z is up (Source convention). No engine / Windows dependencies.
+// ------------------------------------------------------------
+
+struct FriendlyFireVec3
+{
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+
+	FriendlyFireVec3 operator+(const FriendlyFireVec3& o) const { return { x + o.x, y + o.y, z + o.z }; }
+	FriendlyFireVec3 operator-(const FriendlyFireVec3& o) const { return { x - o.x, y - o.y, z - o.z }; }
+	FriendlyFireVec3 operator*(float s) const { return { x * s, y * s, z * s }; }
+	float Dot(const FriendlyFireVec3& o) const { return x * o.x + y * o.y + z * o.z; }
+	FriendlyFireVec3 Cross(const FriendlyFireVec3& o) const { return { y * o.z - z * o.y, z * o.x - x * o.z, x * o.y - y * o.x }; }
+	float Length() const { return std::sqrt(Dot(*this)); }
+};
+
+// Segment a-b swept by radius (a teammate's body, feet to head).
+struct FriendlyFireCapsule
+{
+	FriendlyFireVec3 a;
+	FriendlyFireVec3 b;
+	float radius = 16.0f;
+	int index = -1;             // caller's id (entity index)
+};
+
+struct FriendlyFireResult
+{
+	float sampleHitFraction = 0.0f;     // share of the cone that reaches a teammate before the world
+	float shotHitChance = 0.0f;         // 1 - (1 - fraction)^bullets
+	int nearestIndex = -1;              // capsule id hit closest to the muzzle, -1 if none
+	float nearestDistance = 0.0f;
+	int capsulesTested = 0;             // capsules that survived the cone cull
+};
+
+class FriendlyFirePattern
+{
+public:
+	// Lays out sampleCount directions (including the center ray) on the unit disc. Built once per
+	// sample count; the weapon's spread is applied per shot by SetSpread.
+	void Build(int sampleCount)
+	{
+		constexpr float kGoldenAngle = 2.39996322972865332f;
+		const int n = std::clamp(sampleCount, 1, 256);
+
+		// Vogel spiral: sample i sits at radius sqrt(i / (n - 1)), so the rings are area-uniform.
+		m_Offsets.resize(static_cast<size_t>(n));
+		m_Offsets[0] = { 0.0f, 0.0f };
+		for (int i = 1; i < n; ++i)
+		{
+			const float r = std::sqrt(static_cast<float>(i) / static_cast<float>(n - 1));
+			const float theta = kGoldenAngle * static_cast<float>(i);
+			m_Offsets[static_cast<size_t>(i)] = { r * std::cos(theta), r * std::sin(theta) };
+		}
+	}
+
+	// Half angles in degrees. pitch == yaw gives a round cone; shotguns scatter pitch and yaw apart.
+	void SetSpread(float halfAnglePitchDegrees, float halfAngleYawDegrees)
+	{
+		constexpr float kDegToRad = 3.14159265358979323846f / 180.0f;
+		m_TanPitch = std::tan(std::clamp(halfAnglePitchDegrees, 0.0f, 45.0f) * kDegToRad);
+		m_TanYaw = std::tan(std::clamp(halfAngleYawDegrees, 0.0f, 45.0f) * kDegToRad);
+	}
+
+	int GetCount() const { return static_cast<int>(m_Offsets.size()); }
+	float GetMaxTan() const { return std::max(m_TanPitch, m_TanYaw); }
+
+	// Sample direction i around forward (unit) with right / up completing the basis.
+	FriendlyFireVec3 Direction(int i, const FriendlyFireVec3& forward, const FriendlyFireVec3& right, const FriendlyFireVec3& up) const
+	{
+		const Offset& o = m_Offsets[static_cast<size_t>(i)];
+		const FriendlyFireVec3 d = forward + right * (o.right * m_TanYaw) + up * (o.up * m_TanPitch);
+		return d * (1.0f / d.Length());
+	}
+
+private:
+	struct Offset
+	{
+		float right = 0.0f;
+		float up = 0.0f;
+	};
+
+	std::vector<Offset> m_Offsets;
+	float m_TanPitch = 0.0f;
+	float m_TanYaw = 0.0f;
+};
+
+class FriendlyFireClassifier
+{
+public:
+	// Distance along the unit ray (origin, dir) to the capsule surface, or -1 if it misses.
+	// A ray starting inside the capsule hits at 0.
+	static float RayCapsule(const FriendlyFireVec3& origin, const FriendlyFireVec3& dir, const FriendlyFireCapsule& c)
+	{
+		const float r2 = c.radius * c.radius;
+		const FriendlyFireVec3 axis = c.b - c.a;
+		const FriendlyFireVec3 ao = origin - c.a;
+		const float axisLen2 = axis.Dot(axis);
+		if (axisLen2 < 1e-8f)
+			return RaySphere(origin, dir, c.a, r2);
+
+		// Infinite cylinder around the axis, projected onto the plane perpendicular to it.
+		const float dA = dir.Dot(axis);
+		const float oA = ao.Dot(axis);
+		const float a = axisLen2 - dA * dA;
+		const float b = axisLen2 * ao.Dot(dir) - oA * dA;
+		const float c0 = axisLen2 * (ao.Dot(ao) - r2) - oA * oA;
+
+		if (c0 <= 0.0f && oA >= 0.0f && oA <= axisLen2)
+			return 0.0f;
+
+		float best = -1.0f;
+		if (a > 1e-8f)
+		{
+			const float h = b * b - a * c0;
+			if (h < 0.0f)
+				return -1.0f;   // misses the infinite cylinder, so the caps too
+			const float t = (-b - std::sqrt(h)) / a;
+			const float y = oA + t * dA;
+			if (t >= 0.0f && y >= 0.0f && y <= axisLen2)
+				return t;
+		}
+
+		// End caps: hemispheres at a and b.
+		const float tA = RaySphere(origin, dir, c.a, r2);
+		const float tB = RaySphere(origin, dir, c.b, r2);
+		if (tA >= 0.0f)
+			best = tA;
+		if (tB >= 0.0f && (best < 0.0f || tB < best))
+			best = tB;
+		return best;
+	}
+
+	// capsules: the census (teammates only). forward must be unit. worldDistance: where the center
+	// ray meets the world; samples past it are treated as blocked. bullets >= 1.
+	static FriendlyFireResult Classify(const FriendlyFireVec3& origin, const FriendlyFireVec3& forward, float worldDistance,
+		const FriendlyFirePattern& pattern, int bullets, const FriendlyFireCapsule* capsules, int capsuleCount)
+	{
+		FriendlyFireResult result;
+		const int samples = pattern.GetCount();
+		if (samples <= 0 || !capsules || capsuleCount <= 0 || !(worldDistance > 0.0f))
+			return result;
+
+		FriendlyFireVec3 right;
+		FriendlyFireVec3 up;
+		Basis(forward, right, up);
+
+		// Cone cull: the capsule's bounding sphere against the cone widened by the pattern's largest
+		// tangent. Anything kept is tested per sample.
+		constexpr int kMaxTested = 64;
+		int tested[kMaxTested];
+		int testedCount = 0;
+		const float coneTan = pattern.GetMaxTan();
+		const float coneCos = 1.0f / std::sqrt(1.0f + coneTan * coneTan);
+		const float coneSin = coneTan * coneCos;
+		for (int i = 0; i < capsuleCount && testedCount < kMaxTested; ++i)
+		{
+			const FriendlyFireCapsule& c = capsules[i];
+			const FriendlyFireVec3 mid = (c.a + c.b) * 0.5f;
+			const float boundRadius = (c.b - c.a).Length() * 0.5f + c.radius;
+			const FriendlyFireVec3 rel = mid - origin;
+			const float along = rel.Dot(forward);
+			if (along < -boundRadius || along - boundRadius > worldDistance)
+				continue;
+			const float dist2 = rel.Dot(rel);
+			if (dist2 > boundRadius * boundRadius)
+			{
+				// Sphere-vs-cone: distance from the sphere center to the cone surface.
+				const float perp = std::sqrt(std::max(0.0f, dist2 - along * along));
+				if (perp * coneCos - along * coneSin > boundRadius)
+					continue;
+			}
+			tested[testedCount++] = i;
+		}
+		result.capsulesTested = testedCount;
+		if (testedCount == 0)
+			return result;
+
+		int hits = 0;
+		float nearest = worldDistance;
+		for (int s = 0; s < samples; ++s)
+		{
+			const FriendlyFireVec3 dir = pattern.Direction(s, forward, right, up);
+			bool sampleHit = false;
+			for (int k = 0; k < testedCount; ++k)
+			{
+				const FriendlyFireCapsule& c = capsules[tested[k]];
+				const float t = RayCapsule(origin, dir, c);
+				if (t < 0.0f || t > worldDistance)
+					continue;
+				sampleHit = true;
+				if (t < nearest || result.nearestIndex < 0)
+				{
+					nearest = t;
+					result.nearestIndex = c.index;
+				}
+			}
+			if (sampleHit)
+				++hits;
+		}
+
+		result.sampleHitFraction = static_cast<float>(hits) / static_cast<float>(samples);
+		result.shotHitChance = 1.0f - std::pow(1.0f - result.sampleHitFraction, static_cast<float>(std::max(1, bullets)));
+		result.nearestDistance = result.nearestIndex >= 0 ? nearest : 0.0f;
+		return result;
+	}
+
+	// right / up perpendicular to forward, right level when forward isn't vertical.
+	static void Basis(const FriendlyFireVec3& forward, FriendlyFireVec3& right, FriendlyFireVec3& up)
+	{
+		const FriendlyFireVec3 worldUp = std::fabs(forward.z) > 0.999f ? FriendlyFireVec3{ 1.0f, 0.0f, 0.0f } : FriendlyFireVec3{ 0.0f, 0.0f, 1.0f };
+		right = forward.Cross(worldUp);
+		right = right * (1.0f / right.Length());
+		up = right.Cross(forward);
+	}
+
+private:
+	static float RaySphere(const FriendlyFireVec3& origin, const FriendlyFireVec3& dir, const FriendlyFireVec3& center, float r2)
+	{
+		const FriendlyFireVec3 oc = origin - center;
+		const float b = oc.Dot(dir);
+		const float c = oc.Dot(oc) - r2;
+		if (c <= 0.0f)
+			return 0.0f;
+		const float h = b * b - c;
+		if (h < 0.0f || b > 0.0f)
+			return -1.0f;
+		return -b - std::sqrt(h);
+	}
+};
@@ -13,12 +13,19 @@
 #include <cstdint>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <system_error>
 
 #include "sdk.h"
 #include "vr.h"
 #include "hooks.h"
 #include "offsets.h"
 #include "sigscanner.h"
+#include "init_graph.h"
+#include "spew_filter.h"
 #include "sdk/ivdebugoverlay.h"
 
 static std::mutex logMutex;
@@ -38,23 +45,92 @@ namespace
     static constexpr size_t kIConVarVtableIndexSetValueInt = 2;
     static thread_local int s_ConVarWritePermitDepth = 0;
     static constexpr char kVertexFormatSpamMessage[] = "Too many vertex format changes in frame, whole world not rendered";
+    static constexpr int kSpewAssert = 2;
+    static constexpr int kSpewError = 3;
+    static constexpr int kSpewContinue = 1;
     using SpewOutputFunc_t = int(__cdecl*)(int spewType, const char* pMsg);
     using tSetSpewOutputFunc = SpewOutputFunc_t(__cdecl*)(SpewOutputFunc_t func);
     using tGetSpewOutputFunc = SpewOutputFunc_t(__cdecl*)();
     static tSetSpewOutputFunc s_SetSpewOutputFunc = nullptr;
     static tGetSpewOutputFunc s_GetSpewOutputFunc = nullptr;
     static SpewOutputFunc_t s_OriginalSpewOutputFunc = nullptr;
-    static bool s_VertexFormatWarningFilterInstalled = false;
-
-    static int __cdecl FilterVertexFormatWarningSpew(int spewType, const char* pMsg)
+    static bool s_SpewFilterInstalled = false;
+
+    // The callback reads the active rule set without a lock, so replaced sets are kept alive
+    // (they only change when config.txt is edited).
+    static std::atomic<const SpewFilter*> s_ActiveSpewFilter{ nullptr };
+    static std::mutex s_SpewFilterMutex;
+    static std::vector<std::unique_ptr<SpewFilter>> s_SpewFilters;
+    static SpewLineQueue s_SpewLogQueue;
+    static std::atomic<bool> s_SpewLogWriterStarted{ false };
+    static constexpr auto kSpewSummaryInterval = std::chrono::seconds(30);
+
+    static int __cdecl FilterSpew(int spewType, const char* pMsg)
     {
-        if (pMsg && std::strstr(pMsg, kVertexFormatSpamMessage) != nullptr)
-            return 1; // SPEW_CONTINUE
+        // Asserts and errors always reach the engine: what it does next depends on their return value.
+        const SpewFilter* filter = s_ActiveSpewFilter.load(std::memory_order_acquire);
+        if (pMsg && filter && spewType != kSpewAssert && spewType != kSpewError)
+        {
+            const int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            const SpewFilter::Verdict verdict = filter->Filter(pMsg, nowMs);
+            if (verdict.forward)
+                s_SpewLogQueue.Push(pMsg);
+            if (!verdict.pass)
+                return kSpewContinue;
+        }
 
-        if (s_OriginalSpewOutputFunc && s_OriginalSpewOutputFunc != &FilterVertexFormatWarningSpew)
+        if (s_OriginalSpewOutputFunc && s_OriginalSpewOutputFunc != &FilterSpew)
             return s_OriginalSpewOutputFunc(spewType, pMsg);
 
-        return 1; // SPEW_CONTINUE
+        return kSpewContinue;
+    }
+
+    // Log thread: writes redirected lines and, every kSpewSummaryInterval, what each rule caught.
+    static void SpewLogWriterMain()
+    {
+        std::vector<std::string> lines;
+        const SpewFilter* summarized = nullptr;
+        std::vector<uint64_t> lastHits;
+        std::vector<uint64_t> lastDropped;
+        auto lastSummary = std::chrono::steady_clock::now();
+        for (;;)
+        {
+            lines.clear();
+            s_SpewLogQueue.WaitPop(lines, std::chrono::milliseconds(1000));
+            for (const std::string& line : lines)
+                Game::logMsg("[Spew] %s", line.c_str());
+            if (const uint64_t lost = s_SpewLogQueue.TakeDropped())
+                Game::logMsg("[Spew] %llu redirected lines lost, log writer fell behind", static_cast<unsigned long long>(lost));
+
+            const auto now = std::chrono::steady_clock::now();
+            if (now - lastSummary < kSpewSummaryInterval)
+                continue;
+            lastSummary = now;
+
+            const SpewFilter* filter = s_ActiveSpewFilter.load(std::memory_order_acquire);
+            if (!filter)
+                continue;
+            if (filter != summarized)
+            {
+                summarized = filter;
+                lastHits.assign(filter->GetRuleCount(), 0);
+                lastDropped.assign(filter->GetRuleCount(), 0);
+            }
+            for (size_t i = 0; i < filter->GetRuleCount(); ++i)
+            {
+                const uint64_t hits = filter->GetHits(i);
+                const uint64_t dropped = filter->GetDropped(i);
+                if (hits == lastHits[i])
+                    continue;
+                const SpewRule& rule = filter->GetRule(i);
+                Game::logMsg("[Spew] rule %zu %s \"%s\": %llu hits, %llu kept off the console",
+                    i, SpewFilter::ActionName(rule.action), rule.pattern.c_str(),
+                    static_cast<unsigned long long>(hits - lastHits[i]), static_cast<unsigned long long>(dropped - lastDropped[i]));
+                lastHits[i] = hits;
+                lastDropped[i] = dropped;
+            }
+        }
     }
 
     static bool NormalizeSuspiciousFloat(float candidate, float& normalized)
@@ -391,43 +467,110 @@ static void* TryInterfaceNoError(const char* dllname, const char* interfacename)
 }
 
 // === Game Constructor ===
+// Startup runs as an init graph (init_graph.h): signature scans, config files, weapon scripts and
+// sound warmup overlap OpenVR init and the wait for the D3D9 device instead of queuing behind it.
 Game::Game()
 {
-    m_BaseClient = reinterpret_cast<uintptr_t>(GetModuleWithRetry("client.dll"));
-    m_BaseEngine = reinterpret_cast<uintptr_t>(GetModuleWithRetry("engine.dll"));
-    m_BaseMaterialSystem = reinterpret_cast<uintptr_t>(GetModuleWithRetry("MaterialSystem.dll"));
-    m_BaseServer = reinterpret_cast<uintptr_t>(GetModuleWithRetry("server.dll"));
-    m_BaseVgui2 = reinterpret_cast<uintptr_t>(GetModuleWithRetry("vgui2.dll"));
-
-    m_BaseClientDll = static_cast<IBaseClientDLL*>(GetInterfaceSafe("client.dll", "VClient016"));
-    m_ClientEntityList = static_cast<IClientEntityList*>(GetInterfaceSafe("client.dll", "VClientEntityList003"));
-    m_EngineTrace = static_cast<IEngineTrace*>(GetInterfaceSafe("engine.dll", "EngineTraceClient003"));
-    m_EngineClient = static_cast<IEngineClient*>(GetInterfaceSafe("engine.dll", "VEngineClient013"));
-    m_GameEventManager = static_cast<IGameEventManager2*>(TryInterfaceNoError("engine.dll", "GAMEEVENTSMANAGER002"));
-    if (!m_GameEventManager)
-        m_GameEventManager = static_cast<IGameEventManager2*>(TryInterfaceNoError("engine.dll", "GAMEEVENTSMANAGER001"));
-    m_MaterialSystem = static_cast<IMaterialSystem*>(GetInterfaceSafe("MaterialSystem.dll", "VMaterialSystem080"));
-    m_ModelInfo = static_cast<IModelInfo*>(GetInterfaceSafe("engine.dll", "VModelInfoClient004"));
-    m_ModelRender = static_cast<IModelRender*>(GetInterfaceSafe("engine.dll", "VEngineModel016"));
-    m_VguiInput = static_cast<IInput*>(GetInterfaceSafe("vgui2.dll", "VGUI_InputInternal001"));
-    m_VguiSurface = static_cast<ISurface*>(GetInterfaceSafe("vguimatsurface.dll", "VGUI_Surface031"));
-    m_DebugOverlay = static_cast<IVDebugOverlay*>(TryInterfaceNoError("engine.dll", "VDebugOverlay004"));
-    if (!m_DebugOverlay)
-        m_DebugOverlay = static_cast<IVDebugOverlay*>(TryInterfaceNoError("engine.dll", "VDebugOverlay003"));
-    m_Cvar = TryInterfaceNoError("vstdlib.dll", "VEngineCvar007");
-    if (!m_Cvar)
-        m_Cvar = TryInterfaceNoError("vstdlib.dll", "VEngineCvar006");
-    if (!m_Cvar)
-        m_Cvar = TryInterfaceNoError("vstdlib.dll", "VEngineCvar004");
-
-    m_Offsets = new Offsets();
+    InitGraph graph;
+
+    const int modules = graph.Add("modules", [this]
+        {
+            m_BaseClient = reinterpret_cast<uintptr_t>(GetModuleWithRetry("client.dll"));
+            m_BaseEngine = reinterpret_cast<uintptr_t>(GetModuleWithRetry("engine.dll"));
+            m_BaseMaterialSystem = reinterpret_cast<uintptr_t>(GetModuleWithRetry("MaterialSystem.dll"));
+            m_BaseServer = reinterpret_cast<uintptr_t>(GetModuleWithRetry("server.dll"));
+            m_BaseVgui2 = reinterpret_cast<uintptr_t>(GetModuleWithRetry("vgui2.dll"));
+            return true;
+        });
+
+    const int interfaces = graph.Add("interfaces", [this]
+        {
+            m_BaseClientDll = static_cast<IBaseClientDLL*>(GetInterfaceSafe("client.dll", "VClient016"));
+            m_ClientEntityList = static_cast<IClientEntityList*>(GetInterfaceSafe("client.dll", "VClientEntityList003"));
+            m_EngineTrace = static_cast<IEngineTrace*>(GetInterfaceSafe("engine.dll", "EngineTraceClient003"));
+            m_EngineClient = static_cast<IEngineClient*>(GetInterfaceSafe("engine.dll", "VEngineClient013"));
+            m_GameEventManager = static_cast<IGameEventManager2*>(TryInterfaceNoError("engine.dll", "GAMEEVENTSMANAGER002"));
+            if (!m_GameEventManager)
+                m_GameEventManager = static_cast<IGameEventManager2*>(TryInterfaceNoError("engine.dll", "GAMEEVENTSMANAGER001"));
+            m_MaterialSystem = static_cast<IMaterialSystem*>(GetInterfaceSafe("MaterialSystem.dll", "VMaterialSystem080"));
+            m_ModelInfo = static_cast<IModelInfo*>(GetInterfaceSafe("engine.dll", "VModelInfoClient004"));
+            m_ModelRender = static_cast<IModelRender*>(GetInterfaceSafe("engine.dll", "VEngineModel016"));
+            m_VguiInput = static_cast<IInput*>(GetInterfaceSafe("vgui2.dll", "VGUI_InputInternal001"));
+            m_VguiSurface = static_cast<ISurface*>(GetInterfaceSafe("vguimatsurface.dll", "VGUI_Surface031"));
+            m_DebugOverlay = static_cast<IVDebugOverlay*>(TryInterfaceNoError("engine.dll", "VDebugOverlay004"));
+            if (!m_DebugOverlay)
+                m_DebugOverlay = static_cast<IVDebugOverlay*>(TryInterfaceNoError("engine.dll", "VDebugOverlay003"));
+            m_Cvar = TryInterfaceNoError("vstdlib.dll", "VEngineCvar007");
+            if (!m_Cvar)
+                m_Cvar = TryInterfaceNoError("vstdlib.dll", "VEngineCvar006");
+            if (!m_Cvar)
+                m_Cvar = TryInterfaceNoError("vstdlib.dll", "VEngineCvar004");
+            // IPlayerInfoManager: GetPlayerInfo, GetGlobalVars.
+            if (void* playerInfoManager = TryInterfaceNoError("server.dll", "PlayerInfoManager002"))
+            {
+                using GetGlobalVarsFn = void*(__thiscall*)(void*);
+                m_ServerGlobals = (*reinterpret_cast<GetGlobalVarsFn**>(playerInfoManager))[1](playerInfoManager);
+            }
+            return true;
+        }, { modules });
+
+    // Every signature scan, off the OpenVR / device path.
+    const int offsets = graph.Add("offsets", [this]
+        {
+            m_Offsets = new Offsets();
+            return true;
+        }, { modules });
+
+    // The VR object exists before any stage runs; its stages fill it in.
     m_VR = new VR(this);
 
-    ResetAllPlayerVRInfo();
+    const int vrRuntime = graph.Add("vr-runtime", [this] { return m_VR->InitRuntime(); });
+
+    // config.txt + haptics_config.txt (first pass of the watcher thread).
+    const int config = graph.Add("config", [this] { return m_VR->StartConfigWatcher(); }, { vrRuntime, interfaces });
+
+    const int soundWarmup = graph.Add("sound-warmup", [this]
+        {
+            m_VR->EnsureFeedbackSoundWarmup();
+            return true;
+        }, { config });
 
-    m_Hooks = new Hooks(this);
+    // Weapon scripts (loose files / VPKs) for the effective-range aim data.
+    const int weaponData = graph.Add("weapon-data", [this] { return m_VR->LoadEffectiveAttackRangeWeaponDataNow(); });
 
-    InstallVertexFormatWarningFilter();
+    // Only the VR device waits for D3D. Without a runtime this stage is skipped, so the hooks don't
+    // wait on a device either.
+    const int d3dDevice = graph.Add("d3d-device", []
+        {
+            while (!VR::IsD3DDeviceReady())
+                Sleep(10);
+            return true;
+        }, { vrRuntime });
+
+    const int vrDevice = graph.Add("vr-device", [this] { return m_VR->InitDeviceResources(); },
+        { vrRuntime, d3dDevice, interfaces }, { offsets });
+
+    // Hooks go in even when VR failed to come up, as before (and then straight away, as before: a
+    // failed runtime skips d3d-device and vr-device). Nothing else may touch VR state once the game
+    // starts calling into it.
+    graph.Add("hooks", [this]
+        {
+            ResetAllPlayerVRInfo();
+            m_Hooks = new Hooks(this);
+            return true;
+        }, { offsets, interfaces }, { vrDevice, soundWarmup, weaponData });
+
+    const unsigned threads = std::clamp(std::thread::hardware_concurrency(), 2u, 4u);
+    graph.Run(threads);
+
+    for (const InitGraph::StageTiming& stage : graph.GetTimings())
+    {
+        logMsg("[Init] %-12s %-7s start %8.1f ms  took %8.1f ms",
+            stage.name.c_str(), InitGraph::StateName(stage.state), stage.startMs, stage.durationMs);
+    }
+    logMsg("[Init] startup graph finished in %.1f ms on %u threads", graph.GetTotalMs(), threads);
+
+    InstallSpewFilter();
     m_Initialized = true;
 
 }
@@ -481,9 +624,40 @@ void Game::errorMsg(const char* msg)
     MessageBoxA(nullptr, msg, "L4D2VR Error", MB_ICONERROR | MB_OK);
 }
 
-bool Game::InstallVertexFormatWarningFilter()
+void Game::ConfigureSpewFilter(const std::vector<SpewRule>& rules)
 {
-    if (s_VertexFormatWarningFilterInstalled)
+    // The vertex format warning floods the console every frame the world is split by the stereo
+    // passes; it stays suppressed whatever config.txt says.
+    std::vector<SpewRule> all;
+    all.reserve(rules.size() + 1);
+    SpewRule vertexFormat;
+    vertexFormat.action = SpewAction::Suppress;
+    vertexFormat.pattern = kVertexFormatSpamMessage;
+    all.push_back(vertexFormat);
+    all.insert(all.end(), rules.begin(), rules.end());
+
+    std::lock_guard<std::mutex> lock(s_SpewFilterMutex);
+    if (const SpewFilter* current = s_ActiveSpewFilter.load(std::memory_order_acquire))
+    {
+        bool same = current->GetRuleCount() == all.size();
+        for (size_t i = 0; same && i < all.size(); ++i)
+        {
+            const SpewRule& a = current->GetRule(i);
+            same = a.action == all[i].action && a.perSecond == all[i].perSecond && a.pattern == all[i].pattern;
+        }
+        if (same)
+            return;
+    }
+
+    std::unique_ptr<SpewFilter> filter = std::make_unique<SpewFilter>(std::move(all));
+    logMsg("[Spew] %zu filter rules, %zu matcher states", filter->GetRuleCount(), filter->GetMatcherStates());
+    s_ActiveSpewFilter.store(filter.get(), std::memory_order_release);
+    s_SpewFilters.push_back(std::move(filter));
+}
+
+bool Game::InstallSpewFilter()
+{
+    if (s_SpewFilterInstalled)
         return true;
 
     HMODULE tier0 = GetModuleHandleA("tier0.dll");
@@ -506,25 +680,41 @@ bool Game::InstallVertexFormatWarningFilter()
     if (!s_SetSpewOutputFunc)
         return false;
 
+    if (!s_ActiveSpewFilter.load(std::memory_order_acquire))
+        ConfigureSpewFilter({});
+
+    if (!s_SpewLogWriterStarted.exchange(true))
+    {
+        try
+        {
+            std::thread writer(&SpewLogWriterMain);
+            writer.detach();
+        }
+        catch (const std::system_error&)
+        {
+            s_SpewLogWriterStarted = false;
+        }
+    }
+
     SpewOutputFunc_t current = s_GetSpewOutputFunc ? s_GetSpewOutputFunc() : nullptr;
-    if (current == &FilterVertexFormatWarningSpew)
+    if (current == &FilterSpew)
     {
-        s_VertexFormatWarningFilterInstalled = true;
+        s_SpewFilterInstalled = true;
         return true;
     }
 
     s_OriginalSpewOutputFunc = current;
-    SpewOutputFunc_t previous = s_SetSpewOutputFunc(&FilterVertexFormatWarningSpew);
+    SpewOutputFunc_t previous = s_SetSpewOutputFunc(&FilterSpew);
     if (!s_OriginalSpewOutputFunc)
         s_OriginalSpewOutputFunc = previous;
 
-    s_VertexFormatWarningFilterInstalled = true;
+    s_SpewFilterInstalled = true;
     return true;
 }
 
-void Game::UninstallVertexFormatWarningFilter()
+void Game::UninstallSpewFilter()
 {
-    if (!s_VertexFormatWarningFilterInstalled || !s_SetSpewOutputFunc)
+    if (!s_SpewFilterInstalled || !s_SetSpewOutputFunc)
         return;
 
     HMODULE tier0 = GetModuleHandleA("tier0.dll");
@@ -534,7 +724,7 @@ void Game::UninstallVertexFormatWarningFilter()
         return;
 
     s_SetSpewOutputFunc(s_OriginalSpewOutputFunc);
-    s_VertexFormatWarningFilterInstalled = false;
+    s_SpewFilterInstalled = false;
 }
 
 bool Game::IsValidPlayerIndex(int index) const
@@ -547,6 +737,14 @@ void Game::ResetAllPlayerVRInfo()
     m_PlayersVRInfo.fill(Player{});
 }
 
+int Game::GetServerFrameCount() const
+{
+    // CGlobalVarsBase: float realtime; int framecount; ...
+    if (!m_ServerGlobals)
+        return -1;
+    return *reinterpret_cast<const int*>(reinterpret_cast<uintptr_t>(m_ServerGlobals) + 4);
+}
+
 // === Entity Access ===
 C_BaseEntity* Game::GetClientEntity(int entityIndex)
 {
@@ -632,12 +830,16 @@ int Game::FindRecvPropOffset(const char* networkName, const char* propName) cons
 // === Commands ===
 void Game::ClientCmd(const char* szCmdString)
 {
+    if (szCmdString && std::strstr(szCmdString, "mat_queue_mode"))
+        InvalidateMatQueueMode();
     if (m_EngineClient)
         m_EngineClient->ClientCmd(szCmdString);
 }
 
 void Game::ClientCmd_Unrestricted(const char* szCmdString)
 {
+    if (szCmdString && std::strstr(szCmdString, "mat_queue_mode"))
+        InvalidateMatQueueMode();
     if (m_EngineClient)
         m_EngineClient->ClientCmd_Unrestricted(szCmdString);
 }
@@ -696,6 +898,11 @@ void* Game::FindConVar(const char* name) const
     return FindConVarInternal(m_Cvar, name);
 }
 
+void* Game::FindIConVar(const char* name) const
+{
+    return GetConVarIConVar(FindConVarInternal(m_Cvar, name));
+}
+
 const char* Game::GetConVarNameFromPointer(const void* convar) const
 {
     __try
@@ -858,17 +1065,24 @@ int Game::GetConVarIntDirect(const char* name, int fallback) const
 
 float Game::GetConVarFloat(const char* name, float fallback) const
 {
-    SourceConVar* cvar = FindConVarInternal(m_Cvar, name);
+    float value = fallback;
+    return GetConVarFloatFromPointer(FindConVarInternal(m_Cvar, name), value) ? value : fallback;
+}
+
+bool Game::GetConVarFloatFromPointer(void* convar, float& outValue) const
+{
+    SourceConVar* cvar = reinterpret_cast<SourceConVar*>(convar);
     if (!cvar)
-        return fallback;
+        return false;
 
     __try
     {
-        return cvar->GetFloatValue();
+        outValue = cvar->GetFloatValue();
+        return true;
     }
     __except (EXCEPTION_EXECUTE_HANDLER)
     {
-        return fallback;
+        return false;
     }
 }
 
@@ -995,7 +1209,12 @@ bool Game::SetConVarInt(const char* name, int value) const
 
 bool Game::SetConVarFloat(const char* name, float value) const
 {
-    SourceConVar* cvar = FindConVarInternal(m_Cvar, name);
+    return SetConVarFloatFromPointer(FindConVarInternal(m_Cvar, name), value);
+}
+
+bool Game::SetConVarFloatFromPointer(void* convar, float value) const
+{
+    SourceConVar* cvar = reinterpret_cast<SourceConVar*>(convar);
     if (!cvar)
         return false;
 
@@ -1129,6 +1348,31 @@ int Game::GetEntityEffects(const C_BaseEntity* entity, int fallback) const
 
 // === Rendering Thread Mode ===
 int Game::GetMatQueueMode() const
+{
+    if (m_MatQueueModeCache.IsValid())
+        return m_MatQueueModeCache.Get();
+
+    return ReadMatQueueModeLive();
+}
+
+void Game::RefreshMatQueueMode()
+{
+    // Loading screens and map changes can switch the thread mode on their own.
+    const bool inGame = m_EngineClient && m_EngineClient->IsInGame();
+    if (m_MatQueueModeInGame.exchange(inGame, std::memory_order_acq_rel) != inGame)
+        m_MatQueueModeCache.Invalidate();
+
+    const double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (m_MatQueueModeCache.Refresh(now, [this]() { return ReadMatQueueModeLive(); }))
+        logMsg("[VR][MatQueue] thread mode -> %d", m_MatQueueModeCache.Get());
+}
+
+void Game::InvalidateMatQueueMode()
+{
+    m_MatQueueModeCache.Invalidate();
+}
+
+int Game::ReadMatQueueModeLive() const
 {
     if (!m_MaterialSystem)
         return 0;
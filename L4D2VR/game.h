@@ -2,11 +2,17 @@
 
 #include <cstdint>
 #include <array>
+#include <atomic>
+#include <vector>
 #include <string>
 #include <cstdarg>
 #include <Windows.h>
 
 #include "vector.h"
+#include "vr_usercmd_payload.h"
+#include "vr_server_state.h"
+#include "roomscale_codec.h"
+#include "mat_queue_mode_cache.h"
 
 // === Forward Declarations for Engine Interfaces ===
 class IClientEntityList;
@@ -30,6 +36,7 @@ class IVDebugOverlay;
 class Game;
 class Offsets;
 class VR;
+struct SpewRule;
 class Hooks;
 
 // === Global Game Instance ===
@@ -44,9 +51,40 @@ struct Player
     Vector controllerPos = { 0.f, 0.f, 0.f };
     QAngle controllerAngle = { 0.f, 0.f, 0.f };
     QAngle prevControllerAngle = { 0.f, 0.f, 0.f };
+    Vector prevControllerPos = { 0.f, 0.f, 0.f };
 
     bool isMeleeing = false;
     bool isNewSwing = false;
+    // Swept melee: newest command the swing was traced up to, and the hand position of the segment
+    // being traced (EyePosition while m_PerformingMelee).
+    int meleeSweptCommand = 0;
+    Vector meleeTracePos = { 0.f, 0.f, 0.f };
+    // Server entity seen by the last ProcessUsercmds; shots anchor relative poses at its live origin.
+    Server_BaseEntity* serverEntity = nullptr;
+
+    // Payload v2 also carries the left hand and HMD. Offsets are relative to the player origin;
+    // the absolute positions above / below are re-resolved against the server entity's origin.
+    // hasRightController is false while the client reports the right hand unavailable (tracking lost,
+    // or outside the payload's position range); controllerPos / controllerAngle are stale then.
+    bool hasRelativePoses = false;
+    bool hasRightController = false;
+    bool hasLeftController = false;
+    bool hasHmd = false;
+    Vector controllerOffset = { 0.f, 0.f, 0.f };
+    Vector leftControllerOffset = { 0.f, 0.f, 0.f };
+    Vector hmdOffset = { 0.f, 0.f, 0.f };
+    Vector leftControllerPos = { 0.f, 0.f, 0.f };
+    QAngle leftControllerAngle = { 0.f, 0.f, 0.f };
+    Vector hmdPos = { 0.f, 0.f, 0.f };
+    QAngle hmdAngle = { 0.f, 0.f, 0.f };
+    VRCmdPayloadHistory<> cmdPayloadHistory;
+    // Roomscale 1:1 deltas received but not yet applied (server side), and the server frame that
+    // last drained them.
+    RoomscaleJitterBuffer roomscaleBuffer;
+    int roomscaleDrainFrame = -1;
+
+    // True when controllerPos / controllerAngle describe a live right hand (always for legacy payloads).
+    bool HasRightHand() const { return isUsingVR && (!hasRelativePoses || hasRightController); }
 };
 
 // === Main Game System ===
@@ -66,6 +104,8 @@ public:
     IVDebugOverlay* m_DebugOverlay = nullptr;
     IGameEventManager2* m_GameEventManager = nullptr;
     void* m_Cvar = nullptr;
+    // Server CGlobalVars (IPlayerInfoManager::GetGlobalVars); null until server.dll provides it.
+    const void* m_ServerGlobals = nullptr;
 
     // === Module Base Addresses ===
     uintptr_t m_BaseEngine = 0;
@@ -85,10 +125,17 @@ public:
     int m_CurrentUsercmdID = -1;
     Server_BaseEntity* m_CurrentUsercmdPlayer = nullptr;
 
+    // === Rendering Thread Mode ===
+    // GetMatQueueMode() reads this; RefreshMatQueueMode() re-reads the engine only when it may have changed.
+    MatQueueModeCache m_MatQueueModeCache;
+    std::atomic<bool> m_MatQueueModeInGame{ false };
+
     // === Player VR State (Multiplayer) ===
     // Matches Source's MAX_PLAYERS (65) to cover the full player index range.
     static constexpr size_t kMaxPlayers = 65;
     std::array<Player, kMaxPlayers> m_PlayersVRInfo;
+    // Per-command pose history of VR clients (server side), for evaluating poses at a given tick.
+    VRServerStateStore<kMaxPlayers> m_VRServerState;
 
     // === Weapon / Viewmodel State ===
     bool m_IsMeleeWeaponActive = false;
@@ -109,12 +156,19 @@ public:
 
     // === Rendering Thread Mode ===
     // Returns material system thread mode (0 = single-threaded, >0 = queued/multicore).
+    // Cached; falls back to ReadMatQueueModeLive() until the first refresh.
     int GetMatQueueMode() const;
+    int ReadMatQueueModeLive() const;
+    // Once per frame (VR::Update, RenderView). Invalidates on map load / unload.
+    void RefreshMatQueueMode();
+    // A mat_queue_mode write was seen; the engine applies it at a later frame boundary.
+    void InvalidateMatQueueMode();
 
     // === Command Execution ===
     void ClientCmd(const char* szCmdString);
     void ClientCmd_Unrestricted(const char* szCmdString);
     void* FindConVar(const char* name) const;
+    void* FindIConVar(const char* name) const;
     const char* GetConVarNameFromPointer(const void* convar) const;
     const char* GetConVarNameFromIConVarPointer(const void* iconvar) const;
     void* GetConVarPrimaryStringSetValueTarget(const char* name) const;
@@ -129,6 +183,7 @@ public:
     int GetConVarInt(const char* name, int fallback = 0) const;
     int GetConVarIntDirect(const char* name, int fallback = 0) const;
     float GetConVarFloat(const char* name, float fallback = 0.0f) const;
+    bool GetConVarFloatFromPointer(void* convar, float& outValue) const;   // convar from FindConVar
     float GetConVarFloatDirect(const char* name, float fallback = 0.0f) const;
     std::string GetConVarString(const char* name) const;
     int GetConVarFlags(const char* name) const;
@@ -136,6 +191,7 @@ public:
     bool SetConVarString(const char* name, const char* value) const;
     bool SetConVarInt(const char* name, int value) const;
     bool SetConVarFloat(const char* name, float value) const;
+    bool SetConVarFloatFromPointer(void* convar, float value) const;
     bool SetConVarBool(const char* name, bool value) const;
     static void BeginConVarWritePermit();
     static void EndConVarWritePermit();
@@ -146,12 +202,15 @@ public:
     // === Logging ===
     static void logMsg(const char* fmt, ...);
     static void errorMsg(const char* msg);
-    static bool InstallVertexFormatWarningFilter();
-    static void UninstallVertexFormatWarningFilter();
+    static bool InstallSpewFilter();
+    static void UninstallSpewFilter();
+    static void ConfigureSpewFilter(const std::vector<SpewRule>& rules);
 
     // === Player Utilities ===
     bool IsValidPlayerIndex(int index) const;
     void ResetAllPlayerVRInfo();
+    // gpGlobals->framecount of the server, or -1 when the server globals are unavailable.
+    int GetServerFrameCount() const;
 };
 
 // === Logging Macros (Debug Only) ===
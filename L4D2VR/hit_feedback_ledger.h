@@ -0,0 +1,371 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// ------------------------------------------------------------
+// Predicted hit feedback: shot ledger.
+//
+// Hit / kill feedback is predicted from the local shot trace and later reconciled with the
+// server's hurt / death events. The pending hits used to live in a small vector that every event
+// scanned and pruned, matched against fixed timestamp windows. Instead:
+//  - every shot gets a serial and a slot in a fixed ring (serial & mask), holding its impact,
+//    entity tag, predicted damage and a confidence,
+//  - an open-addressed index maps entity tag -> newest shot, so events find their shot in O(1),
+//  - the reconciliation window follows the measured shot -> hurt event delay (smoothed mean plus
+//    four deviations, as TCP does for its retransmit timeout) instead of a fixed constant. It bounds
+//    the guess for events without an entity; a tagged event names its shot and matches within the
+//    max window, so a server that slows down still feeds the measurement,
+//  - confident predictions play feedback immediately; the rest wait for the server and play when
+//    it confirms. Played predictions that are never confirmed are counted as mispredictions.
+//
+// Times are seconds on any monotonic clock. No engine / Windows dependencies.
+// ------------------------------------------------------------
+
+struct HitLedgerShot
+{
+	uint32_t serial = 0;
+	double firedAt = 0.0;
+	float impact[3] = {};
+	std::uintptr_t entityTag = 0;
+	float predictedDamage = 0.0f;
+	float confidence = 0.0f;
+	bool hasImpact = false;
+	bool predictedLethal = false;
+	bool feedbackPlayed = false;    // hit feedback given, predicted or late
+	bool confirmed = false;         // a hurt event matched it
+	bool consumed = false;          // a kill was credited to it
+	bool audited = false;           // counted by Expire
+};
+
+class HitFeedbackLedger
+{
+public:
+	static constexpr int kCapacity = 64;            // shots; power of two
+	static constexpr int kIndexSize = 256;          // tag index slots; power of two, 4x kCapacity
+
+	struct Counters
+	{
+		uint64_t shots = 0;
+		uint64_t predicted = 0;         // feedback played at the shot
+		uint64_t late = 0;              // feedback played when the server confirmed
+		uint64_t confirmed = 0;
+		uint64_t mispredicted = 0;      // played, never confirmed within the window
+		uint64_t kills = 0;
+	};
+
+	HitFeedbackLedger() { Reset(); }
+
+	void Reset()
+	{
+		for (HitLedgerShot& s : m_Shots)
+			s = HitLedgerShot{};
+		ClearIndex();
+		m_NextSerial = 1;
+		m_LastSerial = 0;
+	}
+
+	// Window bounds in seconds. The window itself is measured; max also applies before the first sample.
+	void SetWindowBounds(float minSeconds, float maxSeconds)
+	{
+		m_MinWindow = std::max(0.01f, minSeconds);
+		m_MaxWindow = std::max(m_MinWindow, maxSeconds);
+	}
+
+	void SetConfidenceThreshold(float threshold) { m_ConfidenceThreshold = std::clamp(threshold, 0.0f, 1.01f); }
+
+	// Shot -> first hurt event delay, smoothed mean + 4 deviations, inside the bounds.
+	float GetWindowSeconds() const
+	{
+		if (m_SmoothedDelay < 0.0f)
+			return m_MaxWindow;
+		return std::clamp(m_SmoothedDelay + 4.0f * m_DelayDeviation + kWindowMargin, m_MinWindow, m_MaxWindow);
+	}
+
+	float GetMaxWindowSeconds() const { return m_MaxWindow; }
+	float GetSmoothedDelaySeconds() const { return m_SmoothedDelay; }
+	const Counters& GetCounters() const { return m_Counters; }
+
+	uint32_t BeginShot(double now)
+	{
+		const uint32_t serial = m_NextSerial++;
+		if (m_NextSerial == 0)
+			m_NextSerial = 1;
+
+		HitLedgerShot& s = Slot(serial);
+		Audit(s);
+		s = HitLedgerShot{};
+		s.serial = serial;
+		s.firedAt = now;
+		m_LastSerial = serial;
+		++m_Counters.shots;
+		return serial;
+	}
+
+	// The shot with this serial while it is still in the ring, else nullptr.
+	const HitLedgerShot* Find(uint32_t serial) const
+	{
+		if (serial == 0)
+			return nullptr;
+		const HitLedgerShot& s = m_Shots[serial & kMask];
+		return s.serial == serial ? &s : nullptr;
+	}
+
+	uint32_t GetLastSerial() const { return m_LastSerial; }
+
+	// Attaches the traced impact to a shot. True when feedback should play right now: the prediction
+	// is confident enough and nothing has been played for this shot yet.
+	bool RecordImpact(uint32_t serial, std::uintptr_t entityTag, const float impact[3], float predictedDamage, bool predictedLethal, float confidence)
+	{
+		HitLedgerShot* s = FindMutable(serial);
+		if (!s || entityTag == 0)
+			return false;
+
+		s->entityTag = entityTag;
+		s->impact[0] = impact[0];
+		s->impact[1] = impact[1];
+		s->impact[2] = impact[2];
+		s->predictedDamage = predictedDamage;
+		s->predictedLethal = predictedLethal;
+		s->confidence = confidence;
+		s->hasImpact = true;
+		IndexInsert(entityTag, serial);
+
+		if (s->feedbackPlayed || confidence < m_ConfidenceThreshold)
+			return false;
+		s->feedbackPlayed = true;
+		++m_Counters.predicted;
+		return true;
+	}
+
+	// A hurt event from the server. Returns the shot it belongs to (the newest shot on entityTag inside
+	// the max window, or for an unknown tag the newest shot with an impact inside the measured window),
+	// else nullptr. outPlayLate is set when that shot's feedback wasn't played yet; it is marked played.
+	const HitLedgerShot* ConfirmHit(std::uintptr_t entityTag, double now, bool& outPlayLate)
+	{
+		outPlayLate = false;
+		HitLedgerShot* s = entityTag != 0 ? FindByTag(entityTag, now, m_MaxWindow, false) : nullptr;
+		if (!s)
+			s = FindNewest(now, GetWindowSeconds(), false, [](const HitLedgerShot&) { return true; });
+		if (!s)
+			return nullptr;
+
+		if (!s->confirmed)
+		{
+			s->confirmed = true;
+			++m_Counters.confirmed;
+			AddDelaySample(static_cast<float>(now - s->firedAt));
+		}
+		if (!s->feedbackPlayed)
+		{
+			s->feedbackPlayed = true;
+			outPlayLate = true;
+			++m_Counters.late;
+		}
+		return s;
+	}
+
+	// Is there a shot a kill on entityTag (0 = any) could be credited to? Kills use the max window:
+	// the kill counters that trigger the credit can trail the events.
+	bool HasKillCandidate(std::uintptr_t entityTag, double now)
+	{
+		if (entityTag != 0)
+			return FindByTag(entityTag, now, m_MaxWindow, true) != nullptr;
+		return FindNewest(now, m_MaxWindow, true, [](const HitLedgerShot&) { return true; }) != nullptr;
+	}
+
+	// Credits a kill: the newest unconsumed shot on entityTag, or for entityTag 0 the newest shot
+	// prefer() accepts, else the newest shot. The shot can't be credited again.
+	template <typename Prefer>
+	const HitLedgerShot* ConsumeKill(std::uintptr_t entityTag, double now, Prefer&& prefer)
+	{
+		HitLedgerShot* s = nullptr;
+		if (entityTag != 0)
+		{
+			s = FindByTag(entityTag, now, m_MaxWindow, true);
+		}
+		else
+		{
+			s = FindNewest(now, m_MaxWindow, true, prefer);
+			if (!s)
+				s = FindNewest(now, m_MaxWindow, true, [](const HitLedgerShot&) { return true; });
+		}
+		if (!s)
+			return nullptr;
+		s->consumed = true;
+		++m_Counters.kills;
+		return s;
+	}
+
+	// Audits shots that left the window. Cheap enough to call every frame.
+	void Expire(double now)
+	{
+		const float window = m_MaxWindow;
+		for (HitLedgerShot& s : m_Shots)
+		{
+			if (s.serial != 0 && !s.audited && now - s.firedAt > window)
+				Audit(s);
+		}
+	}
+
+private:
+	static constexpr uint32_t kMask = kCapacity - 1;
+	static constexpr uint32_t kIndexMask = kIndexSize - 1;
+	static constexpr float kWindowMargin = 0.05f;
+	static_assert((kCapacity & (kCapacity - 1)) == 0 && (kIndexSize & (kIndexSize - 1)) == 0, "power of two");
+
+	struct IndexEntry
+	{
+		std::uintptr_t tag = 0;
+		uint32_t serial = 0;
+	};
+
+	HitLedgerShot& Slot(uint32_t serial) { return m_Shots[serial & kMask]; }
+
+	HitLedgerShot* FindMutable(uint32_t serial)
+	{
+		if (serial == 0)
+			return nullptr;
+		HitLedgerShot& s = m_Shots[serial & kMask];
+		return s.serial == serial ? &s : nullptr;
+	}
+
+	void Audit(HitLedgerShot& s)
+	{
+		if (s.serial != 0 && !s.audited && s.feedbackPlayed && !s.confirmed && !s.consumed)
+			++m_Counters.mispredicted;
+		s.audited = true;
+	}
+
+	void AddDelaySample(float delay)
+	{
+		if (!(delay >= 0.0f) || delay > 5.0f)
+			return;
+		if (m_SmoothedDelay < 0.0f)
+		{
+			m_SmoothedDelay = delay;
+			m_DelayDeviation = delay * 0.5f;
+			return;
+		}
+		m_DelayDeviation += 0.25f * (std::fabs(delay - m_SmoothedDelay) - m_DelayDeviation);
+		m_SmoothedDelay += 0.125f * (delay - m_SmoothedDelay);
+	}
+
+	static size_t HashTag(std::uintptr_t tag)
+	{
+		uint64_t h = static_cast<uint64_t>(tag);
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		return static_cast<size_t>(h);
+	}
+
+	void ClearIndex()
+	{
+		for (IndexEntry& e : m_Index)
+			e = IndexEntry{};
+		m_IndexUsed = 0;
+	}
+
+	// An index entry is live while the ring still holds its shot with the same tag.
+	bool IsLive(const IndexEntry& e) const
+	{
+		const HitLedgerShot* s = Find(e.serial);
+		return s && s->entityTag == e.tag;
+	}
+
+	void IndexInsert(std::uintptr_t tag, uint32_t serial)
+	{
+		// Stale entries are never removed (that would break probe chains); at 3/4 load, rebuild from
+		// the live ring. At most kCapacity entries survive, so rebuilds are 128+ inserts apart.
+		if (m_IndexUsed >= kIndexSize * 3 / 4)
+			RebuildIndex();
+
+		size_t i = HashTag(tag) & kIndexMask;
+		for (int probe = 0; probe < kIndexSize; ++probe, i = (i + 1) & kIndexMask)
+		{
+			IndexEntry& e = m_Index[i];
+			if (e.tag == tag)
+			{
+				e.serial = serial;
+				return;
+			}
+			if (e.tag == 0)
+			{
+				e.tag = tag;
+				e.serial = serial;
+				++m_IndexUsed;
+				return;
+			}
+		}
+	}
+
+	void RebuildIndex()
+	{
+		ClearIndex();
+		// Oldest first so the newest shot per tag wins.
+		const uint32_t newest = m_LastSerial;
+		for (uint32_t k = kCapacity; k > 0; --k)
+		{
+			const uint32_t serial = newest - (k - 1);
+			const HitLedgerShot* s = Find(serial);
+			if (!s || !s->hasImpact)
+				continue;
+			size_t i = HashTag(s->entityTag) & kIndexMask;
+			while (m_Index[i].tag != 0 && m_Index[i].tag != s->entityTag)
+				i = (i + 1) & kIndexMask;
+			if (m_Index[i].tag == 0)
+				++m_IndexUsed;
+			m_Index[i] = { s->entityTag, serial };
+		}
+	}
+
+	HitLedgerShot* FindByTag(std::uintptr_t tag, double now, float window, bool skipConsumed)
+	{
+		size_t i = HashTag(tag) & kIndexMask;
+		for (int probe = 0; probe < kIndexSize; ++probe, i = (i + 1) & kIndexMask)
+		{
+			const IndexEntry& e = m_Index[i];
+			if (e.tag == 0)
+				return nullptr;
+			if (e.tag != tag)
+				continue;
+			if (!IsLive(e))
+				return nullptr;
+			HitLedgerShot* s = FindMutable(e.serial);
+			if (now - s->firedAt > window || (skipConsumed && s->consumed))
+				return nullptr;
+			return s;
+		}
+		return nullptr;
+	}
+
+	// Newest first; stops at the first shot older than the window.
+	template <typename Pred>
+	HitLedgerShot* FindNewest(double now, float window, bool skipConsumed, Pred&& pred)
+	{
+		for (uint32_t k = 0; k < kCapacity; ++k)
+		{
+			HitLedgerShot* s = FindMutable(m_LastSerial - k);
+			if (!s || now - s->firedAt > window)
+				return nullptr;
+			if (!s->hasImpact || (skipConsumed && s->consumed))
+				continue;
+			if (pred(*s))
+				return s;
+		}
+		return nullptr;
+	}
+
+	HitLedgerShot m_Shots[kCapacity];
+	IndexEntry m_Index[kIndexSize];
+	int m_IndexUsed = 0;
+	uint32_t m_NextSerial = 1;
+	uint32_t m_LastSerial = 0;
+	float m_MinWindow = 0.1f;
+	float m_MaxWindow = 0.75f;
+	float m_ConfidenceThreshold = 0.6f;
+	float m_SmoothedDelay = -1.0f;
+	float m_DelayDeviation = 0.0f;
+	Counters m_Counters;
+};
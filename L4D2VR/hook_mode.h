@@ -0,0 +1,158 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// ------------------------------------------------------------
+// Hook dispatch mode.
+//
+// The hot detours (DrawModelExecute, CalcViewModelView, the HUD render-target hooks, the ConVar
+// SetValue family) used to work out on every call whether there was anything to do, each with its
+// own flag checks and a GetMatQueueMode() vtable call, even in the main menu or with VR off. The
+// answer is now computed once per frame and published for every thread:
+//  - HookMode is the kind of frame: Off (VR not running), Menu (no map loaded), InGame1P / InGame3P,
+//    or Queued (in a map with mat_queue_mode != 0, render hooks may run on the material thread),
+//  - HookFrameState adds the engine thread mode and whether the ConVar write guards are armed,
+//  - HookModeState packs it into one 32-bit atomic, so a reader never sees half of an update,
+//  - RequiredHookGroups() names the groups of detours that have work to do; the others can be
+//    disabled outright until the state changes.
+// No engine / Windows dependencies.
+// ------------------------------------------------------------
+
+enum class HookMode : uint8_t
+{
+	Off,
+	Menu,
+	InGame1P,
+	InGame3P,
+	Queued,
+};
+
+struct HookModeInputs
+{
+	bool vrEnabled = false;
+	bool inGame = false;
+	bool thirdPerson = false;
+	int matQueueMode = 0;
+	bool blockConVarWrites = true;
+	bool traceConVarWrites = true;
+};
+
+struct HookFrameState
+{
+	HookMode mode = HookMode::Off;
+	int queueMode = 0;                // engine thread mode (0 single, 1 queued single, 2 queued multicore)
+	bool thirdPerson = false;
+	bool blockConVarWrites = true;    // until the first publish every ConVar write is checked
+	bool traceConVarWrites = true;
+
+	bool IsVRActive() const { return mode != HookMode::Off; }
+	bool IsInGame() const { return mode == HookMode::InGame1P || mode == HookMode::InGame3P || mode == HookMode::Queued; }
+	bool WatchesConVarWrites() const { return blockConVarWrites || traceConVarWrites; }
+	// In a map the render detours and the pose waiter branch on the thread mode, so a mat_queue_mode
+	// write has to reach the cache at once. Entering a map invalidates the cache anyway, and outside
+	// one the cache's once-a-second re-read is enough.
+	bool WatchesQueueModeWrites() const { return IsInGame(); }
+};
+
+inline int ClampQueueMode(int matQueueMode)
+{
+	return (matQueueMode < 0) ? 0 : (matQueueMode > 2 ? 2 : matQueueMode);
+}
+
+inline HookMode ComputeHookMode(bool vrEnabled, bool inGame, bool thirdPerson, int matQueueMode)
+{
+	if (!vrEnabled)
+		return HookMode::Off;
+	if (!inGame)
+		return HookMode::Menu;
+	if (matQueueMode != 0)
+		return HookMode::Queued;
+	return thirdPerson ? HookMode::InGame3P : HookMode::InGame1P;
+}
+
+inline HookFrameState ComputeHookFrameState(const HookModeInputs& in)
+{
+	HookFrameState state;
+	state.queueMode = ClampQueueMode(in.matQueueMode);
+	state.mode = ComputeHookMode(in.vrEnabled, in.inGame, in.thirdPerson, state.queueMode);
+	state.thirdPerson = in.thirdPerson;
+	state.blockConVarWrites = in.blockConVarWrites;
+	state.traceConVarWrites = in.traceConVarWrites;
+	return state;
+}
+
+enum HookGroup : uint32_t
+{
+	kHookGroupVRRender = 1u << 0,       // viewmodel, model draw and HUD capture detours
+	kHookGroupConVarWrite = 1u << 1,    // IConVar::SetValue (block + trace, mat_queue_mode writes)
+	kHookGroupConVarTrace = 1u << 2,    // ConVar::SetValue / InternalSetValue (trace only)
+	kHookGroupAll = kHookGroupVRRender | kHookGroupConVarWrite | kHookGroupConVarTrace,
+};
+
+// Render detours stay installed in Menu: the first in-game frame runs them before the next publish.
+inline uint32_t RequiredHookGroups(const HookFrameState& state)
+{
+	uint32_t groups = 0;
+	if (state.IsVRActive())
+		groups |= kHookGroupVRRender;
+	// IConVar::SetValue also reports mat_queue_mode writes to the thread-mode cache.
+	if (state.WatchesConVarWrites() || state.WatchesQueueModeWrites())
+		groups |= kHookGroupConVarWrite;
+	if (state.traceConVarWrites)
+		groups |= kHookGroupConVarTrace;
+	return groups;
+}
+
+class HookModeState
+{
+public:
+	HookFrameState Load() const { return Unpack(m_Packed.load(std::memory_order_acquire)); }
+
+	// Returns the state that was published before.
+	HookFrameState Publish(const HookFrameState& state)
+	{
+		return Unpack(m_Packed.exchange(Pack(state), std::memory_order_acq_rel));
+	}
+
+	// The engine switches thread mode at a frame boundary; the thread-mode cache pushes transitions
+	// here (queue mode, and Queued vs InGame) without waiting for the next full publish.
+	void PublishQueueMode(int matQueueMode)
+	{
+		uint32_t expected = m_Packed.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			HookFrameState state = Unpack(expected);
+			const int queueMode = ClampQueueMode(matQueueMode);
+			if (state.queueMode == queueMode)
+				return;
+			state.queueMode = queueMode;
+			if (state.IsInGame())
+				state.mode = ComputeHookMode(true, true, state.thirdPerson, queueMode);
+			if (m_Packed.compare_exchange_weak(expected, Pack(state), std::memory_order_acq_rel, std::memory_order_relaxed))
+				return;
+		}
+	}
+
+	static uint32_t Pack(const HookFrameState& state)
+	{
+		return static_cast<uint32_t>(state.mode)
+			| (static_cast<uint32_t>(state.queueMode & 0x3) << 4)
+			| (state.thirdPerson ? 1u << 8 : 0u)
+			| (state.blockConVarWrites ? 1u << 9 : 0u)
+			| (state.traceConVarWrites ? 1u << 10 : 0u);
+	}
+
+	static HookFrameState Unpack(uint32_t packed)
+	{
+		HookFrameState state;
+		state.mode = static_cast<HookMode>(packed & 0xF);
+		state.queueMode = static_cast<int>((packed >> 4) & 0x3);
+		state.thirdPerson = (packed & (1u << 8)) != 0;
+		state.blockConVarWrites = (packed & (1u << 9)) != 0;
+		state.traceConVarWrites = (packed & (1u << 10)) != 0;
+		return state;
+	}
+
+private:
+	std::atomic<uint32_t> m_Packed{ Pack(HookFrameState{}) };
+};
@@ -7,6 +7,7 @@
 #include "vr.h"
 #include "trace.h"
 #include "offsets.h"
+#include "camera_interpolator.h"
 #include <iostream>
 #include <cstdint>
 #include <string>
@@ -47,8 +48,9 @@ static inline void NormalizeAndClampViewAngles(QAngle& a)
 // that updates at tick rate (30/60Hz) while we still render at HMD rate (90Hz+).
 // That produces a "feels like 30fps" stutter even when frametime is stable.
 //
-// We blend from prev tick camera to curr tick camera over an estimated tick interval.
-// Only enabled when tick interval > ~16ms (~<60Hz) to avoid adding lag to 90Hz paths.
+// CameraInterpolator keeps the recent tick cameras and evaluates a Hermite curve through them
+// slightly behind render time (see camera_interpolator.h). Only enabled when the engine updates
+// slower than we render, so 90Hz paths get no added lag.
 // ------------------------------------------------------------
 static inline float AngleDeltaDeg(float to, float from)
 {
@@ -58,11 +60,6 @@ static inline float AngleDeltaDeg(float to, float from)
 	return delta;
 }
 
-static inline float AngleLerpDeg(float a, float b, float t)
-{
-	return a + AngleDeltaDeg(b, a) * t;
-}
-
 // Returns true if the call should be skipped because we ran it too recently.
 static inline bool ShouldThrottleLog(std::chrono::steady_clock::time_point& last, float maxHz)
 {
@@ -179,95 +176,51 @@ static inline bool IsReadableMemoryRange(const void* ptr, size_t bytes)
 
 	return true;
 }
-static inline float SmoothStep01(float t)
+struct EngineCameraSmoother
 {
-	t = std::clamp(t, 0.0f, 1.0f);
-	return t * t * (3.0f - 2.0f * t);
-}
+	CameraInterpolator interp;
 
-struct EngineThirdPersonCamSmoother
-{
-	bool valid = false;
-	Vector prevOrigin{ 0,0,0 };
-	Vector currOrigin{ 0,0,0 };
-	QAngle prevAngles{ 0,0,0 };
-	QAngle currAngles{ 0,0,0 };
-	std::chrono::steady_clock::time_point lastRawUpdate{};
-	std::chrono::steady_clock::time_point blendStart{};
-	float tickIntervalSec = (1.0f / 30.0f); // pessimistic default
+	static double NowSeconds()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void Configure(float delayTicks, float maxExtrapolateTicks)
+	{
+		CameraInterpolatorSettings settings = interp.GetSettings();
+		settings.delayTicks = delayTicks;
+		settings.maxExtrapolateTicks = maxExtrapolateTicks;
+		interp.Configure(settings);
+	}
 
 	void Reset()
 	{
-		valid = false;
+		interp.Reset();
 	}
 
 	void PushRaw(const Vector& rawOrigin, const QAngle& rawAngles)
 	{
-		const auto now = std::chrono::steady_clock::now();
-
-		if (!valid)
-		{
-			valid = true;
-			prevOrigin = currOrigin = rawOrigin;
-			prevAngles = currAngles = rawAngles;
-			lastRawUpdate = now;
-			blendStart = now;
-			return;
-		}
-
-		// Detect a new tick camera sample.
-		const float posDeltaSqr = (rawOrigin - currOrigin).LengthSqr();
-		const float angDelta =
-			std::fabs(AngleDeltaDeg(rawAngles.x, currAngles.x)) +
-			std::fabs(AngleDeltaDeg(rawAngles.y, currAngles.y)) +
-			std::fabs(AngleDeltaDeg(rawAngles.z, currAngles.z));
-		const bool changed = (posDeltaSqr > (0.25f * 0.25f)) || (angDelta > 0.25f);
-
-		if (changed)
-		{
-			const float dt = std::chrono::duration<float>(now - lastRawUpdate).count();
-			const float clamped = std::clamp(dt, 0.008f, 0.100f);
-			tickIntervalSec = (tickIntervalSec * 0.8f) + (clamped * 0.2f);
-
-			prevOrigin = currOrigin;
-			prevAngles = currAngles;
-			currOrigin = rawOrigin;
-			currAngles = rawAngles;
-			lastRawUpdate = now;
-			blendStart = now;
-		}
+		CameraPose pose;
+		pose.origin[0] = rawOrigin.x; pose.origin[1] = rawOrigin.y; pose.origin[2] = rawOrigin.z;
+		pose.angles[0] = rawAngles.x; pose.angles[1] = rawAngles.y; pose.angles[2] = rawAngles.z;
+		interp.Push(NowSeconds(), pose);
 	}
 
 	bool ShouldSmooth() const
 	{
-		// Only smooth when camera updates are slower than ~60Hz.
-		return valid && (tickIntervalSec > 0.016f);
+		return interp.ShouldSmooth();
+	}
+
+	float GetTickIntervalSec() const
+	{
+		return interp.GetTickInterval();
 	}
 
 	void GetSmoothed(Vector& outOrigin, QAngle& outAngles) const
 	{
-		if (!valid)
-		{
-			outOrigin = { 0,0,0 };
-			outAngles = { 0,0,0 };
-			return;
-		}
-
-		if (!ShouldSmooth())
-		{
-			outOrigin = currOrigin;
-			outAngles = currAngles;
-			return;
-		}
-
-		const auto now = std::chrono::steady_clock::now();
-		const float tRaw = std::chrono::duration<float>(now - blendStart).count() / std::max(0.001f, tickIntervalSec);
-		const float t = SmoothStep01(tRaw);
-
-		outOrigin = prevOrigin + (currOrigin - prevOrigin) * t;
-		outAngles.x = AngleLerpDeg(prevAngles.x, currAngles.x, t);
-		outAngles.y = AngleLerpDeg(prevAngles.y, currAngles.y, t);
-		outAngles.z = AngleLerpDeg(prevAngles.z, currAngles.z, t);
+		const CameraPose pose = interp.Evaluate(NowSeconds());
+		outOrigin = { pose.origin[0], pose.origin[1], pose.origin[2] };
+		outAngles = { pose.angles[0], pose.angles[1], pose.angles[2] };
 	}
 };
 
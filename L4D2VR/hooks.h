@@ -5,6 +5,7 @@
 #include <typeinfo>
 
 #include "MinHook.h"
+#include "hook_mode.h"
 
 // We call Game::logMsg / Game::errorMsg here, so we need the full declaration.
 #include "game.h"
@@ -67,6 +68,22 @@ struct Hook
 		isEnabled = false;
 		return 0;
 	}
+
+	// Queues an enable/disable; MH_ApplyQueued() then patches every queued hook in one thread freeze.
+	int queueHookState(bool enable)
+	{
+		if (!pTarget || isEnabled == enable)
+			return 0;
+
+		const MH_STATUS status = enable ? MH_QueueEnableHook(pTarget) : MH_QueueDisableHook(pTarget);
+		if (status != MH_OK)
+		{
+			Game::errorMsg(enable ? "Failed to queue hook enable" : "Failed to queue hook disable");
+			return 1;
+		}
+		isEnabled = enable;
+		return 0;
+	}
 };
 
 
@@ -152,6 +169,12 @@ public:
 	static inline Hook<tConVarInternalSetValueInt> hkConVarInternalSetValueInt;
 	static bool s_ServerUnderstandsVR;
 
+	// Published once per frame (see hook_mode.h); hot detours switch on it before doing any VR work.
+	static inline HookModeState s_HookMode;
+	static inline uint32_t s_EnabledHookGroups = kHookGroupAll;
+	// IConVar of mat_queue_mode; writes through it invalidate Game's cached thread mode.
+	static inline const void* s_MatQueueModeIConVar = nullptr;
+
 	Hooks() {};
 	Hooks(Game* game);
 
@@ -159,6 +182,10 @@ public:
 
 	int initSourceHooks();
 
+	// Recomputes the hook mode from VR / engine state and enables only the detour groups it needs.
+	static void UpdateHookMode();
+	static void SetHookGroupsEnabled(uint32_t groups);
+
 	// Detour functions
 	static ITexture* __fastcall dGetRenderTarget(void* ecx, void* edx);
 	static void __fastcall dRenderView(void* ecx, void* edx, CViewSetup& setup, CViewSetup& hudViewSetup, int nClearFlags, int whatToDraw);
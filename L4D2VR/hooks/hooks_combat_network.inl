@@ -21,12 +21,16 @@ static inline void CallCalcViewModelViewOriginal(void* ecx, void* owner, const V
 
 void __fastcall Hooks::dCalcViewModelView(void* ecx, void* edx, void* owner, const Vector& eyePosition, const QAngle& eyeAngles)
 {
+	const HookFrameState hookState = s_HookMode.Load();
+	if (!hookState.IsInGame())
+		return hkCalcViewModelView.fOriginal(ecx, owner, eyePosition, eyeAngles);
+
 	Vector vecNewOrigin = eyePosition;
 	QAngle vecNewAngles = eyeAngles;
 
 	if (m_VR->m_IsVREnabled)
 	{
-		const int queueMode = (m_Game != nullptr) ? m_Game->GetMatQueueMode() : 0;
+		const int queueMode = hookState.queueMode;
 		const bool multiCoreQueued = (queueMode == 2);
 		const bool forceDisableMoveBob = m_VR->m_ViewmodelDisableMoveBob;
 
@@ -798,11 +802,35 @@ int Hooks::dServerFireTerrorBullets(int playerId, const Vector& vecOrigin, const
 			vecNewAngles = m_VR->GetRightControllerAbsAngle();
 		}
 	}
-	// Clients
-	else if (m_Game->IsValidPlayerIndex(playerId) && m_Game->m_PlayersVRInfo[playerId].isUsingVR)
+	// Clients (a client whose right hand is unavailable shoots from the engine's eye / aim)
+	else if (m_Game->IsValidPlayerIndex(playerId) && m_Game->m_PlayersVRInfo[playerId].HasRightHand())
 	{
-		vecNewOrigin = m_Game->m_PlayersVRInfo[playerId].controllerPos;
-		vecNewAngles = m_Game->m_PlayersVRInfo[playerId].controllerAngle;
+		const Player& info = m_Game->m_PlayersVRInfo[playerId];
+		// Relative poses are offsets from the origin the player has while the shot's command runs,
+		// i.e. the live origin, not the one they were resolved against when the batch was read.
+		const Vector anchor = info.serverEntity
+			? *(Vector*)((uintptr_t)info.serverEntity + 0x2CC)
+			: info.controllerPos - info.controllerOffset;
+		vecNewOrigin = info.hasRelativePoses ? anchor + info.controllerOffset : info.controllerPos;
+		vecNewAngles = info.controllerAngle;
+
+		// The shot's command ran after its whole batch was read: rewind the hand by the player's
+		// measured lag (or the configured one) instead of using the newest command's pose.
+		const float lagTicks = (m_VR->m_ServerShotPoseLagTicks < 0.0f)
+			? m_Game->m_VRServerState.MeasuredLagTicks(playerId)
+			: m_VR->m_ServerShotPoseLagTicks;
+		int newestTick = 0;
+		VRServerStateSample shot;
+		if (lagTicks > 0.0f
+			&& m_Game->m_VRServerState.LatestTick(playerId, newestTick)
+			&& m_Game->m_VRServerState.SampleAtTick(playerId, (float)newestTick - lagTicks, shot)
+			&& shot.pose[VRCmdPose_RightHand].valid)
+		{
+			const VRCmdPoseSample& hand = shot.pose[VRCmdPose_RightHand];
+			const Vector pos(hand.pos[0], hand.pos[1], hand.pos[2]);
+			vecNewOrigin = (shot.flags & VRServerSample_Relative) ? anchor + pos : pos;
+			VRCmdPayloadCodec::QuatToAngles(hand.quat, vecNewAngles.x, vecNewAngles.y, vecNewAngles.z);
+		}
 	}
 
 	return hkServerFireTerrorBullets.fOriginal(playerId, vecNewOrigin, vecNewAngles, a4, a5, a6, a7);
@@ -1064,7 +1092,475 @@ int Hooks::dClientFireTerrorBullets(
 }
 
 
+// ---- VR usercmd payload v2 helpers (see vr_usercmd_payload.h) ----
+static inline VRCmdCarrier ReadVRCmdCarrier(const CUserCmd* cmd)
+{
+	VRCmdCarrier carrier;
+	std::memcpy(&carrier.viewZBits, &cmd->viewangles.z, sizeof(carrier.viewZBits));
+	std::memcpy(&carrier.upmoveBits, &cmd->upmove, sizeof(carrier.upmoveBits));
+	carrier.mouseDx = cmd->mousedx;
+	carrier.mouseDy = cmd->mousedy;
+	return carrier;
+}
+
+static inline void WriteVRCmdCarrier(CUserCmd* cmd, const VRCmdCarrier& carrier)
+{
+	std::memcpy(&cmd->viewangles.z, &carrier.viewZBits, sizeof(carrier.viewZBits));
+	std::memcpy(&cmd->upmove, &carrier.upmoveBits, sizeof(carrier.upmoveBits));
+	cmd->mousedx = carrier.mouseDx;
+	cmd->mousedy = carrier.mouseDy;
+}
+
+static inline VRCmdPoseSample MakeVRCmdPoseSample(const Vector& absPos, const QAngle& absAng, const Vector& playerOrigin)
+{
+	VRCmdPoseSample sample;
+	sample.valid = true;
+	sample.pos[0] = absPos.x - playerOrigin.x;
+	sample.pos[1] = absPos.y - playerOrigin.y;
+	sample.pos[2] = absPos.z - playerOrigin.z;
+	VRCmdPayloadCodec::AnglesToQuat(absAng.x, absAng.y, absAng.z, sample.quat);
+	return sample;
+}
+
+static inline void ReadVRCmdPose(const VRCmdQuantizedPose& q, Vector& outOffset, QAngle& outAngle)
+{
+	const VRCmdPoseSample sample = VRCmdPayloadCodec::Dequantize(q);
+	outOffset = Vector(sample.pos[0], sample.pos[1], sample.pos[2]);
+	VRCmdPayloadCodec::QuatToAngles(sample.quat, outAngle.x, outAngle.y, outAngle.z);
+}
+
+// Payload v2 positions are relative to the player origin; turn them into world positions.
+static inline void ResolvePlayerVRPoses(Player& info, Server_BaseEntity* ent)
+{
+	if (!info.hasRelativePoses || !ent)
+		return;
+	const Vector origin = *(Vector*)((uintptr_t)ent + 0x2CC);
+	if (info.hasRightController)
+		info.controllerPos = origin + info.controllerOffset;
+	if (info.hasLeftController)
+		info.leftControllerPos = origin + info.leftControllerOffset;
+	if (info.hasHmd)
+		info.hmdPos = origin + info.hmdOffset;
+}
+
+// Appends the pose just decoded for command `move` to the player's server-side history.
+static inline void RecordVRServerState(int index, const CUserCmd* move)
+{
+	const Player& info = Hooks::m_Game->m_PlayersVRInfo[index];
+	VRServerStateSample sample;
+	sample.commandNumber = move->command_number;
+	sample.tick = move->tick_count;
+	sample.flags = static_cast<uint8_t>((info.isMeleeing ? VRServerSample_Melee : 0) | (info.hasRelativePoses ? VRServerSample_Relative : 0));
+
+	auto setPose = [&](VRCmdPoseSlot slot, bool valid, const Vector& pos, const QAngle& ang)
+		{
+			VRCmdPoseSample& pose = sample.pose[slot];
+			pose.valid = valid;
+			pose.pos[0] = pos.x;
+			pose.pos[1] = pos.y;
+			pose.pos[2] = pos.z;
+			VRCmdPayloadCodec::AnglesToQuat(ang.x, ang.y, ang.z, pose.quat);
+		};
+	if (info.hasRelativePoses)
+	{
+		setPose(VRCmdPose_RightHand, info.hasRightController, info.controllerOffset, info.controllerAngle);
+		setPose(VRCmdPose_LeftHand, info.hasLeftController, info.leftControllerOffset, info.leftControllerAngle);
+		setPose(VRCmdPose_Hmd, info.hasHmd, info.hmdOffset, info.hmdAngle);
+	}
+	else
+	{
+		setPose(VRCmdPose_RightHand, true, info.controllerPos, info.controllerAngle);
+	}
+	Hooks::m_Game->m_VRServerState.Push(index, sample);
+}
+
+// ---- Swept melee broad phase (see melee_sweep.h) ----
+static inline MeleeSweepVec3 ToMeleeSweepVec(const Vector& v)
+{
+	return { v.x, v.y, v.z };
+}
+
+// 0 = not a melee target; otherwise the bounding radius scale (doors / props are larger than characters).
+// Server map classnames. Brush breakables (func_breakable, func_breakable_surf glass) have no useful
+// origin; the world probe in MeleeSweepWorldProbe finds them along with walls.
+static inline float MeleeSweepTargetScale(const char* className)
+{
+	if (!className)
+		return 0.0f;
+	if (std::strcmp(className, "infected") == 0 || std::strcmp(className, "witch") == 0
+		|| std::strcmp(className, "player") == 0)
+		return 1.0f;
+	if (std::strncmp(className, "prop_door_rotating", 18) == 0 || std::strncmp(className, "prop_physics", 12) == 0
+		|| std::strcmp(className, "prop_dynamic") == 0 || std::strcmp(className, "prop_car_alarm") == 0
+		|| std::strcmp(className, "prop_fuel_barrel") == 0 || std::strcmp(className, "func_physbox") == 0
+		|| std::strncmp(className, "weapon_", 7) == 0)
+		return 2.0f;
+	return 0.0f;
+}
+
+// Server edicts are one array indexed by entity index (ProcessUsercmds hands us the player's, so the
+// array starts at player - index). Free edicts and networkable-only ones have no entity behind them.
+static constexpr int kMaxServerEdicts = 2048;
+static constexpr int kEdictFree = 1 << 1;   // FL_EDICT_FREE
+static_assert(sizeof(edict_t) == 20, "edict_t layout");
+
+// Melee targets from the server's own entities, gridded once per server frame: every command of every
+// swinging player in that frame queries the grid instead of walking all edicts. Players moved by
+// commands processed earlier in the same frame are at most a frame's movement off, well inside the
+// candidate radius. Without the server globals it re-grids on every call, as the edict walk did.
+enum MeleeSweepTargetTag : uint32_t
+{
+	MeleeSweepTarget_Character = 1u << 0,
+	MeleeSweepTarget_Large = 1u << 1,
+};
+
+struct MeleeSweepServerTargets
+{
+	EntitySpatialHash grid{ kMaxServerEdicts, 128.0f, 8 };
+	int frame = -1;
+	const edict_t* edicts = nullptr;
+	std::vector<EntitySpatialHit> hits;
+};
+
+static MeleeSweepServerTargets& RefreshMeleeSweepTargets(edict_t* edicts)
+{
+	static MeleeSweepServerTargets s_targets;
+	const int frame = Hooks::m_Game->GetServerFrameCount();
+	if (frame >= 0 && frame == s_targets.frame && edicts == s_targets.edicts)
+		return s_targets;
+	s_targets.frame = frame;
+	s_targets.edicts = edicts;
+
+	EntitySpatialHash& grid = s_targets.grid;
+	grid.BeginUpdate();
+	for (int i = 1; edicts && i < kMaxServerEdicts; ++i)
+	{
+		const edict_t& edict = edicts[i];
+		if ((edict.m_fStateFlags & kEdictFree) || !edict.m_pUnk || !edict.m_pNetworkable)
+			continue;
+		Server_BaseEntity* ent = (Server_BaseEntity*)edict.m_pUnk->GetBaseEntity();
+		if (!ent)
+			continue;
+		const float scale = MeleeSweepTargetScale(static_cast<IServerNetworkable*>(edict.m_pNetworkable)->GetClassName());
+		if (scale <= 0.0f)
+			continue;
+
+		Vector origin = *(Vector*)((uintptr_t)ent + 0x2CC);
+		// Characters have their origin at the feet; aim the sphere at the torso.
+		if (scale == 1.0f)
+			origin.z += 36.0f;
+		grid.Update(i, { origin.x, origin.y, origin.z }, (scale == 1.0f) ? MeleeSweepTarget_Character : MeleeSweepTarget_Large);
+	}
+	grid.EndUpdate();
+	return s_targets;
+}
+
+static void GatherMeleeSweepCandidates(edict_t* edicts, int playerIndex, const Vector& center, float range,
+	float baseRadius, std::vector<MeleeSweepCandidate>& out)
+{
+	out.clear();
+	MeleeSweepServerTargets& targets = RefreshMeleeSweepTargets(edicts);
+	targets.grid.QueryRadius({ center.x, center.y, center.z }, range,
+		MeleeSweepTarget_Character | MeleeSweepTarget_Large, targets.hits);
+	for (const EntitySpatialHit& hit : targets.hits)
+	{
+		SpatialHashVec3 pos;
+		if (hit.index == playerIndex || !targets.grid.GetPosition(hit.index, pos))
+			continue;
+		MeleeSweepCandidate candidate;
+		candidate.center = { pos.x, pos.y, pos.z };
+		candidate.radius = baseRadius * (targets.grid.GetTags(hit.index) == MeleeSweepTarget_Large ? 2.0f : 1.0f);
+		out.push_back(candidate);
+	}
+}
+
+// World geometry (and brush breakables such as glass) isn't in the candidate list, but a swing into it
+// still needs TestMeleeSwingCollision for the impact effect and sound. Rays along the probe samples
+// (see MeleeSweep::WorldProbeSamples): a hit means the whole plan is traced.
+// The filter works on server handles: it skips the attacking player's own IServerUnknown and keeps
+// everything else, so a character in the way just means tracing the full plan.
+struct MeleeSweepProbeFilter final : public CTraceFilter
+{
+	explicit MeleeSweepProbeFilter(IHandleEntity* attacker) : CTraceFilter(attacker, 0) {}
+	bool ShouldHitEntity(IHandleEntity* entity, int) override { return entity != m_pPassEnt; }
+};
+
+static bool MeleeSweepWorldProbe(IHandleEntity* attacker, const MeleeSweepArc& arc, const MeleeSweepPlan& plan,
+	const int* probes, int probeCount)
+{
+	IEngineTrace* engineTrace = Hooks::m_Game->m_EngineTrace;
+	if (!engineTrace)
+		return true;
+
+	MeleeSweepProbeFilter filter(attacker);
+	const Vector start(arc.origin.x, arc.origin.y, arc.origin.z);
+	for (int p = 0; p < probeCount; ++p)
+	{
+		const MeleeSweepVec3 dir = MeleeSweep::SampleDirection(arc, plan, probes[p]);
+		Ray_t ray;
+		ray.Init(start, start + Vector(dir.x, dir.y, dir.z) * arc.reach);
+		trace_t tr{};
+		__try
+		{
+			engineTrace->TraceRay(ray, MASK_SHOT_HULL, &filter, &tr);
+		}
+		__except (EXCEPTION_EXECUTE_HANDLER)
+		{
+			return true;
+		}
+		if (tr.fraction < 1.0f || tr.startsolid)
+			return true;
+	}
+	return false;
+}
+
+// Roomscale 1:1: move the player by what its jitter buffer releases this frame. dReadUsercmd queues the
+// decoded deltas; this runs from ProcessUsercmds before the packet's commands are simulated, and drains
+// once per server frame however many packets the client's commands arrive in (without the server
+// globals it falls back to once per packet).
+static void ApplyRoomscale1To1ServerMove(int index, Server_BaseEntity* ent)
+{
+	Game* game = Hooks::m_Game;
+	VR* vr = Hooks::m_VR;
+	if (!game || !vr || !game->IsValidPlayerIndex(index))
+		return;
+
+	Player& info = game->m_PlayersVRInfo[index];
+	RoomscaleJitterBuffer& buffer = info.roomscaleBuffer;
+	if (!vr->m_Roomscale1To1Movement || vr->m_ForceNonVRServerMovement)
+	{
+		buffer.Reset();
+		return;
+	}
+
+	const int frame = game->GetServerFrameCount();
+	if (frame >= 0)
+	{
+		if (info.roomscaleDrainFrame == frame)
+			return;
+		info.roomscaleDrainFrame = frame;
+	}
+
+	RoomscaleJitterBuffer::Settings settings;
+	settings.spreadFrames = vr->m_Roomscale1To1ServerSmoothFrames;
+	Vector deltaM;
+	if (!buffer.Drain(settings, deltaM.x, deltaM.y))
+		return;
+	deltaM.z = 0.0f;
+
+	if (!ent || !game->m_EngineTrace || !game->m_Offsets)
+		return;
+	using SetAbsOriginFn = void(__thiscall*)(void*, const Vector&);
+	auto setAbsOrigin = (SetAbsOriginFn)(game->m_Offsets->CBaseEntity_SetAbsOrigin_Server.address);
+	if (!setAbsOrigin)
+		return;
+
+	Vector origin = *(Vector*)((uintptr_t)ent + 0x2CC);
+	Vector deltaU(deltaM.x * vr->m_VRScale, deltaM.y * vr->m_VRScale, 0.0f);
+	Vector target = origin + deltaU;
+
+	Vector mins(-16, -16, 0);
+	Vector maxs(16, 16, 72);
+	// NOTE: Our server entity type is a thin vtable stub; pointer-casting it to IHandleEntity
+	// is not reliable for self-filtering. For 1:1 roomscale we only need world collision here.
+	struct TraceFilterWorldOnly final : public CTraceFilter
+	{
+		TraceFilterWorldOnly() : CTraceFilter(nullptr, 0) {}
+		bool ShouldHitEntity(IHandleEntity*, int) override { return false; }
+		TraceType GetTraceType() const override { return TraceType::TRACE_WORLD_ONLY; }
+	} filter;
+
+	// Lift slightly to avoid rare floor-penetration marking the start as solid.
+	Vector o2 = origin;
+	Vector t2 = target;
+	o2.z += 0.25f;
+	t2.z += 0.25f;
+	Ray_t ray;
+	ray.Init(o2, t2, mins, maxs);
+
+	trace_t tr;
+
+	const unsigned int mask = CONTENTS_SOLID | CONTENTS_MOVEABLE | CONTENTS_GRATE;
+	game->m_EngineTrace->TraceRay(ray, mask, &filter, &tr);
+
+	bool didMove = false;
+	if (!tr.startsolid)
+	{
+		Vector end = tr.endpos;
+		end.z = origin.z; // keep vertical position unchanged (we only apply planar room-scale)
+		setAbsOrigin(ent, end);
+		didMove = true;
+	}
+	// Blocked by the world: don't keep pushing the rest of the queue into the wall.
+	if (tr.startsolid || tr.fraction < 1.0f)
+		buffer.Reset();
+
+	// Hard debug sample: once every 32 applies, no throttle. This tells us whether the server actually moved the entity.
+	static uint32_t s_applyCount = 0;
+	if (vr->m_Roomscale1To1DebugLog && ((++s_applyCount & 31) == 0))
+	{
+		Game::logMsg("[VR][1to1][server] APPLY-SAMPLE player=%d ent=%p setAbsOrigin=%p dM=(%.4f %.4f) origin=(%.2f %.2f %.2f) target=(%.2f %.2f %.2f) end=(%.2f %.2f %.2f) frac=%.3f startsolid=%d didMove=%d",
+			index, (void*)ent, (void*)setAbsOrigin,
+			deltaM.x, deltaM.y,
+			origin.x, origin.y, origin.z,
+			target.x, target.y, target.z,
+			tr.endpos.x, tr.endpos.y, tr.endpos.z,
+			tr.fraction, (int)tr.startsolid, (int)didMove);
+	}
+
+	// Normal throttled "apply" log (separate from pre).
+	if (vr->m_Roomscale1To1DebugLog && !ShouldThrottleLog(vr->m_Roomscale1To1DebugLastServer, vr->m_Roomscale1To1DebugLogHz))
+	{
+		Game::logMsg("[VR][1to1][server] apply player=%d dM=(%.4f %.4f) origin=(%.2f %.2f %.2f) target=(%.2f %.2f %.2f) end=(%.2f %.2f %.2f) frac=%.3f startsolid=%d",
+			index, deltaM.x, deltaM.y, origin.x, origin.y, origin.z, target.x, target.y, target.z, tr.endpos.x, tr.endpos.y, tr.endpos.z, tr.fraction, (int)tr.startsolid);
+	}
+}
+
 // === 用下面这整个函数替换你当前的 Hooks::dProcessUsercmds ===
+// More commands than one usercmd packet carries: the rest of the swing was already swept or is stale.
+static constexpr int kMeleeSweepMaxCommands = 16;
+
+struct MeleeSweepPose
+{
+	Vector pos;
+	QAngle angle;
+};
+
+static inline Vector MeleeSwingDirection(const QAngle& controllerAngle)
+{
+	Vector forward, right, up;
+	QAngle::AngleVectors(controllerAngle, &forward, &right, &up);
+	Vector direction = VectorRotate(forward, right, 50.0f);
+	VectorNormalize(direction);
+	return direction;
+}
+
+// MeleeSweepAdaptive off: the original swing, once per usercmd packet. Ten traces rotated by a tenth
+// of the angle between the previous packet's controller angle and the newest.
+static void RunLegacyMeleeSwing(Server_WeaponCSBase* curWep, void* meleeWepInfo, const QAngle& prevAngle, const QAngle& angle)
+{
+	Vector initialMeleeDirection = MeleeSwingDirection(prevAngle);
+	Vector finalMeleeDirection = MeleeSwingDirection(angle);
+
+	Vector pivot;
+	CrossProduct(initialMeleeDirection, finalMeleeDirection, pivot);
+	VectorNormalize(pivot);
+
+	float swingAngle = acosf(DotProduct(initialMeleeDirection, finalMeleeDirection)) * 180.0f / 3.14159265f;
+
+	Hooks::hkGetPrimaryAttackActivity.fOriginal(curWep, meleeWepInfo); // Needed to call TestMeleeSwingCollision
+
+	Hooks::m_Game->m_PerformingMelee = true;
+
+	Vector traceDirection = initialMeleeDirection;
+	int numTraces = 10;
+	float traceAngle = swingAngle / numTraces;
+	for (int i = 0; i < numTraces; ++i)
+	{
+		traceDirection = VectorRotate(traceDirection, pivot, traceAngle);
+		Hooks::hkTestMeleeSwingCollisionServer.fOriginal(curWep, traceDirection);
+	}
+
+	Hooks::m_Game->m_PerformingMelee = false;
+}
+
+// Traces one piece of a swing, from one command's hand pose to the next. Returns true when the arc is
+// too small to trace, so the caller keeps `from` and the motion accumulates.
+static bool RunMeleeSweepSegment(Server_WeaponCSBase* curWep, void* meleeWepInfo, edict_t* edicts, int index,
+	const MeleeSweepPose& from, const MeleeSweepPose& to)
+{
+	const bool broadPhase = Hooks::m_VR->m_MeleeSweepBroadPhase;
+
+	// Swept melee: samples sized by arc length, traced only where broad-phase candidates are.
+	MeleeSweepParams params;
+	params.reach = Hooks::m_VR->m_MeleeSweepReach;
+	params.sampleSpacing = Hooks::m_VR->m_MeleeSweepSampleSpacing;
+	params.maxSamples = Hooks::m_VR->m_MeleeSweepMaxSamples;
+	params.minSweepDeg = Hooks::m_VR->m_MeleeSweepMinAngleDeg;
+
+	MeleeSweepArc arc;
+	MeleeSweepPlan plan;
+	if (MeleeSweep::BuildArc(ToMeleeSweepVec(to.pos), ToMeleeSweepVec(MeleeSwingDirection(from.angle)),
+		ToMeleeSweepVec(MeleeSwingDirection(to.angle)), params.reach, arc))
+	{
+		plan = MeleeSweep::PlanSweep(arc.sweepRad, VectorLength(to.pos - from.pos), params);
+	}
+
+	// Too small to trace: keep the sweep start so the motion accumulates.
+	if (plan.skip)
+	{
+		Hooks::m_VR->m_MeleeSweepStats.Record(plan, 0, -1);
+		return true;
+	}
+
+	static thread_local std::vector<MeleeSweepCandidate> s_candidates;
+	static thread_local std::vector<MeleeSweepInterval> s_intervals;
+	static thread_local std::vector<uint8_t> s_selected;
+	int candidatesInArc = -1;
+	int probeRays = 0;
+	int selected = plan.samples;
+	if (broadPhase)
+	{
+		// Origin range: reach + the largest candidate sphere + the hull.
+		GatherMeleeSweepCandidates(edicts, index, to.pos,
+			params.reach + 2.0f * Hooks::m_VR->m_MeleeSweepCandidateRadius + params.hullRadius,
+			Hooks::m_VR->m_MeleeSweepCandidateRadius, s_candidates);
+		s_intervals.clear();
+		for (const MeleeSweepCandidate& candidate : s_candidates)
+		{
+			MeleeSweepInterval interval;
+			if (MeleeSweep::CandidateInArc(arc, candidate, params.hullRadius, interval))
+				s_intervals.push_back(interval);
+		}
+		candidatesInArc = (int)s_intervals.size();
+		selected = MeleeSweep::SelectSamples(plan, s_intervals, s_selected);
+
+		// Walls aren't candidates: the dropped samples are only skipped if the probe rays find nothing.
+		int probes[MeleeSweep::kMaxWorldProbes];
+		const int probeCount = MeleeSweep::WorldProbeSamples(plan, probes);
+		bool traceAll = true;
+		if (MeleeSweep::ShouldProbeWorld(plan, selected, probeCount))
+		{
+			probeRays = probeCount;
+			IHandleEntity* attacker = (edicts && index > 0) ? edicts[index].m_pUnk : nullptr;
+			traceAll = MeleeSweepWorldProbe(attacker, arc, plan, probes, probeCount);
+		}
+		if (traceAll)
+			s_selected.assign((size_t)plan.samples, 1);
+	}
+	else
+	{
+		s_selected.assign((size_t)plan.samples, 1);
+	}
+
+	int traced = 0;
+	for (int k = 0; k < plan.samples; ++k)
+	{
+		if (!s_selected[k])
+			continue;
+		if (traced == 0)
+		{
+			Hooks::hkGetPrimaryAttackActivity.fOriginal(curWep, meleeWepInfo); // Needed to call TestMeleeSwingCollision
+			Hooks::m_Game->m_PerformingMelee = true;
+		}
+		const MeleeSweepVec3 dir = MeleeSweep::SampleDirection(arc, plan, k);
+		Hooks::hkTestMeleeSwingCollisionServer.fOriginal(curWep, Vector(dir.x, dir.y, dir.z));
+		++traced;
+	}
+	Hooks::m_Game->m_PerformingMelee = false;
+
+	Hooks::m_VR->m_MeleeSweepStats.Record(plan, traced, candidatesInArc, probeRays);
+	if (Hooks::m_VR->m_MeleeSweepDebugLog && !ShouldThrottleLog(Hooks::m_VR->m_MeleeSweepLastLog, 1.0f))
+	{
+		const MeleeSweepStats& s = Hooks::m_VR->m_MeleeSweepStats;
+		Game::logMsg("[VR][MeleeSweep] player=%d sweep=%.1fdeg samples=%d selected=%d probes=%d traced=%d inArc=%d | packets=%llu cmds=%llu skipped=%llu traced=%llu probes=%llu legacy=%llu saved=%.0f%%",
+			index, plan.sweepRad * 180.0f / MeleeSweep::kPi, plan.samples, selected, probeRays, traced, candidatesInArc,
+			(unsigned long long)s.packets, (unsigned long long)s.commands, (unsigned long long)s.skipped,
+			(unsigned long long)s.traced, (unsigned long long)s.probes, (unsigned long long)s.LegacyTraces(), s.SavedPercent());
+	}
+	return false;
+}
+
 float __fastcall Hooks::dProcessUsercmds(void* ecx, void* edx, edict_t* player,
 	void* buf, int numcmds, int totalcmds,
 	int dropped_packets, bool ignore, bool paused)
@@ -1082,13 +1578,26 @@ float __fastcall Hooks::dProcessUsercmds(void* ecx, void* edx, edict_t* player,
 
 	int index = oEntindex(pPlayer);
 	m_Game->m_CurrentUsercmdID = index;
+	if (m_Game->IsValidPlayerIndex(index))
+		m_Game->m_PlayersVRInfo[index].serverEntity = pPlayer;
+
+	// Roomscale movement queued by earlier packets goes in before this packet's commands move the player.
+	if (!paused)
+		ApplyRoomscale1To1ServerMove(index, pPlayer);
 
+	m_Game->m_VRServerState.BeginBatch(index);
 	float result = hkProcessUsercmds.fOriginal(ecx, player, buf, numcmds, totalcmds, dropped_packets, ignore, paused);
+	m_Game->m_VRServerState.EndBatch(index);
+
+	// The commands have moved the player: re-anchor the relative VR poses before melee uses them.
+	if (m_Game->IsValidPlayerIndex(index))
+		ResolvePlayerVRPoses(m_Game->m_PlayersVRInfo[index], pPlayer);
 
 	// ===== 你原有的“近战挥砍检测/追踪”逻辑，保持不变 =====
 	const bool hasValidPlayer = m_Game->IsValidPlayerIndex(index);
+	bool sweptSegments = false;
 
-	if (hasValidPlayer && m_Game->m_PlayersVRInfo[index].isUsingVR && m_Game->m_PlayersVRInfo[index].isMeleeing)
+	if (hasValidPlayer && m_Game->m_PlayersVRInfo[index].HasRightHand() && m_Game->m_PlayersVRInfo[index].isMeleeing)
 	{
 		typedef Server_WeaponCSBase* (__thiscall* tGetActiveWep)(void* thisptr);
 		static tGetActiveWep oGetActiveWep = (tGetActiveWep)(m_Game->m_Offsets->GetActiveWeapon.address);
@@ -1099,9 +1608,10 @@ float __fastcall Hooks::dProcessUsercmds(void* ecx, void* edx, edict_t* player,
 			int wepID = curWep->GetWeaponID();
 			if (wepID == 19) // melee weapon
 			{
-				if (m_Game->m_PlayersVRInfo[index].isNewSwing)
+				Player& info = m_Game->m_PlayersVRInfo[index];
+				if (info.isNewSwing)
 				{
-					m_Game->m_PlayersVRInfo[index].isNewSwing = false;
+					info.isNewSwing = false;
 					curWep->entitiesHitThisSwing = 0;
 				}
 
@@ -1109,36 +1619,57 @@ float __fastcall Hooks::dProcessUsercmds(void* ecx, void* edx, edict_t* player,
 				static tGetMeleeWepInfo oGetMeleeWepInfo = (tGetMeleeWepInfo)(m_Game->m_Offsets->GetMeleeWeaponInfo.address);
 				void* meleeWepInfo = oGetMeleeWepInfo(curWep);
 
-				Vector initialForward, initialRight, initialUp;
-				QAngle::AngleVectors(m_Game->m_PlayersVRInfo[index].prevControllerAngle, &initialForward, &initialRight, &initialUp);
-				Vector initialMeleeDirection = VectorRotate(initialForward, initialRight, 50.0f);
-				VectorNormalize(initialMeleeDirection);
-
-				Vector finalForward, finalRight, finalUp;
-				QAngle::AngleVectors(m_Game->m_PlayersVRInfo[index].controllerAngle, &finalForward, &finalRight, &finalUp);
-				Vector finalMeleeDirection = VectorRotate(finalForward, finalRight, 50.0f);
-				VectorNormalize(finalMeleeDirection);
-
-				Vector pivot;
-				CrossProduct(initialMeleeDirection, finalMeleeDirection, pivot);
-				VectorNormalize(pivot);
-
-				float swingAngle = acosf(DotProduct(initialMeleeDirection, finalMeleeDirection)) * 180.0f / 3.14159265f;
-
-				m_Game->m_Hooks->hkGetPrimaryAttackActivity.fOriginal(curWep, meleeWepInfo); // Needed to call TestMeleeSwingCollision
-
-				m_Game->m_PerformingMelee = true;
-
-				Vector traceDirection = initialMeleeDirection;
-				int numTraces = 10;
-				float traceAngle = swingAngle / numTraces;
-				for (int i = 0; i < numTraces; ++i)
+				if (!m_VR->m_MeleeSweepAdaptive)
 				{
-					traceDirection = VectorRotate(traceDirection, pivot, traceAngle);
-					m_Game->m_Hooks->hkTestMeleeSwingCollisionServer.fOriginal(curWep, traceDirection);
+					// The original pattern: one 10-trace arc per packet, from the angle the previous packet
+					// left in prevControllerAngle to the newest (updated below like any non-swept packet).
+					info.meleeTracePos = info.controllerPos;
+					RunLegacyMeleeSwing(curWep, meleeWepInfo, info.prevControllerAngle, info.controllerAngle);
+				}
+				else
+				{
+					// One segment per command of this batch, from the pose history: a fast swing curves between
+					// commands, and the straight arc between the batch's end poses would cut the corner.
+					// Relative poses are anchored at the origin the commands just moved the player to.
+					m_VR->m_MeleeSweepStats.RecordPacket();
+					const Vector origin = *(Vector*)((uintptr_t)pPlayer + 0x2CC);
+					MeleeSweepPose from{ info.prevControllerPos, info.prevControllerAngle };
+					int segments = 0;
+					VRServerStateSample sample;
+					// After a client restart the numbers went backwards; after a long gap only the newest counts.
+					if (m_Game->m_VRServerState.Latest(index, sample)
+						&& (sample.commandNumber < info.meleeSweptCommand || sample.commandNumber - info.meleeSweptCommand > kMeleeSweepMaxCommands))
+					{
+						info.meleeSweptCommand = sample.commandNumber - 1;
+					}
+					while (m_Game->m_VRServerState.NextAfter(index, info.meleeSweptCommand, sample))
+					{
+						info.meleeSweptCommand = sample.commandNumber;
+						const VRCmdPoseSample& hand = sample.pose[VRCmdPose_RightHand];
+						if (!hand.valid)
+							continue;
+						MeleeSweepPose to;
+						to.pos = Vector(hand.pos[0], hand.pos[1], hand.pos[2]);
+						if (sample.flags & VRServerSample_Relative)
+							to.pos += origin;
+						VRCmdPayloadCodec::QuatToAngles(hand.quat, to.angle.x, to.angle.y, to.angle.z);
+						info.meleeTracePos = to.pos;
+						if (!RunMeleeSweepSegment(curWep, meleeWepInfo, player - index, index, from, to))
+							from = to;
+						++segments;
+					}
+					if (segments == 0)
+					{
+						// Nothing new recorded (the history was reset): sweep to the newest pose.
+						const MeleeSweepPose to{ info.controllerPos, info.controllerAngle };
+						info.meleeTracePos = to.pos;
+						if (!RunMeleeSweepSegment(curWep, meleeWepInfo, player - index, index, from, to))
+							from = to;
+					}
+					info.prevControllerPos = from.pos;
+					info.prevControllerAngle = from.angle;
+					sweptSegments = true;
 				}
-
-				m_Game->m_PerformingMelee = false;
 			}
 		}
 	}
@@ -1147,9 +1678,15 @@ float __fastcall Hooks::dProcessUsercmds(void* ecx, void* edx, edict_t* player,
 		m_Game->m_PlayersVRInfo[index].isNewSwing = true;
 	}
 
-	if (hasValidPlayer)
+	if (hasValidPlayer && !sweptSegments)
 	{
-		m_Game->m_PlayersVRInfo[index].prevControllerAngle = m_Game->m_PlayersVRInfo[index].controllerAngle;
+		Player& info = m_Game->m_PlayersVRInfo[index];
+		info.prevControllerAngle = info.controllerAngle;
+		info.prevControllerPos = info.controllerPos;
+		// The next swing starts from the newest pose, not from commands recorded before it.
+		VRServerStateSample newest;
+		if (m_Game->m_VRServerState.Latest(index, newest))
+			info.meleeSweptCommand = newest.commandNumber;
 	}
 
 	return result;
@@ -1161,7 +1698,48 @@ int Hooks::dReadUsercmd(void* buf, CUserCmd* move, CUserCmd* from)
 
 	int i = m_Game->m_CurrentUsercmdID;
 	const bool hasValidPlayer = m_Game->IsValidPlayerIndex(i);
-	if (m_VR->m_EncodeVRUsercmd && move->tick_count < 0) // Signal for VR CUserCmd
+	const VRCmdCarrier carrier = ReadVRCmdCarrier(move);
+	if (m_VR->m_EncodeVRUsercmd && move->tick_count < 0 && VRCmdPayloadCodec::IsPayload(carrier))
+	{
+		move->tick_count *= -1;
+
+		if (hasValidPlayer)
+		{
+			Player& info = m_Game->m_PlayersVRInfo[i];
+			const VRCmdPayloadState* ref = info.cmdPayloadHistory.Find(from ? from->command_number : 0);
+			VRCmdPayloadState state;
+			bool melee = false;
+			if (VRCmdPayloadCodec::Decode(carrier, ref ? *ref : VRCmdPayloadState{}, melee, state))
+			{
+				info.cmdPayloadHistory.Store(move->command_number, state);
+				info.isUsingVR = true;
+				info.isMeleeing = melee;
+				info.hasRelativePoses = true;
+				info.hasRightController = state.valid[VRCmdPose_RightHand];
+				if (info.hasRightController)
+					ReadVRCmdPose(state.pose[VRCmdPose_RightHand], info.controllerOffset, info.controllerAngle);
+				info.hasLeftController = state.valid[VRCmdPose_LeftHand];
+				if (info.hasLeftController)
+					ReadVRCmdPose(state.pose[VRCmdPose_LeftHand], info.leftControllerOffset, info.leftControllerAngle);
+				info.hasHmd = state.valid[VRCmdPose_Hmd];
+				if (info.hasHmd)
+					ReadVRCmdPose(state.pose[VRCmdPose_Hmd], info.hmdOffset, info.hmdAngle);
+				ResolvePlayerVRPoses(info, m_Game->m_CurrentUsercmdPlayer);
+			}
+			else
+			{
+				// Reference chain broken (lost state): keep the last poses until the next absolute update.
+				info.isUsingVR = true;
+			}
+		}
+
+		// The carrier fields mean nothing to the stock server code.
+		move->viewangles.z = 0;
+		move->upmove = 0;
+		move->mousedx = 0;
+		move->mousedy = 0;
+	}
+	else if (m_VR->m_EncodeVRUsercmd && move->tick_count < 0) // Signal for VR CUserCmd (legacy payload)
 	{
 		move->tick_count *= -1;
 
@@ -1184,6 +1762,8 @@ int Hooks::dReadUsercmd(void* buf, CUserCmd* move, CUserCmd* from)
 		if (hasValidPlayer)
 		{
 			m_Game->m_PlayersVRInfo[i].isUsingVR = true;
+			m_Game->m_PlayersVRInfo[i].hasRelativePoses = false;
+			m_Game->m_PlayersVRInfo[i].hasRightController = true;
 			m_Game->m_PlayersVRInfo[i].controllerAngle.x = (float)move->mousedx / 10;
 			m_Game->m_PlayersVRInfo[i].controllerAngle.y = (float)move->mousedy / 10;
 			m_Game->m_PlayersVRInfo[i].controllerPos.x = move->viewangles.z;
@@ -1221,12 +1801,18 @@ int Hooks::dReadUsercmd(void* buf, CUserCmd* move, CUserCmd* from)
 		}
 	}
 
-	// ---- roomscale 1:1 server apply ----
+	if (hasValidPlayer && m_Game->m_PlayersVRInfo[i].isUsingVR)
+		RecordVRServerState(i, move);
+
+	// ---- roomscale 1:1 server receive (drained per server frame in dProcessUsercmds) ----
+	static constexpr uint32_t kRSButtonsMask = RoomscaleCodec::kButtonsMask; // bits 26..31
+	const uint32_t rawButtons = (uint32_t)move->buttons;
+	const uint32_t rawPacked = (rawButtons & kRSButtonsMask);
+	// Hide our custom packed bits from the stock server movement/weapon code. A remote client sends
+	// them whatever this host's own Roomscale1To1 setting is; no stock button uses these bits.
+	move->buttons &= ~(int)kRSButtonsMask;
 	if (m_Game && m_VR && m_VR->m_Roomscale1To1Movement && !m_VR->m_ForceNonVRServerMovement)
 	{
-		static constexpr uint32_t kRSButtonsMask = 0xFC000000u; // bits 26..31
-		const uint32_t rawButtons = (uint32_t)move->buttons;
-		const uint32_t rawPacked = (rawButtons & kRSButtonsMask);
 		// NOTE: Do NOT reuse m_Roomscale1To1DebugLastServer for both "pre" and "apply".
 		// Otherwise "pre" consumes the throttle budget and "apply" never prints.
 		static std::chrono::steady_clock::time_point s_roomscaleServerPreLast{};
@@ -1236,76 +1822,8 @@ int Hooks::dReadUsercmd(void* buf, CUserCmd* move, CUserCmd* from)
 				move->command_number, move->tick_count, i, move->weaponselect, (unsigned)rawButtons);
 		}
 		Vector deltaM;
-		if (VR::DecodeRoomscale1To1Delta((int)rawPacked, deltaM) && move->weaponselect == 0)
-		{
-			// Hide our custom packed bits from the stock server movement/weapon code.
-			move->buttons &= ~(int)kRSButtonsMask;
-			Server_BaseEntity* ent = m_Game->m_CurrentUsercmdPlayer;
-			if (ent && m_Game->m_EngineTrace && m_Game->m_Offsets)
-			{
-				using SetAbsOriginFn = void(__thiscall*)(void*, const Vector&);
-				auto setAbsOrigin = (SetAbsOriginFn)(m_Game->m_Offsets->CBaseEntity_SetAbsOrigin_Server.address);
-
-				if (setAbsOrigin)
-				{
-					Vector origin = *(Vector*)((uintptr_t)ent + 0x2CC);
-					Vector deltaU(deltaM.x * m_VR->m_VRScale, deltaM.y * m_VR->m_VRScale, 0.0f);
-					Vector target = origin + deltaU;
-
-					Vector mins(-16, -16, 0);
-					Vector maxs(16, 16, 72);
-					// NOTE: Our server entity type is a thin vtable stub; pointer-casting it to IHandleEntity
-					// is not reliable for self-filtering. For 1:1 roomscale we only need world collision here.
-					struct TraceFilterWorldOnly final : public CTraceFilter
-					{
-						TraceFilterWorldOnly() : CTraceFilter(nullptr, 0) {}
-						bool ShouldHitEntity(IHandleEntity*, int) override { return false; }
-						TraceType GetTraceType() const override { return TraceType::TRACE_WORLD_ONLY; }
-					} filter;
-
-					// Lift slightly to avoid rare floor-penetration marking the start as solid.
-					Vector o2 = origin;
-					Vector t2 = target;
-					o2.z += 0.25f;
-					t2.z += 0.25f;
-					Ray_t ray;
-					ray.Init(o2, t2, mins, maxs);
-
-					trace_t tr;
-
-					const unsigned int mask = CONTENTS_SOLID | CONTENTS_MOVEABLE | CONTENTS_GRATE;
-					m_Game->m_EngineTrace->TraceRay(ray, mask, &filter, &tr);
-
-					bool didMove = false;
-					if (!tr.startsolid)
-					{
-						Vector end = tr.endpos;
-						end.z = origin.z; // keep vertical position unchanged (we only apply planar room-scale)
-						setAbsOrigin(ent, end);
-						didMove = true;
-					}
-
-					// Hard debug sample: once every 32 cmds, no throttle. This tells us whether the server actually moved the entity.
-					if (m_VR->m_Roomscale1To1DebugLog && ((move->command_number & 31) == 0))
-					{
-						Game::logMsg("[VR][1to1][server] APPLY-SAMPLE cmd=%d tick=%d player=%d ent=%p setAbsOrigin=%p packed=0x%08X dM=(%.3f %.3f) origin=(%.2f %.2f %.2f) target=(%.2f %.2f %.2f) end=(%.2f %.2f %.2f) frac=%.3f startsolid=%d didMove=%d",
-							move->command_number, move->tick_count, i, (void*)ent, (void*)setAbsOrigin, (unsigned)rawPacked,
-							deltaM.x, deltaM.y,
-							origin.x, origin.y, origin.z,
-							target.x, target.y, target.z,
-							tr.endpos.x, tr.endpos.y, tr.endpos.z,
-							tr.fraction, (int)tr.startsolid, (int)didMove);
-					}
-
-					// Normal throttled "apply" log (separate from pre).
-					if (m_VR->m_Roomscale1To1DebugLog && !ShouldThrottleLog(m_VR->m_Roomscale1To1DebugLastServer, m_VR->m_Roomscale1To1DebugLogHz))
-					{
-						Game::logMsg("[VR][1to1][server] apply player=%d dM=(%.3f %.3f) origin=(%.2f %.2f %.2f) target=(%.2f %.2f %.2f) end=(%.2f %.2f %.2f) frac=%.3f startsolid=%d",
-							i, deltaM.x, deltaM.y, origin.x, origin.y, origin.z, target.x, target.y, target.z, tr.endpos.x, tr.endpos.y, tr.endpos.z, tr.fraction, (int)tr.startsolid);
-					}
-				}
-			}
-		}
+		if (hasValidPlayer && VR::DecodeRoomscale1To1Delta((int)rawPacked, deltaM) && move->weaponselect == 0)
+			m_Game->m_PlayersVRInfo[i].roomscaleBuffer.Push(move->command_number, deltaM.x, deltaM.y);
 	}
 	return 1;
 }
@@ -1344,6 +1862,65 @@ int Hooks::dWriteUsercmd(void* buf, CUserCmd* to, CUserCmd* from)
 	// Signal to the server that this CUserCmd has VR info
 	to->tick_count *= -1;
 
+	if (m_VR->m_UsercmdPayloadVersion >= VRCmdPayloadCodec::kVersion)
+	{
+		const int lpIdx = m_Game->m_EngineClient ? m_Game->m_EngineClient->GetLocalPlayer() : -1;
+		C_BaseEntity* localPlayer = (lpIdx > 0) ? m_Game->GetClientEntity(lpIdx) : nullptr;
+		const Vector playerOrigin = localPlayer ? localPlayer->GetAbsOrigin() : Vector(0.0f, 0.0f, 0.0f);
+
+		VRCmdPoseSample poses[VRCmdPose_Count];
+		poses[VRCmdPose_RightHand] = MakeVRCmdPoseSample(m_VR->GetRightControllerAbsPos(), m_VR->GetRightControllerAbsAngle(), playerOrigin);
+		poses[VRCmdPose_LeftHand] = MakeVRCmdPoseSample(m_VR->GetLeftControllerAbsPos(), m_VR->GetLeftControllerAbsAngle(), playerOrigin);
+		poses[VRCmdPose_Hmd] = MakeVRCmdPoseSample(m_VR->m_HmdPosAbs, m_VR->m_HmdAngAbs, playerOrigin);
+		if (!localPlayer)
+		{
+			for (VRCmdPoseSample& pose : poses)
+				pose.valid = false;
+		}
+
+		const bool melee = VectorLength(m_VR->m_RightControllerPose.TrackedDeviceVel) > 1.1f;
+		const VRCmdPayloadState* ref = m_VR->m_UsercmdPayloadHistory.Find(from ? from->command_number : 0);
+		const bool rightHandUrgent = melee || (to->buttons & (1 << 0)) != 0; // IN_ATTACK
+		const std::array<int, VRCmdPose_Count> priority = VRCmdPayloadCodec::PlanPriority(
+			ref ? *ref : VRCmdPayloadState{}, to->command_number, rightHandUrgent);
+		VRCmdPayloadState sent;
+		VRCmdCarrier carrier;
+		const VRCmdEncodeResult encoded = VRCmdPayloadCodec::Encode(poses, melee,
+			ref ? *ref : VRCmdPayloadState{}, priority, sent, carrier);
+		m_VR->m_UsercmdPayloadHistory.Store(to->command_number, sent);
+
+		++m_VR->m_UsercmdPayloadWrites;
+		m_VR->m_UsercmdPayloadBits += (uint64_t)encoded.bitsUsed;
+		if (encoded.droppedMask)
+			++m_VR->m_UsercmdPayloadDrops;
+		if (encoded.outOfRangeMask)
+			++m_VR->m_UsercmdPayloadOutOfRange;
+		if (m_VR->m_UsercmdPayloadDebugLog && !ShouldThrottleLog(m_VR->m_UsercmdPayloadLastLog, 1.0f))
+		{
+			Game::logMsg("[VR][UsercmdPayload] cmd=%d from=%d ref=%d bits=%d/%d sent=0x%X dropped=0x%X out=0x%X outOfRange=%llu avgBits=%.1f dropRate=%.1f%%",
+				to->command_number, from ? from->command_number : 0, ref ? 1 : 0,
+				encoded.bitsUsed, VRCmdPayloadCodec::kCapacityBits, (unsigned)encoded.sentMask, (unsigned)encoded.droppedMask,
+				(unsigned)encoded.outOfRangeMask, (unsigned long long)m_VR->m_UsercmdPayloadOutOfRange,
+				(double)m_VR->m_UsercmdPayloadBits / (double)m_VR->m_UsercmdPayloadWrites,
+				100.0 * (double)m_VR->m_UsercmdPayloadDrops / (double)m_VR->m_UsercmdPayloadWrites);
+		}
+
+		WriteVRCmdCarrier(to, carrier);
+		hkWriteUsercmd.fOriginal(buf, to, from);
+
+		// Restore the local CUserCmd. The carrier fields go back to zero (not their old values) because
+		// that's what the server restores them to, and both sides delta the next command against these.
+		to->tick_count *= -1;
+		to->viewangles.z = 0.0f;
+		to->upmove = 0.0f;
+		to->mousedx = 0;
+		to->mousedy = 0;
+
+		pVerified->m_cmd = *to;
+		pVerified->m_crc = to->GetChecksum();
+		return 1;
+	}
+
 	int originalCommandNum = to->command_number;
 
 	QAngle controllerAngles = m_VR->GetRightControllerAbsAngle();
@@ -15,6 +15,9 @@ Hooks::Hooks(Game* game)
 
 	initSourceHooks();
 
+	// Thread-mode transitions reach the published hook state as soon as the cache sees them.
+	m_Game->m_MatQueueModeCache.Subscribe([](int, int current) { s_HookMode.PublishQueueMode(current); });
+
 	hkGetRenderTarget.enableHook();
 	hkCalcViewModelView.enableHook();
 	hkServerFireTerrorBullets.enableHook();
@@ -64,6 +67,70 @@ Hooks::Hooks(Game* game)
 		hkConVarInternalSetValueInt.enableHook();
 }
 
+void Hooks::UpdateHookMode()
+{
+	if (!m_Game || !m_VR)
+		return;
+
+	HookModeInputs inputs;
+	inputs.vrEnabled = m_VR->m_IsVREnabled;
+	inputs.inGame = m_Game->m_EngineClient && m_Game->m_EngineClient->IsInGame();
+	inputs.thirdPerson = m_VR->m_IsThirdPersonCamera;
+	inputs.matQueueMode = m_Game->GetMatQueueMode();
+	inputs.blockConVarWrites = m_VR->m_LocalVScriptConvarsBlockExternalWrites;
+	inputs.traceConVarWrites = m_VR->m_LocalVScriptConvarsLogEnabled;
+
+	const HookFrameState state = ComputeHookFrameState(inputs);
+	const HookFrameState previous = s_HookMode.Publish(state);
+	if (previous.IsVRActive() != state.IsVRActive() || previous.IsInGame() != state.IsInGame())
+		Game::logMsg("[VR][Hooks] mode %d -> %d (queue=%d)", static_cast<int>(previous.mode), static_cast<int>(state.mode), state.queueMode);
+
+	SetHookGroupsEnabled(RequiredHookGroups(state));
+}
+
+void Hooks::SetHookGroupsEnabled(uint32_t groups)
+{
+	const uint32_t changed = groups ^ s_EnabledHookGroups;
+	if (changed == 0)
+		return;
+
+	if (changed & kHookGroupVRRender)
+	{
+		const bool enable = (groups & kHookGroupVRRender) != 0;
+		hkCalcViewModelView.queueHookState(enable);
+		hkDrawModelExecute.queueHookState(enable);
+		hkPushRenderTargetAndViewport.queueHookState(enable);
+		hkPopRenderTargetAndViewport.queueHookState(enable);
+		hkVgui_Paint.queueHookState(enable);
+		hkIsSplitScreen.queueHookState(enable);
+		hkPrePushRenderTarget.queueHookState(enable);
+	}
+
+	if (changed & kHookGroupConVarWrite)
+	{
+		const bool enable = (groups & kHookGroupConVarWrite) != 0;
+		hkConVarSetValueString.queueHookState(enable);
+		hkConVarSetValueFloat.queueHookState(enable);
+		hkConVarSetValueInt.queueHookState(enable);
+	}
+
+	if (changed & kHookGroupConVarTrace)
+	{
+		const bool enable = (groups & kHookGroupConVarTrace) != 0;
+		hkConVarPrimarySetValueString.queueHookState(enable);
+		hkConVarPrimarySetValueFloat.queueHookState(enable);
+		hkConVarPrimarySetValueInt.queueHookState(enable);
+		hkConVarInternalSetValueString.queueHookState(enable);
+		hkConVarInternalSetValueFloat.queueHookState(enable);
+		hkConVarInternalSetValueInt.queueHookState(enable);
+	}
+
+	if (MH_ApplyQueued() != MH_OK)
+		Game::errorMsg("Failed to apply queued hook state changes");
+
+	s_EnabledHookGroups = groups;
+}
+
 Hooks::~Hooks()
 {
 	if (MH_Uninitialize() != MH_OK)
@@ -159,6 +226,8 @@ int Hooks::initSourceHooks()
 		hkUpdateLaserSight.createHook(UpdateLaserSightAddr, &dUpdateLaserSight);
 	}
 
+	s_MatQueueModeIConVar = m_Game->FindIConVar("mat_queue_mode");
+
 	const char* conVarSamples[] = { "name", "r_shadows", "cl_ragdoll_limit" };
 	for (const char* sample : conVarSamples)
 	{
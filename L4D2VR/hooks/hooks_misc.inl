@@ -319,15 +319,16 @@ int Hooks::dGetPrimaryAttackActivity(void* ecx, void* edx, void* meleeInfo)
 
 Vector* Hooks::dEyePosition(void* ecx, void* edx, Vector* eyePos)
 {
+	// Server-side (a listen server also hosts remote VR players), so this does not follow the client hook mode.
+	if (!m_Game->m_PerformingMelee)
+		return hkEyePosition.fOriginal(ecx, eyePos);
+
 	Vector* result = hkEyePosition.fOriginal(ecx, eyePos);
 
-	if (m_Game->m_PerformingMelee)
+	int i = m_Game->m_CurrentUsercmdID;
+	if (m_Game->IsValidPlayerIndex(i) && m_Game->m_PlayersVRInfo[i].HasRightHand())
 	{
-		int i = m_Game->m_CurrentUsercmdID;
-		if (m_Game->IsValidPlayerIndex(i))
-		{
-			*result = m_Game->m_PlayersVRInfo[i].controllerPos;
-		}
+		*result = m_Game->m_PlayersVRInfo[i].meleeTracePos;
 	}
 
 	return result;
@@ -338,6 +339,10 @@ void Hooks::dDrawModelExecute(void* ecx, void* edx, void* state, const ModelRend
 	if (m_Game->m_SwitchedWeapons)
 		m_Game->m_CachedArmsModel = false;
 
+	const HookFrameState hookState = s_HookMode.Load();
+	if (!hookState.IsInGame())
+		return hkDrawModelExecute.fOriginal(ecx, state, info, pCustomBoneToWorld);
+
 	bool hideArms = m_Game->m_IsMeleeWeaponActive || m_VR->m_HideArms;
 
 	void* pBonesToWorldFinal = pCustomBoneToWorld;
@@ -348,26 +353,16 @@ void Hooks::dDrawModelExecute(void* ecx, void* edx, void* state, const ModelRend
 	ModelRenderInfo_t drawInfo = info;
 	const ModelRenderInfo_t* pDrawInfo = &info;
 
-	std::string modelName;
+	// The right eye reuses the left eye's classification of the same draw (see ClassifyStereoDraw).
+	static const std::string s_noModelName;
+	const VR::StereoDrawClass* drawClass = info.pModel ? &m_VR->ClassifyStereoDraw(info.entity_index, info.pModel) : nullptr;
+	const std::string& modelName = drawClass ? drawClass->modelName : s_noModelName;
 	if (info.pModel)
 	{
-		modelName = m_Game->m_ModelInfo->GetModelName(info.pModel);
 		m_VR->ScanSpecialInfectedEntitiesFromClientList();
 
-		const C_BaseEntity* entity = nullptr;
-		if (m_Game->m_ClientEntityList && info.entity_index > 0)
-		{
-			const int maxEntityIndex = m_Game->m_ClientEntityList->GetHighestEntityIndex();
-			if (info.entity_index <= maxEntityIndex)
-				entity = m_Game->GetClientEntity(info.entity_index);
-		}
-		bool isPlayerClass = false;
-		const char* className = nullptr;
-		if (entity)
-		{
-			className = m_Game->GetNetworkClassName(reinterpret_cast<uintptr_t*>(const_cast<C_BaseEntity*>(entity)));
-			isPlayerClass = className && (std::strcmp(className, "CTerrorPlayer") == 0 || std::strcmp(className, "C_TerrorPlayer") == 0);
-		}
+		const bool isPlayerClass = drawClass->isPlayerClass;
+		const char* className = drawClass->className;
 		// Scope RTT pass: optionally hide the local player model so scoped view isn't blocked by your own head/body.
 		if (m_VR->m_ScopeRenderingPass && m_VR->m_ScopeHideLocalPlayerModelInScope && isPlayerClass && m_Game->m_EngineClient)
 		{
@@ -381,31 +376,12 @@ void Hooks::dDrawModelExecute(void* ecx, void* edx, void* state, const ModelRend
 // In queued rendering (mat_queue_mode!=0), viewmodels are frequently submitted with custom bone matrices.
 // In that case, overriding ModelRenderInfo_t.origin/angles does NOT move the model (it stays "head-locked").
 // So we apply a rigid delta to the bone matrices for this draw call, based on our controller-anchored target.
-const int queueMode = (m_Game != nullptr) ? m_Game->GetMatQueueMode() : 0;
+const int queueMode = hookState.queueMode;
 if (m_VR->m_IsVREnabled && queueMode == 2 && (m_VR->m_QueuedViewmodelStabilize || m_VR->m_ViewmodelDisableMoveBob))
 {
-	const bool isViewmodelClass = className &&
-		(std::strcmp(className, "CBaseViewModel") == 0 || std::strcmp(className, "C_BaseViewModel") == 0);
-	const bool isArmsOrHandsModel =
-		(modelName.find("models/weapons/arms/") != std::string::npos) ||
-		(modelName.find("/arms/") != std::string::npos) ||
-		(modelName.find("v_arms") != std::string::npos) ||
-		(modelName.find("models/weapons/hands/") != std::string::npos) ||
-		(modelName.find("/hands/") != std::string::npos) ||
-		(modelName.find("v_hands") != std::string::npos);
-	const bool isViewmodelModel =
-		(modelName.find("models/weapons/v_") != std::string::npos) ||
-		(modelName.find("/v_models/") != std::string::npos) ||
-		(modelName.find("models/v_models/") != std::string::npos) ||
-
-		// L4D2 melee viewmodels often live under models/weapons/melee/...
-		(modelName.find("models/weapons/melee/v_") != std::string::npos) ||
-		(modelName.find("models/weapons/melee/") != std::string::npos && modelName.find("/v_") != std::string::npos) ||
-		(modelName.find("/melee/v_") != std::string::npos) ||
-
-		// Arms/hands are frequently separate models from the gun.
-		isArmsOrHandsModel;
-
+	const bool isViewmodelClass = drawClass->isViewmodelClass;
+	const bool isArmsOrHandsModel = drawClass->isArmsOrHandsModel;
+	const bool isViewmodelModel = drawClass->isViewmodelModel;
 
 	if (isViewmodelClass || isViewmodelModel)
 	{
@@ -615,9 +591,8 @@ if (m_VR->m_IsVREnabled && queueMode == 2 && (m_VR->m_QueuedViewmodelStabilize |
 	}
 }
 
-		const VR::SpecialInfectedType entityInfectedType =
-			entity ? m_VR->GetSpecialInfectedType(entity) : VR::SpecialInfectedType::None;
-		const VR::SpecialInfectedType modelInfectedType = m_VR->GetSpecialInfectedTypeFromModel(modelName);
+		const VR::SpecialInfectedType entityInfectedType = drawClass->entityInfectedType;
+		const VR::SpecialInfectedType modelInfectedType = drawClass->modelInfectedType;
 		const bool useWitchModelFallback =
 			modelInfectedType == VR::SpecialInfectedType::Witch &&
 			entityInfectedType == VR::SpecialInfectedType::None;
@@ -838,10 +813,11 @@ static bool IsHudRenderTarget(ITexture* texture, ITexture* hudTexture)
 
 void Hooks::dPushRenderTargetAndViewport(void* ecx, void* edx, ITexture* pTexture, ITexture* pDepthTexture, int nViewX, int nViewY, int nViewW, int nViewH)
 {
-    if (!m_VR->m_CreatedVRTextures.load(std::memory_order_acquire))
+    const HookFrameState hookState = s_HookMode.Load();
+    if (!hookState.IsVRActive() || !m_VR->m_CreatedVRTextures.load(std::memory_order_acquire))
         return hkPushRenderTargetAndViewport.fOriginal(ecx, pTexture, pDepthTexture, nViewX, nViewY, nViewW, nViewH);
 
-    const int queueMode = (m_Game != nullptr) ? m_Game->GetMatQueueMode() : 0;
+    const int queueMode = hookState.queueMode;
     if (m_VR->m_RenderPipelineDebugLog)
     {
         static thread_local std::chrono::steady_clock::time_point s_lastPushRtLog{};
@@ -927,10 +903,11 @@ void Hooks::dPushRenderTargetAndViewport(void* ecx, void* edx, ITexture* pTextur
 
 void Hooks::dPopRenderTargetAndViewport(void* ecx, void* edx)
 {
-    if (!m_VR->m_CreatedVRTextures.load(std::memory_order_acquire))
+    const HookFrameState hookState = s_HookMode.Load();
+    if (!hookState.IsVRActive() || !m_VR->m_CreatedVRTextures.load(std::memory_order_acquire))
         return hkPopRenderTargetAndViewport.fOriginal(ecx);
 
-    const int queueMode = (m_Game != nullptr) ? m_Game->GetMatQueueMode() : 0;
+    const int queueMode = hookState.queueMode;
     m_HUDStep = (queueMode == 0) ? HUDPushStep::AfterPop : HUDPushStep::None;
 
     if (m_PushedHud)
@@ -949,7 +926,7 @@ void Hooks::dPopRenderTargetAndViewport(void* ecx, void* edx)
 
 void Hooks::dVGui_Paint(void* ecx, void* edx, int mode)
 {
-    if (!m_VR->m_CreatedVRTextures.load(std::memory_order_acquire))
+    if (!s_HookMode.Load().IsVRActive() || !m_VR->m_CreatedVRTextures.load(std::memory_order_acquire))
         return hkVgui_Paint.fOriginal(ecx, mode);
 
     const bool inGame = m_Game && m_Game->m_EngineClient && m_Game->m_EngineClient->IsInGame();
@@ -1050,8 +1027,8 @@ void Hooks::dVGui_Paint(void* ecx, void* edx, int mode)
 //
 int Hooks::dIsSplitScreen()
 {
-    const int queueMode = (m_Game != nullptr) ? m_Game->GetMatQueueMode() : 0;
-    if (queueMode == 0)
+    const HookFrameState hookState = s_HookMode.Load();
+    if (hookState.IsVRActive() && hookState.queueMode == 0)
     {
         if (m_HUDStep == HUDPushStep::AfterPop)
             m_HUDStep = HUDPushStep::AfterIsSplitScreen;
@@ -1068,8 +1045,8 @@ int Hooks::dIsSplitScreen()
 
 DWORD* Hooks::dPrePushRenderTarget(void* ecx, void* edx, int a2)
 {
-    const int queueMode = (m_Game != nullptr) ? m_Game->GetMatQueueMode() : 0;
-    if (queueMode == 0)
+    const HookFrameState hookState = s_HookMode.Load();
+    if (hookState.IsVRActive() && hookState.queueMode == 0)
     {
         if (m_HUDStep == HUDPushStep::AfterIsSplitScreen)
             m_HUDStep = HUDPushStep::ReadyToOverride;
@@ -1086,6 +1063,11 @@ DWORD* Hooks::dPrePushRenderTarget(void* ecx, void* edx, int a2)
 
 void Hooks::dConVarSetValueString(void* ecx, void* edx, const char* value)
 {
+    if (ecx && ecx == s_MatQueueModeIConVar && m_Game)
+        m_Game->InvalidateMatQueueMode();
+    if (!s_HookMode.Load().WatchesConVarWrites())
+        return hkConVarSetValueString.fOriginal(ecx, value);
+
     const bool blocked = ShouldBlockLockedConVarWrite(ecx, value);
     TraceTrackedConVarWrite(ecx, value, "IConVar::SetValue(string)", _ReturnAddress(), true, blocked);
     if (blocked)
@@ -1096,6 +1078,11 @@ void Hooks::dConVarSetValueString(void* ecx, void* edx, const char* value)
 
 void Hooks::dConVarSetValueFloat(void* ecx, void* edx, float value)
 {
+    if (ecx && ecx == s_MatQueueModeIConVar && m_Game)
+        m_Game->InvalidateMatQueueMode();
+    if (!s_HookMode.Load().WatchesConVarWrites())
+        return hkConVarSetValueFloat.fOriginal(ecx, value);
+
     char buffer[64] = {};
     sprintf_s(buffer, "%.9g", static_cast<double>(value));
     const bool blocked = ShouldBlockLockedConVarWrite(ecx, buffer);
@@ -1108,6 +1095,11 @@ void Hooks::dConVarSetValueFloat(void* ecx, void* edx, float value)
 
 void Hooks::dConVarSetValueInt(void* ecx, void* edx, int value)
 {
+    if (ecx && ecx == s_MatQueueModeIConVar && m_Game)
+        m_Game->InvalidateMatQueueMode();
+    if (!s_HookMode.Load().WatchesConVarWrites())
+        return hkConVarSetValueInt.fOriginal(ecx, value);
+
     char buffer[32] = {};
     sprintf_s(buffer, "%d", value);
     const bool blocked = ShouldBlockLockedConVarWrite(ecx, buffer);
@@ -1120,12 +1112,18 @@ void Hooks::dConVarSetValueInt(void* ecx, void* edx, int value)
 
 void Hooks::dConVarPrimarySetValueString(void* ecx, void* edx, const char* value)
 {
+    if (!s_HookMode.Load().traceConVarWrites)
+        return hkConVarPrimarySetValueString.fOriginal(ecx, value);
+
     TraceTrackedConVarWrite(ecx, value, "ConVar::SetValue(string)", _ReturnAddress(), false, false);
     hkConVarPrimarySetValueString.fOriginal(ecx, value);
 }
 
 void Hooks::dConVarPrimarySetValueFloat(void* ecx, void* edx, float value)
 {
+    if (!s_HookMode.Load().traceConVarWrites)
+        return hkConVarPrimarySetValueFloat.fOriginal(ecx, value);
+
     char buffer[64] = {};
     sprintf_s(buffer, "%.9g", static_cast<double>(value));
     TraceTrackedConVarWrite(ecx, buffer, "ConVar::SetValue(float)", _ReturnAddress(), false, false);
@@ -1134,6 +1132,9 @@ void Hooks::dConVarPrimarySetValueFloat(void* ecx, void* edx, float value)
 
 void Hooks::dConVarPrimarySetValueInt(void* ecx, void* edx, int value)
 {
+    if (!s_HookMode.Load().traceConVarWrites)
+        return hkConVarPrimarySetValueInt.fOriginal(ecx, value);
+
     char buffer[32] = {};
     sprintf_s(buffer, "%d", value);
     TraceTrackedConVarWrite(ecx, buffer, "ConVar::SetValue(int)", _ReturnAddress(), false, false);
@@ -1142,12 +1143,18 @@ void Hooks::dConVarPrimarySetValueInt(void* ecx, void* edx, int value)
 
 void Hooks::dConVarInternalSetValueString(void* ecx, void* edx, const char* value)
 {
+    if (!s_HookMode.Load().traceConVarWrites)
+        return hkConVarInternalSetValueString.fOriginal(ecx, value);
+
     TraceTrackedConVarWrite(ecx, value, "ConVar::InternalSetValue(string)", _ReturnAddress(), false, false);
     hkConVarInternalSetValueString.fOriginal(ecx, value);
 }
 
 void Hooks::dConVarInternalSetValueFloat(void* ecx, void* edx, float value)
 {
+    if (!s_HookMode.Load().traceConVarWrites)
+        return hkConVarInternalSetValueFloat.fOriginal(ecx, value);
+
     char buffer[64] = {};
     sprintf_s(buffer, "%.9g", static_cast<double>(value));
     TraceTrackedConVarWrite(ecx, buffer, "ConVar::InternalSetValue(float)", _ReturnAddress(), false, false);
@@ -1156,6 +1163,9 @@ void Hooks::dConVarInternalSetValueFloat(void* ecx, void* edx, float value)
 
 void Hooks::dConVarInternalSetValueInt(void* ecx, void* edx, int value)
 {
+    if (!s_HookMode.Load().traceConVarWrites)
+        return hkConVarInternalSetValueInt.fOriginal(ecx, value);
+
     char buffer[32] = {};
     sprintf_s(buffer, "%d", value);
     TraceTrackedConVarWrite(ecx, buffer, "ConVar::InternalSetValue(int)", _ReturnAddress(), false, false);
@@ -6,7 +6,7 @@ ITexture* __fastcall Hooks::dGetRenderTarget(void* ecx, void* edx)
 
 void __fastcall Hooks::dRenderView(void* ecx, void* edx, CViewSetup& setup, CViewSetup& hudViewSetup, int nClearFlags, int whatToDraw)
 {
-	static EngineThirdPersonCamSmoother s_engineTpCam;
+	static EngineCameraSmoother s_engineTpCam;
 
 	if (!m_VR->m_CreatedVRTextures.load(std::memory_order_acquire))
 		m_VR->CreateVRTextures();
@@ -33,6 +33,8 @@ void __fastcall Hooks::dRenderView(void* ecx, void* edx, CViewSetup& setup, CVie
 	// Ported behavior from the old multicore branch: do a render-thread WaitGetPoses(), combine it with a
 	// main-thread seqlock snapshot of camera anchor/scale/offsets, then publish a render-thread snapshot
 	// that all render-time getters can read consistently during this dRenderView.
+	if (m_Game)
+		m_Game->RefreshMatQueueMode();
 	const int queueMode = (m_Game != nullptr) ? m_Game->GetMatQueueMode() : 0;
 	struct RenderSnapshotTLSGuard
 	{
@@ -121,8 +123,9 @@ void __fastcall Hooks::dRenderView(void* ecx, void* edx, CViewSetup& setup, CVie
 		// render at HMD rate (90Hz+). That can feel like micro-stutter during stick locomotion/turning
 		// (even when frametime graphs look flat). We smooth the engine-provided setup origin between
 		// tick samples and use that for anchor deltas.
-		static EngineThirdPersonCamSmoother s_engineSetupCam;
+		static EngineCameraSmoother s_engineSetupCam;
 		QAngle __rawSetupAngles(setup.angles.x, setup.angles.y, setup.angles.z);
+		s_engineSetupCam.Configure(m_VR->m_EngineCameraInterpDelayTicks, m_VR->m_EngineCameraMaxExtrapolateTicks);
 		s_engineSetupCam.PushRaw(setup.origin, __rawSetupAngles);
 		Vector smoothedSetupOrigin = setup.origin;
 		QAngle smoothedSetupAngles = __rawSetupAngles;
@@ -631,7 +634,7 @@ void __fastcall Hooks::dRenderView(void* ecx, void* edx, CViewSetup& setup, CVie
 						smoothErrA.Length(), smoothErrYaw,
 						std::sqrt(pendingDeltaSq), pendingYawDelta,
 						vp.rotationOffset, extrapRot,
-						s_engineSetupCam.tickIntervalSec * 1000.0f);
+						s_engineSetupCam.GetTickIntervalSec() * 1000.0f);
 				}
 			}
 
@@ -1064,6 +1067,7 @@ void __fastcall Hooks::dRenderView(void* ecx, void* edx, CViewSetup& setup, CVie
 
 	QAngle rawSetupAngles(setup.angles.x, setup.angles.y, setup.angles.z);
 	// Capture and optionally smooth the engine camera (tick-rate 3P -> HMD-rate continuous).
+	s_engineTpCam.Configure(m_VR->m_EngineCameraInterpDelayTicks, m_VR->m_EngineCameraMaxExtrapolateTicks);
 	if (engineThirdPersonNow)
 		s_engineTpCam.PushRaw(setup.origin, rawSetupAngles);
 	else
@@ -1582,15 +1586,8 @@ void __fastcall Hooks::dRenderView(void* ecx, void* edx, CViewSetup& setup, CVie
 	CViewSetup hudLeft = hudViewSetup;
 	hudLeft.origin = leftEyeView.origin;
 	hudLeft.angles = renderViewAngles;
-	rndrContext->SetRenderTarget(m_VR->m_LeftEyeTexture);
-	if (m_VR->m_IsVREnabled)
-		m_VR->RenderDrawGameLaserSight(localPlayer);
-	hkRenderView.fOriginal(ecx, leftEyeView, hudLeft, nClearFlags, whatToDraw);
-	if (m_VR->m_IsVREnabled)
-		m_VR->UpdateD3DAimLineOverlayForView(localPlayer, leftEyeView, 0);
-	m_PushedHud = false;
 
-	// Right eye CViewSetup
+	// Right eye CViewSetup (filled before the left render so both eyes feed the combined frustum)
 	rightEyeView.x = 0;
 	rightEyeView.width = m_VR->m_RenderWidth;
 	rightEyeView.height = m_VR->m_RenderHeight;
@@ -1603,17 +1600,38 @@ void __fastcall Hooks::dRenderView(void* ecx, void* edx, CViewSetup& setup, CVie
 	rightEyeView.zNearViewmodel = 6;
 	rightEyeView.origin = rightOrigin;
 	rightEyeView.angles = renderViewAngles;
+
+	m_VR->BeginStereoVisibilityFrame(m_VR->m_RenderCompletedFrameId.load(std::memory_order_acquire), leftEyeView, rightEyeView);
+
+	rndrContext->SetRenderTarget(m_VR->m_LeftEyeTexture);
+	if (m_VR->m_IsVREnabled)
+		m_VR->RenderDrawGameLaserSight(localPlayer);
+	m_VR->BeginStereoEye(false);
+	auto eyeStart = std::chrono::steady_clock::now();
+	hkRenderView.fOriginal(ecx, leftEyeView, hudLeft, nClearFlags, whatToDraw);
+	m_VR->EndStereoEye();
+	m_VR->RecordStereoEyeCost(false, false,
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - eyeStart).count());
+	if (m_VR->m_IsVREnabled)
+		m_VR->UpdateD3DAimLineOverlayForView(localPlayer, leftEyeView, 0);
+	m_PushedHud = false;
+
 	CViewSetup hudRight = hudViewSetup;
 	hudRight.origin = rightEyeView.origin;
 	hudRight.angles = renderViewAngles;
 
 	rndrContext->SetRenderTarget(m_VR->m_RightEyeTexture);
+	const bool reusedVisibility = m_VR->BeginStereoEye(true);
+	eyeStart = std::chrono::steady_clock::now();
 	hkRenderView.fOriginal(ecx, rightEyeView, hudRight, nClearFlags, whatToDraw);
+	m_VR->EndStereoEye();
+	m_VR->RecordStereoEyeCost(true, reusedVisibility,
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - eyeStart).count());
 	if (m_VR->m_IsVREnabled)
 		m_VR->UpdateD3DAimLineOverlayForView(localPlayer, rightEyeView, 1);
 
 	auto renderToTexture_SetRT = [&](ITexture* target, int texW, int texH, QAngle passAngles,
-		CViewSetup& view, CViewSetup& hud)
+		CViewSetup& view, CViewSetup& hud, int passWhatToDraw)
 		{
 			IMatRenderContext* rc = m_Game->m_MaterialSystem->GetRenderContext();
 			if (!rc)
@@ -1636,7 +1654,7 @@ void __fastcall Hooks::dRenderView(void* ecx, void* edx, CViewSetup& setup, CVie
 					touchedAngles = true;
 				}
 
-				hkRenderView.fOriginal(ecx, view, hud, nClearFlags, whatToDraw);
+				hkRenderView.fOriginal(ecx, view, hud, nClearFlags, passWhatToDraw);
 
 				if (touchedAngles && m_Game && m_Game->m_EngineClient)
 					m_Game->m_EngineClient->SetViewAngles(oldEngineAngles);
@@ -1666,7 +1684,7 @@ void __fastcall Hooks::dRenderView(void* ecx, void* edx, CViewSetup& setup, CVie
 				touchedAngles = true;
 			}
 
-			hkRenderView.fOriginal(ecx, view, hud, nClearFlags, whatToDraw);
+			hkRenderView.fOriginal(ecx, view, hud, nClearFlags, passWhatToDraw);
 
 			if (touchedAngles && m_Game && m_Game->m_EngineClient)
 				m_Game->m_EngineClient->SetViewAngles(oldEngineAngles);
@@ -1677,6 +1695,9 @@ void __fastcall Hooks::dRenderView(void* ecx, void* edx, CViewSetup& setup, CVie
 			m_VR->m_SuppressHudCapture = prevSuppress;
 		};
 
+	// Decide which optics passes run this frame (content-aware; at most one of scope/mirror per frame).
+	m_VR->PlanOpticsRTTFrame();
+
 	// ----------------------------
 	// Scope RTT pass: render from scope camera into vrScope RTT
 	// ----------------------------
@@ -1687,10 +1708,10 @@ void __fastcall Hooks::dRenderView(void* ecx, void* edx, CViewSetup& setup, CVie
 		scopeView.y = 0;
 		scopeView.m_nUnscaledX = 0;
 		scopeView.m_nUnscaledY = 0;
-		scopeView.width = m_VR->m_ScopeRTTSize;
-		scopeView.m_nUnscaledWidth = m_VR->m_ScopeRTTSize;
-		scopeView.height = m_VR->m_ScopeRTTSize;
-		scopeView.m_nUnscaledHeight = m_VR->m_ScopeRTTSize;
+		scopeView.width = m_VR->m_ScopeRTTActiveSize;
+		scopeView.m_nUnscaledWidth = m_VR->m_ScopeRTTActiveSize;
+		scopeView.height = m_VR->m_ScopeRTTActiveSize;
+		scopeView.m_nUnscaledHeight = m_VR->m_ScopeRTTActiveSize;
 		scopeView.fov = m_VR->m_ScopeFov;
 		scopeView.m_flAspectRatio = 1.0f;
 		scopeView.fovViewmodel = scopeView.fov;
@@ -1727,9 +1748,27 @@ void __fastcall Hooks::dRenderView(void* ecx, void* edx, CViewSetup& setup, CVie
 		if (m_VR->m_IsVREnabled)
 			m_VR->RenderDrawGameLaserSight(localPlayer);
 
-		renderToTexture_SetRT(m_VR->m_ScopeTexture,
-			m_VR->m_ScopeRTTSize, m_VR->m_ScopeRTTSize,
-			scopeAngles, scopeView, hudScope);
+		const OpticsRenderProfiles::Variant scopeVariant = m_VR->m_OpticsRenderProfiles.Select(OpticsRTTScheduler::Pass_Scope);
+		const OpticsRenderProfile* scopeProfile = m_VR->m_OpticsRenderProfiles.Resolve(OpticsRTTScheduler::Pass_Scope, scopeVariant);
+		int scopeWhatToDraw = whatToDraw;
+		if (scopeProfile)
+		{
+			scopeWhatToDraw = scopeProfile->ApplyDrawFlags(whatToDraw);
+			scopeView.zFar = scopeProfile->ApplyFarZ(scopeView.zFar);
+		}
+
+		const auto scopeStart = std::chrono::steady_clock::now();
+		{
+			// RenderView runs on the client main thread in every mat_queue_mode; the overrides are read
+			// while the view is built here, before anything is handed to the material thread.
+			OpticsConVarScope scopeConVars(m_VR->m_OpticsConVarAccess, scopeProfile);
+			renderToTexture_SetRT(m_VR->m_ScopeTexture,
+				m_VR->m_ScopeRTTActiveSize, m_VR->m_ScopeRTTActiveSize,
+				scopeAngles, scopeView, hudScope, scopeWhatToDraw);
+		}
+		m_VR->RecordOpticsRTTCost(OpticsRTTScheduler::Pass_Scope, scopeVariant,
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - scopeStart).count());
+		m_VR->m_ScopeRTTContentVersion.fetch_add(1, std::memory_order_acq_rel);
 		m_VR->m_ScopeRenderingPass = false;
 	}
 
@@ -1743,10 +1782,10 @@ void __fastcall Hooks::dRenderView(void* ecx, void* edx, CViewSetup& setup, CVie
 		mirrorView.y = 0;
 		mirrorView.m_nUnscaledX = 0;
 		mirrorView.m_nUnscaledY = 0;
-		mirrorView.width = m_VR->m_RearMirrorRTTSize;
-		mirrorView.m_nUnscaledWidth = m_VR->m_RearMirrorRTTSize;
-		mirrorView.height = m_VR->m_RearMirrorRTTSize;
-		mirrorView.m_nUnscaledHeight = m_VR->m_RearMirrorRTTSize;
+		mirrorView.width = m_VR->m_RearMirrorRTTActiveSize;
+		mirrorView.m_nUnscaledWidth = m_VR->m_RearMirrorRTTActiveSize;
+		mirrorView.height = m_VR->m_RearMirrorRTTActiveSize;
+		mirrorView.m_nUnscaledHeight = m_VR->m_RearMirrorRTTActiveSize;
 		mirrorView.fov = m_VR->m_RearMirrorFov;
 		mirrorView.m_flAspectRatio = 1.0f;
 		mirrorView.fovViewmodel = mirrorView.fov;
@@ -1767,9 +1806,25 @@ void __fastcall Hooks::dRenderView(void* ecx, void* edx, CViewSetup& setup, CVie
 		m_VR->m_RearMirrorRenderingPass = true;
 		m_VR->m_RearMirrorSawSpecialThisPass = false;
 
-		renderToTexture_SetRT(m_VR->m_RearMirrorTexture,
-			m_VR->m_RearMirrorRTTSize, m_VR->m_RearMirrorRTTSize,
-			mirrorAngles, mirrorView, hudMirror);
+		const OpticsRenderProfiles::Variant mirrorVariant = m_VR->m_OpticsRenderProfiles.Select(OpticsRTTScheduler::Pass_RearMirror);
+		const OpticsRenderProfile* mirrorProfile = m_VR->m_OpticsRenderProfiles.Resolve(OpticsRTTScheduler::Pass_RearMirror, mirrorVariant);
+		int mirrorWhatToDraw = whatToDraw;
+		if (mirrorProfile)
+		{
+			mirrorWhatToDraw = mirrorProfile->ApplyDrawFlags(whatToDraw);
+			mirrorView.zFar = mirrorProfile->ApplyFarZ(mirrorView.zFar);
+		}
+
+		const auto mirrorStart = std::chrono::steady_clock::now();
+		{
+			OpticsConVarScope mirrorConVars(m_VR->m_OpticsConVarAccess, mirrorProfile);
+			renderToTexture_SetRT(m_VR->m_RearMirrorTexture,
+				m_VR->m_RearMirrorRTTActiveSize, m_VR->m_RearMirrorRTTActiveSize,
+				mirrorAngles, mirrorView, hudMirror, mirrorWhatToDraw);
+		}
+		m_VR->RecordOpticsRTTCost(OpticsRTTScheduler::Pass_RearMirror, mirrorVariant,
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mirrorStart).count());
+		m_VR->m_RearMirrorRTTContentVersion.fetch_add(1, std::memory_order_acq_rel);
 
 		m_VR->m_RearMirrorRenderingPass = false;
 		const auto rmNow = std::chrono::steady_clock::now();
@@ -0,0 +1,235 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// ------------------------------------------------------------
+// Startup init graph.
+//
+// Game / VR startup used to run strictly in order: module handles, interfaces, every signature scan,
+// OpenVR, then a sleep loop until the D3D9 device exists, and only then the hooks. Stages here declare
+// what they wait for instead and run on a small pool as soon as that is done, so the slow
+// independent work (signature scans, config files, VPK reads) overlaps the device wait:
+//  - needs: stages that must have succeeded; if one failed (or was skipped), this stage is skipped,
+//  - after: stages that only have to be finished first, whatever their result,
+//  - a stage reports success by returning true; an exception counts as a failure.
+// Dependencies refer to stages added earlier, so the graph can't contain a cycle.
+// Each stage's start (from Run) and duration are kept for the startup log.
+// No engine / Windows dependencies.
+// ------------------------------------------------------------
+
+class InitGraph
+{
+public:
+	enum class StageState
+	{
+		Pending,
+		Succeeded,
+		Failed,
+		Skipped
+	};
+
+	struct StageTiming
+	{
+		std::string name;
+		StageState state = StageState::Pending;
+		double startMs = 0.0;       // since Run began
+		double durationMs = 0.0;
+	};
+
+	using StageFn = std::function<bool()>;
+
+	// Returns the stage id, or -1 (and the graph refuses to run) if a dependency id is unknown.
+	int Add(const char* name, StageFn fn, std::initializer_list<int> needs = {}, std::initializer_list<int> after = {})
+	{
+		const int id = static_cast<int>(m_Stages.size());
+		Stage stage;
+		stage.fn = std::move(fn);
+		stage.timing.name = name ? name : "";
+		for (int dep : needs)
+		{
+			if (dep < 0 || dep >= id)
+			{
+				m_Invalid = true;
+				return -1;
+			}
+			stage.needs.push_back(dep);
+		}
+		for (int dep : after)
+		{
+			if (dep < 0 || dep >= id)
+			{
+				m_Invalid = true;
+				return -1;
+			}
+			stage.after.push_back(dep);
+		}
+		m_Stages.push_back(std::move(stage));
+		return id;
+	}
+
+	// Runs every stage on up to threadCount threads, the calling thread included, and returns once all
+	// of them have finished. True if every stage succeeded. A graph can be run once.
+	bool Run(unsigned threadCount)
+	{
+		if (m_Invalid || m_Ran)
+			return false;
+		m_Ran = true;
+		m_RunStart = std::chrono::steady_clock::now();
+
+		const size_t count = m_Stages.size();
+		for (size_t i = 0; i < count; ++i)
+		{
+			Stage& stage = m_Stages[i];
+			std::vector<int> deps = stage.needs;
+			deps.insert(deps.end(), stage.after.begin(), stage.after.end());
+			std::sort(deps.begin(), deps.end());
+			deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+			stage.waitingOn = static_cast<int>(deps.size());
+			for (int dep : deps)
+				m_Stages[static_cast<size_t>(dep)].dependents.push_back(static_cast<int>(i));
+			if (stage.waitingOn == 0)
+				m_Ready.push_back(static_cast<int>(i));
+		}
+		m_Remaining = count;
+
+		const unsigned workers = std::max(1u, std::min<unsigned>(threadCount, static_cast<unsigned>(std::max<size_t>(count, 1))));
+		std::vector<std::thread> pool;
+		pool.reserve(workers - 1);
+		for (unsigned i = 1; i < workers; ++i)
+		{
+			try
+			{
+				pool.emplace_back(&InitGraph::WorkerMain, this);
+			}
+			catch (const std::system_error&)
+			{
+				break;  // fewer threads, same result
+			}
+		}
+		WorkerMain();
+		for (std::thread& t : pool)
+			t.join();
+
+		return std::all_of(m_Stages.begin(), m_Stages.end(),
+			[](const Stage& s) { return s.timing.state == StageState::Succeeded; });
+	}
+
+	StageState GetState(int id) const
+	{
+		return id >= 0 && id < static_cast<int>(m_Stages.size()) ? m_Stages[static_cast<size_t>(id)].timing.state : StageState::Skipped;
+	}
+
+	bool Succeeded(int id) const { return GetState(id) == StageState::Succeeded; }
+
+	// In the order the stages were added. Valid once Run has returned.
+	std::vector<StageTiming> GetTimings() const
+	{
+		std::vector<StageTiming> timings;
+		timings.reserve(m_Stages.size());
+		for (const Stage& s : m_Stages)
+			timings.push_back(s.timing);
+		return timings;
+	}
+
+	// Wall time of the last Run.
+	double GetTotalMs() const { return m_TotalMs; }
+
+	static const char* StateName(StageState state)
+	{
+		switch (state)
+		{
+		case StageState::Succeeded: return "ok";
+		case StageState::Failed: return "failed";
+		case StageState::Skipped: return "skipped";
+		default: return "pending";
+		}
+	}
+
+private:
+	struct Stage
+	{
+		StageFn fn;
+		std::vector<int> needs;
+		std::vector<int> after;
+		std::vector<int> dependents;
+		int waitingOn = 0;
+		StageTiming timing;
+	};
+
+	void WorkerMain()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		for (;;)
+		{
+			m_Cv.wait(lock, [this] { return !m_Ready.empty() || m_Remaining == 0; });
+			if (m_Ready.empty())
+				return;
+
+			const int id = m_Ready.front();
+			m_Ready.pop_front();
+			Stage& stage = m_Stages[static_cast<size_t>(id)];
+
+			bool runnable = true;
+			for (int dep : stage.needs)
+			{
+				if (m_Stages[static_cast<size_t>(dep)].timing.state != StageState::Succeeded)
+				{
+					runnable = false;
+					break;
+				}
+			}
+
+			StageState result = StageState::Skipped;
+			const auto start = std::chrono::steady_clock::now();
+			auto end = start;
+			if (runnable)
+			{
+				lock.unlock();
+				bool ok = false;
+				try
+				{
+					ok = stage.fn ? stage.fn() : true;
+				}
+				catch (...)
+				{
+					ok = false;
+				}
+				end = std::chrono::steady_clock::now();
+				lock.lock();
+				result = ok ? StageState::Succeeded : StageState::Failed;
+			}
+			stage.timing.state = result;
+			stage.timing.startMs = std::chrono::duration<double, std::milli>(start - m_RunStart).count();
+			stage.timing.durationMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+			for (int dependent : stage.dependents)
+			{
+				if (--m_Stages[static_cast<size_t>(dependent)].waitingOn == 0)
+					m_Ready.push_back(dependent);
+			}
+			if (--m_Remaining == 0)
+				m_TotalMs = std::chrono::duration<double, std::milli>(end - m_RunStart).count();
+			m_Cv.notify_all();
+		}
+	}
+
+	std::vector<Stage> m_Stages;
+	std::deque<int> m_Ready;
+	size_t m_Remaining = 0;
+	std::mutex m_Mutex;
+	std::condition_variable m_Cv;
+	std::chrono::steady_clock::time_point m_RunStart{};
+	double m_TotalMs = 0.0;
+	bool m_Invalid = false;
+	bool m_Ran = false;
+};
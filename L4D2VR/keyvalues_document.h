@@ -0,0 +1,443 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ------------------------------------------------------------
+// Zero-copy KeyValues reader (weapon scripts, VMTs, sound scripts).
+//
+// Parse() makes one pass over the text into a flat node array: keys and values are string_views
+// into the source, blocks link to their first child and each node to its next sibling, and every key
+// carries a precomputed case-insensitive hash so lookups compare 32-bit ints before strings.
+//  - Tokens: "quoted" (may span lines, no escape sequences, like the engine's script reader),
+//    bare words, { and }. // comments run to the end of the line. [$PLATFORM] conditionals are
+//    skipped (treated as true).
+//  - #base / #include "file" at the top level are loaded through the caller's loader and appended
+//    after the file's own keys, so the including file wins lookups. Included texts are owned by the
+//    document; the main text must outlive it unless ParseCopy is used.
+//  - Errors never throw: parsing stops, what was read stays usable and ErrorLine() says where.
+//    Nesting and include depth are capped, so hostile input can't exhaust the stack.
+// No engine / Windows dependencies.
+// ------------------------------------------------------------
+
+class KeyValuesDocument
+{
+public:
+	static constexpr int kNone = -1;
+	static constexpr int kRoot = 0;
+	static constexpr int kMaxDepth = 64;
+	static constexpr int kMaxIncludeDepth = 8;
+	static constexpr int kMaxIncludes = 64;     // per document (a file including itself twice would
+	                                            // otherwise grow as 2^depth)
+
+	struct Node
+	{
+		std::string_view key;
+		std::string_view value;     // empty for blocks
+		uint32_t keyHash = 0;
+		int firstChild = kNone;
+		int nextSibling = kNone;
+		bool isBlock = false;
+	};
+
+	// loader(path, outText): fills outText with the named file's contents, false if unavailable.
+	using IncludeLoader = std::function<bool(std::string_view path, std::string& outText)>;
+
+	KeyValuesDocument() { Clear(); }
+
+	void Clear()
+	{
+		m_Nodes.clear();
+		m_Texts.clear();
+		Node root;
+		root.isBlock = true;
+		m_Nodes.push_back(root);
+		m_ErrorLine = 0;
+		m_Includes = 0;
+	}
+
+	// Parses text (which must outlive the document) and appends its keys to the root.
+	bool Parse(std::string_view text, const IncludeLoader* loader = nullptr)
+	{
+		return ParseInto(text, loader, 0);
+	}
+
+	// Same, but the document keeps its own copy of the text.
+	bool ParseCopy(std::string text, const IncludeLoader* loader = nullptr)
+	{
+		m_Texts.push_back(std::move(text));
+		return ParseInto(m_Texts.back(), loader, 0);
+	}
+
+	// 0 when the last parse succeeded, otherwise the (1-based) line of the first error.
+	int ErrorLine() const { return m_ErrorLine; }
+	size_t NodeCount() const { return m_Nodes.size(); }
+	const Node& Get(int index) const { return m_Nodes[static_cast<size_t>(index)]; }
+
+	int FirstChild(int parent) const { return Valid(parent) ? m_Nodes[parent].firstChild : kNone; }
+	int NextSibling(int node) const { return Valid(node) ? m_Nodes[node].nextSibling : kNone; }
+
+	// First direct child of parent named key (case-insensitive).
+	int Find(int parent, std::string_view key) const
+	{
+		if (!Valid(parent))
+			return kNone;
+		const uint32_t hash = HashKey(key);
+		for (int child = m_Nodes[parent].firstChild; child != kNone; child = m_Nodes[child].nextSibling)
+		{
+			const Node& n = m_Nodes[child];
+			if (n.keyHash == hash && EqualsInsensitive(n.key, key))
+				return child;
+		}
+		return kNone;
+	}
+
+	// First node named key anywhere under parent, in document order. Nodes are stored in document
+	// order, so this is a linear scan of parent's subtree.
+	int FindRecursive(int parent, std::string_view key) const
+	{
+		if (!Valid(parent))
+			return kNone;
+		const uint32_t hash = HashKey(key);
+		const int end = SubtreeEnd(parent);
+		for (int i = parent + 1; i < end; ++i)
+		{
+			const Node& n = m_Nodes[i];
+			if (n.keyHash == hash && EqualsInsensitive(n.key, key))
+				return i;
+		}
+		return kNone;
+	}
+
+	// Value of a key / value node; empty for blocks and kNone.
+	std::string_view Value(int node) const { return Valid(node) ? m_Nodes[node].value : std::string_view{}; }
+
+	// strtof on the value (leading whitespace allowed, trailing junk ignored).
+	bool GetFloat(int node, float& out) const
+	{
+		if (!Valid(node) || m_Nodes[node].isBlock)
+			return false;
+		char buffer[64];
+		if (!CopyTrimmed(m_Nodes[node].value, buffer, sizeof(buffer)))
+			return false;
+		char* endPtr = nullptr;
+		const float v = std::strtof(buffer, &endPtr);
+		if (endPtr == buffer || !std::isfinite(v))
+			return false;
+		out = v;
+		return true;
+	}
+
+	// 1 / 0 / true / false / yes / no (case-insensitive), or any number (non-zero = true).
+	bool GetBool(int node, bool& out) const
+	{
+		if (!Valid(node) || m_Nodes[node].isBlock)
+			return false;
+		char buffer[16];
+		if (!CopyTrimmed(m_Nodes[node].value, buffer, sizeof(buffer)))
+			return false;
+		const std::string_view v(buffer);
+		if (EqualsInsensitive(v, "true") || EqualsInsensitive(v, "yes"))
+			out = true;
+		else if (EqualsInsensitive(v, "false") || EqualsInsensitive(v, "no"))
+			out = false;
+		else
+		{
+			float f = 0.0f;
+			if (!GetFloat(node, f))
+				return false;
+			out = f != 0.0f;
+		}
+		return true;
+	}
+
+	// FNV-1a over the ASCII-lowercased key.
+	static uint32_t HashKey(std::string_view key)
+	{
+		uint32_t h = 2166136261u;
+		for (char c : key)
+		{
+			h ^= static_cast<uint8_t>(LowerAscii(c));
+			h *= 16777619u;
+		}
+		return h;
+	}
+
+	static bool EqualsInsensitive(std::string_view a, std::string_view b)
+	{
+		if (a.size() != b.size())
+			return false;
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			if (LowerAscii(a[i]) != LowerAscii(b[i]))
+				return false;
+		}
+		return true;
+	}
+
+private:
+	enum class TokenType { End, Open, Close, String, Conditional };
+
+	struct Token
+	{
+		TokenType type = TokenType::End;
+		std::string_view text;
+		bool quoted = false;
+	};
+
+	struct Lexer
+	{
+		std::string_view text;
+		size_t pos = 0;
+		int line = 1;
+
+		Token Next()
+		{
+			for (;;)
+			{
+				while (pos < text.size() && IsSpace(text[pos]))
+				{
+					if (text[pos] == '\n')
+						++line;
+					++pos;
+				}
+				if (pos + 1 < text.size() && text[pos] == '/' && text[pos + 1] == '/')
+				{
+					while (pos < text.size() && text[pos] != '\n')
+						++pos;
+					continue;
+				}
+				break;
+			}
+
+			Token t;
+			if (pos >= text.size())
+				return t;
+
+			const char c = text[pos];
+			if (c == '{' || c == '}')
+			{
+				t.type = (c == '{') ? TokenType::Open : TokenType::Close;
+				t.text = text.substr(pos, 1);
+				++pos;
+				return t;
+			}
+			if (c == '"')
+			{
+				const size_t begin = ++pos;
+				while (pos < text.size() && text[pos] != '"')
+				{
+					if (text[pos] == '\n')
+						++line;
+					++pos;
+				}
+				t.type = TokenType::String;
+				t.quoted = true;
+				t.text = text.substr(begin, pos - begin);
+				if (pos < text.size())
+					++pos;  // closing quote (an unterminated string runs to the end)
+				return t;
+			}
+
+			const size_t begin = pos;
+			while (pos < text.size() && !IsSpace(text[pos]) && text[pos] != '"' && text[pos] != '{' && text[pos] != '}')
+			{
+				if (text[pos] == '/' && pos + 1 < text.size() && text[pos + 1] == '/')
+					break;
+				++pos;
+			}
+			t.text = text.substr(begin, pos - begin);
+			t.type = (t.text.size() >= 2 && t.text.front() == '[' && t.text.back() == ']') ? TokenType::Conditional : TokenType::String;
+			return t;
+		}
+
+		// Next token that isn't a [$PLATFORM] conditional.
+		Token NextSkippingConditionals()
+		{
+			Token t = Next();
+			while (t.type == TokenType::Conditional)
+				t = Next();
+			return t;
+		}
+	};
+
+	struct Frame
+	{
+		int block = kRoot;
+		int lastChild = kNone;
+	};
+
+	struct PendingInclude
+	{
+		std::string_view path;
+	};
+
+	bool ParseInto(std::string_view text, const IncludeLoader* loader, int includeDepth)
+	{
+		m_ErrorLine = 0;
+		m_Nodes.reserve(m_Nodes.size() + text.size() / 24 + 8);
+
+		std::vector<Frame> stack;
+		stack.push_back({ kRoot, LastChild(kRoot) });
+		std::vector<PendingInclude> includes;
+
+		Lexer lex{ text, 0, 1 };
+		bool ok = true;
+		for (;;)
+		{
+			Token key = lex.NextSkippingConditionals();
+			if (key.type == TokenType::End)
+			{
+				if (stack.size() > 1)
+					ok = Fail(lex.line);
+				break;
+			}
+			if (key.type == TokenType::Close)
+			{
+				if (stack.size() == 1)
+				{
+					ok = Fail(lex.line);
+					break;
+				}
+				stack.pop_back();
+				continue;
+			}
+			if (key.type == TokenType::Open)
+			{
+				// A block without a key: the engine rejects it.
+				ok = Fail(lex.line);
+				break;
+			}
+
+			Token value = lex.NextSkippingConditionals();
+			if (value.type == TokenType::End || value.type == TokenType::Close)
+			{
+				ok = Fail(lex.line);
+				break;
+			}
+
+			const bool directive = stack.size() == 1 && !key.quoted &&
+				(EqualsInsensitive(key.text, "#base") || EqualsInsensitive(key.text, "#include"));
+			if (directive && value.type == TokenType::String)
+			{
+				includes.push_back({ value.text });
+				continue;
+			}
+
+			Node node;
+			node.key = key.text;
+			node.keyHash = HashKey(key.text);
+			if (value.type == TokenType::Open)
+			{
+				if (static_cast<int>(stack.size()) > kMaxDepth)
+				{
+					ok = Fail(lex.line);
+					break;
+				}
+				node.isBlock = true;
+				const int index = Append(stack.back(), node);
+				stack.push_back({ index, kNone });
+			}
+			else
+			{
+				node.value = value.text;
+				Append(stack.back(), node);
+			}
+		}
+
+		if (loader && *loader && includeDepth < kMaxIncludeDepth)
+		{
+			const int errorLine = m_ErrorLine;
+			for (const PendingInclude& include : includes)
+			{
+				if (m_Includes >= kMaxIncludes)
+					break;
+				++m_Includes;
+				std::string included;
+				if (!(*loader)(include.path, included))
+					continue;
+				m_Texts.push_back(std::move(included));
+				ParseInto(m_Texts.back(), loader, includeDepth + 1);
+			}
+			m_ErrorLine = errorLine;
+		}
+		return ok;
+	}
+
+	int Append(Frame& frame, const Node& node)
+	{
+		const int index = static_cast<int>(m_Nodes.size());
+		m_Nodes.push_back(node);
+		if (frame.lastChild == kNone)
+			m_Nodes[frame.block].firstChild = index;
+		else
+			m_Nodes[frame.lastChild].nextSibling = index;
+		frame.lastChild = index;
+		return index;
+	}
+
+	int LastChild(int block) const
+	{
+		int last = kNone;
+		for (int child = m_Nodes[block].firstChild; child != kNone; child = m_Nodes[child].nextSibling)
+			last = child;
+		return last;
+	}
+
+	// One past the last node of node's subtree. Within one parse children follow their block, so
+	// the subtree ends where the next sibling (of node or of an ancestor) begins.
+	int SubtreeEnd(int node) const
+	{
+		if (node == kRoot)
+			return static_cast<int>(m_Nodes.size());
+		if (m_Nodes[node].nextSibling != kNone)
+			return m_Nodes[node].nextSibling;
+		// No next sibling: the subtree ends after its deepest last descendant.
+		int last = node;
+		while (m_Nodes[last].firstChild != kNone)
+		{
+			int child = m_Nodes[last].firstChild;
+			while (m_Nodes[child].nextSibling != kNone)
+				child = m_Nodes[child].nextSibling;
+			last = child;
+		}
+		return last + 1;
+	}
+
+	bool Fail(int line)
+	{
+		if (m_ErrorLine == 0)
+			m_ErrorLine = line;
+		return false;
+	}
+
+	bool Valid(int index) const { return index >= 0 && static_cast<size_t>(index) < m_Nodes.size(); }
+
+	static bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f'; }
+	static char LowerAscii(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c; }
+
+	static bool CopyTrimmed(std::string_view v, char* buffer, size_t size)
+	{
+		while (!v.empty() && IsSpace(v.front()))
+			v.remove_prefix(1);
+		while (!v.empty() && IsSpace(v.back()))
+			v.remove_suffix(1);
+		if (v.empty())
+			return false;
+		const size_t n = (v.size() < size - 1) ? v.size() : size - 1;
+		std::memcpy(buffer, v.data(), n);
+		buffer[n] = '\0';
+		return true;
+	}
+
+	std::vector<Node> m_Nodes;
+	std::deque<std::string> m_Texts;   // included / copied sources; deque keeps them in place
+	int m_ErrorLine = 0;
+	int m_Includes = 0;
+};
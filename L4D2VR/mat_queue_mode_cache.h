@@ -0,0 +1,111 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// ------------------------------------------------------------
+// Cached material system thread mode.
+//
+// GetMatQueueMode() was a virtual call into IMaterialSystem (GetThreadMode, slot 11) for every
+// caller, DrawModelExecute on every draw included, several times a frame on different threads. The
+// mode only changes after a mat_queue_mode write or around a map load, and the engine applies a new
+// mode at a later frame boundary, so:
+//  - readers on any thread get the cached value from an atomic,
+//  - Invalidate() (mat_queue_mode written, map loaded / left) opens a settle window during which
+//    Refresh() re-reads the engine on every call, until the deferred switch has landed,
+//  - outside the window the engine is re-read only every validateIntervalSeconds, as a backstop for
+//    writes we don't see (a console write that never goes through a hooked IConVar, say),
+//  - listeners hear about every transition on the thread that ran Refresh(). One Refresh() runs at
+//    a time (a concurrent caller skips); listeners must not Subscribe / Unsubscribe.
+// No engine / Windows dependencies.
+// ------------------------------------------------------------
+
+struct MatQueueModeCacheSettings
+{
+	double settleSeconds = 2.0;
+	double validateIntervalSeconds = 1.0;
+};
+
+class MatQueueModeCache
+{
+public:
+	using Listener = std::function<void(int previous, int current)>;
+
+	void Configure(const MatQueueModeCacheSettings& settings) { m_Settings = settings; }
+
+	// Any thread.
+	int Get() const { return m_Mode.load(std::memory_order_acquire); }
+	bool IsValid() const { return m_Valid.load(std::memory_order_acquire); }
+	void Invalidate() { m_Dirty.store(true, std::memory_order_release); }
+
+	int Subscribe(Listener listener)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		const int id = ++m_NextListenerId;
+		m_Listeners.emplace_back(id, std::move(listener));
+		return id;
+	}
+
+	void Unsubscribe(int id)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Listeners.erase(std::remove_if(m_Listeners.begin(), m_Listeners.end(),
+			[id](const std::pair<int, Listener>& l) { return l.first == id; }), m_Listeners.end());
+	}
+
+	// read() returns the engine's current thread mode; it is only called when a read is due.
+	// Returns true when the mode changed (listeners have been told).
+	template <typename Read>
+	bool Refresh(double now, Read&& read)
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex, std::try_to_lock);
+		if (!lock.owns_lock())
+			return false;
+
+		if (m_Dirty.exchange(false, std::memory_order_acq_rel))
+			m_SettleUntil = now + m_Settings.settleSeconds;
+
+		const bool valid = m_Valid.load(std::memory_order_relaxed);
+		const bool due = !valid
+			|| now < m_SettleUntil
+			|| now - m_LastReadTime >= m_Settings.validateIntervalSeconds;
+		if (!due)
+			return false;
+
+		m_LastReadTime = now;
+		++m_ReadCount;
+		const int current = read();
+		const int previous = m_Mode.load(std::memory_order_relaxed);
+		m_Mode.store(current, std::memory_order_release);
+		m_Valid.store(true, std::memory_order_release);
+		if (current == previous)
+			return false;
+
+		++m_TransitionCount;
+		for (const auto& l : m_Listeners)
+			l.second(previous, current);
+		return true;
+	}
+
+	uint64_t GetReadCount() const { return m_ReadCount; }
+	uint64_t GetTransitionCount() const { return m_TransitionCount; }
+
+private:
+	MatQueueModeCacheSettings m_Settings;
+	std::atomic<int> m_Mode{ 0 };
+	std::atomic<bool> m_Valid{ false };
+	std::atomic<bool> m_Dirty{ false };
+
+	// Guarded by m_Mutex.
+	std::mutex m_Mutex;
+	double m_SettleUntil = -1.0;
+	double m_LastReadTime = 0.0;
+	uint64_t m_ReadCount = 0;
+	uint64_t m_TransitionCount = 0;
+	std::vector<std::pair<int, Listener>> m_Listeners;
+	int m_NextListenerId = 0;
+};
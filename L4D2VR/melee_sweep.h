@@ -0,0 +1,307 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// ------------------------------------------------------------
+// Swept-volume melee for VR players (server side).
+//
+// dProcessUsercmds used to call TestMeleeSwingCollision 10 times per usercmd for every swinging VR
+// player, rotating the trace direction by swingAngle / 10 no matter how far the controller moved.
+// Instead:
+//  - PlanSweep sizes the sample count from the swept arc length at weapon reach (angle per command,
+//    i.e. angular velocity x tick), so wiggles cost nothing and fast swings get denser samples.
+//  - Arcs below a minimum angle (and without hand translation, i.e. not a stab) are not traced; the
+//    caller keeps the sweep start so slow motion accumulates into one arc instead of being lost.
+//  - Candidates near the player are broad-phased once per swing against the swept wedge, and each
+//    sample is only traced if some candidate's angular interval covers it.
+//  - World geometry isn't a candidate, so when the broad phase drops samples a few probe rays check
+//    the arc for walls first; when it drops fewer samples than the probes would cost, everything is
+//    traced without probing.
+//
+// No engine / Windows dependencies; the hook converts to / from Source vectors.
+// ------------------------------------------------------------
+
+struct MeleeSweepVec3
+{
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+
+	MeleeSweepVec3 operator+(const MeleeSweepVec3& o) const { return { x + o.x, y + o.y, z + o.z }; }
+	MeleeSweepVec3 operator-(const MeleeSweepVec3& o) const { return { x - o.x, y - o.y, z - o.z }; }
+	MeleeSweepVec3 operator*(float s) const { return { x * s, y * s, z * s }; }
+	float Dot(const MeleeSweepVec3& o) const { return x * o.x + y * o.y + z * o.z; }
+	MeleeSweepVec3 Cross(const MeleeSweepVec3& o) const { return { y * o.z - z * o.y, z * o.x - x * o.z, x * o.y - y * o.x }; }
+	float Length() const { return std::sqrt(Dot(*this)); }
+	MeleeSweepVec3 Normalized() const
+	{
+		const float len = Length();
+		return (len > 1e-6f) ? (*this * (1.0f / len)) : MeleeSweepVec3{};
+	}
+};
+
+struct MeleeSweepParams
+{
+	float reach = 70.0f;            // weapon reach in game units (L4D2 melee_range)
+	float sampleSpacing = 10.0f;    // max arc length between samples at full reach
+	int   minSamples = 1;
+	int   maxSamples = 16;
+	float minSweepDeg = 2.0f;       // below this the arc is accumulated instead of traced...
+	float minTranslation = 4.0f;    // ...unless the hand moved this far (stabs barely rotate)
+	float hullRadius = 8.0f;        // half-size of the engine's melee trace hull, added to every candidate
+};
+
+struct MeleeSweepPlan
+{
+	bool skip = true;               // arc too small: keep accumulating
+	int samples = 0;
+	float sweepRad = 0.0f;
+	float stepRad = 0.0f;
+};
+
+// One swing step: rotation of startDir about axis by sweepRad, traced from origin.
+struct MeleeSweepArc
+{
+	MeleeSweepVec3 origin;
+	MeleeSweepVec3 startDir;        // unit
+	MeleeSweepVec3 axis;            // unit, startDir x endDir
+	float sweepRad = 0.0f;
+	float reach = 0.0f;
+};
+
+struct MeleeSweepCandidate
+{
+	MeleeSweepVec3 center;
+	float radius = 0.0f;
+};
+
+// Angular interval of the arc a candidate can be hit from, in radians from startDir.
+struct MeleeSweepInterval
+{
+	float begin = 0.0f;
+	float end = 0.0f;
+};
+
+class MeleeSweep
+{
+public:
+	static constexpr float kPi = 3.14159265358979f;
+
+	// Builds the arc from startDir to endDir (unit or not). If they're parallel the arc has zero sweep
+	// around an arbitrary perpendicular axis. False only for degenerate (zero) directions.
+	static bool BuildArc(const MeleeSweepVec3& origin, const MeleeSweepVec3& startDir, const MeleeSweepVec3& endDir, float reach, MeleeSweepArc& out)
+	{
+		const MeleeSweepVec3 s = startDir.Normalized();
+		const MeleeSweepVec3 e = endDir.Normalized();
+		if (s.Dot(s) < 0.5f || e.Dot(e) < 0.5f)
+			return false;
+
+		MeleeSweepVec3 axis = s.Cross(e);
+		const float sinA = axis.Length();
+		if (sinA < 1e-5f)
+		{
+			// Parallel (or opposite, which a 1-command delta never is): no rotation.
+			const MeleeSweepVec3 helper = (std::fabs(s.z) < 0.9f) ? MeleeSweepVec3{ 0.0f, 0.0f, 1.0f } : MeleeSweepVec3{ 1.0f, 0.0f, 0.0f };
+			out.axis = s.Cross(helper).Normalized();
+			out.sweepRad = 0.0f;
+		}
+		else
+		{
+			out.axis = axis * (1.0f / sinA);
+			out.sweepRad = std::atan2(sinA, std::max(-1.0f, std::min(1.0f, s.Dot(e))));
+		}
+		out.origin = origin;
+		out.startDir = s;
+		out.reach = reach;
+		return true;
+	}
+
+	// translation: how far the swing origin (the hand) moved over the same command.
+	static MeleeSweepPlan PlanSweep(float sweepRad, float translation, const MeleeSweepParams& params)
+	{
+		MeleeSweepPlan plan;
+		if (!std::isfinite(sweepRad) || !std::isfinite(translation))
+			return plan;
+
+		const bool rotated = sweepRad >= params.minSweepDeg * kPi / 180.0f;
+		const bool moved = translation >= params.minTranslation;
+		if (!rotated && !moved)
+			return plan;
+
+		// Spacing is measured along the arc at full reach: that's where gaps between samples are widest.
+		const float arcLength = rotated ? std::max(params.reach, 1.0f) * sweepRad : 0.0f;
+		const float spacing = std::max(params.sampleSpacing, 0.5f);
+		const int wanted = static_cast<int>(std::ceil(arcLength / spacing));
+		plan.skip = false;
+		plan.samples = std::max(params.minSamples, std::min(params.maxSamples, std::max(wanted, 1)));
+		plan.sweepRad = rotated ? sweepRad : 0.0f;
+		plan.stepRad = plan.sweepRad / plan.samples;
+		// A pure stab only needs the final direction once.
+		if (!rotated)
+			plan.samples = 1;
+		return plan;
+	}
+
+	// Rodrigues rotation of v about a unit axis.
+	static MeleeSweepVec3 Rotate(const MeleeSweepVec3& v, const MeleeSweepVec3& axis, float angleRad)
+	{
+		const float c = std::cos(angleRad);
+		const float s = std::sin(angleRad);
+		return v * c + axis.Cross(v) * s + axis * (axis.Dot(v) * (1.0f - c));
+	}
+
+	// Direction of sample k (0-based). Like the old loop, samples sit at step, 2*step, ..., sweep:
+	// the start direction was already covered by the previous command's last sample.
+	static MeleeSweepVec3 SampleDirection(const MeleeSweepArc& arc, const MeleeSweepPlan& plan, int k)
+	{
+		return Rotate(arc.startDir, arc.axis, plan.stepRad * static_cast<float>(k + 1));
+	}
+
+	// Broad phase: can a trace of length reach, anywhere on the arc, touch this sphere?
+	// On success outInterval holds the arc angles (relative to startDir) worth tracing.
+	static bool CandidateInArc(const MeleeSweepArc& arc, const MeleeSweepCandidate& c, float hullRadius, MeleeSweepInterval& outInterval)
+	{
+		const float radius = c.radius + hullRadius;
+		const MeleeSweepVec3 d = c.center - arc.origin;
+		const float dist = d.Length();
+		if (dist - radius > arc.reach)
+			return false;
+
+		// Distance from the sweep plane: the traces all lie in it.
+		const float height = d.Dot(arc.axis);
+		if (std::fabs(height) > radius)
+			return false;
+
+		const MeleeSweepVec3 inPlane = d - arc.axis * height;
+		const float planar = inPlane.Length();
+		// Radius of the sphere's slice through the plane.
+		const float slice = std::sqrt(std::max(0.0f, radius * radius - height * height));
+		if (planar <= slice)
+		{
+			// Around the origin itself: every direction can clip it.
+			outInterval = { 0.0f, arc.sweepRad };
+			return true;
+		}
+
+		const MeleeSweepVec3 side = arc.axis.Cross(arc.startDir);
+		const float theta = std::atan2(inPlane.Dot(side), inPlane.Dot(arc.startDir));
+		const float margin = std::asin(std::min(1.0f, slice / planar));
+		float begin = theta - margin;
+		float end = theta + margin;
+		// theta is in (-pi, pi]: an interval reaching below -pi is the far end of a wide arc.
+		if (end < 0.0f && begin < -kPi)
+		{
+			begin += 2.0f * kPi;
+			end += 2.0f * kPi;
+		}
+		if (end < 0.0f || begin > arc.sweepRad)
+			return false;
+
+		outInterval = { std::max(0.0f, begin), std::min(arc.sweepRad, end) };
+		return true;
+	}
+
+	// Marks which samples are worth tracing given the candidates' intervals. A sample at angle a covers
+	// (a - step, a], so a candidate interval selects every sample whose slice it overlaps.
+	// Returns the number of samples selected.
+	static int SelectSamples(const MeleeSweepPlan& plan, const std::vector<MeleeSweepInterval>& intervals, std::vector<uint8_t>& outSelected)
+	{
+		outSelected.assign(static_cast<size_t>(std::max(plan.samples, 0)), 0);
+		if (plan.skip || plan.samples <= 0)
+			return 0;
+		if (!(plan.stepRad > 0.0f))
+		{
+			// Zero sweep: every sample looks the same way; one trace if anything is in front.
+			if (intervals.empty())
+				return 0;
+			outSelected[plan.samples - 1] = 1;
+			return 1;
+		}
+
+		int count = 0;
+		for (const MeleeSweepInterval& iv : intervals)
+		{
+			int first = static_cast<int>(std::floor(iv.begin / plan.stepRad));
+			int last = static_cast<int>(std::ceil(iv.end / plan.stepRad)) - 1;
+			first = std::max(0, std::min(plan.samples - 1, first));
+			last = std::max(first, std::min(plan.samples - 1, last));
+			for (int k = first; k <= last; ++k)
+			{
+				if (!outSelected[k])
+				{
+					outSelected[k] = 1;
+					++count;
+				}
+			}
+		}
+		return count;
+	}
+
+	static constexpr int kMaxWorldProbes = 3;
+
+	// Sample indices the world probe rays follow: first, middle and last, without repeats.
+	// Returns how many were written to out.
+	static int WorldProbeSamples(const MeleeSweepPlan& plan, int (&out)[kMaxWorldProbes])
+	{
+		if (plan.skip || plan.samples <= 0)
+			return 0;
+		const int picks[kMaxWorldProbes] = { 0, plan.samples / 2, plan.samples - 1 };
+		int count = 0;
+		for (int pick : picks)
+		{
+			if (count == 0 || out[count - 1] != pick)
+				out[count++] = pick;
+		}
+		return count;
+	}
+
+	// Probing only pays when the samples the broad phase dropped outnumber the probe rays: a probe
+	// that finds a wall costs its rays on top of the full plan.
+	static bool ShouldProbeWorld(const MeleeSweepPlan& plan, int selectedSamples, int probeRays)
+	{
+		if (plan.skip || plan.samples <= 0 || probeRays <= 0)
+			return false;
+		return plan.samples - std::max(selectedSamples, 0) > probeRays;
+	}
+};
+
+// Trace accounting: what the adaptive sweep issued vs. what the fixed 10-sample loop would have.
+// The old loop ran once per usercmd packet; the sweep runs once per command in it.
+struct MeleeSweepStats
+{
+	static constexpr int kLegacySamplesPerPacket = 10;
+
+	uint64_t packets = 0;          // ProcessUsercmds calls that swept
+	uint64_t commands = 0;
+	uint64_t skipped = 0;          // arcs below minSweepDeg (accumulated)
+	uint64_t planned = 0;          // samples planned before the broad phase
+	uint64_t traced = 0;           // TestMeleeSwingCollision calls actually made
+	uint64_t probes = 0;           // world probe rays
+	uint64_t candidates = 0;       // broad-phase candidates inside the arc
+
+	void Record(const MeleeSweepPlan& plan, int tracedSamples, int candidatesInArc, int probeRays = 0)
+	{
+		++commands;
+		if (plan.skip)
+		{
+			++skipped;
+			return;
+		}
+		planned += static_cast<uint64_t>(plan.samples);
+		traced += static_cast<uint64_t>(std::max(tracedSamples, 0));
+		probes += static_cast<uint64_t>(std::max(probeRays, 0));
+		candidates += static_cast<uint64_t>(std::max(candidatesInArc, 0));
+	}
+
+	void RecordPacket() { ++packets; }
+
+	uint64_t LegacyTraces() const { return packets * kLegacySamplesPerPacket; }
+	// Probe rays count against the saving: they're traces too.
+	double SavedPercent() const
+	{
+		const uint64_t legacy = LegacyTraces();
+		return legacy ? (1.0 - static_cast<double>(traced + probes) / static_cast<double>(legacy)) * 100.0 : 0.0;
+	}
+};
@@ -0,0 +1,336 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "optics_rtt_scheduler.h"
+
+// ------------------------------------------------------------
+// Reduced-cost render profiles for the optics RTT passes (scope / rear mirror).
+//
+// The optics passes used to call RenderView with the eye views' whatToDraw flags, so a 512px mirror
+// still drew the HUD, viewmodels, detail props and full-distance geometry. A profile trims that:
+//  - whatToDraw bits (HUD / viewmodel),
+//  - a far-plane clamp,
+//  - a handful of client convars (detail props, particles, shadows, model LOD) that are overridden
+//    only for the duration of the pass and restored right after.
+// An optional A/B mode alternates full/reduced renders per pass and keeps separate timings.
+// The config thread publishes profile sets through OpticsRenderProfileMailbox; the render thread
+// picks them up once per frame.
+//
+// No engine / Windows dependencies: convar access goes through OpticsConVarAccess so it can be mocked.
+// ------------------------------------------------------------
+
+// Source view_shared.h RenderViewInfo_t bits (not exposed by our trimmed SDK headers).
+enum OpticsRenderViewFlags
+{
+	OpticsRenderView_DrawViewmodel = (1 << 0),
+	OpticsRenderView_DrawHud = (1 << 1),
+};
+
+struct OpticsRenderProfile
+{
+	bool drawHud = false;
+	bool drawViewmodel = false;
+	// Clamp for CViewSetup::zFar in game units. 0 = keep the engine's value.
+	float farZ = 0.0f;
+	// r_lod override for the pass. < 0 = leave the user's setting alone.
+	int lod = -1;
+	bool detailProps = true;
+	bool particles = true;
+	bool shadows = true;
+
+	int ApplyDrawFlags(int whatToDraw) const
+	{
+		if (!drawHud)
+			whatToDraw &= ~OpticsRenderView_DrawHud;
+		if (!drawViewmodel)
+			whatToDraw &= ~OpticsRenderView_DrawViewmodel;
+		return whatToDraw;
+	}
+
+	float ApplyFarZ(float zFar) const
+	{
+		if (!(farZ > 0.0f))
+			return zFar;
+		return (zFar > 0.0f) ? std::min(zFar, farZ) : farZ;
+	}
+};
+
+// The client convars a profile can override.
+enum OpticsConVar
+{
+	OpticsConVar_DetailProps = 0,
+	OpticsConVar_Particles,
+	OpticsConVar_Shadows,
+	OpticsConVar_Lod,
+	OpticsConVar_Count
+};
+
+inline const char* GetOpticsConVarName(OpticsConVar var)
+{
+	static const char* const kNames[OpticsConVar_Count] = { "r_drawdetailprops", "r_drawparticles", "r_shadows", "r_lod" };
+	return (var >= 0 && var < OpticsConVar_Count) ? kNames[var] : nullptr;
+}
+
+// Indirection over Game::FindConVar / GetConVarFloatFromPointer / SetConVarFloatFromPointer.
+// Convar handles are looked up once and kept: the passes run every frame and a lookup walks the
+// cvar list. Only touched on the thread that runs the optics passes.
+struct OpticsConVarAccess
+{
+	std::function<void*(const char* name)> find;
+	// Return false if the value couldn't be read / written.
+	std::function<bool(void* convar, float& outValue)> get;
+	std::function<bool(void* convar, float value)> set;
+
+	bool IsBound() const { return find && get && set; }
+
+	// nullptr if the convar doesn't exist (also cached: these are engine convars, present from load).
+	void* Handle(OpticsConVar var)
+	{
+		if (var < 0 || var >= OpticsConVar_Count || !find)
+			return nullptr;
+		if (!m_Resolved[var])
+		{
+			m_Handles[var] = find(GetOpticsConVarName(var));
+			m_Resolved[var] = true;
+			++m_FindCount;
+		}
+		return m_Handles[var];
+	}
+
+	// Forget the cached handles (new access functions bound).
+	void ResetHandles()
+	{
+		m_Handles.fill(nullptr);
+		m_Resolved.fill(false);
+	}
+
+	uint32_t GetFindCount() const { return m_FindCount; }
+
+private:
+	std::array<void*, OpticsConVar_Count> m_Handles{};
+	std::array<bool, OpticsConVar_Count> m_Resolved{};
+	uint32_t m_FindCount = 0;
+};
+
+// Applies a profile's convar overrides on construction and restores the previous values on destruction.
+// Only convars whose current value differs are touched, so a no-op profile costs a few reads.
+class OpticsConVarScope
+{
+public:
+	static constexpr int kMaxOverrides = OpticsConVar_Count;
+
+	OpticsConVarScope(OpticsConVarAccess& access, const OpticsRenderProfile* profile)
+		: m_Access(access)
+	{
+		if (!profile || !m_Access.IsBound())
+			return;
+
+		if (!profile->detailProps)
+			Apply(OpticsConVar_DetailProps, 0.0f);
+		if (!profile->particles)
+			Apply(OpticsConVar_Particles, 0.0f);
+		if (!profile->shadows)
+			Apply(OpticsConVar_Shadows, 0.0f);
+		if (profile->lod >= 0)
+			Apply(OpticsConVar_Lod, static_cast<float>(profile->lod));
+	}
+
+	~OpticsConVarScope()
+	{
+		// Restore in reverse order in case the engine ties any of these together.
+		for (int i = m_Count - 1; i >= 0; --i)
+			m_Access.set(m_Entries[i].convar, m_Entries[i].previous);
+	}
+
+	OpticsConVarScope(const OpticsConVarScope&) = delete;
+	OpticsConVarScope& operator=(const OpticsConVarScope&) = delete;
+
+	int GetAppliedCount() const { return m_Count; }
+
+private:
+	struct Entry
+	{
+		void* convar = nullptr;
+		float previous = 0.0f;
+	};
+
+	void Apply(OpticsConVar var, float value)
+	{
+		if (m_Count >= kMaxOverrides)
+			return;
+
+		void* convar = m_Access.Handle(var);
+		float previous = 0.0f;
+		if (!convar || !m_Access.get(convar, previous) || previous == value)
+			return;
+		if (!m_Access.set(convar, value))
+			return;
+
+		m_Entries[m_Count].convar = convar;
+		m_Entries[m_Count].previous = previous;
+		++m_Count;
+	}
+
+	OpticsConVarAccess& m_Access;
+	std::array<Entry, kMaxOverrides> m_Entries{};
+	int m_Count = 0;
+};
+
+// Everything the config file decides about the optics profiles.
+struct OpticsRenderProfileSet
+{
+	bool enabled = true;
+	bool abTest = false;
+	std::array<OpticsRenderProfile, OpticsRTTScheduler::Pass_Count> profiles{};
+};
+
+// Hands OpticsRenderProfileSet from the config watcher thread to the render thread: two slots and an
+// atomic index. The writer fills the slot the reader isn't pointed at and flips the index; it only
+// waits if the reader is still copying that slot from before the previous flip (a few hundred bytes).
+// One writer, one reader.
+class OpticsRenderProfileMailbox
+{
+public:
+	// Writer.
+	void Publish(const OpticsRenderProfileSet& set)
+	{
+		const uint32_t published = m_Published.load(std::memory_order_seq_cst);
+		const uint32_t slot = (published & 1u) ^ 1u;
+		while (m_Reading.load(std::memory_order_seq_cst) == static_cast<int>(slot))
+			std::this_thread::yield();
+
+		m_Slots[slot] = set;
+		// Low bit: slot index. The rest counts publishes so the reader can skip unchanged sets.
+		m_Published.store(((published >> 1) + 1) << 1 | slot, std::memory_order_seq_cst);
+	}
+
+	// Reader. Copies the latest set into out if anything was published since *generation; returns
+	// whether it did. generation starts at 0 (nothing seen).
+	bool Consume(OpticsRenderProfileSet& out, uint32_t& generation) const
+	{
+		for (;;)
+		{
+			const uint32_t published = m_Published.load(std::memory_order_seq_cst);
+			if ((published >> 1) == generation)
+				return false;
+
+			const int slot = static_cast<int>(published & 1u);
+			m_Reading.store(slot, std::memory_order_seq_cst);
+			// The writer may have flipped twice since our load and be refilling this slot.
+			if (m_Published.load(std::memory_order_seq_cst) != published)
+			{
+				m_Reading.store(-1, std::memory_order_seq_cst);
+				continue;
+			}
+
+			out = m_Slots[slot];
+			m_Reading.store(-1, std::memory_order_seq_cst);
+			generation = published >> 1;
+			return true;
+		}
+	}
+
+private:
+	std::array<OpticsRenderProfileSet, 2> m_Slots{};
+	std::atomic<uint32_t> m_Published{ 0 };
+	mutable std::atomic<int> m_Reading{ -1 };
+};
+
+// Per-pass profile selection plus A/B timing (full vs reduced).
+class OpticsRenderProfiles
+{
+public:
+	enum Variant
+	{
+		Variant_Full = 0,
+		Variant_Reduced,
+		Variant_Count
+	};
+
+	struct VariantStats
+	{
+		uint64_t samples = 0;
+		double lastMs = 0.0;
+		double avgMs = 0.0;   // EMA
+		double totalMs = 0.0;
+	};
+
+	std::array<OpticsRenderProfile, OpticsRTTScheduler::Pass_Count> m_Profiles{};
+	bool m_Enabled = true;
+	// Alternate full / reduced renders per pass so both variants get timed under the same load.
+	bool m_ABTest = false;
+
+	// Render thread: take over a set published by the config thread. A/B stats restart when the
+	// A/B mode flips.
+	void Apply(const OpticsRenderProfileSet& set)
+	{
+		const bool abTest = set.enabled && set.abTest;
+		if (abTest != m_ABTest)
+			ResetStats();
+		m_Enabled = set.enabled;
+		m_ABTest = abTest;
+		m_Profiles = set.profiles;
+	}
+
+	// Picks the variant for the next render of this pass.
+	Variant Select(int pass)
+	{
+		if (pass < 0 || pass >= OpticsRTTScheduler::Pass_Count || !m_Enabled)
+			return Variant_Full;
+		if (!m_ABTest)
+			return Variant_Reduced;
+		return ((m_SelectCount[pass]++ & 1u) == 0) ? Variant_Reduced : Variant_Full;
+	}
+
+	// nullptr means "render exactly like the eye views".
+	const OpticsRenderProfile* Resolve(int pass, Variant variant) const
+	{
+		if (variant != Variant_Reduced || pass < 0 || pass >= OpticsRTTScheduler::Pass_Count)
+			return nullptr;
+		return &m_Profiles[pass];
+	}
+
+	void RecordCost(int pass, Variant variant, double costMs)
+	{
+		if (pass < 0 || pass >= OpticsRTTScheduler::Pass_Count || variant < 0 || variant >= Variant_Count)
+			return;
+		if (!std::isfinite(costMs) || costMs < 0.0)
+			return;
+
+		VariantStats& s = m_Stats[pass][variant];
+		++s.samples;
+		s.lastMs = costMs;
+		s.totalMs += costMs;
+		s.avgMs = (s.samples == 1) ? costMs : (s.avgMs * 0.9 + costMs * 0.1);
+	}
+
+	const VariantStats& GetStats(int pass, Variant variant) const { return m_Stats[pass][variant]; }
+
+	// Reduced cost relative to full, in percent (0 until both variants have samples).
+	double GetSavingsPercent(int pass) const
+	{
+		const VariantStats& full = m_Stats[pass][Variant_Full];
+		const VariantStats& reduced = m_Stats[pass][Variant_Reduced];
+		if (full.samples == 0 || reduced.samples == 0 || !(full.avgMs > 0.0))
+			return 0.0;
+		return (1.0 - reduced.avgMs / full.avgMs) * 100.0;
+	}
+
+	void ResetStats()
+	{
+		for (auto& perPass : m_Stats)
+			for (VariantStats& s : perPass)
+				s = VariantStats{};
+		m_SelectCount.fill(0);
+	}
+
+private:
+	std::array<std::array<VariantStats, Variant_Count>, OpticsRTTScheduler::Pass_Count> m_Stats{};
+	std::array<uint32_t, OpticsRTTScheduler::Pass_Count> m_SelectCount{};
+};
@@ -0,0 +1,309 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+// ------------------------------------------------------------
+// Content-aware update scheduler for the extra optics RTT passes (scope / rear mirror).
+//
+// Each pass is a full extra scene render. A fixed Hz cap re-renders a static mirror at full rate
+// and gives a fast head turn the same rate as standing still. Instead we decide per frame:
+//  - how stale the last RTT is (camera rotation / translation since it was rendered),
+//  - how much frame headroom we currently have (frame interval vs HMD frame budget),
+//  - whether the pass is urgent (special infected seen in the mirror, scope being looked through).
+// Scope and mirror are interleaved so both never land on the same frame.
+//
+// Pure policy: no engine / Windows dependencies, so it can be driven with synthetic motion traces.
+// ------------------------------------------------------------
+class OpticsRTTScheduler
+{
+public:
+	enum Pass
+	{
+		Pass_Scope = 0,
+		Pass_RearMirror,
+		Pass_Count
+	};
+
+	struct PassConfig
+	{
+		// Hard cap (same meaning as the legacy ScopeRTTMaxHz / RearMirrorRTTMaxHz). 0 = uncapped.
+		float maxHz = 90.0f;
+		// Refresh floor for a static camera. Scene content (infected, lights) still moves, so keep this > 0.
+		float minHz = 15.0f;
+		// Camera rotation (degrees) / translation (game units) since the last RTT that warrants running at maxHz.
+		float fullRateAngleDeg = 4.0f;
+		float fullRateDistance = 6.0f;
+	};
+
+	struct Config
+	{
+		std::array<PassConfig, Pass_Count> passes{};
+		// Never render both optics passes in the same frame.
+		bool interleave = true;
+		// Headroom is 1 - frameInterval / frameBudget. Below this we start slowing passes down.
+		// Frame intervals are vsync-paced, so a game holding the display rate reads ~0 no matter how
+		// much GPU time is spare: only start once frames are actually being missed.
+		float headroomLow = -0.05f;
+		// Fraction of maxHz kept when we're badly over budget (urgent passes ignore this).
+		float overBudgetRateScale = 0.35f;
+	};
+
+	struct PassRequest
+	{
+		bool wanted = false;
+		// Bypass the headroom scale and staleness check (still respects maxHz).
+		bool urgent = false;
+		float pos[3] = { 0.0f, 0.0f, 0.0f };
+		float ang[3] = { 0.0f, 0.0f, 0.0f }; // pitch, yaw, roll (degrees)
+	};
+
+	struct PassCounters
+	{
+		uint64_t requested = 0;
+		uint64_t rendered = 0;
+		uint64_t skippedRate = 0;       // maxHz / headroom cap
+		uint64_t skippedStatic = 0;     // camera hasn't moved enough yet
+		uint64_t deferredInterleave = 0; // due, but the other pass took this frame
+		uint64_t urgent = 0;
+		double lastCostMs = 0.0;
+		double avgCostMs = 0.0;          // EMA
+		double maxCostMs = 0.0;
+		double totalCostMs = 0.0;
+	};
+
+	Config m_Config{};
+
+	// Returns a bitmask of passes to render this frame (1 << Pass).
+	// nowSec is any monotonic clock; frameBudgetSec is the HMD frame time (<= 0 disables headroom scaling).
+	uint32_t PlanFrame(double nowSec, float frameBudgetSec, const std::array<PassRequest, Pass_Count>& requests)
+	{
+		UpdateHeadroom(nowSec, frameBudgetSec);
+		++m_FrameIndex;
+
+		std::array<float, Pass_Count> priority{};
+		std::array<bool, Pass_Count> due{};
+		for (int i = 0; i < Pass_Count; ++i)
+		{
+			priority[i] = 0.0f;
+			due[i] = false;
+
+			const PassRequest& req = requests[i];
+			if (!req.wanted)
+			{
+				// Force a refresh as soon as the pass comes back (texture content is stale).
+				m_State[i].hasLast = false;
+				continue;
+			}
+
+			PassCounters& c = m_Counters[i];
+			++c.requested;
+
+			float ratio = 0.0f;
+			const Decision d = Evaluate(i, nowSec, req, ratio);
+			if (d == Decision::Due)
+			{
+				due[i] = true;
+				priority[i] = ratio;
+				if (req.urgent)
+					++c.urgent;
+			}
+			else if (d == Decision::RateLimited)
+			{
+				++c.skippedRate;
+			}
+			else
+			{
+				++c.skippedStatic;
+			}
+		}
+
+		if (m_Config.interleave && due[Pass_Scope] && due[Pass_RearMirror])
+		{
+			// Most overdue wins; on a tie alternate away from whoever ran last.
+			int winner = Pass_Scope;
+			if (priority[Pass_RearMirror] > priority[Pass_Scope])
+				winner = Pass_RearMirror;
+			else if (priority[Pass_RearMirror] == priority[Pass_Scope])
+				winner = (m_LastRenderedPass == Pass_Scope) ? Pass_RearMirror : Pass_Scope;
+
+			const int loser = (winner == Pass_Scope) ? Pass_RearMirror : Pass_Scope;
+			due[loser] = false;
+			++m_Counters[loser].deferredInterleave;
+		}
+
+		uint32_t mask = 0;
+		for (int i = 0; i < Pass_Count; ++i)
+		{
+			if (!due[i])
+				continue;
+
+			PassState& s = m_State[i];
+			s.hasLast = true;
+			s.lastTime = nowSec;
+			for (int k = 0; k < 3; ++k)
+			{
+				s.lastPos[k] = requests[i].pos[k];
+				s.lastAng[k] = requests[i].ang[k];
+			}
+			++m_Counters[i].rendered;
+			m_LastRenderedPass = i;
+			mask |= (1u << i);
+		}
+		return mask;
+	}
+
+	// Feed back the measured CPU cost of a pass that PlanFrame() scheduled.
+	void RecordCost(Pass pass, double costMs)
+	{
+		if (pass < 0 || pass >= Pass_Count || !std::isfinite(costMs) || costMs < 0.0)
+			return;
+
+		PassCounters& c = m_Counters[pass];
+		c.lastCostMs = costMs;
+		c.totalCostMs += costMs;
+		c.maxCostMs = std::max(c.maxCostMs, costMs);
+		c.avgCostMs = (c.avgCostMs <= 0.0) ? costMs : (c.avgCostMs * 0.9 + costMs * 0.1);
+	}
+
+	// Drop timing history (map change, config reload). Counters are kept.
+	void Reset()
+	{
+		for (PassState& s : m_State)
+			s = PassState{};
+		m_HasLastFrameTime = false;
+		m_Headroom = 1.0f;
+		m_LastRenderedPass = -1;
+	}
+
+	void ResetCounters()
+	{
+		for (PassCounters& c : m_Counters)
+			c = PassCounters{};
+	}
+
+	const PassCounters& GetCounters(Pass pass) const { return m_Counters[pass]; }
+	float GetHeadroom() const { return m_Headroom; }
+	uint64_t GetFrameIndex() const { return m_FrameIndex; }
+
+	// Rate multiplier applied to non-urgent passes for the current headroom (1 = no slowdown).
+	float GetHeadroomRateScale() const
+	{
+		const float low = m_Config.headroomLow;
+		if (m_Headroom >= low)
+			return 1.0f;
+		// Fully scaled down once we're a further 25% over budget.
+		const float t = std::clamp((low - m_Headroom) / 0.25f, 0.0f, 1.0f);
+		const float floorScale = std::clamp(m_Config.overBudgetRateScale, 0.05f, 1.0f);
+		return 1.0f - t * (1.0f - floorScale);
+	}
+
+private:
+	enum class Decision
+	{
+		Due,
+		RateLimited,
+		Static
+	};
+
+	struct PassState
+	{
+		bool hasLast = false;
+		double lastTime = 0.0;
+		float lastPos[3] = { 0.0f, 0.0f, 0.0f };
+		float lastAng[3] = { 0.0f, 0.0f, 0.0f };
+	};
+
+	static float AngleDiffDeg(float a, float b)
+	{
+		float d = std::fmod(a - b, 360.0f);
+		if (d > 180.0f) d -= 360.0f;
+		if (d < -180.0f) d += 360.0f;
+		return std::fabs(d);
+	}
+
+	static float IntervalForHz(float hz)
+	{
+		return (hz > 0.0f) ? (1.0f / hz) : 0.0f;
+	}
+
+	// Frames land on the vsync grid with jitter: a pass capped at the display rate sees elapsed values
+	// a hair under its interval and would otherwise run every other frame.
+	static constexpr float kIntervalSlack = 0.9f;
+
+	void UpdateHeadroom(double nowSec, float frameBudgetSec)
+	{
+		if (m_HasLastFrameTime && frameBudgetSec > 0.0f)
+		{
+			const float frameSec = static_cast<float>(nowSec - m_LastFrameTime);
+			// Ignore hitches (alt-tab, loading) so one stall doesn't throttle optics for seconds.
+			if (frameSec > 0.0f && frameSec < 0.25f)
+			{
+				const float headroom = std::clamp(1.0f - frameSec / frameBudgetSec, -1.0f, 1.0f);
+				m_Headroom = m_Headroom * 0.85f + headroom * 0.15f;
+			}
+		}
+		m_LastFrameTime = nowSec;
+		m_HasLastFrameTime = true;
+	}
+
+	Decision Evaluate(int pass, double nowSec, const PassRequest& req, float& outOverdueRatio) const
+	{
+		const PassConfig& cfg = m_Config.passes[pass];
+		const PassState& s = m_State[pass];
+		if (!s.hasLast)
+		{
+			outOverdueRatio = std::numeric_limits<float>::max();
+			return Decision::Due;
+		}
+
+		const float elapsed = static_cast<float>(nowSec - s.lastTime);
+
+		// Hard cap, scaled down when we're missing the frame budget.
+		const float maxHz = (cfg.maxHz > 0.0f)
+			? (req.urgent ? cfg.maxHz : cfg.maxHz * GetHeadroomRateScale())
+			: 0.0f;
+		const float minInterval = IntervalForHz(maxHz);
+		if (elapsed < minInterval * kIntervalSlack)
+			return Decision::RateLimited;
+
+		if (req.urgent)
+		{
+			outOverdueRatio = (minInterval > 0.0f) ? (elapsed / minInterval) : 1.0f;
+			return Decision::Due;
+		}
+
+		// Staleness: 0 = camera hasn't moved since the last RTT, 1 = moved enough for a full-rate refresh.
+		float angDelta = 0.0f;
+		float distSqr = 0.0f;
+		for (int k = 0; k < 3; ++k)
+		{
+			angDelta = std::max(angDelta, AngleDiffDeg(req.ang[k], s.lastAng[k]));
+			const float d = req.pos[k] - s.lastPos[k];
+			distSqr += d * d;
+		}
+		const float angTerm = (cfg.fullRateAngleDeg > 0.0f) ? (angDelta / cfg.fullRateAngleDeg) : 0.0f;
+		const float posTerm = (cfg.fullRateDistance > 0.0f) ? (std::sqrt(distSqr) / cfg.fullRateDistance) : 0.0f;
+		const float motion = std::clamp(std::max(angTerm, posTerm), 0.0f, 1.0f);
+
+		// Interpolate the required interval between the static floor and the (scaled) cap.
+		const float minHz = (cfg.minHz > 0.0f) ? std::min(cfg.minHz, (maxHz > 0.0f) ? maxHz : cfg.minHz) : 0.0f;
+		const float staticInterval = (minHz > 0.0f) ? (1.0f / minHz) : 1.0f;
+		const float required = staticInterval + (minInterval - staticInterval) * motion;
+		if (elapsed < required * kIntervalSlack)
+			return Decision::Static;
+
+		outOverdueRatio = (required > 0.0f) ? (elapsed / required) : 1.0f;
+		return Decision::Due;
+	}
+
+	std::array<PassState, Pass_Count> m_State{};
+	std::array<PassCounters, Pass_Count> m_Counters{};
+	double m_LastFrameTime = 0.0;
+	bool m_HasLastFrameTime = false;
+	float m_Headroom = 1.0f;
+	uint64_t m_FrameIndex = 0;
+	int m_LastRenderedPass = -1;
+};
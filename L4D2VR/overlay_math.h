@@ -0,0 +1,447 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OVERLAY_MATH_SSE 1
+#else
+#define OVERLAY_MATH_SSE 0
+#endif
+
+// ------------------------------------------------------------
+// Overlay transform math.
+//
+// Overlay placement used to rebuild the HMD basis by hand in every overlay function (scalar Vector
+// math, VectorNormalize, CrossProduct, an Euler matrix product per call). This is a small 3x4 library
+// laid out like vr::HmdMatrix34_t (row-major, translation in column 3) so conversion is a copy:
+//  - Vec3 / Quat / Mat34 are 16-byte aligned; Mat34 rows load straight into SSE registers,
+//  - Compose, InverseRigid, Inverse and TransformPoints have SSE kernels, with *Scalar reference
+//    versions used where SSE is unavailable and to check the kernels,
+//  - OverlayFrame derives the per-frame transforms every overlay starts from: the HMD pose, the
+//    yaw-only body frame (right, up, back) at the HMD, and Source world -> HMD-relative meters.
+// OpenVR tracking space: +X right, +Y up, +Z back. No engine / Windows dependencies.
+// ------------------------------------------------------------
+
+struct alignas(16) Vec3
+{
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+	float w = 0.0f;   // padding, keeps loads aligned
+
+	Vec3() = default;
+	Vec3(float x_, float y_, float z_) : x(x_), y(y_), z(z_) {}
+
+	Vec3 operator+(const Vec3& o) const { return Vec3(x + o.x, y + o.y, z + o.z); }
+	Vec3 operator-(const Vec3& o) const { return Vec3(x - o.x, y - o.y, z - o.z); }
+	Vec3 operator-() const { return Vec3(-x, -y, -z); }
+	Vec3 operator*(float s) const { return Vec3(x * s, y * s, z * s); }
+
+	static float Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	static Vec3 Cross(const Vec3& a, const Vec3& b)
+	{
+		return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+	}
+	float Length() const { return std::sqrt(Dot(*this, *this)); }
+
+	// Normalizes in place; returns the old length (0 leaves the vector untouched).
+	float Normalize()
+	{
+		const float len = Length();
+		if (len > 0.0f)
+		{
+			const float inv = 1.0f / len;
+			x *= inv;
+			y *= inv;
+			z *= inv;
+		}
+		return len;
+	}
+};
+
+struct alignas(16) Quat
+{
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+	float w = 1.0f;
+
+	Quat() = default;
+	Quat(float x_, float y_, float z_, float w_) : x(x_), y(y_), z(z_), w(w_) {}
+
+	// axis must be unit length.
+	static Quat FromAxisAngle(const Vec3& axis, float radians)
+	{
+		const float s = std::sin(radians * 0.5f);
+		return Quat(axis.x * s, axis.y * s, axis.z * s, std::cos(radians * 0.5f));
+	}
+
+	Quat operator*(const Quat& b) const
+	{
+		return Quat(
+			w * b.x + x * b.w + y * b.z - z * b.y,
+			w * b.y - x * b.z + y * b.w + z * b.x,
+			w * b.z + x * b.y - y * b.x + z * b.w,
+			w * b.w - x * b.x - y * b.y - z * b.z);
+	}
+
+	Vec3 Rotate(const Vec3& v) const
+	{
+		const Vec3 u(x, y, z);
+		const Vec3 t = Vec3::Cross(u, v) * 2.0f;
+		return v + t * w + Vec3::Cross(u, t);
+	}
+};
+
+struct alignas(16) Mat34
+{
+	float m[3][4] =
+	{
+		{ 1.0f, 0.0f, 0.0f, 0.0f },
+		{ 0.0f, 1.0f, 0.0f, 0.0f },
+		{ 0.0f, 0.0f, 1.0f, 0.0f }
+	};
+
+	static Mat34 Identity() { return Mat34(); }
+
+	static Mat34 Translation(float x, float y, float z)
+	{
+		Mat34 out;
+		out.m[0][3] = x;
+		out.m[1][3] = y;
+		out.m[2][3] = z;
+		return out;
+	}
+
+	static Mat34 Scale(float x, float y, float z)
+	{
+		Mat34 out;
+		out.m[0][0] = x;
+		out.m[1][1] = y;
+		out.m[2][2] = z;
+		return out;
+	}
+
+	// Columns are the basis axes, translation is the origin.
+	static Mat34 FromBasis(const Vec3& xAxis, const Vec3& yAxis, const Vec3& zAxis, const Vec3& origin)
+	{
+		Mat34 out;
+		const Vec3* cols[4] = { &xAxis, &yAxis, &zAxis, &origin };
+		for (int c = 0; c < 4; ++c)
+		{
+			out.m[0][c] = cols[c]->x;
+			out.m[1][c] = cols[c]->y;
+			out.m[2][c] = cols[c]->z;
+		}
+		return out;
+	}
+
+	static Mat34 FromQuat(const Quat& q, const Vec3& origin = Vec3())
+	{
+		const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+		const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+		const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+		Mat34 out;
+		out.m[0][0] = 1.0f - 2.0f * (yy + zz); out.m[0][1] = 2.0f * (xy - wz);        out.m[0][2] = 2.0f * (xz + wy);        out.m[0][3] = origin.x;
+		out.m[1][0] = 2.0f * (xy + wz);        out.m[1][1] = 1.0f - 2.0f * (xx + zz); out.m[1][2] = 2.0f * (yz - wx);        out.m[1][3] = origin.y;
+		out.m[2][0] = 2.0f * (xz - wy);        out.m[2][1] = 2.0f * (yz + wx);        out.m[2][2] = 1.0f - 2.0f * (xx + yy); out.m[2][3] = origin.z;
+		return out;
+	}
+
+	// Rz(roll) * Ry(yaw) * Rx(pitch): the convention of the hand HUD, scope and mirror angle offsets.
+	static Mat34 RotationZYXDeg(float pitch, float yaw, float roll, const Vec3& origin = Vec3())
+	{
+		return FromQuat(AxisQuat(2, roll) * AxisQuat(1, yaw) * AxisQuat(0, pitch), origin);
+	}
+
+	// Rx(pitch) * Ry(yaw) * Rz(roll): the absolute (mouse mode / third-person) scope overlay.
+	static Mat34 RotationXYZDeg(float pitch, float yaw, float roll, const Vec3& origin = Vec3())
+	{
+		return FromQuat(AxisQuat(0, pitch) * AxisQuat(1, yaw) * AxisQuat(2, roll), origin);
+	}
+
+	// T is any struct with float m[3][4] (vr::HmdMatrix34_t).
+	template <typename T>
+	static Mat34 From(const T& src)
+	{
+		static_assert(sizeof(src.m) == sizeof(float) * 12, "expected a 3x4 float matrix");
+		Mat34 out;
+		std::memcpy(out.m, src.m, sizeof(out.m));
+		return out;
+	}
+
+	template <typename T>
+	T To() const
+	{
+		T out;
+		static_assert(sizeof(out.m) == sizeof(float) * 12, "expected a 3x4 float matrix");
+		std::memcpy(out.m, m, sizeof(m));
+		return out;
+	}
+
+	Vec3 Column(int c) const { return Vec3(m[0][c], m[1][c], m[2][c]); }
+	Vec3 Origin() const { return Column(3); }
+	void SetOrigin(const Vec3& p)
+	{
+		m[0][3] = p.x;
+		m[1][3] = p.y;
+		m[2][3] = p.z;
+	}
+
+private:
+	static Quat AxisQuat(int axis, float degrees)
+	{
+		const Vec3 axes[3] = { Vec3(1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f), Vec3(0.0f, 0.0f, 1.0f) };
+		return Quat::FromAxisAngle(axes[axis], degrees * (3.14159265358979323846f / 180.0f));
+	}
+};
+
+namespace Mat34Math
+{
+	// ---- scalar reference kernels ----
+
+	inline Mat34 ComposeScalar(const Mat34& a, const Mat34& b)
+	{
+		Mat34 out;
+		for (int r = 0; r < 3; ++r)
+		{
+			for (int c = 0; c < 4; ++c)
+				out.m[r][c] = a.m[r][0] * b.m[0][c] + a.m[r][1] * b.m[1][c] + a.m[r][2] * b.m[2][c];
+			out.m[r][3] += a.m[r][3];
+		}
+		return out;
+	}
+
+	inline Vec3 TransformPointScalar(const Mat34& a, const Vec3& p)
+	{
+		return Vec3(
+			a.m[0][0] * p.x + a.m[0][1] * p.y + a.m[0][2] * p.z + a.m[0][3],
+			a.m[1][0] * p.x + a.m[1][1] * p.y + a.m[1][2] * p.z + a.m[1][3],
+			a.m[2][0] * p.x + a.m[2][1] * p.y + a.m[2][2] * p.z + a.m[2][3]);
+	}
+
+	inline void TransformPointsScalar(const Mat34& a, const Vec3* in, Vec3* out, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+			out[i] = TransformPointScalar(a, in[i]);
+	}
+
+	// Rotation part must be orthonormal.
+	inline Mat34 InverseRigidScalar(const Mat34& a)
+	{
+		Mat34 out;
+		for (int r = 0; r < 3; ++r)
+		{
+			for (int c = 0; c < 3; ++c)
+				out.m[r][c] = a.m[c][r];
+			out.m[r][3] = -(a.m[0][r] * a.m[0][3] + a.m[1][r] * a.m[1][3] + a.m[2][r] * a.m[2][3]);
+		}
+		return out;
+	}
+
+	// General affine inverse; false (out untouched) when the 3x3 part is singular.
+	inline bool InverseScalar(const Mat34& a, Mat34& out)
+	{
+		const Vec3 r0(a.m[0][0], a.m[0][1], a.m[0][2]);
+		const Vec3 r1(a.m[1][0], a.m[1][1], a.m[1][2]);
+		const Vec3 r2(a.m[2][0], a.m[2][1], a.m[2][2]);
+		const Vec3 c0 = Vec3::Cross(r1, r2);
+		const Vec3 c1 = Vec3::Cross(r2, r0);
+		const Vec3 c2 = Vec3::Cross(r0, r1);
+		const float det = Vec3::Dot(r0, c0);
+		if (!(std::fabs(det) > 1e-12f))
+			return false;
+		const float inv = 1.0f / det;
+		Mat34 result = Mat34::FromBasis(c0 * inv, c1 * inv, c2 * inv, Vec3());
+		for (int r = 0; r < 3; ++r)
+			result.m[r][3] = -(result.m[r][0] * a.m[0][3] + result.m[r][1] * a.m[1][3] + result.m[r][2] * a.m[2][3]);
+		out = result;
+		return true;
+	}
+
+#if OVERLAY_MATH_SSE
+	// ---- SSE kernels ----
+
+	inline __m128 Splat(__m128 v, int lane)
+	{
+		switch (lane)
+		{
+		case 0: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+		case 1: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+		case 2: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+		default: return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+		}
+	}
+
+	inline __m128 Cross(__m128 a, __m128 b)
+	{
+		const __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+		const __m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+		const __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+		return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+	}
+
+	// Rows of the result are the first three columns of the 4x4 transpose of (r0, r1, r2, r3).
+	inline void StoreTransposed(__m128 r0, __m128 r1, __m128 r2, __m128 r3, Mat34& out)
+	{
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		_mm_store_ps(out.m[0], r0);
+		_mm_store_ps(out.m[1], r1);
+		_mm_store_ps(out.m[2], r2);
+	}
+
+	inline Mat34 Compose(const Mat34& a, const Mat34& b)
+	{
+		const __m128 b0 = _mm_load_ps(b.m[0]);
+		const __m128 b1 = _mm_load_ps(b.m[1]);
+		const __m128 b2 = _mm_load_ps(b.m[2]);
+		// a's own translation is added by keeping only lane 3 of its row.
+		const __m128 lane3 = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+		Mat34 out;
+		for (int r = 0; r < 3; ++r)
+		{
+			const __m128 ar = _mm_load_ps(a.m[r]);
+			__m128 v = _mm_and_ps(ar, lane3);
+			v = _mm_add_ps(v, _mm_mul_ps(Splat(ar, 0), b0));
+			v = _mm_add_ps(v, _mm_mul_ps(Splat(ar, 1), b1));
+			v = _mm_add_ps(v, _mm_mul_ps(Splat(ar, 2), b2));
+			_mm_store_ps(out.m[r], v);
+		}
+		return out;
+	}
+
+	inline void TransformPoints(const Mat34& a, const Vec3* in, Vec3* out, size_t count)
+	{
+		__m128 c0 = _mm_load_ps(a.m[0]);
+		__m128 c1 = _mm_load_ps(a.m[1]);
+		__m128 c2 = _mm_load_ps(a.m[2]);
+		__m128 c3 = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);   // now the columns; c3 is the translation
+		for (size_t i = 0; i < count; ++i)
+		{
+			const __m128 p = _mm_load_ps(&in[i].x);
+			__m128 v = _mm_add_ps(c3, _mm_mul_ps(Splat(p, 0), c0));
+			v = _mm_add_ps(v, _mm_mul_ps(Splat(p, 1), c1));
+			v = _mm_add_ps(v, _mm_mul_ps(Splat(p, 2), c2));
+			_mm_store_ps(&out[i].x, v);
+		}
+	}
+
+	inline Vec3 TransformPoint(const Mat34& a, const Vec3& p)
+	{
+		Vec3 out;
+		TransformPoints(a, &p, &out, 1);
+		return out;
+	}
+
+	inline Mat34 InverseRigid(const Mat34& a)
+	{
+		const __m128 r0 = _mm_load_ps(a.m[0]);
+		const __m128 r1 = _mm_load_ps(a.m[1]);
+		const __m128 r2 = _mm_load_ps(a.m[2]);
+		// t' = -(R^T t) = -(r0 * t0 + r1 * t1 + r2 * t2); lane 3 is garbage and transposes away.
+		__m128 t = _mm_mul_ps(r0, Splat(r0, 3));
+		t = _mm_add_ps(t, _mm_mul_ps(r1, Splat(r1, 3)));
+		t = _mm_add_ps(t, _mm_mul_ps(r2, Splat(r2, 3)));
+		t = _mm_sub_ps(_mm_setzero_ps(), t);
+		Mat34 out;
+		StoreTransposed(r0, r1, r2, t, out);
+		return out;
+	}
+
+	inline bool Inverse(const Mat34& a, Mat34& out)
+	{
+		const __m128 r0 = _mm_load_ps(a.m[0]);
+		const __m128 r1 = _mm_load_ps(a.m[1]);
+		const __m128 r2 = _mm_load_ps(a.m[2]);
+		// Columns of the inverse 3x3 are the row cross products over the determinant.
+		__m128 x0 = Cross(r1, r2);
+		__m128 x1 = Cross(r2, r0);
+		__m128 x2 = Cross(r0, r1);
+		const float det = a.m[0][0] * _mm_cvtss_f32(x0)
+			+ a.m[0][1] * _mm_cvtss_f32(Splat(x0, 1))
+			+ a.m[0][2] * _mm_cvtss_f32(Splat(x0, 2));
+		if (!(std::fabs(det) > 1e-12f))
+			return false;
+		const __m128 inv = _mm_set1_ps(1.0f / det);
+		x0 = _mm_mul_ps(x0, inv);
+		x1 = _mm_mul_ps(x1, inv);
+		x2 = _mm_mul_ps(x2, inv);
+		__m128 t = _mm_mul_ps(x0, Splat(r0, 3));
+		t = _mm_add_ps(t, _mm_mul_ps(x1, Splat(r1, 3)));
+		t = _mm_add_ps(t, _mm_mul_ps(x2, Splat(r2, 3)));
+		t = _mm_sub_ps(_mm_setzero_ps(), t);
+		StoreTransposed(x0, x1, x2, t, out);
+		return true;
+	}
+#else
+	inline Mat34 Compose(const Mat34& a, const Mat34& b) { return ComposeScalar(a, b); }
+	inline void TransformPoints(const Mat34& a, const Vec3* in, Vec3* out, size_t count) { TransformPointsScalar(a, in, out, count); }
+	inline Vec3 TransformPoint(const Mat34& a, const Vec3& p) { return TransformPointScalar(a, p); }
+	inline Mat34 InverseRigid(const Mat34& a) { return InverseRigidScalar(a); }
+	inline bool Inverse(const Mat34& a, Mat34& out) { return InverseScalar(a, out); }
+#endif
+}
+
+// Per-frame overlay anchors, rebuilt when new poses / a new view arrive.
+struct OverlayFrame
+{
+	bool hmdValid = false;
+	Mat34 trackingFromHmd;     // HMD pose, basis columns normalized
+	Mat34 trackingFromBody;    // yaw-only (right, up, back) at the HMD position
+
+	bool worldValid = false;
+	Mat34 hmdFromWorld;        // Source units -> meters along (right, up, back) of the HMD
+
+	// hmdPose is mDeviceToAbsoluteTracking.
+	template <typename T>
+	void SetHmdPose(const T& hmdPose, bool poseValid)
+	{
+		const Mat34 pose = Mat34::From(hmdPose);
+		Vec3 right = pose.Column(0);
+		Vec3 up = pose.Column(1);
+		Vec3 back = pose.Column(2);
+		const Vec3 origin = pose.Origin();
+		hmdValid = poseValid && right.Normalize() > 0.0f && up.Normalize() > 0.0f && back.Normalize() > 0.0f;
+		if (!hmdValid)
+			return;
+		trackingFromHmd = Mat34::FromBasis(right, up, back, origin);
+
+		// fwd lies in the floor plane, so fwd x up is already unit length.
+		Vec3 fwd(-pose.m[0][2], 0.0f, -pose.m[2][2]);
+		if (fwd.Normalize() == 0.0f)
+			fwd = Vec3(0.0f, 0.0f, -1.0f);
+		trackingFromBody = Mat34::FromBasis(Vec3(-fwd.z, 0.0f, fwd.x), Vec3(0.0f, 1.0f, 0.0f), -fwd, origin);
+	}
+
+	// View basis in Source space (forward, right, up) at eye, and the world scale.
+	bool SetWorldView(const Vec3& eye, Vec3 forward, Vec3 right, Vec3 up, float unitsPerMeter)
+	{
+		worldValid = forward.Normalize() > 0.0f && right.Normalize() > 0.0f && up.Normalize() > 0.0f;
+		if (!worldValid)
+			return false;
+		const float s = 1.0f / (unitsPerMeter > 1.0f ? unitsPerMeter : 1.0f);
+		const Vec3 rows[3] = { right * s, up * s, forward * -s };
+		for (int r = 0; r < 3; ++r)
+		{
+			hmdFromWorld.m[r][0] = rows[r].x;
+			hmdFromWorld.m[r][1] = rows[r].y;
+			hmdFromWorld.m[r][2] = rows[r].z;
+			hmdFromWorld.m[r][3] = -Vec3::Dot(rows[r], eye);
+		}
+		return true;
+	}
+
+	// A point given as (forward, right, up) meters in the body frame, in tracking space.
+	Vec3 BodyPoint(float forward, float right, float up) const
+	{
+		return Mat34Math::TransformPoint(trackingFromBody, Vec3(right, up, -forward));
+	}
+
+	Vec3 HmdPoint(float forward, float right, float up) const
+	{
+		return Mat34Math::TransformPoint(trackingFromHmd, Vec3(right, up, -forward));
+	}
+};
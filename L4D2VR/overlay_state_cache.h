@@ -0,0 +1,314 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "openvr.h"
+
+// ------------------------------------------------------------
+// Diffing layer in front of IVROverlay.
+//
+// Every IVROverlay call is an IPC round trip to vrcompositor, and SubmitVRTextures / ProcessInput
+// used to re-issue Show/Hide/alpha/bounds/texture/flag calls for every overlay on every frame.
+// Callers now describe the state they want; Flush() (once per frame) issues only what changed.
+//  - Visibility, alpha, curvature, texture bounds, texture and flags are deferred until Flush().
+//  - Textures carry a content key (texture generation + render counter); an unchanged key is elided,
+//    and uploads for hidden overlays are postponed until the overlay is shown.
+//  - Transform / width are written through immediately (other code reads them back in the same frame),
+//    but still elided when identical.
+//
+// Only use it for handles whose state isn't also changed with direct IVROverlay calls, or call
+// Invalidate() after such calls. Single-threaded (VR::Update thread).
+// OverlayApi is vr::IVROverlay in the game; any type with the same member functions works (e.g. a
+// recording fake).
+// ------------------------------------------------------------
+template <typename OverlayApi>
+class OverlayStateCache
+{
+public:
+	struct Counters
+	{
+		uint64_t requested = 0;
+		uint64_t issued = 0;
+		uint64_t flushes = 0;
+		uint64_t Elided() const { return (requested > issued) ? (requested - issued) : 0; }
+	};
+
+	void SetApi(OverlayApi* api) { m_Api = api; }
+	OverlayApi* GetApi() const { return m_Api; }
+
+	void SetVisible(vr::VROverlayHandle_t handle, bool visible)
+	{
+		Entry* e = Find(handle, true);
+		++m_Counters.requested;
+		e->want.hasVisible = true;
+		e->want.visible = visible;
+	}
+	void Show(vr::VROverlayHandle_t handle) { SetVisible(handle, true); }
+	void Hide(vr::VROverlayHandle_t handle) { SetVisible(handle, false); }
+
+	// Desired visibility (what the compositor will have after the next Flush()).
+	bool IsVisible(vr::VROverlayHandle_t handle) const
+	{
+		const Entry* e = Find(handle);
+		return e && e->want.hasVisible && e->want.visible;
+	}
+
+	void SetAlpha(vr::VROverlayHandle_t handle, float alpha)
+	{
+		Entry* e = Find(handle, true);
+		++m_Counters.requested;
+		e->want.hasAlpha = true;
+		e->want.alpha = alpha;
+	}
+
+	void SetCurvature(vr::VROverlayHandle_t handle, float curvature)
+	{
+		Entry* e = Find(handle, true);
+		++m_Counters.requested;
+		e->want.hasCurvature = true;
+		e->want.curvature = curvature;
+	}
+
+	void SetTextureBounds(vr::VROverlayHandle_t handle, const vr::VRTextureBounds_t& bounds)
+	{
+		Entry* e = Find(handle, true);
+		++m_Counters.requested;
+		e->want.hasBounds = true;
+		e->want.bounds = bounds;
+	}
+
+	// The texture descriptor is copied, so it doesn't need to outlive this call.
+	void SetTexture(vr::VROverlayHandle_t handle, const vr::Texture_t& texture, uint64_t contentKey)
+	{
+		Entry* e = Find(handle, true);
+		++m_Counters.requested;
+		e->want.hasTexture = true;
+		e->want.textureKey = contentKey;
+		e->want.texture = texture;
+		e->want.ownsVulkanData = (texture.eType == vr::TextureType_Vulkan && texture.handle);
+		if (e->want.ownsVulkanData)
+			std::memcpy(&e->want.vulkanData, texture.handle, sizeof(vr::VRVulkanTextureData_t));
+	}
+
+	void SetFlag(vr::VROverlayHandle_t handle, vr::VROverlayFlags flag, bool enabled)
+	{
+		Entry* e = Find(handle, true);
+		++m_Counters.requested;
+		const uint32_t bit = static_cast<uint32_t>(flag);
+		e->want.flagMask |= bit;
+		if (enabled)
+			e->want.flagValues |= bit;
+		else
+			e->want.flagValues &= ~bit;
+	}
+
+	vr::EVROverlayError SetTransformAbsolute(vr::VROverlayHandle_t handle, vr::ETrackingUniverseOrigin origin, const vr::HmdMatrix34_t& transform)
+	{
+		Entry* e = Find(handle, true);
+		++m_Counters.requested;
+		if (e->issued.hasTransform && e->issued.origin == origin
+			&& std::memcmp(&e->issued.transform, &transform, sizeof(transform)) == 0)
+			return vr::VROverlayError_None;
+		if (!m_Api)
+			return vr::VROverlayError_RequestFailed;
+
+		++m_Counters.issued;
+		const vr::EVROverlayError err = m_Api->SetOverlayTransformAbsolute(handle, origin, &transform);
+		e->issued.hasTransform = (err == vr::VROverlayError_None);
+		e->issued.origin = origin;
+		e->issued.transform = transform;
+		return err;
+	}
+
+	vr::EVROverlayError SetWidthInMeters(vr::VROverlayHandle_t handle, float widthMeters)
+	{
+		Entry* e = Find(handle, true);
+		++m_Counters.requested;
+		if (e->issued.hasWidth && e->issued.width == widthMeters)
+			return vr::VROverlayError_None;
+		if (!m_Api)
+			return vr::VROverlayError_RequestFailed;
+
+		++m_Counters.issued;
+		const vr::EVROverlayError err = m_Api->SetOverlayWidthInMeters(handle, widthMeters);
+		e->issued.hasWidth = (err == vr::VROverlayError_None);
+		e->issued.width = widthMeters;
+		return err;
+	}
+
+	// Forget what we think the compositor has (after direct IVROverlay calls or overlay recreation).
+	// Desired state is kept and will be re-issued on the next Flush().
+	void Invalidate(vr::VROverlayHandle_t handle)
+	{
+		if (Entry* e = Find(handle))
+			e->issued = Issued{};
+	}
+
+	void InvalidateAll()
+	{
+		for (Entry& e : m_Entries)
+			e.issued = Issued{};
+	}
+
+	// Issue everything that differs from the last issued state. Order per overlay: bounds, texture,
+	// alpha, curvature, flags, visibility (so an overlay never becomes visible with stale content).
+	void Flush()
+	{
+		++m_Counters.flushes;
+		if (!m_Api)
+			return;
+
+		for (Entry& e : m_Entries)
+		{
+			const Desired& want = e.want;
+			Issued& have = e.issued;
+			const bool willBeVisible = want.hasVisible ? want.visible : (have.hasVisible && have.visible);
+
+			if (want.hasBounds && (!have.hasBounds || std::memcmp(&have.bounds, &want.bounds, sizeof(want.bounds)) != 0))
+			{
+				Issue(have.hasBounds, m_Api->SetOverlayTextureBounds(e.handle, &want.bounds));
+				have.bounds = want.bounds;
+			}
+
+			// Hidden overlays don't need fresh pixels; upload once they're about to be shown.
+			if (want.hasTexture && willBeVisible && (!have.hasTexture || have.textureKey != want.textureKey))
+			{
+				vr::Texture_t texture = want.texture;
+				if (want.ownsVulkanData)
+					texture.handle = const_cast<vr::VRVulkanTextureData_t*>(&want.vulkanData);
+				Issue(have.hasTexture, m_Api->SetOverlayTexture(e.handle, &texture));
+				have.textureKey = want.textureKey;
+			}
+
+			if (want.hasAlpha && (!have.hasAlpha || have.alpha != want.alpha))
+			{
+				Issue(have.hasAlpha, m_Api->SetOverlayAlpha(e.handle, want.alpha));
+				have.alpha = want.alpha;
+			}
+
+			if (want.hasCurvature && (!have.hasCurvature || have.curvature != want.curvature))
+			{
+				Issue(have.hasCurvature, m_Api->SetOverlayCurvature(e.handle, want.curvature));
+				have.curvature = want.curvature;
+			}
+
+			const uint32_t changedFlags = want.flagMask & ~(have.flagMask & ~(have.flagValues ^ want.flagValues));
+			if (changedFlags)
+			{
+				for (uint32_t bit = 1; bit != 0; bit <<= 1)
+				{
+					if (!(changedFlags & bit))
+						continue;
+					const bool enabled = (want.flagValues & bit) != 0;
+					bool ok = false;
+					Issue(ok, m_Api->SetOverlayFlag(e.handle, static_cast<vr::VROverlayFlags>(bit), enabled));
+					if (ok)
+					{
+						have.flagMask |= bit;
+						have.flagValues = enabled ? (have.flagValues | bit) : (have.flagValues & ~bit);
+					}
+					else
+					{
+						have.flagMask &= ~bit;
+					}
+				}
+			}
+
+			if (want.hasVisible && (!have.hasVisible || have.visible != want.visible))
+			{
+				Issue(have.hasVisible, want.visible ? m_Api->ShowOverlay(e.handle) : m_Api->HideOverlay(e.handle));
+				have.visible = want.visible;
+			}
+		}
+	}
+
+	const Counters& GetCounters() const { return m_Counters; }
+	void ResetCounters() { m_Counters = Counters{}; }
+
+private:
+	struct Desired
+	{
+		bool hasVisible = false;
+		bool visible = false;
+		bool hasAlpha = false;
+		float alpha = 1.0f;
+		bool hasCurvature = false;
+		float curvature = 0.0f;
+		bool hasBounds = false;
+		vr::VRTextureBounds_t bounds{};
+		bool hasTexture = false;
+		uint64_t textureKey = 0;
+		vr::Texture_t texture{};
+		// Vulkan descriptors are copied here; texture.handle is re-pointed at issue time (entries can move).
+		bool ownsVulkanData = false;
+		vr::VRVulkanTextureData_t vulkanData{};
+		uint32_t flagMask = 0;
+		uint32_t flagValues = 0;
+	};
+
+	// What we last successfully issued; has* = false means unknown.
+	struct Issued
+	{
+		bool hasVisible = false;
+		bool visible = false;
+		bool hasAlpha = false;
+		float alpha = 0.0f;
+		bool hasCurvature = false;
+		float curvature = 0.0f;
+		bool hasBounds = false;
+		vr::VRTextureBounds_t bounds{};
+		bool hasTexture = false;
+		uint64_t textureKey = 0;
+		uint32_t flagMask = 0;
+		uint32_t flagValues = 0;
+		bool hasTransform = false;
+		vr::ETrackingUniverseOrigin origin = vr::TrackingUniverseStanding;
+		vr::HmdMatrix34_t transform{};
+		bool hasWidth = false;
+		float width = 0.0f;
+	};
+
+	struct Entry
+	{
+		vr::VROverlayHandle_t handle = vr::k_ulOverlayHandleInvalid;
+		Desired want;
+		Issued issued;
+	};
+
+	// A dozen overlays at most: a linear scan beats hashing.
+	Entry* Find(vr::VROverlayHandle_t handle, bool create = false)
+	{
+		for (Entry& e : m_Entries)
+		{
+			if (e.handle == handle)
+				return &e;
+		}
+		if (!create)
+			return nullptr;
+		m_Entries.emplace_back();
+		m_Entries.back().handle = handle;
+		return &m_Entries.back();
+	}
+
+	const Entry* Find(vr::VROverlayHandle_t handle) const
+	{
+		for (const Entry& e : m_Entries)
+		{
+			if (e.handle == handle)
+				return &e;
+		}
+		return nullptr;
+	}
+
+	void Issue(bool& known, vr::EVROverlayError err)
+	{
+		++m_Counters.issued;
+		// On failure, leave the field unknown so the next Flush() retries.
+		known = (err == vr::VROverlayError_None);
+	}
+
+	OverlayApi* m_Api = nullptr;
+	std::vector<Entry> m_Entries;
+	Counters m_Counters{};
+};
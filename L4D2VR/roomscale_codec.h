@@ -0,0 +1,216 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// ------------------------------------------------------------
+// Roomscale 1:1 movement codec.
+//
+// The planar HMD delta of a command rides in CUserCmd::buttons bits 26..31 (L4D2 button flags end at
+// IN_ATTACK3, 1 << 25). Whole centimeters in two signed 3-bit fields capped walking at 3-4 cm per
+// command, so six bits now carry one code of an adaptive-scale codebook:
+//  - code 0 is "no movement", codes 1..56 are 1 + exponent * 8 + direction,
+//  - exponent e in [0, 7) picks the step 0.25 cm * 2^e (0.25 cm .. 16 cm), direction is a ternary
+//    mantissa pair (mx, my) in {-1, 0, 1}^2 without (0, 0); the delta is (mx, my) * step,
+//  - codes 57..63 are reserved and decode to nothing.
+// RoomscaleDeltaEncoder picks the nearest code to the wanted movement plus what earlier commands
+// still owe (error feedback), so the coarse steps average out exactly and no drift accumulates.
+// RoomscaleJitterBuffer is the server side: decoded deltas are queued per player (backup copies of
+// commands already queued are dropped by command number) and released a fraction per server frame,
+// which smooths the step pattern the quantizer produces and bursts of commands arriving together.
+// Meters throughout. No engine / Windows dependencies.
+// ------------------------------------------------------------
+
+class RoomscaleCodec
+{
+public:
+	static constexpr int kShift = 26;
+	static constexpr uint32_t kButtonsMask = 0x3Fu << kShift;
+	static constexpr int kExponents = 7;
+	static constexpr int kDirections = 8;
+	static constexpr uint32_t kMaxCode = kExponents * kDirections;
+	static constexpr float kMinStepMeters = 0.0025f;
+
+	static float StepMeters(int exponent) { return std::ldexp(kMinStepMeters, exponent); }
+	static float MaxStepMeters() { return StepMeters(kExponents - 1); }
+
+	// Code -> delta. False for "no movement" and reserved codes.
+	static bool DecodeCode(uint32_t code, float& dx, float& dy)
+	{
+		if (code == 0 || code > kMaxCode)
+			return false;
+		const uint32_t index = code - 1;
+		const float step = StepMeters(static_cast<int>(index / kDirections));
+		const Direction& dir = Directions()[index % kDirections];
+		dx = dir.x * step;
+		dy = dir.y * step;
+		return true;
+	}
+
+	// Nearest code to (dx, dy); 0 when standing still is closest. Ties keep the smaller step.
+	static uint32_t QuantizeCode(float dx, float dy)
+	{
+		uint32_t best = 0;
+		float bestErr = dx * dx + dy * dy;
+		for (int e = 0; e < kExponents; ++e)
+		{
+			const float step = StepMeters(e);
+			const int mx = Trit(dx / step);
+			const int my = Trit(dy / step);
+			if (mx == 0 && my == 0)
+				continue;
+			const float ex = dx - mx * step;
+			const float ey = dy - my * step;
+			const float err = ex * ex + ey * ey;
+			if (err < bestErr)
+			{
+				bestErr = err;
+				best = 1 + static_cast<uint32_t>(e * kDirections + DirectionIndex(mx, my));
+			}
+		}
+		return best;
+	}
+
+	static uint32_t Pack(uint32_t code) { return (code << kShift) & kButtonsMask; }
+	static uint32_t Unpack(uint32_t buttons) { return (buttons & kButtonsMask) >> kShift; }
+
+	static bool Decode(uint32_t buttons, float& dx, float& dy) { return DecodeCode(Unpack(buttons), dx, dy); }
+
+private:
+	struct Direction
+	{
+		float x;
+		float y;
+	};
+
+	static const Direction* Directions()
+	{
+		static const Direction kDirs[kDirections] =
+		{
+			{ -1.0f, -1.0f }, { 0.0f, -1.0f }, { 1.0f, -1.0f },
+			{ -1.0f,  0.0f },                  { 1.0f,  0.0f },
+			{ -1.0f,  1.0f }, { 0.0f,  1.0f }, { 1.0f,  1.0f }
+		};
+		return kDirs;
+	}
+
+	static int DirectionIndex(int mx, int my)
+	{
+		const int t = (my + 1) * 3 + (mx + 1);
+		return t > 4 ? t - 1 : t;
+	}
+
+	static int Trit(float v)
+	{
+		return v >= 0.5f ? 1 : (v <= -0.5f ? -1 : 0);
+	}
+};
+
+class RoomscaleDeltaEncoder
+{
+public:
+	// Movement still owed after this much saturation is dropped rather than chased for seconds.
+	static constexpr float kMaxResidualMeters = 0.5f;
+
+	void Reset()
+	{
+		m_Residual[0] = 0.0f;
+		m_Residual[1] = 0.0f;
+	}
+
+	// Adds (dx, dy) to what is owed and returns the code to send (0: nothing this command).
+	// sentDx / sentDy receive what the receiver will decode.
+	uint32_t Encode(float dx, float dy, float& sentDx, float& sentDy)
+	{
+		float wantX = m_Residual[0] + dx;
+		float wantY = m_Residual[1] + dy;
+		const float len = std::sqrt(wantX * wantX + wantY * wantY);
+		if (len > kMaxResidualMeters + RoomscaleCodec::MaxStepMeters())
+		{
+			const float s = (kMaxResidualMeters + RoomscaleCodec::MaxStepMeters()) / len;
+			wantX *= s;
+			wantY *= s;
+		}
+
+		sentDx = 0.0f;
+		sentDy = 0.0f;
+		const uint32_t code = RoomscaleCodec::QuantizeCode(wantX, wantY);
+		if (code != 0)
+			RoomscaleCodec::DecodeCode(code, sentDx, sentDy);
+		m_Residual[0] = wantX - sentDx;
+		m_Residual[1] = wantY - sentDy;
+		return code;
+	}
+
+	float ResidualX() const { return m_Residual[0]; }
+	float ResidualY() const { return m_Residual[1]; }
+
+private:
+	float m_Residual[2] = { 0.0f, 0.0f };
+};
+
+class RoomscaleJitterBuffer
+{
+public:
+	struct Settings
+	{
+		int spreadFrames = 2;            // release 1/spread of the queue per drain; 1 applies at once
+		float maxBacklogMeters = 0.3f;   // anything queued beyond this goes out immediately
+		float flushMeters = 0.005f;      // a remainder this small is released whole
+	};
+
+	// Same rule as VRServerStateStore: a command this far behind the newest means the client restarted.
+	static constexpr int kRestartGap = 64;
+
+	void Reset()
+	{
+		m_Pending[0] = 0.0f;
+		m_Pending[1] = 0.0f;
+	}
+
+	// False for a command number already queued (the engine resends recent commands as backups).
+	bool Push(int commandNumber, float dx, float dy)
+	{
+		if (m_HaveLast && commandNumber <= m_LastCommand && m_LastCommand - commandNumber < kRestartGap)
+			return false;
+		m_HaveLast = true;
+		m_LastCommand = commandNumber;
+		m_Pending[0] += dx;
+		m_Pending[1] += dy;
+		return true;
+	}
+
+	bool HasPending() const { return m_Pending[0] != 0.0f || m_Pending[1] != 0.0f; }
+
+	// Movement to apply now. False when nothing is queued.
+	bool Drain(const Settings& settings, float& dx, float& dy)
+	{
+		if (!HasPending())
+			return false;
+
+		const float len = std::sqrt(m_Pending[0] * m_Pending[0] + m_Pending[1] * m_Pending[1]);
+		float fraction = 1.0f / static_cast<float>(std::max(1, settings.spreadFrames));
+		if (len <= settings.flushMeters)
+			fraction = 1.0f;
+		else if (len > settings.maxBacklogMeters)
+			fraction = std::max(fraction, 1.0f - settings.maxBacklogMeters * (1.0f - fraction) / len);
+
+		dx = m_Pending[0] * fraction;
+		dy = m_Pending[1] * fraction;
+		if (fraction >= 1.0f)
+		{
+			Reset();
+		}
+		else
+		{
+			m_Pending[0] -= dx;
+			m_Pending[1] -= dy;
+		}
+		return true;
+	}
+
+private:
+	float m_Pending[2] = { 0.0f, 0.0f };
+	int m_LastCommand = 0;
+	bool m_HaveLast = false;
+};
@@ -1058,6 +1058,22 @@ public:
 	virtual void* GetBaseEntity() = 0;
 };
 
+struct edict_t;
+
+// Server-side networkable (CBaseEdict::m_pNetworkable).
+class IServerNetworkable
+{
+public:
+	virtual IHandleEntity* GetEntityHandle() = 0;
+	virtual void* GetServerClass() = 0;
+	virtual edict_t* GetEdict() const = 0;
+	virtual const char* GetClassName() const = 0;   // map classname, e.g. "infected", "func_breakable_surf"
+	virtual void Release() = 0;
+	virtual int AreaNum() const = 0;
+	virtual void* GetBaseNetworkable() = 0;
+	virtual void* GetBaseEntity() = 0;
+};
+
 class IClientUnknown : public IHandleEntity
 {
 public:
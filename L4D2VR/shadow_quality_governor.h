@@ -0,0 +1,217 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// ------------------------------------------------------------
+// Shadow quality governor.
+//
+// The shadow cvars from config.txt are applied as one fixed set, so the user has to guess what the
+// machine sustains at the headset's refresh rate. The governor closes the loop instead:
+//  - the configured values are the top tier; lower tiers scale the expensive knobs down from it
+//    (flashlight depth resolution, shadows rendered, shadow distance, infected shadows),
+//  - each compositor frame is fed in with its CPU / GPU time against the frame budget,
+//  - a sustained share of missed frames steps one tier down; a long calm stretch with headroom steps
+//    one tier up. Falling straight back out of a tier doubles how long the next step into it has to
+//    wait, so a scene that sits on the edge settles instead of flapping.
+// Configure() keeps the current tier and history when called again with the same top tier, tier count
+// and settings, so re-reading an unrelated config key doesn't throw away what the governor learned.
+// Times are in seconds from any steady clock. No engine / Windows dependencies.
+// ------------------------------------------------------------
+
+struct ShadowQualityTier
+{
+	int flashlightDepthRes = 1024;          // r_flashlightdepthres
+	int maxRendered = 32;                   // r_shadowmaxrendered
+	float maxRenderableDist = 3000.0f;      // cl_max_shadow_renderable_dist
+	int infectedShadows = 1;                // z_infected_shadows
+	int flashlightInfectedShadows = 1;      // r_flashlightinfectedshadows
+
+	bool operator==(const ShadowQualityTier& o) const
+	{
+		return flashlightDepthRes == o.flashlightDepthRes && maxRendered == o.maxRendered
+			&& maxRenderableDist == o.maxRenderableDist && infectedShadows == o.infectedShadows
+			&& flashlightInfectedShadows == o.flashlightInfectedShadows;
+	}
+	bool operator!=(const ShadowQualityTier& o) const { return !(*this == o); }
+};
+
+struct ShadowGovernorSettings
+{
+	float downWindowSeconds = 1.0f;     // misses are counted over this long before stepping down
+	float downMissRatio = 0.2f;
+	float upWindowSeconds = 5.0f;       // calm stretch needed before stepping up (times the tier's backoff)
+	float upMissRatio = 0.02f;
+	float upHeadroom = 0.8f;            // mean frame time must be under budget * this to step up
+	float cooldownSeconds = 1.0f;       // after any step, let the new tier settle
+	float maxBackoff = 32.0f;
+	int minSamples = 20;
+
+	bool operator==(const ShadowGovernorSettings& o) const
+	{
+		return downWindowSeconds == o.downWindowSeconds && downMissRatio == o.downMissRatio
+			&& upWindowSeconds == o.upWindowSeconds && upMissRatio == o.upMissRatio && upHeadroom == o.upHeadroom
+			&& cooldownSeconds == o.cooldownSeconds && maxBackoff == o.maxBackoff && minSamples == o.minSamples;
+	}
+	bool operator!=(const ShadowGovernorSettings& o) const { return !(*this == o); }
+};
+
+class ShadowQualityGovernor
+{
+public:
+	static constexpr int kMaxTiers = 8;
+
+	// Tier index (0 = top) of tierCount scaled down from top.
+	static ShadowQualityTier MakeTier(const ShadowQualityTier& top, int index, int tierCount)
+	{
+		const int n = std::clamp(tierCount, 1, kMaxTiers);
+		const int k = std::clamp(index, 0, n - 1);
+		if (k == 0)
+			return top;
+
+		const float f = static_cast<float>(k) / static_cast<float>(n - 1);
+		ShadowQualityTier tier = top;
+		tier.flashlightDepthRes = std::min(top.flashlightDepthRes, std::max(256, top.flashlightDepthRes >> k));
+		tier.maxRendered = std::max(std::min(top.maxRendered, 2), static_cast<int>(std::lround(top.maxRendered * (1.0f - 0.75f * f))));
+		tier.maxRenderableDist = top.maxRenderableDist * (1.0f - 0.6f * f);
+		tier.infectedShadows = k < (n + 1) / 2 ? top.infectedShadows : 0;
+		tier.flashlightInfectedShadows = 0;
+		return tier;
+	}
+
+	// Returns false (and keeps the state) when nothing that shapes the tiers changed.
+	bool Configure(const ShadowQualityTier& top, int tierCount, const ShadowGovernorSettings& settings)
+	{
+		const int n = std::clamp(tierCount, 1, kMaxTiers);
+		if (GetTierCount() == n && m_Tiers[0] == top && m_Settings == settings)
+			return false;
+
+		m_Settings = settings;
+		m_Tiers.clear();
+		for (int k = 0; k < n; ++k)
+			m_Tiers.push_back(MakeTier(top, k, n));
+		m_Backoff.fill(1.0f);
+		m_Tier = 0;
+		m_SampleCount = 0;
+		m_Head = 0;
+		m_LastChange = -1.0;
+		m_EnteredByStepUp = false;
+		return true;
+	}
+
+	int GetTierIndex() const { return m_Tier; }
+	int GetTierCount() const { return static_cast<int>(m_Tiers.size()); }
+	const ShadowQualityTier& GetTier() const { return m_Tiers[static_cast<size_t>(m_Tier)]; }
+	float GetBackoff(int index) const { return m_Backoff[static_cast<size_t>(std::clamp(index, 0, kMaxTiers - 1))]; }
+
+	// One compositor frame. missed: the compositor reported it dropped / re-presented, on top of
+	// max(cpu, gpu) going over budget. Returns +1 after stepping up, -1 after stepping down, else 0.
+	int Feed(double now, float cpuMs, float gpuMs, float budgetMs, bool missed)
+	{
+		if (m_Tiers.empty() || !(budgetMs > 0.0f))
+			return 0;
+		if (m_LastChange < 0.0)
+			m_LastChange = now;
+
+		const float frameMs = std::max(cpuMs, gpuMs);
+		Sample& s = m_Samples[m_Head];
+		s.time = now;
+		s.frameMs = frameMs;
+		s.missed = missed || frameMs > budgetMs;
+		m_Head = (m_Head + 1) % m_Samples.size();
+		m_SampleCount = std::min(m_SampleCount + 1, m_Samples.size());
+
+		const double sinceChange = now - m_LastChange;
+		if (sinceChange < m_Settings.cooldownSeconds)
+			return 0;
+
+		const int last = GetTierCount() - 1;
+		if (m_Tier < last)
+		{
+			const Window w = Gather(now, m_Settings.downWindowSeconds);
+			if (w.count >= m_Settings.minSamples && w.misses >= m_Settings.downMissRatio * static_cast<float>(w.count))
+			{
+				// Fell back out of a tier we had just climbed into: make the next climb wait longer.
+				const double unstable = static_cast<double>(m_Settings.upWindowSeconds) * m_Backoff[static_cast<size_t>(m_Tier)] * 2.0;
+				float& backoff = m_Backoff[static_cast<size_t>(m_Tier)];
+				if (m_EnteredByStepUp && sinceChange < unstable)
+					backoff = std::min(backoff * 2.0f, m_Settings.maxBackoff);
+				return Step(m_Tier + 1, now, false);
+			}
+		}
+
+		if (m_Tier > 0)
+		{
+			const float calm = m_Settings.upWindowSeconds * m_Backoff[static_cast<size_t>(m_Tier - 1)];
+			if (sinceChange < calm)
+				return 0;
+			const Window w = Gather(now, calm);
+			// At high refresh rates a long backoff outlasts the ring; then the whole ring has to be calm.
+			const bool covered = w.coversSeconds >= calm * 0.9f || static_cast<size_t>(w.count) == m_Samples.size();
+			if (w.count >= m_Settings.minSamples && covered
+				&& w.misses <= m_Settings.upMissRatio * static_cast<float>(w.count)
+				&& w.sumMs <= m_Settings.upHeadroom * budgetMs * static_cast<double>(w.count))
+			{
+				return Step(m_Tier - 1, now, true);
+			}
+		}
+		return 0;
+	}
+
+private:
+	struct Sample
+	{
+		double time = 0.0;
+		float frameMs = 0.0f;
+		bool missed = false;
+	};
+
+	struct Window
+	{
+		int count = 0;
+		int misses = 0;
+		double sumMs = 0.0;
+		float coversSeconds = 0.0f;
+	};
+
+	// Samples newer than now - seconds, never older than the last tier change.
+	Window Gather(double now, float seconds) const
+	{
+		Window w;
+		const double from = std::max(now - static_cast<double>(seconds), m_LastChange);
+		const size_t size = m_Samples.size();
+		double oldest = now;
+		for (size_t i = 0; i < m_SampleCount; ++i)
+		{
+			const Sample& s = m_Samples[(m_Head + size - 1 - i) % size];
+			if (s.time < from)
+				break;
+			++w.count;
+			w.misses += s.missed ? 1 : 0;
+			w.sumMs += s.frameMs;
+			oldest = s.time;
+		}
+		w.coversSeconds = static_cast<float>(now - oldest);
+		return w;
+	}
+
+	int Step(int tier, double now, bool up)
+	{
+		m_Tier = tier;
+		m_LastChange = now;
+		m_EnteredByStepUp = up;
+		return up ? 1 : -1;
+	}
+
+	ShadowGovernorSettings m_Settings;
+	std::vector<ShadowQualityTier> m_Tiers;
+	std::array<float, kMaxTiers> m_Backoff{};
+	std::array<Sample, 2048> m_Samples{};
+	size_t m_Head = 0;
+	size_t m_SampleCount = 0;
+	int m_Tier = 0;
+	double m_LastChange = -1.0;
+	bool m_EnteredByStepUp = false;
+};
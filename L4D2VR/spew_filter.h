@@ -0,0 +1,439 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------
+// Engine spew filter.
+//
+// tier0 hands every console message to one spew callback, and map loads push tens of thousands of
+// them through it on the main thread. The filter decides per message with a single pass:
+//  - rules are substrings (case sensitive, like strstr) compiled into one Aho-Corasick automaton;
+//    the alphabet is folded to the bytes the patterns use, so the table stays small and a message
+//    costs one lookup per byte however many rules there are,
+//  - when several rules match, the first one in the list wins,
+//  - suppress drops the line, ratelimit lets N per second through, redirect drops it from the
+//    console and forwards it to the mod log; every rule counts hits and drops,
+//  - forwarded lines go through SpewLineQueue so the file writes happen on the log thread.
+// Rule specs (config.txt SpewFilter1..N): "suppress:<text>", "redirect:<text>", "ratelimit/<n>:<text>".
+// config.txt strips ';', '#' and '//' as comments, so patterns can't contain those.
+// No engine / Windows dependencies.
+// ------------------------------------------------------------
+
+enum class SpewAction : int
+{
+	Suppress = 0,
+	RateLimit,
+	Redirect
+};
+
+struct SpewRule
+{
+	SpewAction action = SpewAction::Suppress;
+	std::string pattern;
+	int perSecond = 0;      // RateLimit only
+};
+
+// Multi-pattern substring matcher: Aho-Corasick expanded into a DFA, behind a bigram prefilter.
+// Each pattern contributes its rarest-looking byte pair to an 8 KB bitmap; while the automaton sits
+// in its root state, bytes are skipped until a position whose pair is in the bitmap, and the
+// automaton restarts far enough back to cover every pattern that uses that pair. Console spew is
+// mostly text no rule cares about, so most bytes only cost a lookup in a table of the pairs' first
+// bytes; the bitmap is only tested where one of those bytes shows up.
+class SpewMatcher
+{
+public:
+	void Build(const std::vector<std::string>& patterns)
+	{
+		m_Class.fill(0);
+		m_Classes = 1;
+		for (const std::string& p : patterns)
+		{
+			for (unsigned char c : p)
+			{
+				if (m_Class[c] == 0)
+					m_Class[c] = static_cast<uint8_t>(m_Classes++);
+			}
+		}
+
+		// Trie over byte classes; class 0 (bytes no pattern uses) never has an edge.
+		const size_t k = static_cast<size_t>(m_Classes);
+		std::vector<int32_t> next(k, -1);
+		m_Out.assign(1, INT_MAX);
+		for (size_t i = 0; i < patterns.size(); ++i)
+		{
+			const std::string& p = patterns[i];
+			if (p.empty())
+				continue;
+			int32_t node = 0;
+			for (unsigned char c : p)
+			{
+				const size_t slot = static_cast<size_t>(node) * k + m_Class[c];
+				if (next[slot] < 0)
+				{
+					next[slot] = static_cast<int32_t>(m_Out.size());
+					m_Out.push_back(INT_MAX);
+					next.resize(next.size() + k, -1);
+				}
+				node = next[slot];
+			}
+			m_Out[static_cast<size_t>(node)] = std::min(m_Out[static_cast<size_t>(node)], static_cast<int>(i));
+		}
+
+		// Breadth first: resolve missing edges through the failure links and fold each node's
+		// failure output into its own, so the scan never has to walk a chain.
+		std::vector<int32_t> fail(m_Out.size(), 0);
+		std::deque<int32_t> queue;
+		for (size_t c = 0; c < k; ++c)
+		{
+			if (next[c] < 0)
+				next[c] = 0;
+			else
+				queue.push_back(next[c]);
+		}
+		while (!queue.empty())
+		{
+			const int32_t node = queue.front();
+			queue.pop_front();
+			const size_t row = static_cast<size_t>(node) * k;
+			const size_t failRow = static_cast<size_t>(fail[static_cast<size_t>(node)]) * k;
+			for (size_t c = 0; c < k; ++c)
+			{
+				int32_t& edge = next[row + c];
+				if (edge < 0)
+				{
+					edge = next[failRow + c];
+				}
+				else
+				{
+					fail[static_cast<size_t>(edge)] = next[failRow + c];
+					m_Out[static_cast<size_t>(edge)] = std::min(m_Out[static_cast<size_t>(edge)], m_Out[static_cast<size_t>(next[failRow + c])]);
+					queue.push_back(edge);
+				}
+			}
+		}
+
+		// Transitions hold the target's row offset, with kHasOutput set when the target ends a pattern.
+		m_Next.resize(next.size());
+		for (size_t i = 0; i < next.size(); ++i)
+		{
+			const uint32_t target = static_cast<uint32_t>(next[i]);
+			m_Next[i] = static_cast<uint32_t>(target * k) | (m_Out[target] != INT_MAX ? kHasOutput : 0u);
+		}
+
+		m_Bigrams.fill(0);
+		m_PairStart.fill(0);
+		m_MaxBack = 0;
+		m_Prefilter = m_Out.size() > 1;
+		for (const std::string& p : patterns)
+		{
+			if (p.empty())
+				continue;
+			if (p.size() < 2)
+			{
+				m_Prefilter = false;
+				break;
+			}
+			size_t bestAt = 0;
+			int bestScore = INT_MAX;
+			for (size_t i = 0; i + 1 < p.size(); ++i)
+			{
+				const int score = Commonness(static_cast<unsigned char>(p[i])) + Commonness(static_cast<unsigned char>(p[i + 1]));
+				if (score < bestScore)
+				{
+					bestScore = score;
+					bestAt = i;
+				}
+			}
+			const unsigned pair = Pair(static_cast<unsigned char>(p[bestAt]), static_cast<unsigned char>(p[bestAt + 1]));
+			m_Bigrams[pair >> 6] |= 1ull << (pair & 63);
+			m_PairStart[static_cast<unsigned char>(p[bestAt])] = 1;
+			m_MaxBack = std::max(m_MaxBack, bestAt);
+		}
+	}
+
+	// Lowest index of a pattern found in the NUL-terminated text, or -1.
+	int Find(const char* text) const
+	{
+		if (!text || m_Out.size() <= 1)
+			return -1;
+		const unsigned char* t = reinterpret_cast<const unsigned char*>(text);
+		const size_t length = std::strlen(text);
+		const uint32_t* next = m_Next.data();
+		const size_t k = static_cast<size_t>(m_Classes);
+		uint32_t row = 0;
+		int best = INT_MAX;
+		size_t pos = 0;
+		size_t feedUntil = 0;
+		while (pos < length)
+		{
+			if (m_Prefilter && row == 0 && pos >= feedUntil)
+			{
+				// Root state: nothing is partially matched, so only a listed pair can start a match.
+				const size_t i = NextPair(t, pos, length);
+				if (i + 1 >= length)
+					break;
+				pos = std::max(pos, i >= m_MaxBack ? i - m_MaxBack : 0);
+				feedUntil = i + 2;
+			}
+
+			const uint32_t edge = next[row + m_Class[t[pos++]]];
+			row = edge & ~kHasOutput;
+			if (edge & kHasOutput)
+			{
+				best = std::min(best, m_Out[row / k]);
+				if (best == 0)
+					break;
+			}
+		}
+		return best == INT_MAX ? -1 : best;
+	}
+
+	size_t GetStateCount() const { return m_Out.size(); }
+
+private:
+	static constexpr uint32_t kHasOutput = 0x80000000u;
+
+	static unsigned Pair(unsigned char a, unsigned char b) { return (static_cast<unsigned>(a) << 8) | b; }
+
+	bool HasPair(unsigned char a, unsigned char b) const
+	{
+		const unsigned pair = Pair(a, b);
+		return (m_Bigrams[pair >> 6] >> (pair & 63)) & 1u;
+	}
+
+	// First i >= from with a listed pair at t[i], t[i + 1], or length if there is none.
+	size_t NextPair(const unsigned char* t, size_t from, size_t length) const
+	{
+		size_t i = from;
+		for (;;)
+		{
+			while (i + 4 < length && !(m_PairStart[t[i]] | m_PairStart[t[i + 1]] | m_PairStart[t[i + 2]] | m_PairStart[t[i + 3]]))
+				i += 4;
+			while (i + 1 < length && !m_PairStart[t[i]])
+				++i;
+			if (i + 1 >= length)
+				return length;
+			if (HasPair(t[i], t[i + 1]))
+				return i;
+			++i;
+		}
+	}
+
+	// Rough frequency of a byte in console text; picks which pair of a pattern goes in the bitmap.
+	static int Commonness(unsigned char c)
+	{
+		if (c == ' ' || c == 'e' || c == 't' || c == 'a' || c == 'o' || c == 'i' || c == 'n' || c == 's' || c == 'r')
+			return 4;
+		if (std::islower(c))
+			return 3;
+		if (std::isdigit(c) || c == '/' || c == '.' || c == '_')
+			return 2;
+		if (std::isupper(c))
+			return 1;
+		return 0;
+	}
+
+	std::array<uint8_t, 256> m_Class{};
+	int m_Classes = 1;
+	std::vector<uint32_t> m_Next;
+	std::vector<int> m_Out;
+	std::array<uint64_t, 1024> m_Bigrams{};
+	std::array<uint8_t, 256> m_PairStart{};     // first bytes of the pairs in m_Bigrams
+	size_t m_MaxBack = 0;
+	bool m_Prefilter = false;
+};
+
+class SpewFilter
+{
+public:
+	static constexpr int kMaxConfigRules = 32;
+
+	struct Verdict
+	{
+		int rule = -1;
+		bool pass = true;       // hand the message on to the console
+		bool forward = false;   // copy it into the mod log
+	};
+
+	explicit SpewFilter(std::vector<SpewRule> rules)
+		: m_Rules(std::move(rules)), m_State(m_Rules.size())
+	{
+		std::vector<std::string> patterns;
+		patterns.reserve(m_Rules.size());
+		for (const SpewRule& rule : m_Rules)
+			patterns.push_back(rule.pattern);
+		m_Matcher.Build(patterns);
+	}
+
+	// Any thread.
+	Verdict Filter(const char* message, int64_t nowMs) const
+	{
+		Verdict verdict;
+		verdict.rule = m_Matcher.Find(message);
+		if (verdict.rule < 0)
+			return verdict;
+
+		const SpewRule& rule = m_Rules[static_cast<size_t>(verdict.rule)];
+		RuleState& state = m_State[static_cast<size_t>(verdict.rule)];
+		state.hits.fetch_add(1, std::memory_order_relaxed);
+		switch (rule.action)
+		{
+		case SpewAction::RateLimit:
+		{
+			int64_t windowStart = state.windowStartMs.load(std::memory_order_relaxed);
+			if (nowMs - windowStart >= 1000 &&
+				state.windowStartMs.compare_exchange_strong(windowStart, nowMs, std::memory_order_relaxed))
+			{
+				state.windowCount.store(0, std::memory_order_relaxed);
+			}
+			verdict.pass = state.windowCount.fetch_add(1, std::memory_order_relaxed) < static_cast<uint32_t>(std::max(rule.perSecond, 0));
+			break;
+		}
+		case SpewAction::Redirect:
+			verdict.pass = false;
+			verdict.forward = true;
+			break;
+		default:
+			verdict.pass = false;
+			break;
+		}
+		if (!verdict.pass)
+			state.dropped.fetch_add(1, std::memory_order_relaxed);
+		return verdict;
+	}
+
+	size_t GetRuleCount() const { return m_Rules.size(); }
+	const SpewRule& GetRule(size_t index) const { return m_Rules[index]; }
+	uint64_t GetHits(size_t index) const { return m_State[index].hits.load(std::memory_order_relaxed); }
+	uint64_t GetDropped(size_t index) const { return m_State[index].dropped.load(std::memory_order_relaxed); }
+	size_t GetMatcherStates() const { return m_Matcher.GetStateCount(); }
+
+	static bool ParseRule(const std::string& spec, SpewRule& out)
+	{
+		const size_t colon = spec.find(':');
+		if (colon == std::string::npos || colon + 1 >= spec.size())
+			return false;
+
+		std::string action = spec.substr(0, colon);
+		std::transform(action.begin(), action.end(), action.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		action.erase(std::remove_if(action.begin(), action.end(), [](unsigned char c) { return std::isspace(c) != 0; }), action.end());
+
+		SpewRule rule;
+		rule.pattern = spec.substr(colon + 1);
+		if (action == "suppress")
+		{
+			rule.action = SpewAction::Suppress;
+		}
+		else if (action == "redirect")
+		{
+			rule.action = SpewAction::Redirect;
+		}
+		else if (action.compare(0, 10, "ratelimit/") == 0 && action.size() > 10)
+		{
+			char* end = nullptr;
+			const long perSecond = std::strtol(action.c_str() + 10, &end, 10);
+			if (!end || *end != '\0' || perSecond < 0)
+				return false;
+			rule.action = SpewAction::RateLimit;
+			rule.perSecond = static_cast<int>(std::min<long>(perSecond, 100000));
+		}
+		else
+		{
+			return false;
+		}
+		out = std::move(rule);
+		return true;
+	}
+
+	static const char* ActionName(SpewAction action)
+	{
+		switch (action)
+		{
+		case SpewAction::RateLimit: return "ratelimit";
+		case SpewAction::Redirect: return "redirect";
+		default: return "suppress";
+		}
+	}
+
+private:
+	struct RuleState
+	{
+		std::atomic<uint64_t> hits{ 0 };
+		std::atomic<uint64_t> dropped{ 0 };
+		std::atomic<int64_t> windowStartMs{ INT64_MIN / 2 };
+		std::atomic<uint32_t> windowCount{ 0 };
+	};
+
+	std::vector<SpewRule> m_Rules;
+	mutable std::vector<RuleState> m_State;
+	SpewMatcher m_Matcher;
+};
+
+// Bounded hand-off from the spew callback to the log thread. Push never waits on the writer;
+// when the writer falls behind, new lines are dropped and counted.
+class SpewLineQueue
+{
+public:
+	explicit SpewLineQueue(size_t capacity = 1024) : m_Capacity(capacity) {}
+
+	bool Push(const char* line)
+	{
+		if (!line)
+			return false;
+		size_t length = std::strlen(line);
+		while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+			--length;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (m_Lines.size() >= m_Capacity)
+			{
+				++m_Dropped;
+				return false;
+			}
+			m_Lines.emplace_back(line, length);
+		}
+		m_Cv.notify_one();
+		return true;
+	}
+
+	// Waits up to timeout for lines, then moves everything queued into out. False if none.
+	bool WaitPop(std::vector<std::string>& out, std::chrono::milliseconds timeout)
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Cv.wait_for(lock, timeout, [this] { return !m_Lines.empty(); });
+		if (m_Lines.empty())
+			return false;
+		for (std::string& line : m_Lines)
+			out.push_back(std::move(line));
+		m_Lines.clear();
+		return true;
+	}
+
+	uint64_t TakeDropped()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		const uint64_t dropped = m_Dropped;
+		m_Dropped = 0;
+		return dropped;
+	}
+
+private:
+	const size_t m_Capacity;
+	std::mutex m_Mutex;
+	std::condition_variable m_Cv;
+	std::deque<std::string> m_Lines;
+	uint64_t m_Dropped = 0;
+};
@@ -0,0 +1,404 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// ------------------------------------------------------------
+// Stereo visibility: one culling frustum for both eyes.
+//
+// dRenderView renders the same scene twice from origins an IPD apart, and the engine rebuilds the
+// world / renderable lists for each eye although they are nearly identical. The combined frustum
+// (apex pulled back behind the eyes until both eye frusta fit inside) is a conservative superset of
+// both views, so lists culled against it once can be reused for the second eye.
+//  - BuildCombinedStereoView / BuildStereoFrustum: the frustum-union math.
+//  - StereoVisibilityCache: lists captured during the first eye, handed out to the second eye only
+//    for the same frame and combined pose.
+//  - StereoRenderableList: the per-renderable list those captures use (keyed by entity index and
+//    model, looked up in draw order with a hash fallback).
+//  - StereoEyeCostStats: per-eye CPU timing, so the second eye's saving can be reported.
+//
+// No engine / Windows dependencies (own small vector type, Source axis conventions are the caller's).
+// ------------------------------------------------------------
+
+struct StereoVec3
+{
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+
+	StereoVec3 operator+(const StereoVec3& o) const { return { x + o.x, y + o.y, z + o.z }; }
+	StereoVec3 operator-(const StereoVec3& o) const { return { x - o.x, y - o.y, z - o.z }; }
+	StereoVec3 operator*(float s) const { return { x * s, y * s, z * s }; }
+	float Dot(const StereoVec3& o) const { return x * o.x + y * o.y + z * o.z; }
+};
+
+// A symmetric perspective view. forward / right / up must be orthonormal.
+struct StereoEyeView
+{
+	StereoVec3 origin;
+	StereoVec3 forward{ 1.0f, 0.0f, 0.0f };
+	StereoVec3 right{ 0.0f, -1.0f, 0.0f };
+	StereoVec3 up{ 0.0f, 0.0f, 1.0f };
+	float fovXDeg = 90.0f;   // full horizontal FOV
+	float aspect = 1.0f;     // width / height
+	float zNear = 6.0f;
+	float zFar = 28377.9f;
+
+	float TanHalfX() const { return std::tan(fovXDeg * 0.5f * 3.14159265358979f / 180.0f); }
+	float TanHalfY() const { return (aspect > 0.0f) ? (TanHalfX() / aspect) : TanHalfX(); }
+};
+
+// Points with Distance() >= 0 are inside.
+struct StereoPlane
+{
+	StereoVec3 normal;
+	float dist = 0.0f;
+
+	float Distance(const StereoVec3& p) const { return normal.Dot(p) - dist; }
+};
+
+struct StereoFrustum
+{
+	enum { Near = 0, Far, Left, Right, Bottom, Top, PlaneCount };
+	std::array<StereoPlane, PlaneCount> planes{};
+
+	bool ContainsPoint(const StereoVec3& p, float epsilon = 0.0f) const
+	{
+		for (const StereoPlane& plane : planes)
+		{
+			if (plane.Distance(p) < -epsilon)
+				return false;
+		}
+		return true;
+	}
+
+	// Conservative: false only if the sphere is fully outside one plane.
+	bool IntersectsSphere(const StereoVec3& center, float radius) const
+	{
+		for (const StereoPlane& plane : planes)
+		{
+			if (plane.Distance(center) < -radius)
+				return false;
+		}
+		return true;
+	}
+};
+
+inline StereoFrustum BuildStereoFrustum(const StereoEyeView& view)
+{
+	const float tx = view.TanHalfX();
+	const float ty = view.TanHalfY();
+
+	auto makePlane = [&](const StereoVec3& n)
+		{
+			const float len = std::sqrt(n.Dot(n));
+			StereoPlane plane;
+			plane.normal = (len > 0.0f) ? n * (1.0f / len) : n;
+			plane.dist = plane.normal.Dot(view.origin);
+			return plane;
+		};
+
+	StereoFrustum f;
+	f.planes[StereoFrustum::Near].normal = view.forward;
+	f.planes[StereoFrustum::Near].dist = view.forward.Dot(view.origin) + view.zNear;
+	f.planes[StereoFrustum::Far].normal = view.forward * -1.0f;
+	f.planes[StereoFrustum::Far].dist = -(view.forward.Dot(view.origin) + view.zFar);
+	// Side planes pass through the apex; inward normals are forward * tan +/- the side axis.
+	f.planes[StereoFrustum::Left] = makePlane(view.forward * tx + view.right);
+	f.planes[StereoFrustum::Right] = makePlane(view.forward * tx - view.right);
+	f.planes[StereoFrustum::Bottom] = makePlane(view.forward * ty + view.up);
+	f.planes[StereoFrustum::Top] = makePlane(view.forward * ty - view.up);
+	return f;
+}
+
+// The eight corners of a view's near / far rectangles.
+inline std::array<StereoVec3, 8> StereoFrustumCorners(const StereoEyeView& view)
+{
+	std::array<StereoVec3, 8> corners{};
+	const float tx = view.TanHalfX();
+	const float ty = view.TanHalfY();
+	const float depths[2] = { view.zNear, view.zFar };
+	int i = 0;
+	for (float d : depths)
+	{
+		for (int sy = -1; sy <= 1; sy += 2)
+		{
+			for (int sx = -1; sx <= 1; sx += 2)
+				corners[i++] = view.origin + view.forward * d + view.right * (sx * d * tx) + view.up * (sy * d * ty);
+		}
+	}
+	return corners;
+}
+
+// Builds one view whose frustum contains both eye frusta. The eyes must share orientation and
+// projection (they do in dRenderView: same angles / fov / aspect, origins offset by the IPD);
+// returns false otherwise and leaves outView untouched.
+// The apex sits on the eye midpoint's view axis, pulled back far enough that each eye's frustum
+// lies inside; outPullback receives that distance (ipd/2 / tan(fovX/2) for a pure sideways offset).
+inline bool BuildCombinedStereoView(const StereoEyeView& left, const StereoEyeView& right, StereoEyeView& outView, float* outPullback = nullptr)
+{
+	constexpr float kAxisEpsilon = 1e-4f;
+	if (left.forward.Dot(right.forward) < 1.0f - kAxisEpsilon || left.up.Dot(right.up) < 1.0f - kAxisEpsilon)
+		return false;
+	if (std::fabs(left.fovXDeg - right.fovXDeg) > 1e-3f || std::fabs(left.aspect - right.aspect) > 1e-4f)
+		return false;
+
+	const float tx = left.TanHalfX();
+	const float ty = left.TanHalfY();
+	if (!(tx > 0.0f) || !(ty > 0.0f))
+		return false;
+
+	const StereoVec3 mid = (left.origin + right.origin) * 0.5f;
+	const StereoEyeView* eyes[2] = { &left, &right };
+
+	// For an eye at (ex, ey, ez) in camera space relative to the midpoint, its frustum fits if
+	// |ex| <= (p + ez) * tx and |ey| <= (p + ez) * ty for the apex at depth -p.
+	float pullback = 0.0f;
+	for (const StereoEyeView* eye : eyes)
+	{
+		const StereoVec3 d = eye->origin - mid;
+		const float ex = std::fabs(d.Dot(left.right));
+		const float ey = std::fabs(d.Dot(left.up));
+		const float ez = d.Dot(left.forward);
+		pullback = std::max(pullback, std::max(ex / tx, ey / ty) - ez);
+	}
+
+	float zNear = 0.0f;
+	float zFar = 0.0f;
+	for (int i = 0; i < 2; ++i)
+	{
+		const float ez = (eyes[i]->origin - mid).Dot(left.forward) + pullback;
+		const float n = ez + eyes[i]->zNear;
+		const float f = ez + eyes[i]->zFar;
+		zNear = (i == 0) ? n : std::min(zNear, n);
+		zFar = (i == 0) ? f : std::max(zFar, f);
+	}
+
+	outView = left;
+	outView.origin = mid - left.forward * pullback;
+	outView.zNear = zNear;
+	outView.zFar = zFar;
+	if (outPullback)
+		*outPullback = pullback;
+	return true;
+}
+
+// True if every corner of inner lies inside outer (frusta are convex, so that's containment).
+// The default epsilon covers float rounding of plane distances for far corners at map coordinates
+// (~1e-2 units at 16k units out with the default zFar).
+inline bool StereoFrustumContains(const StereoFrustum& outer, const StereoEyeView& inner, float epsilon = 5e-2f)
+{
+	for (const StereoVec3& c : StereoFrustumCorners(inner))
+	{
+		if (!outer.ContainsPoint(c, epsilon))
+			return false;
+	}
+	return true;
+}
+
+// Per-renderable results captured while the first eye draws, looked up while the second eye draws
+// the same renderables. The second eye submits them in (nearly) the same order, so Find tries the
+// entry after the previous hit before falling back to the hash. Entries keep their payload storage
+// (strings, vectors) across Clear(), so a steady frame reuses it.
+template <typename Payload>
+class StereoRenderableList
+{
+public:
+	static uint64_t MakeKey(int entityIndex, const void* model)
+	{
+		return (uint64_t(uint32_t(entityIndex)) << 32) ^ uint64_t(uintptr_t(model));
+	}
+
+	void Clear()
+	{
+		m_Count = 0;
+		m_Index.clear();
+	}
+
+	// Returns the payload slot for key. A key seen twice in one capture keeps its first slot (the
+	// same entity and model classify the same way within a frame).
+	Payload& Append(uint64_t key, bool* outInserted = nullptr)
+	{
+		auto it = m_Index.find(key);
+		if (it != m_Index.end())
+		{
+			if (outInserted)
+				*outInserted = false;
+			return m_Entries[it->second].payload;
+		}
+		if (m_Count == m_Entries.size())
+			m_Entries.emplace_back();
+		Entry& e = m_Entries[m_Count];
+		e.key = key;
+		m_Index.emplace(key, uint32_t(m_Count));
+		++m_Count;
+		if (outInserted)
+			*outInserted = true;
+		return e.payload;
+	}
+
+	// cursor carries the draw-order hint between calls; start each pass at 0.
+	const Payload* Find(uint64_t key, size_t& cursor) const
+	{
+		if (cursor < m_Count && m_Entries[cursor].key == key)
+			return &m_Entries[cursor++].payload;
+		auto it = m_Index.find(key);
+		if (it == m_Index.end())
+			return nullptr;
+		cursor = size_t(it->second) + 1;
+		return &m_Entries[it->second].payload;
+	}
+
+	size_t Size() const { return m_Count; }
+
+private:
+	struct Entry
+	{
+		uint64_t key = 0;
+		Payload payload{};
+	};
+
+	std::vector<Entry> m_Entries;
+	size_t m_Count = 0;
+	std::unordered_map<uint64_t, uint32_t> m_Index;
+};
+
+// Visibility lists captured for the combined view during the first eye, reused by the second eye.
+// Lists is whatever the capture hooks collect (leaf indices, renderable pointers, ...); it is kept
+// across frames so its storage is reused. Render thread only.
+template <typename Lists>
+class StereoVisibilityCache
+{
+public:
+	struct Counters
+	{
+		uint64_t frames = 0;
+		uint64_t captures = 0;
+		uint64_t reuses = 0;
+		uint64_t misses = 0;
+	};
+
+	// Origin tolerance (game units) when comparing the combined pose between capture and reuse.
+	float m_OriginTolerance = 0.01f;
+
+	// Start a new stereo frame. Any previous capture becomes stale.
+	void BeginFrame(uint64_t frameId, const StereoEyeView& combined)
+	{
+		m_FrameId = frameId;
+		m_View = combined;
+		m_Valid = false;
+		m_Capturing = false;
+		++m_Counters.frames;
+	}
+
+	// First eye: returns the lists to fill (caller clears / appends as it needs).
+	Lists& BeginCapture()
+	{
+		m_Capturing = true;
+		m_Valid = false;
+		return m_Lists;
+	}
+
+	void EndCapture()
+	{
+		if (!m_Capturing)
+			return;
+		m_Capturing = false;
+		m_Valid = true;
+		++m_Counters.captures;
+	}
+
+	// Second eye: the captured lists, or nullptr if they don't belong to this frame / pose.
+	const Lists* TryReuse(uint64_t frameId, const StereoEyeView& combined)
+	{
+		if (!m_Valid || m_Capturing || frameId != m_FrameId || !SamePose(combined))
+		{
+			++m_Counters.misses;
+			return nullptr;
+		}
+		++m_Counters.reuses;
+		return &m_Lists;
+	}
+
+	// Level change, map reload, material reload: drop the capture.
+	void Invalidate()
+	{
+		m_Valid = false;
+		m_Capturing = false;
+	}
+
+	bool HasCapture() const { return m_Valid; }
+	const Lists& GetLists() const { return m_Lists; }
+	const StereoEyeView& GetView() const { return m_View; }
+	const Counters& GetCounters() const { return m_Counters; }
+	void ResetCounters() { m_Counters = Counters{}; }
+
+private:
+	bool SamePose(const StereoEyeView& v) const
+	{
+		const StereoVec3 d = v.origin - m_View.origin;
+		return d.Dot(d) <= m_OriginTolerance * m_OriginTolerance
+			&& v.forward.Dot(m_View.forward) >= 1.0f - 1e-5f
+			&& v.up.Dot(m_View.up) >= 1.0f - 1e-5f
+			&& v.fovXDeg == m_View.fovXDeg && v.aspect == m_View.aspect
+			&& v.zNear <= m_View.zNear && v.zFar <= m_View.zFar;
+	}
+
+	Lists m_Lists{};
+	StereoEyeView m_View{};
+	uint64_t m_FrameId = 0;
+	bool m_Valid = false;
+	bool m_Capturing = false;
+	Counters m_Counters{};
+};
+
+// Per-eye CPU cost of the RenderView calls. The second eye's saving is reported relative to the
+// first eye (which pays for visibility), split by whether the second eye reused the lists.
+class StereoEyeCostStats
+{
+public:
+	enum Eye
+	{
+		Eye_First = 0,
+		Eye_Second,
+		Eye_SecondReused,
+		Eye_Count
+	};
+
+	struct Stats
+	{
+		uint64_t samples = 0;
+		double lastMs = 0.0;
+		double avgMs = 0.0;   // EMA
+	};
+
+	void Record(Eye eye, double costMs)
+	{
+		if (eye < 0 || eye >= Eye_Count || !std::isfinite(costMs) || costMs < 0.0)
+			return;
+		Stats& s = m_Stats[eye];
+		++s.samples;
+		s.lastMs = costMs;
+		s.avgMs = (s.samples == 1) ? costMs : (s.avgMs * 0.9 + costMs * 0.1);
+	}
+
+	const Stats& Get(Eye eye) const { return m_Stats[eye]; }
+
+	// How much cheaper the second eye is than the first, in percent (0 until both have samples).
+	double GetSecondEyeSavingsPercent(bool reused) const
+	{
+		const Stats& first = m_Stats[Eye_First];
+		const Stats& second = m_Stats[reused ? Eye_SecondReused : Eye_Second];
+		if (first.samples == 0 || second.samples == 0 || !(first.avgMs > 0.0))
+			return 0.0;
+		return (1.0 - second.avgMs / first.avgMs) * 100.0;
+	}
+
+	void Reset() { m_Stats.fill(Stats{}); }
+
+private:
+	std::array<Stats, Eye_Count> m_Stats{};
+};
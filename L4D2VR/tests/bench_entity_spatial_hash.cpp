@@ -0,0 +1,203 @@
+// Per-tick proximity cost with 50, 200 and 1000 live entities: EntitySpatialHash (refresh with
+// Update() per entity, then the tick's queries) against the linear scan it replaced (distance-check
+// every entity for every query). A tick's queries are the melee fan (a 96 unit radius), the special
+// infected warning (a 600 unit radius) and an aim cone (30 deg, 1500 units), all around the player.
+// Entities are spread over a 6000 x 6000 unit area with a denser horde near the player; each tick
+// moves every entity a few units, so some cross cell boundaries.
+#include "entity_spatial_hash.h"
+#include "test_common.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	struct Entity
+	{
+		SpatialHashVec3 pos;
+		SpatialHashVec3 vel;
+		uint32_t tags = 1;
+	};
+
+	std::vector<Entity> MakeEntities(int count, std::mt19937& rng)
+	{
+		std::uniform_real_distribution<float> map(-3000.0f, 3000.0f);
+		std::normal_distribution<float> horde(0.0f, 400.0f);
+		std::uniform_real_distribution<float> z(0.0f, 200.0f);
+		std::uniform_real_distribution<float> speed(-8.0f, 8.0f);
+		std::vector<Entity> out(static_cast<size_t>(count));
+		for (size_t i = 0; i < out.size(); ++i)
+		{
+			Entity& e = out[i];
+			const bool near = (i % 3) != 0;   // two thirds in the horde around the player
+			e.pos = near ? SpatialHashVec3{ horde(rng), horde(rng), z(rng) } : SpatialHashVec3{ map(rng), map(rng), z(rng) };
+			e.vel = { speed(rng), speed(rng), 0.0f };
+			e.tags = (i % 10 == 0) ? 2u : 1u;   // a few specials among the commons
+		}
+		return out;
+	}
+
+	void Step(std::vector<Entity>& entities)
+	{
+		for (Entity& e : entities)
+		{
+			e.pos.x += e.vel.x;
+			e.pos.y += e.vel.y;
+		}
+	}
+
+	void LinearRadius(const std::vector<Entity>& entities, const SpatialHashVec3& c, float radius, uint32_t tagMask, std::vector<EntitySpatialHit>& out)
+	{
+		out.clear();
+		const float r2 = radius * radius;
+		for (size_t i = 0; i < entities.size(); ++i)
+		{
+			const Entity& e = entities[i];
+			if (!(e.tags & tagMask))
+				continue;
+			const float dx = e.pos.x - c.x, dy = e.pos.y - c.y, dz = e.pos.z - c.z;
+			const float d2 = dx * dx + dy * dy + dz * dz;
+			if (d2 <= r2)
+				out.push_back({ static_cast<int>(i) + 1, std::sqrt(d2), 1.0f });
+		}
+		std::sort(out.begin(), out.end(), [](const EntitySpatialHit& a, const EntitySpatialHit& b) { return a.distance < b.distance; });
+	}
+
+	void LinearCone(const std::vector<Entity>& entities, const EntitySpatialCone& cone, uint32_t tagMask, std::vector<EntitySpatialHit>& out)
+	{
+		out.clear();
+		const float maxD2 = cone.maxDistance * cone.maxDistance;
+		for (size_t i = 0; i < entities.size(); ++i)
+		{
+			const Entity& e = entities[i];
+			if (!(e.tags & tagMask))
+				continue;
+			const float dx = e.pos.x - cone.origin.x, dy = e.pos.y - cone.origin.y, dz = e.pos.z - cone.origin.z;
+			const float d2 = dx * dx + dy * dy + dz * dz;
+			if (d2 > maxD2 || d2 <= 0.0f)
+				continue;
+			const float d = std::sqrt(d2);
+			const float dot = (dx * cone.dir.x + dy * cone.dir.y + dz * cone.dir.z) / d;
+			if (dot >= cone.minDot)
+				out.push_back({ static_cast<int>(i) + 1, d, dot });
+		}
+		std::sort(out.begin(), out.end(), [](const EntitySpatialHit& a, const EntitySpatialHit& b) { return a.distance < b.distance; });
+	}
+
+	bool SameIndices(std::vector<EntitySpatialHit> a, std::vector<EntitySpatialHit> b)
+	{
+		auto byIndex = [](const EntitySpatialHit& x, const EntitySpatialHit& y) { return x.index < y.index; };
+		std::sort(a.begin(), a.end(), byIndex);
+		std::sort(b.begin(), b.end(), byIndex);
+		if (a.size() != b.size())
+			return false;
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			if (a[i].index != b[i].index)
+				return false;
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const bool quick = vrtest::QuickMode(argc, argv);
+	const int ticks = quick ? 200 : 20000;
+
+	const SpatialHashVec3 player{ 0.0f, 0.0f, 64.0f };
+	EntitySpatialCone aim;
+	aim.origin = player;
+	aim.dir = { 1.0f, 0.0f, 0.0f };
+	aim.minDot = std::cos(15.0f * 3.14159265f / 180.0f);
+	aim.maxDistance = 1500.0f;
+
+	std::printf("%d ticks; per tick: refresh + melee radius + warning radius + aim cone\n", ticks);
+	int failures = 0;
+	for (int count : { 50, 200, 1000 })
+	{
+		std::mt19937 rng(36);
+		std::vector<Entity> base = MakeEntities(count, rng);
+
+		// Correctness first: every query agrees with the scan on the same positions.
+		{
+			std::vector<Entity> entities = base;
+			EntitySpatialHash grid;
+			std::vector<EntitySpatialHit> a, b;
+			for (int t = 0; t < 50; ++t)
+			{
+				Step(entities);
+				grid.BeginUpdate();
+				for (size_t i = 0; i < entities.size(); ++i)
+					grid.Update(static_cast<int>(i) + 1, entities[i].pos, entities[i].tags);
+				grid.EndUpdate();
+				grid.QueryRadius(player, 600.0f, 3u, a);
+				LinearRadius(entities, player, 600.0f, 3u, b);
+				failures += SameIndices(a, b) ? 0 : 1;
+				grid.QueryCone(aim, 3u, a);
+				LinearCone(entities, aim, 3u, b);
+				failures += SameIndices(a, b) ? 0 : 1;
+			}
+		}
+
+		std::vector<EntitySpatialHit> hits;
+		size_t sink = 0;
+
+		std::vector<Entity> entities = base;
+		EntitySpatialHash grid;
+		const double gridSeconds = vrtest::BenchSeconds([&]()
+			{
+				for (int t = 0; t < ticks; ++t)
+				{
+					Step(entities);
+					grid.BeginUpdate();
+					for (size_t i = 0; i < entities.size(); ++i)
+						grid.Update(static_cast<int>(i) + 1, entities[i].pos, entities[i].tags);
+					grid.EndUpdate();
+					sink += grid.QueryRadius(player, 96.0f, 1u, hits);
+					sink += grid.QueryRadius(player, 600.0f, 2u, hits);
+					sink += grid.QueryCone(aim, 3u, hits);
+				}
+			});
+		vrtest::DoNotOptimize(sink);
+
+		entities = base;
+		const double scanSeconds = vrtest::BenchSeconds([&]()
+			{
+				for (int t = 0; t < ticks; ++t)
+				{
+					Step(entities);
+					LinearRadius(entities, player, 96.0f, 1u, hits);
+					sink += hits.size();
+					LinearRadius(entities, player, 600.0f, 2u, hits);
+					sink += hits.size();
+					LinearCone(entities, aim, 3u, hits);
+					sink += hits.size();
+				}
+			});
+		vrtest::DoNotOptimize(sink);
+
+		// Queries alone, on a grid that's already current (several features query per tick).
+		const double queriesSeconds = vrtest::BenchSeconds([&]()
+			{
+				for (int t = 0; t < ticks; ++t)
+				{
+					sink += grid.QueryRadius(player, 96.0f, 1u, hits);
+					sink += grid.QueryRadius(player, 600.0f, 2u, hits);
+					sink += grid.QueryCone(aim, 3u, hits);
+				}
+			});
+		vrtest::DoNotOptimize(sink);
+
+		// How many queries a tick needs before the refresh pays for itself.
+		const double refreshNs = (gridSeconds - queriesSeconds) * 1e9 / ticks;
+		const double savedPerQueryNs = (scanSeconds - queriesSeconds) * 1e9 / ticks / 3.0;
+		std::printf("  %4d entities  grid %8.0f ns/tick (queries %7.0f)  linear scan %8.0f ns/tick  (%.2fx)  break-even %.1f queries/tick\n",
+			count, gridSeconds * 1e9 / ticks, queriesSeconds * 1e9 / ticks, scanSeconds * 1e9 / ticks, scanSeconds / gridSeconds,
+			savedPerQueryNs > 0.0 ? refreshNs / savedPerQueryNs : 0.0);
+	}
+	if (failures)
+		std::printf("  %d grid / scan mismatches\n", failures);
+	return failures == 0 ? 0 : 1;
+}
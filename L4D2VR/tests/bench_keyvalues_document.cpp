@@ -0,0 +1,197 @@
+// Weapon-script scan throughput: KeyValuesDocument (one pass into string_views, hashed keys)
+// against an owning tree like the engine's KeyValues (a std::string per key and value, a vector
+// per block). Each script is parsed and its ten range keys looked up, as WeaponScriptDb does for
+// every scripts/weapon_*.txt on a cold cache.
+#include "weapon_script_db.h"
+#include "test_common.h"
+
+#include <cctype>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// Reference: an owning tree, same tokenizer rules (quoted / bare words, braces, // comments).
+	struct OwningNode
+	{
+		std::string key;
+		std::string value;
+		std::vector<std::unique_ptr<OwningNode>> children;
+	};
+
+	class OwningParser
+	{
+	public:
+		explicit OwningParser(std::string_view text) : m_Text(text) {}
+
+		void Parse(OwningNode& root) { ParseBlock(root, 0); }
+
+	private:
+		bool NextToken(std::string& out, bool& brace)
+		{
+			for (;;)
+			{
+				while (m_Pos < m_Text.size() && std::isspace(static_cast<unsigned char>(m_Text[m_Pos])))
+					++m_Pos;
+				if (m_Pos + 1 < m_Text.size() && m_Text[m_Pos] == '/' && m_Text[m_Pos + 1] == '/')
+				{
+					while (m_Pos < m_Text.size() && m_Text[m_Pos] != '\n')
+						++m_Pos;
+					continue;
+				}
+				break;
+			}
+			if (m_Pos >= m_Text.size())
+				return false;
+			out.clear();
+			brace = m_Text[m_Pos] == '{' || m_Text[m_Pos] == '}';
+			if (brace)
+			{
+				out.push_back(m_Text[m_Pos++]);
+				return true;
+			}
+			if (m_Text[m_Pos] == '"')
+			{
+				++m_Pos;
+				while (m_Pos < m_Text.size() && m_Text[m_Pos] != '"')
+					out.push_back(m_Text[m_Pos++]);
+				++m_Pos;
+				return true;
+			}
+			while (m_Pos < m_Text.size() && !std::isspace(static_cast<unsigned char>(m_Text[m_Pos])) && m_Text[m_Pos] != '{' && m_Text[m_Pos] != '}')
+				out.push_back(m_Text[m_Pos++]);
+			return true;
+		}
+
+		void ParseBlock(OwningNode& block, int depth)
+		{
+			std::string key, value;
+			bool brace = false;
+			while (NextToken(key, brace))
+			{
+				if (brace)
+					return;   // '}'
+				auto node = std::make_unique<OwningNode>();
+				node->key = key;
+				if (!NextToken(value, brace))
+					return;
+				if (brace && depth < KeyValuesDocument::kMaxDepth)
+					ParseBlock(*node, depth + 1);
+				else
+					node->value = value;
+				block.children.push_back(std::move(node));
+			}
+		}
+
+		std::string_view m_Text;
+		size_t m_Pos = 0;
+	};
+
+	const OwningNode* FindRecursive(const OwningNode& block, std::string_view key)
+	{
+		for (const auto& child : block.children)
+		{
+			if (KeyValuesDocument::EqualsInsensitive(child->key, key))
+				return child.get();
+			if (const OwningNode* found = FindRecursive(*child, key))
+				return found;
+		}
+		return nullptr;
+	}
+
+	// A weapon_*.txt shaped script, about 2 KB like the stock rifle / shotgun files.
+	std::string MakeWeaponScript(int index)
+	{
+		std::string s = "WeaponData\n{\n";
+		s += "\t\"printname\"\t\"#L4D_Weapon_" + std::to_string(index) + "\"\n";
+		s += "\t\"playermodel\"\t\"models/w_models/weapons/w_rifle_m16a2.mdl\"\n";
+		s += "\t\"viewmodel\"\t\"models/v_models/v_rifle.mdl\"\n";
+		const char* const keys[] = { "Damage", "Bullets", "Range", "RangeModifier", "CycleTime", "MaxPlayerSpeed",
+			"MinStandingSpread", "MinDuckingSpread", "MinInAirSpread", "MaxMovementSpread", "SpreadPerShot",
+			"MaxSpread", "SpreadDecay", "PelletScatterPitch", "PelletScatterYaw", "PenetrationNumLayers" };
+		for (int k = 0; k < 16; ++k)
+			s += std::string("\t\"") + keys[k] + "\"\t\t\"" + std::to_string(index % 7 + k) + ".5\"  // tuned\n";
+		s += "\tSoundData\n\t{\n";
+		for (int k = 0; k < 12; ++k)
+			s += "\t\t\"sound_" + std::to_string(k) + "\"\t\"Weapon_Rifle.Fire" + std::to_string(k) + "\"\n";
+		s += "\t}\n\tTextureData\n\t{\n";
+		for (int k = 0; k < 8; ++k)
+			s += "\t\t\"icon_" + std::to_string(k) + "\"\n\t\t{\n\t\t\t\"file\"\t\"vgui/hud/icons\"\n\t\t\t\"x\"\t\"" +
+				std::to_string(k * 64) + "\"\n\t\t\t\"y\"\t\"0\"\n\t\t\t\"width\"\t\"64\"\n\t\t\t\"height\"\t\"32\"\n\t\t}\n";
+		s += "\t}\n}\n";
+		return s;
+	}
+
+	const char* const kRangeKeys[] = { "MinStandingSpread", "MinDuckingSpread", "MinInAirSpread", "MaxMovementSpread",
+		"PelletScatterPitch", "PelletScatterYaw", "Range", "MaxPlayerSpeed", "Damage", "Bullets" };
+}
+
+int main(int argc, char** argv)
+{
+	const int passes = vrtest::QuickMode(argc, argv) ? 2 : 400;
+
+	std::vector<std::string> scripts;
+	size_t totalBytes = 0;
+	for (int i = 0; i < 64; ++i)
+	{
+		scripts.push_back(MakeWeaponScript(i));
+		totalBytes += scripts.back().size();
+	}
+
+	float sink = 0.0f;
+	const double documentSeconds = vrtest::BenchSeconds([&]()
+		{
+			for (int p = 0; p < passes; ++p)
+			{
+				for (const std::string& script : scripts)
+				{
+					KeyValuesDocument doc;
+					doc.Parse(script);
+					WeaponRangeData data;
+					if (WeaponScriptDb::ParseRangeData(doc, data))
+						sink += data.range;
+				}
+			}
+		});
+
+	const double owningSeconds = vrtest::BenchSeconds([&]()
+		{
+			for (int p = 0; p < passes; ++p)
+			{
+				for (const std::string& script : scripts)
+				{
+					OwningNode root;
+					OwningParser(script).Parse(root);
+					for (const char* key : kRangeKeys)
+					{
+						if (const OwningNode* n = FindRecursive(root, key))
+							sink += std::strtof(n->value.c_str(), nullptr);
+					}
+				}
+			}
+		});
+
+	// Parse alone, to separate it from the lookups.
+	const double parseSeconds = vrtest::BenchSeconds([&]()
+		{
+			for (int p = 0; p < passes; ++p)
+			{
+				for (const std::string& script : scripts)
+				{
+					KeyValuesDocument doc;
+					doc.Parse(script);
+					sink += static_cast<float>(doc.NodeCount());
+				}
+			}
+		});
+	vrtest::DoNotOptimize(sink);
+
+	const double mib = double(totalBytes) * passes / (1024.0 * 1024.0);
+	const double scriptsParsed = double(scripts.size()) * passes;
+	std::printf("%zu weapon scripts (%.1f KiB), %d passes\n", scripts.size(), totalBytes / 1024.0, passes);
+	std::printf("  KeyValuesDocument parse only:        %7.1f MiB/s\n", mib / parseSeconds);
+	std::printf("  KeyValuesDocument parse + 10 keys:   %7.1f MiB/s  %6.2f us per script\n", mib / documentSeconds, documentSeconds * 1e6 / scriptsParsed);
+	std::printf("  owning tree       parse + 10 keys:   %7.1f MiB/s  %6.2f us per script\n", mib / owningSeconds, owningSeconds * 1e6 / scriptsParsed);
+	return 0;
+}
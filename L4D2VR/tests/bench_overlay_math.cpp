@@ -0,0 +1,214 @@
+// Overlay math kernels: SSE against the scalar reference for compose, rigid / general inverse and
+// point transforms, plus one frame of overlay placement (four body-anchored overlays and six hand
+// HUD rows off the first) through OverlayFrame against the per-overlay basis / Euler code it replaced.
+#include "overlay_math.h"
+#include "test_common.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+	constexpr float kDeg2Rad = 3.14159265358979323846f / 180.0f;
+
+	struct Hmd34
+	{
+		float m[3][4];
+	};
+
+	Mat34 RandomRigid(std::mt19937& rng)
+	{
+		std::normal_distribution<float> n(0.0f, 1.0f);
+		Quat q(n(rng), n(rng), n(rng), n(rng));
+		const float len = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+		return Mat34::FromQuat(Quat(q.x / len, q.y / len, q.z / len, q.w / len), Vec3(n(rng), n(rng) + 1.7f, n(rng)));
+	}
+
+	void Mul33(const float a[3][3], const float b[3][3], float out[3][3])
+	{
+		for (int r = 0; r < 3; ++r)
+			for (int c = 0; c < 3; ++c)
+				out[r][c] = a[r][0] * b[0][c] + a[r][1] * b[1][c] + a[r][2] * b[2][c];
+	}
+
+	// The old per-overlay path: rebuild the yaw basis and the Rz * Ry * Rx matrix every time.
+	Hmd34 LegacyPlace(const Hmd34& hmd, float forwardOff, float rightOff, float upOff, const float angles[3])
+	{
+		float fwd[3] = { -hmd.m[0][2], 0.0f, -hmd.m[2][2] };
+		float len = std::sqrt(fwd[0] * fwd[0] + fwd[2] * fwd[2]);
+		if (len == 0.0f)
+		{
+			fwd[2] = -1.0f;
+			len = 1.0f;
+		}
+		fwd[0] /= len;
+		fwd[2] /= len;
+		const float right[3] = { -fwd[2], 0.0f, fwd[0] };
+		const float cp = cosf(angles[0] * kDeg2Rad), sp = sinf(angles[0] * kDeg2Rad);
+		const float cy = cosf(angles[1] * kDeg2Rad), sy = sinf(angles[1] * kDeg2Rad);
+		const float cr = cosf(angles[2] * kDeg2Rad), sr = sinf(angles[2] * kDeg2Rad);
+		const float Rx[3][3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, cp, -sp }, { 0.0f, sp, cp } };
+		const float Ry[3][3] = { { cy, 0.0f, sy }, { 0.0f, 1.0f, 0.0f }, { -sy, 0.0f, cy } };
+		const float Rz[3][3] = { { cr, -sr, 0.0f }, { sr, cr, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+		float RyRx[3][3], Roff[3][3], R[3][3];
+		Mul33(Ry, Rx, RyRx);
+		Mul33(Rz, RyRx, Roff);
+		const float B[3][3] = { { right[0], 0.0f, -fwd[0] }, { right[1], 1.0f, -fwd[1] }, { right[2], 0.0f, -fwd[2] } };
+		Mul33(B, Roff, R);
+		Hmd34 out;
+		for (int r = 0; r < 3; ++r)
+		{
+			for (int c = 0; c < 3; ++c)
+				out.m[r][c] = R[r][c];
+			out.m[r][3] = hmd.m[r][3] + fwd[r] * forwardOff + right[r] * rightOff + (r == 1 ? upOff : 0.0f);
+		}
+		return out;
+	}
+
+	Hmd34 LegacyMul34(const Hmd34& a, const Hmd34& b)
+	{
+		Hmd34 out;
+		for (int r = 0; r < 3; ++r)
+		{
+			for (int c = 0; c < 3; ++c)
+				out.m[r][c] = a.m[r][0] * b.m[0][c] + a.m[r][1] * b.m[1][c] + a.m[r][2] * b.m[2][c];
+			out.m[r][3] = a.m[r][0] * b.m[0][3] + a.m[r][1] * b.m[1][3] + a.m[r][2] * b.m[2][3] + a.m[r][3];
+		}
+		return out;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const bool quick = vrtest::QuickMode(argc, argv);
+	const int iterations = quick ? 20000 : 2000000;
+	std::mt19937 rng(48);
+
+	// A ring of matrices so each iteration loads fresh operands.
+	constexpr size_t kRing = 256;
+	std::vector<Mat34> mats(kRing);
+	for (Mat34& m : mats)
+		m = RandomRigid(rng);
+
+	std::printf("SSE kernels %s, %d iterations\n", OVERLAY_MATH_SSE ? "enabled" : "unavailable (both columns scalar)", iterations);
+	auto report = [&](const char* name, double sse, double scalar, double perUnit)
+		{
+			std::printf("  %-22s %6.2f ns  scalar %6.2f ns  (%.2fx)\n", name, sse * 1e9 / perUnit, scalar * 1e9 / perUnit, scalar / sse);
+		};
+
+	Mat34 acc;
+	const double composeSse = vrtest::BenchSeconds([&]()
+		{
+			for (int i = 0; i < iterations; ++i)
+				acc = Mat34Math::Compose(mats[i & (kRing - 1)], mats[(i + 7) & (kRing - 1)]);
+		});
+	vrtest::DoNotOptimize(acc);
+	const double composeScalar = vrtest::BenchSeconds([&]()
+		{
+			for (int i = 0; i < iterations; ++i)
+				acc = Mat34Math::ComposeScalar(mats[i & (kRing - 1)], mats[(i + 7) & (kRing - 1)]);
+		});
+	vrtest::DoNotOptimize(acc);
+	report("compose", composeSse, composeScalar, iterations);
+
+	const double rigidSse = vrtest::BenchSeconds([&]()
+		{
+			for (int i = 0; i < iterations; ++i)
+				acc = Mat34Math::InverseRigid(mats[i & (kRing - 1)]);
+		});
+	vrtest::DoNotOptimize(acc);
+	const double rigidScalar = vrtest::BenchSeconds([&]()
+		{
+			for (int i = 0; i < iterations; ++i)
+				acc = Mat34Math::InverseRigidScalar(mats[i & (kRing - 1)]);
+		});
+	vrtest::DoNotOptimize(acc);
+	report("rigid inverse", rigidSse, rigidScalar, iterations);
+
+	int ok = 0;
+	const double inverseSse = vrtest::BenchSeconds([&]()
+		{
+			for (int i = 0; i < iterations; ++i)
+				ok += Mat34Math::Inverse(mats[i & (kRing - 1)], acc) ? 1 : 0;
+		});
+	vrtest::DoNotOptimize(acc);
+	const double inverseScalar = vrtest::BenchSeconds([&]()
+		{
+			for (int i = 0; i < iterations; ++i)
+				ok += Mat34Math::InverseScalar(mats[i & (kRing - 1)], acc) ? 1 : 0;
+		});
+	vrtest::DoNotOptimize(acc);
+	vrtest::DoNotOptimize(ok);
+	report("general inverse", inverseSse, inverseScalar, iterations);
+
+	// A batch the size of a hand HUD's glyph quads.
+	constexpr size_t kPoints = 64;
+	std::vector<Vec3> in(kPoints), out(kPoints);
+	std::normal_distribution<float> n(0.0f, 1.0f);
+	for (Vec3& p : in)
+		p = Vec3(n(rng), n(rng), n(rng));
+	const int batches = iterations / 16;
+	const double pointsSse = vrtest::BenchSeconds([&]()
+		{
+			for (int i = 0; i < batches; ++i)
+				Mat34Math::TransformPoints(mats[i & (kRing - 1)], in.data(), out.data(), kPoints);
+		});
+	vrtest::DoNotOptimize(out[kPoints - 1]);
+	const double pointsScalar = vrtest::BenchSeconds([&]()
+		{
+			for (int i = 0; i < batches; ++i)
+				Mat34Math::TransformPointsScalar(mats[i & (kRing - 1)], in.data(), out.data(), kPoints);
+		});
+	vrtest::DoNotOptimize(out[kPoints - 1]);
+	report("transform point", pointsSse, pointsScalar, double(batches) * kPoints);
+
+	// One frame of placement: rear mirror, scope, menu and hand HUD anchored to the yaw-only body
+	// frame, with six hand HUD rows hanging off the mirror. The old code rebuilt the body basis in
+	// every overlay function; OverlayFrame builds it once per pose.
+	constexpr int kOverlays = 4;
+	const float angles[kOverlays][3] = { { -20.0f, 180.0f, 5.0f }, { 0.0f, 0.0f, 0.0f }, { -10.0f, 0.0f, 0.0f }, { 30.0f, 15.0f, -5.0f } };
+	const float offsets[kOverlays][3] = { { 0.3f, 0.0f, -0.1f }, { 0.5f, 0.05f, 0.0f }, { 1.5f, 0.0f, 0.2f }, { 0.35f, -0.2f, -0.3f } };
+	const int frames = iterations / 4;
+	std::vector<Hmd34> hmds(kRing);
+	for (size_t i = 0; i < kRing; ++i)
+		hmds[i] = mats[i].To<Hmd34>();
+	Hmd34 sink{};
+	const double frameNew = vrtest::BenchSeconds([&]()
+		{
+			for (int f = 0; f < frames; ++f)
+			{
+				OverlayFrame frame;
+				frame.SetHmdPose(hmds[f & (kRing - 1)], true);
+				Mat34 placed[kOverlays];
+				for (int o = 0; o < kOverlays; ++o)
+				{
+					placed[o] = Mat34Math::Compose(frame.trackingFromBody, Mat34::RotationZYXDeg(angles[o][0], angles[o][1], angles[o][2]));
+					placed[o].SetOrigin(frame.BodyPoint(offsets[o][0], offsets[o][1], offsets[o][2]));
+					sink = placed[o].To<Hmd34>();
+				}
+				for (int row = 0; row < 6; ++row)
+					sink = Mat34Math::Compose(placed[0], Mat34::Translation(0.05f * row, -0.02f * row, 0.0f)).To<Hmd34>();
+			}
+		});
+	vrtest::DoNotOptimize(sink);
+	const double frameOld = vrtest::BenchSeconds([&]()
+		{
+			for (int f = 0; f < frames; ++f)
+			{
+				Hmd34 placed[kOverlays];
+				for (int o = 0; o < kOverlays; ++o)
+				{
+					placed[o] = LegacyPlace(hmds[f & (kRing - 1)], offsets[o][0], offsets[o][1], offsets[o][2], angles[o]);
+					sink = placed[o];
+				}
+				for (int row = 0; row < 6; ++row)
+				{
+					Hmd34 t = Mat34::Translation(0.05f * row, -0.02f * row, 0.0f).To<Hmd34>();
+					sink = LegacyMul34(placed[0], t);
+				}
+			}
+		});
+	vrtest::DoNotOptimize(sink);
+	std::printf("  4 overlays + 6 rows   %7.2f ns  old per-overlay math %7.2f ns  (%.2fx)\n", frameNew * 1e9 / frames, frameOld * 1e9 / frames, frameOld / frameNew);
+	return 0;
+}
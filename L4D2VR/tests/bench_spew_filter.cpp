@@ -0,0 +1,224 @@
+// Spew callback cost during a map load: SpewMatcher (bigram prefilter + Aho-Corasick DFA) against the
+// obvious loop of strstr over the rules, at 1, 8 and 32 rules, on console text shaped like a
+// c5m1 load with a few addons mounted. glibc's strstr is vectorized, which a CRT's need not be, so
+// a byte-at-a-time search per rule is timed as well. Every message's verdict is cross-checked
+// against strstr (first rule in list order wins), so the --quick smoke run doubles as a
+// correctness check.
+#include "spew_filter.h"
+#include "test_common.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// Typical map-load spew, most of which no rule cares about.
+	const char* const kLineTemplates[] = {
+		"Material models/props_%s/%s_%d not found\n",
+		"CModelLoader::Map_IsValid: map %s_%d has no worldspawn entity\n",
+		"Unknown vertex format %d for mesh %s/%s\n",
+		"SOLID_VPHYSICS static prop with no vphysics model! (models/props_%s/%s_%d.mdl)\n",
+		"Precache of sound/%s/%s_%d.wav failed: file not found\n",
+		"Couldn't find any entities named %s_%d, which point_template %s is specifying.\n",
+		"NextBotPlayer: %s_%d spawned at (%d, 0, 0)\n",
+		"L 10/18/2026 - 12:00:%d: \"%s<%d><BOT><Survivor>\" triggered \"%s\"\n",
+		"Addon %s_%d: mounted %s.vpk (%d files)\n",
+		"Warning: ragdoll %s_%d has no physics constraints, %s\n",
+	};
+	const char* const kWords[] = { "urban", "c5m1", "waterfront", "debris", "crate", "fence", "barricade", "signs",
+		"vehicles", "trees", "nav", "infected", "survivor", "ambient", "rain", "ellis", "coach" };
+
+	std::vector<std::string> MakeSpew(size_t lines, unsigned seed)
+	{
+		std::mt19937 rng(seed);
+		std::vector<std::string> out;
+		out.reserve(lines);
+		char buffer[256];
+		for (size_t i = 0; i < lines; ++i)
+		{
+			const char* w0 = kWords[rng() % 17];
+			const char* w1 = kWords[rng() % 17];
+			const int n = static_cast<int>(rng() % 200);
+			switch (rng() % 10)
+			{
+			case 0: std::snprintf(buffer, sizeof(buffer), kLineTemplates[0], w0, w1, n); break;
+			case 1: std::snprintf(buffer, sizeof(buffer), kLineTemplates[1], w0, n); break;
+			case 2: std::snprintf(buffer, sizeof(buffer), kLineTemplates[2], n, w0, w1); break;
+			case 3: std::snprintf(buffer, sizeof(buffer), kLineTemplates[3], w0, w1, n); break;
+			case 4: std::snprintf(buffer, sizeof(buffer), kLineTemplates[4], w0, w1, n); break;
+			case 5: std::snprintf(buffer, sizeof(buffer), kLineTemplates[5], w0, n, w1); break;
+			case 6: std::snprintf(buffer, sizeof(buffer), kLineTemplates[6], w0, n, n * 16); break;
+			case 7: std::snprintf(buffer, sizeof(buffer), kLineTemplates[7], n % 60, w0, n, w1); break;
+			case 8: std::snprintf(buffer, sizeof(buffer), kLineTemplates[8], w0, n, w1, n * 37); break;
+			default: std::snprintf(buffer, sizeof(buffer), kLineTemplates[9], w0, n, w1); break;
+			}
+			out.emplace_back(buffer);
+		}
+		return out;
+	}
+
+	// Rule sets as a config would have them: the vertex format warning first, then more specific
+	// noise. Most patterns never appear in the spew.
+	std::vector<std::string> MakePatterns(size_t count)
+	{
+		static const char* const kPatterns[] = {
+			"Unknown vertex format", "SOLID_VPHYSICS static prop", "has no physics constraints", "Precache of sound/ambient",
+			"point_template", "no worldspawn", "NextBotPlayer:", "BOT><Survivor>", "mounted ellis", "Material models/props_nav",
+			"CreateFragmentsFromFile", "Failed to load sound", "Can't find decal", "Invalid bone array",
+			"DataTable warning", "Unable to remove", "SetupBones", "Refusing to spawn", "Bad pstudiohdr",
+			"CUtlRBTree overflow", "ConVarRef", "Attempted to create", "Host_Error", "Mod_LoadTexinfo",
+			"VertexLitGeneric", "Shader_", "m_flSimulationTime", "CSoundEmitterSystem", "addons/workshop",
+			"Weapon_", "particles/", "scripts/vscripts"
+		};
+		std::vector<std::string> out;
+		for (size_t i = 0; i < count && i < sizeof(kPatterns) / sizeof(kPatterns[0]); ++i)
+			out.emplace_back(kPatterns[i]);
+		return out;
+	}
+
+	int StrstrFind(const std::vector<std::string>& patterns, const char* text)
+	{
+		for (size_t i = 0; i < patterns.size(); ++i)
+		{
+			if (std::strstr(text, patterns[i].c_str()))
+				return static_cast<int>(i);
+		}
+		return -1;
+	}
+
+	// A plain scalar substring search per rule, standing in for a CRT strstr without SIMD.
+	int ScalarFind(const std::vector<std::string>& patterns, const char* text)
+	{
+		for (size_t i = 0; i < patterns.size(); ++i)
+		{
+			const char* p = patterns[i].c_str();
+			for (const char* s = text; *s; ++s)
+			{
+				size_t n = 0;
+				while (p[n] && s[n] == p[n])
+					++n;
+				if (!p[n])
+					return static_cast<int>(i);
+			}
+		}
+		return -1;
+	}
+
+	// Random patterns over a small alphabet on random text: overlaps, prefixes of each other,
+	// single bytes (which turn the prefilter off).
+	int CrossCheckRandom(int rounds)
+	{
+		std::mt19937 rng(77);
+		int mismatches = 0;
+		for (int r = 0; r < rounds; ++r)
+		{
+			std::vector<std::string> patterns(1 + rng() % 12);
+			for (std::string& p : patterns)
+			{
+				p.resize(1 + rng() % (r % 3 == 0 ? 2 : 6));
+				for (char& c : p)
+					c = static_cast<char>('a' + rng() % 4);
+			}
+			SpewMatcher matcher;
+			matcher.Build(patterns);
+			std::string text(rng() % 80, ' ');
+			for (char& c : text)
+				c = static_cast<char>('a' + rng() % 6);
+			mismatches += matcher.Find(text.c_str()) != StrstrFind(patterns, text.c_str()) ? 1 : 0;
+		}
+		return mismatches;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const bool quick = vrtest::QuickMode(argc, argv);
+	const std::vector<std::string> spew = MakeSpew(quick ? 2000 : 60000, 1);
+	const int passes = quick ? 1 : 20;
+	size_t bytes = 0;
+	for (const std::string& line : spew)
+		bytes += line.size();
+
+	int mismatches = CrossCheckRandom(quick ? 2000 : 50000);
+	std::printf("%zu spew lines (%.1f KiB, %.0f bytes per line), %d passes\n", spew.size(), bytes / 1024.0,
+		double(bytes) / spew.size(), passes);
+	for (size_t ruleCount : { size_t(1), size_t(8), size_t(32) })
+	{
+		const std::vector<std::string> patterns = MakePatterns(ruleCount);
+		SpewMatcher matcher;
+		matcher.Build(patterns);
+
+		int matched = 0;
+		for (const std::string& line : spew)
+		{
+			const int found = matcher.Find(line.c_str());
+			mismatches += found != StrstrFind(patterns, line.c_str()) ? 1 : 0;
+			mismatches += ScalarFind(patterns, line.c_str()) != found ? 1 : 0;
+			matched += found >= 0 ? 1 : 0;
+		}
+
+		int sink = 0;
+		const double matcherSeconds = vrtest::BenchSeconds([&]()
+			{
+				for (int p = 0; p < passes; ++p)
+				{
+					for (const std::string& line : spew)
+						sink += matcher.Find(line.c_str());
+				}
+			});
+		const double strstrSeconds = vrtest::BenchSeconds([&]()
+			{
+				for (int p = 0; p < passes; ++p)
+				{
+					for (const std::string& line : spew)
+						sink += StrstrFind(patterns, line.c_str());
+				}
+			});
+
+		const double scalarSeconds = vrtest::BenchSeconds([&]()
+			{
+				for (int p = 0; p < passes; ++p)
+				{
+					for (const std::string& line : spew)
+						sink += ScalarFind(patterns, line.c_str());
+				}
+			});
+
+		// The whole callback path: matcher plus the per-rule counters and rate limit.
+		std::vector<SpewRule> rules;
+		for (size_t i = 0; i < patterns.size(); ++i)
+		{
+			SpewRule rule;
+			rule.pattern = patterns[i];
+			rule.action = (i % 3 == 1) ? SpewAction::RateLimit : (i % 3 == 2 ? SpewAction::Redirect : SpewAction::Suppress);
+			rule.perSecond = 5;
+			rules.push_back(rule);
+		}
+		const SpewFilter filter(rules);
+		int64_t nowMs = 0;
+		const double filterSeconds = vrtest::BenchSeconds([&]()
+			{
+				for (int p = 0; p < passes; ++p)
+				{
+					for (const std::string& line : spew)
+						sink += filter.Filter(line.c_str(), nowMs++ / 8).pass ? 1 : 0;
+				}
+			});
+		vrtest::DoNotOptimize(sink);
+
+		const double messages = double(spew.size()) * passes;
+		std::printf("  %2zu rules (%4zu DFA states, %5.1f%% of lines match):\n", ruleCount, matcher.GetStateCount(), 100.0 * matched / spew.size());
+		std::printf("    SpewMatcher::Find  %6.1f ns/message  %7.0f MiB/s\n", matcherSeconds * 1e9 / messages, bytes * passes / matcherSeconds / (1024.0 * 1024.0));
+		std::printf("    strstr per rule    %6.1f ns/message  %7.0f MiB/s\n", strstrSeconds * 1e9 / messages, bytes * passes / strstrSeconds / (1024.0 * 1024.0));
+		std::printf("    scalar per rule    %6.1f ns/message  %7.0f MiB/s\n", scalarSeconds * 1e9 / messages, bytes * passes / scalarSeconds / (1024.0 * 1024.0));
+		std::printf("    SpewFilter::Filter %6.1f ns/message\n", filterSeconds * 1e9 / messages);
+	}
+
+	if (mismatches != 0)
+	{
+		std::printf("FAILED: %d verdicts disagree with strstr\n", mismatches);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,143 @@
+// Submit-path contention: per-call m_TextureMutex (old SubmitVRTextures) vs GenerationPublisher reads.
+//
+// The submit thread runs frames of kSubmitsPerFrame texture hand-offs (two eyes, explicit timing,
+// HUD / scope / mirror overlays). In "mutex" mode each hand-off holds a recursive mutex around the
+// simulated compositor call, like the old code; in "generation" mode it reads the descriptor from
+// the current generation. Meanwhile the render thread takes the mutex for HUD render-target lookups
+// (both modes - those still lock) and republishes the texture set every so often.
+#include "texture_generation.h"
+#include "test_common.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	constexpr int kSubmitsPerFrame = 6;
+
+	struct Descriptor
+	{
+		uint64_t handle[4];
+	};
+
+	struct TextureSet
+	{
+		Descriptor textures[kSubmitsPerFrame];
+	};
+
+	void SpinMicros(double micros)
+	{
+		const auto until = std::chrono::steady_clock::now() + std::chrono::duration<double, std::micro>(micros);
+		while (std::chrono::steady_clock::now() < until)
+		{
+		}
+	}
+
+	struct Result
+	{
+		double avgUs = 0.0;
+		double p99Us = 0.0;
+		double maxUs = 0.0;
+	};
+
+	Result Run(bool useGenerations, int frames, double submitCallUs, double hudLockUs)
+	{
+		std::recursive_mutex textureMutex;
+		TextureSet legacy{};
+		GenerationPublisher<TextureSet> sets;
+		sets.Publish(std::make_unique<TextureSet>());
+
+		std::atomic<bool> stop{ false };
+		std::thread render([&]()
+			{
+				uint64_t n = 0;
+				while (!stop.load(std::memory_order_relaxed))
+				{
+					{
+						std::lock_guard<std::recursive_mutex> lock(textureMutex);
+						SpinMicros(hudLockUs);
+						legacy.textures[0].handle[0] = ++n;
+					}
+					// Texture recreation (resize, optics RTT toggle) is rare; model one every ~500 lookups.
+					if ((n % 500) == 0)
+					{
+						auto next = std::make_unique<TextureSet>();
+						next->textures[0].handle[0] = n;
+						std::lock_guard<std::recursive_mutex> lock(textureMutex);
+						sets.Publish(std::move(next));
+					}
+					std::this_thread::yield();
+				}
+			});
+
+		std::vector<double> frameUs;
+		frameUs.reserve(frames);
+		uint64_t sink = 0;
+		for (int f = 0; f < frames; ++f)
+		{
+			const double us = vrtest::BenchSeconds([&]()
+				{
+					if (useGenerations)
+					{
+						GenerationPublisher<TextureSet>::ReadGuard guard(sets);
+						for (int i = 0; i < kSubmitsPerFrame; ++i)
+						{
+							sink += guard.Get()->textures[i].handle[0];
+							SpinMicros(submitCallUs);
+						}
+					}
+					else
+					{
+						for (int i = 0; i < kSubmitsPerFrame; ++i)
+						{
+							std::lock_guard<std::recursive_mutex> lock(textureMutex);
+							sink += legacy.textures[i].handle[0];
+							SpinMicros(submitCallUs);
+						}
+					}
+				}) * 1e6;
+			frameUs.push_back(us);
+			sets.NoteConsumerFrame();
+		}
+		stop.store(true);
+		render.join();
+		vrtest::DoNotOptimize(sink);
+
+		std::sort(frameUs.begin(), frameUs.end());
+		Result r;
+		for (double us : frameUs)
+			r.avgUs += us;
+		r.avgUs /= frameUs.size();
+		r.p99Us = frameUs[std::min(frameUs.size() - 1, frameUs.size() * 99 / 100)];
+		r.maxUs = frameUs.back();
+		return r;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const bool quick = vrtest::QuickMode(argc, argv);
+	const int frames = quick ? 200 : 5000;
+	if (std::thread::hardware_concurrency() < 2)
+		std::printf("note: single hardware thread, contention numbers are not meaningful\n");
+
+	std::printf("%-11s %8s %8s | %10s %10s %10s\n", "mode", "submitUs", "hudUs", "avg us", "p99 us", "max us");
+	const double submitCosts[] = { 5.0, 20.0 };
+	const double hudCosts[] = { 10.0, 50.0 };
+	for (double submitUs : submitCosts)
+	{
+		for (double hudUs : hudCosts)
+		{
+			for (int mode = 0; mode < 2; ++mode)
+			{
+				const Result r = Run(mode == 1, frames, submitUs, hudUs);
+				std::printf("%-11s %8.0f %8.0f | %10.1f %10.1f %10.1f\n",
+					mode ? "generation" : "mutex", submitUs, hudUs, r.avgUs, r.p99Us, r.maxUs);
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,131 @@
+// Server tick cost of the VR pose history: every player pushes one command and the server asks for
+// one interpolated pose (a shot) per player per tick. VRServerStateStore (structure of arrays)
+// against the array-of-structs ring it replaced the idea of: one VRServerStateSample per slot.
+#include "vr_server_state.h"
+#include "test_common.h"
+
+#include <vector>
+
+namespace
+{
+	constexpr size_t kPlayers = 32;
+	constexpr size_t kHistory = 32;
+
+	// Reference: same ring and queries, samples stored whole.
+	class AosStore
+	{
+	public:
+		AosStore() : m_Samples(kPlayers * kHistory) {}
+
+		void Push(int player, const VRServerStateSample& s)
+		{
+			m_Samples[player * kHistory + m_Head[player]] = s;
+			m_Head[player] = (m_Head[player] + 1) % kHistory;
+			m_Count[player] = std::min(m_Count[player] + 1, kHistory);
+		}
+
+		bool SampleAtTick(int player, float tick, VRServerStateSample& out) const
+		{
+			const size_t count = m_Count[player];
+			if (count == 0)
+				return false;
+			auto at = [&](size_t n) -> const VRServerStateSample& {
+				return m_Samples[player * kHistory + (m_Head[player] + kHistory - count + n) % kHistory];
+			};
+			size_t lo = 0, hi = count;
+			while (lo < hi)
+			{
+				const size_t mid = (lo + hi) / 2;
+				if (float(at(mid).tick) <= tick)
+					lo = mid + 1;
+				else
+					hi = mid;
+			}
+			if (lo == 0 || lo == count)
+			{
+				out = at(lo == 0 ? 0 : count - 1);
+				return true;
+			}
+			const VRServerStateSample& a = at(lo - 1);
+			const VRServerStateSample& b = at(lo);
+			const float t = (tick - a.tick) / float(b.tick - a.tick);
+			out = b;
+			for (int k = 0; k < VRCmdPose_Count; ++k)
+			{
+				for (int c = 0; c < 3; ++c)
+					out.pose[k].pos[c] = a.pose[k].pos[c] + (b.pose[k].pos[c] - a.pose[k].pos[c]) * t;
+				VRServerStateStore<kPlayers, kHistory>::Nlerp(a.pose[k].quat, b.pose[k].quat, t, out.pose[k].quat);
+			}
+			return true;
+		}
+
+	private:
+		std::vector<VRServerStateSample> m_Samples;
+		size_t m_Head[kPlayers] = {};
+		size_t m_Count[kPlayers] = {};
+	};
+
+	VRServerStateSample MakeSample(int player, int command)
+	{
+		VRServerStateSample s;
+		s.commandNumber = command;
+		s.tick = command;
+		for (int k = 0; k < VRCmdPose_Count; ++k)
+		{
+			s.pose[k].valid = true;
+			s.pose[k].pos[0] = float(player + k);
+			s.pose[k].pos[1] = float(command % 97);
+			VRCmdPayloadCodec::AnglesToQuat(float(command % 60), float(player), 0.0f, s.pose[k].quat);
+		}
+		return s;
+	}
+
+	template <typename StoreT, typename BatchFn>
+	double NanosPerPlayerTick(StoreT& store, int ticks, BatchFn&& batch)
+	{
+		float sink = 0.0f;
+		const double seconds = vrtest::BenchSeconds([&]()
+			{
+				VRServerStateSample out;
+				for (int t = 1; t <= ticks; ++t)
+				{
+					for (int p = 0; p < int(kPlayers); ++p)
+					{
+						batch(store, p, t);
+						if (store.SampleAtTick(p, float(t) - 0.5f, out))
+							sink += out.pose[VRCmdPose_RightHand].pos[1];
+					}
+				}
+			});
+		vrtest::DoNotOptimize(sink);
+		return seconds * 1e9 / (double(ticks) * kPlayers);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const int ticks = vrtest::QuickMode(argc, argv) ? 200 : 200000;
+
+	VRServerStateStore<kPlayers, kHistory> soa;
+	const double soaNs = NanosPerPlayerTick(soa, ticks, [](auto& s, int p, int t) { s.Push(p, MakeSample(p, t)); });
+
+	VRServerStateStore<kPlayers, kHistory> batched;
+	const double batchNs = NanosPerPlayerTick(batched, ticks, [](auto& s, int p, int t)
+		{
+			s.BeginBatch(p);
+			s.Push(p, MakeSample(p, t));
+			s.EndBatch(p);
+		});
+
+	AosStore aos;
+	const double aosNs = NanosPerPlayerTick(aos, ticks, [](auto& s, int p, int t) { s.Push(p, MakeSample(p, t)); });
+
+	std::printf("%zu players, %zu-sample history, %d ticks\n", kPlayers, kHistory, ticks);
+	std::printf("  SoA store (push + query):             %6.1f ns per player per tick\n", soaNs);
+	std::printf("  SoA store (push + batch lag + query): %6.1f ns per player per tick\n", batchNs);
+	std::printf("  AoS ring  (push + query):             %6.1f ns per player per tick\n", aosNs);
+	std::printf("  store footprint: %zu bytes SoA vs %zu bytes AoS\n",
+		kPlayers * kHistory * (4 + 4 + 1 + VRCmdPose_Count * (1 + 12 + 16)),
+		kPlayers * kHistory * sizeof(VRServerStateSample));
+	return 0;
+}
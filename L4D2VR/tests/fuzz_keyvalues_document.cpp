@@ -0,0 +1,188 @@
+// Fuzz target for KeyValuesDocument: any byte string must parse without crashing, hanging or
+// producing a malformed node tree, with #base / #include resolved through a loader that feeds the
+// input back in (self-inclusion, the worst case for the include caps).
+//
+// With Clang and -DL4D2VR_BUILD_FUZZERS=ON this is a libFuzzer target:
+//   fuzz_keyvalues_document -max_len=4096 corpus/
+// Otherwise it builds a standalone driver that mutates a built-in corpus of weapon-script and VMT
+// shaped texts with a fixed seed (--quick for the CTest smoke run, --iterations N for longer runs).
+#include "keyvalues_document.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	[[noreturn]] void Violation(const char* what, const uint8_t* data, size_t size)
+	{
+		std::fprintf(stderr, "keyvalues_document invariant violated: %s (input %zu bytes)\n", what, size);
+		std::fwrite(data, 1, size, stderr);
+		std::fputc('\n', stderr);
+		std::abort();
+	}
+
+	// Structural invariants of a parsed document, whatever the input was.
+	void CheckDocument(const KeyValuesDocument& doc, const uint8_t* data, size_t size)
+	{
+		const int count = static_cast<int>(doc.NodeCount());
+		if (count < 1 || !doc.Get(KeyValuesDocument::kRoot).isBlock)
+			Violation("root missing", data, size);
+
+		std::vector<int> seen(static_cast<size_t>(count), 0);
+		for (int i = 0; i < count; ++i)
+		{
+			const KeyValuesDocument::Node& n = doc.Get(i);
+			if (n.firstChild != KeyValuesDocument::kNone && (n.firstChild <= i || n.firstChild >= count))
+				Violation("child link out of order", data, size);
+			if (n.nextSibling != KeyValuesDocument::kNone && (n.nextSibling <= i || n.nextSibling >= count))
+				Violation("sibling link out of order", data, size);
+			if (!n.isBlock && n.firstChild != KeyValuesDocument::kNone)
+				Violation("value node with children", data, size);
+			if (i != KeyValuesDocument::kRoot && n.keyHash != KeyValuesDocument::HashKey(n.key))
+				Violation("stale key hash", data, size);
+
+			for (int child = n.firstChild; child != KeyValuesDocument::kNone; child = doc.NextSibling(child))
+			{
+				if (++seen[static_cast<size_t>(child)] > 1)
+					Violation("node reachable twice", data, size);
+			}
+
+			// Every lookup path must stay in bounds and agree with itself.
+			float f = 0.0f;
+			bool b = false;
+			doc.GetFloat(i, f);
+			doc.GetBool(i, b);
+			if (i != KeyValuesDocument::kRoot)
+			{
+				const int found = doc.FindRecursive(KeyValuesDocument::kRoot, n.key);
+				if (found == KeyValuesDocument::kNone || found > i)
+					Violation("FindRecursive missed an earlier-or-equal node", data, size);
+			}
+		}
+		for (int i = 1; i < count; ++i)
+		{
+			if (seen[static_cast<size_t>(i)] != 1)
+				Violation("orphan node", data, size);
+		}
+	}
+
+	void RunOne(const uint8_t* data, size_t size)
+	{
+		const std::string text(reinterpret_cast<const char*>(data), size);
+		const KeyValuesDocument::IncludeLoader loader = [&](std::string_view, std::string& out)
+			{
+				out = text;
+				return true;
+			};
+
+		KeyValuesDocument doc;
+		doc.Parse(text, &loader);
+		CheckDocument(doc, data, size);
+
+		const int lines = 1 + static_cast<int>(std::count(text.begin(), text.end(), '\n'));
+		if (doc.ErrorLine() < 0 || doc.ErrorLine() > lines)
+			Violation("error line past the end of the input", data, size);
+
+		// ParseCopy must agree with Parse on the same text.
+		KeyValuesDocument copy;
+		copy.ParseCopy(text, &loader);
+		if (copy.NodeCount() != doc.NodeCount() || copy.ErrorLine() != doc.ErrorLine())
+			Violation("ParseCopy disagrees with Parse", data, size);
+	}
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	RunOne(data, size);
+	return 0;
+}
+
+#ifndef L4D2VR_LIBFUZZER
+namespace
+{
+	const char* const kCorpus[] = {
+		"WeaponData\n{\n\t\"printname\"\t\"#L4D_Weapon_SMG\"\n\t\"Range\"\t\"2500\"\n\t\"RangeModifier\"\t\"0.84\"\n"
+		"\t\"Bullets\" \"1\" [$X360]\n\t\"SpreadPerShot\"\t\"0.32\"\n\t\"MaxSpread\" \"30\" // comment\n"
+		"\tSoundData\n\t{\n\t\t\"single_shot\"\t\"SMG.Fire\"\n\t}\n}\n",
+		"\"UnlitGeneric\"\n{\n\t\"$basetexture\" \"vgui/hud/killicon\"\n\t\"$additive\" 1\n\t\"Proxies\"\n\t{\n"
+		"\t\t\"AnimatedTexture\"\n\t\t{\n\t\t\t\"animatedTextureVar\" \"$basetexture\"\n"
+		"\t\t\t\"animatedTextureFrameRate\" \"30\"\n\t\t}\n\t}\n}\n",
+		"#base \"weapon_base.txt\"\n#include \"other.txt\"\nWeaponData { Damage 20 }\n",
+		"a { b { c { d { e \"f\" } } } }",
+		"\"unterminated { \"string\n",
+	};
+
+	const char* const kTokens[] = { "{", "}", "\"", "//", "\n", "[$X360]", "#base", "#include", " ", "1e39", "-0", "yes" };
+
+	std::string Mutate(std::mt19937& rng, const std::string& seed)
+	{
+		std::string s = seed;
+		const int edits = 1 + static_cast<int>(rng() % 8);
+		for (int e = 0; e < edits; ++e)
+		{
+			const size_t at = s.empty() ? 0 : rng() % (s.size() + 1);
+			switch (rng() % 5)
+			{
+			case 0:   // flip a byte
+				if (!s.empty())
+					s[at % s.size()] = static_cast<char>(rng());
+				break;
+			case 1:   // insert a token
+				s.insert(at, kTokens[rng() % (sizeof(kTokens) / sizeof(kTokens[0]))]);
+				break;
+			case 2:   // delete a run
+				if (!s.empty())
+					s.erase(at % s.size(), 1 + rng() % 16);
+				break;
+			case 3:   // splice another corpus entry in
+				s.insert(at, kCorpus[rng() % (sizeof(kCorpus) / sizeof(kCorpus[0]))]);
+				break;
+			default:  // truncate
+				s.resize(at);
+				break;
+			}
+		}
+		return s;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	long iterations = 200000;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--quick") == 0)
+			iterations = 5000;
+		else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+			iterations = std::atol(argv[++i]);
+	}
+
+	// Hostile shapes the mutator is unlikely to reach on its own.
+	std::vector<std::string> inputs(std::begin(kCorpus), std::end(kCorpus));
+	inputs.push_back(std::string(200000, '{'));
+	std::string deep;
+	for (int i = 0; i < 10000; ++i)
+		deep += "k {";
+	inputs.push_back(deep);
+	inputs.push_back("#base x\n#base x\n#base x\n#base x\nk v\n");
+	inputs.push_back(std::string());
+	for (const std::string& input : inputs)
+		RunOne(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+
+	std::mt19937 rng(0x4b56u);
+	size_t bytes = 0;
+	for (long i = 0; i < iterations; ++i)
+	{
+		const std::string input = Mutate(rng, kCorpus[rng() % (sizeof(kCorpus) / sizeof(kCorpus[0]))]);
+		bytes += input.size();
+		RunOne(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+	}
+	std::printf("%ld mutated inputs (%.1f MiB) parsed, invariants held\n", iterations, bytes / (1024.0 * 1024.0));
+	return 0;
+}
+#endif
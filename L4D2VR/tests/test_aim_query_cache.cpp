@@ -0,0 +1,162 @@
+// AimQueryCache: which requests a cached trace may answer, and how far the answer can be from the truth.
+#include "aim_query_cache.h"
+#include "test_common.h"
+
+#include <random>
+
+namespace
+{
+	struct TraceResult
+	{
+		float end[3] = {};
+	};
+
+	using Cache = AimQueryCache<TraceResult, 32>;
+
+	// A wall: the plane n . p = d (n unit). Tracing it gives the analytic intersection.
+	struct Wall
+	{
+		float n[3] = { 1.0f, 0.0f, 0.0f };
+		float d = 1000.0f;
+		int traces = 0;
+
+		bool operator()(const AimQueryRay& r, TraceResult& out, float& hitDistance)
+		{
+			++traces;
+			const float denom = n[0] * r.dir[0] + n[1] * r.dir[1] + n[2] * r.dir[2];
+			const float num = d - (n[0] * r.start[0] + n[1] * r.start[1] + n[2] * r.start[2]);
+			const float t = (std::fabs(denom) > 1e-6f) ? num / denom : -1.0f;
+			hitDistance = (t >= 0.0f && t < r.length) ? t : r.length;
+			for (int i = 0; i < 3; ++i)
+				out.end[i] = r.start[i] + r.dir[i] * hitDistance;
+			return true;
+		}
+	};
+
+	AimQueryRay MakeRay(float yawDeg, float length, float startY = 0.0f)
+	{
+		const float a = yawDeg * 3.14159265f / 180.0f;
+		const float s[3] = { 0.0f, startY, 64.0f };
+		const float e[3] = { s[0] + std::cos(a) * length, s[1] + std::sin(a) * length, s[2] };
+		AimQueryRay r;
+		AimQueryRay::FromPoints(s, e, r);
+		r.mask = 1;
+		r.filterKey = 7;
+		return r;
+	}
+}
+
+VR_TEST(RepeatOfTheSameRayIsServed)
+{
+	Cache cache;
+	Wall wall;
+	VR_CHECK(!cache.Query(1, MakeRay(0.0f, 8192.0f), wall).fromCache);
+	const AimQueryServe<TraceResult> s = cache.Query(1, MakeRay(0.0f, 8192.0f), wall);
+	VR_CHECK(s.fromCache);
+	VR_CHECK(s.Hit(8192.0f));
+	VR_CHECK_NEAR(s.hitDistance, 1000.0, 1e-3);
+	VR_CHECK(wall.traces == 1);
+
+	// A new frame starts empty; a different filter never matches.
+	VR_CHECK(!cache.Query(2, MakeRay(0.0f, 8192.0f), wall).fromCache);
+	AimQueryRay other = MakeRay(0.0f, 8192.0f);
+	other.filterKey = 8;
+	VR_CHECK(!cache.Query(2, other, wall).fromCache);
+}
+
+VR_TEST(AngularToleranceShrinksWithRange)
+{
+	Cache cache;
+	Wall wall;
+
+	// 0.1 degrees at a 1000-unit hit is ~1.7 units apart: traced again.
+	cache.Query(1, MakeRay(0.0f, 8192.0f), wall);
+	VR_CHECK(!cache.Query(1, MakeRay(0.1f, 8192.0f), wall).fromCache);
+
+	// The same angle against a wall 20 units away is ~0.035 units apart: served.
+	Wall near;
+	near.d = 20.0f;
+	cache.Invalidate();
+	cache.Query(1, MakeRay(0.0f, 8192.0f), near);
+	VR_CHECK(cache.Query(1, MakeRay(0.1f, 8192.0f), near).fromCache);
+
+	// With no hit the whole request length counts.
+	Wall none;
+	none.d = -10.0f;
+	cache.Invalidate();
+	cache.Query(1, MakeRay(0.0f, 8192.0f), none);
+	VR_CHECK(!cache.Query(1, MakeRay(0.01f, 8192.0f), none).fromCache);
+	VR_CHECK(cache.Query(1, MakeRay(0.0f, 8192.0f, 0.1f), none).fromCache);
+	VR_CHECK(!cache.Query(1, MakeRay(0.0f, 8192.0f, 0.3f), none).fromCache);
+}
+
+VR_TEST(CachedTraceMustDecideTheRequestLength)
+{
+	Cache cache;
+	Wall none;
+	none.d = -10.0f;
+	cache.Query(1, MakeRay(0.0f, 500.0f), none);
+	VR_CHECK(cache.Query(1, MakeRay(0.0f, 400.0f), none).fromCache);
+	VR_CHECK(!cache.Query(1, MakeRay(0.0f, 600.0f), none).fromCache);
+
+	Wall wall;
+	wall.d = 300.0f;
+	cache.Invalidate();
+	cache.Query(1, MakeRay(0.0f, 500.0f), wall);
+	const AimQueryServe<TraceResult> s = cache.Query(1, MakeRay(0.0f, 8192.0f), wall);
+	VR_CHECK(s.fromCache && s.Hit(8192.0f));
+	VR_CHECK(!s.Hit(200.0f));
+}
+
+VR_TEST(ServedEndPositionStaysOnTheRequestRay)
+{
+	// Jittered aim at a slanted wall, as a hand tremor would produce. Every served answer is rebuilt
+	// along the request's own ray (what VR::AimTraceRay does); compare it to the exact intersection.
+	std::mt19937 rng(5);
+	std::normal_distribution<float> jitter(0.0f, 0.02f);
+	Wall wall;
+	const float inv = 1.0f / std::sqrt(2.0f);
+	wall.n[0] = inv;
+	wall.n[1] = inv;
+	wall.d = 600.0f;
+
+	Cache cache;
+	double worstProjected = 0.0, worstReused = 0.0;
+	int served = 0;
+	for (int frame = 0; frame < 500; ++frame)
+	{
+		const AimQueryRay base = MakeRay(jitter(rng) * 10.0f, 8192.0f);
+		cache.Query(frame, base, wall);
+		for (int k = 0; k < 6; ++k)
+		{
+			const AimQueryRay r = MakeRay(base.dir[1] * 57.2957795f + jitter(rng), 8192.0f);
+			const AimQueryServe<TraceResult> s = cache.Query(frame, r, wall);
+			if (!s.fromCache)
+				continue;
+			++served;
+			TraceResult truth;
+			float truthDistance = 0.0f;
+			wall(r, truth, truthDistance);
+			double projected = 0.0, reused = 0.0;
+			for (int i = 0; i < 3; ++i)
+			{
+				const double p = r.start[i] + r.dir[i] * s.hitDistance - truth.end[i];
+				const double q = s.result->end[i] - truth.end[i];
+				projected += p * p;
+				reused += q * q;
+			}
+			worstProjected = std::max(worstProjected, std::sqrt(projected));
+			worstReused = std::max(worstReused, std::sqrt(reused));
+		}
+	}
+	std::printf("  served %d: worst end position error %.3f u projected, %.3f u reusing the cached end\n",
+		served, worstProjected, worstReused);
+	VR_CHECK(served > 0);
+	// Rays within maxDeviation of each other meet a 45-degree wall within maxDeviation * sqrt(2).
+	VR_CHECK(worstProjected <= 0.25 * std::sqrt(2.0) + 1e-3);
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
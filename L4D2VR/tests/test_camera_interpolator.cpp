@@ -0,0 +1,309 @@
+// CameraInterpolator on engine camera traces: tick-quantized paths whose ticks show up on the first
+// render frame after a few ms of jitter, the way the engine camera reaches the render hook. Checks
+// the tick estimate, error and jerk against the two-sample smoothstep blend it replaced, snaps,
+// yaw wrap, restarts from rest and the extrapolation bound.
+#include "camera_interpolator.h"
+#include "test_common.h"
+
+#include <functional>
+#include <random>
+
+namespace
+{
+	using Path = std::function<CameraPose(double)>;
+
+	float Wrap(float deg) { return CameraInterpolator::WrapDeg(deg); }
+
+	float Distance(const CameraPose& a, const CameraPose& b)
+	{
+		float sq = 0.0f;
+		for (int i = 0; i < 3; ++i)
+			sq += (a.origin[i] - b.origin[i]) * (a.origin[i] - b.origin[i]);
+		return std::sqrt(sq);
+	}
+
+	// The smoother camera_interpolator.h replaced (EngineThirdPersonCamSmoother in hooks.cpp), with the
+	// clock passed in: blend the last two samples with a smoothstep over an EMA of the tick length.
+	struct LegacySmoother
+	{
+		bool valid = false;
+		CameraPose prev;
+		CameraPose curr;
+		double lastRawUpdate = 0.0;
+		double blendStart = 0.0;
+		float tickIntervalSec = 1.0f / 30.0f;
+
+		void Push(double now, const CameraPose& raw)
+		{
+			if (!valid)
+			{
+				valid = true;
+				prev = curr = raw;
+				lastRawUpdate = blendStart = now;
+				return;
+			}
+			float posSq = 0.0f;
+			float ang = 0.0f;
+			for (int i = 0; i < 3; ++i)
+			{
+				posSq += (raw.origin[i] - curr.origin[i]) * (raw.origin[i] - curr.origin[i]);
+				ang += std::fabs(Wrap(raw.angles[i] - curr.angles[i]));
+			}
+			if (posSq > 0.25f * 0.25f || ang > 0.25f)
+			{
+				const float dt = static_cast<float>(now - lastRawUpdate);
+				tickIntervalSec = tickIntervalSec * 0.8f + std::clamp(dt, 0.008f, 0.100f) * 0.2f;
+				prev = curr;
+				curr = raw;
+				lastRawUpdate = blendStart = now;
+			}
+		}
+
+		CameraPose Get(double now) const
+		{
+			if (tickIntervalSec <= 0.016f)
+				return curr;
+			float t = std::clamp(static_cast<float>(now - blendStart) / std::max(0.001f, tickIntervalSec), 0.0f, 1.0f);
+			t = t * t * (3.0f - 2.0f * t);
+			CameraPose out;
+			for (int i = 0; i < 3; ++i)
+			{
+				out.origin[i] = prev.origin[i] + (curr.origin[i] - prev.origin[i]) * t;
+				out.angles[i] = prev.angles[i] + Wrap(curr.angles[i] - prev.angles[i]) * t;
+			}
+			return out;
+		}
+	};
+
+	struct TraceResult
+	{
+		double meanError = 0.0;     // units from the true camera at render time
+		double jerk = 0.0;          // RMS second difference of the rendered origin per frame
+		uint32_t snaps = 0;
+		std::vector<CameraPose> frames;
+	};
+
+	// Render `seconds` of `path` at renderHz while the engine ticks at tickHz. Frames in the first half
+	// second are rendered but not scored.
+	template <typename Smoother, typename Push, typename Get>
+	TraceResult Replay(Smoother& smoother, Push push, Get get, const Path& path, double tickHz, double renderHz,
+		double seconds, unsigned seed)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<double> jitter(0.0, 0.003);
+		const double tick = 1.0 / tickHz;
+		const double frame = 1.0 / renderHz;
+
+		TraceResult result;
+		int tickIndex = 0;
+		double tickVisibleAt = jitter(rng);
+		CameraPose raw = path(0.0);
+		double errorSum = 0.0, jerkSum = 0.0;
+		int scored = 0;
+		for (int n = 0; n * frame < seconds; ++n)
+		{
+			const double now = n * frame;
+			while (now >= tickVisibleAt)
+			{
+				raw = path(tickIndex * tick);
+				++tickIndex;
+				tickVisibleAt = tickIndex * tick + jitter(rng);
+			}
+			push(smoother, now, raw);
+			result.frames.push_back(get(smoother, now));
+			if (now < 0.5)
+				continue;
+			errorSum += Distance(result.frames.back(), path(now));
+			const size_t k = result.frames.size();
+			float sq = 0.0f;
+			for (int i = 0; i < 3; ++i)
+			{
+				const float d2 = result.frames[k - 1].origin[i] - 2.0f * result.frames[k - 2].origin[i] + result.frames[k - 3].origin[i];
+				sq += d2 * d2;
+			}
+			jerkSum += sq;
+			++scored;
+		}
+		result.meanError = errorSum / scored;
+		result.jerk = std::sqrt(jerkSum / scored);
+		return result;
+	}
+
+	TraceResult ReplayNew(const Path& path, double tickHz, double renderHz, double seconds, unsigned seed = 1)
+	{
+		CameraInterpolator interp;
+		TraceResult r = Replay(interp,
+			[](CameraInterpolator& s, double now, const CameraPose& raw) { s.Push(now, raw); },
+			[](const CameraInterpolator& s, double now) { return s.Evaluate(now); },
+			path, tickHz, renderHz, seconds, seed);
+		r.snaps = interp.GetSnapCount();
+		return r;
+	}
+
+	TraceResult ReplayLegacy(const Path& path, double tickHz, double renderHz, double seconds, unsigned seed = 1)
+	{
+		LegacySmoother legacy;
+		return Replay(legacy,
+			[](LegacySmoother& s, double now, const CameraPose& raw) { s.Push(now, raw); },
+			[](const LegacySmoother& s, double now) { return s.Get(now); },
+			path, tickHz, renderHz, seconds, seed);
+	}
+
+	CameraPose Pose(float x, float y, float z, float pitch = 0.0f, float yaw = 0.0f)
+	{
+		CameraPose p;
+		p.origin[0] = x; p.origin[1] = y; p.origin[2] = z;
+		p.angles[0] = pitch; p.angles[1] = yaw;
+		return p;
+	}
+
+	// Running down a street at survivor speed, turning slowly.
+	CameraPose Run(double t) { return Pose(static_cast<float>(220.0 * t), 0.0f, 64.0f, 5.0f, static_cast<float>(10.0 * t)); }
+
+	// Strafing back and forth.
+	CameraPose Strafe(double t) { return Pose(0.0f, static_cast<float>(120.0 * std::sin(3.0 * t)), 64.0f); }
+}
+
+VR_TEST(TickEstimateFollowsTheEngine)
+{
+	const double ticks[] = { 30.0, 60.0, 64.0 };
+	for (double tickHz : ticks)
+	{
+		CameraInterpolator interp;
+		Replay(interp,
+			[](CameraInterpolator& s, double now, const CameraPose& raw) { s.Push(now, raw); },
+			[](const CameraInterpolator& s, double now) { return s.Evaluate(now); },
+			Run, tickHz, 90.0, 2.0, 3);
+		std::printf("  %2.0f Hz engine at 90 Hz render: tick %.2f ms\n", tickHz, interp.GetTickInterval() * 1e3);
+		// Two ticks that turn up in the same render frame are one sample to us, so the estimate runs
+		// long by up to about a tenth when the tick is close to the render interval.
+		VR_CHECK(interp.GetTickInterval() >= 0.98 / tickHz && interp.GetTickInterval() <= 1.12 / tickHz);
+		VR_CHECK_NEAR(interp.GetRenderInterval(), 1.0 / 90.0, 1e-4);
+		VR_CHECK(interp.ShouldSmooth());
+	}
+
+	// An engine camera that updates every render frame isn't smoothed (no added lag).
+	CameraInterpolator same;
+	Replay(same,
+		[](CameraInterpolator& s, double now, const CameraPose& raw) { s.Push(now, raw); },
+		[](const CameraInterpolator& s, double now) { return s.Evaluate(now); },
+		Run, 90.0, 90.0, 1.0, 4);
+	VR_CHECK(!same.ShouldSmooth());
+}
+
+VR_TEST(TracesBeatTheTwoSampleBlend)
+{
+	struct Case { const char* name; CameraPose (*path)(double); double tickHz, renderHz; };
+	const Case cases[] = {
+		{ "run 220u/s", Run, 30.0, 90.0 },
+		{ "strafe sine", Strafe, 30.0, 90.0 },
+		{ "run 220u/s", Run, 60.0, 90.0 },
+		{ "strafe sine", Strafe, 60.0, 120.0 },
+	};
+	for (const Case& c : cases)
+	{
+		const TraceResult legacy = ReplayLegacy(c.path, c.tickHz, c.renderHz, 6.0);
+		const TraceResult interp = ReplayNew(c.path, c.tickHz, c.renderHz, 6.0);
+		std::printf("  %2.0f/%3.0f %-12s err %5.2f -> %5.2f  jerk %4.2f -> %4.2f\n", c.tickHz, c.renderHz, c.name,
+			legacy.meanError, interp.meanError, legacy.jerk, interp.jerk);
+		VR_CHECK(interp.meanError < legacy.meanError);
+		VR_CHECK(interp.jerk < legacy.jerk);
+		VR_CHECK(interp.snaps == 0);
+	}
+}
+
+VR_TEST(TeleportsSnapOnTheSameFrame)
+{
+	// Running, then a teleport 600 units away (a ledge grab / respawn), then running on from there.
+	auto path = [](double t) { return t < 2.0 ? Run(t) : Pose(static_cast<float>(220.0 * t) + 600.0f, 300.0f, 64.0f, 5.0f, 20.0f); };
+	const TraceResult r = ReplayNew(path, 30.0, 90.0, 3.0);
+	VR_CHECK(r.snaps == 1);
+
+	// No rendered frame lands between the two places.
+	int between = 0;
+	for (const CameraPose& f : r.frames)
+		between += (f.origin[1] > 1.0f && f.origin[1] < 299.0f) ? 1 : 0;
+	VR_CHECK(between == 0);
+
+	// The first frame at the new place is the engine's own camera, not a blend toward it.
+	CameraInterpolator interp;
+	double now = 0.0;
+	for (int i = 0; i < 60; ++i, now += 1.0 / 30.0)
+		interp.Push(now, Run(now));
+	const CameraPose target = Pose(5000.0f, 0.0f, 64.0f);
+	VR_CHECK(interp.Push(now, target));
+	VR_CHECK(Distance(interp.Evaluate(now), target) < 1e-3f);
+}
+
+VR_TEST(FastFallsSnapAtMostOnce)
+{
+	// Falling at 2500 u/s covers more than the snap distance every tick.
+	auto fall = [](double t) { return Pose(0.0f, 0.0f, static_cast<float>(t < 0.5 ? 0.0 : -2500.0 * (t - 0.5))); };
+	const TraceResult r = ReplayNew(fall, 30.0, 90.0, 2.0);
+	VR_CHECK(r.snaps <= 1);
+	// And the rendered camera keeps falling smoothly with it.
+	VR_CHECK(std::fabs(r.frames.back().origin[2] - fall(2.0).origin[2]) < 2500.0f / 30.0f * 1.5f);
+}
+
+VR_TEST(YawWrapsAcrossTheSeam)
+{
+	// Turning at 200 deg/s through +/-180 several times.
+	auto turn = [](double t) { return Pose(0.0f, 0.0f, 64.0f, 0.0f, Wrap(static_cast<float>(170.0 + 200.0 * t))); };
+	const TraceResult r = ReplayNew(turn, 30.0, 90.0, 4.0);
+	VR_CHECK(r.snaps == 0);
+	float worstStep = 0.0f;
+	for (size_t i = 1; i < r.frames.size(); ++i)
+	{
+		const float yaw = r.frames[i].angles[1];
+		VR_CHECK(yaw >= -180.0f && yaw < 180.0f);
+		worstStep = std::max(worstStep, std::fabs(Wrap(yaw - r.frames[i - 1].angles[1])));
+	}
+	// 200 deg/s at 90 Hz is 2.2 degrees a frame.
+	VR_CHECK(worstStep < 4.0f);
+}
+
+VR_TEST(StandingStillRestartsFromRest)
+{
+	// Stand for a second, then walk off: the camera neither drifts before the move nor eases in over
+	// the whole idle stretch.
+	auto path = [](double t) { return Pose(t < 1.0 ? 0.0f : static_cast<float>(150.0 * (t - 1.0)), 0.0f, 64.0f); };
+	const TraceResult r = ReplayNew(path, 30.0, 90.0, 2.0);
+	float minX = 0.0f;
+	for (size_t i = 0; i < r.frames.size(); ++i)
+	{
+		const double now = i / 90.0;
+		minX = std::min(minX, r.frames[i].origin[0]);
+		if (now < 1.0)
+			VR_CHECK(r.frames[i].origin[0] == 0.0f);
+		if (now > 1.2)
+			VR_CHECK(path(now).origin[0] - r.frames[i].origin[0] < 150.0f * 0.1f);
+	}
+	VR_CHECK(minX >= -0.01f);
+}
+
+VR_TEST(ExtrapolationIsBounded)
+{
+	// The engine stops sending while the camera was moving (a hitch): the pose follows the last
+	// velocity for maxExtrapolateTicks and then holds.
+	CameraInterpolator interp;
+	const double tick = 1.0 / 30.0;
+	double now = 0.0;
+	for (int i = 0; i < 30; ++i, now += tick)
+		interp.Push(now, Run(now));
+	const double last = now - tick;
+	const CameraPose held = interp.Evaluate(last + 10.0);
+	const CameraPose later = interp.Evaluate(last + 20.0);
+	VR_CHECK(Distance(held, later) < 1e-4f);
+	const float ahead = held.origin[0] - Run(last).origin[0];
+	VR_CHECK(ahead > 0.0f && ahead <= 220.0f * interp.GetSettings().maxExtrapolateTicks * interp.GetTickInterval() * 1.05f);
+
+	// Reset drops the history.
+	interp.Reset();
+	VR_CHECK(!interp.IsValid());
+	VR_CHECK(Distance(interp.Evaluate(now), CameraPose{}) == 0.0f);
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+// ------------------------------------------------------------
+// Minimal test / benchmark support for the module tests.
+//
+// No framework dependency: VR_TEST registers a case, VR_CHECK* record failures and keep going,
+// RunAllTests() returns the process exit code. Benchmarks time a callable with BenchSeconds() and
+// read --quick from the command line.
+// ------------------------------------------------------------
+
+namespace vrtest
+{
+	struct TestCase
+	{
+		const char* name;
+		void (*fn)();
+	};
+
+	inline std::vector<TestCase>& Registry()
+	{
+		static std::vector<TestCase> cases;
+		return cases;
+	}
+
+	inline int& FailureCount()
+	{
+		static int failures = 0;
+		return failures;
+	}
+
+	struct Registrar
+	{
+		Registrar(const char* name, void (*fn)()) { Registry().push_back({ name, fn }); }
+	};
+
+	inline void Fail(const char* file, int line, const char* expr)
+	{
+		++FailureCount();
+		std::printf("  FAILED %s:%d: %s\n", file, line, expr);
+	}
+
+	inline void FailNear(const char* file, int line, const char* expr, double a, double b)
+	{
+		++FailureCount();
+		std::printf("  FAILED %s:%d: %s (%g vs %g)\n", file, line, expr, a, b);
+	}
+
+	inline int RunAllTests()
+	{
+		for (const TestCase& c : Registry())
+		{
+			const int before = FailureCount();
+			c.fn();
+			std::printf("[%s] %s\n", (FailureCount() == before) ? "pass" : "FAIL", c.name);
+		}
+		std::printf("%zu cases, %d failed checks\n", Registry().size(), FailureCount());
+		return FailureCount() == 0 ? 0 : 1;
+	}
+
+	inline bool QuickMode(int argc, char** argv)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			if (std::strcmp(argv[i], "--quick") == 0)
+				return true;
+		}
+		return false;
+	}
+
+	// Wall time of fn() in seconds.
+	template <typename Fn>
+	double BenchSeconds(Fn&& fn)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		fn();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	inline volatile char g_BenchSink = 0;
+
+	// Keeps the optimizer from dropping a benchmark result.
+	template <typename T>
+	inline void DoNotOptimize(const T& value)
+	{
+		g_BenchSink = *reinterpret_cast<const volatile char*>(&value);
+	}
+}
+
+#define VR_TEST(name) \
+	static void name(); \
+	static vrtest::Registrar name##_registrar(#name, name); \
+	static void name()
+
+#define VR_CHECK(cond) \
+	do { if (!(cond)) vrtest::Fail(__FILE__, __LINE__, #cond); } while (0)
+
+#define VR_CHECK_NEAR(a, b, eps) \
+	do { if (!(std::fabs(static_cast<double>(a) - static_cast<double>(b)) <= static_cast<double>(eps))) vrtest::FailNear(__FILE__, __LINE__, #a " ~= " #b, static_cast<double>(a), static_cast<double>(b)); } while (0)
@@ -0,0 +1,92 @@
+// EntitySpatialHash: grid queries agree with the linear fallback, and re-gridding keeps queries valid.
+#include "entity_spatial_hash.h"
+#include "test_common.h"
+
+#include <random>
+
+namespace
+{
+	void Fill(EntitySpatialHash& grid, int count, unsigned seed)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> xy(-3000.0f, 3000.0f);
+		std::uniform_real_distribution<float> z(-100.0f, 300.0f);
+		grid.BeginUpdate();
+		for (int i = 1; i <= count; ++i)
+			grid.Update(i, { xy(rng), xy(rng), z(rng) }, (i % 3 == 0) ? 1u : 2u);
+		grid.EndUpdate();
+	}
+
+	bool SameHits(const std::vector<EntitySpatialHit>& a, const std::vector<EntitySpatialHit>& b)
+	{
+		if (a.size() != b.size())
+			return false;
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			if (a[i].index != b[i].index || std::fabs(a[i].distance - b[i].distance) > 1e-3f)
+				return false;
+		}
+		return true;
+	}
+}
+
+VR_TEST(LinearFallbackMatchesCellWalk)
+{
+	for (int count : { 5, 24, 25, 300 })
+	{
+		EntitySpatialHash cells(512, 256.0f);
+		EntitySpatialHash linear(512, 256.0f);
+		cells.m_LinearScanMax = 0;
+		linear.m_LinearScanMax = 4096;
+		Fill(cells, count, 3);
+		Fill(linear, count, 3);
+
+		std::vector<EntitySpatialHit> a, b;
+		for (float r : { 100.0f, 600.0f, 2500.0f })
+		{
+			cells.QueryRadius({ 100.0f, -200.0f, 50.0f }, r, 2u, a);
+			linear.QueryRadius({ 100.0f, -200.0f, 50.0f }, r, 2u, b);
+			VR_CHECK(SameHits(a, b));
+		}
+
+		EntitySpatialCone cone;
+		cone.origin = { 0.0f, 0.0f, 64.0f };
+		cone.dir = { 1.0f, 0.0f, 0.0f };
+		cone.minDot = 0.7f;
+		cone.maxDistance = 1500.0f;
+		cone.planar = true;
+		cone.slack = 32.0f;
+		cells.QueryCone(cone, 3u, a);
+		linear.QueryCone(cone, 3u, b);
+		VR_CHECK(SameHits(a, b));
+	}
+}
+
+VR_TEST(SmallGridsScanTheLiveList)
+{
+	EntitySpatialHash grid(512, 64.0f);
+	Fill(grid, 10, 9);
+	grid.ResetCounters();
+	std::vector<EntitySpatialHit> hits;
+	grid.QueryRadius({ 0.0f, 0.0f, 0.0f }, 1000.0f, ~0u, hits);
+	// 10 live entities visited once each, instead of (2 * 1000 / 64 + 1)^2 cells.
+	VR_CHECK(grid.GetCounters().visited == 10);
+}
+
+VR_TEST(ConfigureRegridsAndDropsEntities)
+{
+	EntitySpatialHash grid(512, 256.0f);
+	Fill(grid, 100, 4);
+	VR_CHECK(grid.Size() == 100);
+	grid.Configure(grid.GetMaxEntities(), 512.0f);
+	VR_CHECK(grid.Size() == 0);
+	VR_CHECK(grid.GetCellSize() == 512.0f);
+	Fill(grid, 100, 4);
+	std::vector<EntitySpatialHit> hits;
+	VR_CHECK(grid.QueryNearest({ 0.0f, 0.0f, 0.0f }, 5, 10000.0f, ~0u, hits) == 5);
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
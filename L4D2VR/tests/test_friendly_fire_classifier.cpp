@@ -0,0 +1,260 @@
+// FriendlyFireClassifier: ray / capsule distances against a marched reference, the spread pattern's
+// coverage, and Classify (cone cull, world occlusion, pellets) against an unculled brute force.
+#include "friendly_fire_classifier.h"
+#include "test_common.h"
+
+#include <random>
+
+namespace
+{
+	using Vec = FriendlyFireVec3;
+
+	float PointSegmentDistance(const Vec& p, const Vec& a, const Vec& b)
+	{
+		const Vec ab = b - a;
+		const float len2 = ab.Dot(ab);
+		const float t = len2 > 0.0f ? std::clamp((p - a).Dot(ab) / len2, 0.0f, 1.0f) : 0.0f;
+		return (p - (a + ab * t)).Length();
+	}
+
+	// First distance along the ray inside the capsule: march in small steps, then bisect.
+	float MarchRayCapsule(const Vec& origin, const Vec& dir, const FriendlyFireCapsule& c, float maxDistance)
+	{
+		auto inside = [&](float t) { return PointSegmentDistance(origin + dir * t, c.a, c.b) <= c.radius; };
+		if (inside(0.0f))
+			return 0.0f;
+		constexpr float kStep = 0.25f;
+		for (float t = kStep; t <= maxDistance; t += kStep)
+		{
+			if (!inside(t))
+				continue;
+			float lo = t - kStep, hi = t;
+			for (int i = 0; i < 30; ++i)
+			{
+				const float mid = 0.5f * (lo + hi);
+				(inside(mid) ? hi : lo) = mid;
+			}
+			return hi;
+		}
+		return -1.0f;
+	}
+
+	Vec RandomUnit(std::mt19937& rng)
+	{
+		std::normal_distribution<float> n(0.0f, 1.0f);
+		Vec v{ n(rng), n(rng), n(rng) };
+		return v * (1.0f / v.Length());
+	}
+
+	// A standing survivor at (x, y) on the floor: feet to head, as the census builds them.
+	FriendlyFireCapsule Survivor(float x, float y, int index)
+	{
+		FriendlyFireCapsule c;
+		c.a = { x, y, 16.0f };
+		c.b = { x, y, 56.0f };
+		c.radius = 16.0f;
+		c.index = index;
+		return c;
+	}
+
+	// Per-sample test of every capsule, no cull: what Classify must agree with.
+	float BruteForceFraction(const Vec& origin, const Vec& forward, float worldDistance, const FriendlyFirePattern& pattern,
+		const std::vector<FriendlyFireCapsule>& capsules)
+	{
+		Vec right, up;
+		FriendlyFireClassifier::Basis(forward, right, up);
+		int hits = 0;
+		for (int s = 0; s < pattern.GetCount(); ++s)
+		{
+			const Vec dir = pattern.Direction(s, forward, right, up);
+			for (const FriendlyFireCapsule& c : capsules)
+			{
+				const float t = FriendlyFireClassifier::RayCapsule(origin, dir, c);
+				if (t >= 0.0f && t <= worldDistance)
+				{
+					++hits;
+					break;
+				}
+			}
+		}
+		return static_cast<float>(hits) / static_cast<float>(pattern.GetCount());
+	}
+}
+
+VR_TEST(RayCapsuleMatchesMarchedReference)
+{
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> coord(-60.0f, 60.0f);
+	std::uniform_real_distribution<float> radius(2.0f, 20.0f);
+	int hits = 0, misses = 0;
+	for (int i = 0; i < 2000; ++i)
+	{
+		FriendlyFireCapsule c;
+		c.a = { coord(rng), coord(rng), coord(rng) };
+		c.b = (i % 10 == 0) ? c.a : c.a + RandomUnit(rng) * (radius(rng) * 3.0f);   // some degenerate (spheres)
+		c.radius = radius(rng);
+
+		// Aim roughly at the capsule so most rays hit, some graze, some miss.
+		const Vec origin{ coord(rng) * 3.0f, coord(rng) * 3.0f, coord(rng) * 3.0f };
+		const Vec target = (c.a + c.b) * 0.5f + RandomUnit(rng) * (c.radius * 1.5f);
+		Vec dir = target - origin;
+		dir = dir * (1.0f / dir.Length());
+
+		const float analytic = FriendlyFireClassifier::RayCapsule(origin, dir, c);
+		const float marched = MarchRayCapsule(origin, dir, c, 800.0f);
+		if (marched < 0.0f)
+		{
+			// A grazing ray the 0.25 u march steps over can still legitimately hit.
+			if (analytic >= 0.0f)
+			{
+				const Vec p = origin + dir * analytic;
+				VR_CHECK_NEAR(PointSegmentDistance(p, c.a, c.b), c.radius, 1e-2);
+			}
+			++misses;
+			continue;
+		}
+		++hits;
+		VR_CHECK(analytic >= 0.0f);
+		VR_CHECK_NEAR(analytic, marched, 0.05);
+	}
+	VR_CHECK(hits > 1000 && misses > 50);
+}
+
+VR_TEST(RayCapsuleEdgeCases)
+{
+	const FriendlyFireCapsule c = Survivor(100.0f, 0.0f, 1);
+
+	// Starting inside (muzzle pressed into a teammate) hits at 0.
+	VR_CHECK(FriendlyFireClassifier::RayCapsule({ 100.0f, 0.0f, 30.0f }, { 1.0f, 0.0f, 0.0f }, c) == 0.0f);
+	// Pointing away misses.
+	VR_CHECK(FriendlyFireClassifier::RayCapsule({ 0.0f, 0.0f, 30.0f }, { -1.0f, 0.0f, 0.0f }, c) < 0.0f);
+	// Side hit on the cylinder.
+	VR_CHECK_NEAR(FriendlyFireClassifier::RayCapsule({ 0.0f, 0.0f, 30.0f }, { 1.0f, 0.0f, 0.0f }, c), 84.0, 1e-3);
+	// Straight down the axis from above hits the head cap.
+	VR_CHECK_NEAR(FriendlyFireClassifier::RayCapsule({ 100.0f, 0.0f, 200.0f }, { 0.0f, 0.0f, -1.0f }, c), 128.0, 1e-3);
+	// Over the head, past the cap.
+	VR_CHECK(FriendlyFireClassifier::RayCapsule({ 0.0f, 0.0f, 73.0f }, { 1.0f, 0.0f, 0.0f }, c) < 0.0f);
+	// Parallel to the axis, just outside the radius.
+	VR_CHECK(FriendlyFireClassifier::RayCapsule({ 116.5f, 0.0f, 200.0f }, { 0.0f, 0.0f, -1.0f }, c) < 0.0f);
+}
+
+VR_TEST(PatternIsAreaUniformAndInsideTheCone)
+{
+	FriendlyFirePattern pattern;
+	pattern.Build(256);
+	VR_CHECK(pattern.GetCount() == 256);
+	pattern.SetSpread(6.0f, 6.0f);
+
+	const Vec forward{ 1.0f, 0.0f, 0.0f };
+	Vec right, up;
+	FriendlyFireClassifier::Basis(forward, right, up);
+	VR_CHECK_NEAR(right.Dot(forward), 0.0, 1e-6);
+	VR_CHECK_NEAR(up.z, 1.0, 1e-6);
+
+	const float tanHalf = std::tan(6.0f * 3.14159265f / 180.0f);
+	int innerHalf = 0;
+	float widest = 0.0f;
+	for (int i = 0; i < pattern.GetCount(); ++i)
+	{
+		const Vec d = pattern.Direction(i, forward, right, up);
+		VR_CHECK_NEAR(d.Length(), 1.0, 1e-5);
+		const float tanOff = std::sqrt(d.y * d.y + d.z * d.z) / d.x;
+		widest = std::max(widest, tanOff);
+		if (tanOff <= 0.5f * tanHalf + 1e-6f)
+			++innerHalf;
+	}
+	// Area-uniform: the inner half radius holds a quarter of the samples; the rim reaches the spread.
+	VR_CHECK_NEAR(innerHalf / 256.0, 0.25, 0.02);
+	VR_CHECK_NEAR(widest, tanHalf, 1e-4);
+
+	// Clamped spread and sample counts.
+	pattern.Build(0);
+	VR_CHECK(pattern.GetCount() == 1);
+	pattern.Build(10000);
+	VR_CHECK(pattern.GetCount() == 256);
+	pattern.SetSpread(90.0f, -5.0f);
+	VR_CHECK_NEAR(pattern.GetMaxTan(), 1.0, 1e-5);
+}
+
+VR_TEST(TeammateBesideTheCrosshair)
+{
+	// The center ray passes just beside a survivor 300 u ahead: the old center-ray guard let it
+	// through, the spread cone of a shotgun doesn't.
+	FriendlyFirePattern pattern;
+	pattern.Build(64);
+	const std::vector<FriendlyFireCapsule> team = { Survivor(300.0f, 20.0f, 4) };
+	const Vec origin{ 0.0f, 0.0f, 40.0f };
+	const Vec forward{ 1.0f, 0.0f, 0.0f };
+
+	pattern.SetSpread(0.0f, 0.0f);
+	FriendlyFireResult r = FriendlyFireClassifier::Classify(origin, forward, 4096.0f, pattern, 1, team.data(), 1);
+	VR_CHECK(r.sampleHitFraction == 0.0f && r.nearestIndex == -1);
+
+	pattern.SetSpread(3.0f, 5.0f);
+	r = FriendlyFireClassifier::Classify(origin, forward, 4096.0f, pattern, 1, team.data(), 1);
+	VR_CHECK(r.sampleHitFraction > 0.0f && r.sampleHitFraction < 0.5f);
+	VR_CHECK(r.nearestIndex == 4);
+	VR_CHECK(r.nearestDistance > 280.0f && r.nearestDistance < 300.0f);
+
+	// Ten pellets: the chance any of them hits compounds.
+	const FriendlyFireResult pellets = FriendlyFireClassifier::Classify(origin, forward, 4096.0f, pattern, 10, team.data(), 1);
+	VR_CHECK_NEAR(pellets.shotHitChance, 1.0 - std::pow(1.0 - r.sampleHitFraction, 10.0), 1e-5);
+	VR_CHECK(pellets.shotHitChance > r.shotHitChance);
+
+	// A wall at 200 u blocks the whole cone.
+	r = FriendlyFireClassifier::Classify(origin, forward, 200.0f, pattern, 10, team.data(), 1);
+	VR_CHECK(r.sampleHitFraction == 0.0f && r.shotHitChance == 0.0f);
+}
+
+VR_TEST(ConeCullNeverChangesTheAnswer)
+{
+	// Random squads around a random aim: Classify (with the cone cull) against every capsule tested
+	// for every sample.
+	std::mt19937 rng(17);
+	std::uniform_real_distribution<float> pos(-600.0f, 600.0f);
+	std::uniform_real_distribution<float> spread(0.0f, 12.0f);
+	std::uniform_real_distribution<float> wall(50.0f, 1500.0f);
+	FriendlyFirePattern pattern;
+	pattern.Build(48);
+	int culled = 0, scenesWithHits = 0;
+	for (int scene = 0; scene < 400; ++scene)
+	{
+		std::vector<FriendlyFireCapsule> team;
+		for (int i = 0; i < 3; ++i)
+			team.push_back(Survivor(pos(rng), pos(rng), i + 1));
+		const Vec origin{ pos(rng) * 0.2f, pos(rng) * 0.2f, 40.0f + pos(rng) * 0.02f };
+		// Aim near one of them half the time.
+		Vec forward = (scene % 2 == 0) ? (team[0].a + team[0].b) * 0.5f - origin + RandomUnit(rng) * 40.0f : RandomUnit(rng);
+		forward = forward * (1.0f / forward.Length());
+		pattern.SetSpread(spread(rng), spread(rng));
+		const float worldDistance = wall(rng);
+
+		const FriendlyFireResult r = FriendlyFireClassifier::Classify(origin, forward, worldDistance, pattern, 1, team.data(), int(team.size()));
+		const float expected = BruteForceFraction(origin, forward, worldDistance, pattern, team);
+		VR_CHECK_NEAR(r.sampleHitFraction, expected, 1e-6);
+		culled += 3 - r.capsulesTested;
+		scenesWithHits += expected > 0.0f ? 1 : 0;
+	}
+	std::printf("  %d of 1200 capsules culled, %d of 400 scenes with a hit\n", culled, scenesWithHits);
+	VR_CHECK(culled > 600);
+	VR_CHECK(scenesWithHits > 50);
+}
+
+VR_TEST(NoCensusNoWork)
+{
+	FriendlyFirePattern pattern;
+	pattern.Build(16);
+	pattern.SetSpread(2.0f, 2.0f);
+	const FriendlyFireCapsule c = Survivor(100.0f, 0.0f, 1);
+	FriendlyFireResult r = FriendlyFireClassifier::Classify({ 0.0f, 0.0f, 40.0f }, { 1.0f, 0.0f, 0.0f }, 4096.0f, pattern, 1, nullptr, 0);
+	VR_CHECK(r.capsulesTested == 0 && r.nearestIndex == -1);
+	r = FriendlyFireClassifier::Classify({ 0.0f, 0.0f, 40.0f }, { 1.0f, 0.0f, 0.0f }, 0.0f, pattern, 1, &c, 1);
+	VR_CHECK(r.capsulesTested == 0);
+	r = FriendlyFireClassifier::Classify({ 0.0f, 0.0f, 40.0f }, { 1.0f, 0.0f, 0.0f }, std::nanf(""), pattern, 1, &c, 1);
+	VR_CHECK(r.capsulesTested == 0);
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
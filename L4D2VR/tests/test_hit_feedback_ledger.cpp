@@ -0,0 +1,248 @@
+// HitFeedbackLedger: predicted vs late feedback, misprediction audit, the measured window, kill
+// crediting, and event matching against a linear-scan reference under ring wrap and index churn.
+#include "hit_feedback_ledger.h"
+#include "test_common.h"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+	const float kImpact[3] = { 1.0f, 2.0f, 3.0f };
+
+	struct RefShot
+	{
+		uint32_t serial = 0;
+		double firedAt = 0.0;
+		std::uintptr_t tag = 0;
+	};
+
+	// What ConfirmHit must pick, by scanning every shot still in the ring: the newest shot on the tag
+	// if it is inside the max window, otherwise the newest shot with an impact inside the window.
+	uint32_t ReferenceMatch(const std::vector<RefShot>& shots, std::uintptr_t tag, double now, float window, float maxWindow)
+	{
+		const size_t first = shots.size() > size_t(HitFeedbackLedger::kCapacity) ? shots.size() - HitFeedbackLedger::kCapacity : 0;
+		for (size_t i = shots.size(); i-- > first;)
+		{
+			if (shots[i].tag != tag || tag == 0)
+				continue;
+			if (now - shots[i].firedAt <= maxWindow)
+				return shots[i].serial;
+			break;
+		}
+		for (size_t i = shots.size(); i-- > first;)
+		{
+			if (now - shots[i].firedAt > window)
+				break;
+			if (shots[i].tag != 0)
+				return shots[i].serial;
+		}
+		return 0;
+	}
+}
+
+VR_TEST(ConfidentShotsPlayAtOnceTheRestWaitForTheServer)
+{
+	HitFeedbackLedger ledger;
+	ledger.SetConfidenceThreshold(0.6f);
+
+	const uint32_t a = ledger.BeginShot(10.0);
+	VR_CHECK(ledger.RecordImpact(a, 100, kImpact, 30.0f, false, 0.9f));
+	// A second trace of the same shot (pellets) doesn't play again.
+	VR_CHECK(!ledger.RecordImpact(a, 100, kImpact, 30.0f, false, 0.9f));
+
+	bool late = true;
+	const HitLedgerShot* s = ledger.ConfirmHit(100, 10.05, late);
+	VR_CHECK(s && s->serial == a && !late);
+
+	const uint32_t b = ledger.BeginShot(11.0);
+	VR_CHECK(!ledger.RecordImpact(b, 200, kImpact, 10.0f, false, 0.3f));
+	s = ledger.ConfirmHit(200, 11.06, late);
+	VR_CHECK(s && s->serial == b && late);
+	// A second hurt event for the same shot (DoT, pellets) doesn't play again.
+	s = ledger.ConfirmHit(200, 11.07, late);
+	VR_CHECK(s && s->serial == b && !late);
+
+	const HitFeedbackLedger::Counters& c = ledger.GetCounters();
+	VR_CHECK(c.shots == 2 && c.predicted == 1 && c.late == 1 && c.confirmed == 2);
+
+	// No tag on the shot (a miss) or no shot at all.
+	VR_CHECK(!ledger.RecordImpact(b, 0, kImpact, 1.0f, false, 1.0f));
+	VR_CHECK(!ledger.RecordImpact(12345, 7, kImpact, 1.0f, false, 1.0f));
+}
+
+VR_TEST(UnconfirmedPredictionsAreCountedOnce)
+{
+	HitFeedbackLedger ledger;
+	ledger.SetWindowBounds(0.1f, 0.5f);
+	const uint32_t a = ledger.BeginShot(0.0);
+	VR_CHECK(ledger.RecordImpact(a, 5, kImpact, 30.0f, false, 1.0f));   // played, server never agrees
+	const uint32_t b = ledger.BeginShot(0.1);
+	ledger.RecordImpact(b, 6, kImpact, 30.0f, false, 1.0f);
+	bool late = false;
+	ledger.ConfirmHit(6, 0.15, late);                                     // confirmed
+	const uint32_t c = ledger.BeginShot(0.2);
+	ledger.RecordImpact(c, 7, kImpact, 30.0f, true, 1.0f);
+	VR_CHECK(ledger.ConsumeKill(7, 0.3, [](const HitLedgerShot&) { return true; }));   // credited a kill
+
+	ledger.Expire(0.4);
+	VR_CHECK(ledger.GetCounters().mispredicted == 0);
+	ledger.Expire(2.0);
+	VR_CHECK(ledger.GetCounters().mispredicted == 1);
+
+	// The ring overwriting an audited slot doesn't count it again.
+	for (int i = 0; i < HitFeedbackLedger::kCapacity * 2; ++i)
+		ledger.BeginShot(3.0 + i);
+	VR_CHECK(ledger.GetCounters().mispredicted == 1);
+
+	// Overwriting a slot that wasn't expired yet audits it on the way out.
+	HitFeedbackLedger fast;
+	const uint32_t first = fast.BeginShot(0.0);
+	fast.RecordImpact(first, 9, kImpact, 30.0f, false, 1.0f);
+	for (int i = 0; i < HitFeedbackLedger::kCapacity; ++i)
+		fast.BeginShot(0.001 * i);
+	VR_CHECK(fast.Find(first) == nullptr);
+	VR_CHECK(fast.GetCounters().mispredicted == 1);
+}
+
+VR_TEST(WindowFollowsTheMeasuredDelay)
+{
+	HitFeedbackLedger ledger;
+	ledger.SetWindowBounds(0.1f, 0.75f);
+	VR_CHECK_NEAR(ledger.GetWindowSeconds(), 0.75, 1e-6);   // nothing measured yet
+
+	// A listen-server-like delay: 40 ms +- 5 ms.
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<double> jitter(-0.005, 0.005);
+	double t = 0.0;
+	for (int i = 0; i < 200; ++i, t += 0.5)
+	{
+		const uint32_t s = ledger.BeginShot(t);
+		ledger.RecordImpact(s, 1000 + i, kImpact, 10.0f, false, 1.0f);
+		bool late = false;
+		ledger.ConfirmHit(1000 + i, t + 0.04 + jitter(rng), late);
+	}
+	std::printf("  40 ms delay: smoothed %.1f ms, window %.1f ms\n", ledger.GetSmoothedDelaySeconds() * 1e3, ledger.GetWindowSeconds() * 1e3);
+	VR_CHECK_NEAR(ledger.GetSmoothedDelaySeconds(), 0.04, 0.004);
+	VR_CHECK(ledger.GetWindowSeconds() >= 0.1f && ledger.GetWindowSeconds() < 0.12f);
+
+	// The server slows down: its events land outside the tight window but still name their shot, so
+	// the window grows with them (up to the max) instead of shutting them out.
+	for (int i = 0; i < 200; ++i, t += 0.5)
+	{
+		const uint32_t s = ledger.BeginShot(t);
+		ledger.RecordImpact(s, 5000 + i, kImpact, 10.0f, false, 1.0f);
+		bool late = false;
+		ledger.ConfirmHit(5000 + i, t + 0.25 + jitter(rng) * 10.0, late);
+	}
+	std::printf("  250 ms delay: smoothed %.1f ms, window %.1f ms\n", ledger.GetSmoothedDelaySeconds() * 1e3, ledger.GetWindowSeconds() * 1e3);
+	VR_CHECK(ledger.GetWindowSeconds() > 0.3f && ledger.GetWindowSeconds() <= 0.75f);
+
+	// An event after the max window doesn't match the old shot; an untagged one only inside the
+	// measured window.
+	const uint32_t s = ledger.BeginShot(t);
+	ledger.RecordImpact(s, 42, kImpact, 10.0f, false, 1.0f);
+	bool late = false;
+	VR_CHECK(ledger.ConfirmHit(42, t + 1.0, late) == nullptr);
+	VR_CHECK(ledger.ConfirmHit(0, t + ledger.GetWindowSeconds() + 0.01, late) == nullptr);
+	VR_CHECK(ledger.ConfirmHit(0, t + ledger.GetWindowSeconds() - 0.01, late) != nullptr);
+}
+
+VR_TEST(KillsAreCreditedOnce)
+{
+	HitFeedbackLedger ledger;
+	const uint32_t a = ledger.BeginShot(1.0);
+	ledger.RecordImpact(a, 11, kImpact, 50.0f, true, 1.0f);
+	const uint32_t b = ledger.BeginShot(1.1);
+	ledger.RecordImpact(b, 12, kImpact, 5.0f, false, 1.0f);
+
+	auto any = [](const HitLedgerShot&) { return true; };
+	auto lethal = [](const HitLedgerShot& s) { return s.predictedLethal; };
+
+	VR_CHECK(ledger.HasKillCandidate(11, 1.2));
+	const HitLedgerShot* k = ledger.ConsumeKill(11, 1.2, any);
+	VR_CHECK(k && k->serial == a);
+	VR_CHECK(!ledger.HasKillCandidate(11, 1.2));
+	VR_CHECK(ledger.ConsumeKill(11, 1.2, any) == nullptr);
+
+	// Untagged kill: the preferred shot, else the newest.
+	const uint32_t c = ledger.BeginShot(1.3);
+	ledger.RecordImpact(c, 13, kImpact, 80.0f, true, 1.0f);
+	k = ledger.ConsumeKill(0, 1.35, lethal);
+	VR_CHECK(k && k->serial == c);
+	k = ledger.ConsumeKill(0, 1.35, lethal);
+	VR_CHECK(k && k->serial == b);
+	VR_CHECK(ledger.ConsumeKill(0, 1.35, any) == nullptr);
+	VR_CHECK(ledger.GetCounters().kills == 3);
+	VR_CHECK(!ledger.HasKillCandidate(0, 10.0));
+}
+
+VR_TEST(EventMatchingAgreesWithALinearScan)
+{
+	// A long firefight: fast fire, a horde of tags (so the tag index fills, goes stale and is
+	// rebuilt many times over), hurt events for random recent tags, some for unknown tags.
+	std::mt19937 rng(23);
+	std::uniform_real_distribution<double> gap(0.01, 0.12);
+	std::uniform_int_distribution<int> tagPick(1, 400);
+	std::uniform_int_distribution<int> roll(0, 99);
+
+	HitFeedbackLedger ledger;
+	ledger.SetWindowBounds(0.1f, 0.75f);
+	std::vector<RefShot> ref;
+	double now = 0.0;
+	int events = 0, matched = 0, mismatches = 0;
+	for (int i = 0; i < 20000; ++i)
+	{
+		now += gap(rng);
+		RefShot shot;
+		shot.serial = ledger.BeginShot(now);
+		shot.firedAt = now;
+		if (roll(rng) < 80)
+		{
+			shot.tag = static_cast<std::uintptr_t>(tagPick(rng)) * 16;
+			ledger.RecordImpact(shot.serial, shot.tag, kImpact, 20.0f, false, roll(rng) / 100.0f);
+		}
+		ref.push_back(shot);
+
+		for (int e = roll(rng) % 3; e > 0; --e)
+		{
+			const double at = now + gap(rng) * 0.5;
+			std::uintptr_t tag = 0;
+			const int kind = roll(rng);
+			if (kind < 70 && ref.size() > 1)
+				tag = ref[ref.size() - 1 - size_t(roll(rng)) % std::min<size_t>(ref.size(), 80)].tag;
+			else if (kind < 90)
+				tag = static_cast<std::uintptr_t>(tagPick(rng)) * 16 + 8;   // never shot
+			const float window = ledger.GetWindowSeconds();
+			const uint32_t expected = ReferenceMatch(ref, tag, at, window, ledger.GetMaxWindowSeconds());
+			bool late = false;
+			const HitLedgerShot* got = ledger.ConfirmHit(tag, at, late);
+			++events;
+			matched += got ? 1 : 0;
+			if ((got ? got->serial : 0u) != expected)
+				++mismatches;
+		}
+		if (i % 16 == 0)
+			ledger.Expire(now);
+	}
+	std::printf("  %d hurt events, %d matched a shot, %d disagreed with the scan\n", events, matched, mismatches);
+	VR_CHECK(mismatches == 0);
+	VR_CHECK(matched > events / 2);
+}
+
+VR_TEST(ResetForgetsEverything)
+{
+	HitFeedbackLedger ledger;
+	const uint32_t a = ledger.BeginShot(1.0);
+	ledger.RecordImpact(a, 3, kImpact, 1.0f, false, 1.0f);
+	ledger.Reset();
+	VR_CHECK(ledger.GetLastSerial() == 0 && ledger.Find(a) == nullptr);
+	bool late = false;
+	VR_CHECK(ledger.ConfirmHit(3, 1.01, late) == nullptr);
+	VR_CHECK(ledger.BeginShot(2.0) == 1);
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
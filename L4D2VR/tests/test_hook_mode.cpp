@@ -0,0 +1,62 @@
+// Hook groups per frame state, and the packed state round trip.
+#include "hook_mode.h"
+#include "test_common.h"
+
+namespace
+{
+	HookFrameState State(bool vr, bool inGame, int queueMode, bool block, bool trace)
+	{
+		HookModeInputs in;
+		in.vrEnabled = vr;
+		in.inGame = inGame;
+		in.matQueueMode = queueMode;
+		in.blockConVarWrites = block;
+		in.traceConVarWrites = trace;
+		return ComputeHookFrameState(in);
+	}
+}
+
+VR_TEST(ConVarWriteHookFollowsItsUsers)
+{
+	// Nothing blocked or traced: the write hook is only needed in a map, for mat_queue_mode writes.
+	VR_CHECK((RequiredHookGroups(State(false, false, 0, false, false)) & kHookGroupConVarWrite) == 0);
+	VR_CHECK((RequiredHookGroups(State(true, false, 2, false, false)) & kHookGroupConVarWrite) == 0);
+	VR_CHECK((RequiredHookGroups(State(true, true, 0, false, false)) & kHookGroupConVarWrite) != 0);
+	VR_CHECK((RequiredHookGroups(State(true, true, 2, false, false)) & kHookGroupConVarWrite) != 0);
+
+	// Blocking or tracing needs it everywhere; only tracing needs the trace group.
+	VR_CHECK((RequiredHookGroups(State(false, false, 0, true, false)) & kHookGroupConVarWrite) != 0);
+	VR_CHECK((RequiredHookGroups(State(false, false, 0, true, false)) & kHookGroupConVarTrace) == 0);
+	VR_CHECK((RequiredHookGroups(State(false, false, 0, false, true)) & kHookGroupConVarTrace) != 0);
+
+	VR_CHECK((RequiredHookGroups(State(false, true, 0, false, false)) & kHookGroupVRRender) == 0);
+	VR_CHECK((RequiredHookGroups(State(true, false, 0, false, false)) & kHookGroupVRRender) != 0);
+}
+
+VR_TEST(QueueModeTransitionsKeepTheRestOfTheState)
+{
+	HookModeState state;
+	HookFrameState in = State(true, true, 0, false, true);
+	in.thirdPerson = true;
+	in.mode = ComputeHookMode(true, true, true, 0);
+	state.Publish(in);
+	VR_CHECK(state.Load().mode == HookMode::InGame3P);
+
+	state.PublishQueueMode(2);
+	HookFrameState out = state.Load();
+	VR_CHECK(out.mode == HookMode::Queued && out.queueMode == 2);
+	VR_CHECK(out.thirdPerson && out.traceConVarWrites && !out.blockConVarWrites);
+
+	state.PublishQueueMode(0);
+	VR_CHECK(state.Load().mode == HookMode::InGame3P);
+
+	// In the menu a queue mode change doesn't make the frame Queued.
+	state.Publish(State(true, false, 0, false, false));
+	state.PublishQueueMode(1);
+	VR_CHECK(state.Load().mode == HookMode::Menu && state.Load().queueMode == 1);
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
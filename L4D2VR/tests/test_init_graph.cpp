@@ -0,0 +1,271 @@
+// InitGraph executor on std::thread: dependency order, failure / skip propagation, the thread bound,
+// overlap of independent stages, and random graphs checked against a serial evaluation.
+#include "init_graph.h"
+#include "test_common.h"
+
+#include <atomic>
+#include <random>
+#include <stdexcept>
+
+namespace
+{
+	void SleepMs(int ms)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+	}
+
+	// Start / finish order of every stage, on a global sequence counter.
+	struct Trace
+	{
+		std::atomic<int> clock{ 0 };
+		std::vector<int> started;
+		std::vector<int> finished;
+
+		explicit Trace(size_t stages) : started(stages, -1), finished(stages, -1) {}
+
+		InitGraph::StageFn Stage(int id, bool result, int sleepMs = 0)
+		{
+			return [this, id, result, sleepMs]()
+				{
+					started[static_cast<size_t>(id)] = clock.fetch_add(1);
+					if (sleepMs > 0)
+						SleepMs(sleepMs);
+					finished[static_cast<size_t>(id)] = clock.fetch_add(1);
+					return result;
+				};
+		}
+	};
+}
+
+VR_TEST(DependenciesRunFirst)
+{
+	Trace trace(6);
+	InitGraph graph;
+	const int modules = graph.Add("modules", trace.Stage(0, true, 5));
+	const int interfaces = graph.Add("interfaces", trace.Stage(1, true), { modules });
+	const int scans = graph.Add("scans", trace.Stage(2, true, 10), { modules });
+	const int config = graph.Add("config", trace.Stage(3, true));
+	const int device = graph.Add("device", trace.Stage(4, true, 10), { interfaces });
+	const int hooks = graph.Add("hooks", trace.Stage(5, true), { scans, device }, { config });
+	VR_CHECK(hooks == 5);
+
+	VR_CHECK(graph.Run(4));
+	const std::pair<int, int> edges[] = { { modules, interfaces }, { modules, scans }, { interfaces, device },
+		{ scans, hooks }, { device, hooks }, { config, hooks } };
+	for (const auto& e : edges)
+		VR_CHECK(trace.finished[e.first] < trace.started[e.second]);
+
+	// Timings come back in the order stages were added, with starts after their dependencies.
+	const std::vector<InitGraph::StageTiming> timings = graph.GetTimings();
+	VR_CHECK(timings.size() == 6 && timings[5].name == "hooks");
+	VR_CHECK(timings[5].startMs >= timings[2].startMs + timings[2].durationMs - 0.5);
+	VR_CHECK(graph.GetTotalMs() >= timings[5].startMs);
+}
+
+VR_TEST(FailuresSkipWhatNeedsThem)
+{
+	Trace trace(6);
+	InitGraph graph;
+	const int a = graph.Add("openvr", trace.Stage(0, false));
+	const int b = graph.Add("needs a", trace.Stage(1, true), { a });
+	const int c = graph.Add("needs b", trace.Stage(2, true), { b });
+	const int d = graph.Add("after a", trace.Stage(3, true), {}, { a });
+	const int e = graph.Add("throws", []() -> bool { throw std::runtime_error("scan"); });
+	const int f = graph.Add("after e", trace.Stage(5, true), {}, { e });
+
+	VR_CHECK(!graph.Run(3));
+	VR_CHECK(graph.GetState(a) == InitGraph::StageState::Failed);
+	VR_CHECK(graph.GetState(b) == InitGraph::StageState::Skipped && trace.started[1] < 0);
+	VR_CHECK(graph.GetState(c) == InitGraph::StageState::Skipped && trace.started[2] < 0);
+	VR_CHECK(graph.Succeeded(d));
+	VR_CHECK(graph.GetState(e) == InitGraph::StageState::Failed);
+	VR_CHECK(graph.Succeeded(f));
+	VR_CHECK(graph.GetState(99) == InitGraph::StageState::Skipped);
+	VR_CHECK(std::string(InitGraph::StateName(graph.GetState(c))) == "skipped");
+}
+
+// The shape of Game's startup graph: the D3D wait needs the VR runtime, so when OpenVR fails the
+// hooks go in without waiting for a device that only VR needs.
+VR_TEST(FailedRuntimeSkipsTheDeviceWait)
+{
+	for (bool runtimeUp : { false, true })
+	{
+		std::atomic<bool> deviceReady{ false };
+		std::atomic<bool> waited{ false };
+		InitGraph graph;
+		const int modules = graph.Add("modules", []() { return true; });
+		const int offsets = graph.Add("offsets", []() { SleepMs(2); return true; }, { modules });
+		const int runtime = graph.Add("vr-runtime", [runtimeUp]() { return runtimeUp; });
+		const int d3d = graph.Add("d3d-device", [&]()
+			{
+				waited = true;
+				while (!deviceReady)
+					SleepMs(1);
+				return true;
+			}, { runtime });
+		const int vrDevice = graph.Add("vr-device", []() { return true; }, { runtime, d3d });
+		const int hooks = graph.Add("hooks", []() { return true; }, { offsets }, { vrDevice });
+
+		// The game creates its device a while after startup begins.
+		std::thread game([&]()
+			{
+				SleepMs(60);
+				deviceReady = true;
+			});
+		VR_CHECK(graph.Run(4) == runtimeUp);
+		game.join();
+
+		const std::vector<InitGraph::StageTiming> timings = graph.GetTimings();
+		const InitGraph::StageTiming& d3dTiming = timings[static_cast<size_t>(d3d)];
+		const double hooksStart = timings[static_cast<size_t>(hooks)].startMs;
+		VR_CHECK(graph.Succeeded(hooks));
+		if (runtimeUp)
+		{
+			VR_CHECK(waited && graph.Succeeded(vrDevice));
+			VR_CHECK(hooksStart >= d3dTiming.startMs + d3dTiming.durationMs - 0.5);
+		}
+		else
+		{
+			VR_CHECK(!waited);
+			VR_CHECK(graph.GetState(d3d) == InitGraph::StageState::Skipped);
+			VR_CHECK(graph.GetState(vrDevice) == InitGraph::StageState::Skipped);
+			VR_CHECK(hooksStart < 50.0);
+		}
+	}
+}
+
+VR_TEST(BadGraphsDontRun)
+{
+	bool ran = false;
+	InitGraph graph;
+	graph.Add("first", [&]() { ran = true; return true; });
+	VR_CHECK(graph.Add("forward ref", []() { return true; }, { 5 }) == -1);
+	VR_CHECK(!graph.Run(2));
+	VR_CHECK(!ran);
+
+	InitGraph once;
+	int runs = 0;
+	once.Add("only", [&]() { ++runs; return true; });
+	VR_CHECK(once.Run(2));
+	VR_CHECK(!once.Run(2));
+	VR_CHECK(runs == 1);
+
+	InitGraph empty;
+	VR_CHECK(empty.Run(4));
+	VR_CHECK(empty.GetTimings().empty());
+
+	// A stage without a function is a no-op that succeeds.
+	InitGraph noop;
+	noop.Add("marker", nullptr);
+	VR_CHECK(noop.Run(1) && noop.Succeeded(0));
+}
+
+VR_TEST(IndependentStagesOverlapWithinTheThreadBound)
+{
+	// The startup shape: the device wait sleeps while the scans and config reads run beside it.
+	std::atomic<int> active{ 0 };
+	std::atomic<int> peak{ 0 };
+	auto work = [&](int ms)
+		{
+			return [&active, &peak, ms]()
+				{
+					const int now = ++active;
+					int seen = peak.load();
+					while (now > seen && !peak.compare_exchange_weak(seen, now))
+					{
+					}
+					SleepMs(ms);
+					--active;
+					return true;
+				};
+		};
+
+	InitGraph graph;
+	const int modules = graph.Add("modules", work(5));
+	graph.Add("device wait", work(80), { modules });
+	for (int i = 0; i < 6; ++i)
+		graph.Add("scan", work(25), { modules });
+	graph.Add("config", work(25));
+
+	VR_CHECK(graph.Run(3));
+	std::printf("  8 stages, 260 ms of work on 3 threads: %.1f ms, peak %d running\n", graph.GetTotalMs(), peak.load());
+	VR_CHECK(peak.load() <= 3);
+	VR_CHECK(peak.load() >= 2);
+	VR_CHECK(graph.GetTotalMs() < 200.0);
+
+	// One thread: the calling thread alone runs everything, in a valid order.
+	InitGraph serial;
+	active = 0;
+	peak = 0;
+	for (int i = 0; i < 4; ++i)
+		serial.Add("s", work(1));
+	VR_CHECK(serial.Run(1));
+	VR_CHECK(peak.load() == 1);
+}
+
+VR_TEST(RandomGraphsMatchASerialEvaluation)
+{
+	// Random DAGs with random failures on 8 threads, against the states a serial walk gives. Run
+	// this binary under -fsanitize=thread to check the executor's locking as well.
+	std::mt19937 rng(41);
+	for (int round = 0; round < 60; ++round)
+	{
+		const int n = 20 + static_cast<int>(rng() % 180);
+		std::vector<std::vector<int>> needs(static_cast<size_t>(n)), after(static_cast<size_t>(n));
+		std::vector<bool> result(static_cast<size_t>(n));
+		Trace trace(static_cast<size_t>(n));
+		InitGraph graph;
+		for (int i = 0; i < n; ++i)
+		{
+			for (int k = static_cast<int>(rng() % 3); k > 0 && i > 0; --k)
+				needs[i].push_back(static_cast<int>(rng() % i));
+			for (int k = static_cast<int>(rng() % 2); k > 0 && i > 0; --k)
+				after[i].push_back(static_cast<int>(rng() % i));
+			result[i] = rng() % 10 != 0;
+			// Add takes initializer_lists, so pass up to two needs and one after explicitly.
+			const auto& nd = needs[i];
+			const auto& af = after[i];
+			InitGraph::StageFn fn = trace.Stage(i, result[i]);
+			int id = -1;
+			if (nd.size() == 0 && af.empty())
+				id = graph.Add("r", fn);
+			else if (nd.size() == 0)
+				id = graph.Add("r", fn, {}, { af[0] });
+			else if (nd.size() == 1)
+				id = af.empty() ? graph.Add("r", fn, { nd[0] }) : graph.Add("r", fn, { nd[0] }, { af[0] });
+			else
+				id = af.empty() ? graph.Add("r", fn, { nd[0], nd[1] }) : graph.Add("r", fn, { nd[0], nd[1] }, { af[0] });
+			VR_CHECK(id == i);
+		}
+
+		graph.Run(8);
+
+		std::vector<InitGraph::StageState> expected(static_cast<size_t>(n));
+		for (int i = 0; i < n; ++i)
+		{
+			bool runnable = true;
+			for (int dep : needs[i])
+				runnable = runnable && expected[dep] == InitGraph::StageState::Succeeded;
+			expected[i] = !runnable ? InitGraph::StageState::Skipped
+				: (result[i] ? InitGraph::StageState::Succeeded : InitGraph::StageState::Failed);
+		}
+		int wrong = 0, orderViolations = 0;
+		for (int i = 0; i < n; ++i)
+		{
+			wrong += graph.GetState(i) != expected[i] ? 1 : 0;
+			if (trace.started[i] < 0)
+				continue;
+			for (int dep : needs[i])
+				orderViolations += trace.finished[dep] > trace.started[i] ? 1 : 0;
+			for (int dep : after[i])
+				orderViolations += (trace.started[dep] >= 0 && trace.finished[dep] > trace.started[i]) ? 1 : 0;
+		}
+		VR_CHECK(wrong == 0);
+		VR_CHECK(orderViolations == 0);
+	}
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
@@ -0,0 +1,342 @@
+// MatQueueModeCache with a scripted clock and engine: the first read, the 1 s validation interval,
+// the 2 s settle window after Invalidate() (a read per Refresh, a notification per actual change
+// only), listener notifications on transitions, and the try_lock that lets a concurrent Refresh()
+// skip instead of waiting.
+#include "mat_queue_mode_cache.h"
+#include "test_common.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	// Stands in for IMaterialSystem::GetThreadMode: the mode it reports, and how often it was asked.
+	struct FakeEngine
+	{
+		int mode = 0;
+		int reads = 0;
+
+		int operator()()
+		{
+			++reads;
+			return mode;
+		}
+	};
+
+	struct Transition
+	{
+		int previous;
+		int current;
+		double time;
+	};
+
+	// A cache with one recording listener, driven like Game::RefreshMatQueueMode at a fixed frame rate.
+	struct Harness
+	{
+		MatQueueModeCache cache;
+		FakeEngine engine;
+		std::vector<Transition> seen;
+		double now = 100.0;
+
+		Harness()
+		{
+			cache.Subscribe([this](int previous, int current) { seen.push_back({ previous, current, now }); });
+		}
+
+		bool Refresh() { return cache.Refresh(now, engine); }
+
+		// Refreshes every frameSeconds until `until`; returns the engine reads made.
+		int RunUntil(double until, double frameSeconds = 1.0 / 90.0)
+		{
+			const int before = engine.reads;
+			while (now + frameSeconds <= until + 1e-9)
+			{
+				now += frameSeconds;
+				Refresh();
+			}
+			return engine.reads - before;
+		}
+	};
+}
+
+VR_TEST(FirstRefreshReadsAndNotifies)
+{
+	Harness h;
+	h.engine.mode = 2;
+	VR_CHECK(!h.cache.IsValid());
+	VR_CHECK(h.cache.Get() == 0);
+
+	VR_CHECK(h.Refresh());
+	VR_CHECK(h.cache.IsValid() && h.cache.Get() == 2);
+	VR_CHECK(h.engine.reads == 1);
+	VR_CHECK(h.seen.size() == 1 && h.seen[0].previous == 0 && h.seen[0].current == 2);
+
+	// An engine that starts in mode 0 is read (the cache becomes valid) but is not a transition.
+	Harness zero;
+	VR_CHECK(!zero.Refresh());
+	VR_CHECK(zero.cache.IsValid() && zero.engine.reads == 1 && zero.seen.empty());
+}
+
+VR_TEST(ValidationReadsOncePerSecond)
+{
+	Harness h;
+	h.engine.mode = 2;
+	h.Refresh();
+
+	// Steady state at 90 Hz: one engine read a second instead of one per call.
+	const int reads = h.RunUntil(h.now + 60.0);
+	VR_CHECK(reads >= 59 && reads <= 61);
+	VR_CHECK(h.cache.GetReadCount() == static_cast<uint64_t>(h.engine.reads));
+
+	// Exactly at the interval boundary.
+	MatQueueModeCache cache;
+	FakeEngine engine;
+	cache.Refresh(10.0, engine);
+	cache.Refresh(10.999, engine);
+	VR_CHECK(engine.reads == 1);
+	cache.Refresh(11.0, engine);
+	VR_CHECK(engine.reads == 2);
+
+	// A write the hooks never saw (no Invalidate): picked up by the next validation, within 1 s.
+	const double changedAt = h.now + 0.3;
+	h.RunUntil(changedAt);
+	h.engine.mode = 0;
+	const size_t before = h.seen.size();
+	h.RunUntil(changedAt + 1.0);
+	VR_CHECK(h.seen.size() == before + 1);
+	VR_CHECK(h.seen.back().previous == 2 && h.seen.back().current == 0);
+	VR_CHECK(h.seen.back().time - changedAt <= 1.0 + 1e-9);
+	VR_CHECK(h.cache.Get() == 0);
+}
+
+VR_TEST(SettleWindowReadsEveryRefreshButNotifiesOnlyOnChange)
+{
+	Harness h;
+	h.engine.mode = 2;
+	h.Refresh();
+	h.RunUntil(h.now + 5.0);
+	h.seen.clear();
+
+	// mat_queue_mode 0 is written; the engine applies it 0.4 s later at a frame boundary.
+	h.cache.Invalidate();
+	const double invalidatedAt = h.now;
+	const int framesIn2s = static_cast<int>(2.0 * 90.0);
+	int reads = 0;
+	bool switched = false;
+	for (int frame = 0; frame < framesIn2s + 90; ++frame)
+	{
+		h.now += 1.0 / 90.0;
+		if (!switched && h.now - invalidatedAt >= 0.4)
+		{
+			h.engine.mode = 0;
+			switched = true;
+		}
+		const int before = h.engine.reads;
+		h.Refresh();
+		reads += h.engine.reads - before;
+	}
+
+	// Every Refresh inside the 2 s window read the engine; the extra second afterwards read once.
+	VR_CHECK(reads >= framesIn2s - 1 && reads <= framesIn2s + 2);
+	// The deferred switch is seen on the first frame it is live, and only once: reading the same
+	// value again on every later frame of the window is not a transition.
+	VR_CHECK(h.seen.size() == 1);
+	VR_CHECK(h.seen[0].previous == 2 && h.seen[0].current == 0);
+	VR_CHECK(h.seen[0].time - invalidatedAt < 0.4 + 1.0 / 90.0 + 1e-9);
+	VR_CHECK(h.cache.GetTransitionCount() == 2);     // the first read (0 -> 2) and this one
+
+	// After the window: back to one read a second.
+	VR_CHECK(h.RunUntil(h.now + 10.0) <= 11);
+}
+
+VR_TEST(SettleWindowStartsAtTheNextRefreshAndRestartsOnInvalidate)
+{
+	MatQueueModeCache cache;
+	FakeEngine engine;
+	cache.Refresh(0.0, engine);
+
+	// Invalidate() has no clock (it runs on whatever thread wrote the ConVar); the window opens at
+	// the next Refresh, however late that is.
+	cache.Invalidate();
+	cache.Refresh(50.0, engine);
+	const int atOpen = engine.reads;
+	cache.Refresh(51.9, engine);
+	VR_CHECK(engine.reads == atOpen + 1);
+	cache.Refresh(52.0, engine);       // window over, and the last read was 0.1 s ago
+	VR_CHECK(engine.reads == atOpen + 1);
+
+	// A second Invalidate inside the window extends it from that point.
+	cache.Invalidate();
+	cache.Refresh(53.0, engine);
+	cache.Invalidate();
+	cache.Refresh(54.5, engine);
+	const int extended = engine.reads;
+	cache.Refresh(56.4, engine);       // 1.9 s after the second open
+	VR_CHECK(engine.reads == extended + 1);
+
+	// Custom windows are honoured.
+	MatQueueModeCache quick;
+	MatQueueModeCacheSettings settings;
+	settings.settleSeconds = 0.5;
+	settings.validateIntervalSeconds = 5.0;
+	quick.Configure(settings);
+	FakeEngine e;
+	quick.Refresh(0.0, e);
+	quick.Invalidate();
+	quick.Refresh(1.0, e);
+	quick.Refresh(1.4, e);
+	quick.Refresh(1.6, e);             // window closed, validation 5 s away
+	quick.Refresh(5.9, e);
+	VR_CHECK(e.reads == 3);
+	quick.Refresh(6.4, e);
+	VR_CHECK(e.reads == 4);
+}
+
+VR_TEST(ListenersHearEveryTransitionInOrder)
+{
+	Harness h;
+	std::vector<std::pair<int, int>> second;
+	const int id = h.cache.Subscribe([&](int previous, int current) { second.push_back({ previous, current }); });
+
+	h.engine.mode = 2;
+	h.Refresh();
+	// A map load flips the mode away and back inside one settle window: both transitions reported.
+	h.cache.Invalidate();
+	h.now += 0.1;
+	h.Refresh();
+	h.engine.mode = 0;
+	h.now += 0.1;
+	VR_CHECK(h.Refresh());
+	h.now += 0.1;
+	VR_CHECK(!h.Refresh());             // same value again: no notification
+	h.engine.mode = 2;
+	h.now += 0.1;
+	VR_CHECK(h.Refresh());
+
+	const std::pair<int, int> expected[] = { { 0, 2 }, { 2, 0 }, { 0, 2 } };
+	VR_CHECK(h.seen.size() == 3 && second.size() == 3);
+	for (size_t i = 0; i < 3 && i < h.seen.size() && i < second.size(); ++i)
+	{
+		VR_CHECK(h.seen[i].previous == expected[i].first && h.seen[i].current == expected[i].second);
+		VR_CHECK(second[i] == expected[i]);
+	}
+
+	// Unsubscribed listeners hear nothing more; the others still do.
+	h.cache.Unsubscribe(id);
+	h.engine.mode = 1;
+	h.now += 0.1;
+	VR_CHECK(h.Refresh());
+	VR_CHECK(second.size() == 3 && h.seen.size() == 4);
+}
+
+VR_TEST(ConcurrentRefreshSkipsInsteadOfWaiting)
+{
+	MatQueueModeCache cache;
+	std::atomic<bool> inRead{ false };
+	std::atomic<bool> release{ false };
+	std::atomic<int> slowReads{ 0 };
+
+	// Thread A is inside the engine read (a slow GetThreadMode during a mode switch).
+	std::thread a([&]()
+		{
+			cache.Refresh(1.0, [&]()
+				{
+					++slowReads;
+					inRead = true;
+					while (!release)
+						std::this_thread::yield();
+					return 2;
+				});
+		});
+	while (!inRead)
+		std::this_thread::yield();
+
+	// Meanwhile thread B's Refresh returns at once without reading. B runs on its own thread so a
+	// Refresh that waited on the lock fails this check instead of deadlocking the test.
+	FakeEngine engine;
+	engine.mode = 1;
+	std::atomic<bool> bDone{ false };
+	bool bRefreshed = true;
+	std::thread b([&]()
+		{
+			bRefreshed = cache.Refresh(1.0, engine);
+			bDone = true;
+		});
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+	while (!bDone && std::chrono::steady_clock::now() < deadline)
+		std::this_thread::yield();
+	VR_CHECK(bDone);
+	// Readers see the old state rather than blocking, and Invalidate never blocks either.
+	VR_CHECK(!cache.IsValid() && cache.Get() == 0);
+	cache.Invalidate();
+
+	release = true;
+	a.join();
+	b.join();
+	VR_CHECK(!bRefreshed);
+	VR_CHECK(engine.reads == 0);
+	VR_CHECK(slowReads == 1);
+	VR_CHECK(cache.IsValid() && cache.Get() == 2);
+
+	// The Invalidate made while A held the lock still opens a window at the next Refresh.
+	VR_CHECK(cache.Refresh(1.1, engine));
+	VR_CHECK(engine.reads == 1 && cache.Get() == 1);
+	cache.Refresh(1.2, engine);
+	VR_CHECK(engine.reads == 2);
+}
+
+VR_TEST(ManyThreadsRefreshingAndReading)
+{
+	// Four threads refresh on a shared clock while the engine toggles; readers never see a mode the
+	// engine didn't report, and every transition reaches the listener exactly once.
+	MatQueueModeCache cache;
+	std::atomic<int> engineMode{ 2 };
+	std::atomic<int64_t> clockMs{ 0 };
+	std::atomic<int> notifications{ 0 };
+	std::atomic<int> badReads{ 0 };
+	cache.Subscribe([&](int previous, int current)
+		{
+			if (previous == current)
+				++badReads;
+			++notifications;
+		});
+
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t)
+	{
+		threads.emplace_back([&, t]()
+			{
+				for (int i = 0; i < 20000; ++i)
+				{
+					const double now = static_cast<double>(clockMs.fetch_add(1)) / 1000.0;
+					if (t == 0 && i % 500 == 0)
+					{
+						engineMode = (engineMode.load() == 2) ? 0 : 2;
+						cache.Invalidate();
+					}
+					cache.Refresh(now, [&]() { return engineMode.load(); });
+					const int seen = cache.Get();
+					if (seen != 0 && seen != 2)
+						++badReads;
+				}
+			});
+	}
+	for (std::thread& t : threads)
+		t.join();
+
+	VR_CHECK(badReads == 0);
+	VR_CHECK(static_cast<uint64_t>(notifications.load()) == cache.GetTransitionCount());
+	VR_CHECK(cache.GetTransitionCount() >= 2);
+	// A final refresh settles on the engine's value.
+	cache.Invalidate();
+	cache.Refresh(static_cast<double>(clockMs.load()) / 1000.0, [&]() { return engineMode.load(); });
+	VR_CHECK(cache.Get() == engineMode.load());
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
@@ -0,0 +1,308 @@
+// MeleeSweep: arc construction and subdivision, the accumulate-or-trace plan across segments, and the
+// broad phase checked against brute force: a dense fan of reach-length rays against each candidate's
+// hull-inflated sphere. A candidate any ray touches must be accepted, with an interval covering the
+// touching angles and a selected sample for each of them.
+#include "melee_sweep.h"
+#include "test_common.h"
+
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+	constexpr float kDeg2Rad = MeleeSweep::kPi / 180.0f;
+
+	MeleeSweepVec3 RandomUnit(std::mt19937& rng)
+	{
+		std::normal_distribution<float> n(0.0f, 1.0f);
+		for (;;)
+		{
+			const MeleeSweepVec3 v{ n(rng), n(rng), n(rng) };
+			if (v.Length() > 1e-3f)
+				return v.Normalized();
+		}
+	}
+
+	float Angle(const MeleeSweepVec3& a, const MeleeSweepVec3& b)
+	{
+		return std::atan2(a.Cross(b).Length(), a.Dot(b));
+	}
+
+	// Distance from p to the segment origin -> origin + dir * length.
+	float SegmentDistance(const MeleeSweepVec3& origin, const MeleeSweepVec3& dir, float length, const MeleeSweepVec3& p)
+	{
+		const float t = std::max(0.0f, std::min(length, (p - origin).Dot(dir)));
+		return (origin + dir * t - p).Length();
+	}
+}
+
+VR_TEST(BuildArcMeasuresTheSweep)
+{
+	std::mt19937 rng(32);
+	for (int i = 0; i < 1000; ++i)
+	{
+		const MeleeSweepVec3 s = RandomUnit(rng);
+		const MeleeSweepVec3 e = RandomUnit(rng);
+		MeleeSweepArc arc;
+		VR_CHECK(MeleeSweep::BuildArc({ 1.0f, 2.0f, 3.0f }, s * 3.0f, e * 0.5f, 70.0f, arc));
+		VR_CHECK_NEAR(arc.sweepRad, Angle(s, e), 1e-4);
+		VR_CHECK_NEAR(arc.axis.Length(), 1.0, 1e-4);
+		VR_CHECK_NEAR(arc.axis.Dot(arc.startDir), 0.0, 1e-4);
+		// Rotating the start by the sweep lands on the end direction.
+		const MeleeSweepVec3 end = MeleeSweep::Rotate(arc.startDir, arc.axis, arc.sweepRad);
+		VR_CHECK_NEAR((end - e).Length(), 0.0, 1e-3);
+	}
+
+	// Parallel directions: zero sweep around some perpendicular axis.
+	MeleeSweepArc still;
+	VR_CHECK(MeleeSweep::BuildArc({}, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 2.0f }, 70.0f, still));
+	VR_CHECK(still.sweepRad == 0.0f);
+	VR_CHECK_NEAR(still.axis.Dot({ 0.0f, 0.0f, 1.0f }), 0.0, 1e-5);
+
+	MeleeSweepArc degenerate;
+	VR_CHECK(!MeleeSweep::BuildArc({}, {}, { 1.0f, 0.0f, 0.0f }, 70.0f, degenerate));
+}
+
+VR_TEST(PlanSizesSamplesByArcLength)
+{
+	MeleeSweepParams params;   // reach 70, spacing 10, 1..16 samples, 2 deg minimum, 4 unit stab
+	for (float deg = 0.0f; deg <= 180.0f; deg += 0.25f)
+	{
+		const MeleeSweepPlan plan = MeleeSweep::PlanSweep(deg * kDeg2Rad, 0.0f, params);
+		if (deg < params.minSweepDeg)
+		{
+			VR_CHECK(plan.skip);
+			continue;
+		}
+		const int expected = std::min(params.maxSamples, std::max(1, (int)std::ceil(params.reach * deg * kDeg2Rad / params.sampleSpacing - 1e-4f)));
+		VR_CHECK(!plan.skip);
+		VR_CHECK(std::abs(plan.samples - expected) <= 1);   // ceil at exact multiples
+		VR_CHECK_NEAR(plan.stepRad * plan.samples, plan.sweepRad, 1e-5);
+		// Unless clamped, neighbouring samples are at most sampleSpacing apart at full reach.
+		if (plan.samples < params.maxSamples)
+			VR_CHECK(params.reach * plan.stepRad <= params.sampleSpacing + 1e-3f);
+	}
+
+	// A stab: barely rotated, but the hand moved. One trace along the final direction.
+	const MeleeSweepPlan stab = MeleeSweep::PlanSweep(0.5f * kDeg2Rad, 6.0f, params);
+	VR_CHECK(!stab.skip);
+	VR_CHECK(stab.samples == 1);
+	VR_CHECK(stab.sweepRad == 0.0f);
+
+	VR_CHECK(MeleeSweep::PlanSweep(std::nanf(""), 0.0f, params).skip);
+	VR_CHECK(MeleeSweep::PlanSweep(1.0f, std::numeric_limits<float>::infinity(), params).skip);
+}
+
+VR_TEST(SamplesSubdivideTheArcUpToTheEnd)
+{
+	std::mt19937 rng(33);
+	MeleeSweepParams params;
+	for (int i = 0; i < 500; ++i)
+	{
+		const MeleeSweepVec3 s = RandomUnit(rng);
+		const MeleeSweepVec3 e = RandomUnit(rng);
+		MeleeSweepArc arc;
+		MeleeSweep::BuildArc({}, s, e, params.reach, arc);
+		const MeleeSweepPlan plan = MeleeSweep::PlanSweep(arc.sweepRad, 0.0f, params);
+		if (plan.skip)
+			continue;
+		MeleeSweepVec3 prev = arc.startDir;
+		for (int k = 0; k < plan.samples; ++k)
+		{
+			const MeleeSweepVec3 dir = MeleeSweep::SampleDirection(arc, plan, k);
+			VR_CHECK_NEAR(dir.Length(), 1.0, 1e-4);
+			VR_CHECK_NEAR(dir.Dot(arc.axis), 0.0, 1e-4);   // stays in the sweep plane
+			VR_CHECK_NEAR(Angle(prev, dir), plan.stepRad, 2e-3);
+			prev = dir;
+		}
+		VR_CHECK_NEAR((prev - e).Length(), 0.0, 2e-3);   // the last sample is the end direction
+	}
+}
+
+VR_TEST(SlowMotionAccumulatesAcrossSegments)
+{
+	// The hook keeps `from` while PlanSweep skips: a 0.55 deg/command wrist roll is traced every fourth
+	// command as one 2.2 deg arc instead of being dropped.
+	MeleeSweepParams params;
+	const MeleeSweepVec3 axis{ 0.0f, 0.0f, 1.0f };
+	const MeleeSweepVec3 start{ 1.0f, 0.0f, 0.0f };
+	MeleeSweepVec3 from = start;
+	int traced = 0;
+	float tracedDeg = 0.0f;
+	constexpr int kCommands = 40;
+	for (int cmd = 1; cmd <= kCommands; ++cmd)
+	{
+		const MeleeSweepVec3 to = MeleeSweep::Rotate(start, axis, cmd * 0.55f * kDeg2Rad);
+		MeleeSweepArc arc;
+		MeleeSweep::BuildArc({}, from, to, params.reach, arc);
+		const MeleeSweepPlan plan = MeleeSweep::PlanSweep(arc.sweepRad, 0.0f, params);
+		if (plan.skip)
+			continue;
+		++traced;
+		tracedDeg += plan.sweepRad / kDeg2Rad;
+		from = to;
+	}
+	VR_CHECK(traced == kCommands / 4);
+	VR_CHECK_NEAR(tracedDeg, kCommands * 0.55f, 1e-2);
+}
+
+VR_TEST(BroadPhaseNeverRejectsWhatARayCanTouch)
+{
+	std::mt19937 rng(34);
+	std::uniform_real_distribution<float> sweepDeg(3.0f, 120.0f);
+	std::uniform_real_distribution<float> offset(-140.0f, 140.0f);
+	std::uniform_real_distribution<float> radius(4.0f, 40.0f);
+	MeleeSweepParams params;
+	constexpr int kRays = 720;
+
+	int accepted = 0;
+	int touched = 0;
+	int rejected = 0;
+	int missedHits = 0;
+	int uncoveredAngles = 0;
+	int unselectedAngles = 0;
+	std::vector<MeleeSweepInterval> intervals(1);
+	std::vector<uint8_t> selected;
+	for (int i = 0; i < 20000; ++i)
+	{
+		const MeleeSweepVec3 s = RandomUnit(rng);
+		MeleeSweepVec3 axis = s.Cross(RandomUnit(rng)).Normalized();
+		const MeleeSweepVec3 origin{ offset(rng), offset(rng), offset(rng) };
+		MeleeSweepArc arc;
+		MeleeSweep::BuildArc(origin, s, MeleeSweep::Rotate(s, axis, sweepDeg(rng) * kDeg2Rad), params.reach, arc);
+		const MeleeSweepPlan plan = MeleeSweep::PlanSweep(arc.sweepRad, 0.0f, params);
+
+		MeleeSweepCandidate c;
+		c.center = origin + MeleeSweepVec3{ offset(rng), offset(rng), offset(rng) } * 0.75f;
+		c.radius = radius(rng);
+		MeleeSweepInterval interval;
+		const bool inArc = MeleeSweep::CandidateInArc(arc, c, params.hullRadius, interval);
+		accepted += inArc ? 1 : 0;
+		rejected += inArc ? 0 : 1;
+		if (inArc)
+		{
+			intervals[0] = interval;
+			MeleeSweep::SelectSamples(plan, intervals, selected);
+		}
+
+		bool anyHit = false;
+		for (int r = 0; r <= kRays; ++r)
+		{
+			const float a = arc.sweepRad * r / kRays;
+			const MeleeSweepVec3 dir = MeleeSweep::Rotate(arc.startDir, arc.axis, a);
+			if (SegmentDistance(origin, dir, arc.reach, c.center) > c.radius + params.hullRadius - 1e-3f)
+				continue;
+			anyHit = true;
+			if (!inArc)
+				continue;
+			if (a < interval.begin - 1e-3f || a > interval.end + 1e-3f)
+				++uncoveredAngles;
+			// The sample whose slice (a - step, a] holds this angle.
+			const int k = std::max(0, std::min(plan.samples - 1, (int)std::ceil(a / plan.stepRad - 1e-4f) - 1));
+			if (!selected[k])
+				++unselectedAngles;
+		}
+		touched += anyHit ? 1 : 0;
+		missedHits += (anyHit && !inArc) ? 1 : 0;
+	}
+	std::printf("  %d candidates touched by a ray, %d accepted, %d rejected\n", touched, accepted, rejected);
+	VR_CHECK(touched > 1000);
+	VR_CHECK(missedHits == 0);
+	VR_CHECK(uncoveredAngles == 0);
+	VR_CHECK(unselectedAngles == 0);
+	// And it does reject: most random spheres are nowhere near the wedge.
+	VR_CHECK(rejected > 10000);
+}
+
+VR_TEST(RejectsOutOfReachAndOffPlane)
+{
+	MeleeSweepArc arc;
+	MeleeSweep::BuildArc({}, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, 70.0f, arc);   // 90 deg in the x/y plane
+	MeleeSweepInterval iv;
+	const float hull = 8.0f;
+
+	// In the middle of the wedge: the interval brackets 45 deg.
+	VR_CHECK(MeleeSweep::CandidateInArc(arc, { { 40.0f, 40.0f, 0.0f }, 10.0f }, hull, iv));
+	VR_CHECK(iv.begin < 45.0f * kDeg2Rad && iv.end > 45.0f * kDeg2Rad);
+	// Beyond reach + radius + hull.
+	VR_CHECK(!MeleeSweep::CandidateInArc(arc, { { 100.0f, 0.0f, 0.0f }, 10.0f }, hull, iv));
+	VR_CHECK(MeleeSweep::CandidateInArc(arc, { { 85.0f, 0.0f, 0.0f }, 10.0f }, hull, iv));
+	// Above the sweep plane by more than radius + hull.
+	VR_CHECK(!MeleeSweep::CandidateInArc(arc, { { 40.0f, 40.0f, 19.0f }, 10.0f }, hull, iv));
+	VR_CHECK(MeleeSweep::CandidateInArc(arc, { { 40.0f, 40.0f, 17.0f }, 10.0f }, hull, iv));
+	// Behind the start / past the end of the wedge.
+	VR_CHECK(!MeleeSweep::CandidateInArc(arc, { { 40.0f, -40.0f, 0.0f }, 10.0f }, hull, iv));
+	VR_CHECK(!MeleeSweep::CandidateInArc(arc, { { -40.0f, 40.0f, 0.0f }, 10.0f }, hull, iv));
+	// Around the hand: every direction can clip it.
+	VR_CHECK(MeleeSweep::CandidateInArc(arc, { { 2.0f, -3.0f, 0.0f }, 10.0f }, hull, iv));
+	VR_CHECK(iv.begin == 0.0f && iv.end == arc.sweepRad);
+}
+
+VR_TEST(SelectSamplesAndWorldProbeDecision)
+{
+	MeleeSweepPlan plan;
+	plan.skip = false;
+	plan.samples = 10;
+	plan.sweepRad = 1.0f;
+	plan.stepRad = 0.1f;
+
+	std::vector<uint8_t> selected;
+	VR_CHECK(MeleeSweep::SelectSamples(plan, {}, selected) == 0);
+	// (0.25, 0.32) overlaps the slices of samples at 0.3 and 0.4.
+	VR_CHECK(MeleeSweep::SelectSamples(plan, { { 0.25f, 0.32f } }, selected) == 2);
+	VR_CHECK(selected[2] && selected[3] && !selected[1] && !selected[4]);
+	// Overlapping intervals count each sample once.
+	VR_CHECK(MeleeSweep::SelectSamples(plan, { { 0.0f, 0.15f }, { 0.05f, 0.2f } }, selected) == 2);
+
+	MeleeSweepPlan still = plan;
+	still.stepRad = 0.0f;
+	still.sweepRad = 0.0f;
+	VR_CHECK(MeleeSweep::SelectSamples(still, { { 0.0f, 0.0f } }, selected) == 1);
+	VR_CHECK(selected[9]);
+
+	int probes[MeleeSweep::kMaxWorldProbes];
+	VR_CHECK(MeleeSweep::WorldProbeSamples(plan, probes) == 3);
+	VR_CHECK(probes[0] == 0 && probes[1] == 5 && probes[2] == 9);
+	MeleeSweepPlan two = plan;
+	two.samples = 2;
+	VR_CHECK(MeleeSweep::WorldProbeSamples(two, probes) == 2);
+	VR_CHECK(probes[0] == 0 && probes[1] == 1);
+	MeleeSweepPlan one = plan;
+	one.samples = 1;
+	VR_CHECK(MeleeSweep::WorldProbeSamples(one, probes) == 1);
+
+	// Probe only when it can save more traces than it costs.
+	VR_CHECK(MeleeSweep::ShouldProbeWorld(plan, 0, 3));
+	VR_CHECK(MeleeSweep::ShouldProbeWorld(plan, 6, 3));
+	VR_CHECK(!MeleeSweep::ShouldProbeWorld(plan, 7, 3));
+	VR_CHECK(!MeleeSweep::ShouldProbeWorld(plan, 10, 3));
+	VR_CHECK(!MeleeSweep::ShouldProbeWorld(two, 0, 2));
+	VR_CHECK(!MeleeSweep::ShouldProbeWorld(one, 0, 1));
+}
+
+VR_TEST(StatsCountProbesAgainstTheLegacyPackets)
+{
+	MeleeSweepStats stats;
+	MeleeSweepPlan plan;
+	plan.skip = false;
+	plan.samples = 8;
+
+	// Two packets of four commands: 4 traces + 3 probes each packet, one skipped command.
+	for (int packet = 0; packet < 2; ++packet)
+	{
+		stats.RecordPacket();
+		stats.Record(plan, 2, 1, 3);
+		stats.Record(plan, 2, 1, 0);
+		stats.Record(plan, 0, 0, 0);
+		stats.Record(MeleeSweepPlan{}, 0, -1);
+	}
+	VR_CHECK(stats.LegacyTraces() == 20);
+	VR_CHECK(stats.commands == 8);
+	VR_CHECK(stats.skipped == 2);
+	VR_CHECK(stats.traced == 8);
+	VR_CHECK(stats.probes == 6);
+	VR_CHECK_NEAR(stats.SavedPercent(), 30.0, 1e-9);
+}
+
+int main() { return vrtest::RunAllTests(); }
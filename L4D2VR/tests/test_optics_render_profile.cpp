@@ -0,0 +1,200 @@
+// OpticsRenderProfiles / OpticsConVarScope / OpticsRenderProfileMailbox.
+#include "optics_render_profile.h"
+#include "test_common.h"
+
+#include <map>
+#include <string>
+#include <thread>
+
+namespace
+{
+	// Fake cvar list: handles are pointers into the map, lookups are counted.
+	struct FakeCvars
+	{
+		std::map<std::string, float> values;
+		int finds = 0;
+		int sets = 0;
+
+		OpticsConVarAccess Bind()
+		{
+			OpticsConVarAccess access;
+			access.find = [this](const char* name) -> void*
+				{
+					++finds;
+					auto it = values.find(name);
+					return (it != values.end()) ? &it->second : nullptr;
+				};
+			access.get = [](void* convar, float& out) { out = *static_cast<float*>(convar); return true; };
+			access.set = [this](void* convar, float value) { ++sets; *static_cast<float*>(convar) = value; return true; };
+			return access;
+		}
+	};
+}
+
+VR_TEST(ConVarScopeOverridesAndRestores)
+{
+	FakeCvars cvars;
+	cvars.values = { { "r_drawdetailprops", 1.0f }, { "r_drawparticles", 1.0f }, { "r_shadows", 1.0f }, { "r_lod", -1.0f } };
+	OpticsConVarAccess access = cvars.Bind();
+
+	OpticsRenderProfile profile;
+	profile.detailProps = false;
+	profile.shadows = false;
+	profile.lod = 2;
+	{
+		OpticsConVarScope scope(access, &profile);
+		VR_CHECK(scope.GetAppliedCount() == 3);
+		VR_CHECK(cvars.values["r_drawdetailprops"] == 0.0f);
+		VR_CHECK(cvars.values["r_drawparticles"] == 1.0f);
+		VR_CHECK(cvars.values["r_shadows"] == 0.0f);
+		VR_CHECK(cvars.values["r_lod"] == 2.0f);
+	}
+	VR_CHECK(cvars.values["r_drawdetailprops"] == 1.0f);
+	VR_CHECK(cvars.values["r_shadows"] == 1.0f);
+	VR_CHECK(cvars.values["r_lod"] == -1.0f);
+}
+
+VR_TEST(ConVarHandlesAreLookedUpOnce)
+{
+	FakeCvars cvars;
+	cvars.values = { { "r_drawdetailprops", 1.0f }, { "r_shadows", 1.0f } };
+	OpticsConVarAccess access = cvars.Bind();
+
+	OpticsRenderProfile profile;
+	profile.detailProps = false;
+	profile.shadows = false;
+	profile.lod = 1; // r_lod is missing from this cvar list: skipped, and not searched for again
+	for (int frame = 0; frame < 100; ++frame)
+	{
+		OpticsConVarScope scope(access, &profile);
+		VR_CHECK(scope.GetAppliedCount() == 2);
+	}
+	VR_CHECK(cvars.finds == 3);
+	VR_CHECK(access.GetFindCount() == 3);
+
+	access.ResetHandles();
+	{
+		OpticsConVarScope scope(access, &profile);
+	}
+	VR_CHECK(cvars.finds == 6);
+}
+
+VR_TEST(ConVarScopeSkipsMatchingValuesAndNullProfile)
+{
+	FakeCvars cvars;
+	cvars.values = { { "r_drawdetailprops", 0.0f } };
+	OpticsConVarAccess access = cvars.Bind();
+
+	OpticsRenderProfile profile;
+	profile.detailProps = false;
+	{
+		OpticsConVarScope scope(access, &profile);
+		VR_CHECK(scope.GetAppliedCount() == 0);
+	}
+	{
+		OpticsConVarScope scope(access, nullptr);
+		VR_CHECK(scope.GetAppliedCount() == 0);
+	}
+	VR_CHECK(cvars.sets == 0);
+
+	OpticsConVarAccess unbound;
+	OpticsConVarScope scope(unbound, &profile);
+	VR_CHECK(scope.GetAppliedCount() == 0);
+}
+
+VR_TEST(ApplyTakesProfilesAndResetsStatsOnABFlip)
+{
+	OpticsRenderProfiles profiles;
+	profiles.RecordCost(OpticsRTTScheduler::Pass_Scope, OpticsRenderProfiles::Variant_Reduced, 1.0);
+
+	OpticsRenderProfileSet set;
+	set.profiles[OpticsRTTScheduler::Pass_RearMirror].farZ = 3000.0f;
+	profiles.Apply(set);
+	VR_CHECK(profiles.GetStats(OpticsRTTScheduler::Pass_Scope, OpticsRenderProfiles::Variant_Reduced).samples == 1);
+	VR_CHECK(profiles.m_Profiles[OpticsRTTScheduler::Pass_RearMirror].farZ == 3000.0f);
+
+	set.abTest = true;
+	profiles.Apply(set);
+	VR_CHECK(profiles.m_ABTest);
+	VR_CHECK(profiles.GetStats(OpticsRTTScheduler::Pass_Scope, OpticsRenderProfiles::Variant_Reduced).samples == 0);
+	VR_CHECK(profiles.Select(OpticsRTTScheduler::Pass_Scope) == OpticsRenderProfiles::Variant_Reduced);
+	VR_CHECK(profiles.Select(OpticsRTTScheduler::Pass_Scope) == OpticsRenderProfiles::Variant_Full);
+
+	// A/B needs profiles enabled.
+	set.enabled = false;
+	profiles.Apply(set);
+	VR_CHECK(!profiles.m_ABTest);
+	VR_CHECK(profiles.Select(OpticsRTTScheduler::Pass_Scope) == OpticsRenderProfiles::Variant_Full);
+}
+
+VR_TEST(MailboxDeliversLatestSetOnce)
+{
+	OpticsRenderProfileMailbox mailbox;
+	OpticsRenderProfileSet out;
+	uint32_t generation = 0;
+	VR_CHECK(!mailbox.Consume(out, generation));
+
+	OpticsRenderProfileSet set;
+	set.profiles[0].lod = 1;
+	mailbox.Publish(set);
+	set.profiles[0].lod = 2;
+	mailbox.Publish(set);
+
+	VR_CHECK(mailbox.Consume(out, generation));
+	VR_CHECK(out.profiles[0].lod == 2);
+	VR_CHECK(generation == 2);
+	VR_CHECK(!mailbox.Consume(out, generation));
+}
+
+VR_TEST(MailboxReaderNeverSeesTornSet)
+{
+	// Every field of a published set carries the same sequence number; a torn copy would mix two.
+	OpticsRenderProfileMailbox mailbox;
+	constexpr int kPublishes = 20000;
+	std::atomic<bool> done{ false };
+	int torn = 0;
+	int seen = 0;
+	int lastSeq = 0;
+	bool monotonic = true;
+
+	std::thread reader([&]()
+		{
+			OpticsRenderProfileSet out;
+			uint32_t generation = 0;
+			while (!done.load(std::memory_order_acquire) || generation < kPublishes)
+			{
+				if (!mailbox.Consume(out, generation))
+					continue;
+				++seen;
+				const int seq = out.profiles[0].lod;
+				if (out.profiles[1].lod != seq || out.profiles[0].farZ != static_cast<float>(seq) || out.profiles[1].farZ != static_cast<float>(seq))
+					++torn;
+				if (seq < lastSeq)
+					monotonic = false;
+				lastSeq = seq;
+			}
+		});
+
+	OpticsRenderProfileSet set;
+	for (int i = 1; i <= kPublishes; ++i)
+	{
+		for (OpticsRenderProfile& p : set.profiles)
+		{
+			p.lod = i;
+			p.farZ = static_cast<float>(i);
+		}
+		mailbox.Publish(set);
+	}
+	done.store(true, std::memory_order_release);
+	reader.join();
+
+	VR_CHECK(torn == 0);
+	VR_CHECK(monotonic);
+	VR_CHECK(seen > 0);
+	VR_CHECK(lastSeq == kPublishes);
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
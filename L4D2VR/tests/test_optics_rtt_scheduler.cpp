@@ -0,0 +1,223 @@
+// Synthetic motion traces through OpticsRTTScheduler.
+#include "optics_rtt_scheduler.h"
+#include "test_common.h"
+
+namespace
+{
+	using Scheduler = OpticsRTTScheduler;
+	using Requests = std::array<Scheduler::PassRequest, Scheduler::Pass_Count>;
+
+	constexpr double kFrameSec = 1.0 / 90.0;
+
+	Scheduler MakeScheduler()
+	{
+		Scheduler s;
+		s.m_Config.passes[Scheduler::Pass_Scope].maxHz = 90.0f;
+		s.m_Config.passes[Scheduler::Pass_Scope].minHz = 30.0f;
+		s.m_Config.passes[Scheduler::Pass_RearMirror].maxHz = 45.0f;
+		s.m_Config.passes[Scheduler::Pass_RearMirror].minHz = 12.0f;
+		return s;
+	}
+
+	// Runs `frames` frames at frameSec; move(frame, requests) edits the request before each plan.
+	// Returns the number of frames each pass was rendered on.
+	template <typename Move>
+	std::array<int, Scheduler::Pass_Count> RunTrace(Scheduler& s, int frames, double frameSec, float budgetSec, Move&& move, int* bothOut = nullptr)
+	{
+		Requests req{};
+		std::array<int, Scheduler::Pass_Count> rendered{};
+		double now = 0.0;
+		for (int f = 0; f < frames; ++f)
+		{
+			now += frameSec;
+			move(f, req);
+			const uint32_t mask = s.PlanFrame(now, budgetSec, req);
+			for (int i = 0; i < Scheduler::Pass_Count; ++i)
+			{
+				if (mask & (1u << i))
+					++rendered[i];
+			}
+			if (bothOut && mask == 3u)
+				++*bothOut;
+		}
+		return rendered;
+	}
+}
+
+VR_TEST(StaticCameraRefreshesAtFloorRate)
+{
+	Scheduler s = MakeScheduler();
+	// 10 s, nothing moves: each pass should settle near its minHz.
+	const auto rendered = RunTrace(s, 900, kFrameSec, static_cast<float>(kFrameSec),
+		[](int, Requests& r) { r[0].wanted = true; r[1].wanted = true; });
+
+	VR_CHECK(rendered[Scheduler::Pass_Scope] >= 290 && rendered[Scheduler::Pass_Scope] <= 310);
+	VR_CHECK(rendered[Scheduler::Pass_RearMirror] >= 115 && rendered[Scheduler::Pass_RearMirror] <= 125);
+	VR_CHECK(s.GetCounters(Scheduler::Pass_Scope).skippedStatic > 0);
+}
+
+VR_TEST(FastHeadTurnRunsAtCap)
+{
+	Scheduler s = MakeScheduler();
+	s.m_Config.interleave = false;
+	// 5 deg / frame yaw (a flick) is past fullRateAngleDeg after a single frame.
+	const auto rendered = RunTrace(s, 900, kFrameSec, static_cast<float>(kFrameSec),
+		[](int, Requests& r)
+		{
+			r[0].wanted = true;
+			r[1].wanted = true;
+			r[0].ang[1] += 5.0f;
+			r[1].ang[1] += 5.0f;
+		});
+
+	// Scope cap is the frame rate, mirror cap half of it.
+	VR_CHECK(rendered[Scheduler::Pass_Scope] >= 880);
+	VR_CHECK(rendered[Scheduler::Pass_RearMirror] >= 440 && rendered[Scheduler::Pass_RearMirror] <= 455);
+}
+
+VR_TEST(MotionRaisesRateOverStatic)
+{
+	Scheduler still = MakeScheduler();
+	Scheduler walking = MakeScheduler();
+	auto stillTrace = [](int, Requests& r) { r[1].wanted = true; };
+	// Walking pace: ~200 u/s forward plus a slow yaw drift.
+	auto walkTrace = [](int, Requests& r)
+	{
+		r[1].wanted = true;
+		r[1].pos[0] += 200.0f * static_cast<float>(kFrameSec);
+		r[1].ang[1] += 0.2f;
+	};
+	const auto a = RunTrace(still, 900, kFrameSec, static_cast<float>(kFrameSec), stillTrace);
+	const auto b = RunTrace(walking, 900, kFrameSec, static_cast<float>(kFrameSec), walkTrace);
+	VR_CHECK(b[Scheduler::Pass_RearMirror] > a[Scheduler::Pass_RearMirror] * 2);
+}
+
+VR_TEST(InterleaveNeverRendersBothPasses)
+{
+	Scheduler s = MakeScheduler();
+	int both = 0;
+	const auto rendered = RunTrace(s, 900, kFrameSec, static_cast<float>(kFrameSec),
+		[](int f, Requests& r)
+		{
+			r[0].wanted = true;
+			r[1].wanted = true;
+			if (f > 450)
+			{
+				r[0].ang[1] += 2.0f;
+				r[1].ang[1] += 2.0f;
+			}
+		}, &both);
+
+	VR_CHECK(both == 0);
+	VR_CHECK(rendered[0] > 0 && rendered[1] > 0);
+	VR_CHECK(s.GetCounters(Scheduler::Pass_Scope).deferredInterleave + s.GetCounters(Scheduler::Pass_RearMirror).deferredInterleave > 0);
+}
+
+VR_TEST(OverBudgetSlowsOnlyNonUrgentPasses)
+{
+	auto moving = [](int, Requests& r)
+	{
+		r[0].wanted = true;
+		r[0].ang[1] += 2.0f;
+	};
+	auto movingUrgent = [](int, Requests& r)
+	{
+		r[0].wanted = true;
+		r[0].urgent = true;
+		r[0].ang[1] += 2.0f;
+	};
+
+	// Frames take 1/60 s against an 11.1 ms budget (50% over).
+	Scheduler slow = MakeScheduler();
+	const auto a = RunTrace(slow, 600, 1.0 / 60.0, static_cast<float>(kFrameSec), moving);
+	VR_CHECK(slow.GetHeadroom() < 0.0f);
+	VR_CHECK(slow.GetHeadroomRateScale() < 0.5f);
+	VR_CHECK(a[Scheduler::Pass_Scope] < 400);
+
+	Scheduler urgent = MakeScheduler();
+	const auto b = RunTrace(urgent, 600, 1.0 / 60.0, static_cast<float>(kFrameSec), movingUrgent);
+	VR_CHECK(b[Scheduler::Pass_Scope] == 600);
+	VR_CHECK(urgent.GetCounters(Scheduler::Pass_Scope).urgent == 600);
+}
+
+VR_TEST(HoldingDisplayRateDoesNotThrottle)
+{
+	// Vsync-paced frames exactly on budget read as zero headroom; that is not "over budget".
+	Scheduler s = MakeScheduler();
+	const auto rendered = RunTrace(s, 900, kFrameSec, static_cast<float>(kFrameSec),
+		[](int, Requests& r)
+		{
+			r[0].wanted = true;
+			r[0].ang[1] += 5.0f;
+		});
+	VR_CHECK_NEAR(s.GetHeadroomRateScale(), 1.0, 1e-6);
+	VR_CHECK(rendered[Scheduler::Pass_Scope] >= 880);
+}
+
+VR_TEST(HitchDoesNotThrottle)
+{
+	Scheduler s = MakeScheduler();
+	Requests req{};
+	req[0].wanted = true;
+	double now = 0.0;
+	for (int f = 0; f < 90; ++f)
+	{
+		now += kFrameSec;
+		s.PlanFrame(now, static_cast<float>(kFrameSec), req);
+	}
+	const float before = s.GetHeadroom();
+	// One 2 s stall (alt-tab / load) is ignored by the headroom filter.
+	now += 2.0;
+	s.PlanFrame(now, static_cast<float>(kFrameSec), req);
+	VR_CHECK_NEAR(s.GetHeadroom(), before, 1e-6);
+}
+
+VR_TEST(ReturningPassRendersImmediately)
+{
+	Scheduler s = MakeScheduler();
+	Requests req{};
+	req[1].wanted = true;
+	double now = kFrameSec;
+	VR_CHECK(s.PlanFrame(now, 0.0f, req) == 2u);
+	now += kFrameSec;
+	VR_CHECK(s.PlanFrame(now, 0.0f, req) == 0u);
+
+	req[1].wanted = false;
+	now += kFrameSec;
+	VR_CHECK(s.PlanFrame(now, 0.0f, req) == 0u);
+
+	req[1].wanted = true;
+	now += kFrameSec;
+	VR_CHECK(s.PlanFrame(now, 0.0f, req) == 2u);
+}
+
+VR_TEST(YawWrapIsShortestArc)
+{
+	Scheduler s = MakeScheduler();
+	Requests req{};
+	req[1].wanted = true;
+	req[1].ang[1] = 179.5f;
+	double now = kFrameSec;
+	s.PlanFrame(now, 0.0f, req);
+	// -179.5 is 1 degree away, not 359: still below fullRateAngleDeg so the floor rate applies.
+	req[1].ang[1] = -179.5f;
+	now += 1.0 / 40.0;
+	VR_CHECK(s.PlanFrame(now, 0.0f, req) == 0u);
+}
+
+VR_TEST(RecordCostIgnoresInvalidSamples)
+{
+	Scheduler s;
+	s.RecordCost(Scheduler::Pass_Scope, 2.0);
+	s.RecordCost(Scheduler::Pass_Scope, -1.0);
+	s.RecordCost(Scheduler::Pass_Scope, std::nan(""));
+	const auto& c = s.GetCounters(Scheduler::Pass_Scope);
+	VR_CHECK_NEAR(c.lastCostMs, 2.0, 1e-9);
+	VR_CHECK_NEAR(c.totalCostMs, 2.0, 1e-9);
+	VR_CHECK_NEAR(c.maxCostMs, 2.0, 1e-9);
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
@@ -0,0 +1,384 @@
+// overlay_math.h: SSE kernels against the scalar reference and a double-precision product, inverse
+// round trips, Quat / Mat34 agreement, and OverlayFrame against the per-overlay math it replaced
+// (Euler matrices, the rear mirror's yaw-only basis, the kill indicator's HMD-relative offset).
+#include "overlay_math.h"
+#include "test_common.h"
+
+#include <openvr.h>
+
+#include <random>
+
+namespace
+{
+	constexpr float kDeg2Rad = 3.14159265358979323846f / 180.0f;
+
+	double MaxDiff(const Mat34& a, const Mat34& b)
+	{
+		double worst = 0.0;
+		for (int r = 0; r < 3; ++r)
+		{
+			for (int c = 0; c < 4; ++c)
+				worst = std::max(worst, std::fabs(static_cast<double>(a.m[r][c]) - b.m[r][c]));
+		}
+		return worst;
+	}
+
+	double MaxDiff(const Vec3& a, const Vec3& b)
+	{
+		return std::max({ std::fabs(a.x - b.x), std::fabs(a.y - b.y), std::fabs(a.z - b.z) });
+	}
+
+	// a * b in double, rounded once.
+	Mat34 ComposeDouble(const Mat34& a, const Mat34& b)
+	{
+		Mat34 out;
+		for (int r = 0; r < 3; ++r)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				double v = 0.0;
+				for (int k = 0; k < 3; ++k)
+					v += static_cast<double>(a.m[r][k]) * b.m[k][c];
+				out.m[r][c] = static_cast<float>(c == 3 ? v + a.m[r][3] : v);
+			}
+		}
+		return out;
+	}
+
+	Quat RandomQuat(std::mt19937& rng)
+	{
+		std::normal_distribution<float> n(0.0f, 1.0f);
+		Quat q(n(rng), n(rng), n(rng), n(rng));
+		const float len = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+		return Quat(q.x / len, q.y / len, q.z / len, q.w / len);
+	}
+
+	Mat34 RandomRigid(std::mt19937& rng)
+	{
+		std::uniform_real_distribution<float> pos(-3.0f, 3.0f);
+		return Mat34::FromQuat(RandomQuat(rng), Vec3(pos(rng), pos(rng), pos(rng)));
+	}
+
+	// Rotation, per-axis scale and a little shear: what overlay widths and parent scales produce.
+	Mat34 RandomAffine(std::mt19937& rng)
+	{
+		std::uniform_real_distribution<float> scale(0.2f, 4.0f);
+		std::uniform_real_distribution<float> shear(-0.3f, 0.3f);
+		Mat34 s = Mat34::Scale(scale(rng), scale(rng), scale(rng));
+		s.m[0][1] = shear(rng);
+		s.m[1][2] = shear(rng);
+		return ComposeDouble(RandomRigid(rng), s);
+	}
+
+	// ---- the code overlay_math.h replaced (vr_lifecycle_update.inl / vr_lifecycle_pose_hud.inl / vr.cpp) ----
+
+	void Mul33(const float a[3][3], const float b[3][3], float out[3][3])
+	{
+		for (int r = 0; r < 3; ++r)
+			for (int c = 0; c < 3; ++c)
+				out[r][c] = a[r][0] * b[0][c] + a[r][1] * b[1][c] + a[r][2] * b[2][c];
+	}
+
+	// Rz * Ry * Rx, or Rx * Ry * Rz when xyz is set, from explicit per-axis matrices.
+	vr::HmdMatrix34_t LegacyEuler(float pitchDeg, float yawDeg, float rollDeg, float xOff, float yOff, float zOff, bool xyz)
+	{
+		const float cp = cosf(pitchDeg * kDeg2Rad), sp = sinf(pitchDeg * kDeg2Rad);
+		const float cy = cosf(yawDeg * kDeg2Rad), sy = sinf(yawDeg * kDeg2Rad);
+		const float cr = cosf(rollDeg * kDeg2Rad), sr = sinf(rollDeg * kDeg2Rad);
+		const float Rx[3][3] = { { 1.0f, 0.0f, 0.0f }, { 0.0f, cp, -sp }, { 0.0f, sp, cp } };
+		const float Ry[3][3] = { { cy, 0.0f, sy }, { 0.0f, 1.0f, 0.0f }, { -sy, 0.0f, cy } };
+		const float Rz[3][3] = { { cr, -sr, 0.0f }, { sr, cr, 0.0f }, { 0.0f, 0.0f, 1.0f } };
+		float inner[3][3], R[3][3];
+		if (xyz)
+		{
+			Mul33(Ry, Rz, inner);
+			Mul33(Rx, inner, R);
+		}
+		else
+		{
+			Mul33(Ry, Rx, inner);
+			Mul33(Rz, inner, R);
+		}
+		vr::HmdMatrix34_t rel = {
+			R[0][0], R[0][1], R[0][2], xOff,
+			R[1][0], R[1][1], R[1][2], yOff,
+			R[2][0], R[2][1], R[2][2], zOff
+		};
+		return rel;
+	}
+
+	float Normalize3(float v[3])
+	{
+		const float len = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+		if (len > 0.0f)
+		{
+			for (int i = 0; i < 3; ++i)
+				v[i] /= len;
+		}
+		return len;
+	}
+
+	// UpdateRearMirrorOverlayTransform before OverlayFrame: yaw-only (right, up, back) from the HMD
+	// pose, body origin + mirror offsets along (forward, right, up), then the angle offset.
+	vr::HmdMatrix34_t LegacyRearMirror(const vr::HmdMatrix34_t& hmdMat, const float bodyOffset[3], const float mirrorOffset[3],
+		const float angles[3])
+	{
+		const float up[3] = { 0.0f, 1.0f, 0.0f };
+		float fwd[3] = { -hmdMat.m[0][2], 0.0f, -hmdMat.m[2][2] };
+		if (Normalize3(fwd) == 0.0f)
+		{
+			fwd[0] = 0.0f; fwd[1] = 0.0f; fwd[2] = -1.0f;
+		}
+		float right[3] = { fwd[1] * up[2] - fwd[2] * up[1], fwd[2] * up[0] - fwd[0] * up[2], fwd[0] * up[1] - fwd[1] * up[0] };
+		if (Normalize3(right) == 0.0f)
+		{
+			right[0] = 1.0f; right[1] = 0.0f; right[2] = 0.0f;
+		}
+		const float back[3] = { -fwd[0], -fwd[1], -fwd[2] };
+
+		float mirrorPos[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			const float bodyOrigin = hmdMat.m[i][3] + fwd[i] * bodyOffset[0] + right[i] * bodyOffset[1] + up[i] * bodyOffset[2];
+			mirrorPos[i] = bodyOrigin + fwd[i] * mirrorOffset[0] + right[i] * mirrorOffset[1] + up[i] * mirrorOffset[2];
+		}
+
+		const vr::HmdMatrix34_t off = LegacyEuler(angles[0], angles[1], angles[2], 0.0f, 0.0f, 0.0f, false);
+		const float Roff[3][3] = {
+			{ off.m[0][0], off.m[0][1], off.m[0][2] },
+			{ off.m[1][0], off.m[1][1], off.m[1][2] },
+			{ off.m[2][0], off.m[2][1], off.m[2][2] }
+		};
+		const float B[3][3] = {
+			{ right[0], up[0], back[0] },
+			{ right[1], up[1], back[1] },
+			{ right[2], up[2], back[2] }
+		};
+		float Rworld[3][3];
+		Mul33(B, Roff, Rworld);
+		vr::HmdMatrix34_t out = {
+			Rworld[0][0], Rworld[0][1], Rworld[0][2], mirrorPos[0],
+			Rworld[1][0], Rworld[1][1], Rworld[1][2], mirrorPos[1],
+			Rworld[2][0], Rworld[2][1], Rworld[2][2], mirrorPos[2]
+		};
+		return out;
+	}
+
+	// The hand HUD's mul34(devToMirror, translate34(x, y, 0)).
+	vr::HmdMatrix34_t LegacyMul34(const vr::HmdMatrix34_t& a, const vr::HmdMatrix34_t& b)
+	{
+		vr::HmdMatrix34_t out{};
+		for (int r = 0; r < 3; ++r)
+		{
+			for (int c = 0; c < 3; ++c)
+				out.m[r][c] = a.m[r][0] * b.m[0][c] + a.m[r][1] * b.m[1][c] + a.m[r][2] * b.m[2][c];
+			out.m[r][3] = a.m[r][0] * b.m[0][3] + a.m[r][1] * b.m[1][3] + a.m[r][2] * b.m[2][3] + a.m[r][3];
+		}
+		return out;
+	}
+
+	// ComputeKillIndicatorOverlayTransform before OverlayFrame: (right, up, -forward) meters.
+	Vec3 LegacyKillIndicator(const Vec3& world, const Vec3& eye, Vec3 forward, Vec3 right, Vec3 up, float unitsPerMeter)
+	{
+		forward.Normalize();
+		right.Normalize();
+		up.Normalize();
+		const float upm = std::max(1.0f, unitsPerMeter);
+		const Vec3 d = world - eye;
+		return Vec3(Vec3::Dot(d, right) / upm, Vec3::Dot(d, up) / upm, -Vec3::Dot(d, forward) / upm);
+	}
+}
+
+VR_TEST(EulerHelpersMatchTheOldMatrices)
+{
+	std::mt19937 rng(48);
+	std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+	std::uniform_real_distribution<float> off(-1.0f, 1.0f);
+	double worst = 0.0;
+	for (int i = 0; i < 5000; ++i)
+	{
+		const float p = angle(rng), y = angle(rng), r = angle(rng);
+		const Vec3 o(off(rng), off(rng), off(rng));
+		worst = std::max(worst, MaxDiff(Mat34::RotationZYXDeg(p, y, r, o), Mat34::From(LegacyEuler(p, y, r, o.x, o.y, o.z, false))));
+		worst = std::max(worst, MaxDiff(Mat34::RotationXYZDeg(p, y, r, o), Mat34::From(LegacyEuler(p, y, r, o.x, o.y, o.z, true))));
+	}
+	std::printf("  Euler helpers vs per-axis products: %.2g\n", worst);
+	VR_CHECK(worst < 2e-6);
+}
+
+VR_TEST(KernelsMatchTheScalarReference)
+{
+	std::printf("  SSE kernels %s\n", OVERLAY_MATH_SSE ? "enabled" : "unavailable (scalar only)");
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> pos(-50.0f, 50.0f);
+	double compose = 0.0, composeRef = 0.0, rigid = 0.0, inverse = 0.0, points = 0.0;
+	for (int i = 0; i < 5000; ++i)
+	{
+		const Mat34 a = (i & 1) ? RandomAffine(rng) : RandomRigid(rng);
+		const Mat34 b = RandomAffine(rng);
+		compose = std::max(compose, MaxDiff(Mat34Math::Compose(a, b), Mat34Math::ComposeScalar(a, b)));
+		composeRef = std::max(composeRef, MaxDiff(Mat34Math::Compose(a, b), ComposeDouble(a, b)));
+
+		const Mat34 rigidA = RandomRigid(rng);
+		rigid = std::max(rigid, MaxDiff(Mat34Math::InverseRigid(rigidA), Mat34Math::InverseRigidScalar(rigidA)));
+
+		Mat34 inv, invScalar;
+		VR_CHECK(Mat34Math::Inverse(a, inv) && Mat34Math::InverseScalar(a, invScalar));
+		inverse = std::max(inverse, MaxDiff(inv, invScalar));
+
+		alignas(16) Vec3 in[7], out[7], outScalar[7];
+		for (Vec3& p : in)
+			p = Vec3(pos(rng), pos(rng), pos(rng));
+		Mat34Math::TransformPoints(a, in, out, 7);
+		Mat34Math::TransformPointsScalar(a, in, outScalar, 7);
+		for (int k = 0; k < 7; ++k)
+			points = std::max(points, MaxDiff(out[k], outScalar[k]) / (1.0 + in[k].Length()));
+	}
+	std::printf("  compose %.2g (vs double %.2g), rigid inverse %.2g, inverse %.2g, points %.2g per unit\n",
+		compose, composeRef, rigid, inverse, points);
+	VR_CHECK(compose < 1e-5 && composeRef < 1e-5);
+	VR_CHECK(rigid < 1e-5);
+	VR_CHECK(inverse < 1e-5);
+	VR_CHECK(points < 1e-6);
+}
+
+VR_TEST(InversesRoundTrip)
+{
+	std::mt19937 rng(11);
+	double rigidWorst = 0.0, affineWorst = 0.0;
+	for (int i = 0; i < 2000; ++i)
+	{
+		const Mat34 r = RandomRigid(rng);
+		rigidWorst = std::max(rigidWorst, MaxDiff(Mat34Math::Compose(r, Mat34Math::InverseRigid(r)), Mat34::Identity()));
+		Mat34 inv;
+		VR_CHECK(Mat34Math::Inverse(r, inv));
+		VR_CHECK(MaxDiff(inv, Mat34Math::InverseRigid(r)) < 1e-5);
+
+		const Mat34 a = RandomAffine(rng);
+		VR_CHECK(Mat34Math::Inverse(a, inv));
+		affineWorst = std::max(affineWorst, MaxDiff(Mat34Math::Compose(a, inv), Mat34::Identity()));
+		affineWorst = std::max(affineWorst, MaxDiff(Mat34Math::Compose(inv, a), Mat34::Identity()));
+	}
+	std::printf("  round trip: rigid %.2g, affine %.2g\n", rigidWorst, affineWorst);
+	VR_CHECK(rigidWorst < 1e-5);
+	VR_CHECK(affineWorst < 1e-4);
+
+	// Singular: false, output untouched.
+	Mat34 flat = Mat34::Scale(1.0f, 0.0f, 1.0f);
+	Mat34 out = Mat34::Translation(1.0f, 2.0f, 3.0f);
+	VR_CHECK(!Mat34Math::Inverse(flat, out));
+	VR_CHECK(!Mat34Math::InverseScalar(flat, out));
+	VR_CHECK(MaxDiff(out, Mat34::Translation(1.0f, 2.0f, 3.0f)) == 0.0);
+}
+
+VR_TEST(QuatAndMatrixAgree)
+{
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> pos(-2.0f, 2.0f);
+	double worst = 0.0;
+	for (int i = 0; i < 2000; ++i)
+	{
+		const Quat a = RandomQuat(rng);
+		const Quat b = RandomQuat(rng);
+		const Vec3 v(pos(rng), pos(rng), pos(rng));
+		worst = std::max(worst, MaxDiff(a.Rotate(v), Mat34Math::TransformPoint(Mat34::FromQuat(a), v)));
+		worst = std::max(worst, MaxDiff(Mat34::FromQuat(a * b), Mat34Math::Compose(Mat34::FromQuat(a), Mat34::FromQuat(b))));
+	}
+	VR_CHECK(worst < 1e-5);
+
+	// HmdMatrix34_t is a straight copy both ways.
+	const Mat34 m = RandomAffine(rng);
+	const vr::HmdMatrix34_t h = m.To<vr::HmdMatrix34_t>();
+	VR_CHECK(h.m[1][3] == m.m[1][3] && h.m[2][0] == m.m[2][0]);
+	VR_CHECK(MaxDiff(Mat34::From(h), m) == 0.0);
+	VR_CHECK(alignof(Mat34) == 16 && alignof(Vec3) == 16 && sizeof(Vec3) == 16);
+}
+
+VR_TEST(RearMirrorMatchesTheOldMath)
+{
+	std::mt19937 rng(21);
+	std::uniform_real_distribution<float> angle(-90.0f, 90.0f);
+	std::uniform_real_distribution<float> off(-0.5f, 0.5f);
+	double worst = 0.0;
+	for (int i = 0; i < 5000; ++i)
+	{
+		// Every 50th pose looks straight down, where the yaw basis falls back to -Z forward.
+		Mat34 pose = RandomRigid(rng);
+		if (i % 50 == 0)
+			pose = Mat34::RotationZYXDeg(-90.0f, 0.0f, 0.0f, pose.Origin());
+		const vr::HmdMatrix34_t hmd = pose.To<vr::HmdMatrix34_t>();
+		const float body[3] = { off(rng), off(rng), off(rng) };
+		const float mirror[3] = { off(rng), off(rng), off(rng) };
+		const float angles[3] = { angle(rng), angle(rng) * 2.0f, angle(rng) };
+
+		// UpdateRearMirrorOverlayTransform.
+		OverlayFrame frame;
+		frame.SetHmdPose(hmd, true);
+		VR_CHECK(frame.hmdValid);
+		const Vec3 mirrorPos = frame.BodyPoint(body[0] + mirror[0], body[1] + mirror[1], body[2] + mirror[2]);
+		Mat34 mirrorAbs = Mat34Math::Compose(frame.trackingFromBody, Mat34::RotationZYXDeg(angles[0], angles[1], angles[2]));
+		mirrorAbs.SetOrigin(mirrorPos);
+
+		worst = std::max(worst, MaxDiff(mirrorAbs, Mat34::From(LegacyRearMirror(hmd, body, mirror, angles))));
+
+		// The hand HUD rows hang off the mirror transform.
+		const Mat34 row = Mat34Math::Compose(mirrorAbs, Mat34::Translation(0.1f, -0.05f, 0.0f));
+		const vr::HmdMatrix34_t legacyRow = LegacyMul34(mirrorAbs.To<vr::HmdMatrix34_t>(), Mat34::Translation(0.1f, -0.05f, 0.0f).To<vr::HmdMatrix34_t>());
+		worst = std::max(worst, MaxDiff(row, Mat34::From(legacyRow)));
+	}
+	std::printf("  rear mirror and hand HUD rows vs old math: %.2g\n", worst);
+	VR_CHECK(worst < 1e-5);
+}
+
+VR_TEST(KillIndicatorMatchesTheOldMath)
+{
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> world(-4000.0f, 4000.0f);
+	std::uniform_real_distribution<float> scale(20.0f, 60.0f);
+	double worst = 0.0;
+	for (int i = 0; i < 5000; ++i)
+	{
+		// A Source view basis (forward, right, up) at some unnormalized length.
+		const Mat34 view = Mat34::FromQuat(RandomQuat(rng));
+		const Vec3 forward = view.Column(0) * 3.0f;
+		const Vec3 right = view.Column(1) * -0.5f;
+		const Vec3 up = view.Column(2) * 2.0f;
+		const Vec3 eye(world(rng), world(rng), world(rng) * 0.1f);
+		const Vec3 target = eye + Vec3(world(rng), world(rng), world(rng)) * 0.2f;
+		const float unitsPerMeter = scale(rng);
+
+		OverlayFrame frame;
+		VR_CHECK(frame.SetWorldView(eye, forward, right, up, unitsPerMeter));
+		const Vec3 got = Mat34Math::TransformPoint(frame.hmdFromWorld, target);
+		const Vec3 want = LegacyKillIndicator(target, eye, forward, right, up, unitsPerMeter);
+		// Relative to the distance: the new path folds the eye into the translation.
+		worst = std::max(worst, MaxDiff(got, want) / (1.0 + want.Length()));
+	}
+	std::printf("  kill indicator vs old math: %.2g per meter\n", worst);
+	VR_CHECK(worst < 2e-5);
+}
+
+VR_TEST(InvalidPosesAreRejected)
+{
+	OverlayFrame frame;
+	Mat34 pose = Mat34::Translation(0.0f, 1.7f, 0.0f);
+	frame.SetHmdPose(pose.To<vr::HmdMatrix34_t>(), false);
+	VR_CHECK(!frame.hmdValid);
+	pose.m[0][1] = pose.m[1][1] = pose.m[2][1] = 0.0f;   // no up axis
+	frame.SetHmdPose(pose.To<vr::HmdMatrix34_t>(), true);
+	VR_CHECK(!frame.hmdValid);
+
+	// Standing up straight: body frame is the HMD frame, forward is -Z.
+	frame.SetHmdPose(Mat34::Translation(0.0f, 1.7f, 0.0f).To<vr::HmdMatrix34_t>(), true);
+	VR_CHECK(frame.hmdValid);
+	VR_CHECK(MaxDiff(frame.BodyPoint(1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.7f, -1.0f)) < 1e-6);
+	VR_CHECK(MaxDiff(frame.HmdPoint(0.0f, 1.0f, 0.5f), Vec3(1.0f, 2.2f, 0.0f)) < 1e-6);
+
+	VR_CHECK(!frame.SetWorldView(Vec3(), Vec3(1.0f, 0.0f, 0.0f), Vec3(), Vec3(0.0f, 0.0f, 1.0f), 40.0f));
+	VR_CHECK(!frame.worldValid);
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
@@ -0,0 +1,218 @@
+// OverlayStateCache against a recording fake of IVROverlay.
+#include "overlay_state_cache.h"
+#include "test_common.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+	// Records every call as "<Method> <handle>"; failNext makes the next call return an error.
+	struct RecordingOverlay
+	{
+		std::vector<std::string> calls;
+		bool failNext = false;
+
+		vr::EVROverlayError Record(const char* method, vr::VROverlayHandle_t handle)
+		{
+			calls.push_back(std::string(method) + " " + std::to_string(handle));
+			if (failNext)
+			{
+				failNext = false;
+				return vr::VROverlayError_RequestFailed;
+			}
+			return vr::VROverlayError_None;
+		}
+
+		vr::EVROverlayError ShowOverlay(vr::VROverlayHandle_t h) { return Record("Show", h); }
+		vr::EVROverlayError HideOverlay(vr::VROverlayHandle_t h) { return Record("Hide", h); }
+		vr::EVROverlayError SetOverlayAlpha(vr::VROverlayHandle_t h, float) { return Record("Alpha", h); }
+		vr::EVROverlayError SetOverlayCurvature(vr::VROverlayHandle_t h, float) { return Record("Curvature", h); }
+		vr::EVROverlayError SetOverlayTextureBounds(vr::VROverlayHandle_t h, const vr::VRTextureBounds_t*) { return Record("Bounds", h); }
+		vr::EVROverlayError SetOverlayTexture(vr::VROverlayHandle_t h, const vr::Texture_t*) { return Record("Texture", h); }
+		vr::EVROverlayError SetOverlayFlag(vr::VROverlayHandle_t h, vr::VROverlayFlags, bool) { return Record("Flag", h); }
+		vr::EVROverlayError SetOverlayTransformAbsolute(vr::VROverlayHandle_t h, vr::ETrackingUniverseOrigin, const vr::HmdMatrix34_t*) { return Record("Transform", h); }
+		vr::EVROverlayError SetOverlayWidthInMeters(vr::VROverlayHandle_t h, float) { return Record("Width", h); }
+
+		std::vector<std::string> Take()
+		{
+			std::vector<std::string> out;
+			out.swap(calls);
+			return out;
+		}
+	};
+
+	using Cache = OverlayStateCache<RecordingOverlay>;
+	using Calls = std::vector<std::string>;
+
+	constexpr vr::VROverlayHandle_t kHud = 1;
+	constexpr vr::VROverlayHandle_t kScope = 2;
+
+	vr::Texture_t MakeTexture()
+	{
+		vr::Texture_t texture{};
+		texture.eType = vr::TextureType_DirectX;
+		texture.eColorSpace = vr::ColorSpace_Auto;
+		return texture;
+	}
+}
+
+VR_TEST(RepeatedStateIsElided)
+{
+	RecordingOverlay api;
+	Cache cache;
+	cache.SetApi(&api);
+
+	for (int frame = 0; frame < 10; ++frame)
+	{
+		cache.Show(kHud);
+		cache.SetAlpha(kHud, 0.5f);
+		cache.SetCurvature(kHud, 0.2f);
+		cache.SetFlag(kHud, vr::VROverlayFlags_MakeOverlaysInteractiveIfVisible, false);
+		cache.Flush();
+		const Calls calls = api.Take();
+		VR_CHECK(calls.size() == (frame == 0 ? 4u : 0u));
+	}
+	VR_CHECK(cache.GetCounters().requested == 40);
+	VR_CHECK(cache.GetCounters().issued == 4);
+	VR_CHECK(cache.GetCounters().Elided() == 36);
+}
+
+VR_TEST(FlushOrderKeepsContentAheadOfVisibility)
+{
+	RecordingOverlay api;
+	Cache cache;
+	cache.SetApi(&api);
+
+	cache.Show(kScope);
+	cache.SetFlag(kScope, vr::VROverlayFlags_MakeOverlaysInteractiveIfVisible, true);
+	cache.SetCurvature(kScope, 0.1f);
+	cache.SetAlpha(kScope, 1.0f);
+	cache.SetTexture(kScope, MakeTexture(), 1);
+	cache.SetTextureBounds(kScope, vr::VRTextureBounds_t{ 0.0f, 0.0f, 1.0f, 1.0f });
+	cache.Flush();
+	VR_CHECK((api.Take() == Calls{ "Bounds 2", "Texture 2", "Alpha 2", "Curvature 2", "Flag 2", "Show 2" }));
+}
+
+VR_TEST(HiddenOverlayTextureUploadIsPostponed)
+{
+	RecordingOverlay api;
+	Cache cache;
+	cache.SetApi(&api);
+
+	cache.Hide(kScope);
+	cache.SetTexture(kScope, MakeTexture(), 1);
+	cache.Flush();
+	VR_CHECK((api.Take() == Calls{ "Hide 2" }));
+
+	cache.SetTexture(kScope, MakeTexture(), 2);
+	cache.Flush();
+	VR_CHECK(api.Take().empty());
+
+	// Shown: the latest texture goes out before the overlay becomes visible.
+	cache.Show(kScope);
+	cache.Flush();
+	VR_CHECK((api.Take() == Calls{ "Texture 2", "Show 2" }));
+
+	// Same content key: no re-upload.
+	cache.SetTexture(kScope, MakeTexture(), 2);
+	cache.Flush();
+	VR_CHECK(api.Take().empty());
+	cache.SetTexture(kScope, MakeTexture(), 3);
+	cache.Flush();
+	VR_CHECK((api.Take() == Calls{ "Texture 2" }));
+}
+
+VR_TEST(FailedCallIsRetriedOnNextFlush)
+{
+	RecordingOverlay api;
+	Cache cache;
+	cache.SetApi(&api);
+
+	cache.SetCurvature(kHud, 0.3f);
+	api.failNext = true;
+	cache.Flush();
+	VR_CHECK(api.Take().size() == 1);
+	cache.Flush();
+	VR_CHECK((api.Take() == Calls{ "Curvature 1" }));
+	cache.Flush();
+	VR_CHECK(api.Take().empty());
+}
+
+VR_TEST(InvalidateReissuesDesiredState)
+{
+	RecordingOverlay api;
+	Cache cache;
+	cache.SetApi(&api);
+
+	cache.Show(kHud);
+	cache.SetCurvature(kHud, 0.3f);
+	cache.Flush();
+	api.Take();
+
+	cache.Invalidate(kHud);
+	cache.Flush();
+	VR_CHECK((api.Take() == Calls{ "Curvature 1", "Show 1" }));
+
+	cache.InvalidateAll();
+	cache.Flush();
+	VR_CHECK(api.Take().size() == 2);
+}
+
+VR_TEST(TransformAndWidthWriteThroughWithElision)
+{
+	RecordingOverlay api;
+	Cache cache;
+	cache.SetApi(&api);
+
+	vr::HmdMatrix34_t m{};
+	m.m[0][0] = m.m[1][1] = m.m[2][2] = 1.0f;
+	VR_CHECK(cache.SetTransformAbsolute(kHud, vr::TrackingUniverseStanding, m) == vr::VROverlayError_None);
+	VR_CHECK(cache.SetWidthInMeters(kHud, 0.5f) == vr::VROverlayError_None);
+	// Issued immediately, not at Flush().
+	VR_CHECK((api.Take() == Calls{ "Transform 1", "Width 1" }));
+
+	cache.SetTransformAbsolute(kHud, vr::TrackingUniverseStanding, m);
+	cache.SetWidthInMeters(kHud, 0.5f);
+	VR_CHECK(api.Take().empty());
+
+	cache.SetTransformAbsolute(kHud, vr::TrackingUniverseSeated, m);
+	m.m[0][3] = 1.0f;
+	cache.SetTransformAbsolute(kHud, vr::TrackingUniverseSeated, m);
+	VR_CHECK(api.Take().size() == 2);
+}
+
+VR_TEST(FlagsOnlyIssueChangedBits)
+{
+	RecordingOverlay api;
+	Cache cache;
+	cache.SetApi(&api);
+
+	cache.SetFlag(kHud, vr::VROverlayFlags_MakeOverlaysInteractiveIfVisible, true);
+	cache.SetFlag(kHud, vr::VROverlayFlags_SendVRSmoothScrollEvents, false);
+	cache.Flush();
+	VR_CHECK(api.Take().size() == 2);
+
+	cache.SetFlag(kHud, vr::VROverlayFlags_MakeOverlaysInteractiveIfVisible, false);
+	cache.SetFlag(kHud, vr::VROverlayFlags_SendVRSmoothScrollEvents, false);
+	cache.Flush();
+	VR_CHECK(api.Take().size() == 1);
+}
+
+VR_TEST(NoApiDefersEverything)
+{
+	RecordingOverlay api;
+	Cache cache;
+	cache.Show(kHud);
+	cache.Flush();
+	VR_CHECK(cache.SetWidthInMeters(kHud, 1.0f) == vr::VROverlayError_RequestFailed);
+
+	cache.SetApi(&api);
+	cache.Flush();
+	VR_CHECK((api.Take() == Calls{ "Show 1" }));
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
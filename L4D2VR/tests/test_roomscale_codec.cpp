@@ -0,0 +1,327 @@
+// Roomscale codec: every code of the 7 exponent x 8 direction codebook round-trips through quantize,
+// pack and decode; the encoder's error feedback keeps the accumulated error inside
+// kMaxResidualMeters over long random walks; the server jitter buffer drops backups and reordered
+// commands, smooths what it releases, and accepts a client restart (kRestartGap).
+#include "roomscale_codec.h"
+#include "test_common.h"
+
+#include <random>
+#include <set>
+#include <utility>
+
+namespace
+{
+	constexpr uint32_t kOtherButtons = (1u << 0) | (1u << 11) | (1u << 25);   // IN_ATTACK, IN_RELOAD, IN_ATTACK3
+
+	float Length(float x, float y)
+	{
+		return std::sqrt(x * x + y * y);
+	}
+
+	// Nearest code by brute force over the whole codebook.
+	float BestError(float dx, float dy)
+	{
+		float best = Length(dx, dy);
+		for (uint32_t code = 1; code <= RoomscaleCodec::kMaxCode; ++code)
+		{
+			float cx = 0.0f, cy = 0.0f;
+			RoomscaleCodec::DecodeCode(code, cx, cy);
+			best = std::min(best, Length(dx - cx, dy - cy));
+		}
+		return best;
+	}
+}
+
+VR_TEST(EveryCodeRoundTrips)
+{
+	std::set<std::pair<float, float>> deltas;
+	for (int e = 0; e < RoomscaleCodec::kExponents; ++e)
+	{
+		const float step = RoomscaleCodec::StepMeters(e);
+		VR_CHECK_NEAR(step, 0.0025 * (1 << e), 1e-7);
+		for (int d = 0; d < RoomscaleCodec::kDirections; ++d)
+		{
+			const uint32_t code = 1 + static_cast<uint32_t>(e * RoomscaleCodec::kDirections + d);
+			float dx = 0.0f, dy = 0.0f;
+			VR_CHECK(RoomscaleCodec::DecodeCode(code, dx, dy));
+
+			// A ternary pair times the step, never (0, 0).
+			VR_CHECK(dx == 0.0f || dx == step || dx == -step);
+			VR_CHECK(dy == 0.0f || dy == step || dy == -step);
+			VR_CHECK(dx != 0.0f || dy != 0.0f);
+			deltas.insert({ dx, dy });
+
+			// The decoded delta quantizes back to the same code.
+			VR_CHECK(RoomscaleCodec::QuantizeCode(dx, dy) == code);
+
+			// Through the buttons word, next to real button bits, and back.
+			const uint32_t buttons = kOtherButtons | RoomscaleCodec::Pack(code);
+			VR_CHECK((buttons & ~RoomscaleCodec::kButtonsMask) == kOtherButtons);
+			VR_CHECK(RoomscaleCodec::Unpack(buttons) == code);
+			float bx = 0.0f, by = 0.0f;
+			VR_CHECK(RoomscaleCodec::Decode(buttons, bx, by));
+			VR_CHECK(bx == dx && by == dy);
+		}
+	}
+	// 56 distinct deltas.
+	VR_CHECK(deltas.size() == static_cast<size_t>(RoomscaleCodec::kMaxCode));
+
+	// "No movement" and the reserved codes decode to nothing; no button bit leaks into the field.
+	float dx = 1.0f, dy = 1.0f;
+	VR_CHECK(!RoomscaleCodec::DecodeCode(0, dx, dy));
+	for (uint32_t code = RoomscaleCodec::kMaxCode + 1; code < 64; ++code)
+		VR_CHECK(!RoomscaleCodec::Decode(RoomscaleCodec::Pack(code), dx, dy));
+	VR_CHECK(dx == 1.0f && dy == 1.0f);
+	VR_CHECK(RoomscaleCodec::Unpack(kOtherButtons) == 0);
+	VR_CHECK(RoomscaleCodec::Pack(0) == 0);
+	VR_CHECK(RoomscaleCodec::QuantizeCode(0.0f, 0.0f) == 0);
+	VR_CHECK(RoomscaleCodec::QuantizeCode(0.001f, -0.001f) == 0);
+}
+
+VR_TEST(QuantizePicksTheNearestCode)
+{
+	std::mt19937 rng(47);
+	std::uniform_real_distribution<float> component(-0.25f, 0.25f);
+	std::uniform_real_distribution<float> small(-0.01f, 0.01f);
+	double worstExcess = 0.0;
+	for (int i = 0; i < 20000; ++i)
+	{
+		const float dx = (i % 2) ? component(rng) : small(rng);
+		const float dy = (i % 2) ? component(rng) : small(rng);
+		const uint32_t code = RoomscaleCodec::QuantizeCode(dx, dy);
+		float cx = 0.0f, cy = 0.0f;
+		if (code != 0)
+			RoomscaleCodec::DecodeCode(code, cx, cy);
+		const float err = Length(dx - cx, dy - cy);
+		worstExcess = std::max(worstExcess, static_cast<double>(err - BestError(dx, dy)));
+	}
+	VR_CHECK(worstExcess <= 1e-6);
+
+	// Ties keep the smaller step: 1.5 steps of exponent 0 is as close to 1 step as to 2.
+	float tx = 0.0f, ty = 0.0f;
+	RoomscaleCodec::DecodeCode(RoomscaleCodec::QuantizeCode(0.00375f, 0.0f), tx, ty);
+	VR_CHECK(tx == RoomscaleCodec::StepMeters(0) && ty == 0.0f);
+}
+
+VR_TEST(EncoderErrorStaysBoundedOverARandomWalk)
+{
+	// 200k commands of a player wandering the play space: standing with tracking noise, slow
+	// shuffles, walking and the odd lunge, with direction changes along the way. Every move stays
+	// within one command's largest step, so nothing is clamped and the feedback alone has to keep up.
+	std::mt19937 rng(4747);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::normal_distribution<float> noise(0.0f, 0.0004f);
+	RoomscaleDeltaEncoder encoder;
+	double wantedX = 0.0, wantedY = 0.0, sentX = 0.0, sentY = 0.0;
+	double worstError = 0.0, worstAccounting = 0.0, worstResidual = 0.0;
+	float heading = 0.0f, speed = 0.0f;
+	int codes = 0;
+	constexpr int kSteps = 200000;
+	for (int i = 0; i < kSteps; ++i)
+	{
+		if (i % 90 == 0)
+		{
+			const float r = unit(rng);
+			speed = r < 0.3f ? 0.0f : (r < 0.6f ? 0.004f : (r < 0.95f ? 0.045f : 0.15f));   // meters per command
+			heading = unit(rng) * 6.2831853f;
+		}
+		heading += (unit(rng) - 0.5f) * 0.2f;
+		const float dx = std::cos(heading) * speed + noise(rng);
+		const float dy = std::sin(heading) * speed + noise(rng);
+		wantedX += dx;
+		wantedY += dy;
+
+		float sx = 0.0f, sy = 0.0f;
+		const uint32_t code = encoder.Encode(dx, dy, sx, sy);
+		codes += code != 0 ? 1 : 0;
+		// What is sent is exactly what the receiver decodes from the buttons.
+		float rx = 0.0f, ry = 0.0f;
+		if (RoomscaleCodec::Decode(kOtherButtons | RoomscaleCodec::Pack(code), rx, ry))
+		{
+			sentX += rx;
+			sentY += ry;
+		}
+		VR_CHECK(rx == sx && ry == sy);
+
+		const double errX = wantedX - sentX, errY = wantedY - sentY;
+		worstError = std::max(worstError, std::sqrt(errX * errX + errY * errY));
+		worstResidual = std::max(worstResidual, static_cast<double>(Length(encoder.ResidualX(), encoder.ResidualY())));
+		// The residual is the accumulated error (up to float rounding).
+		worstAccounting = std::max(worstAccounting, std::max(std::fabs(errX - encoder.ResidualX()), std::fabs(errY - encoder.ResidualY())));
+	}
+	std::printf("  %d commands, %d codes sent: worst accumulated error %.2f mm, residual %.2f mm, accounting drift %.3g m\n",
+		kSteps, codes, worstError * 1000.0, worstResidual * 1000.0, worstAccounting);
+	VR_CHECK(worstError <= RoomscaleDeltaEncoder::kMaxResidualMeters);
+	VR_CHECK(worstAccounting < 1e-3);
+	// In practice the feedback keeps it within one largest step.
+	VR_CHECK(worstError <= RoomscaleCodec::MaxStepMeters());
+}
+
+VR_TEST(EncoderDropsMovementItCannotCatchUpWith)
+{
+	// A 5 m jump (a tracking glitch or recenter) is clamped: at most kMaxResidualMeters is carried,
+	// paid out over the next commands, and then the encoder goes quiet.
+	RoomscaleDeltaEncoder encoder;
+	float sx = 0.0f, sy = 0.0f;
+	VR_CHECK(encoder.Encode(5.0f, 0.0f, sx, sy) != 0);
+	VR_CHECK(sx == RoomscaleCodec::MaxStepMeters() && sy == 0.0f);
+	VR_CHECK(Length(encoder.ResidualX(), encoder.ResidualY()) <= RoomscaleDeltaEncoder::kMaxResidualMeters + 1e-5f);
+
+	double paid = sx;
+	int commands = 1;
+	while (encoder.Encode(0.0f, 0.0f, sx, sy) != 0 && commands < 100)
+	{
+		paid += sx;
+		++commands;
+	}
+	VR_CHECK_NEAR(paid, RoomscaleDeltaEncoder::kMaxResidualMeters + RoomscaleCodec::MaxStepMeters(), RoomscaleCodec::StepMeters(0));
+	VR_CHECK(commands < 10);
+	VR_CHECK(Length(encoder.ResidualX(), encoder.ResidualY()) < RoomscaleCodec::StepMeters(0));
+
+	encoder.Reset();
+	VR_CHECK(encoder.ResidualX() == 0.0f && encoder.ResidualY() == 0.0f);
+}
+
+VR_TEST(JitterBufferDropsBackupsAndReorderedCommands)
+{
+	RoomscaleJitterBuffer buffer;
+	RoomscaleJitterBuffer::Settings applyAll;
+	applyAll.spreadFrames = 1;
+
+	// 1..10 arrive; each packet also carries the previous two commands as backups.
+	int accepted = 0, dropped = 0;
+	for (int cmd = 1; cmd <= 10; ++cmd)
+	{
+		for (int backup = std::max(1, cmd - 2); backup <= cmd; ++backup)
+			(buffer.Push(backup, 0.01f, 0.0f) ? accepted : dropped)++;
+	}
+	VR_CHECK(accepted == 10);
+	VR_CHECK(dropped == 17);
+	float dx = 0.0f, dy = 0.0f;
+	VR_CHECK(buffer.Drain(applyAll, dx, dy));
+	VR_CHECK_NEAR(dx, 0.10, 1e-6);
+	VR_CHECK(!buffer.HasPending() && !buffer.Drain(applyAll, dx, dy));
+
+	// Reordered delivery: 12 arrives before 11. 11 is then behind the newest and is dropped rather
+	// than applied late (its movement is lost, not doubled).
+	VR_CHECK(buffer.Push(12, 0.0f, 0.02f));
+	VR_CHECK(!buffer.Push(11, 0.0f, 0.02f));
+	VR_CHECK(buffer.Push(13, 0.0f, 0.02f));
+	VR_CHECK(buffer.Drain(applyAll, dx, dy));
+	VR_CHECK_NEAR(dy, 0.04, 1e-6);
+
+	// Reset clears what is queued but keeps the command history.
+	VR_CHECK(buffer.Push(14, 0.05f, 0.0f));
+	buffer.Reset();
+	VR_CHECK(!buffer.HasPending());
+	VR_CHECK(!buffer.Push(14, 0.05f, 0.0f));
+}
+
+VR_TEST(JitterBufferSpreadsWhatItReleases)
+{
+	RoomscaleJitterBuffer::Settings settings;     // half per frame, 0.3 m backlog, 5 mm flush
+	RoomscaleJitterBuffer buffer;
+	float dx = 0.0f, dy = 0.0f;
+
+	// 8 cm queued: half per frame until the remainder is down to 5 mm, which goes whole.
+	VR_CHECK(buffer.Push(1, 0.08f, 0.0f));
+	const float expected[] = { 0.04f, 0.02f, 0.01f, 0.005f, 0.005f };
+	for (float e : expected)
+	{
+		VR_CHECK(buffer.Drain(settings, dx, dy));
+		VR_CHECK_NEAR(dx, e, 1e-6);
+	}
+	VR_CHECK(!buffer.HasPending());
+
+	// A burst beyond the backlog: everything past 0.3 m goes out in the first frame.
+	VR_CHECK(buffer.Push(2, 1.0f, 0.0f));
+	VR_CHECK(buffer.Drain(settings, dx, dy));
+	VR_CHECK_NEAR(1.0f - dx, 0.15, 1e-5);    // what stays queued is half the backlog
+
+	// Whatever the pattern, the total released equals the total accepted.
+	std::mt19937 rng(470);
+	std::uniform_real_distribution<float> step(-0.03f, 0.03f);
+	RoomscaleJitterBuffer smooth;
+	double pushed = 0.0, released = 0.0;
+	int cmd = 100;
+	for (int frame = 0; frame < 5000; ++frame)
+	{
+		// 0 to 3 commands land in a server frame.
+		for (int n = static_cast<int>(rng() % 4); n > 0; --n)
+		{
+			const float d = step(rng);
+			if (smooth.Push(++cmd, d, 0.0f))
+				pushed += d;
+		}
+		if (smooth.Drain(settings, dx, dy))
+			released += dx;
+	}
+	while (smooth.Drain(settings, dx, dy))
+		released += dx;
+	VR_CHECK_NEAR(released, pushed, 1e-4);
+}
+
+VR_TEST(JitterBufferAcceptsAClientRestart)
+{
+	RoomscaleJitterBuffer buffer;
+	VR_CHECK(buffer.Push(1000, 0.01f, 0.0f));
+
+	// Up to kRestartGap - 1 behind the newest: a stale backup, dropped.
+	VR_CHECK(!buffer.Push(1000 - (RoomscaleJitterBuffer::kRestartGap - 1), 0.01f, 0.0f));
+	VR_CHECK(!buffer.Push(1000, 0.01f, 0.0f));
+	// kRestartGap or more behind: the client reconnected and counts from the start again.
+	VR_CHECK(buffer.Push(1000 - RoomscaleJitterBuffer::kRestartGap, 0.01f, 0.0f));
+	VR_CHECK(buffer.Push(1000 - RoomscaleJitterBuffer::kRestartGap + 1, 0.01f, 0.0f));
+
+	// A fresh client from command 1, then its own backups are dropped again.
+	RoomscaleJitterBuffer other;
+	VR_CHECK(other.Push(5000, 0.0f, 0.0f));
+	VR_CHECK(other.Push(1, 0.01f, 0.0f));
+	VR_CHECK(other.Push(2, 0.01f, 0.0f));
+	VR_CHECK(!other.Push(1, 0.01f, 0.0f));
+	VR_CHECK(!other.Push(2, 0.01f, 0.0f));
+	RoomscaleJitterBuffer::Settings applyAll;
+	applyAll.spreadFrames = 1;
+	float dx = 0.0f, dy = 0.0f;
+	VR_CHECK(other.Drain(applyAll, dx, dy));
+	VR_CHECK_NEAR(dx, 0.02, 1e-6);
+}
+
+VR_TEST(ClientToServerEndToEnd)
+{
+	// Encoder -> buttons -> decode -> jitter buffer (with backups) -> drain: the server applies
+	// exactly what the client sent, and that stays within the encoder's residual of the walk.
+	std::mt19937 rng(4700);
+	std::uniform_real_distribution<float> move(-0.05f, 0.05f);
+	RoomscaleDeltaEncoder encoder;
+	RoomscaleJitterBuffer buffer;
+	RoomscaleJitterBuffer::Settings settings;
+	std::vector<uint32_t> sentButtons;
+	double wanted = 0.0, applied = 0.0;
+	for (int cmd = 1; cmd <= 20000; ++cmd)
+	{
+		const float d = move(rng);
+		wanted += d;
+		float sx = 0.0f, sy = 0.0f;
+		sentButtons.push_back(kOtherButtons | RoomscaleCodec::Pack(encoder.Encode(d, 0.0f, sx, sy)));
+		for (int c = std::max(1, cmd - 2); c <= cmd; ++c)
+		{
+			float dx = 0.0f, dy = 0.0f;
+			if (RoomscaleCodec::Decode(sentButtons[static_cast<size_t>(c - 1)], dx, dy))
+				buffer.Push(c, dx, dy);
+		}
+		float ax = 0.0f, ay = 0.0f;
+		if (buffer.Drain(settings, ax, ay))
+			applied += ax;
+	}
+	float ax = 0.0f, ay = 0.0f;
+	while (buffer.Drain(settings, ax, ay))
+		applied += ax;
+	VR_CHECK_NEAR(applied + encoder.ResidualX(), wanted, 1e-3);
+	VR_CHECK(std::fabs(applied - wanted) <= RoomscaleDeltaEncoder::kMaxResidualMeters);
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
@@ -0,0 +1,141 @@
+// ShadowQualityGovernor on scripted compositor frame-time traces, and reconfiguration.
+//
+// Each trace is a list of segments (duration, scene cost at the top tier, jitter) played at 90 Hz.
+// A frame costs sceneMs * tierScale[tier] + jitter; over the 11.1 ms budget it counts as missed, the
+// same rule UpdateShadowQualityGovernor feeds from Compositor_FrameTiming.
+#include "shadow_quality_governor.h"
+#include "test_common.h"
+
+#include <random>
+
+namespace
+{
+	constexpr float kHz = 90.0f;
+	constexpr float kBudgetMs = 1000.0f / kHz;
+	// Frame cost of each tier relative to the top (shadow work is a share of the frame, not all of it).
+	constexpr float kTierScale[4] = { 1.0f, 0.85f, 0.75f, 0.68f };
+
+	struct Segment
+	{
+		float seconds;
+		float sceneMs;
+		float jitterMs;
+	};
+
+	struct TraceResult
+	{
+		int ups = 0;
+		int downs = 0;
+		int finalTier = 0;
+		double firstDownAt = -1.0;
+		std::vector<int> tierPerSecond;
+	};
+
+	TraceResult Play(ShadowQualityGovernor& governor, const std::vector<Segment>& trace, unsigned seed = 1)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		TraceResult r;
+		double t = 0.0;
+		int frame = 0;
+		for (const Segment& seg : trace)
+		{
+			const int frames = static_cast<int>(seg.seconds * kHz);
+			for (int i = 0; i < frames; ++i, ++frame)
+			{
+				t = frame / static_cast<double>(kHz);
+				const float cost = seg.sceneMs * kTierScale[governor.GetTierIndex()] + seg.jitterMs * unit(rng);
+				const int step = governor.Feed(t, cost * 0.6f, cost, kBudgetMs, false);
+				if (step > 0)
+					++r.ups;
+				if (step < 0)
+				{
+					++r.downs;
+					if (r.firstDownAt < 0.0)
+						r.firstDownAt = t;
+				}
+				if (frame % static_cast<int>(kHz) == 0)
+					r.tierPerSecond.push_back(governor.GetTierIndex());
+			}
+		}
+		r.finalTier = governor.GetTierIndex();
+		return r;
+	}
+
+	ShadowQualityGovernor MakeGovernor()
+	{
+		ShadowQualityGovernor g;
+		g.Configure(ShadowQualityTier{}, 4, ShadowGovernorSettings{});
+		return g;
+	}
+}
+
+VR_TEST(LightSceneStaysOnTop)
+{
+	ShadowQualityGovernor g = MakeGovernor();
+	const TraceResult r = Play(g, { { 60.0f, 7.0f, 0.8f } });
+	VR_CHECK(r.ups == 0 && r.downs == 0 && r.finalTier == 0);
+}
+
+VR_TEST(HordeSpikeStepsDownAndRecovers)
+{
+	// Calm corridor, a 10 s horde that blows the budget at full quality, then calm again.
+	ShadowQualityGovernor g = MakeGovernor();
+	const TraceResult r = Play(g, { { 10.0f, 7.0f, 0.8f }, { 10.0f, 13.5f, 1.0f }, { 40.0f, 7.0f, 0.8f } });
+	std::printf("  spike: first step down at %.2f s, %d down / %d up, final tier %d\n", r.firstDownAt, r.downs, r.ups, r.finalTier);
+	VR_CHECK(r.firstDownAt >= 10.0 && r.firstDownAt < 11.5);
+	VR_CHECK(r.downs >= 1);
+	VR_CHECK(r.tierPerSecond[19] >= 1);
+	VR_CHECK(r.finalTier == 0);
+}
+
+VR_TEST(SceneOnTheEdgeSettles)
+{
+	// Full quality misses a fifth of the frames; one tier down fits but without the headroom to climb.
+	ShadowQualityGovernor g = MakeGovernor();
+	const TraceResult r = Play(g, { { 120.0f, 11.6f, 0.6f } });
+	std::printf("  edge: %d down / %d up, final tier %d\n", r.downs, r.ups, r.finalTier);
+	VR_CHECK(r.downs + r.ups <= 2);
+	VR_CHECK(r.finalTier >= 1);
+}
+
+VR_TEST(FlappingSceneBacksOff)
+{
+	// The top tier misses often enough to step down, the next one is calm enough to step back up.
+	// Every failed climb doubles the wait, so three minutes see a handful of climbs, not thirty.
+	ShadowQualityGovernor g = MakeGovernor();
+	const TraceResult r = Play(g, { { 180.0f, 10.3f, 1.5f } });
+	std::printf("  flapping: %d down / %d up, backoff %.0fx\n", r.downs, r.ups, g.GetBackoff(0));
+	VR_CHECK(r.ups >= 1 && r.ups <= 5);
+	VR_CHECK(g.GetBackoff(0) >= 4.0f);
+}
+
+VR_TEST(ReconfigureKeepsStateUnlessTheTiersChange)
+{
+	ShadowQualityGovernor g = MakeGovernor();
+	Play(g, { { 5.0f, 14.0f, 0.5f } });
+	const int tier = g.GetTierIndex();
+	VR_CHECK(tier >= 1);
+
+	// A config reparse with the same shadow keys: nothing to rebuild.
+	VR_CHECK(!g.Configure(ShadowQualityTier{}, 4, ShadowGovernorSettings{}));
+	VR_CHECK(g.GetTierIndex() == tier);
+
+	// A different top tier, tier count or settings rebuilds from the top.
+	ShadowQualityTier top;
+	top.flashlightDepthRes = 2048;
+	VR_CHECK(g.Configure(top, 4, ShadowGovernorSettings{}));
+	VR_CHECK(g.GetTierIndex() == 0);
+	Play(g, { { 5.0f, 14.0f, 0.5f } });
+	VR_CHECK(g.GetTierIndex() >= 1);
+	VR_CHECK(g.Configure(top, 3, ShadowGovernorSettings{}));
+	VR_CHECK(g.GetTierIndex() == 0 && g.GetTierCount() == 3);
+	ShadowGovernorSettings settings;
+	settings.upHeadroom = 0.7f;
+	VR_CHECK(g.Configure(top, 3, settings));
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
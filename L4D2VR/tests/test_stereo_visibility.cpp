@@ -0,0 +1,310 @@
+// Stereo visibility: the combined frustum must contain both eye frusta (checked on random poses and
+// IPDs), the capture cache must only hand a capture to the same frame and pose, the renderable list
+// must find every draw whatever order the second eye submits it in, and the eye cost stats must
+// report the second eye's saving.
+#include "stereo_visibility.h"
+#include "test_common.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr float kDeg2Rad = 3.14159265358979323846f / 180.0f;
+
+	// Source's AngleVectors (pitch, yaw, roll in degrees).
+	void AngleBasis(float pitch, float yaw, float roll, StereoVec3& forward, StereoVec3& right, StereoVec3& up)
+	{
+		const float sp = std::sin(pitch * kDeg2Rad), cp = std::cos(pitch * kDeg2Rad);
+		const float sy = std::sin(yaw * kDeg2Rad), cy = std::cos(yaw * kDeg2Rad);
+		const float sr = std::sin(roll * kDeg2Rad), cr = std::cos(roll * kDeg2Rad);
+		forward = { cp * cy, cp * sy, -sp };
+		right = { -sr * sp * cy + cr * sy, -sr * sp * sy - cr * cy, -sr * cp };
+		up = { cr * sp * cy + sr * sy, cr * sp * sy - sr * cy, cr * cp };
+	}
+
+	struct EyePair
+	{
+		StereoEyeView left;
+		StereoEyeView right;
+	};
+
+	// Both eyes share orientation and projection; origins sit ipd apart along the view's right axis,
+	// the way dRenderView builds them.
+	EyePair RandomEyes(std::mt19937& rng, float ipd)
+	{
+		std::uniform_real_distribution<float> pitch(-89.0f, 89.0f);
+		std::uniform_real_distribution<float> yaw(-180.0f, 180.0f);
+		std::uniform_real_distribution<float> roll(-30.0f, 30.0f);
+		std::uniform_real_distribution<float> fov(80.0f, 120.0f);
+		std::uniform_real_distribution<float> aspect(0.8f, 1.25f);
+		std::uniform_real_distribution<float> pos(-4000.0f, 4000.0f);
+
+		StereoEyeView center;
+		AngleBasis(pitch(rng), yaw(rng), roll(rng), center.forward, center.right, center.up);
+		center.origin = { pos(rng), pos(rng), pos(rng) * 0.25f };
+		center.fovXDeg = fov(rng);
+		center.aspect = aspect(rng);
+
+		EyePair eyes{ center, center };
+		eyes.left.origin = center.origin - center.right * (ipd * 0.5f);
+		eyes.right.origin = center.origin + center.right * (ipd * 0.5f);
+		return eyes;
+	}
+
+	// A random point inside view's frustum.
+	StereoVec3 PointInside(std::mt19937& rng, const StereoEyeView& view)
+	{
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		std::uniform_real_distribution<float> depth(view.zNear, 2000.0f);
+		const float d = depth(rng);
+		return view.origin + view.forward * d + view.right * (unit(rng) * d * view.TanHalfX())
+			+ view.up * (unit(rng) * d * view.TanHalfY());
+	}
+
+	struct DrawInfo
+	{
+		std::string modelName;
+		int classifications = 0;
+	};
+	using DrawList = StereoRenderableList<DrawInfo>;
+}
+
+VR_TEST(CombinedViewContainsBothEyeFrusta)
+{
+	std::mt19937 rng(30);
+	std::uniform_real_distribution<float> ipd(1.5f, 6.0f);
+	int containedEyes = 0;
+	int containedPoints = 0;
+	constexpr int kPoses = 2000;
+	constexpr int kPointsPerEye = 16;
+	for (int i = 0; i < kPoses; ++i)
+	{
+		const EyePair eyes = RandomEyes(rng, ipd(rng));
+		StereoEyeView combined;
+		VR_CHECK(BuildCombinedStereoView(eyes.left, eyes.right, combined));
+		const StereoFrustum frustum = BuildStereoFrustum(combined);
+		for (const StereoEyeView* eye : { &eyes.left, &eyes.right })
+		{
+			containedEyes += StereoFrustumContains(frustum, *eye) ? 1 : 0;
+			for (int p = 0; p < kPointsPerEye; ++p)
+				containedPoints += frustum.ContainsPoint(PointInside(rng, *eye), 5e-2f) ? 1 : 0;
+		}
+	}
+	VR_CHECK(containedEyes == kPoses * 2);
+	VR_CHECK(containedPoints == kPoses * 2 * kPointsPerEye);
+}
+
+VR_TEST(PullbackIsTheClosedFormAndTight)
+{
+	std::mt19937 rng(31);
+	for (float ipd : { 2.5f, 4.0f, 6.0f })
+	{
+		const EyePair eyes = RandomEyes(rng, ipd);
+		StereoEyeView combined;
+		float pullback = 0.0f;
+		VR_CHECK(BuildCombinedStereoView(eyes.left, eyes.right, combined, &pullback));
+
+		// Pure sideways offset: the horizontal planes bind, ipd/2 / tan(fovX/2).
+		const float expected = ipd * 0.5f / eyes.left.TanHalfX();
+		VR_CHECK_NEAR(pullback, expected, 1e-3);
+
+		// The apex is on the midpoint's axis.
+		const StereoVec3 mid = (eyes.left.origin + eyes.right.origin) * 0.5f;
+		const StereoVec3 apexOffset = mid - combined.origin;
+		VR_CHECK_NEAR(apexOffset.Dot(eyes.left.forward), pullback, 1e-2);
+		VR_CHECK_NEAR(apexOffset.Dot(eyes.left.right), 0.0, 1e-2);
+
+		// Ten percent less pullback no longer contains the eyes' far corners.
+		StereoEyeView shallow = combined;
+		shallow.origin = mid - eyes.left.forward * (pullback * 0.9f);
+		const StereoFrustum shallowFrustum = BuildStereoFrustum(shallow);
+		VR_CHECK(!StereoFrustumContains(shallowFrustum, eyes.left) || !StereoFrustumContains(shallowFrustum, eyes.right));
+	}
+}
+
+VR_TEST(MismatchedEyesAreRejected)
+{
+	std::mt19937 rng(32);
+	const EyePair eyes = RandomEyes(rng, 2.5f);
+	StereoEyeView out;
+	out.zNear = -123.0f;
+
+	StereoEyeView turned = eyes.right;
+	AngleBasis(10.0f, 45.0f, 0.0f, turned.forward, turned.right, turned.up);
+	VR_CHECK(!BuildCombinedStereoView(eyes.left, turned, out));
+
+	StereoEyeView wider = eyes.right;
+	wider.fovXDeg += 5.0f;
+	VR_CHECK(!BuildCombinedStereoView(eyes.left, wider, out));
+
+	StereoEyeView squat = eyes.right;
+	squat.aspect *= 1.5f;
+	VR_CHECK(!BuildCombinedStereoView(eyes.left, squat, out));
+
+	// Untouched on failure.
+	VR_CHECK(out.zNear == -123.0f);
+}
+
+VR_TEST(SphereTestIsConservative)
+{
+	// Anything either eye can see must survive the combined cull; some of what neither sees is culled.
+	std::mt19937 rng(33);
+	std::uniform_real_distribution<float> radius(1.0f, 64.0f);
+	int kept = 0;
+	int culledBehind = 0;
+	constexpr int kSpheres = 20000;
+	for (int i = 0; i < kSpheres; ++i)
+	{
+		const EyePair eyes = RandomEyes(rng, 3.0f);
+		StereoEyeView combined;
+		BuildCombinedStereoView(eyes.left, eyes.right, combined);
+		const StereoFrustum frustum = BuildStereoFrustum(combined);
+		const StereoEyeView& eye = (i & 1) ? eyes.right : eyes.left;
+		kept += frustum.IntersectsSphere(PointInside(rng, eye), radius(rng)) ? 1 : 0;
+
+		const StereoVec3 behind = eyes.left.origin - eyes.left.forward * 500.0f;
+		culledBehind += frustum.IntersectsSphere(behind, 16.0f) ? 0 : 1;
+	}
+	VR_CHECK(kept == kSpheres);
+	VR_CHECK(culledBehind == kSpheres);
+}
+
+VR_TEST(CacheHandsOutCapturesForTheSameFrameAndPoseOnly)
+{
+	std::mt19937 rng(34);
+	const EyePair eyes = RandomEyes(rng, 2.5f);
+	StereoEyeView combined;
+	VR_CHECK(BuildCombinedStereoView(eyes.left, eyes.right, combined));
+
+	StereoVisibilityCache<DrawList> cache;
+	cache.BeginFrame(7, combined);
+	VR_CHECK(cache.TryReuse(7, combined) == nullptr);   // nothing captured yet
+
+	DrawList& lists = cache.BeginCapture();
+	lists.Clear();
+	lists.Append(DrawList::MakeKey(3, &lists)).modelName = "models/survivors/survivor_coach.mdl";
+	VR_CHECK(cache.TryReuse(7, combined) == nullptr);   // capture still open
+	cache.EndCapture();
+
+	const DrawList* reused = cache.TryReuse(7, combined);
+	VR_CHECK(reused != nullptr);
+	VR_CHECK(reused && reused->Size() == 1);
+	VR_CHECK(cache.TryReuse(8, combined) == nullptr);
+
+	StereoEyeView moved = combined;
+	moved.origin = moved.origin + moved.forward * 1.0f;
+	VR_CHECK(cache.TryReuse(7, moved) == nullptr);
+
+	StereoEyeView wider = combined;
+	wider.fovXDeg += 1.0f;
+	VR_CHECK(cache.TryReuse(7, wider) == nullptr);
+
+	// A new frame drops the previous capture.
+	cache.BeginFrame(8, combined);
+	VR_CHECK(cache.TryReuse(8, combined) == nullptr);
+	cache.BeginCapture();
+	cache.EndCapture();
+	VR_CHECK(cache.TryReuse(8, combined) != nullptr);
+	cache.Invalidate();
+	VR_CHECK(cache.TryReuse(8, combined) == nullptr);
+
+	const auto& c = cache.GetCounters();
+	VR_CHECK(c.frames == 2);
+	VR_CHECK(c.captures == 2);
+	VR_CHECK(c.reuses == 2);
+	VR_CHECK(c.misses == 7);
+}
+
+VR_TEST(RenderableListFindsEveryDrawInAnyOrder)
+{
+	// A frame's worth of draws: entity index + model pointer, a few world draws (index -1) sharing models.
+	std::mt19937 rng(35);
+	static const char kModels[8] = {};
+	std::vector<uint64_t> keys;
+	for (int i = 1; i <= 300; ++i)
+		keys.push_back(DrawList::MakeKey(i, &kModels[i & 7]));
+	for (int i = 0; i < 8; ++i)
+		keys.push_back(DrawList::MakeKey(-1, &kModels[i]));
+
+	DrawList list;
+	int classifications = 0;
+	for (uint64_t key : keys)
+	{
+		bool inserted = false;
+		DrawInfo& info = list.Append(key, &inserted);
+		VR_CHECK(inserted);
+		info.modelName = "models/infected/common_male01.mdl#" + std::to_string(key & 0xffff);
+		info.classifications = ++classifications;
+	}
+	VR_CHECK(list.Size() == keys.size());
+
+	// A repeated draw of the same entity and model keeps its first slot.
+	bool inserted = true;
+	VR_CHECK(list.Append(keys[5], &inserted).classifications == 6);
+	VR_CHECK(!inserted);
+	VR_CHECK(list.Size() == keys.size());
+
+	// Same order: every lookup is the cursor's next entry.
+	size_t cursor = 0;
+	int hits = 0;
+	for (size_t i = 0; i < keys.size(); ++i)
+	{
+		const DrawInfo* info = list.Find(keys[i], cursor);
+		hits += (info && info->classifications == int(i) + 1) ? 1 : 0;
+		VR_CHECK(cursor == i + 1);
+	}
+	VR_CHECK(hits == int(keys.size()));
+
+	// Shuffled, with a key the first eye never drew.
+	std::vector<uint64_t> shuffled = keys;
+	std::shuffle(shuffled.begin(), shuffled.end(), rng);
+	cursor = 0;
+	hits = 0;
+	for (uint64_t key : shuffled)
+	{
+		const DrawInfo* info = list.Find(key, cursor);
+		hits += (info && info->modelName.size() > 0) ? 1 : 0;
+	}
+	VR_CHECK(hits == int(keys.size()));
+	VR_CHECK(list.Find(DrawList::MakeKey(301, &kModels[0]), cursor) == nullptr);
+
+	// Clear keeps the payload storage: the next frame's names land in the same buffers.
+	const char* firstBuffer = list.Find(keys[0], cursor = 0)->modelName.data();
+	list.Clear();
+	VR_CHECK(list.Size() == 0);
+	VR_CHECK(list.Find(keys[0], cursor = 0) == nullptr);
+	list.Append(keys[0]).modelName = "models/infected/common_male02.mdl";
+	VR_CHECK(list.Find(keys[0], cursor = 0)->modelName.data() == firstBuffer);
+}
+
+VR_TEST(EyeCostStatsReportTheSecondEyeSaving)
+{
+	StereoEyeCostStats stats;
+	VR_CHECK(stats.GetSecondEyeSavingsPercent(false) == 0.0);
+
+	stats.Record(StereoEyeCostStats::Eye_First, 4.0);
+	VR_CHECK(stats.GetSecondEyeSavingsPercent(true) == 0.0);   // no second-eye sample yet
+	stats.Record(StereoEyeCostStats::Eye_Second, 3.0);
+	stats.Record(StereoEyeCostStats::Eye_SecondReused, 2.0);
+	VR_CHECK_NEAR(stats.GetSecondEyeSavingsPercent(false), 25.0, 1e-9);
+	VR_CHECK_NEAR(stats.GetSecondEyeSavingsPercent(true), 50.0, 1e-9);
+
+	// Bad samples are dropped.
+	stats.Record(StereoEyeCostStats::Eye_First, std::nan(""));
+	stats.Record(StereoEyeCostStats::Eye_First, -1.0);
+	VR_CHECK(stats.Get(StereoEyeCostStats::Eye_First).samples == 1);
+
+	// The average follows a step change.
+	for (int i = 0; i < 100; ++i)
+		stats.Record(StereoEyeCostStats::Eye_SecondReused, 1.0);
+	VR_CHECK_NEAR(stats.Get(StereoEyeCostStats::Eye_SecondReused).avgMs, 1.0, 1e-3);
+	VR_CHECK_NEAR(stats.GetSecondEyeSavingsPercent(true), 75.0, 0.1);
+
+	stats.Reset();
+	VR_CHECK(stats.Get(StereoEyeCostStats::Eye_First).samples == 0);
+}
+
+int main() { return vrtest::RunAllTests(); }
@@ -0,0 +1,112 @@
+// GenerationPublisher: reclamation rules and concurrent readers.
+#include "texture_generation.h"
+#include "test_common.h"
+
+#include <thread>
+
+namespace
+{
+	struct Tracked
+	{
+		static int& Live()
+		{
+			static int live = 0;
+			return live;
+		}
+
+		explicit Tracked(int v) : value(v) { ++Live(); }
+		~Tracked() { --Live(); }
+
+		int value;
+		int copies[7] = { 0 };
+	};
+}
+
+VR_TEST(RetiredGenerationWaitsForGraceFrames)
+{
+	{
+		GenerationPublisher<Tracked> pub;
+		VR_CHECK(pub.Publish(std::make_unique<Tracked>(1)) == 1);
+		VR_CHECK(pub.Publish(std::make_unique<Tracked>(2)) == 2);
+		VR_CHECK(pub.GetRetiredCount() == 1);
+		VR_CHECK(Tracked::Live() == 2);
+
+		pub.NoteConsumerFrame();
+		VR_CHECK(pub.Reclaim() == 0);
+		pub.NoteConsumerFrame();
+		VR_CHECK(pub.Reclaim() == 1);
+		VR_CHECK(Tracked::Live() == 1);
+		VR_CHECK(pub.GetReclaimedTotal() == 1);
+	}
+	VR_CHECK(Tracked::Live() == 0);
+}
+
+VR_TEST(ActiveReaderBlocksReclaim)
+{
+	GenerationPublisher<Tracked> pub;
+	pub.Publish(std::make_unique<Tracked>(1));
+	{
+		GenerationPublisher<Tracked>::ReadGuard guard(pub);
+		VR_CHECK(guard.Get()->value == 1);
+		pub.Publish(std::make_unique<Tracked>(2));
+		pub.NoteConsumerFrame();
+		pub.NoteConsumerFrame();
+		VR_CHECK(pub.Reclaim() == 0);
+		VR_CHECK(guard.Get()->value == 1);
+		VR_CHECK(guard.Refresh()->value == 2);
+	}
+	VR_CHECK(pub.Reclaim() == 1);
+}
+
+VR_TEST(EmptyPublisherReadsNull)
+{
+	GenerationPublisher<Tracked> pub;
+	GenerationPublisher<Tracked>::ReadGuard guard(pub);
+	VR_CHECK(guard.Get() == nullptr);
+	VR_CHECK(pub.GetGeneration() == 0);
+}
+
+VR_TEST(ConcurrentReadersSeeWholeGenerations)
+{
+	GenerationPublisher<Tracked> pub;
+	pub.Publish(std::make_unique<Tracked>(0));
+	std::atomic<bool> stop{ false };
+	std::atomic<int> torn{ 0 };
+
+	std::thread reader([&]()
+		{
+			while (!stop.load(std::memory_order_relaxed))
+			{
+				GenerationPublisher<Tracked>::ReadGuard guard(pub);
+				const Tracked* t = guard.Get();
+				for (int c : t->copies)
+				{
+					if (c != t->value)
+						++torn;
+				}
+				pub.NoteConsumerFrame();
+			}
+		});
+
+	for (int i = 1; i <= 5000; ++i)
+	{
+		auto next = std::make_unique<Tracked>(i);
+		for (int& c : next->copies)
+			c = i;
+		pub.Publish(std::move(next));
+	}
+	stop.store(true);
+	reader.join();
+	pub.NoteConsumerFrame();
+	pub.NoteConsumerFrame();
+	pub.Reclaim();
+
+	VR_CHECK(torn.load() == 0);
+	VR_CHECK(pub.GetRetiredCount() == 0);
+	VR_CHECK(Tracked::Live() == 1);
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
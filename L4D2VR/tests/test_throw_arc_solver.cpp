@@ -0,0 +1,88 @@
+// ThrowArcSolver: first hit against a floor, and the landing-plane fallback for arcs that hit nothing.
+#include "throw_arc_solver.h"
+#include "test_common.h"
+
+namespace
+{
+	ThrowArcLaunch MakeLaunch(float pitchDeg, float speed)
+	{
+		const float a = pitchDeg * 3.14159265f / 180.0f;
+		ThrowArcLaunch launch;
+		launch.origin = { 0.0f, 0.0f, 60.0f };
+		launch.velocity = { std::cos(a) * speed, 0.0f, std::sin(a) * speed };
+		return launch;
+	}
+
+	// Floor at z = floorZ.
+	struct Floor
+	{
+		float floorZ = 0.0f;
+		int traces = 0;
+
+		bool operator()(const ThrowArcVec3& a, const ThrowArcVec3& b, float& fraction, ThrowArcVec3& normal)
+		{
+			++traces;
+			if (b.z > floorZ || a.z < floorZ)
+				return false;
+			fraction = (a.z - floorZ) / std::max(a.z - b.z, 1e-6f);
+			normal = { 0.0f, 0.0f, 1.0f };
+			return true;
+		}
+	};
+}
+
+VR_TEST(FirstHitLandsOnTheFloorWithinBudget)
+{
+	ThrowArcProfile profile;
+	profile.drag = 0.15f;
+	Floor floor;
+	const ThrowArcLaunch launch = MakeLaunch(20.0f, 700.0f);
+	const ThrowArcHit hit = ThrowArcSolver::FindFirstHit(launch, profile, 16, floor);
+	VR_CHECK(hit.hit);
+	VR_CHECK(hit.traces <= 16 && floor.traces == hit.traces);
+	VR_CHECK_NEAR(hit.point.z, 0.0, 1e-3);
+	VR_CHECK_NEAR(ThrowArcSolver::Position(launch, profile, hit.time).z, 0.0, 2.0);
+}
+
+VR_TEST(ApexAndPlaneCrossingMatchTheClosedForm)
+{
+	// Vacuum: z(t) = 60 + vz t - g t^2 / 2.
+	ThrowArcProfile profile;
+	const ThrowArcLaunch launch = MakeLaunch(30.0f, 700.0f);
+	const float vz = launch.velocity.z;
+	VR_CHECK_NEAR(ThrowArcSolver::ApexTime(launch, profile), vz / profile.gravity, 1e-4);
+
+	float t = 0.0f;
+	VR_CHECK(ThrowArcSolver::PlaneCrossingTime(launch, profile, 60.0f - 90.0f, t));
+	const float expected = (vz + std::sqrt(vz * vz + 2.0f * profile.gravity * 90.0f)) / profile.gravity;
+	VR_CHECK_NEAR(t, expected, 1e-3);
+
+	// With drag the apex is where the vertical velocity is zero.
+	profile.drag = 0.15f;
+	const float apex = ThrowArcSolver::ApexTime(launch, profile);
+	VR_CHECK_NEAR(ThrowArcSolver::Velocity(launch, profile, apex).z, 0.0, 1e-2);
+	VR_CHECK(ThrowArcSolver::PlaneCrossingTime(launch, profile, -30.0f, t));
+	VR_CHECK_NEAR(ThrowArcSolver::Position(launch, profile, t).z, -30.0, 1e-2);
+	VR_CHECK(t > apex);
+}
+
+VR_TEST(PlaneCrossingRejectsUnreachablePlanes)
+{
+	ThrowArcProfile profile;
+	float t = 0.0f;
+	// A plane above the apex is never reached; a plane far below is not reached within maxTime.
+	VR_CHECK(!ThrowArcSolver::PlaneCrossingTime(MakeLaunch(30.0f, 700.0f), profile, 5000.0f, t));
+	VR_CHECK(!ThrowArcSolver::PlaneCrossingTime(MakeLaunch(30.0f, 700.0f), profile, -1e6f, t));
+	// A plane above the hand but below the apex is crossed on the way down.
+	const ThrowArcLaunch launch = MakeLaunch(45.0f, 400.0f);
+	VR_CHECK(ThrowArcSolver::PlaneCrossingTime(launch, profile, 100.0f, t));
+	VR_CHECK(t > ThrowArcSolver::ApexTime(launch, profile));
+	// Thrown downward: crossing found from the start.
+	VR_CHECK(ThrowArcSolver::PlaneCrossingTime(MakeLaunch(-30.0f, 700.0f), profile, 0.0f, t));
+	VR_CHECK_NEAR(ThrowArcSolver::Position(MakeLaunch(-30.0f, 700.0f), profile, t).z, 0.0, 1e-2);
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
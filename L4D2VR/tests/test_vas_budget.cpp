@@ -0,0 +1,435 @@
+// VasBudget / VasMappedTrim: pressure thresholds on both the free total and the largest block,
+// hysteresis on the way down, the sampling / region-walk schedule, listeners, the mapped-memory
+// trim and retrim decisions, and a long session on a simulated fragmented 32-bit address space
+// driven the way VR::UpdateVASBudget drives it.
+#include "vas_budget.h"
+#include "test_common.h"
+
+#include <deque>
+#include <random>
+
+namespace
+{
+	constexpr uint64_t kMiB = 1ull << 20;
+
+	VasSample Sample(uint64_t totalMiB, uint64_t largestMiB)
+	{
+		return { totalMiB * kMiB, largestMiB * kMiB };
+	}
+
+	// A 4 GB (large address aware) address space in 64 KB allocation granules, first fit.
+	class SimulatedAddressSpace
+	{
+	public:
+		static constexpr uint64_t kGranule = 64ull << 10;
+		static constexpr size_t kGranules = static_cast<size_t>((4ull << 30) / kGranule);
+
+		SimulatedAddressSpace() : m_Used(kGranules, false) {}
+
+		// Base granule, or -1 when no free run is long enough.
+		int64_t Alloc(uint64_t bytes)
+		{
+			const size_t need = static_cast<size_t>((bytes + kGranule - 1) / kGranule);
+			size_t run = 0;
+			for (size_t i = 0; i < kGranules; ++i)
+			{
+				run = m_Used[i] ? 0 : run + 1;
+				if (run == need)
+				{
+					const size_t base = i + 1 - need;
+					for (size_t g = base; g <= i; ++g)
+						m_Used[g] = true;
+					m_Free -= need;
+					return static_cast<int64_t>(base);
+				}
+			}
+			return -1;
+		}
+
+		void Free(int64_t base, uint64_t bytes)
+		{
+			const size_t need = static_cast<size_t>((bytes + kGranule - 1) / kGranule);
+			for (size_t g = static_cast<size_t>(base); g < static_cast<size_t>(base) + need; ++g)
+				m_Used[g] = false;
+			m_Free += need;
+		}
+
+		uint64_t FreeTotal() const { return static_cast<uint64_t>(m_Free) * kGranule; }
+
+		// The VirtualQuery walk.
+		uint64_t FreeLargest() const
+		{
+			size_t best = 0, run = 0;
+			for (size_t i = 0; i < kGranules; ++i)
+			{
+				run = m_Used[i] ? 0 : run + 1;
+				best = std::max(best, run);
+			}
+			return static_cast<uint64_t>(best) * kGranule;
+		}
+
+	private:
+		std::vector<bool> m_Used;
+		size_t m_Free = kGranules;
+	};
+
+	struct Block
+	{
+		int64_t base;
+		uint64_t bytes;
+	};
+
+	// DXVK's mapped texture chunks: mapped as textures are touched, unmapped least recently used first
+	// (by its own textureMemory cap, or by TrimMappedMemory).
+	class SimulatedMappedTextures
+	{
+	public:
+		SimulatedMappedTextures(SimulatedAddressSpace& space, uint64_t capBytes) : m_Space(space), m_Cap(capBytes) {}
+
+		bool Touch(uint64_t bytes)
+		{
+			const int64_t base = m_Space.Alloc(bytes);
+			if (base < 0)
+				return false;
+			m_Chunks.push_back({ base, bytes });
+			m_Mapped += bytes;
+			if (m_Mapped >= m_Cap)
+				Trim((m_Cap / 4) * 3);
+			return true;
+		}
+
+		uint32_t Trim(uint64_t targetBytes)
+		{
+			while (m_Mapped >= targetBytes && !m_Chunks.empty())
+			{
+				m_Space.Free(m_Chunks.front().base, m_Chunks.front().bytes);
+				m_Mapped -= m_Chunks.front().bytes;
+				m_Chunks.pop_front();
+			}
+			return static_cast<uint32_t>(m_Mapped);
+		}
+
+		uint32_t Mapped() const { return static_cast<uint32_t>(m_Mapped); }
+
+	private:
+		SimulatedAddressSpace& m_Space;
+		uint64_t m_Cap;
+		std::deque<Block> m_Chunks;
+		uint64_t m_Mapped = 0;
+	};
+
+	struct SessionResult
+	{
+		bool outOfSpace = false;
+		uint64_t startFree = 0;
+		uint64_t startLargest = 0;
+		double endTime = 0.0;
+		uint32_t transitions = 0;
+		uint32_t trims = 0;
+		uint32_t retrims = 0;
+		uint32_t walks = 0;
+		uint32_t samples = 0;
+		VasPressure peak = VasPressure::Normal;
+		double minRetrimGap = 1.0e9;
+		uint32_t minRetrimRegrowth = UINT32_MAX;
+	};
+
+	// A session on a fragmented address space: the game and DLLs leave ~600 MB free in scattered
+	// holes, the game keeps swapping level data in and out (its footprint stays about level), and
+	// DXVK maps 2 MB of textures every 100 ms with d3d9.textureMemory raised to 1 GB, so its own cap
+	// never kicks in before the address space runs out. Each step is one VR::Update: the budget
+	// samples when due and trims the way VR::UpdateVASBudget does.
+	SessionResult RunSession(bool trimEnabled, double seconds)
+	{
+		SimulatedAddressSpace space;
+		std::mt19937 rng(43);
+		std::uniform_int_distribution<int> blockMiB(1, 48);
+		std::vector<Block> game;
+		while (space.FreeTotal() > 300 * kMiB)
+		{
+			const uint64_t bytes = static_cast<uint64_t>(blockMiB(rng)) * kMiB;
+			game.push_back({ space.Alloc(bytes), bytes });
+		}
+		// Free every sixth block: holes everywhere, so the largest block is much smaller than the total.
+		std::vector<Block> kept;
+		for (size_t i = 0; i < game.size(); ++i)
+		{
+			if (i % 6 == 0)
+				space.Free(game[i].base, game[i].bytes);
+			else
+				kept.push_back(game[i]);
+		}
+		game.swap(kept);
+
+		// Level data streamed in and out; the static blocks above stay.
+		std::uniform_int_distribution<int> levelMiB(2, 24);
+		std::vector<Block> level;
+		for (int i = 0; i < 16; ++i)
+		{
+			const uint64_t bytes = static_cast<uint64_t>(levelMiB(rng)) * kMiB;
+			level.push_back({ space.Alloc(bytes), bytes });
+		}
+
+		SessionResult result;
+		result.startFree = space.FreeTotal();
+		result.startLargest = space.FreeLargest();
+		SimulatedMappedTextures textures(space, 1024 * kMiB);
+		VasBudget budget;
+		VasMappedTrim trim;
+		double lastRetrim = -1.0;
+		uint32_t lastTrimmedTo = 0;
+		double now = 0.0;
+		auto doTrim = [&](VasPressure pressure)
+			{
+				const uint32_t mapped = textures.Trim(VasMappedTrim::TargetBytes(pressure));
+				trim.Trimmed(mapped, now);
+				lastTrimmedTo = mapped;
+			};
+		budget.Subscribe([&](VasPressure previous, VasPressure current)
+			{
+				if (trimEnabled && VasMappedTrim::TrimOnTransition(previous, current))
+					doTrim(current);
+			});
+
+		for (int step = 0; now < seconds; ++step, now = step * 0.1)
+		{
+			// Level streaming: every other step one old block goes and a new one comes in.
+			if (step % 2 == 0)
+			{
+				const size_t victim = static_cast<size_t>(rng() % level.size());
+				space.Free(level[victim].base, level[victim].bytes);
+				level.erase(level.begin() + static_cast<std::ptrdiff_t>(victim));
+
+				const uint64_t bytes = static_cast<uint64_t>(levelMiB(rng)) * kMiB;
+				const int64_t base = space.Alloc(bytes);
+				if (base < 0)
+				{
+					result.outOfSpace = true;
+					break;
+				}
+				level.push_back({ base, bytes });
+			}
+			if (!textures.Touch(2 * kMiB))
+			{
+				result.outOfSpace = true;
+				break;
+			}
+
+			if (!budget.SampleDue(now))
+				continue;
+			VasSample sample{ space.FreeTotal(), 0 };
+			if (budget.WantsRegionWalk(sample.freeTotal, now))
+			{
+				sample.freeLargest = space.FreeLargest();
+				++result.walks;
+			}
+			++result.samples;
+			budget.Update(sample, now);
+			result.peak = std::max(result.peak, budget.GetPressure());
+
+			if (trimEnabled && trim.RetrimDue(budget.GetPressure(), now) && trim.Regrown(textures.Mapped()))
+			{
+				result.minRetrimRegrowth = std::min(result.minRetrimRegrowth, textures.Mapped() - lastTrimmedTo);
+				if (lastRetrim >= 0.0)
+					result.minRetrimGap = std::min(result.minRetrimGap, now - lastRetrim);
+				lastRetrim = now;
+				doTrim(VasPressure::Critical);
+				++result.retrims;
+			}
+		}
+		result.endTime = now;
+		result.transitions = budget.GetTransitions();
+		result.trims = trim.GetTrims();
+		return result;
+	}
+}
+
+VR_TEST(ThresholdsOnTotalAndLargest)
+{
+	VasBudget budget;
+	// Either value below a threshold enters the level; the worst one wins.
+	VR_CHECK(budget.Classify(Sample(2000, 1000), 1.0f) == VasPressure::Normal);
+	VR_CHECK(budget.Classify(Sample(2000, 383), 1.0f) == VasPressure::Elevated);
+	VR_CHECK(budget.Classify(Sample(767, 1000), 1.0f) == VasPressure::Elevated);
+	VR_CHECK(budget.Classify(Sample(2000, 191), 1.0f) == VasPressure::High);
+	VR_CHECK(budget.Classify(Sample(447, 1000), 1.0f) == VasPressure::High);
+	VR_CHECK(budget.Classify(Sample(2000, 95), 1.0f) == VasPressure::Critical);
+	VR_CHECK(budget.Classify(Sample(223, 200), 1.0f) == VasPressure::Critical);
+	VR_CHECK(budget.Classify(Sample(700, 150), 1.0f) == VasPressure::High);
+
+	// Exactly on a threshold is not below it.
+	VR_CHECK(budget.Classify(Sample(768, 384), 1.0f) == VasPressure::Normal);
+	VR_CHECK(budget.Classify(Sample(224, 96), 1.0f) == VasPressure::High);
+
+	// Custom thresholds are used as given.
+	VasThresholds t;
+	t.largestElevated = 1000 * kMiB;
+	budget.SetThresholds(t);
+	VR_CHECK(budget.Classify(Sample(2000, 999), 1.0f) == VasPressure::Elevated);
+	VR_CHECK(budget.GetThresholds().largestElevated == 1000 * kMiB);
+}
+
+VR_TEST(RisingIsImmediateFallingNeedsTheMargin)
+{
+	VasBudget budget;
+	std::vector<std::pair<VasPressure, VasPressure>> seen;
+	budget.Subscribe([&](VasPressure a, VasPressure b) { seen.push_back({ a, b }); });
+
+	// Straight from Normal to Critical in one sample: one notification, no intermediate levels.
+	VR_CHECK(budget.Update(Sample(2000, 80), 0.0) == VasPressure::Critical);
+	VR_CHECK(seen.size() == 1 && seen[0].first == VasPressure::Normal && seen[0].second == VasPressure::Critical);
+
+	// Just above the Critical threshold (96 MiB) but inside the 1.25x margin (120 MiB): stays.
+	VR_CHECK(budget.Update(Sample(2000, 100), 1.0) == VasPressure::Critical);
+	VR_CHECK(budget.Update(Sample(2000, 119), 2.0) == VasPressure::Critical);
+	VR_CHECK(seen.size() == 1);
+
+	// Clear of the margin: falls only as far as the margin allows (121 MiB < 192 * 1.25 = High).
+	VR_CHECK(budget.Update(Sample(2000, 121), 3.0) == VasPressure::High);
+	// Plenty of room again: straight down to Normal.
+	VR_CHECK(budget.Update(Sample(2000, 1000), 4.0) == VasPressure::Normal);
+	VR_CHECK(seen.size() == 3);
+
+	// A value jittering across a threshold flips once, not every sample.
+	seen.clear();
+	for (int i = 0; i < 100; ++i)
+		budget.Update(Sample(2000, (i % 2) ? 380 : 390), 5.0 + i);
+	VR_CHECK(budget.GetPressure() == VasPressure::Elevated);
+	VR_CHECK(seen.size() == 1);
+	VR_CHECK(budget.GetTransitions() == 4);
+
+	// With a margin of 1 the same jitter does flap: the margin is what prevents it.
+	VasBudget noMargin;
+	VasThresholds t;
+	t.releaseMargin = 1.0f;
+	noMargin.SetThresholds(t);
+	for (int i = 0; i < 100; ++i)
+		noMargin.Update(Sample(2000, (i % 2) ? 380 : 390), 5.0 + i);
+	VR_CHECK(noMargin.GetTransitions() >= 99);
+}
+
+VR_TEST(SamplingAndRegionWalkSchedule)
+{
+	VasBudget budget;
+	VR_CHECK(budget.SampleDue(0.0));
+	VR_CHECK(budget.WantsRegionWalk(3000 * kMiB, 0.0));      // nothing walked yet
+
+	budget.Update(Sample(3000, 2000), 0.0);
+	VR_CHECK(!budget.SampleDue(1.9) && budget.SampleDue(2.0));
+	// Plenty of room: no walk until the walk interval.
+	VR_CHECK(!budget.WantsRegionWalk(3000 * kMiB, 5.0));
+	VR_CHECK(budget.WantsRegionWalk(3000 * kMiB, 10.0));
+	// A free total near the Elevated threshold asks for the walk right away.
+	VR_CHECK(budget.WantsRegionWalk(1500 * kMiB, 5.0));
+
+	// A skipped walk keeps the last largest block, capped by the new free total.
+	budget.Update({ 3000 * kMiB, 0 }, 2.0);
+	VR_CHECK(budget.GetLastSample().freeLargest == 2000 * kMiB);
+	budget.Update({ 1200 * kMiB, 0 }, 4.0);
+	VR_CHECK(budget.GetLastSample().freeLargest == 1200 * kMiB);
+	VR_CHECK(budget.GetPressure() == VasPressure::Normal);
+
+	// Under pressure every sample walks, and sampling speeds up with the level.
+	const double intervals[] = { 2.0, 1.0, 0.5, 0.25 };
+	const VasSample levels[] = { Sample(3000, 2000), Sample(3000, 300), Sample(3000, 150), Sample(3000, 50) };
+	for (int level = 3; level >= 0; --level)
+	{
+		VasBudget b;
+		b.Update(levels[level], 0.0);
+		VR_CHECK(static_cast<int>(b.GetPressure()) == level);
+		VR_CHECK(b.GetSampleInterval() == intervals[level]);
+		if (level > 0)
+			VR_CHECK(b.WantsRegionWalk(3000 * kMiB, 0.1));
+	}
+}
+
+VR_TEST(TrackingAndListeners)
+{
+	VasBudget budget;
+	budget.Track(VasCategory::EyeTargets, 64 * kMiB);
+	budget.Track(VasCategory::EyeTargets, -100 * static_cast<int64_t>(kMiB));    // never below zero
+	budget.SetTracked(VasCategory::HudTargets, 8 * kMiB);
+	VR_CHECK(budget.GetTracked(VasCategory::EyeTargets) == 0);
+	VR_CHECK(budget.GetTrackedTotal() == 8 * kMiB);
+	VR_CHECK(std::string(VasBudget::CategoryName(VasCategory::HudTargets)) == "hud");
+	VR_CHECK(std::string(VasBudget::PressureName(VasPressure::Critical)) == "critical");
+
+	// A listener may unsubscribe itself (and others) while being notified.
+	int first = 0, second = 0;
+	int secondId = 0;
+	int firstId = 0;
+	firstId = budget.Subscribe([&](VasPressure, VasPressure)
+		{
+			++first;
+			budget.Unsubscribe(firstId);
+		});
+	secondId = budget.Subscribe([&](VasPressure, VasPressure) { ++second; });
+	budget.Update(Sample(2000, 300), 0.0);
+	budget.Update(Sample(2000, 50), 1.0);
+	VR_CHECK(first == 1 && second == 2);
+	budget.Unsubscribe(secondId);
+	budget.Update(Sample(3000, 2000), 2.0);
+	VR_CHECK(second == 2);
+}
+
+VR_TEST(MappedTrimDecisions)
+{
+	// Targets per level; Normal never trims.
+	VR_CHECK(VasMappedTrim::TargetBytes(VasPressure::Normal) == UINT32_MAX);
+	VR_CHECK(VasMappedTrim::TargetBytes(VasPressure::Elevated) == 256u << 20);
+	VR_CHECK(VasMappedTrim::TargetBytes(VasPressure::High) == 128u << 20);
+	VR_CHECK(VasMappedTrim::TargetBytes(VasPressure::Critical) == 0u);
+
+	// Only a rise trims.
+	VR_CHECK(VasMappedTrim::TrimOnTransition(VasPressure::Normal, VasPressure::Elevated));
+	VR_CHECK(VasMappedTrim::TrimOnTransition(VasPressure::Elevated, VasPressure::Critical));
+	VR_CHECK(!VasMappedTrim::TrimOnTransition(VasPressure::Critical, VasPressure::High));
+	VR_CHECK(!VasMappedTrim::TrimOnTransition(VasPressure::Elevated, VasPressure::Normal));
+
+	// Retrim: only at Critical, at most every 2 s, and only after 32 MiB of regrowth.
+	VasMappedTrim trim;
+	VR_CHECK(trim.RetrimDue(VasPressure::Critical, 0.0));    // never trimmed
+	VR_CHECK(!trim.RetrimDue(VasPressure::High, 100.0));
+	trim.Trimmed(10u << 20, 50.0);
+	VR_CHECK(!trim.RetrimDue(VasPressure::Critical, 51.9));
+	VR_CHECK(trim.RetrimDue(VasPressure::Critical, 52.0));
+	VR_CHECK(!trim.Regrown((10u << 20) + (32u << 20) - 1));
+	VR_CHECK(trim.Regrown((10u << 20) + (32u << 20)));
+	VR_CHECK(!trim.Regrown(0));                               // shrank since: nothing to do
+	VR_CHECK(trim.GetMappedAfterTrim() == 10u << 20 && trim.GetTrims() == 1);
+
+	// No overflow when the last trim left almost 4 GB mapped.
+	trim.Trimmed(UINT32_MAX - 1, 60.0);
+	VR_CHECK(!trim.Regrown(UINT32_MAX));
+}
+
+VR_TEST(SimulatedSessionStaysInsideTheAddressSpace)
+{
+	const SessionResult trimmed = RunSession(true, 600.0);
+	const SessionResult untrimmed = RunSession(false, 600.0);
+	std::printf("  start: %.0f MiB free, largest block %.0f MiB\n", trimmed.startFree / double(kMiB), trimmed.startLargest / double(kMiB));
+	std::printf("  with trim:    %s at %.1f s, peak %s, %u transitions, %u trims (%u retrims), %u of %u samples walked\n",
+		trimmed.outOfSpace ? "out of space" : "ran", trimmed.endTime, VasBudget::PressureName(trimmed.peak), trimmed.transitions,
+		trimmed.trims, trimmed.retrims, trimmed.walks, trimmed.samples);
+	std::printf("  without trim: %s at %.1f s, peak %s, %u transitions\n",
+		untrimmed.outOfSpace ? "out of space" : "ran", untrimmed.endTime, VasBudget::PressureName(untrimmed.peak), untrimmed.transitions);
+
+	// The session is built to reach the limit: without trimming, DXVK's mapped pool runs it out.
+	VR_CHECK(untrimmed.outOfSpace);
+	VR_CHECK(untrimmed.peak == VasPressure::Critical);
+
+	// With trimming the whole session runs, pressure reached Critical and was handled there.
+	VR_CHECK(!trimmed.outOfSpace);
+	VR_CHECK(trimmed.peak == VasPressure::Critical);
+	VR_CHECK(trimmed.retrims > 0);
+	// Retrims never come faster than the interval or before the pool has regrown.
+	VR_CHECK(trimmed.minRetrimGap >= VasMappedTrim::kRetrimIntervalSeconds - 1e-9);
+	VR_CHECK(trimmed.minRetrimRegrowth >= VasMappedTrim::kRegrowthBytes);
+	// Trimming and regrowth make a sawtooth, but hysteresis keeps the level from flapping per sample.
+	VR_CHECK(trimmed.transitions < trimmed.samples / 10);
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
@@ -0,0 +1,262 @@
+// ViewmodelAdjustTable: key normalization and slots, the viewmodel_adjustments.txt format against the
+// map-based loader it replaced, Serialize / Parse round trips, and SaveAtomic.
+#include "viewmodel_adjust_table.h"
+#include "test_common.h"
+
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <unistd.h>
+
+namespace
+{
+	bool SameValue(const ViewmodelAdjustValue& a, const ViewmodelAdjustValue& b)
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			if (a.position[i] != b.position[i] || a.angle[i] != b.angle[i])
+				return false;
+		}
+		return true;
+	}
+
+	ViewmodelAdjustValue MakeValue(float base)
+	{
+		ViewmodelAdjustValue v;
+		for (int i = 0; i < 3; ++i)
+		{
+			v.position[i] = base + i;
+			v.angle[i] = -base * (i + 1);
+		}
+		return v;
+	}
+
+	// The loader the table replaced: a map keyed by the normalized string, std::stof per component.
+	std::map<std::string, ViewmodelAdjustValue> LegacyParse(const std::string& text, const ViewmodelAdjustValue& fallback)
+	{
+		auto trim = [](std::string s)
+			{
+				s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) { return !std::isspace(ch); }));
+				s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char ch) { return !std::isspace(ch); }).base(), s.end());
+				return s;
+			};
+		auto parseVector3 = [&](const std::string& raw, const float (&defaults)[3], float (&out)[3])
+			{
+				std::copy(defaults, defaults + 3, out);
+				std::stringstream ss(raw);
+				std::string token;
+				int index = 0;
+				while (std::getline(ss, token, ',') && index < 3)
+				{
+					token = trim(token);
+					if (!token.empty())
+					{
+						try
+						{
+							out[index] = std::stof(token);
+						}
+						catch (...)
+						{
+						}
+					}
+					++index;
+				}
+			};
+
+		std::map<std::string, ViewmodelAdjustValue> out;
+		std::stringstream stream(text);
+		std::string line;
+		while (std::getline(stream, line))
+		{
+			line = trim(line);
+			const size_t eq = line.find('=');
+			const size_t separator = line.find(';', eq == std::string::npos ? 0 : eq + 1);
+			if (line.empty() || eq == std::string::npos || separator == std::string::npos || separator <= eq)
+				continue;
+			const std::string key = trim(line.substr(0, eq));
+			if (key.empty())
+				continue;
+			ViewmodelAdjustValue v;
+			parseVector3(line.substr(eq + 1, separator - eq - 1), fallback.position, v.position);
+			parseVector3(line.substr(separator + 1), fallback.angle, v.angle);
+			out[ViewmodelAdjustTable::NormalizeKey(key)] = v;
+		}
+		return out;
+	}
+
+	std::string TempPath(const char* name)
+	{
+		return "/tmp/l4d2vr_test_" + std::to_string(::getpid()) + "_" + name;
+	}
+
+	std::string ReadFile(const std::string& path)
+	{
+		std::ifstream f(path, std::ios::binary);
+		return std::string((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	}
+}
+
+VR_TEST(KeysResolveToStableSlots)
+{
+	ViewmodelAdjustTable table;
+	VR_CHECK(table.GetSlotCount() == ViewmodelAdjustTable::kWeaponIds);
+	VR_CHECK(table.WeaponSlot(1) == 1 && table.GetKey(1) == "weapon:pistol");
+	VR_CHECK(table.SlotForKey("weapon:pistol") == 1);
+	VR_CHECK(table.SlotForKey("  weapon:1 ") == 1);                     // numeric ids from old files
+	VR_CHECK(ViewmodelAdjustTable::NormalizeKey("weapon:32") == "weapon:magnum");
+	VR_CHECK(ViewmodelAdjustTable::NormalizeKey("weapon:99999") == "weapon:99999");
+
+	// Unknown ids and melee scripts are interned after the weapon ids, once.
+	const int unknown = table.WeaponSlot(300);
+	VR_CHECK(unknown == ViewmodelAdjustTable::kWeaponIds);
+	VR_CHECK(table.WeaponSlot(300) == unknown && table.SlotForKey("weapon:300") == unknown);
+	const int katana = table.MeleeSlot("Katana");
+	VR_CHECK(katana == unknown + 1 && table.GetKey(katana) == "melee:katana");
+	VR_CHECK(table.SlotForKey("melee:KATANA") == katana);
+	VR_CHECK(table.GetKey(table.MeleeSlot("")) == "melee:unknown");
+	VR_CHECK(table.GetSlotCount() == ViewmodelAdjustTable::kWeaponIds + 3);
+
+	// Unset slots fall back; out-of-range slots are ignored.
+	const ViewmodelAdjustValue fallback = MakeValue(7.0f);
+	VR_CHECK(SameValue(table.Get(katana, fallback), fallback));
+	table.Set(katana, MakeValue(1.0f));
+	VR_CHECK(table.IsSet(katana) && SameValue(table.Get(katana, fallback), MakeValue(1.0f)));
+	table.Set(-1, MakeValue(2.0f));
+	table.Set(10000, MakeValue(2.0f));
+	VR_CHECK(!table.IsSet(-1) && !table.IsSet(10000));
+	VR_CHECK(SameValue(table.Get(10000, fallback), fallback));
+}
+
+VR_TEST(ParseAcceptsWhatTheOldLoaderDid)
+{
+	const ViewmodelAdjustValue fallback = MakeValue(0.5f);
+	const std::string text =
+		"weapon:pistol=1,2,3;4,5,6\r\n"
+		"  weapon:3 = 0.5 , -1.25 ,2 ; 0,0,90  \n"
+		"melee:Katana=1,,3;,5\n"
+		"no separator here=1,2,3\n"
+		"=1,2,3;4,5,6\n"
+		"weapon:ak47=abc,1e3,-0;junk\n"
+		"\n"
+		"custom:key=9,9,9;8,8,8";
+	ViewmodelAdjustTable table;
+	VR_CHECK(table.Parse(text, fallback) == 5);
+
+	const std::map<std::string, ViewmodelAdjustValue> legacy = LegacyParse(text, fallback);
+	VR_CHECK(legacy.size() == 5);
+	for (const auto& [key, value] : legacy)
+	{
+		const int slot = table.SlotForKey(key);
+		VR_CHECK(table.IsSet(slot));
+		VR_CHECK(SameValue(table.Get(slot, fallback), value));
+	}
+
+	const ViewmodelAdjustValue& katana = table.Get(table.MeleeSlot("katana"), fallback);
+	VR_CHECK(katana.position[0] == 1.0f && katana.position[1] == fallback.position[1] && katana.position[2] == 3.0f);
+	VR_CHECK(katana.angle[0] == fallback.angle[0] && katana.angle[1] == 5.0f && katana.angle[2] == fallback.angle[2]);
+}
+
+VR_TEST(RandomFilesMatchTheOldLoader)
+{
+	std::mt19937 rng(9);
+	const char* const keys[] = { "weapon:pistol", "weapon:1", "weapon:mp5", "weapon:33", "melee:katana", "melee:Machete",
+		"melee:FIREAXE", "custom:scope", "weapon:400" };
+	const char* const numbers[] = { "0", "1.5", "-2", " 3 ", "", "x", "12.345678", "-0.001", "1e2", "7abc" };
+	const ViewmodelAdjustValue fallback = MakeValue(3.0f);
+	for (int round = 0; round < 500; ++round)
+	{
+		std::string text;
+		for (int line = static_cast<int>(rng() % 12); line > 0; --line)
+		{
+			text += keys[rng() % 9];
+			text += rng() % 8 ? "=" : " ";
+			for (int c = 0; c < 6; ++c)
+			{
+				text += numbers[rng() % 10];
+				if (c < 5)
+					text += (c == 2) ? (rng() % 8 ? ";" : ",") : ",";
+			}
+			text += rng() % 4 ? "\n" : "\r\n";
+		}
+
+		ViewmodelAdjustTable table;
+		table.Parse(text, fallback);
+		const std::map<std::string, ViewmodelAdjustValue> legacy = LegacyParse(text, fallback);
+		int set = 0;
+		for (int slot = 0; slot < table.GetSlotCount(); ++slot)
+			set += table.IsSet(slot) ? 1 : 0;
+		VR_CHECK(set == static_cast<int>(legacy.size()));
+		for (const auto& [key, value] : legacy)
+			VR_CHECK(SameValue(table.Get(table.SlotForKey(key), fallback), value));
+	}
+}
+
+VR_TEST(OutOfRangeNumbersKeepTheFallback)
+{
+	// std::stof threw on out-of-range values and the old loader kept the default; strtof gives inf.
+	// A nan component would poison the viewmodel transform, so it keeps the default too.
+	const ViewmodelAdjustValue fallback = MakeValue(1.0f);
+	ViewmodelAdjustTable table;
+	table.Parse("weapon:pistol=1e40,-1e40,nan;inf,2,3\n", fallback);
+	const ViewmodelAdjustValue& v = table.Get(1, fallback);
+	VR_CHECK(v.position[0] == fallback.position[0] && v.position[1] == fallback.position[1]);
+	VR_CHECK(v.position[2] == fallback.position[2] && v.angle[0] == fallback.angle[0]);
+	VR_CHECK(v.angle[1] == 2.0f && v.angle[2] == 3.0f);
+}
+
+VR_TEST(SerializeRoundTrips)
+{
+	ViewmodelAdjustTable table;
+	table.Set(table.MeleeSlot("katana"), MakeValue(0.25f));
+	table.Set(table.WeaponSlot(26), MakeValue(-1.5f));
+	table.Set(table.WeaponSlot(1), MakeValue(2.0f));
+	table.WeaponSlot(5);   // resolved but never adjusted: not written
+
+	const std::string text = table.Serialize();
+	VR_CHECK(text ==
+		"melee:katana=0.25,1.25,2.25;-0.25,-0.5,-0.75\n"
+		"weapon:ak47=-1.5,-0.5,0.5;1.5,3,4.5\n"
+		"weapon:pistol=2,3,4;-2,-4,-6\n");
+
+	ViewmodelAdjustTable reloaded;
+	VR_CHECK(reloaded.Parse(text, ViewmodelAdjustValue{}) == 3);
+	VR_CHECK(reloaded.Serialize() == text);
+	VR_CHECK(SameValue(reloaded.Get(reloaded.MeleeSlot("KATANA"), ViewmodelAdjustValue{}), MakeValue(0.25f)));
+
+	// %g keeps six significant digits, like the old ostream writer: values survive to that precision.
+	ViewmodelAdjustTable precise;
+	ViewmodelAdjustValue v;
+	v.position[0] = 1.23456789f;
+	v.angle[2] = -123.456789f;
+	precise.Set(1, v);
+	ViewmodelAdjustTable back;
+	back.Parse(precise.Serialize(), ViewmodelAdjustValue{});
+	VR_CHECK_NEAR(back.Get(1, ViewmodelAdjustValue{}).position[0], 1.23457, 1e-6);
+	VR_CHECK_NEAR(back.Get(1, ViewmodelAdjustValue{}).angle[2], -123.457, 1e-4);
+}
+
+VR_TEST(SaveAtomicReplacesOrLeavesTheOldFile)
+{
+	const std::string path = TempPath("viewmodel_adjustments.txt");
+	std::remove(path.c_str());
+
+	VR_CHECK(ViewmodelAdjustTable::SaveAtomic(path, "weapon:pistol=1,2,3;4,5,6\n"));
+	VR_CHECK(ReadFile(path) == "weapon:pistol=1,2,3;4,5,6\n");
+	VR_CHECK(ViewmodelAdjustTable::SaveAtomic(path, "weapon:mp5=0,0,0;0,0,0\n"));
+	VR_CHECK(ReadFile(path) == "weapon:mp5=0,0,0;0,0,0\n");
+
+	// The swap fails: the old file stays whole and the temp file is cleaned up.
+	VR_CHECK(!ViewmodelAdjustTable::SaveAtomic(path, "half", [](const std::string&, const std::string&) { return false; }));
+	VR_CHECK(ReadFile(path) == "weapon:mp5=0,0,0;0,0,0\n");
+	VR_CHECK(!std::ifstream(path + ".tmp").good());
+
+	// A directory that doesn't exist.
+	VR_CHECK(!ViewmodelAdjustTable::SaveAtomic(TempPath("missing_dir/x.txt"), "x"));
+	std::remove(path.c_str());
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
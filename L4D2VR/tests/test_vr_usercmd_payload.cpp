@@ -0,0 +1,343 @@
+// VRCmdPayloadCodec: round trips, aim precision, budget under motion, unavailable poses.
+#include "vr_usercmd_payload.h"
+#include "test_common.h"
+
+#include <random>
+
+namespace
+{
+	using Codec = VRCmdPayloadCodec;
+
+	void Forward(const float q[4], float out[3])
+	{
+		const float x = q[0], y = q[1], z = q[2], w = q[3];
+		out[0] = 1.0f - 2.0f * y * y - 2.0f * z * z;
+		out[1] = 2.0f * x * y + 2.0f * w * z;
+		out[2] = 2.0f * x * z - 2.0f * w * y;
+	}
+
+	// Angle between the forward axes of two rotations (what a shot's direction depends on), degrees.
+	double AimErrorDeg(const float a[4], const float b[4])
+	{
+		float fa[3], fb[3];
+		Forward(a, fa);
+		Forward(b, fb);
+		double dot = 0.0, la = 0.0, lb = 0.0;
+		for (int i = 0; i < 3; ++i)
+		{
+			dot += double(fa[i]) * fb[i];
+			la += double(fa[i]) * fa[i];
+			lb += double(fb[i]) * fb[i];
+		}
+		dot /= std::sqrt(la * lb);
+		return std::acos(std::min(1.0, std::max(-1.0, dot))) * 57.29577951308232;
+	}
+
+	// Legacy v1 sent angles * 10 as integers.
+	double LegacyAimErrorDeg(float pitch, float yaw, float roll)
+	{
+		float exact[4], legacy[4];
+		Codec::AnglesToQuat(pitch, yaw, roll, exact);
+		Codec::AnglesToQuat(std::round(pitch * 10.0f) / 10.0f, std::round(yaw * 10.0f) / 10.0f, std::round(roll * 10.0f) / 10.0f, legacy);
+		return AimErrorDeg(exact, legacy);
+	}
+
+	struct Link
+	{
+		VRCmdPayloadHistory<> encoder;
+		VRCmdPayloadHistory<> decoder;
+		int drops = 0;
+		int maxBits = 0;
+		int mismatches = 0;
+		std::array<int, VRCmdPose_Count> staleCommands{};
+		std::array<int, VRCmdPose_Count> staleRun{};
+		std::array<int, VRCmdPose_Count> maxStaleRun{};   // longest run of commands a pose lagged behind
+
+		// Sends one command; `from` is 0 at the start of a usercmd packet (no reference).
+		VRCmdEncodeResult Send(int cmd, int from, const VRCmdPoseSample (&poses)[VRCmdPose_Count], VRCmdPayloadState& decoded,
+			bool urgent = false)
+		{
+			const bool odd = (cmd & 1) != 0;
+			const VRCmdPayloadState empty;
+			const VRCmdPayloadState* encRef = encoder.Find(from);
+			const std::array<int, VRCmdPose_Count> priority = Codec::PlanPriority(encRef ? *encRef : empty, cmd, urgent);
+			VRCmdPayloadState sent;
+			VRCmdCarrier carrier;
+			const VRCmdEncodeResult r = Codec::Encode(poses, odd, encRef ? *encRef : empty, priority, sent, carrier);
+			encoder.Store(cmd, sent);
+			maxBits = std::max(maxBits, r.bitsUsed);
+			if (r.droppedMask)
+				++drops;
+
+			const VRCmdPayloadState* decRef = decoder.Find(from);
+			bool melee = false;
+			if (!Codec::Decode(carrier, decRef ? *decRef : empty, melee, decoded) || melee != odd)
+			{
+				++mismatches;
+				return r;
+			}
+			decoder.Store(cmd, decoded);
+			for (int s = 0; s < VRCmdPose_Count; ++s)
+			{
+				if (decoded.valid[s] != sent.valid[s] || (decoded.valid[s] && decoded.pose[s] != sent.pose[s]))
+					++mismatches;
+				bool inRange = true;
+				const VRCmdQuantizedPose q = Codec::Quantize(poses[s], &inRange);
+				if (poses[s].valid && inRange && (!decoded.valid[s] || decoded.pose[s] != q))
+				{
+					++staleCommands[s];
+					maxStaleRun[s] = std::max(maxStaleRun[s], ++staleRun[s]);
+				}
+				else
+				{
+					staleRun[s] = 0;
+				}
+			}
+			return r;
+		}
+	};
+
+	struct PoseWalk
+	{
+		float ang[VRCmdPose_Count][3] = { { 10, 20, 30 }, { -40, 170, 5 }, { 0, 90, 0 } };
+		float pos[VRCmdPose_Count][3] = { { 20, -10, 50 }, { -20, -10, 45 }, { 0, 0, 64 } };
+
+		// degPerCmd / unitsPerCmd: per-axis random step bound.
+		void Step(std::mt19937& rng, float degPerCmd, float unitsPerCmd, VRCmdPoseSample (&out)[VRCmdPose_Count])
+		{
+			std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+			for (int s = 0; s < VRCmdPose_Count; ++s)
+			{
+				for (int a = 0; a < 3; ++a)
+				{
+					ang[s][a] += u(rng) * degPerCmd;
+					pos[s][a] = std::clamp(pos[s][a] + u(rng) * unitsPerCmd, -100.0f, 100.0f);
+				}
+				ang[s][0] = std::clamp(ang[s][0], -85.0f, 85.0f);
+				out[s].valid = true;
+				for (int a = 0; a < 3; ++a)
+					out[s].pos[a] = pos[s][a];
+				Codec::AnglesToQuat(ang[s][0], ang[s][1], ang[s][2], out[s].quat);
+			}
+		}
+	};
+}
+
+VR_TEST(RotationPrecisionBeatsLegacyAngles)
+{
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> pitch(-89.0f, 89.0f), yaw(-180.0f, 180.0f), roll(-180.0f, 180.0f);
+	double sum = 0.0, worst = 0.0, legacySum = 0.0, legacyWorst = 0.0;
+	constexpr int kSamples = 200000;
+	for (int i = 0; i < kSamples; ++i)
+	{
+		const float p = pitch(rng), y = yaw(rng), r = roll(rng);
+		VRCmdPoseSample sample;
+		sample.valid = true;
+		Codec::AnglesToQuat(p, y, r, sample.quat);
+		const VRCmdPoseSample back = Codec::Dequantize(Codec::Quantize(sample));
+		const double err = AimErrorDeg(sample.quat, back.quat);
+		sum += err;
+		worst = std::max(worst, err);
+
+		const double legacy = LegacyAimErrorDeg(p, y, r);
+		legacySum += legacy;
+		legacyWorst = std::max(legacyWorst, legacy);
+	}
+	std::printf("  aim error: v2 mean %.4f max %.4f deg | legacy x10 mean %.4f max %.4f deg\n",
+		sum / kSamples, worst, legacySum / kSamples, legacyWorst);
+	VR_CHECK(sum / kSamples < 0.03);
+	VR_CHECK(worst < 0.1);
+	VR_CHECK(sum / kSamples < legacySum / kSamples);
+}
+
+VR_TEST(EncoderAndDecoderStayInStep)
+{
+	std::mt19937 rng(1);
+	Link link;
+	PoseWalk walk;
+	VRCmdPoseSample poses[VRCmdPose_Count];
+	double maxPosErr = 0.0;
+	for (int cmd = 1; cmd < 5000; ++cmd)
+	{
+		walk.Step(rng, 0.7f, 0.3f, poses);
+		// Four commands per packet; the first one of each packet has no reference.
+		const int from = (cmd % 4 == 1) ? 0 : cmd - 1;
+		VRCmdPayloadState decoded;
+		const VRCmdEncodeResult r = link.Send(cmd, from, poses, decoded);
+		for (int s = 0; s < VRCmdPose_Count; ++s)
+		{
+			if (!(r.sentMask & (1u << s)))
+				continue;
+			const VRCmdPoseSample d = Codec::Dequantize(decoded.pose[s]);
+			for (int a = 0; a < 3; ++a)
+				maxPosErr = std::max(maxPosErr, double(std::fabs(d.pos[a] - poses[s].pos[a])));
+		}
+	}
+	VR_CHECK(link.mismatches == 0);
+	VR_CHECK(link.maxBits <= Codec::kCapacityBits);
+	VR_CHECK(maxPosErr <= Codec::kPosStep * 0.5 + 1e-4);
+}
+
+VR_TEST(AllPosesGetThroughUnderMotion)
+{
+	// 90 fps against cl_cmdrate 30 gives 3 commands per usercmd packet; the first of each packet is
+	// encoded with no reference, so every pose needs an absolute update again. Slow: ~60 deg/s and
+	// 25 u/s per axis at 90 commands/s; fast: ~600 deg/s and 180 u/s (a swing).
+	// Bounds: the share of commands a pose was exact at the decoder, and the longest stale run.
+	struct Case
+	{
+		const char* name;
+		int commandsPerPacket;
+		float degPerCmd;
+		float unitsPerCmd;
+		bool urgent;
+		double minRight;
+		int maxRightRun;
+		double minOther;
+		int maxOtherRun;
+	};
+	// Firing keeps the right hand exact at the secondaries' expense; with one command per packet only
+	// the right hand's absolute update ever fits.
+	const Case cases[] = {
+		{ "slow, 3/packet", 3, 0.7f, 0.3f, false, 0.60, 1, 0.20, 8 },
+		{ "fast, 3/packet", 3, 7.0f, 2.0f, false, 0.60, 1, 0.15, 8 },
+		{ "fast, 3/packet, firing", 3, 7.0f, 2.0f, true, 1.0, 0, 0.0, 1 << 30 },
+		{ "slow, 1/packet", 1, 0.7f, 0.3f, false, 1.0, 0, 0.0, 1 << 30 },
+		{ "slow, continuous", 1 << 30, 0.7f, 0.3f, false, 0.99, 1, 0.45, 3 },
+		{ "fast, continuous", 1 << 30, 7.0f, 2.0f, false, 0.45, 1, 0.20, 3 },
+	};
+	for (const Case& c : cases)
+	{
+		std::mt19937 rng(3);
+		Link link;
+		PoseWalk walk;
+		VRCmdPoseSample poses[VRCmdPose_Count];
+		constexpr int kCommands = 6000;
+		for (int cmd = 1; cmd <= kCommands; ++cmd)
+		{
+			walk.Step(rng, c.degPerCmd, c.unitsPerCmd, poses);
+			VRCmdPayloadState decoded;
+			const int from = ((cmd - 1) % c.commandsPerPacket == 0) ? 0 : cmd - 1;
+			link.Send(cmd, from, poses, decoded, c.urgent);
+		}
+		auto rate = [&](int slot) { return 1.0 - double(link.staleCommands[slot]) / kCommands; };
+		std::printf("  %-24s exact right %5.1f%% (run %d) left %5.1f%% (run %d) hmd %5.1f%% (run %d)\n", c.name,
+			rate(VRCmdPose_RightHand) * 100.0, link.maxStaleRun[VRCmdPose_RightHand],
+			rate(VRCmdPose_LeftHand) * 100.0, link.maxStaleRun[VRCmdPose_LeftHand],
+			rate(VRCmdPose_Hmd) * 100.0, link.maxStaleRun[VRCmdPose_Hmd]);
+		VR_CHECK(link.mismatches == 0);
+		VR_CHECK(link.maxBits <= Codec::kCapacityBits);
+		VR_CHECK(rate(VRCmdPose_RightHand) >= c.minRight);
+		VR_CHECK(link.maxStaleRun[VRCmdPose_RightHand] <= c.maxRightRun);
+		VR_CHECK(rate(VRCmdPose_LeftHand) >= c.minOther && rate(VRCmdPose_Hmd) >= c.minOther);
+		VR_CHECK(link.maxStaleRun[VRCmdPose_LeftHand] <= c.maxOtherRun && link.maxStaleRun[VRCmdPose_Hmd] <= c.maxOtherRun);
+	}
+}
+
+VR_TEST(PlanPriorityTakesTurns)
+{
+	VRCmdPayloadState ref;
+	// No reference (packet start): right hand first.
+	VR_CHECK(Codec::PlanPriority(ref, 4, false)[0] == VRCmdPose_RightHand);
+	ref.valid[VRCmdPose_RightHand] = true;
+	const int expectedFirst[4] = { VRCmdPose_LeftHand, VRCmdPose_RightHand, VRCmdPose_Hmd, VRCmdPose_RightHand };
+	const int expectedSecondary[4] = { VRCmdPose_LeftHand, VRCmdPose_LeftHand, VRCmdPose_Hmd, VRCmdPose_Hmd };
+	for (int cmd = 8; cmd < 16; ++cmd)
+	{
+		const std::array<int, VRCmdPose_Count> p = Codec::PlanPriority(ref, cmd, false);
+		VR_CHECK(p[0] == expectedFirst[cmd & 3]);
+		VR_CHECK(p[0] != p[1] && p[1] != p[2] && p[0] != p[2]);
+		VR_CHECK((p[0] == VRCmdPose_RightHand ? p[1] : p[0]) == expectedSecondary[cmd & 3]);
+		// Firing / swinging keeps the right hand first.
+		VR_CHECK(Codec::PlanPriority(ref, cmd, true)[0] == VRCmdPose_RightHand);
+	}
+}
+
+VR_TEST(OutOfRangePositionIsSentAsUnavailable)
+{
+	Link link;
+	VRCmdPoseSample poses[VRCmdPose_Count];
+	for (VRCmdPoseSample& p : poses)
+		p.valid = true;
+
+	VRCmdPayloadState decoded;
+	VRCmdEncodeResult r = link.Send(1, 0, poses, decoded);
+	VR_CHECK(decoded.valid[VRCmdPose_RightHand]);
+	VR_CHECK(r.outOfRangeMask == 0);
+
+	// x past +128 and z below -64: flagged, and the decoder drops the pose instead of clamping it.
+	poses[VRCmdPose_RightHand].pos[0] = 300.0f;
+	poses[VRCmdPose_LeftHand].pos[2] = -80.0f;
+	r = link.Send(2, 1, poses, decoded);
+	VR_CHECK(r.outOfRangeMask == ((1u << VRCmdPose_RightHand) | (1u << VRCmdPose_LeftHand)));
+	VR_CHECK(!decoded.valid[VRCmdPose_RightHand]);
+	VR_CHECK(!decoded.valid[VRCmdPose_LeftHand]);
+	VR_CHECK(decoded.valid[VRCmdPose_Hmd]);
+
+	// Still out of range: nothing more to say.
+	r = link.Send(3, 2, poses, decoded);
+	VR_CHECK(r.sentMask == 0);
+	VR_CHECK(!decoded.valid[VRCmdPose_RightHand]);
+
+	// Back in range: sent absolute again.
+	poses[VRCmdPose_RightHand].pos[0] = 100.0f;
+	r = link.Send(4, 3, poses, decoded);
+	VR_CHECK(decoded.valid[VRCmdPose_RightHand]);
+	VR_CHECK_NEAR(Codec::Dequantize(decoded.pose[VRCmdPose_RightHand]).pos[0], 100.0, 0.125);
+	VR_CHECK(link.mismatches == 0);
+
+	// Non-finite input is out of range too.
+	VRCmdPoseSample bad;
+	bad.valid = true;
+	bad.pos[1] = std::nanf("");
+	bool inRange = true;
+	Codec::Quantize(bad, &inRange);
+	VR_CHECK(!inRange);
+}
+
+VR_TEST(LostTrackingInvalidatesOnlyKnownPoses)
+{
+	Link link;
+	VRCmdPoseSample poses[VRCmdPose_Count];
+	poses[VRCmdPose_RightHand].valid = true;
+
+	VRCmdPayloadState decoded;
+	VRCmdEncodeResult r = link.Send(1, 0, poses, decoded);
+	VR_CHECK(r.sentMask == (1u << VRCmdPose_RightHand));
+
+	poses[VRCmdPose_RightHand].valid = false;
+	r = link.Send(2, 1, poses, decoded);
+	VR_CHECK(r.sentMask == (1u << VRCmdPose_RightHand));
+	VR_CHECK(r.bitsUsed == Codec::kVersionBits + 1 + VRCmdPose_Count + 1 + Codec::kUnavailablePoseBits);
+	VR_CHECK(!decoded.valid[VRCmdPose_RightHand]);
+	VR_CHECK(link.mismatches == 0);
+}
+
+VR_TEST(LegacyCarrierIsRejected)
+{
+	VRCmdCarrier legacy;
+	float f = 1532.5f;
+	std::memcpy(&legacy.viewZBits, &f, 4);
+	f = -200.0f;
+	std::memcpy(&legacy.upmoveBits, &f, 4);
+	bool melee = false;
+	VRCmdPayloadState out, empty;
+	VR_CHECK(!Codec::Decode(legacy, empty, melee, out));
+	VR_CHECK(!Codec::IsPayload(legacy));
+}
+
+VR_TEST(EulerQuaternionRoundTrip)
+{
+	float q[4], p, y, r;
+	Codec::AnglesToQuat(30.0f, -120.0f, 45.0f, q);
+	Codec::QuatToAngles(q, p, y, r);
+	VR_CHECK_NEAR(p, 30.0, 1e-3);
+	VR_CHECK_NEAR(y, -120.0, 1e-3);
+	VR_CHECK_NEAR(r, 45.0, 1e-3);
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
@@ -0,0 +1,415 @@
+// WeaponScriptDb: range keys from a stock-shaped weapon script, the binary cache round trip, rejection
+// of a stale, damaged or truncated cache, and the loader's cache-or-parse step (LoadOrBuild).
+#include "weapon_script_db.h"
+#include "test_common.h"
+
+#include <map>
+
+namespace
+{
+	// Shaped like the stock weapon_pumpshotgun.txt: CRLF, comments, unrelated nested blocks, and keys
+	// repeated inside a nested block after the top-level ones (first occurrence wins).
+	const char kShotgunScript[] =
+		"// Pump Shotgun\r\n"
+		"WeaponData\r\n"
+		"{\r\n"
+		"\t\"printname\"\t\t\"#L4D_Weapon_PumpShotgun\"\r\n"
+		"\t\"playermodel\"\t\t\"models/w_models/weapons/w_shotgun.mdl\"\r\n"
+		"\t\"Damage\"\t\t\t\"25\"\r\n"
+		"\t\"Bullets\"\t\t\t\"10\"\t// pellets\r\n"
+		"\t\"Range\"\t\t\t\"3000\"\r\n"
+		"\t\"MaxPlayerSpeed\"\t\t\"220\"\r\n"
+		"\t\"MinStandingSpread\"\t\"0.75\"\r\n"
+		"\t\"MinDuckingSpread\"\t\"0.5\"\r\n"
+		"\t\"MinInAirSpread\"\t\t\"2.5\"\r\n"
+		"\t\"MaxMovementSpread\"\t\"1.5\"\r\n"
+		"\t\"PelletScatterPitch\"\t\"3.5\"\r\n"
+		"\t\"PelletScatterYaw\"\t\"6.0\"\r\n"
+		"\tSoundData\r\n"
+		"\t{\r\n"
+		"\t\t\"single_shot\"\t\t\"Shotgun.Fire\"\r\n"
+		"\t\t\"Damage\"\t\t\t\"999\"\r\n"
+		"\t}\r\n"
+		"\tTextureData\r\n"
+		"\t{\r\n"
+		"\t\t\"weapon\"\r\n"
+		"\t\t{\r\n"
+		"\t\t\t\"file\"\t\t\"vgui/hud/iconsheet\"\r\n"
+		"\t\t\t\"x\"\t\t\t\"0\"\r\n"
+		"\t\t}\r\n"
+		"\t}\r\n"
+		"}\r\n";
+
+	const char kRifleScript[] =
+		"WeaponData\n{\n"
+		"\t\"Damage\" \"33\"\n"
+		"\t\"MinStandingSpread\" \"0.25\"\n"
+		"\t\"MaxMovementSpread\" \"2.0\"\n"
+		"}\n";
+
+	// A file in the working directory, removed (with its .tmp) when the test ends.
+	struct TempCacheFile
+	{
+		std::string path;
+
+		explicit TempCacheFile(const char* name) : path(name)
+		{
+			Remove();
+		}
+		~TempCacheFile()
+		{
+			Remove();
+		}
+		void Remove() const
+		{
+			std::remove(path.c_str());
+			std::remove((path + ".tmp").c_str());
+		}
+
+		std::string Read() const
+		{
+			std::string blob;
+			if (FILE* f = std::fopen(path.c_str(), "rb"))
+			{
+				char buffer[4096];
+				size_t n = 0;
+				while ((n = std::fread(buffer, 1, sizeof(buffer), f)) > 0)
+					blob.append(buffer, n);
+				std::fclose(f);
+			}
+			return blob;
+		}
+
+		void Write(const std::string& blob) const
+		{
+			if (FILE* f = std::fopen(path.c_str(), "wb"))
+			{
+				std::fwrite(blob.data(), 1, blob.size(), f);
+				std::fclose(f);
+			}
+		}
+	};
+
+	std::vector<WeaponScriptStamp> SampleStamps()
+	{
+		return {
+			{ "left4dead2\\pak01_dir.vpk", 0x01d8a0b0c0d0e0f0ull, 1855432123ull },
+			{ "update\\pak01_dir.vpk", 0x01d9000011112222ull, 40213ull },
+			{ "left4dead2\\addons\\workshop\\123456789.vpk", 0x01da33334444aaaaull, 9012ull },
+		};
+	}
+
+	std::vector<WeaponScriptCacheEntry> SampleEntries()
+	{
+		std::vector<WeaponScriptCacheEntry> entries;
+		WeaponRangeData shotgun{};
+		VR_CHECK(WeaponScriptDb::ParseRangeData(kShotgunScript, sizeof(kShotgunScript) - 1, shotgun));
+		shotgun.source = "left4dead2\\pak01_dir.vpk";
+		entries.push_back({ 7, shotgun });
+		WeaponRangeData rifle{};
+		VR_CHECK(WeaponScriptDb::ParseRangeData(kRifleScript, sizeof(kRifleScript) - 1, rifle));
+		rifle.source = "scripts/weapon_rifle.txt";
+		entries.push_back({ 5, rifle });
+		return entries;
+	}
+
+	bool SameData(const WeaponRangeData& a, const WeaponRangeData& b)
+	{
+		return a.valid == b.valid && a.minDuckingSpread == b.minDuckingSpread && a.minStandingSpread == b.minStandingSpread
+			&& a.minInAirSpread == b.minInAirSpread && a.maxMovementSpread == b.maxMovementSpread
+			&& a.pelletScatterPitch == b.pelletScatterPitch && a.pelletScatterYaw == b.pelletScatterYaw && a.range == b.range
+			&& a.maxPlayerSpeed == b.maxPlayerSpeed && a.damage == b.damage && a.bullets == b.bullets && a.source == b.source;
+	}
+
+	bool SameEntries(const std::vector<WeaponScriptCacheEntry>& a, const std::vector<WeaponScriptCacheEntry>& b)
+	{
+		if (a.size() != b.size())
+			return false;
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			if (a[i].slot != b[i].slot || !SameData(a[i].data, b[i].data))
+				return false;
+		}
+		return true;
+	}
+
+	// Stands in for VR_TryReadGameResourceText: scripts by path, with a read counter.
+	struct FakeGameFiles
+	{
+		std::map<std::string, std::string> files;
+		int reads = 0;
+
+		bool operator()(const char* path, std::string& text, std::string& source)
+		{
+			++reads;
+			const auto it = files.find(path);
+			if (it == files.end())
+				return false;
+			text = it->second;
+			source = std::string("pak01_dir.vpk:") + path;
+			return true;
+		}
+	};
+
+	const WeaponScriptDb::ScriptSlot kScripts[] =
+	{
+		{ 5, "scripts/weapon_rifle.txt" },
+		{ 7, "scripts/weapon_pumpshotgun.txt" },
+		{ 9, "scripts/weapon_missing.txt" },
+		{ 80, "scripts/weapon_out_of_range.txt" },
+	};
+	constexpr size_t kScriptCount = sizeof(kScripts) / sizeof(kScripts[0]);
+	constexpr size_t kSlotLimit = 64;
+}
+
+VR_TEST(ParsesRepresentativeWeaponScript)
+{
+	WeaponRangeData data{};
+	VR_CHECK(WeaponScriptDb::ParseRangeData(kShotgunScript, sizeof(kShotgunScript) - 1, data));
+	VR_CHECK(data.valid);
+	VR_CHECK_NEAR(data.minStandingSpread, 0.75, 1e-6);
+	VR_CHECK_NEAR(data.minDuckingSpread, 0.5, 1e-6);
+	VR_CHECK_NEAR(data.minInAirSpread, 2.5, 1e-6);
+	VR_CHECK_NEAR(data.maxMovementSpread, 1.5, 1e-6);
+	VR_CHECK_NEAR(data.pelletScatterPitch, 3.5, 1e-6);
+	VR_CHECK_NEAR(data.pelletScatterYaw, 6.0, 1e-6);
+	VR_CHECK_NEAR(data.range, 3000.0, 1e-3);
+	VR_CHECK_NEAR(data.maxPlayerSpeed, 220.0, 1e-3);
+	VR_CHECK_NEAR(data.damage, 25.0, 1e-6);     // the top-level key, not the one under SoundData
+	VR_CHECK(data.bullets == 10);
+}
+
+VR_TEST(ParseFillsDefaultsAndRejectsScriptsWithoutSpread)
+{
+	// Missing ducking / in-air spread fall back to standing; missing range and speed keep the defaults.
+	WeaponRangeData rifle{};
+	VR_CHECK(WeaponScriptDb::ParseRangeData(kRifleScript, sizeof(kRifleScript) - 1, rifle));
+	VR_CHECK_NEAR(rifle.minDuckingSpread, 0.25, 1e-6);
+	VR_CHECK_NEAR(rifle.minInAirSpread, 0.25, 1e-6);
+	VR_CHECK_NEAR(rifle.range, 8192.0, 1e-3);
+	VR_CHECK_NEAR(rifle.maxPlayerSpeed, 250.0, 1e-3);
+	VR_CHECK(rifle.bullets == 1);
+
+	// Out-of-range values are clamped.
+	const char wild[] = "WeaponData { \"MinStandingSpread\" \"-3\" \"Range\" \"1e9\" \"MaxPlayerSpeed\" \"0\" \"Bullets\" \"-4\" }";
+	WeaponRangeData clamped{};
+	VR_CHECK(WeaponScriptDb::ParseRangeData(wild, sizeof(wild) - 1, clamped));
+	VR_CHECK(clamped.minStandingSpread == 0.0f);
+	VR_CHECK_NEAR(clamped.range, 65536.0, 1e-3);
+	VR_CHECK_NEAR(clamped.maxPlayerSpeed, 1.0, 1e-6);
+	VR_CHECK(clamped.bullets == 1);
+
+	// No spread keys at all (a melee or item script), empty text and a null pointer: not range data,
+	// and out is left alone.
+	WeaponRangeData untouched{};
+	untouched.range = 123.0f;
+	const char melee[] = "MeleeWeaponData { \"damage\" \"50\" \"refire_delay\" \"0.8\" }";
+	VR_CHECK(!WeaponScriptDb::ParseRangeData(melee, sizeof(melee) - 1, untouched));
+	VR_CHECK(!WeaponScriptDb::ParseRangeData("", 0, untouched));
+	VR_CHECK(!WeaponScriptDb::ParseRangeData(nullptr, 42, untouched));
+	VR_CHECK(untouched.range == 123.0f && !untouched.valid);
+}
+
+VR_TEST(FingerprintCoversEveryStampField)
+{
+	const std::vector<WeaponScriptStamp> stamps = SampleStamps();
+	const uint64_t base = WeaponScriptDb::Fingerprint(stamps);
+	VR_CHECK(WeaponScriptDb::Fingerprint(SampleStamps()) == base);
+
+	std::vector<WeaponScriptStamp> touched = stamps;
+	touched[1].writeTime += 1;
+	VR_CHECK(WeaponScriptDb::Fingerprint(touched) != base);
+	touched = stamps;
+	touched[2].size += 1;
+	VR_CHECK(WeaponScriptDb::Fingerprint(touched) != base);
+	touched = stamps;
+	touched[0].path += "x";
+	VR_CHECK(WeaponScriptDb::Fingerprint(touched) != base);
+	touched = stamps;
+	touched.pop_back();     // an addon VPK removed
+	VR_CHECK(WeaponScriptDb::Fingerprint(touched) != base);
+	touched = stamps;
+	std::swap(touched[0], touched[1]);
+	VR_CHECK(WeaponScriptDb::Fingerprint(touched) != base);
+}
+
+VR_TEST(CacheRoundTrip)
+{
+	TempCacheFile file("test_weapon_script_db_roundtrip.bin");
+	const uint64_t fingerprint = WeaponScriptDb::Fingerprint(SampleStamps());
+	const std::vector<WeaponScriptCacheEntry> entries = SampleEntries();
+	VR_CHECK(WeaponScriptDb::SaveCache(file.path, fingerprint, entries));
+
+	std::vector<WeaponScriptCacheEntry> loaded;
+	VR_CHECK(WeaponScriptDb::LoadCache(file.path, fingerprint, loaded));
+	VR_CHECK(SameEntries(entries, loaded));
+
+	// Saving again replaces the file (rename() alone wouldn't on Windows) and leaves no .tmp.
+	std::vector<WeaponScriptCacheEntry> one(entries.begin(), entries.begin() + 1);
+	VR_CHECK(WeaponScriptDb::SaveCache(file.path, fingerprint, one));
+	VR_CHECK(WeaponScriptDb::LoadCache(file.path, fingerprint, loaded));
+	VR_CHECK(SameEntries(one, loaded));
+	FILE* tmp = std::fopen((file.path + ".tmp").c_str(), "rb");
+	VR_CHECK(tmp == nullptr);
+	if (tmp)
+		std::fclose(tmp);
+
+	// An empty table round-trips too.
+	VR_CHECK(WeaponScriptDb::SaveCache(file.path, fingerprint, {}));
+	VR_CHECK(WeaponScriptDb::LoadCache(file.path, fingerprint, loaded));
+	VR_CHECK(loaded.empty());
+}
+
+VR_TEST(RejectsStaleCache)
+{
+	TempCacheFile file("test_weapon_script_db_stale.bin");
+	const std::vector<WeaponScriptStamp> stamps = SampleStamps();
+	VR_CHECK(WeaponScriptDb::SaveCache(file.path, WeaponScriptDb::Fingerprint(stamps), SampleEntries()));
+
+	// A workshop addon updated since the cache was written.
+	std::vector<WeaponScriptStamp> updated = stamps;
+	updated[2].writeTime += 10000000ull;
+	std::vector<WeaponScriptCacheEntry> out = { { 3, WeaponRangeData{} } };
+	VR_CHECK(!WeaponScriptDb::LoadCache(file.path, WeaponScriptDb::Fingerprint(updated), out));
+	VR_CHECK(out.size() == 1 && out[0].slot == 3);
+
+	// Missing file.
+	file.Remove();
+	VR_CHECK(!WeaponScriptDb::LoadCache(file.path, WeaponScriptDb::Fingerprint(stamps), out));
+	VR_CHECK(out.size() == 1);
+}
+
+VR_TEST(RejectsCorruptCache)
+{
+	TempCacheFile file("test_weapon_script_db_corrupt.bin");
+	const uint64_t fingerprint = WeaponScriptDb::Fingerprint(SampleStamps());
+	VR_CHECK(WeaponScriptDb::SaveCache(file.path, fingerprint, SampleEntries()));
+	const std::string good = file.Read();
+	VR_CHECK(good.size() > 32);
+
+	std::vector<WeaponScriptCacheEntry> out;
+	// Every single flipped byte (header, entries, source strings, checksum) is caught.
+	int accepted = 0;
+	for (size_t i = 0; i < good.size(); ++i)
+	{
+		std::string bad = good;
+		bad[i] = static_cast<char>(bad[i] ^ 0x5a);
+		file.Write(bad);
+		accepted += WeaponScriptDb::LoadCache(file.path, fingerprint, out) ? 1 : 0;
+	}
+	VR_CHECK(accepted == 0);
+	VR_CHECK(out.empty());
+
+	// Truncated at every length (a torn write from an older build, or a full disk).
+	for (size_t n = 0; n < good.size(); ++n)
+	{
+		file.Write(good.substr(0, n));
+		accepted += WeaponScriptDb::LoadCache(file.path, fingerprint, out) ? 1 : 0;
+	}
+	VR_CHECK(accepted == 0);
+
+	// Trailing bytes after a valid file.
+	file.Write(good + "junk");
+	VR_CHECK(!WeaponScriptDb::LoadCache(file.path, fingerprint, out));
+
+	// Not a cache at all.
+	file.Write(std::string(kShotgunScript));
+	VR_CHECK(!WeaponScriptDb::LoadCache(file.path, fingerprint, out));
+	VR_CHECK(out.empty());
+
+	// The untouched file still loads.
+	file.Write(good);
+	VR_CHECK(WeaponScriptDb::LoadCache(file.path, fingerprint, out));
+	VR_CHECK(SameEntries(out, SampleEntries()));
+}
+
+VR_TEST(LoaderParsesOnceThenServesFromCache)
+{
+	TempCacheFile file("test_weapon_script_db_loader.bin");
+	FakeGameFiles game;
+	game.files["scripts/weapon_rifle.txt"] = kRifleScript;
+	game.files["scripts/weapon_pumpshotgun.txt"] = kShotgunScript;
+	game.files["scripts/weapon_out_of_range.txt"] = kRifleScript;
+	const uint64_t fingerprint = WeaponScriptDb::Fingerprint(SampleStamps());
+
+	// Cold: every in-range script is read, the missing one is skipped, slot 80 never read.
+	std::vector<WeaponScriptCacheEntry> cold;
+	VR_CHECK(!WeaponScriptDb::LoadOrBuild(file.path, true, fingerprint, kScripts, kScriptCount, kSlotLimit, game, cold));
+	VR_CHECK(game.reads == 3);
+	VR_CHECK(cold.size() == 2);
+	VR_CHECK(cold[0].slot == 5 && cold[1].slot == 7);
+	VR_CHECK(cold[1].data.bullets == 10);
+	VR_CHECK(cold[0].data.source == "pak01_dir.vpk:scripts/weapon_rifle.txt");
+
+	// Warm: same inputs, nothing is read and the table is identical.
+	std::vector<WeaponScriptCacheEntry> warm;
+	VR_CHECK(WeaponScriptDb::LoadOrBuild(file.path, true, fingerprint, kScripts, kScriptCount, kSlotLimit, game, warm));
+	VR_CHECK(game.reads == 3);
+	VR_CHECK(SameEntries(cold, warm));
+
+	// An addon changed: the stale cache is ignored, scripts are read again and the cache rewritten.
+	std::vector<WeaponScriptStamp> updated = SampleStamps();
+	updated[2].size += 512;
+	const uint64_t newFingerprint = WeaponScriptDb::Fingerprint(updated);
+	game.files["scripts/weapon_rifle.txt"] = "WeaponData { \"MinStandingSpread\" \"0.4\" }";
+	std::vector<WeaponScriptCacheEntry> rebuilt;
+	VR_CHECK(!WeaponScriptDb::LoadOrBuild(file.path, true, newFingerprint, kScripts, kScriptCount, kSlotLimit, game, rebuilt));
+	VR_CHECK(game.reads == 6);
+	VR_CHECK(rebuilt.size() == 2 && rebuilt[0].data.minStandingSpread == 0.4f);
+	std::vector<WeaponScriptCacheEntry> reloaded;
+	VR_CHECK(WeaponScriptDb::LoadCache(file.path, newFingerprint, reloaded));
+	VR_CHECK(SameEntries(rebuilt, reloaded));
+}
+
+VR_TEST(LoaderRebuildsOverCorruptCache)
+{
+	TempCacheFile file("test_weapon_script_db_loader_corrupt.bin");
+	FakeGameFiles game;
+	game.files["scripts/weapon_rifle.txt"] = kRifleScript;
+	game.files["scripts/weapon_pumpshotgun.txt"] = kShotgunScript;
+	const uint64_t fingerprint = WeaponScriptDb::Fingerprint(SampleStamps());
+
+	std::vector<WeaponScriptCacheEntry> entries;
+	VR_CHECK(!WeaponScriptDb::LoadOrBuild(file.path, true, fingerprint, kScripts, kScriptCount, kSlotLimit, game, entries));
+	std::string blob = file.Read();
+	blob[blob.size() / 2] = static_cast<char>(blob[blob.size() / 2] ^ 0x01);
+	file.Write(blob);
+
+	const int readsBefore = game.reads;
+	std::vector<WeaponScriptCacheEntry> again;
+	VR_CHECK(!WeaponScriptDb::LoadOrBuild(file.path, true, fingerprint, kScripts, kScriptCount, kSlotLimit, game, again));
+	VR_CHECK(game.reads > readsBefore);
+	VR_CHECK(SameEntries(entries, again));
+	VR_CHECK(WeaponScriptDb::LoadOrBuild(file.path, true, fingerprint, kScripts, kScriptCount, kSlotLimit, game, again));
+	VR_CHECK(SameEntries(entries, again));
+}
+
+VR_TEST(LoaderWithoutStampsNeverTouchesTheCache)
+{
+	// No install directory found: stamps are empty, so a fingerprint would match any other stampless
+	// run. The loader must read the scripts and neither trust nor write a cache.
+	TempCacheFile file("test_weapon_script_db_nostamps.bin");
+	const uint64_t emptyFingerprint = WeaponScriptDb::Fingerprint({});
+	VR_CHECK(WeaponScriptDb::SaveCache(file.path, emptyFingerprint, SampleEntries()));
+	const std::string before = file.Read();
+
+	FakeGameFiles game;
+	game.files["scripts/weapon_rifle.txt"] = "WeaponData { \"MinStandingSpread\" \"0.9\" }";
+	std::vector<WeaponScriptCacheEntry> entries;
+	VR_CHECK(!WeaponScriptDb::LoadOrBuild(file.path, false, emptyFingerprint, kScripts, kScriptCount, kSlotLimit, game, entries));
+	VR_CHECK(game.reads == 3);
+	VR_CHECK(entries.size() == 1 && entries[0].data.minStandingSpread == 0.9f);
+	VR_CHECK(file.Read() == before);
+
+	// Nothing readable: an empty table and still no cache written.
+	file.Remove();
+	FakeGameFiles empty;
+	VR_CHECK(!WeaponScriptDb::LoadOrBuild(file.path, true, emptyFingerprint, kScripts, kScriptCount, kSlotLimit, empty, entries));
+	VR_CHECK(entries.empty());
+	VR_CHECK(file.Read().empty());
+}
+
+int main()
+{
+	return vrtest::RunAllTests();
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// ------------------------------------------------------------
+// Immutable generations published through an atomic pointer.
+//
+// Used for the SteamVR texture descriptors: texture (re)creation builds a complete new set and publishes
+// it in one store, the submit thread reads whatever set is current without taking a lock.
+// Old generations are retired, not freed: they are only deleted once
+//  - no reader is inside a ReadGuard (so nobody can still hold the pointer), and
+//  - the consumer (compositor submit) has completed kGraceFrames frames since the retirement,
+// which keeps descriptors alive until SteamVR has certainly stopped referencing them.
+//
+// Writers (Publish / Reclaim) must be serialized by the caller; readers are wait-free apart from
+// two atomic increments. No engine / Windows dependencies.
+// ------------------------------------------------------------
+template <typename T>
+class GenerationPublisher
+{
+public:
+	static constexpr uint64_t kGraceFrames = 2;
+
+	class ReadGuard
+	{
+	public:
+		explicit ReadGuard(const GenerationPublisher& owner)
+			: m_Owner(&owner)
+		{
+			m_Owner->m_Readers.fetch_add(1, std::memory_order_seq_cst);
+			m_Value = m_Owner->m_Current.load(std::memory_order_seq_cst);
+		}
+
+		~ReadGuard()
+		{
+			if (m_Owner)
+				m_Owner->m_Readers.fetch_sub(1, std::memory_order_seq_cst);
+		}
+
+		ReadGuard(const ReadGuard&) = delete;
+		ReadGuard& operator=(const ReadGuard&) = delete;
+
+		// nullptr until the first Publish().
+		const T* Get() const { return m_Value; }
+
+		// Pick up a generation published while this guard was held (e.g. textures created mid-submit).
+		const T* Refresh()
+		{
+			m_Value = m_Owner->m_Current.load(std::memory_order_seq_cst);
+			return m_Value;
+		}
+
+	private:
+		const GenerationPublisher* m_Owner = nullptr;
+		const T* m_Value = nullptr;
+	};
+
+	GenerationPublisher() = default;
+	GenerationPublisher(const GenerationPublisher&) = delete;
+	GenerationPublisher& operator=(const GenerationPublisher&) = delete;
+
+	~GenerationPublisher()
+	{
+		delete m_Current.exchange(nullptr, std::memory_order_acq_rel);
+		for (Retired& r : m_Retired)
+			delete r.value;
+	}
+
+	// Writer side. Returns the new generation number.
+	uint64_t Publish(std::unique_ptr<T> next)
+	{
+		T* previous = m_Current.exchange(next.release(), std::memory_order_seq_cst);
+		const uint64_t generation = m_Generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+		if (previous)
+			m_Retired.push_back({ previous, m_ConsumerFrames.load(std::memory_order_acquire) });
+		Reclaim();
+		return generation;
+	}
+
+	// Consumer side (submit thread): one frame has been handed to the compositor.
+	void NoteConsumerFrame()
+	{
+		m_ConsumerFrames.fetch_add(1, std::memory_order_acq_rel);
+	}
+
+	// Writer side. Deletes retired generations that are past the grace period. Returns how many were freed.
+	size_t Reclaim()
+	{
+		if (m_Retired.empty())
+			return 0;
+
+		// A reader that incremented m_Readers before our exchange may still hold an old pointer.
+		if (m_Readers.load(std::memory_order_seq_cst) != 0)
+			return 0;
+
+		const uint64_t frames = m_ConsumerFrames.load(std::memory_order_acquire);
+		size_t freed = 0;
+		for (size_t i = 0; i < m_Retired.size();)
+		{
+			if (frames - m_Retired[i].retiredAtFrame >= kGraceFrames)
+			{
+				delete m_Retired[i].value;
+				m_Retired[i] = m_Retired.back();
+				m_Retired.pop_back();
+				++freed;
+				continue;
+			}
+			++i;
+		}
+		m_ReclaimedTotal += freed;
+		return freed;
+	}
+
+	uint64_t GetGeneration() const { return m_Generation.load(std::memory_order_acquire); }
+	size_t GetRetiredCount() const { return m_Retired.size(); }
+	uint64_t GetReclaimedTotal() const { return m_ReclaimedTotal; }
+
+private:
+	struct Retired
+	{
+		T* value = nullptr;
+		uint64_t retiredAtFrame = 0;
+	};
+
+	std::atomic<T*> m_Current{ nullptr };
+	mutable std::atomic<uint32_t> m_Readers{ 0 };
+	std::atomic<uint64_t> m_Generation{ 0 };
+	std::atomic<uint64_t> m_ConsumerFrames{ 0 };
+	std::vector<Retired> m_Retired;
+	uint64_t m_ReclaimedTotal = 0;
+};
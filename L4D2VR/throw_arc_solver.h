@@ -0,0 +1,275 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// ------------------------------------------------------------
+// Throwable trajectory preview.
+//
+// DrawThrowArc used to draw a quadratic Bezier whose length came from a tuned pitch heuristic and
+// never looked at the world. Instead:
+//  - ThrowArcSolver evaluates the flight path in closed form. Air drag is approximated as linear
+//    (dv/dt = g - k v), which has an exact solution, so any point on the path costs a few exps.
+//  - FindFirstHit traces chords of the path to find the first surface, then bisects the hit chord
+//    in time; the total number of traces never exceeds the caller's budget.
+//  - ThrowArcCache keeps the resulting polyline until the launch moves past a threshold (or the
+//    cache ages out, since the world can move), so a still hand costs no traces at all.
+//
+// Z is up (Source convention). No engine / Windows dependencies: the tracer is a template parameter.
+// ------------------------------------------------------------
+
+struct ThrowArcVec3
+{
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+
+	ThrowArcVec3 operator+(const ThrowArcVec3& o) const { return { x + o.x, y + o.y, z + o.z }; }
+	ThrowArcVec3 operator-(const ThrowArcVec3& o) const { return { x - o.x, y - o.y, z - o.z }; }
+	ThrowArcVec3 operator*(float s) const { return { x * s, y * s, z * s }; }
+	float Dot(const ThrowArcVec3& o) const { return x * o.x + y * o.y + z * o.z; }
+	float Length() const { return std::sqrt(Dot(*this)); }
+};
+
+// Per-throwable flight model.
+struct ThrowArcProfile
+{
+	float speed = 700.0f;       // launch speed (units/s)
+	float gravity = 320.0f;     // downward acceleration (sv_gravity x entity gravity scale)
+	float drag = 0.0f;          // linear drag coefficient (1/s); 0 = vacuum
+	float maxTime = 3.0f;       // stop looking for a hit after this long
+};
+
+struct ThrowArcLaunch
+{
+	ThrowArcVec3 origin;
+	ThrowArcVec3 velocity;
+};
+
+struct ThrowArcHit
+{
+	bool hit = false;
+	float time = 0.0f;          // flight time at the hit (maxTime when nothing was hit)
+	ThrowArcVec3 point;
+	ThrowArcVec3 normal;
+	int traces = 0;
+};
+
+class ThrowArcSolver
+{
+public:
+	// Position after t seconds. With drag k: x(t) = x0 + (v0 - vT)(1 - e^-kt)/k + vT t,
+	// where vT = (0, 0, -g/k) is the terminal velocity.
+	static ThrowArcVec3 Position(const ThrowArcLaunch& launch, const ThrowArcProfile& profile, float t)
+	{
+		const float k = profile.drag;
+		if (k < 1e-4f)
+		{
+			ThrowArcVec3 p = launch.origin + launch.velocity * t;
+			p.z -= 0.5f * profile.gravity * t * t;
+			return p;
+		}
+		const float decay = (1.0f - std::exp(-k * t)) / k;
+		const float terminalZ = -profile.gravity / k;
+		ThrowArcVec3 p;
+		p.x = launch.origin.x + launch.velocity.x * decay;
+		p.y = launch.origin.y + launch.velocity.y * decay;
+		p.z = launch.origin.z + (launch.velocity.z - terminalZ) * decay + terminalZ * t;
+		return p;
+	}
+
+	static ThrowArcVec3 Velocity(const ThrowArcLaunch& launch, const ThrowArcProfile& profile, float t)
+	{
+		const float k = profile.drag;
+		if (k < 1e-4f)
+			return { launch.velocity.x, launch.velocity.y, launch.velocity.z - profile.gravity * t };
+		const float e = std::exp(-k * t);
+		const float terminalZ = -profile.gravity / k;
+		return { launch.velocity.x * e, launch.velocity.y * e, terminalZ + (launch.velocity.z - terminalZ) * e };
+	}
+
+	// tracer: bool(const ThrowArcVec3& from, const ThrowArcVec3& to, float& outFraction, ThrowArcVec3& outNormal),
+	// true if the segment hit something. At most maxTraces calls are made (minimum 2).
+	// About two thirds of the budget goes to chords over [0, maxTime], the rest to bisecting the
+	// first chord that hit.
+	template <typename Tracer>
+	static ThrowArcHit FindFirstHit(const ThrowArcLaunch& launch, const ThrowArcProfile& profile, int maxTraces, Tracer&& tracer)
+	{
+		ThrowArcHit result;
+		const int budget = std::max(2, maxTraces);
+		const int refineSteps = std::min(6, budget / 3);
+		const int chords = budget - refineSteps;
+		const float maxTime = std::max(profile.maxTime, 0.05f);
+		const float dt = maxTime / static_cast<float>(chords);
+
+		float lo = 0.0f;
+		float hi = 0.0f;
+		float fraction = 1.0f;
+		ThrowArcVec3 normal;
+		ThrowArcVec3 a = launch.origin;
+		for (int i = 0; i < chords; ++i)
+		{
+			const float t1 = dt * static_cast<float>(i + 1);
+			const ThrowArcVec3 b = Position(launch, profile, t1);
+			++result.traces;
+			if (tracer(a, b, fraction, normal))
+			{
+				lo = dt * static_cast<float>(i);
+				hi = t1;
+				result.hit = true;
+				SetHit(result, a, b, lo, hi, fraction, normal);
+				break;
+			}
+			a = b;
+		}
+
+		if (!result.hit)
+		{
+			result.time = maxTime;
+			result.point = Position(launch, profile, maxTime);
+			return result;
+		}
+
+		// Bisect [lo, hi] in time. A chord from P(lo) to the midpoint that hits narrows to the front
+		// half and becomes the current estimate; a miss narrows to the back half.
+		bool estimateCurrent = true;
+		for (int s = 0; s < refineSteps && result.traces < budget; ++s)
+		{
+			const float mid = 0.5f * (lo + hi);
+			const ThrowArcVec3 pa = Position(launch, profile, lo);
+			const ThrowArcVec3 pm = Position(launch, profile, mid);
+			++result.traces;
+			if (tracer(pa, pm, fraction, normal))
+			{
+				hi = mid;
+				SetHit(result, pa, pm, lo, mid, fraction, normal);
+				estimateCurrent = true;
+			}
+			else
+			{
+				lo = mid;
+				estimateCurrent = false;
+			}
+		}
+
+		// The last step missed: the hit is in [lo, hi] but the estimate is from a longer chord.
+		if (!estimateCurrent && result.traces < budget)
+		{
+			const ThrowArcVec3 pa = Position(launch, profile, lo);
+			const ThrowArcVec3 pb = Position(launch, profile, hi);
+			++result.traces;
+			if (tracer(pa, pb, fraction, normal))
+				SetHit(result, pa, pb, lo, hi, fraction, normal);
+		}
+		return result;
+	}
+
+	// Time within [0, maxTime] at which the falling path crosses height planeZ. False when the flight
+	// stays above the plane, or never rises to it.
+	static bool PlaneCrossingTime(const ThrowArcLaunch& launch, const ThrowArcProfile& profile, float planeZ, float& outTime)
+	{
+		const float maxTime = std::max(profile.maxTime, 0.05f);
+		// Height rises to the apex and then falls, so after the apex there is a single crossing.
+		float lo = std::min(ApexTime(launch, profile), maxTime);
+		if (Position(launch, profile, lo).z < planeZ || Position(launch, profile, maxTime).z > planeZ)
+			return false;
+		float hi = maxTime;
+		for (int i = 0; i < 24; ++i)
+		{
+			const float mid = 0.5f * (lo + hi);
+			if (Position(launch, profile, mid).z > planeZ)
+				lo = mid;
+			else
+				hi = mid;
+		}
+		outTime = hi;
+		return true;
+	}
+
+	// Time of the highest point (0 when launched downward).
+	static float ApexTime(const ThrowArcLaunch& launch, const ThrowArcProfile& profile)
+	{
+		const float vz = launch.velocity.z;
+		if (vz <= 0.0f || profile.gravity <= 0.0f)
+			return 0.0f;
+		const float k = profile.drag;
+		if (k < 1e-4f)
+			return vz / profile.gravity;
+		// vz(t) = vT + (vz - vT) e^-kt = 0 with vT = -g/k.
+		return std::log(1.0f + k * vz / profile.gravity) / k;
+	}
+
+	// Samples [0, endTime] into count points (count >= 2), uniformly in time.
+	static void BuildPolyline(const ThrowArcLaunch& launch, const ThrowArcProfile& profile, float endTime, ThrowArcVec3* out, int count)
+	{
+		if (!out || count < 2)
+			return;
+		for (int i = 0; i < count; ++i)
+		{
+			const float t = endTime * static_cast<float>(i) / static_cast<float>(count - 1);
+			out[i] = Position(launch, profile, t);
+		}
+	}
+
+private:
+	static void SetHit(ThrowArcHit& result, const ThrowArcVec3& a, const ThrowArcVec3& b, float t0, float t1, float fraction, const ThrowArcVec3& normal)
+	{
+		const float f = std::clamp(fraction, 0.0f, 1.0f);
+		result.point = a + (b - a) * f;
+		result.time = t0 + (t1 - t0) * f;
+		result.normal = normal;
+	}
+};
+
+// Solved arc for one launch, reused while the launch stays within the thresholds.
+template <int MaxPoints>
+class ThrowArcCache
+{
+public:
+	float m_OriginThreshold = 1.0f;        // game units
+	float m_DirectionCos = 0.99996f;       // ~0.5 degrees
+	float m_MaxAgeSeconds = 0.25f;         // world geometry can move under a still arc
+
+	bool IsValid(const ThrowArcLaunch& launch, int profileId, double nowSeconds) const
+	{
+		if (!m_Valid || profileId != m_ProfileId || nowSeconds - m_BuiltAt > m_MaxAgeSeconds || nowSeconds < m_BuiltAt)
+			return false;
+		const ThrowArcVec3 d = launch.origin - m_Launch.origin;
+		if (d.Dot(d) > m_OriginThreshold * m_OriginThreshold)
+			return false;
+		const float la = launch.velocity.Length();
+		const float lb = m_Launch.velocity.Length();
+		if (!(la > 0.0f) || !(lb > 0.0f) || std::fabs(la - lb) > 1.0f)
+			return false;
+		return launch.velocity.Dot(m_Launch.velocity) / (la * lb) >= m_DirectionCos;
+	}
+
+	void Store(const ThrowArcLaunch& launch, int profileId, double nowSeconds, const ThrowArcHit& hit, const ThrowArcVec3* points, int count)
+	{
+		m_Launch = launch;
+		m_ProfileId = profileId;
+		m_BuiltAt = nowSeconds;
+		m_Hit = hit;
+		m_Count = std::clamp(count, 0, MaxPoints);
+		std::copy(points, points + m_Count, m_Points);
+		m_Valid = true;
+		++m_Builds;
+	}
+
+	void Invalidate() { m_Valid = false; }
+
+	const ThrowArcHit& GetHit() const { return m_Hit; }
+	const ThrowArcVec3* GetPoints() const { return m_Points; }
+	int GetCount() const { return m_Count; }
+	uint64_t GetBuilds() const { return m_Builds; }
+
+private:
+	ThrowArcLaunch m_Launch{};
+	ThrowArcHit m_Hit{};
+	ThrowArcVec3 m_Points[MaxPoints]{};
+	int m_Count = 0;
+	int m_ProfileId = -1;
+	double m_BuiltAt = 0.0;
+	bool m_Valid = false;
+	uint64_t m_Builds = 0;
+};
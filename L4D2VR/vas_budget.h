@@ -0,0 +1,274 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// ------------------------------------------------------------
+// Virtual address space budget (32-bit process).
+//
+// LogVAS only reported the address space after the fact. Eye / optics / HUD targets, kill-indicator
+// textures, decoded frame caches and DXVK's mapped texture chunks add up to the 4 GB limit on long
+// campaigns with addons. This keeps a running picture and lets the owners give memory back:
+//  - the caller feeds samples (free total, largest free block); the cheap free total is enough while
+//    there is plenty of room, the region walk for the largest block is only asked for near the limit,
+//  - the mod's own allocations are tracked per category (estimates, for the log and for policy),
+//  - a pressure level (Normal .. Critical) is derived from the sample. Rising is immediate, falling
+//    needs the free space to clear the threshold by a margin, so listeners don't flap;
+//    listeners are called on the sampling thread whenever the level changes,
+//  - VasMappedTrim decides when DXVK's mapped texture memory is handed back.
+// No engine / Windows dependencies.
+// ------------------------------------------------------------
+
+enum class VasCategory : int
+{
+	EyeTargets = 0,
+	OpticsTargets,
+	HudTargets,
+	KillIndicatorTextures,
+	DecodedFrameCache,
+	Count
+};
+
+enum class VasPressure : int
+{
+	Normal = 0,
+	Elevated,
+	High,
+	Critical
+};
+
+struct VasSample
+{
+	uint64_t freeTotal = 0;
+	uint64_t freeLargest = 0;
+};
+
+struct VasThresholds
+{
+	// Levels are entered when either value drops below its threshold.
+	uint64_t largestElevated = 384ull << 20;
+	uint64_t largestHigh = 192ull << 20;
+	uint64_t largestCritical = 96ull << 20;
+	uint64_t totalElevated = 768ull << 20;
+	uint64_t totalHigh = 448ull << 20;
+	uint64_t totalCritical = 224ull << 20;
+	float releaseMargin = 1.25f;        // to fall back a level, free space must clear its threshold by this factor
+	double walkIntervalSeconds = 10.0;  // full region walk at least this often even when there is room
+};
+
+class VasBudget
+{
+public:
+	using Listener = std::function<void(VasPressure previous, VasPressure current)>;
+
+	void SetThresholds(const VasThresholds& thresholds) { m_Thresholds = thresholds; }
+	const VasThresholds& GetThresholds() const { return m_Thresholds; }
+
+	// Any thread.
+	void Track(VasCategory category, int64_t deltaBytes)
+	{
+		std::atomic<int64_t>& slot = m_Tracked[static_cast<size_t>(category)];
+		int64_t current = slot.load(std::memory_order_relaxed);
+		while (!slot.compare_exchange_weak(current, std::max<int64_t>(0, current + deltaBytes), std::memory_order_relaxed))
+		{
+		}
+	}
+
+	void SetTracked(VasCategory category, uint64_t bytes)
+	{
+		m_Tracked[static_cast<size_t>(category)].store(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+	}
+
+	uint64_t GetTracked(VasCategory category) const
+	{
+		return static_cast<uint64_t>(m_Tracked[static_cast<size_t>(category)].load(std::memory_order_relaxed));
+	}
+
+	uint64_t GetTrackedTotal() const
+	{
+		uint64_t total = 0;
+		for (const std::atomic<int64_t>& slot : m_Tracked)
+			total += static_cast<uint64_t>(slot.load(std::memory_order_relaxed));
+		return total;
+	}
+
+	// The sampling thread owns everything below.
+	int Subscribe(Listener listener)
+	{
+		const int id = ++m_NextListenerId;
+		m_Listeners.emplace_back(id, std::move(listener));
+		return id;
+	}
+
+	void Unsubscribe(int id)
+	{
+		m_Listeners.erase(std::remove_if(m_Listeners.begin(), m_Listeners.end(),
+			[id](const std::pair<int, Listener>& l) { return l.first == id; }), m_Listeners.end());
+	}
+
+	// Sampling gets more frequent as the pressure rises.
+	double GetSampleInterval() const
+	{
+		static constexpr double kIntervals[] = { 2.0, 1.0, 0.5, 0.25 };
+		return kIntervals[static_cast<int>(m_Pressure)];
+	}
+
+	bool SampleDue(double now) const { return m_LastSampleTime < 0.0 || now - m_LastSampleTime >= GetSampleInterval(); }
+
+	// Whether this sample needs the (slow) largest-free-block walk, given the cheap free total.
+	bool WantsRegionWalk(uint64_t freeTotal, double now) const
+	{
+		if (m_Pressure != VasPressure::Normal || m_LastWalkTime < 0.0)
+			return true;
+		if (freeTotal < m_Thresholds.totalElevated * 2)
+			return true;
+		return now - m_LastWalkTime >= m_Thresholds.walkIntervalSeconds;
+	}
+
+	// sample.freeLargest == 0 means the walk was skipped: the last walked value is kept (capped by
+	// the free total). Returns the new level; listeners have been told if it changed.
+	VasPressure Update(const VasSample& sample, double now)
+	{
+		m_LastSampleTime = now;
+		VasSample s = sample;
+		if (s.freeLargest != 0)
+		{
+			m_LastWalkTime = now;
+			m_LastLargest = s.freeLargest;
+		}
+		else
+		{
+			s.freeLargest = std::min(m_LastLargest != 0 ? m_LastLargest : s.freeTotal, s.freeTotal);
+		}
+		m_LastSample = s;
+
+		const VasPressure raw = Classify(s, 1.0f);
+		VasPressure next = m_Pressure;
+		if (raw > m_Pressure)
+			next = raw;
+		else if (raw < m_Pressure)
+			next = std::min(m_Pressure, Classify(s, m_Thresholds.releaseMargin));
+
+		if (next != m_Pressure)
+		{
+			const VasPressure previous = m_Pressure;
+			m_Pressure = next;
+			++m_Transitions;
+			// Copy: a listener may subscribe / unsubscribe.
+			const std::vector<std::pair<int, Listener>> listeners = m_Listeners;
+			for (const auto& l : listeners)
+			{
+				if (l.second)
+					l.second(previous, next);
+			}
+		}
+		return m_Pressure;
+	}
+
+	VasPressure GetPressure() const { return m_Pressure; }
+	const VasSample& GetLastSample() const { return m_LastSample; }
+	uint32_t GetTransitions() const { return m_Transitions; }
+
+	VasPressure Classify(const VasSample& s, float margin) const
+	{
+		auto below = [margin](uint64_t value, uint64_t threshold)
+			{
+				return static_cast<double>(value) < static_cast<double>(threshold) * margin;
+			};
+		if (below(s.freeLargest, m_Thresholds.largestCritical) || below(s.freeTotal, m_Thresholds.totalCritical))
+			return VasPressure::Critical;
+		if (below(s.freeLargest, m_Thresholds.largestHigh) || below(s.freeTotal, m_Thresholds.totalHigh))
+			return VasPressure::High;
+		if (below(s.freeLargest, m_Thresholds.largestElevated) || below(s.freeTotal, m_Thresholds.totalElevated))
+			return VasPressure::Elevated;
+		return VasPressure::Normal;
+	}
+
+	static const char* PressureName(VasPressure pressure)
+	{
+		switch (pressure)
+		{
+		case VasPressure::Elevated: return "elevated";
+		case VasPressure::High: return "high";
+		case VasPressure::Critical: return "critical";
+		default: return "normal";
+		}
+	}
+
+	static const char* CategoryName(VasCategory category)
+	{
+		switch (category)
+		{
+		case VasCategory::EyeTargets: return "eye";
+		case VasCategory::OpticsTargets: return "optics";
+		case VasCategory::HudTargets: return "hud";
+		case VasCategory::KillIndicatorTextures: return "killind";
+		case VasCategory::DecodedFrameCache: return "frames";
+		default: return "?";
+		}
+	}
+
+private:
+	VasThresholds m_Thresholds;
+	std::array<std::atomic<int64_t>, static_cast<size_t>(VasCategory::Count)> m_Tracked{};
+	std::vector<std::pair<int, Listener>> m_Listeners;
+	int m_NextListenerId = 0;
+	VasPressure m_Pressure = VasPressure::Normal;
+	VasSample m_LastSample;
+	uint64_t m_LastLargest = 0;
+	double m_LastSampleTime = -1.0;
+	double m_LastWalkTime = -1.0;
+	uint32_t m_Transitions = 0;
+};
+
+// When to unmap DXVK's mapped texture chunks: on every rise in pressure, down to a per-level target,
+// and while Critical again once DXVK has mapped a meaningful amount since the last trim (a full
+// unmap on every sample just thrashes the same textures).
+class VasMappedTrim
+{
+public:
+	static constexpr double kRetrimIntervalSeconds = 2.0;
+	static constexpr uint32_t kRegrowthBytes = 32u << 20;
+
+	// Mapped bytes to trim down to; UINT32_MAX (Normal) leaves everything mapped.
+	static uint32_t TargetBytes(VasPressure pressure)
+	{
+		static constexpr uint32_t kTargets[] = { UINT32_MAX, 256u << 20, 128u << 20, 0u };
+		return kTargets[static_cast<int>(pressure)];
+	}
+
+	static bool TrimOnTransition(VasPressure previous, VasPressure current)
+	{
+		return current > previous && current != VasPressure::Normal;
+	}
+
+	// Checked before asking DXVK how much is mapped.
+	bool RetrimDue(VasPressure pressure, double now) const
+	{
+		return pressure == VasPressure::Critical && now - m_LastTrimTime >= kRetrimIntervalSeconds;
+	}
+
+	bool Regrown(uint32_t mappedBytes) const
+	{
+		return static_cast<uint64_t>(mappedBytes) >= static_cast<uint64_t>(m_MappedAfterTrim) + kRegrowthBytes;
+	}
+
+	void Trimmed(uint32_t mappedAfter, double now)
+	{
+		m_MappedAfterTrim = mappedAfter;
+		m_LastTrimTime = now;
+		++m_Trims;
+	}
+
+	uint32_t GetMappedAfterTrim() const { return m_MappedAfterTrim; }
+	uint32_t GetTrims() const { return m_Trims; }
+
+private:
+	uint32_t m_MappedAfterTrim = 0;
+	double m_LastTrimTime = -1.0e9;
+	uint32_t m_Trims = 0;
+};
@@ -0,0 +1,268 @@
+#pragma once
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// ------------------------------------------------------------
+// Viewmodel adjustment table.
+//
+// Adjustments used to live in an unordered_map keyed by strings ("weapon:pistol", "melee:katana")
+// that were rebuilt and looked up every frame. Now:
+//  - every key resolves once to a slot: weapon ids map straight onto slots [0, kWeaponIds), melee
+//    scripts and anything else (hand-written keys, unknown weapon ids) are interned after them,
+//  - the caller resolves a slot when the active weapon changes and reads the adjustment by index,
+//  - Serialize / Parse keep the viewmodel_adjustments.txt line format
+//    (key=px,py,pz;ax,ay,az), writing only the slots that were set, sorted by key,
+//  - SaveAtomic writes path.tmp and swaps it in, so a crash never leaves a half-written file.
+// No engine / Windows dependencies.
+// ------------------------------------------------------------
+
+struct ViewmodelAdjustValue
+{
+	float position[3] = { 0.0f, 0.0f, 0.0f };
+	float angle[3] = { 0.0f, 0.0f, 0.0f };
+};
+
+class ViewmodelAdjustTable
+{
+public:
+	// L4D2 weapon ids in order (C_WeaponCSBase::WeaponID).
+	static const char* WeaponName(int weaponId)
+	{
+		static const char* const kNames[] =
+		{
+			"none", "pistol", "uzi", "pumpshotgun", "autoshotgun", "m16a1", "hunting_rifle", "mac10",
+			"shotgun_chrome", "scar", "sniper_military", "spas", "first_aid_kit", "molotov", "pipe_bomb",
+			"pain_pills", "gascan", "propane_tank", "oxygen_tank", "melee", "chainsaw", "grenade_launcher",
+			"ammo_pack", "adrenaline", "defibrillator", "vomitjar", "ak47", "gnome_chompski", "cola_bottles",
+			"fireworks_box", "incendiary_ammo", "frag_ammo", "magnum", "mp5", "sg552", "awp", "scout", "m60",
+			"tank_claw", "hunter_claw", "charger_claw", "boomer_claw", "smoker_claw", "spitter_claw",
+			"jockey_claw", "machinegun", "vomit", "splat", "pounce", "lounge", "pull", "choke", "rock",
+			"physics", "ammo", "upgrade_item"
+		};
+		static_assert(sizeof(kNames) / sizeof(kNames[0]) == kWeaponIds, "weapon name table out of sync");
+		return weaponId >= 0 && weaponId < kWeaponIds ? kNames[weaponId] : "";
+	}
+
+	static constexpr int kWeaponIds = 56;
+
+	// Canonical form of a key from the file or from the game: trimmed, melee names lower case,
+	// numeric weapon ids ("weapon:3") replaced by their names.
+	static std::string NormalizeKey(const std::string& rawKey)
+	{
+		std::string key = Trim(rawKey);
+		static const std::string kWeapon = "weapon:";
+		static const std::string kMelee = "melee:";
+		if (key.compare(0, kWeapon.size(), kWeapon) == 0)
+		{
+			const std::string rest = key.substr(kWeapon.size());
+			if (!rest.empty() && rest.size() <= 4 && std::all_of(rest.begin(), rest.end(), [](unsigned char c) { return std::isdigit(c) != 0; }))
+			{
+				const char* name = WeaponName(std::atoi(rest.c_str()));
+				if (*name)
+					return kWeapon + name;
+			}
+		}
+		else if (key.compare(0, kMelee.size(), kMelee) == 0)
+		{
+			std::transform(key.begin() + kMelee.size(), key.end(), key.begin() + kMelee.size(),
+				[](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		}
+		return key;
+	}
+
+	ViewmodelAdjustTable() { Clear(); }
+
+	void Clear()
+	{
+		m_Entries.assign(kWeaponIds, Entry{});
+		for (int i = 0; i < kWeaponIds; ++i)
+			m_Entries[static_cast<size_t>(i)].key = std::string("weapon:") + WeaponName(i);
+		m_Interned.clear();
+	}
+
+	int WeaponSlot(int weaponId)
+	{
+		if (weaponId >= 0 && weaponId < kWeaponIds)
+			return weaponId;
+		return Intern("weapon:" + std::to_string(weaponId));
+	}
+
+	// meleeScriptName as reported by the game; empty when it couldn't be read.
+	int MeleeSlot(const std::string& meleeScriptName)
+	{
+		return Intern(NormalizeKey("melee:" + (meleeScriptName.empty() ? std::string("unknown") : meleeScriptName)));
+	}
+
+	int SlotForKey(const std::string& rawKey)
+	{
+		const std::string key = NormalizeKey(rawKey);
+		static const std::string kWeapon = "weapon:";
+		if (key.compare(0, kWeapon.size(), kWeapon) == 0)
+		{
+			for (int i = 0; i < kWeaponIds; ++i)
+			{
+				if (key.compare(kWeapon.size(), std::string::npos, WeaponName(i)) == 0)
+					return i;
+			}
+		}
+		return Intern(key);
+	}
+
+	int GetSlotCount() const { return static_cast<int>(m_Entries.size()); }
+	const std::string& GetKey(int slot) const { return m_Entries[static_cast<size_t>(slot)].key; }
+	bool IsSet(int slot) const { return InRange(slot) && m_Entries[static_cast<size_t>(slot)].set; }
+
+	const ViewmodelAdjustValue& Get(int slot, const ViewmodelAdjustValue& fallback) const
+	{
+		return IsSet(slot) ? m_Entries[static_cast<size_t>(slot)].value : fallback;
+	}
+
+	void Set(int slot, const ViewmodelAdjustValue& value)
+	{
+		if (!InRange(slot))
+			return;
+		Entry& e = m_Entries[static_cast<size_t>(slot)];
+		e.value = value;
+		e.set = true;
+	}
+
+	// Lines of key=px,py,pz;ax,ay,az. Components that are missing or unreadable take the fallback's.
+	// Returns the number of entries read.
+	int Parse(const std::string& text, const ViewmodelAdjustValue& fallback)
+	{
+		int count = 0;
+		size_t lineStart = 0;
+		while (lineStart < text.size())
+		{
+			size_t lineEnd = text.find('\n', lineStart);
+			if (lineEnd == std::string::npos)
+				lineEnd = text.size();
+			const std::string line = Trim(text.substr(lineStart, lineEnd - lineStart));
+			lineStart = lineEnd + 1;
+			if (line.empty())
+				continue;
+
+			const size_t eq = line.find('=');
+			const size_t separator = line.find(';', eq == std::string::npos ? 0 : eq + 1);
+			if (eq == std::string::npos || separator == std::string::npos || separator <= eq)
+				continue;
+			const std::string key = Trim(line.substr(0, eq));
+			if (key.empty())
+				continue;
+
+			ViewmodelAdjustValue value = fallback;
+			ParseVector3(line.substr(eq + 1, separator - eq - 1), value.position);
+			ParseVector3(line.substr(separator + 1), value.angle);
+			Set(SlotForKey(key), value);
+			++count;
+		}
+		return count;
+	}
+
+	std::string Serialize() const
+	{
+		std::vector<const Entry*> set;
+		for (const Entry& e : m_Entries)
+		{
+			if (e.set)
+				set.push_back(&e);
+		}
+		std::sort(set.begin(), set.end(), [](const Entry* a, const Entry* b) { return a->key < b->key; });
+
+		std::string out;
+		char buffer[160];
+		for (const Entry* e : set)
+		{
+			const ViewmodelAdjustValue& v = e->value;
+			std::snprintf(buffer, sizeof(buffer), "=%g,%g,%g;%g,%g,%g\n",
+				v.position[0], v.position[1], v.position[2], v.angle[0], v.angle[1], v.angle[2]);
+			out += e->key;
+			out += buffer;
+		}
+		return out;
+	}
+
+	// replace(tmp, path) must swap tmp in over an existing path (MoveFileEx on Windows); the default
+	// is std::rename, which does that on POSIX.
+	static bool SaveAtomic(const std::string& path, const std::string& text,
+		const std::function<bool(const std::string&, const std::string&)>& replace = {})
+	{
+		const std::string tmp = path + ".tmp";
+		FILE* f = std::fopen(tmp.c_str(), "wb");
+		if (!f)
+			return false;
+		const bool written = std::fwrite(text.data(), 1, text.size(), f) == text.size();
+		const bool flushed = std::fflush(f) == 0;
+		const bool closed = std::fclose(f) == 0;
+		const bool swapped = written && flushed && closed &&
+			(replace ? replace(tmp, path) : std::rename(tmp.c_str(), path.c_str()) == 0);
+		if (!swapped)
+			std::remove(tmp.c_str());
+		return swapped;
+	}
+
+private:
+	struct Entry
+	{
+		std::string key;
+		ViewmodelAdjustValue value;
+		bool set = false;
+	};
+
+	bool InRange(int slot) const { return slot >= 0 && slot < static_cast<int>(m_Entries.size()); }
+
+	int Intern(const std::string& key)
+	{
+		auto it = m_Interned.find(key);
+		if (it != m_Interned.end())
+			return it->second;
+		const int slot = static_cast<int>(m_Entries.size());
+		Entry e;
+		e.key = key;
+		m_Entries.push_back(std::move(e));
+		m_Interned.emplace(key, slot);
+		return slot;
+	}
+
+	static std::string Trim(const std::string& s)
+	{
+		size_t b = 0;
+		size_t e = s.size();
+		while (b < e && std::isspace(static_cast<unsigned char>(s[b])))
+			++b;
+		while (e > b && std::isspace(static_cast<unsigned char>(s[e - 1])))
+			--e;
+		return s.substr(b, e - b);
+	}
+
+	static void ParseVector3(const std::string& raw, float (&out)[3])
+	{
+		size_t start = 0;
+		for (int i = 0; i < 3 && start <= raw.size(); ++i)
+		{
+			size_t comma = raw.find(',', start);
+			if (comma == std::string::npos)
+				comma = raw.size();
+			const std::string token = Trim(raw.substr(start, comma - start));
+			if (!token.empty())
+			{
+				char* end = nullptr;
+				const float v = std::strtof(token.c_str(), &end);
+				if (end != token.c_str() && std::isfinite(v))   // out of range / nan keep the fallback
+					out[i] = v;
+			}
+			start = comma + 1;
+		}
+	}
+
+	std::vector<Entry> m_Entries;
+	std::unordered_map<std::string, int> m_Interned;
+};
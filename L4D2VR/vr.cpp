@@ -43,6 +43,11 @@ namespace
     // NOTE: “被控放行”要宁可保守：只在「确实是控制者本人」且「目标非常贴近队友」时才放行。
     // Used by VR::UpdateFriendlyFireAimHit().
     constexpr float kAllowThroughControlledTeammateMaxDist = 64.0f; // units (conservative)
+    inline Vec3 ToVec3(const Vector& v)
+    {
+        return Vec3(v.x, v.y, v.z);
+    }
+
     // Returns true if the call should be skipped because we ran it too recently.
     inline bool ShouldThrottle(std::chrono::steady_clock::time_point& last, float maxHz)
     {
@@ -61,6 +66,12 @@ namespace
         return false;
     }
 
+    // Seconds on the steady clock, for the clock-agnostic helpers (hit_feedback_ledger.h).
+    inline double SteadySeconds(std::chrono::steady_clock::time_point t)
+    {
+        return std::chrono::duration<double>(t.time_since_epoch()).count();
+    }
+
     inline float MinIntervalSeconds(float maxHz)
     {
         if (maxHz <= 0.0f)
@@ -87,45 +98,6 @@ namespace
         return -1;
     }
 
-    // Roomscale 1:1 delta packing.
-    //
-    // We originally used a 32-bit payload stored in CUserCmd::weaponsubtype. In practice,
-    // some builds/routes appear to truncate this field during usercmd serialization.
-    // To be robust, prefer a compact 15-bit format (1 marker + 7-bit signed X + 7-bit signed Y)
-    // that survives 16-bit truncation, while still accepting the legacy 32-bit format.
-    static constexpr uint32_t kRSMarker32 = 0x80000000u;
-
-    static constexpr uint32_t kRSMarker15 = 0x00004000u; // bit 14
-    static constexpr int kAxisBits15 = 7;
-    static constexpr int kAxisMask15 = (1 << kAxisBits15) - 1; // 0x7F
-    static constexpr int kAxisBias15 = 1 << (kAxisBits15 - 1); // 64
-
-    static constexpr int kAxisBits32 = 15;
-    static constexpr int kAxisMask32 = (1 << kAxisBits32) - 1;
-    static constexpr int kAxisBias32 = 1 << (kAxisBits32 - 1);
-
-    static inline int QuantizeCm(float meters)
-    {
-        int cm = (int)roundf(meters * 100.0f);
-        if (cm < -kAxisBias32) cm = -kAxisBias32;
-        if (cm > (kAxisBias32 - 1)) cm = (kAxisBias32 - 1);
-        return cm;
-    }
-
-    static inline uint32_t PackDeltaCm(int dx, int dy)
-    {
-        // Compact 15-bit format: marker + 7-bit signed dx + 7-bit signed dy (centimeters).
-        // Clamp to +/-63cm per command to guarantee it fits.
-        if (dx < -(kAxisBias15 - 1)) dx = -(kAxisBias15 - 1);
-        if (dx > (kAxisBias15 - 1))  dx = (kAxisBias15 - 1);
-        if (dy < -(kAxisBias15 - 1)) dy = -(kAxisBias15 - 1);
-        if (dy > (kAxisBias15 - 1))  dy = (kAxisBias15 - 1);
-
-        uint32_t ux = (uint32_t)((dx + kAxisBias15) & kAxisMask15);
-        uint32_t uy = (uint32_t)((dy + kAxisBias15) & kAxisMask15);
-        return kRSMarker15 | ux | (uy << kAxisBits15);
-    }
-
     struct VASStats
     {
         size_t freeTotal = 0;
@@ -1588,6 +1560,18 @@ namespace
         uint32_t height = 0;
         float frameRate = 0.0f;
         std::vector<std::vector<uint8_t>> frames;
+        size_t bytes = 0;
+        uint64_t lastUse = 0;
+    };
+
+    // Decoded frames by lowercase material name, bounded by a byte budget the VAS budget lowers
+    // under pressure. Main thread only.
+    struct KillIndicatorDecodedFrameStore
+    {
+        std::unordered_map<std::string, KillIndicatorDecodedFrames> entries;
+        size_t totalBytes = 0;
+        size_t byteBudget = SIZE_MAX;
+        uint64_t useTick = 0;
     };
 
     static std::string NormalizeSlashes(std::string value, char slash)
@@ -1597,14 +1581,6 @@ namespace
         return value;
     }
 
-    static std::string TrimQuotesCopy(std::string value)
-    {
-        value = TrimCopy(value);
-        if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
-            value = value.substr(1, value.size() - 2);
-        return value;
-    }
-
     static size_t BytesPerBlockForImageFormat(ImageFormat format)
     {
         switch (format)
@@ -1861,100 +1837,6 @@ namespace
         return outWidth > 0 && outHeight > 0;
     }
 
-    static bool ParseTrailingBoolValue(const std::string& line, const char* key, bool& outValue)
-    {
-        if (!key || !*key)
-            return false;
-
-        const std::string trimmed = TrimCopy(line);
-        const std::string lowered = ToLowerCopy(trimmed);
-        const std::string loweredKey = ToLowerCopy(key);
-        const size_t keyPos = lowered.find(loweredKey);
-        if (keyPos == std::string::npos)
-            return false;
-
-        std::string tail = ToLowerCopy(TrimQuotesCopy(trimmed.substr(keyPos + loweredKey.size())));
-        if (tail.empty())
-            return false;
-
-        if (tail == "1" || tail == "true" || tail == "yes")
-        {
-            outValue = true;
-            return true;
-        }
-        if (tail == "0" || tail == "false" || tail == "no")
-        {
-            outValue = false;
-            return true;
-        }
-
-        return false;
-    }
-
-    static bool ParseQuotedMaterialValue(const std::string& line, const char* key, std::string& outValue)
-    {
-        if (!key || !*key)
-            return false;
-
-        const std::string trimmed = TrimCopy(line);
-        const std::string lowered = ToLowerCopy(trimmed);
-        const std::string loweredKey = ToLowerCopy(key);
-        const size_t keyPos = lowered.find(loweredKey);
-        if (keyPos == std::string::npos)
-            return false;
-
-        size_t searchPos = keyPos + loweredKey.size();
-        while (searchPos < trimmed.size() && std::isspace(static_cast<unsigned char>(trimmed[searchPos])))
-            ++searchPos;
-
-        if (searchPos >= trimmed.size() || trimmed[searchPos] != '"')
-            return false;
-
-        size_t firstQuote = searchPos;
-        size_t secondQuote = trimmed.find('"', firstQuote + 1);
-        if (secondQuote == std::string::npos)
-            return false;
-
-        std::string candidate = TrimCopy(trimmed.substr(firstQuote + 1, secondQuote - firstQuote - 1));
-        if (!candidate.empty())
-        {
-            outValue = candidate;
-            return true;
-        }
-
-        firstQuote = secondQuote;
-        secondQuote = trimmed.find('"', firstQuote + 1);
-        if (secondQuote == std::string::npos)
-            return false;
-
-        outValue = TrimCopy(trimmed.substr(firstQuote + 1, secondQuote - firstQuote - 1));
-        return !outValue.empty();
-    }
-
-    static bool ParseTrailingFloatValue(const std::string& line, const char* key, float& outValue)
-    {
-        if (!key || !*key)
-            return false;
-
-        const std::string trimmed = TrimCopy(line);
-        const std::string lowered = ToLowerCopy(trimmed);
-        const std::string loweredKey = ToLowerCopy(key);
-        const size_t keyPos = lowered.find(loweredKey);
-        if (keyPos == std::string::npos)
-            return false;
-
-        std::string tail = TrimQuotesCopy(trimmed.substr(keyPos + loweredKey.size()));
-        if (tail.empty())
-            return false;
-
-        char* endPtr = nullptr;
-        const float value = std::strtof(tail.c_str(), &endPtr);
-        if (endPtr == tail.c_str())
-            return false;
-        outValue = value;
-        return true;
-    }
-
     static bool LoadKillIndicatorDecodedFramesFromDisk(const std::string& materialName, KillIndicatorDecodedFrames& outFrames)
     {
         const std::string moduleDir = GetModuleDirectoryA();
@@ -1968,40 +1850,27 @@ namespace
         const std::string materialsDir = JoinWindowsPath(JoinWindowsPath(moduleDir, "left4dead2"), "materials");
         const std::string vmtPath = JoinWindowsPath(materialsDir, NormalizeSlashes(normalizedMaterial, '\\') + ".vmt");
 
-        std::ifstream vmtFile(vmtPath);
+        std::ifstream vmtFile(vmtPath, std::ios::binary);
         if (!vmtFile.is_open())
             return false;
+        const std::string vmtText((std::istreambuf_iterator<char>(vmtFile)), std::istreambuf_iterator<char>());
+
+        // "Shader" { "$basetexture" ... "$additive" ... "Proxies" { "AnimatedTexture" { "animatedTextureFrameRate" ... } } }
+        KeyValuesDocument vmt;
+        vmt.Parse(vmtText);
+        const int material = vmt.FirstChild(KeyValuesDocument::kRoot);
 
         std::string baseTexture = normalizedMaterial;
-        float frameRate = 0.0f;
-        bool additive = false;
-        std::string line;
-        while (std::getline(vmtFile, line))
-        {
-            std::string parsedValue;
-            if (ParseQuotedMaterialValue(line, "$basetexture", parsedValue))
-                baseTexture = NormalizeMaterialPathSpec(parsedValue);
+        const std::string_view parsedBaseTexture = vmt.Value(vmt.Find(material, "$basetexture"));
+        if (!parsedBaseTexture.empty())
+            baseTexture = NormalizeMaterialPathSpec(std::string(parsedBaseTexture));
 
-            float parsedRate = 0.0f;
-            if (ParseTrailingFloatValue(line, "animatedTextureFrameRate", parsedRate))
-                frameRate = (std::max)(0.0f, parsedRate);
+        float frameRate = 0.0f;
+        if (vmt.GetFloat(vmt.FindRecursive(material, "animatedTextureFrameRate"), frameRate))
+            frameRate = (std::max)(0.0f, frameRate);
 
-            std::string parsedBoolValue;
-            if (ParseQuotedMaterialValue(line, "$additive", parsedBoolValue))
-            {
-                const std::string loweredBool = ToLowerCopy(TrimQuotesCopy(parsedBoolValue));
-                if (loweredBool == "1" || loweredBool == "true" || loweredBool == "yes")
-                    additive = true;
-                else if (loweredBool == "0" || loweredBool == "false" || loweredBool == "no")
-                    additive = false;
-            }
-            else
-            {
-                bool parsedAdditive = false;
-                if (ParseTrailingBoolValue(line, "$additive", parsedAdditive))
-                    additive = parsedAdditive;
-            }
-        }
+        bool additive = false;
+        vmt.GetBool(vmt.Find(material, "$additive"), additive);
 
         const std::string vtfPath = JoinWindowsPath(materialsDir, NormalizeSlashes(baseTexture, '\\') + ".vtf");
         std::ifstream vtfFile(vtfPath, std::ios::binary);
@@ -2166,16 +2035,50 @@ namespace
         return outFrames.loaded;
     }
 
+    static KillIndicatorDecodedFrameStore& GetKillIndicatorDecodedFrameStore()
+    {
+        static KillIndicatorDecodedFrameStore store;
+        return store;
+    }
+
+    // Drops the least recently used decoded materials (never keepKey) until the store fits its budget.
+    // Dropped materials are decoded again on their next use.
+    static void TrimKillIndicatorDecodedFrameStore(KillIndicatorDecodedFrameStore& store, const std::string* keepKey)
+    {
+        while (store.totalBytes > store.byteBudget)
+        {
+            auto victim = store.entries.end();
+            for (auto it = store.entries.begin(); it != store.entries.end(); ++it)
+            {
+                if (it->second.bytes == 0 || (keepKey && it->first == *keepKey))
+                    continue;
+                if (victim == store.entries.end() || it->second.lastUse < victim->second.lastUse)
+                    victim = it;
+            }
+            if (victim == store.entries.end())
+                break;
+
+            store.totalBytes -= victim->second.bytes;
+            store.entries.erase(victim);
+        }
+    }
+
     static KillIndicatorDecodedFrames& GetKillIndicatorDecodedFrameCache(const std::string& materialName)
     {
-        static std::unordered_map<std::string, KillIndicatorDecodedFrames> cache;
+        KillIndicatorDecodedFrameStore& store = GetKillIndicatorDecodedFrameStore();
         const std::string key = ToLowerCopy(materialName);
-        KillIndicatorDecodedFrames& entry = cache[key];
+        KillIndicatorDecodedFrames& entry = store.entries[key];
         if (!entry.attempted)
         {
             entry.attempted = true;
             entry.loaded = LoadKillIndicatorDecodedFramesFromDisk(materialName, entry);
+            for (const std::vector<uint8_t>& frame : entry.frames)
+                entry.bytes += frame.size();
+            store.totalBytes += entry.bytes;
         }
+        entry.lastUse = ++store.useTick;
+        if (store.totalBytes > store.byteBudget)
+            TrimKillIndicatorDecodedFrameStore(store, &key);
         return entry;
     }
 
@@ -3321,58 +3224,49 @@ void VR::HandleKillSoundGameEvent(IGameEvent* event)
         const bool attackerMatchesLocalUser = localUserId > 0 && attackerUserId == localUserId;
         const bool attackerMatchesLocalIndex = attackerIndex > 0 && attackerIndex == localPlayerIndex;
 
-        const auto now = std::chrono::steady_clock::now();
         const std::uintptr_t entityTag = ResolveKillEventEntityTag(m_Game, event, eventName);
-        Vector impactPos{};
         const bool attackerMatchesLocal = attackerMatchesLocalUser || attackerMatchesLocalIndex;
-        const uint32_t shotSerial = m_PredictedHitFeedbackShotSerial;
-        const float shotAgeSeconds =
-            m_LastPredictedHitFeedbackShotTime.time_since_epoch().count() != 0
-            ? std::chrono::duration<float>(now - m_LastPredictedHitFeedbackShotTime).count()
-            : -1.0f;
-        const bool recentShotWindowActive =
-            m_LastPredictedHitFeedbackShotTime.time_since_epoch().count() != 0
-            && shotAgeSeconds >= 0.0f
-            && shotAgeSeconds <= 0.35f;
-
-        bool matchedImpactByEntityTag = false;
-        bool matchedImpactByShotFallback = false;
-        if (recentShotWindowActive && shotSerial != 0)
-        {
-            if (entityTag != 0)
-                matchedImpactByEntityTag = FindPendingKillSoundHit(entityTag, now, &impactPos, shotSerial);
-            if (!matchedImpactByEntityTag)
-                matchedImpactByShotFallback = FindPendingKillSoundHit(0, now, &impactPos, shotSerial);
-        }
-        const bool matchedImpact = matchedImpactByEntityTag || matchedImpactByShotFallback;
+
+        // Hurt events alone are not a reliable hit-confirm source here:
+        // they can arrive without a usable impact match, or be unrelated to the
+        // current shot (DOT / lingering damage / other local-side quirks). Only
+        // emit hit feedback when the event can still be tied back to a recent
+        // predicted shot impact.
+        if (!attackerMatchesLocal)
+            return;
+
+        const double nowSeconds = SteadySeconds(std::chrono::steady_clock::now());
+        bool playLate = false;
+        const HitLedgerShot* shot = m_HitFeedbackLedger.ConfirmHit(entityTag, nowSeconds, playLate);
 
         if (m_FeedbackSoundDebugLog &&
-            !ShouldThrottle(m_LastFeedbackSoundDebugLogTime, m_FeedbackSoundDebugLogHz) &&
-            (attackerMatchesLocal || recentShotWindowActive || matchedImpact))
+            !ShouldThrottle(m_LastFeedbackSoundDebugLogTime, m_FeedbackSoundDebugLogHz))
         {
+            const HitFeedbackLedger::Counters& counters = m_HitFeedbackLedger.GetCounters();
             Game::logMsg(
-                "[VR][KillSound][hurt] event=%s attackerUid=%d attackerIdx=%d local=%d entity=%p shot=%u age=%.3f matchedTag=%d matchedShot=%d accept=%d pending=%zu",
+                "[VR][KillSound][hurt] event=%s attackerUid=%d attackerIdx=%d entity=%p shot=%u tagMatch=%d late=%d window=%.3f delay=%.3f predicted=%llu late=%llu confirmed=%llu mispredicted=%llu",
                 eventName.c_str(),
                 attackerUserId,
                 attackerIndex,
-                attackerMatchesLocal ? 1 : 0,
                 reinterpret_cast<void*>(entityTag),
-                shotSerial,
-                shotAgeSeconds,
-                matchedImpactByEntityTag ? 1 : 0,
-                matchedImpactByShotFallback ? 1 : 0,
-                (attackerMatchesLocal && matchedImpact && recentShotWindowActive) ? 1 : 0,
-                m_PendingKillSoundHits.size());
+                shot ? shot->serial : 0u,
+                (shot && entityTag != 0 && shot->entityTag == entityTag) ? 1 : 0,
+                playLate ? 1 : 0,
+                m_HitFeedbackLedger.GetWindowSeconds(),
+                m_HitFeedbackLedger.GetSmoothedDelaySeconds(),
+                static_cast<unsigned long long>(counters.predicted),
+                static_cast<unsigned long long>(counters.late),
+                static_cast<unsigned long long>(counters.confirmed),
+                static_cast<unsigned long long>(counters.mispredicted));
         }
 
-        // Hurt events alone are not a reliable hit-confirm source here:
-        // they can arrive without a usable impact match, or be unrelated to the
-        // current shot (DOT / lingering damage / other local-side quirks). Only
-        // emit hit feedback when the event can still be tied back to a recent
-        // predicted shot impact.
-        if (!attackerMatchesLocal || !matchedImpact || !recentShotWindowActive)
+        if (!shot)
             return;
 
+        // The server confirmed a shot whose prediction wasn't confident enough to play at the time.
+        Vector impactPos{ shot->impact[0], shot->impact[1], shot->impact[2] };
+        if (playLate && m_HitSoundEnabled)
+            QueueHitSoundPlayback(&impactPos);
         if (m_HitIndicatorEnabled)
             SpawnHitIndicator(impactPos);
         return;
@@ -3417,12 +3311,12 @@ void VR::HandleKillSoundGameEvent(IGameEvent* event)
 
     if (!attackerMatchesLocalUser && !attackerMatchesLocalIndex)
     {
-        const auto now = std::chrono::steady_clock::now();
+        const double nowSeconds = SteadySeconds(std::chrono::steady_clock::now());
         bool matchedImpact = false;
         if (entityTag != 0)
-            matchedImpact = FindPendingKillSoundHit(entityTag, now, nullptr);
+            matchedImpact = m_HitFeedbackLedger.HasKillCandidate(entityTag, nowSeconds);
         if (!matchedImpact)
-            matchedImpact = FindPendingKillSoundHit(0, now, nullptr);
+            matchedImpact = m_HitFeedbackLedger.HasKillCandidate(0, nowSeconds);
         if (!matchedImpact)
             return;
     }
@@ -3514,11 +3408,38 @@ bool VR::IsKillSoundTargetEntity(const C_BaseEntity* entity) const
 
 void VR::BeginPredictedHitFeedbackShot()
 {
-    const auto now = std::chrono::steady_clock::now();
-    ++m_PredictedHitFeedbackShotSerial;
-    if (m_PredictedHitFeedbackShotSerial == 0)
-        m_PredictedHitFeedbackShotSerial = 1;
-    m_LastPredictedHitFeedbackShotTime = now;
+    m_HitFeedbackLedger.BeginShot(SteadySeconds(std::chrono::steady_clock::now()));
+}
+
+float VR::EstimatePredictedHitConfidence(C_BasePlayer* localPlayer, C_BaseEntity* entity, const CGameTrace& trace, const Vector& start, float& outPredictedDamage, bool& outPredictedLethal)
+{
+    outPredictedDamage = 0.0f;
+    outPredictedLethal = false;
+
+    C_WeaponCSBase* weapon = localPlayer ? static_cast<C_WeaponCSBase*>(localPlayer->GetActiveWeapon()) : nullptr;
+    const EffectiveAttackRangeWeaponData* data = weapon ? GetEffectiveAttackRangeWeaponData(weapon) : nullptr;
+    if (!data)
+        return 1.0f;
+
+    // The local trace is the center of the spread cone. The server's bullet lands somewhere in the
+    // cone, so the wider the cone is at the target compared to a body, the less the prediction is worth.
+    const float distance = (trace.endpos - start).Length();
+    if (distance > data->range)
+        return 0.0f;
+    const float spread = GetEffectiveAttackRangeSpreadDegrees(localPlayer, weapon, *data);
+    const float coneRadius = spread > 0.0f ? std::tan(DEG2RAD(spread)) * distance : 0.0f;
+    const float confidence = std::clamp(1.0f - coneRadius / 48.0f, 0.0f, 1.0f);
+
+    if (data->damage > 0.0f)
+    {
+        outPredictedDamage = data->damage * static_cast<float>((std::max)(1, data->bullets));
+        // Commons have 50 health (z_health); players carry theirs.
+        int health = 50;
+        if (entity && entity->IsPlayer() != nullptr)
+            VR_TryReadI32(reinterpret_cast<const unsigned char*>(entity), kHealthOffset, health);
+        outPredictedLethal = health > 0 && outPredictedDamage * confidence >= static_cast<float>(health);
+    }
+    return confidence;
 }
 
 void VR::RegisterPotentialKillSoundHit(const Vector& start, const QAngle& angles)
@@ -3598,43 +3519,39 @@ void VR::RegisterPotentialKillSoundHit(const Vector& start, const QAngle& angles
         }
     }
 
+    const double nowSeconds = SteadySeconds(now);
+    uint32_t shotSerial = m_HitFeedbackLedger.GetLastSerial();
+    if (shotSerial == 0)
+        shotSerial = m_HitFeedbackLedger.BeginShot(nowSeconds);
+
+    const std::uintptr_t entityTag = reinterpret_cast<std::uintptr_t>(entity);
+    float predictedDamage = 0.0f;
+    bool predictedLethal = false;
+    const float confidence = EstimatePredictedHitConfidence(localPlayer, entity, trace, start, predictedDamage, predictedLethal);
+    const float impact[3] = { trace.endpos.x, trace.endpos.y, trace.endpos.z };
+    const bool playNow = m_HitFeedbackLedger.RecordImpact(shotSerial, entityTag, impact, predictedDamage, predictedLethal, confidence);
+
     if (triggerDirectHitFeedback)
     {
-        const uint32_t shotSerial = m_PredictedHitFeedbackShotSerial;
-        const bool canUseShotGate = shotSerial != 0
-            && m_LastPredictedHitFeedbackShotTime.time_since_epoch().count() != 0
-            && std::chrono::duration<float>(now - m_LastPredictedHitFeedbackShotTime).count() <= 0.35f;
-
-        if (m_HitSoundEnabled)
-        {
-            const bool shouldQueueHitSound = !canUseShotGate || m_LastPredictedHitSoundShotSerial != shotSerial;
-            if (shouldQueueHitSound)
-            {
-                QueueHitSoundPlayback(&trace.endpos);
-                if (canUseShotGate)
-                    m_LastPredictedHitSoundShotSerial = shotSerial;
-            }
-        }
-        if (m_HitIndicatorEnabled)
+        // One hit sound per shot; a shot below the confidence threshold waits for the server's hurt
+        // event instead (HandleKillSoundGameEvent).
+        if (m_HitSoundEnabled && playNow)
+            QueueHitSoundPlayback(&trace.endpos);
+        if (m_HitIndicatorEnabled && playNow)
             SpawnHitIndicator(trace.endpos);
 
         m_LastPredictedHitFeedbackStart = start;
         m_LastPredictedHitFeedbackDir = forward;
-        m_LastPredictedHitFeedbackEntityTag = reinterpret_cast<std::uintptr_t>(entity);
+        m_LastPredictedHitFeedbackEntityTag = entityTag;
         m_LastPredictedHitFeedbackTime = now;
     }
 
-    const auto expiresAt = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
-        std::chrono::duration<float>(m_KillSoundDetectionWindowSeconds));
-    const std::uintptr_t entityTag = reinterpret_cast<std::uintptr_t>(entity);
-    const uint32_t shotSerial = m_PredictedHitFeedbackShotSerial;
     const SpecialInfectedType specialType = GetSpecialInfectedType(entity);
-
     if (m_FeedbackSoundDebugLog &&
         !ShouldThrottle(m_LastFeedbackSoundDebugLogTime, m_FeedbackSoundDebugLogHz))
     {
         Game::logMsg(
-            "[VR][KillSound][predicted-hit] shot=%u idx=%d entity=%p class=%s team=%d life=%d z=%d si=%d direct=%d pos=(%.1f %.1f %.1f)",
+            "[VR][KillSound][predicted-hit] shot=%u idx=%d entity=%p class=%s team=%d life=%d z=%d si=%d direct=%d conf=%.2f play=%d dmg=%.0f lethal=%d pos=(%.1f %.1f %.1f)",
             shotSerial,
             entityIndex,
             reinterpret_cast<void*>(entityTag),
@@ -3644,122 +3561,31 @@ void VR::RegisterPotentialKillSoundHit(const Vector& start, const QAngle& angles
             hasZombieClass ? zombieClass : -1,
             static_cast<int>(specialType),
             triggerDirectHitFeedback ? 1 : 0,
+            confidence,
+            playNow ? 1 : 0,
+            predictedDamage,
+            predictedLethal ? 1 : 0,
             trace.endpos.x,
             trace.endpos.y,
             trace.endpos.z);
     }
-
-    m_PendingKillSoundHits.erase(
-        std::remove_if(
-            m_PendingKillSoundHits.begin(),
-            m_PendingKillSoundHits.end(),
-            [&](const PendingKillSoundHit& hit)
-            {
-                return hit.entityTag == 0 || hit.expiresAt < now;
-            }),
-        m_PendingKillSoundHits.end());
-
-    for (auto& hit : m_PendingKillSoundHits)
-    {
-        if (hit.entityTag == entityTag)
-        {
-            hit.expiresAt = expiresAt;
-            hit.shotSerial = shotSerial;
-            hit.impactPos = trace.endpos;
-            return;
-        }
-    }
-
-    PendingKillSoundHit hit{};
-    hit.entityTag = entityTag;
-    hit.expiresAt = expiresAt;
-    hit.shotSerial = shotSerial;
-    hit.impactPos = trace.endpos;
-    m_PendingKillSoundHits.push_back(hit);
-    if (m_PendingKillSoundHits.size() > 24)
-        m_PendingKillSoundHits.erase(m_PendingKillSoundHits.begin(), m_PendingKillSoundHits.begin() + (m_PendingKillSoundHits.size() - 24));
 }
 
 bool VR::ConsumePendingKillSoundHit(std::uintptr_t preferredEntityTag, std::chrono::steady_clock::time_point now, Vector* outImpactPos)
 {
-    m_PendingKillSoundHits.erase(
-        std::remove_if(
-            m_PendingKillSoundHits.begin(),
-            m_PendingKillSoundHits.end(),
-            [&](const PendingKillSoundHit& hit)
-            {
-                return hit.entityTag == 0 || hit.expiresAt < now;
-            }),
-        m_PendingKillSoundHits.end());
-
-    if (preferredEntityTag != 0)
-    {
-        for (auto it = m_PendingKillSoundHits.rbegin(); it != m_PendingKillSoundHits.rend(); ++it)
-        {
-            if (it->entityTag != preferredEntityTag)
-                continue;
-
-            if (outImpactPos)
-                *outImpactPos = it->impactPos;
-            m_PendingKillSoundHits.erase(std::next(it).base());
-            return true;
-        }
-    }
-
-    for (auto it = m_PendingKillSoundHits.rbegin(); it != m_PendingKillSoundHits.rend(); ++it)
-    {
-        const auto* entity = reinterpret_cast<const C_BaseEntity*>(it->entityTag);
-        if (entity && IsEntityAlive(entity))
-            continue;
-        if (outImpactPos)
-            *outImpactPos = it->impactPos;
-        m_PendingKillSoundHits.erase(std::next(it).base());
-        return true;
-    }
-
-    if (!m_PendingKillSoundHits.empty())
-    {
-        if (outImpactPos)
-            *outImpactPos = m_PendingKillSoundHits.back().impactPos;
-        m_PendingKillSoundHits.pop_back();
-        return true;
-    }
-
-    return false;
-}
-
-bool VR::FindPendingKillSoundHit(std::uintptr_t preferredEntityTag, std::chrono::steady_clock::time_point now, Vector* outImpactPos, uint32_t preferredShotSerial)
-{
-    m_PendingKillSoundHits.erase(
-        std::remove_if(
-            m_PendingKillSoundHits.begin(),
-            m_PendingKillSoundHits.end(),
-            [&](const PendingKillSoundHit& hit)
-            {
-                return hit.entityTag == 0 || hit.expiresAt < now;
-            }),
-        m_PendingKillSoundHits.end());
-
-    auto matchesTag = [&](const PendingKillSoundHit& hit)
-        {
-            return preferredEntityTag == 0 || hit.entityTag == preferredEntityTag;
-        };
-    auto matchesShotSerial = [&](const PendingKillSoundHit& hit)
-        {
-            return preferredShotSerial == 0 || hit.shotSerial == preferredShotSerial;
-        };
-
-    for (auto it = m_PendingKillSoundHits.rbegin(); it != m_PendingKillSoundHits.rend(); ++it)
-    {
-        if (!matchesTag(*it) || !matchesShotSerial(*it))
-            continue;
-
-        if (outImpactPos)
-            *outImpactPos = it->impactPos;
-        return true;
-    }
+    // Without a tag, prefer a shot whose target is already gone or that was predicted to kill.
+    const HitLedgerShot* shot = m_HitFeedbackLedger.ConsumeKill(preferredEntityTag, SteadySeconds(now),
+        [&](const HitLedgerShot& candidate)
+        {
+            const auto* entity = reinterpret_cast<const C_BaseEntity*>(candidate.entityTag);
+            return candidate.predictedLethal || !entity || !IsEntityAlive(entity);
+        });
+    if (!shot)
+        return false;
 
-    return false;
+    if (outImpactPos)
+        *outImpactPos = Vector{ shot->impact[0], shot->impact[1], shot->impact[2] };
+    return true;
 }
 
 bool VR::TryPlayKillSoundSpec(const std::string& rawSpec, float baseVolume, const Vector* worldPos, bool preferLoadedPathReuse)
@@ -4396,6 +4222,18 @@ void VR::DestroyHandHudWorldQuadTextures()
     std::memset(&m_VKRightAmmoHudDyn, 0, sizeof(m_VKRightAmmoHudDyn));
 }
 
+void VR::SetKillIndicatorDecodedFrameBudget(size_t bytes)
+{
+    KillIndicatorDecodedFrameStore& store = GetKillIndicatorDecodedFrameStore();
+    store.byteBudget = bytes;
+    TrimKillIndicatorDecodedFrameStore(store, nullptr);
+}
+
+size_t VR::GetKillIndicatorDecodedFrameBytes() const
+{
+    return GetKillIndicatorDecodedFrameStore().totalBytes;
+}
+
 void VR::DestroyKillIndicatorOverlayTextures()
 {
     for (int materialIndex = 0; materialIndex < static_cast<int>(m_KillIndicatorOverlayTextures.size()); ++materialIndex)
@@ -4416,6 +4254,8 @@ void VR::DestroyKillIndicatorOverlayTexture(int materialIndex)
         };
 
     KillIndicatorOverlayTexture& texture = m_KillIndicatorOverlayTextures[materialIndex];
+    if (texture.width > 0 && texture.height > 0)
+        m_VASBudget.Track(VasCategory::KillIndicatorTextures, -static_cast<int64_t>(texture.width) * texture.height * 4);
     SafeReleaseD3D(texture.d3dSurface);
     SafeReleaseD3D(texture.d3dTexture);
     texture.width = 0;
@@ -4477,6 +4317,7 @@ bool VR::EnsureKillIndicatorOverlayTexture(int materialIndex, int width, int hei
                 texture.sharedTexture.m_VRTexture.eType = vr::TextureType_Vulkan;
                 texture.width = width;
                 texture.height = height;
+                m_VASBudget.Track(VasCategory::KillIndicatorTextures, static_cast<int64_t>(width) * height * 4);
             }
             else
             {
@@ -4819,23 +4660,12 @@ bool VR::BuildKillIndicatorOverlayPixels(IMaterial* material, std::vector<uint8_
 
 bool VR::ComputeKillIndicatorOverlayTransform(const Vector& worldPos, vr::HmdMatrix34_t& outTransform) const
 {
-    Vector srcRight = m_HmdRight;
-    Vector srcUp = m_HmdUp;
-    Vector srcForward = m_HmdForward;
-    if (VectorNormalize(srcRight) == 0.0f || VectorNormalize(srcUp) == 0.0f || VectorNormalize(srcForward) == 0.0f)
+    if (!m_OverlayFrame.worldValid)
         return false;
 
-    const float unitsPerMeter = (std::max)(1.0f, m_VRScale);
-    const Vector deltaSource = worldPos - m_HmdPosAbs;
-    const float deltaRightMeters = DotProduct(deltaSource, srcRight) / unitsPerMeter;
-    const float deltaUpMeters = DotProduct(deltaSource, srcUp) / unitsPerMeter;
-    const float deltaForwardMeters = DotProduct(deltaSource, srcForward) / unitsPerMeter;
-
-    outTransform = {
-        1.0f, 0.0f, 0.0f, deltaRightMeters,
-        0.0f, 1.0f, 0.0f, deltaUpMeters,
-        0.0f, 0.0f, 1.0f, -deltaForwardMeters
-    };
+    // HMD-relative meters along (right, up, back).
+    const Vec3 local = Mat34Math::TransformPoint(m_OverlayFrame.hmdFromWorld, ToVec3(worldPos));
+    outTransform = Mat34::Translation(local.x, local.y, local.z).To<vr::HmdMatrix34_t>();
     return true;
 }
 
@@ -5181,14 +5011,14 @@ void VR::UpdateKillSoundFeedback()
     auto resetState = [&]()
         {
             const bool hadFeedbackState = m_HitSoundPending
-                || !m_PendingKillSoundHits.empty()
+                || m_HitFeedbackLedger.GetLastSerial() != 0
                 || !m_PendingKillSoundEvents.empty()
                 || !m_FeedbackSoundWarmupSignature.empty();
             if (hadFeedbackState)
                 ResetFeedbackSoundWorkerState();
 
             TrimExpiredKillIndicators(std::chrono::steady_clock::now(), true);
-            m_PendingKillSoundHits.clear();
+            m_HitFeedbackLedger.Reset();
             m_PendingKillSoundEvents.clear();
             m_HitSoundPending = false;
             m_HitSoundPendingMergedCount = 0;
@@ -5196,9 +5026,6 @@ void VR::UpdateKillSoundFeedback()
             m_HitSoundPendingQueuedAt = {};
             m_LastKillSoundCommonKills = -1;
             m_LastKillSoundSpecialKills = -1;
-            m_PredictedHitFeedbackShotSerial = 0;
-            m_LastPredictedHitSoundShotSerial = 0;
-            m_LastPredictedHitFeedbackShotTime = {};
             m_FeedbackSoundWarmupSignature.clear();
         };
 
@@ -5230,15 +5057,9 @@ void VR::UpdateKillSoundFeedback()
     const auto now = std::chrono::steady_clock::now();
     FlushPendingHitSound(now);
     EnsureKillSoundEventListener();
-    m_PendingKillSoundHits.erase(
-        std::remove_if(
-            m_PendingKillSoundHits.begin(),
-            m_PendingKillSoundHits.end(),
-            [&](const PendingKillSoundHit& hit)
-            {
-                return hit.entityTag == 0 || hit.expiresAt < now;
-            }),
-        m_PendingKillSoundHits.end());
+    m_HitFeedbackLedger.SetWindowBounds(m_HitFeedbackMinWindowSeconds, m_KillSoundDetectionWindowSeconds);
+    m_HitFeedbackLedger.SetConfidenceThreshold(m_HitFeedbackPredictConfidence);
+    m_HitFeedbackLedger.Expire(SteadySeconds(now));
 
     if (!wantsKillFeedback)
         return;
@@ -5265,7 +5086,7 @@ void VR::UpdateKillSoundFeedback()
     {
         m_LastKillSoundCommonKills = commonKills;
         m_LastKillSoundSpecialKills = specialKills;
-        m_PendingKillSoundHits.clear();
+        m_HitFeedbackLedger.Reset();
         m_PendingKillSoundEvents.clear();
         return;
     }
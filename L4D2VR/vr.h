@@ -11,6 +11,25 @@
 #endif
 #include "openvr.h"
 #include "vector.h"
+#include "optics_rtt_scheduler.h"
+#include "optics_render_profile.h"
+#include "texture_generation.h"
+#include "overlay_state_cache.h"
+#include "stereo_visibility.h"
+#include "vr_usercmd_payload.h"
+#include "melee_sweep.h"
+#include "aim_query_cache.h"
+#include "throw_arc_solver.h"
+#include "entity_spatial_hash.h"
+#include "friendly_fire_classifier.h"
+#include "hit_feedback_ledger.h"
+#include "weapon_script_db.h"
+#include "shadow_quality_governor.h"
+#include "vas_budget.h"
+#include "viewmodel_adjust_table.h"
+#include "spew_filter.h"
+#include "roomscale_codec.h"
+#include "overlay_math.h"
 #include <cstdint>
 #include <array>
 #include <chrono>
@@ -39,6 +58,7 @@ class CUserCmd;
 class IDirect3DDevice9;
 class IDirect3DTexture9;
 class IDirect3DSurface9;
+class IDirect3DVR9_1;
 class ITexture;
 class IMaterial;
 class IMatRenderContext;
@@ -46,12 +66,9 @@ class CViewSetup;
 class IGameEvent;
 class IGameEventListener2;
 class IGameEventManager2;
-
-struct ViewmodelAdjustment
-{
-	Vector position;
-	QAngle angle;
-};
+class CGameTrace;
+class CTraceFilter;
+struct Ray_t;
 
 
 struct TrackedDevicePoseData
@@ -67,6 +84,28 @@ struct SharedTextureHolder
 {
 	vr::VRVulkanTextureData_t m_VulkanData{};
 	vr::Texture_t m_VRTexture{};
+
+	// m_VRTexture.handle points at our own m_VulkanData, so a plain copy would alias the source.
+	void CopyFrom(const SharedTextureHolder& other)
+	{
+		m_VulkanData = other.m_VulkanData;
+		m_VRTexture = other.m_VRTexture;
+		if (other.m_VRTexture.handle)
+			m_VRTexture.handle = &m_VulkanData;
+	}
+};
+
+// Snapshot of every texture the submit thread hands to SteamVR. Immutable once published.
+struct SharedTextureSet
+{
+	SharedTextureHolder leftEye;
+	SharedTextureHolder rightEye;
+	SharedTextureHolder backBuffer;
+	SharedTextureHolder hud;
+	SharedTextureHolder scope;
+	SharedTextureHolder rearMirror;
+	SharedTextureHolder blank;
+	uint64_t generation = 0;
 };
 
 using TextureStateMutex = std::recursive_mutex;
@@ -98,6 +137,12 @@ struct HapticMixState
 	std::chrono::steady_clock::time_point lastSubmit{};
 };
 
+// Raw copy of a CGameTrace (not copyable, and its definition lives in sdk/trace.h) for AimQueryCache.
+struct VRAimTraceBlob
+{
+	alignas(8) unsigned char bytes[128];
+};
+
 struct D3DAimLineOverlayEyeState
 {
 	bool valid = false;
@@ -132,6 +177,19 @@ public:
 	// Hand HUD overlays (raw, controller-anchored)
 	vr::VROverlayHandle_t m_LeftWristHudHandle = vr::k_ulOverlayHandleInvalid;
 	vr::VROverlayHandle_t m_RightAmmoHudHandle = vr::k_ulOverlayHandleInvalid;
+	// Diffed visibility / alpha / bounds / texture / flag state for the menu, HUD, scope and mirror overlays.
+	// Flushed once per frame at the end of SubmitVRTextures; transforms and widths are written through.
+	OverlayStateCache<vr::IVROverlay> m_OverlayCache;
+	// Per-frame anchors the overlay transforms derive from: the tracking part is rebuilt when poses
+	// arrive (UpdatePosesAndActions), the Source world part after UpdateTracking.
+	OverlayFrame m_OverlayFrame;
+	// Last absolute rear mirror transform; mouse-mode hand HUDs hang below it.
+	Mat34 m_RearMirrorOverlayTransform;
+	bool m_RearMirrorOverlayTransformValid = false;
+	uint64_t m_OverlayMenuTextureKey = 0;
+	bool m_OverlayCacheDebugLog = false;
+	std::chrono::steady_clock::time_point m_OverlayCacheLastLog{};
+	void FlushOverlayState();
 
 
 	float m_HorizontalOffsetLeft;
@@ -231,6 +289,10 @@ public:
 	Vector m_ThirdPersonRenderCenter = { 0,0,0 };
 	bool m_ThirdPersonPoseInitialized = false;
 	float m_ThirdPersonCameraSmoothing = 0.85f;
+	// Tick-rate engine cameras (third-person, queued setup origin): how far behind render time the
+	// interpolated pose is evaluated, and how far past the newest tick it may extrapolate (in ticks).
+	float m_EngineCameraInterpDelayTicks = 0.5f;
+	float m_EngineCameraMaxExtrapolateTicks = 0.5f;
 	float m_ThirdPersonVRCameraOffset = 80.0f;
 	// Front-view third-person camera local offset in camera basis:
 	// x=front/back, y=left/right, z=up/down.
@@ -345,8 +407,10 @@ public:
 	// WaitGetPoses() is a hard pacing barrier. If we call it on the queued render thread, we can
 	// destroy mat_queue_mode 2 throughput. Instead, in queued mode we run a tiny "pose waiter" thread
 	// that blocks in WaitGetPoses() and publishes a seqlock snapshot. Render/main threads only read.
+	// Started / enabled from OnMatQueueModeChanged() when the cached thread mode changes.
 	std::atomic<bool> m_PoseWaiterStarted{ false };
 	std::atomic<bool> m_PoseWaiterEnabled{ false };
+	bool m_MatQueueModeSubscribed = false;
 	std::atomic<uint32_t> m_PoseWaiterSeq{ 0 };
 	std::array<vr::TrackedDevicePose_t, vr::k_unMaxTrackedDeviceCount> m_PoseWaiterPoses{};
 
@@ -450,16 +514,24 @@ public:
 
 	Vector m_ViewmodelPosAdjust = { 0,0,0 };
 	QAngle m_ViewmodelAngAdjust = { 0,0,0 };
-	ViewmodelAdjustment m_DefaultViewmodelAdjust{ {0,0,0}, {0,0,0} };
-	std::unordered_map<std::string, ViewmodelAdjustment> m_ViewmodelAdjustments{};
-	std::string m_CurrentViewmodelKey;
-	std::string m_LastLoggedViewmodelKey;
+	ViewmodelAdjustValue m_DefaultViewmodelAdjust{};
+	// Slot per weapon id / melee script; resolved only when the active weapon changes.
+	ViewmodelAdjustTable m_ViewmodelAdjustments{};
+	int m_CurrentViewmodelSlot = 0;
+	const void* m_ViewmodelSlotWeapon = nullptr;
+	int m_ViewmodelSlotWeaponId = -1;
+	bool m_ViewmodelSlotValid = false;
 	bool m_ViewmodelAdjustmentsDirty = false;
 	std::string m_ViewmodelAdjustmentSavePath;
 	bool m_ViewmodelAdjustEnabled = true;
+	// Saves are written to disk by a short-lived worker; only the latest snapshot is kept.
+	std::mutex m_ViewmodelAdjustSaveMutex;
+	std::string m_ViewmodelAdjustPendingSave;
+	bool m_ViewmodelAdjustSavePending = false;
+	bool m_ViewmodelAdjustSaveWorkerRunning = false;
 
 	bool m_AdjustingViewmodel = false;
-	std::string m_AdjustingKey;
+	int m_AdjustingSlot = -1;
 	Vector m_AdjustStartLeftPos = { 0,0,0 };
 	QAngle m_AdjustStartLeftAng = { 0,0,0 };
 	Vector m_AdjustStartViewmodelPos = { 0,0,0 };
@@ -522,20 +594,7 @@ public:
 	int m_AimLineColorG = 255;
 	int m_AimLineColorB = 0;
 	int m_AimLineColorA = 192;
-	struct EffectiveAttackRangeWeaponData
-	{
-		bool valid = false;
-		float minDuckingSpread = 0.0f;
-		float minStandingSpread = 0.0f;
-		float minInAirSpread = 0.0f;
-		float maxMovementSpread = 0.0f;
-		float pelletScatterPitch = 0.0f;
-		float pelletScatterYaw = 0.0f;
-		float range = 8192.0f;
-		float maxPlayerSpeed = 250.0f;
-		int bullets = 1;
-		std::string source;
-	};
+	using EffectiveAttackRangeWeaponData = WeaponRangeData;
 	bool m_EffectiveAttackRangeIndicatorEnabled = true;
 	bool m_EffectiveAttackRangeAutoFireEnabled = false;
 	bool m_EffectiveAttackRangeAutoFireActive = false;
@@ -572,9 +631,16 @@ public:
 	float m_EffectiveAttackRangeHitPointMaxTolerance = 24.0f;
 	std::uintptr_t m_EffectiveAttackRangeDebugLastEntity = 0;
 	std::chrono::steady_clock::time_point m_EffectiveAttackRangeDebugLastLog{};
+	// Weapon script data is loaded on a background thread (map load, or first use) and handed to the
+	// aim path by PollEffectiveAttackRangeWeaponData; the render / aim path never reads files.
 	bool m_EffectiveAttackRangeWeaponDataLoaded = false;
 	std::chrono::steady_clock::time_point m_EffectiveAttackRangeWeaponDataLastLoad{};
+	float m_EffectiveAttackRangeWeaponDataRetrySeconds = 2.0f;   // doubles after each failed load
 	std::array<EffectiveAttackRangeWeaponData, 64> m_EffectiveAttackRangeWeaponData{};
+	std::mutex m_EffectiveAttackRangeWeaponDataMutex{};
+	std::array<EffectiveAttackRangeWeaponData, 64> m_EffectiveAttackRangeWeaponDataPending{};
+	std::atomic<bool> m_EffectiveAttackRangeWeaponDataLoading{ false };
+	std::atomic<bool> m_EffectiveAttackRangeWeaponDataReady{ false };
 	bool m_GameLaserSightBeamEnabled = true;
 	bool m_GameLaserSightReplaceParticle = false;
 	float m_GameLaserSightThickness = 1.5f;
@@ -592,7 +658,18 @@ public:
 	float m_ThrowArcMaxDistance = 2200.0f;
 	float m_ThrowArcHeightRatio = 0.25f;
 	float m_ThrowArcPitchScale = 6.0f;
+	// Landing height relative to the hand. The physics preview ends an arc that hits nothing there.
 	float m_ThrowArcLandingOffset = -90.0f;
+	// Physical throw preview (throw_arc_solver.h). false = the pitch heuristic above (no traces).
+	bool m_ThrowArcPhysics = true;
+	// speed, gravity, linear drag per throwable (molotov, pipe bomb, bile jar); approximations, tunable.
+	std::array<ThrowArcProfile, 3> m_ThrowArcProfiles{ {
+		{ 700.0f, 400.0f, 0.15f, 3.0f },
+		{ 700.0f, 400.0f, 0.15f, 3.0f },
+		{ 700.0f, 400.0f, 0.15f, 3.0f } } };
+	int m_ThrowArcMaxTraces = 12;
+	float m_ThrowArcCacheMove = 1.0f;         // re-solve once the launch moves this far (units)
+	ThrowArcCache<THROW_ARC_SEGMENTS + 1> m_ThrowArcCache;
 	// Tracks the duration of the previous frame so the aim line can persist when the framerate dips.
 	float m_LastFrameDuration = 1.0f / 90.0f;
 
@@ -654,17 +731,32 @@ public:
 	SharedTextureHolder m_VKRearMirror;
 	SharedTextureHolder m_VKBlankTexture;
 
-	// Protects VR texture lifecycle and SteamVR texture submissions when render/update threads overlap.
+	// Protects the VR texture lifecycle (creation re-enters DXVK and writes the m_VK* holders above).
+	// The submit path doesn't take it: it reads the last published SharedTextureSet instead.
 	mutable TextureStateMutex m_TextureMutex;
+	GenerationPublisher<SharedTextureSet> m_TextureSets;
+	// Snapshot the m_VK* holders into a new SharedTextureSet. Caller holds m_TextureMutex.
+	void PublishTextureSet();
 
 	// If enabled, scope / rear-mirror render-target textures are created only when the feature is enabled.
 	// This can save large chunks of 32-bit VAS when ScopeRTTSize/RearMirrorRTTSize are high.
 	bool m_LazyScopeRearMirrorRTT = true;
 	// Debug: log Virtual Address Space (VAS) stats at key allocation points.
 	bool m_DebugVASLog = false;
+	// VAS budget: sampled from Update; pressure changes shrink the decoded kill-indicator frames,
+	// shrink optics RTTs at their next creation and trim DXVK's mapped texture memory.
+	bool m_VASBudgetEnabled = true;
+	VasBudget m_VASBudget;
+	bool m_VASBudgetSubscribed = false;
+	int m_OpticsRTTPressureShift = 0;          // optics RTTs are created at size >> shift
+	int m_ScopeRTTActiveSize = 1024;           // size the scope / mirror RTTs were actually created with
+	int m_RearMirrorRTTActiveSize = 512;
+	VasMappedTrim m_VASMappedTrim;
+	IDirect3DVR9_1* m_D3DVR9Trim = nullptr;    // null when the d3d9.dll predates mapped-memory trimming
 
 	bool m_IsVREnabled = false;
 	bool m_IsInitialized = false;
+	std::atomic<bool> m_ConfigInitialPassDone{ false };    // config watcher has read config.txt once
 	std::atomic<bool> m_RenderedNewFrame{ false };
 	std::atomic<bool> m_RenderedHud{ false };
 	// Main menu only needs one blank stereo submit to clear the last scene frame.
@@ -1162,6 +1254,12 @@ public:
 	float m_ShadowCvarNbShadowBlobbyDist = 0.0f;
 	float m_ShadowCvarNbShadowCullDist = 0.0f;
 	int m_ShadowCvarFlashlightInfectedShadows = 0;
+	// Closed-loop shadow quality: the values above are the top tier, stepped down / up from compositor timings.
+	bool m_ShadowQualityGovernorEnabled = false;
+	int m_ShadowQualityGovernorTiers = 4;
+	ShadowQualityGovernor m_ShadowQualityGovernor;
+	std::atomic<bool> m_ShadowQualityGovernorReset{ true };
+	uint32_t m_ShadowQualityGovernorLastFrameIndex = 0;
 	bool m_ShadowTweaksApplied = false;
 	bool m_ShadowOriginalsCaptured = false;
 	int m_ShadowOrigShadows = 1;
@@ -1288,9 +1386,11 @@ public:
 	int m_Roomscale1To1LocomotionCooldownCmds = 0;
 
 	Vector m_Roomscale1To1PrevCorrectedAbs = {};
-	// Accumulate sub-centimeter HMD deltas so slow walking/leaning still produces movement.
-	// This is in *meters* in the same corrected space as m_HmdPosCorrectedPrev.
-	Vector m_Roomscale1To1AccumMeters = {};
+	// Quantizes HMD deltas onto the wire and carries what the codec couldn't send yet, so slow
+	// walking/leaning still produces movement. Meters, in the same corrected space as m_HmdPosCorrectedPrev.
+	RoomscaleDeltaEncoder m_Roomscale1To1Encoder;
+	// Server side: spread each player's received deltas over this many server frames (1 = apply at once).
+	int m_Roomscale1To1ServerSmoothFrames = 2;
 	bool m_Roomscale1To1PrevValid = false;
 	// Debug logging for 1:1 roomscale pipeline (encode -> wire -> server apply).
 	bool m_Roomscale1To1DebugLog = false;
@@ -1391,6 +1491,13 @@ public:
 	// Extra radius (meters) for the friendly-fire aim guard trace.
 	// 0 = legacy thin ray; >0 uses a swept hull (fat ray) to reduce misses from spread/latency.
 	float m_BlockFireOnFriendlyAimRadiusMeters = 0.0f;
+	// Spread-cone check on top of the center rays: samples the weapon's spread against teammate
+	// capsules (no traces). Blocks when a shot would touch a teammate at least BlockChance of the time.
+	bool m_FriendlyFireSpreadGuardEnabled = true;
+	int m_FriendlyFireSpreadSamples = 32;
+	float m_FriendlyFireSpreadBlockChance = 0.1f;
+	FriendlyFirePattern m_FriendlyFireSpreadPattern;
+	std::vector<FriendlyFireCapsule> m_FriendlyFireCensus;
 
 
 	// Aim-line teammate HUD hint (left wrist HUD):
@@ -1403,15 +1510,6 @@ public:
 	int m_AimTeammateLastRawIndex = -1;
 	std::chrono::steady_clock::time_point m_AimTeammateLastRawTime{};
 
-	struct PendingKillSoundHit
-	{
-		std::uintptr_t entityTag = 0;
-		std::chrono::steady_clock::time_point expiresAt{};
-		uint32_t shotSerial = 0;
-		bool headshot = false;
-		Vector impactPos = { 0,0,0 };
-	};
-
 	struct ActiveKillIndicator
 	{
 		Vector worldPos = { 0,0,0 };
@@ -1508,7 +1606,10 @@ public:
 	float m_KillIndicatorRiseUnits = 18.0f;
 	float m_KillIndicatorMaxDistance = 4096.0f;
 	std::string m_KillIndicatorMaterialBaseSpec = "overlays/2965700751";
-	std::vector<PendingKillSoundHit> m_PendingKillSoundHits;
+	// Predicted shots awaiting the server's hurt / death events (hit_feedback_ledger.h).
+	HitFeedbackLedger m_HitFeedbackLedger;
+	float m_HitFeedbackPredictConfidence = 0.6f;    // play at the shot above this, otherwise on server confirm
+	float m_HitFeedbackMinWindowSeconds = 0.1f;     // lower bound of the measured reconciliation window
 	std::vector<PendingKillSoundEvent> m_PendingKillSoundEvents;
 	std::vector<ActiveKillIndicator> m_ActiveKillIndicators;
 	int m_LastKillSoundCommonKills = -1;
@@ -1521,9 +1622,6 @@ public:
 	Vector m_LastPredictedHitFeedbackDir = { 0,0,0 };
 	std::uintptr_t m_LastPredictedHitFeedbackEntityTag = 0;
 	std::chrono::steady_clock::time_point m_LastPredictedHitFeedbackTime{};
-	uint32_t m_PredictedHitFeedbackShotSerial = 0;
-	uint32_t m_LastPredictedHitSoundShotSerial = 0;
-	std::chrono::steady_clock::time_point m_LastPredictedHitFeedbackShotTime{};
 	std::chrono::steady_clock::time_point m_LastHitSoundPlaybackTime{};
 	std::chrono::steady_clock::time_point m_LastKillSoundPlaybackTime{};
 	std::chrono::steady_clock::time_point m_LastKillSoundEventRegisterAttempt{};
@@ -1995,11 +2093,121 @@ public:
 	bool   ShouldUpdateRearMirrorRTT();
 	void   NotifyRearMirrorSpecialWarning();
 
+	// ----------------------------
+	// Optics RTT scheduling (scope + rear mirror)
+	// ----------------------------
+	// When enabled, ScopeRTTMaxHz / RearMirrorRTTMaxHz become upper bounds and the actual rate follows
+	// camera motion since the last RTT, frame headroom and special-infected presence. Scope and mirror
+	// never render on the same frame. When disabled, the legacy fixed-Hz throttle is used.
+	bool  m_OpticsRTTAdaptive = true;
+	bool  m_OpticsRTTInterleave = true;
+	float m_ScopeRTTMinHz = 30.0f;
+	float m_RearMirrorRTTMinHz = 12.0f;
+	float m_OpticsRTTFullRateAngleDeg = 4.0f;   // camera rotation since last RTT that warrants MaxHz
+	float m_OpticsRTTFullRateDistance = 6.0f;   // camera translation (Source units) since last RTT that warrants MaxHz
+	bool  m_OpticsRTTDebugLog = false;
+	float m_OpticsRTTDebugLogHz = 0.5f;
+	std::chrono::steady_clock::time_point m_OpticsRTTDebugLastLog{};
+	OpticsRTTScheduler m_OpticsRTTScheduler{};
+	uint32_t m_OpticsRTTPlanMask = 0;
+	// Bumped by dRenderView after each optics RTT render; used as overlay texture content keys.
+	std::atomic<uint32_t> m_ScopeRTTContentVersion{ 0 };
+	std::atomic<uint32_t> m_RearMirrorRTTContentVersion{ 0 };
+	std::atomic<bool> m_OpticsRTTSettingsDirty{ true };
+
+	// Optics render profiles: what the scope / mirror passes skip compared to the eye views.
+	// The values below are parsed on the config watcher thread and reach the render thread only
+	// through m_OpticsRenderProfileMailbox.
+	bool  m_OpticsRTTProfilesEnabled = true;
+	bool  m_OpticsRTTProfileABTest = false;     // alternate full/reduced renders and log both timings
+	bool  m_ScopeRTTDrawHud = false;
+	bool  m_ScopeRTTDrawViewmodel = false;
+	float m_ScopeRTTFarZ = 0.0f;                // 0 = engine far plane
+	int   m_ScopeRTTLod = -1;                   // r_lod during the pass; -1 = unchanged
+	bool  m_ScopeRTTDetailProps = true;
+	bool  m_ScopeRTTParticles = true;
+	bool  m_ScopeRTTShadows = true;
+	bool  m_RearMirrorRTTDrawHud = false;
+	bool  m_RearMirrorRTTDrawViewmodel = false;
+	float m_RearMirrorRTTFarZ = 3000.0f;
+	int   m_RearMirrorRTTLod = -1;
+	bool  m_RearMirrorRTTDetailProps = false;
+	bool  m_RearMirrorRTTParticles = true;
+	bool  m_RearMirrorRTTShadows = false;
+	OpticsRenderProfileMailbox m_OpticsRenderProfileMailbox{};
+	uint32_t m_OpticsRenderProfileGeneration = 0; // render thread: last mailbox set applied
+	OpticsRenderProfiles m_OpticsRenderProfiles{};
+	OpticsConVarAccess m_OpticsConVarAccess{};
+	std::chrono::steady_clock::time_point m_OpticsRTTProfileLastLog{};
+
+	// Called once per dRenderView (render thread) before the scope / mirror passes.
+	void   PlanOpticsRTTFrame();
+	void   UpdateOpticsRenderProfiles();
+	void   RecordOpticsRTTCost(OpticsRTTScheduler::Pass pass, OpticsRenderProfiles::Variant variant, double costMs);
+
+	// Stereo visibility: combined culling frustum for both eyes + per-eye RenderView CPU cost.
+	// The engine's world / renderable list building isn't hooked in this build, so the engine still
+	// culls each eye itself. What the left eye captures is the mod's own per-draw work in
+	// dDrawModelExecute (model name, class, viewmodel / infected classification); the right eye
+	// looks each draw up instead of redoing it, as long as the frame and combined pose match.
+	struct StereoDrawClass
+	{
+		std::string modelName;
+		const char* className = nullptr;
+		bool isPlayerClass = false;
+		bool isViewmodelClass = false;
+		bool isViewmodelModel = false;
+		bool isArmsOrHandsModel = false;
+		SpecialInfectedType entityInfectedType = SpecialInfectedType::None;
+		SpecialInfectedType modelInfectedType = SpecialInfectedType::None;
+	};
+	using StereoVisibilityLists = StereoRenderableList<StereoDrawClass>;
+	enum class StereoDrawPass
+	{
+		None,
+		Capture,
+		Reuse
+	};
+	bool  m_StereoVisibilityReuse = true;
+	bool  m_StereoVisibilityDebugLog = false;
+	float m_StereoVisibilityDebugLogHz = 0.5f;
+	StereoVisibilityCache<StereoVisibilityLists> m_StereoVisibilityCache{};
+	StereoEyeCostStats m_StereoEyeCosts{};
+	float m_StereoCombinedPullback = 0.0f;
+	uint32_t m_StereoFrameId = 0;
+	bool  m_StereoFrameValid = false;
+	StereoDrawPass m_StereoDrawPass = StereoDrawPass::None;
+	DWORD m_StereoDrawThreadId = 0;
+	StereoVisibilityLists* m_StereoCaptureLists = nullptr;
+	const StereoVisibilityLists* m_StereoReuseLists = nullptr;
+	size_t m_StereoReuseCursor = 0;
+	uint64_t m_StereoReuseHits = 0;
+	uint64_t m_StereoReuseMisses = 0;
+	std::chrono::steady_clock::time_point m_StereoVisibilityLastLog{};
+
+	// Render thread: once per dRenderView before the eye renders, then around each eye's RenderView.
+	// BeginStereoEye(true) returns whether the second eye reuses the first eye's captures.
+	void   BeginStereoVisibilityFrame(uint32_t frameId, const CViewSetup& leftEye, const CViewSetup& rightEye);
+	bool   BeginStereoEye(bool secondEye);
+	void   EndStereoEye();
+	void   RecordStereoEyeCost(bool secondEye, bool reusedVisibility, double costMs);
+	// dDrawModelExecute: the draw's classification, captured / reused during the eye passes and
+	// computed fresh everywhere else (scope / mirror passes, other threads).
+	const StereoDrawClass& ClassifyStereoDraw(int entityIndex, void* model);
+	void   ComputeStereoDrawClass(int entityIndex, void* model, StereoDrawClass& out) const;
+
 	VR() {};
 	VR(Game* game);
+	// Startup stages, run by Game's init graph: OpenVR and input, then (once the D3D9 device exists)
+	// textures and overlays. StartConfigWatcher returns after the first config pass.
+	bool InitRuntime();
+	bool StartConfigWatcher();
+	static bool IsD3DDeviceReady();
+	bool InitDeviceResources();
 	int SetActionManifest(const char* fileName);
 	void InstallApplicationManifest(const char* fileName);
 	void Update();
+	void UpdateShadowQualityGovernor();
 	void ApplyShadowSettingsIfNeeded();
 	void ApplyFlashlightEnhancementIfNeeded();
 	void ApplyLocalVScriptConvarsIfNeeded();
@@ -2018,6 +2226,13 @@ public:
 	void CreateVRTextures();
 	void EnsureOpticsRTTTextures();
 	void LogVAS(const char* tag);
+	void UpdateVASBudget();
+	void OnVASPressureChanged(VasPressure previous, VasPressure current);
+	void TrimDXVKMappedMemory(VasPressure pressure);
+	void RetrimDXVKMappedMemoryIfRegrown(double now);
+	void SetKillIndicatorDecodedFrameBudget(size_t bytes);
+	size_t GetKillIndicatorDecodedFrameBytes() const;
+	int GetOpticsRTTCreateSize(int configuredSize) const { return (std::max)(128, configuredSize >> m_OpticsRTTPressureShift); }
 	void HandleMissingRenderContext(const char* location);
 	void SubmitVRTextures();
 	void LogCompositorError(const char* action, vr::EVRCompositorError error);
@@ -2054,7 +2269,6 @@ public:
 	void ResetAutoFlashlightState();
 	void IssueFlashlightToggle(bool manual);
 	bool QueryFlashlightState(C_BasePlayer* localPlayer, bool& outOn);
-	bool UpdateThirdPersonViewState(const Vector& cameraOrigin, const Vector& cameraAngles);
 	Vector GetViewAngle();
 	// Yaw (degrees) used as the movement basis for the walk axis.
 	// Default: HMD yaw. Optional: right-controller yaw (hand-oriented locomotion).
@@ -2075,6 +2289,7 @@ public:
 	void ResetPosition();
 	void GetPoseData(vr::TrackedDevicePose_t& poseRaw, TrackedDevicePoseData& poseOut);
 	void PoseWaiterThreadMain();
+	void OnMatQueueModeChanged(int previous, int current);
 	bool ReadPoseWaiterSnapshot(vr::TrackedDevicePose_t* outPoses, uint32_t* outSeq = nullptr) const;
 	// leftHand follows the project's gameplay hand ordering after LeftHanded remapping.
 	bool IsGameplayHandLeftPhysical(bool leftHand) const;
@@ -2091,14 +2306,15 @@ public:
 	void LoadViewmodelAdjustments();
 	void SaveViewmodelAdjustments();
 	void RefreshActiveViewmodelAdjustment(C_BasePlayer* localPlayer);
-	ViewmodelAdjustment& EnsureViewmodelAdjustment(const std::string& key);
-	std::string BuildViewmodelAdjustKey(C_WeaponCSBase* weapon) const;
+	int ResolveViewmodelAdjustSlot(C_WeaponCSBase* weapon);
+	void ViewmodelAdjustmentSaveWorkerMain();
 	std::string WeaponIdToString(int weaponId) const;
-	std::string NormalizeViewmodelAdjustKey(const std::string& rawKey) const;
 	std::string GetMeleeWeaponName(C_WeaponCSBase* weapon) const;
 	void WaitForConfigUpdate();
 	bool GetWalkAxis(float& x, float& y);
 	void UpdateNonVRAimSolution(C_BasePlayer* localPlayer);
+	// TraceRay through the per-frame aim query cache (m_AimQueries). Main thread only.
+	bool AimTraceRay(const Ray_t& ray, unsigned int mask, CTraceFilter* filter, uint64_t filterKey, CGameTrace& out);
 	// Friendly-fire aim guard:
 	// - m_AimLineHitsFriendly is computed from a ray trace and may flicker at hitbox edges.
 	// - While the attack button is held, flicker can effectively create press/release edges.
@@ -2106,6 +2322,8 @@ public:
 	// ticks and latch suppression until the user releases attack.
 	bool ShouldSuppressPrimaryFire(const CUserCmd* cmd, C_BasePlayer* localPlayer);
 	bool UpdateFriendlyFireAimHit(C_BasePlayer* localPlayer);
+	int CollectFriendlyFireCensus(C_BasePlayer* localPlayer, float paddingUnits);
+	bool ClassifyFriendlyFireSpread(C_BasePlayer* localPlayer, C_WeaponCSBase* weapon, const Vector& start, const Vector& dir, const CGameTrace& centerTrace, float traceLength);
 	void UpdateAimTeammateHudTarget(C_BasePlayer* localPlayer, const Vector& start, const Vector& end, bool aimLineActive);
 	bool GetAimTeammateHudInfo(int& outPlayerIndex, int& outPercent, char* outName, size_t outNameSize);
 	int GetIncapMaxHealth() const;
@@ -2131,7 +2349,7 @@ public:
 	bool ReadLocalHeadshotCounter(C_BasePlayer* localPlayer, int& outHeadshots) const;
 	bool IsKillSoundTargetEntity(const C_BaseEntity* entity) const;
 	bool ConsumePendingKillSoundHit(std::uintptr_t preferredEntityTag, std::chrono::steady_clock::time_point now, Vector* outImpactPos = nullptr);
-	bool FindPendingKillSoundHit(std::uintptr_t preferredEntityTag, std::chrono::steady_clock::time_point now, Vector* outImpactPos = nullptr, uint32_t preferredShotSerial = 0);
+	float EstimatePredictedHitConfidence(C_BasePlayer* localPlayer, C_BaseEntity* entity, const CGameTrace& trace, const Vector& start, float& outPredictedDamage, bool& outPredictedLethal);
 	void PlayHitSound(const Vector* worldPos = nullptr);
 	void PlayKillSound(bool headshot, const Vector* worldPos = nullptr);
 	bool TryPlayKillSoundSpec(const std::string& spec, float baseVolume = 1.0f, const Vector* worldPos = nullptr, bool preferLoadedPathReuse = true);
@@ -2170,6 +2388,55 @@ public:
 	bool IsUsingMountedGun(const C_BasePlayer* localPlayer) const;
 	C_BaseEntity* GetMountedGunUseEntity(C_BasePlayer* localPlayer) const;
 	bool m_EncodeVRUsercmd = true;
+	// 1 = legacy field packing (right controller only), 2 = bit-packed payload (both hands + HMD).
+	int  m_UsercmdPayloadVersion = 2;
+	bool m_UsercmdPayloadDebugLog = false;
+	VRCmdPayloadHistory<> m_UsercmdPayloadHistory;
+	uint64_t m_UsercmdPayloadWrites = 0;
+	uint64_t m_UsercmdPayloadBits = 0;
+	uint64_t m_UsercmdPayloadDrops = 0;
+	uint64_t m_UsercmdPayloadOutOfRange = 0;   // commands with a pose outside the fixed-point range (sent as unavailable)
+	std::chrono::steady_clock::time_point m_UsercmdPayloadLastLog{};
+	// Server-side swept melee for VR clients (dProcessUsercmds). Disabled = legacy fixed 10 traces per command.
+	bool  m_MeleeSweepAdaptive = true;
+	bool  m_MeleeSweepBroadPhase = true;       // trace only where server entities (or world geometry) are near the arc
+	float m_MeleeSweepReach = 70.0f;           // melee_range
+	float m_MeleeSweepSampleSpacing = 10.0f;   // arc length between samples at full reach
+	int   m_MeleeSweepMaxSamples = 16;
+	float m_MeleeSweepMinAngleDeg = 2.0f;
+	float m_MeleeSweepCandidateRadius = 40.0f;
+	bool  m_MeleeSweepDebugLog = false;
+	// Server: VR client shots use the recorded pose this many ticks behind the newest command read.
+	// Commands arriving in bursts run after all of them were read. -1 = the player's measured lag
+	// (VRServerStateStore::MeasuredLagTicks), 0 = always the newest pose.
+	float m_ServerShotPoseLagTicks = -1.0f;
+	// Aim traces (laser, non-VR aim solution, friendly-fire guard, teammate HUD, effective range) share
+	// one per-frame result cache; m_AimQueryFrameId advances once per UpdateTracking.
+	bool m_AimQueryDedup = true;
+	bool m_AimQueryDebugLog = false;
+	uint64_t m_AimQueryFrameId = 0;
+	AimQueryCache<VRAimTraceBlob, 32> m_AimQueries;
+	std::chrono::steady_clock::time_point m_AimQueryLastLog{};
+	// Live players / infected by position, refreshed at most m_EntityGridMaxHz (about once per client
+	// tick) from the client entity list. Proximity searches query it instead of walking every entity.
+	enum EntityGridTag : uint32_t
+	{
+		EntityGridTag_Survivor = 1u << 0,   // team 2
+		EntityGridTag_Infected = 1u << 1,   // team 3
+		EntityGridTag_Other = 1u << 2       // any other non-zero team (L4D1 survivors, spectators)
+	};
+	bool m_EntityGridEnabled = true;
+	float m_EntityGridCellSize = 256.0f;
+	// Cell size wanted by the config thread; RefreshEntityGrid re-grids on the main thread when it differs.
+	std::atomic<float> m_EntityGridPendingCellSize{ 256.0f };
+	float m_EntityGridMaxHz = 30.0f;
+	int m_EntityGridMaxLosTraces = 4;          // LOS traces per proximity search, nearest candidates first
+	mutable EntitySpatialHash m_EntityGrid;
+	mutable std::vector<EntitySpatialHit> m_EntityGridHits;
+	std::chrono::steady_clock::time_point m_EntityGridLastRefresh{};
+	void RefreshEntityGrid(C_BasePlayer* localPlayer);
+	MeleeSweepStats m_MeleeSweepStats{};
+	std::chrono::steady_clock::time_point m_MeleeSweepLastLog{};
 	void UpdateAimingLaser(C_BasePlayer* localPlayer);
 	void UpdateD3DAimLineOverlayForView(C_BasePlayer* localPlayer, const CViewSetup& view, int eyeIndex);
 	void ClearD3DAimLineOverlayEye(int eyeIndex);
@@ -2186,7 +2453,8 @@ public:
 	float CalculateThrowArcDistance(const Vector& pitchSource, bool* clampedToMax = nullptr) const;
 	void DrawAimLine(const Vector& start, const Vector& end);
 	void RenderDrawGameLaserSight(C_BasePlayer* localPlayer);
-	void DrawThrowArc(const Vector& origin, const Vector& forward, const Vector& pitchSource);
+	void DrawThrowArc(const Vector& origin, const Vector& forward, const Vector& pitchSource, C_BasePlayer* localPlayer, C_WeaponCSBase* weapon);
+	bool SolveThrowArc(const Vector& origin, const Vector& planarForward, const Vector& pitchSource, C_BasePlayer* localPlayer, C_WeaponCSBase* weapon);
 	void DrawThrowArcFromCache(float duration);
 	void DrawLineWithThickness(const Vector& start, const Vector& end, float duration);
 	bool IsLocalPlayerEntityIndex(int entityIndex) const;
@@ -2202,7 +2470,7 @@ public:
 	void UpdateSpecialInfectedWarningState();
 	void UpdateSpecialInfectedPreWarningState();
 	void EncodeRoomscale1To1Move(CUserCmd* cmd);
-	static bool DecodeRoomscale1To1Delta(int weaponsubtype, Vector& outDeltaMeters);
+	static bool DecodeRoomscale1To1Delta(int buttons, Vector& outDeltaMeters);
 	void OnPredictionRunCommand(CUserCmd* cmd);
 	void OnPrimaryAttackServerDecision(CUserCmd* cmd, bool fromSecondaryPrediction);
 	void StartSpecialInfectedWarningAction();
@@ -2214,11 +2482,17 @@ public:
 	bool IsEffectiveAttackRangeWitchTarget(const C_BaseEntity* entity) const;
 	void LogEffectiveAttackRangeTarget(C_BaseEntity* entity, C_WeaponCSBase* weapon, float distance, float maxRange, float spreadDegrees, bool cached, const char* dataSource);
 	bool EnsureEffectiveAttackRangeWeaponDataLoaded();
+	void StartEffectiveAttackRangeWeaponDataPreload(bool force);
+	// Loads on the calling thread (startup); false if a load was already running.
+	bool LoadEffectiveAttackRangeWeaponDataNow();
+	bool BeginEffectiveAttackRangeWeaponDataLoad(bool force);
+	void PollEffectiveAttackRangeWeaponData();
+	void EffectiveAttackRangeWeaponDataWorkerMain();
 	const EffectiveAttackRangeWeaponData* GetEffectiveAttackRangeWeaponData(C_WeaponCSBase* weapon);
 	float GetEffectiveAttackRangeSpreadDegrees(C_BasePlayer* localPlayer, C_WeaponCSBase* weapon, const EffectiveAttackRangeWeaponData& data) const;
 	float GetEffectiveAttackRangeHitPointTolerance(const Vector& start, const Vector& centerHitPos, float spreadDegrees, float maxRange) const;
-	bool DoesEffectiveAttackRangeSpreadConeHitTarget(C_BasePlayer* localPlayer, C_WeaponCSBase* weapon, C_BaseEntity* hitEntity, const Vector& start, const Vector& end, const Vector& centerHitPos, float spreadDegrees, float maxRange) const;
-	bool TryFindEffectiveAttackRangeMeleeFanTarget(C_BasePlayer* localPlayer, C_WeaponCSBase* weapon, const Vector& start, const Vector& end, float maxDistance, C_BaseEntity*& outTarget, Vector& outTargetPos, float& outDistance) const;
+	bool DoesEffectiveAttackRangeSpreadConeHitTarget(C_BasePlayer* localPlayer, C_WeaponCSBase* weapon, C_BaseEntity* hitEntity, const Vector& start, const Vector& end, const Vector& centerHitPos, float spreadDegrees, float maxRange);
+	bool TryFindEffectiveAttackRangeMeleeFanTarget(C_BasePlayer* localPlayer, C_WeaponCSBase* weapon, const Vector& start, const Vector& end, float maxDistance, C_BaseEntity*& outTarget, Vector& outTargetPos, float& outDistance);
 	void FinishFrame();
 	void ConfigureExplicitTiming();
 };
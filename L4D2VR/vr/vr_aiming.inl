@@ -79,6 +79,18 @@ namespace
         }
     }
 
+    // Identifies a CTraceFilterSkipThreeEntities(a, b, c, 0) for AimQueryCache lookups.
+    static inline uint64_t VR_AimQueryFilterKey(const void* a, const void* b, const void* c)
+    {
+        uint64_t h = 0x9E3779B97F4A7C15ull;
+        for (const void* p : { a, b, c })
+        {
+            h ^= static_cast<uint64_t>(reinterpret_cast<uintptr_t>(p)) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+            h *= 0xBF58476D1CE4E5B9ull;
+        }
+        return h;
+    }
+
     static std::string VR_NormalizeResourcePath(std::string path)
     {
         std::replace(path.begin(), path.end(), '\\', '/');
@@ -88,14 +100,6 @@ namespace
         return path;
     }
 
-    static std::string VR_TrimCopy(std::string value)
-    {
-        auto isSpace = [](unsigned char ch) { return std::isspace(ch) != 0; };
-        value.erase(value.begin(), std::find_if(value.begin(), value.end(), [&](char ch) { return !isSpace(static_cast<unsigned char>(ch)); }));
-        value.erase(std::find_if(value.rbegin(), value.rend(), [&](char ch) { return !isSpace(static_cast<unsigned char>(ch)); }).base(), value.end());
-        return value;
-    }
-
     static std::string VR_JoinWindowsPath(const std::string& base, const std::string& child)
     {
         if (base.empty())
@@ -426,100 +430,87 @@ namespace
         return false;
     }
 
-    static bool VR_ReadQuotedToken(const std::string& line, size_t& pos, std::string& out)
+    // Every file VR_TryReadGameResourceText could pick relativePath from, with its timestamp, in search
+    // order. VPK directories are listed once for all scripts (they don't depend on the path).
+    static void VR_AppendFileStamp(const std::string& path, std::vector<WeaponScriptStamp>& out)
     {
-        out.clear();
-
-        const size_t begin = line.find('"', pos);
-        if (begin == std::string::npos)
-            return false;
-        const size_t end = line.find('"', begin + 1);
-        if (end == std::string::npos)
-            return false;
+        WIN32_FILE_ATTRIBUTE_DATA attributes{};
+        if (!::GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attributes))
+            return;
+        if ((attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+            return;
 
-        out = line.substr(begin + 1, end - begin - 1);
-        pos = end + 1;
-        return true;
+        WeaponScriptStamp stamp;
+        stamp.path = path;
+        stamp.writeTime = (static_cast<uint64_t>(attributes.ftLastWriteTime.dwHighDateTime) << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+        stamp.size = (static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+        out.push_back(std::move(stamp));
     }
 
-    static bool VR_ParseWeaponScriptFloat(const std::string& text, const char* key, float& outValue)
+    static void VR_AppendVpkDirectoryStamps(const std::string& directory, std::vector<WeaponScriptStamp>& out)
     {
-        if (!key || !*key)
-            return false;
+        const std::string pattern = VR_JoinWindowsPath(directory, "*.vpk");
+        WIN32_FIND_DATAA data{};
+        HANDLE find = ::FindFirstFileA(pattern.c_str(), &data);
+        if (find == INVALID_HANDLE_VALUE)
+            return;
 
-        std::istringstream stream(text);
-        std::string line;
-        while (std::getline(stream, line))
+        std::vector<WeaponScriptStamp> stamps;
+        do
         {
-            const size_t comment = line.find("//");
-            if (comment != std::string::npos)
-                line = line.substr(0, comment);
-
-            size_t pos = 0;
-            std::string parsedKey;
-            std::string parsedValue;
-            if (!VR_ReadQuotedToken(line, pos, parsedKey) || !VR_ReadQuotedToken(line, pos, parsedValue))
-                continue;
-
-            if (_stricmp(parsedKey.c_str(), key) != 0)
+            if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
                 continue;
+            WeaponScriptStamp stamp;
+            stamp.path = VR_JoinWindowsPath(directory, data.cFileName);
+            stamp.writeTime = (static_cast<uint64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+            stamp.size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+            stamps.push_back(std::move(stamp));
+        } while (::FindNextFileA(find, &data));
+        ::FindClose(find);
 
-            try
-            {
-                outValue = std::stof(VR_TrimCopy(parsedValue));
-                return std::isfinite(outValue);
-            }
-            catch (...)
-            {
-                return false;
-            }
-        }
-
-        return false;
+        std::sort(stamps.begin(), stamps.end(), [](const WeaponScriptStamp& a, const WeaponScriptStamp& b) { return a.path < b.path; });
+        out.insert(out.end(), stamps.begin(), stamps.end());
     }
 
-    static bool VR_ParseWeaponScriptInt(const std::string& text, const char* key, int& outValue)
+    static bool VR_CollectGameResourceStamps(const std::vector<const char*>& relativePaths, std::vector<WeaponScriptStamp>& out)
     {
-        float value = 0.0f;
-        if (!VR_ParseWeaponScriptFloat(text, key, value))
+        out.clear();
+        const std::string moduleDir = VR_GetModuleDirectoryA();
+        if (moduleDir.empty())
             return false;
 
-        outValue = static_cast<int>(std::lround(value));
-        return true;
-    }
-
-    static bool VR_ParseEffectiveWeaponData(const std::string& text, VR::EffectiveAttackRangeWeaponData& outData)
-    {
-        VR::EffectiveAttackRangeWeaponData data{};
-        bool hasSpread = false;
-        hasSpread |= VR_ParseWeaponScriptFloat(text, "MinStandingSpread", data.minStandingSpread);
-        hasSpread |= VR_ParseWeaponScriptFloat(text, "MinDuckingSpread", data.minDuckingSpread);
-        hasSpread |= VR_ParseWeaponScriptFloat(text, "MinInAirSpread", data.minInAirSpread);
-        VR_ParseWeaponScriptFloat(text, "MaxMovementSpread", data.maxMovementSpread);
-        VR_ParseWeaponScriptFloat(text, "PelletScatterPitch", data.pelletScatterPitch);
-        VR_ParseWeaponScriptFloat(text, "PelletScatterYaw", data.pelletScatterYaw);
-        VR_ParseWeaponScriptFloat(text, "Range", data.range);
-        VR_ParseWeaponScriptFloat(text, "MaxPlayerSpeed", data.maxPlayerSpeed);
-        VR_ParseWeaponScriptInt(text, "Bullets", data.bullets);
-
-        if (!hasSpread)
-            return false;
+        const std::string l4d2Dir = VR_JoinWindowsPath(moduleDir, "left4dead2");
+        const std::array<std::string, 2> looseOverrideRoots =
+        {
+            VR_JoinWindowsPath(l4d2Dir, "downloads"),
+            l4d2Dir
+        };
+        const std::array<std::string, 3> vpkOverrideRoots =
+        {
+            VR_JoinWindowsPath(l4d2Dir, "downloads"),
+            VR_JoinWindowsPath(l4d2Dir, "addons"),
+            VR_JoinWindowsPath(VR_JoinWindowsPath(l4d2Dir, "addons"), "workshop")
+        };
+        const std::array<const char*, 5> searchRoots =
+        {
+            "update",
+            "left4dead2_dlc3",
+            "left4dead2_dlc2",
+            "left4dead2_dlc1",
+            "left4dead2"
+        };
 
-        if (data.minDuckingSpread <= 0.0f)
-            data.minDuckingSpread = data.minStandingSpread;
-        if (data.minInAirSpread <= 0.0f)
-            data.minInAirSpread = data.minStandingSpread;
-        data.minStandingSpread = std::max(0.0f, data.minStandingSpread);
-        data.minDuckingSpread = std::max(0.0f, data.minDuckingSpread);
-        data.minInAirSpread = std::max(0.0f, data.minInAirSpread);
-        data.maxMovementSpread = std::max(0.0f, data.maxMovementSpread);
-        data.pelletScatterPitch = std::max(0.0f, data.pelletScatterPitch);
-        data.pelletScatterYaw = std::max(0.0f, data.pelletScatterYaw);
-        data.range = std::clamp(data.range, 1.0f, 65536.0f);
-        data.maxPlayerSpeed = std::clamp(data.maxPlayerSpeed, 1.0f, 1000.0f);
-        data.bullets = std::max(1, data.bullets);
-        data.valid = true;
-        outData = data;
+        for (const char* relativePath : relativePaths)
+        {
+            for (const std::string& root : looseOverrideRoots)
+                VR_AppendFileStamp(VR_JoinWindowsPath(root, relativePath), out);
+            for (const char* root : searchRoots)
+                VR_AppendFileStamp(VR_JoinWindowsPath(VR_JoinWindowsPath(moduleDir, root), relativePath), out);
+        }
+        for (const std::string& root : vpkOverrideRoots)
+            VR_AppendVpkDirectoryStamps(root, out);
+        for (const char* root : searchRoots)
+            VR_AppendFileStamp(VR_JoinWindowsPath(VR_JoinWindowsPath(moduleDir, root), "pak01_dir.vpk"), out);
         return true;
     }
 
@@ -805,6 +796,65 @@ namespace
 
 }
 
+bool VR::AimTraceRay(const Ray_t& ray, unsigned int mask, CTraceFilter* filter, uint64_t filterKey, CGameTrace& out)
+{
+    static_assert(sizeof(CGameTrace) <= sizeof(VRAimTraceBlob), "VRAimTraceBlob too small for CGameTrace");
+
+    IEngineTrace* engineTrace = m_Game ? m_Game->m_EngineTrace : nullptr;
+    const Vector start = ray.m_Start + ray.m_StartOffset;
+    const Vector end = start + ray.m_Delta;
+    // Only line traces and cube hulls are keyed; anything else goes straight to the engine.
+    const bool cubeHull = ray.m_Extents.x == ray.m_Extents.y && ray.m_Extents.x == ray.m_Extents.z;
+    AimQueryRay query;
+    if (!m_AimQueryDedup || !cubeHull || !AimQueryRay::FromPoints(&start.x, &end.x, query))
+        return VR_SafeTraceRay(engineTrace, ray, mask, filter, out);
+    query.hullExtent = ray.m_IsRay ? 0.0f : ray.m_Extents.x;
+    query.mask = mask;
+    query.filterKey = filterKey;
+
+    bool traced = true;
+    const AimQueryServe<VRAimTraceBlob> serve = m_AimQueries.Query(m_AimQueryFrameId, query,
+        [&](const AimQueryRay& r, VRAimTraceBlob& blob, float& hitDistance)
+        {
+            CGameTrace tr;
+            traced = VR_SafeTraceRay(engineTrace, ray, mask, filter, tr);
+            std::memcpy(blob.bytes, &tr, sizeof(CGameTrace));
+            hitDistance = (tr.fraction < 1.0f) ? tr.fraction * r.length : r.length;
+            return traced;
+        });
+
+    std::memcpy(&out, serve.result->bytes, sizeof(CGameTrace));
+    if (serve.fromCache)
+    {
+        // Rebuild the cached trace along this request's ray: the hit distance carries over, the
+        // end position is projected onto this ray rather than reusing the cached one.
+        out.startpos = start;
+        if (serve.Hit(query.length))
+        {
+            out.fraction = std::clamp(serve.hitDistance / query.length, 0.0f, 1.0f);
+            out.endpos = start + ray.m_Delta * out.fraction;
+        }
+        else
+        {
+            out.fraction = 1.0f;
+            out.endpos = end;
+            out.m_pEnt = nullptr;
+            out.contents = 0;
+            out.hitgroup = 0;
+            out.hitbox = 0;
+        }
+    }
+
+    if (m_AimQueryDebugLog && !ShouldThrottle(m_AimQueryLastLog, 1.0f))
+    {
+        const auto& c = m_AimQueries.GetCounters();
+        Game::logMsg("[VR][AimQuery] requested=%llu executed=%llu served=%llu failed=%llu (%.0f%% deduped)",
+            (unsigned long long)c.requested, (unsigned long long)c.executed, (unsigned long long)c.served,
+            (unsigned long long)c.failed, c.requested ? (100.0 * (double)c.served / (double)c.requested) : 0.0);
+    }
+    return traced;
+}
+
 bool VR::IsUsingMountedGun(const C_BasePlayer* localPlayer) const
 {
     if (!localPlayer)
@@ -888,7 +938,7 @@ void VR::UpdateNonVRAimSolution(C_BasePlayer* localPlayer)
         CTraceFilterSkipThreeEntities tracefilterThree((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon, 0);
         CTraceFilter* pTraceFilter = static_cast<CTraceFilter*>(&tracefilterThree);
         rayH.Init(eye, endEye);
-        VR_SafeTraceRay(m_Game->m_EngineTrace, rayH, STANDARD_TRACE_MASK, pTraceFilter, traceH);
+        AimTraceRay(rayH, STANDARD_TRACE_MASK, pTraceFilter, VR_AimQueryFilterKey((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon), traceH);
 
         const Vector H = (traceH.fraction < 1.0f && traceH.fraction > 0.0f) ? traceH.endpos : endEye;
         m_NonVRAimHitPoint = H;
@@ -933,7 +983,7 @@ void VR::UpdateNonVRAimSolution(C_BasePlayer* localPlayer)
         CTraceFilterSkipThreeEntities tracefilterThree((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon, 0);
         CTraceFilter* pTraceFilter = static_cast<CTraceFilter*>(&tracefilterThree);
         rayH.Init(eye, endEye);
-        VR_SafeTraceRay(m_Game->m_EngineTrace, rayH, STANDARD_TRACE_MASK, pTraceFilter, traceH);
+        AimTraceRay(rayH, STANDARD_TRACE_MASK, pTraceFilter, VR_AimQueryFilterKey((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon), traceH);
 
         const Vector H = (traceH.fraction < 1.0f && traceH.fraction > 0.0f) ? traceH.endpos : endEye;
         m_NonVRAimHitPoint = H;
@@ -971,7 +1021,7 @@ void VR::UpdateNonVRAimSolution(C_BasePlayer* localPlayer)
         CTraceFilterSkipThreeEntities tracefilterThree((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon, 0);
         CTraceFilter* pTraceFilter = static_cast<CTraceFilter*>(&tracefilterThree);
         rayH.Init(eye, endEye);
-        VR_SafeTraceRay(m_Game->m_EngineTrace, rayH, STANDARD_TRACE_MASK, pTraceFilter, traceH);
+        AimTraceRay(rayH, STANDARD_TRACE_MASK, pTraceFilter, VR_AimQueryFilterKey((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon), traceH);
 
         const Vector H = (traceH.fraction < 1.0f && traceH.fraction > 0.0f) ? traceH.endpos : endEye;
         m_NonVRAimHitPoint = H;
@@ -1028,7 +1078,7 @@ void VR::UpdateNonVRAimSolution(C_BasePlayer* localPlayer)
     CTraceFilterSkipThreeEntities tracefilterThree((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon, 0);
     CTraceFilter* pTraceFilter = static_cast<CTraceFilter*>(&tracefilterThree);
     rayP.Init(origin, target);
-    VR_SafeTraceRay(m_Game->m_EngineTrace, rayP, STANDARD_TRACE_MASK, pTraceFilter, traceP);
+    AimTraceRay(rayP, STANDARD_TRACE_MASK, pTraceFilter, VR_AimQueryFilterKey((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon), traceP);
 
     const Vector P = (traceP.fraction < 1.0f && traceP.fraction > 0.0f) ? traceP.endpos : target;
     m_NonVRAimDesiredPoint = P;
@@ -1047,7 +1097,7 @@ void VR::UpdateNonVRAimSolution(C_BasePlayer* localPlayer)
     CGameTrace traceH;
     Ray_t rayH;
     rayH.Init(eye, endEye);
-    VR_SafeTraceRay(m_Game->m_EngineTrace, rayH, STANDARD_TRACE_MASK, pTraceFilter, traceH);
+    AimTraceRay(rayH, STANDARD_TRACE_MASK, pTraceFilter, VR_AimQueryFilterKey((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon), traceH);
 
     const Vector H = (traceH.fraction < 1.0f && traceH.fraction > 0.0f) ? traceH.endpos : endEye;
     m_NonVRAimHitPoint = H;
@@ -1202,6 +1252,7 @@ bool VR::UpdateFriendlyFireAimHit(C_BasePlayer* localPlayer)
     CTraceFilterSkipThreeEntities tracefilterThree((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon, 0);
     CTraceFilter* pTraceFilter = static_cast<CTraceFilter*>(&tracefilterThree);
 
+    const uint64_t traceFilterKey = VR_AimQueryFilterKey((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon);
     auto SafeTraceRay = [&](Ray_t& ray, unsigned int mask, CTraceFilter* filter, CGameTrace& out) -> bool
         {
             if (!m_Game || !m_Game->m_EngineTrace)
@@ -1210,18 +1261,8 @@ bool VR::UpdateFriendlyFireAimHit(C_BasePlayer* localPlayer)
                 out.m_pEnt = nullptr;
                 return false;
             }
-            __try
-            {
-                m_Game->m_EngineTrace->TraceRay(ray, mask, filter, &out);
-                return true;
-            }
-            __except (EXCEPTION_EXECUTE_HANDLER)
-            {
-                // Fail closed (no hit) rather than crash the game.
-                out.fraction = 1.0f;
-                out.m_pEnt = nullptr;
-                return false;
-            }
+            // Fails closed (no hit) rather than crash the game.
+            return AimTraceRay(ray, mask, filter, traceFilterKey, out);
         };
 
     auto hasValidHandle = [](uint32_t h) -> bool
@@ -1354,6 +1395,12 @@ bool VR::UpdateFriendlyFireAimHit(C_BasePlayer* localPlayer)
     SafeTraceRay(rayGun, traceMask, pTraceFilter, traceGun);
     const bool friendlyGun = evalFriendlyHitForTrace(traceGun, gunStart, gunEnd);
 
+    // Spread cone around each center ray, against the teammate census. Only needed while the center
+    // rays themselves are clear.
+    const bool spreadGuard = m_FriendlyFireSpreadGuardEnabled && CollectFriendlyFireCensus(localPlayer, hullRadiusUnits) > 0;
+    const bool friendlyGunSpread = spreadGuard && !friendlyGun
+        && ClassifyFriendlyFireSpread(localPlayer, activeWeapon, gunStart, gunDir, traceGun, 8192.0f);
+
     // 2) Eye ray (closer to authoritative server bullets, esp. with lag compensation)
     Vector eye = localPlayer->EyePosition();
 
@@ -1398,15 +1445,120 @@ bool VR::UpdateFriendlyFireAimHit(C_BasePlayer* localPlayer)
         SafeTraceRay(rayEye, traceMask, pTraceFilter, traceEye);
 
         const bool friendlyEye = evalFriendlyHitForTrace(traceEye, eyeStart, eyeEnd);
+        const bool friendlyEyeSpread = spreadGuard && !friendlyGun && !friendlyGunSpread && !friendlyEye
+            && ClassifyFriendlyFireSpread(localPlayer, activeWeapon, eyeStart, eyeDir2, traceEye, 8192.0f);
 
-        m_AimLineHitsFriendly = (friendlyGun || friendlyEye);
+        m_AimLineHitsFriendly = (friendlyGun || friendlyEye || friendlyGunSpread || friendlyEyeSpread);
         return m_AimLineHitsFriendly;
     }
 
-    m_AimLineHitsFriendly = friendlyGun;
+    m_AimLineHitsFriendly = (friendlyGun || friendlyGunSpread);
     return m_AimLineHitsFriendly;
 }
 
+int VR::CollectFriendlyFireCensus(C_BasePlayer* localPlayer, float paddingUnits)
+{
+    m_FriendlyFireCensus.clear();
+    if (!localPlayer || !m_Game || !m_Game->m_ClientEntityList)
+        return 0;
+
+    int localTeam = 0;
+    if (!VR_TryReadI32(reinterpret_cast<const unsigned char*>(localPlayer), kTeamNumOffset, localTeam) || localTeam == 0)
+        return 0;
+
+    // Survivor hull: 32 wide, 72 tall standing; crouched hitboxes reach a bit above the 36-unit hull.
+    constexpr float kBodyRadius = 14.0f;
+    constexpr float kStandingHeight = 72.0f;
+    constexpr float kDuckingHeight = 52.0f;
+    const float radius = kBodyRadius + std::clamp(paddingUnits, 0.0f, 32.0f);
+
+    const int highestIndex = (std::min)(m_Game->m_ClientEntityList->GetHighestEntityIndex(), static_cast<int>(Game::kMaxPlayers) - 1);
+    for (int i = 1; i <= highestIndex; ++i)
+    {
+        C_BaseEntity* entity = m_Game->GetClientEntity(i);
+        if (!entity || entity == localPlayer || entity->IsPlayer() == nullptr)
+            continue;
+
+        const unsigned char* base = reinterpret_cast<const unsigned char*>(entity);
+        int team = 0;
+        if (!VR_TryReadI32(base, kTeamNumOffset, team) || team != localTeam || !IsEntityAlive(entity))
+            continue;
+
+        // Pinned teammates are left to the center-ray check, which knows when the shot is aimed at the
+        // attacker on top of them.
+        uint32_t handles[5] = {};
+        VR_TryReadU32(base, kTongueOwnerOffset, handles[0]);
+        VR_TryReadU32(base, kPummelAttackerOffset, handles[1]);
+        VR_TryReadU32(base, kCarryAttackerOffset, handles[2]);
+        VR_TryReadU32(base, kPounceAttackerOffset, handles[3]);
+        VR_TryReadU32(base, kJockeyAttackerOffset, handles[4]);
+        if (std::any_of(std::begin(handles), std::end(handles), [](uint32_t h) { return h != 0u && h != 0xFFFFFFFFu; }))
+            continue;
+
+        Vector origin{};
+        if (!VR_TryGetEntityAbsOrigin(entity, origin))
+            continue;
+
+        int flags = 0;
+        const bool ducking = VR_TryReadI32(base, kFlagsOffset, flags) && ((flags & 0x2) != 0); // FL_DUCKING
+        const float height = ducking ? kDuckingHeight : kStandingHeight;
+
+        FriendlyFireCapsule capsule;
+        capsule.a = { origin.x, origin.y, origin.z + kBodyRadius };
+        capsule.b = { origin.x, origin.y, origin.z + height - kBodyRadius };
+        capsule.radius = radius;
+        capsule.index = i;
+        m_FriendlyFireCensus.push_back(capsule);
+    }
+    return static_cast<int>(m_FriendlyFireCensus.size());
+}
+
+bool VR::ClassifyFriendlyFireSpread(C_BasePlayer* localPlayer, C_WeaponCSBase* weapon, const Vector& start, const Vector& dir, const CGameTrace& centerTrace, float traceLength)
+{
+    if (m_FriendlyFireCensus.empty() || dir.IsZero())
+        return false;
+
+    // No script data yet (still loading, or a custom weapon): the center rays are all we have.
+    const EffectiveAttackRangeWeaponData* data = GetEffectiveAttackRangeWeaponData(weapon);
+    if (!data)
+        return false;
+    const float spread = GetEffectiveAttackRangeSpreadDegrees(localPlayer, weapon, *data);
+    if (spread <= 0.0f)
+        return false;
+
+    // Shotguns scatter wider in yaw than in pitch; keep that shape at the current spread.
+    float halfPitch = spread;
+    float halfYaw = spread;
+    if (data->bullets > 1 && data->pelletScatterPitch > 0.0f && data->pelletScatterYaw > 0.0f)
+    {
+        const float widest = (std::max)(data->pelletScatterPitch, data->pelletScatterYaw);
+        halfPitch = spread * (data->pelletScatterPitch / widest);
+        halfYaw = spread * (data->pelletScatterYaw / widest);
+    }
+
+    const int samples = std::clamp(m_FriendlyFireSpreadSamples, 8, 128);
+    if (m_FriendlyFireSpreadPattern.GetCount() != samples)
+        m_FriendlyFireSpreadPattern.Build(samples);
+    m_FriendlyFireSpreadPattern.SetSpread(halfPitch, halfYaw);
+
+    // World occlusion comes from the center trace: the world and props (team 0) stop the cone there,
+    // while infected and other players don't (bullets can pass through them).
+    float worldDistance = traceLength;
+    if (centerTrace.fraction < 1.0f)
+    {
+        const C_BaseEntity* hitEnt = reinterpret_cast<const C_BaseEntity*>(centerTrace.m_pEnt);
+        int team = 0;
+        if (!hitEnt || (VR_TryReadI32(reinterpret_cast<const unsigned char*>(hitEnt), kTeamNumOffset, team) && team == 0))
+            worldDistance = traceLength * (std::max)(centerTrace.fraction, 0.0f);
+    }
+
+    const FriendlyFireResult result = FriendlyFireClassifier::Classify(
+        { start.x, start.y, start.z }, { dir.x, dir.y, dir.z }, worldDistance,
+        m_FriendlyFireSpreadPattern, data->bullets,
+        m_FriendlyFireCensus.data(), static_cast<int>(m_FriendlyFireCensus.size()));
+    return result.shotHitChance >= std::clamp(m_FriendlyFireSpreadBlockChance, 0.01f, 1.0f);
+}
+
 bool VR::ShouldSuppressPrimaryFire(const CUserCmd* cmd, C_BasePlayer* localPlayer)
 {
     if (!m_BlockFireOnFriendlyAimEnabled)
@@ -1652,7 +1804,7 @@ void VR::UpdateAimingLaser(C_BasePlayer* localPlayer)
         else if (!m_ForceNonVRServerMovement && !m_HmdForward.IsZero())
             pitchSource = m_HmdForward;
 
-        DrawThrowArc(origin, direction, pitchSource);
+        DrawThrowArc(origin, direction, pitchSource, localPlayer, activeWeapon);
         return;
     }
 
@@ -1686,7 +1838,7 @@ void VR::UpdateAimingLaser(C_BasePlayer* localPlayer)
             CTraceFilter* pTraceFilter = static_cast<CTraceFilter*>(&tracefilterThree);
 
             ray.Init(origin, target);
-            VR_SafeTraceRay(m_Game->m_EngineTrace, ray, STANDARD_TRACE_MASK, pTraceFilter, trace);
+            AimTraceRay(ray, STANDARD_TRACE_MASK, pTraceFilter, VR_AimQueryFilterKey((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon), trace);
 
             m_AimConvergePoint = (trace.fraction < 1.0f && trace.fraction > 0.0f) ? trace.endpos : target;
             m_HasAimConvergePoint = true;
@@ -1724,7 +1876,7 @@ void VR::UpdateAimingLaser(C_BasePlayer* localPlayer)
         CTraceFilterSkipThreeEntities tracefilterThree((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon, 0);
         CTraceFilter* pTraceFilter = static_cast<CTraceFilter*>(&tracefilterThree);
         visibleRay.Init(origin, target);
-        if (VR_SafeTraceRay(m_Game->m_EngineTrace, visibleRay, STANDARD_TRACE_MASK, pTraceFilter, visibleTrace)
+        if (AimTraceRay(visibleRay, STANDARD_TRACE_MASK, pTraceFilter, VR_AimQueryFilterKey((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon), visibleTrace)
             && visibleTrace.fraction < 1.0f
             && visibleTrace.fraction > 0.0f)
         {
@@ -1800,7 +1952,7 @@ void VR::UpdateAimTeammateHudTarget(C_BasePlayer* localPlayer, const Vector& sta
         CTraceFilter* pFilter = static_cast<CTraceFilter*>(&filterThree);
 
         ray.Init(start, end);
-        VR_SafeTraceRay(m_Game->m_EngineTrace, ray, STANDARD_TRACE_MASK, pFilter, tr);
+        AimTraceRay(ray, STANDARD_TRACE_MASK, pFilter, VR_AimQueryFilterKey((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon), tr);
 
         hitEnt = reinterpret_cast<C_BaseEntity*>(tr.m_pEnt);
         UpdateAimLineEffectiveAttackRange(
@@ -2196,67 +2348,155 @@ void VR::LogEffectiveAttackRangeTarget(C_BaseEntity* entity, C_WeaponCSBase* wea
         (dataSource && *dataSource) ? dataSource : "<unknown>");
 }
 
+namespace
+{
+    struct VR_EffectiveAttackRangeWeaponScript
+    {
+        C_WeaponCSBase::WeaponID weaponId;
+        const char* path;
+    };
+
+    constexpr VR_EffectiveAttackRangeWeaponScript kEffectiveAttackRangeWeaponScripts[] =
+    {
+        { C_WeaponCSBase::PISTOL, "scripts/weapon_pistol.txt" },
+        { C_WeaponCSBase::MAGNUM, "scripts/weapon_pistol_magnum.txt" },
+        { C_WeaponCSBase::UZI, "scripts/weapon_smg.txt" },
+        { C_WeaponCSBase::MAC10, "scripts/weapon_smg_silenced.txt" },
+        { C_WeaponCSBase::MP5, "scripts/weapon_smg_mp5.txt" },
+        { C_WeaponCSBase::M16A1, "scripts/weapon_rifle.txt" },
+        { C_WeaponCSBase::AK47, "scripts/weapon_rifle_ak47.txt" },
+        { C_WeaponCSBase::SCAR, "scripts/weapon_rifle_desert.txt" },
+        { C_WeaponCSBase::SG552, "scripts/weapon_rifle_sg552.txt" },
+        { C_WeaponCSBase::HUNTING_RIFLE, "scripts/weapon_hunting_rifle.txt" },
+        { C_WeaponCSBase::SNIPER_MILITARY, "scripts/weapon_sniper_military.txt" },
+        { C_WeaponCSBase::AWP, "scripts/weapon_sniper_awp.txt" },
+        { C_WeaponCSBase::SCOUT, "scripts/weapon_sniper_scout.txt" },
+        { C_WeaponCSBase::M60, "scripts/weapon_rifle_m60.txt" },
+        { C_WeaponCSBase::PUMPSHOTGUN, "scripts/weapon_pumpshotgun.txt" },
+        { C_WeaponCSBase::SHOTGUN_CHROME, "scripts/weapon_shotgun_chrome.txt" },
+        { C_WeaponCSBase::AUTOSHOTGUN, "scripts/weapon_autoshotgun.txt" },
+        { C_WeaponCSBase::SPAS, "scripts/weapon_shotgun_spas.txt" },
+    };
+
+    constexpr const char* kEffectiveAttackRangeWeaponCachePath = "VR\\weapon_data_cache.bin";
+}
+
 bool VR::EnsureEffectiveAttackRangeWeaponDataLoaded()
 {
-    auto hasLoadedData = [&]() -> bool
-        {
-            for (const auto& data : m_EffectiveAttackRangeWeaponData)
-            {
-                if (data.valid)
-                    return true;
-            }
-            return false;
-        };
+    PollEffectiveAttackRangeWeaponData();
+    if (m_EffectiveAttackRangeWeaponDataLoaded)
+        return true;
+
+    // Not loaded yet (or the last load found nothing): make sure a load is on its way, never wait.
+    StartEffectiveAttackRangeWeaponDataPreload(false);
+    return false;
+}
+
+bool VR::BeginEffectiveAttackRangeWeaponDataLoad(bool force)
+{
+    if (m_EffectiveAttackRangeWeaponDataLoading.load(std::memory_order_acquire))
+        return false;
 
     const auto now = std::chrono::steady_clock::now();
-    if (m_EffectiveAttackRangeWeaponDataLoaded && hasLoadedData())
-        return hasLoadedData();
-    if (m_EffectiveAttackRangeWeaponDataLoaded &&
-        std::chrono::duration<float>(now - m_EffectiveAttackRangeWeaponDataLastLoad).count() < 2.0f)
+    if (!force && m_EffectiveAttackRangeWeaponDataLastLoad.time_since_epoch().count() != 0 &&
+        std::chrono::duration<float>(now - m_EffectiveAttackRangeWeaponDataLastLoad).count() < m_EffectiveAttackRangeWeaponDataRetrySeconds)
     {
         return false;
     }
 
-    m_EffectiveAttackRangeWeaponDataLoaded = true;
+    bool expected = false;
+    if (!m_EffectiveAttackRangeWeaponDataLoading.compare_exchange_strong(expected, true))
+        return false;
     m_EffectiveAttackRangeWeaponDataLastLoad = now;
-    m_EffectiveAttackRangeWeaponData = {};
+    return true;
+}
 
-    auto loadScript = [&](C_WeaponCSBase::WeaponID weaponId, const char* scriptPath)
-        {
-            const size_t index = static_cast<size_t>(weaponId);
-            if (!scriptPath || index >= m_EffectiveAttackRangeWeaponData.size())
-                return;
+bool VR::LoadEffectiveAttackRangeWeaponDataNow()
+{
+    if (!BeginEffectiveAttackRangeWeaponDataLoad(true))
+        return false;
 
-            std::string text;
-            std::string source;
-            EffectiveAttackRangeWeaponData data{};
-            if (VR_TryReadGameResourceText(scriptPath, text, &source) && VR_ParseEffectiveWeaponData(text, data))
-            {
-                data.source = source.empty() ? scriptPath : source;
-                m_EffectiveAttackRangeWeaponData[index] = data;
-            }
-        };
+    EffectiveAttackRangeWeaponDataWorkerMain();
+    return true;
+}
+
+void VR::StartEffectiveAttackRangeWeaponDataPreload(bool force)
+{
+    if (!BeginEffectiveAttackRangeWeaponDataLoad(force))
+        return;
 
-    loadScript(C_WeaponCSBase::PISTOL, "scripts/weapon_pistol.txt");
-    loadScript(C_WeaponCSBase::MAGNUM, "scripts/weapon_pistol_magnum.txt");
-    loadScript(C_WeaponCSBase::UZI, "scripts/weapon_smg.txt");
-    loadScript(C_WeaponCSBase::MAC10, "scripts/weapon_smg_silenced.txt");
-    loadScript(C_WeaponCSBase::MP5, "scripts/weapon_smg_mp5.txt");
-    loadScript(C_WeaponCSBase::M16A1, "scripts/weapon_rifle.txt");
-    loadScript(C_WeaponCSBase::AK47, "scripts/weapon_rifle_ak47.txt");
-    loadScript(C_WeaponCSBase::SCAR, "scripts/weapon_rifle_desert.txt");
-    loadScript(C_WeaponCSBase::SG552, "scripts/weapon_rifle_sg552.txt");
-    loadScript(C_WeaponCSBase::HUNTING_RIFLE, "scripts/weapon_hunting_rifle.txt");
-    loadScript(C_WeaponCSBase::SNIPER_MILITARY, "scripts/weapon_sniper_military.txt");
-    loadScript(C_WeaponCSBase::AWP, "scripts/weapon_sniper_awp.txt");
-    loadScript(C_WeaponCSBase::SCOUT, "scripts/weapon_sniper_scout.txt");
-    loadScript(C_WeaponCSBase::M60, "scripts/weapon_rifle_m60.txt");
-    loadScript(C_WeaponCSBase::PUMPSHOTGUN, "scripts/weapon_pumpshotgun.txt");
-    loadScript(C_WeaponCSBase::SHOTGUN_CHROME, "scripts/weapon_shotgun_chrome.txt");
-    loadScript(C_WeaponCSBase::AUTOSHOTGUN, "scripts/weapon_autoshotgun.txt");
-    loadScript(C_WeaponCSBase::SPAS, "scripts/weapon_shotgun_spas.txt");
-
-    return hasLoadedData();
+    try
+    {
+        std::thread worker(&VR::EffectiveAttackRangeWeaponDataWorkerMain, this);
+        worker.detach();
+    }
+    catch (const std::system_error&)
+    {
+        m_EffectiveAttackRangeWeaponDataLoading.store(false, std::memory_order_release);
+    }
+}
+
+void VR::PollEffectiveAttackRangeWeaponData()
+{
+    if (!m_EffectiveAttackRangeWeaponDataReady.exchange(false, std::memory_order_acq_rel))
+        return;
+
+    std::lock_guard<std::mutex> lock(m_EffectiveAttackRangeWeaponDataMutex);
+    const bool hasData = std::any_of(m_EffectiveAttackRangeWeaponDataPending.begin(), m_EffectiveAttackRangeWeaponDataPending.end(),
+        [](const EffectiveAttackRangeWeaponData& data) { return data.valid; });
+    if (hasData)
+    {
+        m_EffectiveAttackRangeWeaponData.swap(m_EffectiveAttackRangeWeaponDataPending);
+        m_EffectiveAttackRangeWeaponDataLoaded = true;
+        m_EffectiveAttackRangeWeaponDataRetrySeconds = 2.0f;
+    }
+    else if (!m_EffectiveAttackRangeWeaponDataLoaded)
+    {
+        // Keep whatever table we had; back off so a missing install doesn't respawn loads every 2 s.
+        m_EffectiveAttackRangeWeaponDataRetrySeconds = std::min(m_EffectiveAttackRangeWeaponDataRetrySeconds * 2.0f, 60.0f);
+    }
+}
+
+void VR::EffectiveAttackRangeWeaponDataWorkerMain()
+{
+    std::array<EffectiveAttackRangeWeaponData, 64> table{};
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<const char*> scriptPaths;
+    std::vector<WeaponScriptDb::ScriptSlot> scripts;
+    for (const auto& script : kEffectiveAttackRangeWeaponScripts)
+    {
+        scriptPaths.push_back(script.path);
+        scripts.push_back({ static_cast<uint16_t>(script.weaponId), script.path });
+    }
+
+    std::vector<WeaponScriptStamp> stamps;
+    const bool haveStamps = VR_CollectGameResourceStamps(scriptPaths, stamps);
+    const uint64_t fingerprint = WeaponScriptDb::Fingerprint(stamps);
+
+    std::vector<WeaponScriptCacheEntry> entries;
+    const bool fromCache = WeaponScriptDb::LoadOrBuild(kEffectiveAttackRangeWeaponCachePath, haveStamps, fingerprint, scripts.data(), scripts.size(),
+        table.size(), [](const char* path, std::string& text, std::string& source) { return VR_TryReadGameResourceText(path, text, &source); }, entries);
+    for (const WeaponScriptCacheEntry& entry : entries)
+    {
+        if (entry.slot < table.size())
+            table[entry.slot] = entry.data;
+    }
+
+    if (m_EffectiveAttackRangeDebugLog)
+    {
+        Game::logMsg("[VR][EffectiveRange] weapon data: %d scripts from %s in %.1f ms (%d stamps)",
+            static_cast<int>(entries.size()), fromCache ? "cache" : "game files",
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count(),
+            static_cast<int>(stamps.size()));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_EffectiveAttackRangeWeaponDataMutex);
+        m_EffectiveAttackRangeWeaponDataPending = std::move(table);
+    }
+    m_EffectiveAttackRangeWeaponDataReady.store(true, std::memory_order_release);
+    m_EffectiveAttackRangeWeaponDataLoading.store(false, std::memory_order_release);
 }
 
 const VR::EffectiveAttackRangeWeaponData* VR::GetEffectiveAttackRangeWeaponData(C_WeaponCSBase* weapon)
@@ -2323,7 +2563,7 @@ float VR::GetEffectiveAttackRangeHitPointTolerance(const Vector& start, const Ve
     return std::clamp(dynamicTolerance, baseTolerance, maxTolerance);
 }
 
-bool VR::DoesEffectiveAttackRangeSpreadConeHitTarget(C_BasePlayer* localPlayer, C_WeaponCSBase* weapon, C_BaseEntity* hitEntity, const Vector& start, const Vector& end, const Vector& centerHitPos, float spreadDegrees, float maxRange) const
+bool VR::DoesEffectiveAttackRangeSpreadConeHitTarget(C_BasePlayer* localPlayer, C_WeaponCSBase* weapon, C_BaseEntity* hitEntity, const Vector& start, const Vector& end, const Vector& centerHitPos, float spreadDegrees, float maxRange)
 {
     if (!localPlayer || !weapon || !hitEntity || !m_Game || !m_Game->m_EngineTrace || !m_Game->m_ClientEntityList)
         return false;
@@ -2365,6 +2605,7 @@ bool VR::DoesEffectiveAttackRangeSpreadConeHitTarget(C_BasePlayer* localPlayer,
     IHandleEntity* safeActiveWeapon = VR_GetSafeTraceSkipEntity(entityList, reinterpret_cast<IHandleEntity*>(weapon));
     CTraceFilterSkipThreeEntities filterThree((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon, 0);
     CTraceFilter* pFilter = static_cast<CTraceFilter*>(&filterThree);
+    const uint64_t filterKey = VR_AimQueryFilterKey((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon);
 
     constexpr int kSamples = 8;
     constexpr int kRelaxedMovementRequiredHits = 5;
@@ -2381,7 +2622,7 @@ bool VR::DoesEffectiveAttackRangeSpreadConeHitTarget(C_BasePlayer* localPlayer,
         CGameTrace sampleTrace;
         Ray_t sampleRay;
         sampleRay.Init(start, start + sampleDir * maxRange);
-        if (!VR_SafeTraceRay(m_Game->m_EngineTrace, sampleRay, STANDARD_TRACE_MASK, pFilter, sampleTrace))
+        if (!AimTraceRay(sampleRay, STANDARD_TRACE_MASK, pFilter, filterKey, sampleTrace))
             return false;
 
         C_BaseEntity* sampleHit = reinterpret_cast<C_BaseEntity*>(sampleTrace.m_pEnt);
@@ -2413,7 +2654,54 @@ bool VR::DoesEffectiveAttackRangeSpreadConeHitTarget(C_BasePlayer* localPlayer,
     return relaxedMovement ? (hitCount >= kRelaxedMovementRequiredHits) : true;
 }
 
-bool VR::TryFindEffectiveAttackRangeMeleeFanTarget(C_BasePlayer* localPlayer, C_WeaponCSBase* weapon, const Vector& start, const Vector& end, float maxDistance, C_BaseEntity*& outTarget, Vector& outTargetPos, float& outDistance) const
+void VR::RefreshEntityGrid(C_BasePlayer* localPlayer)
+{
+    // Re-grid here rather than on the config thread, which would race the queries below.
+    const float cellSize = m_EntityGridPendingCellSize.load(std::memory_order_relaxed);
+    if (m_EntityGrid.GetCellSize() != cellSize)
+    {
+        m_EntityGrid.Configure(m_EntityGrid.GetMaxEntities(), cellSize);
+        m_EntityGridLastRefresh = {};
+    }
+
+    if (!m_EntityGridEnabled || !localPlayer || !m_Game || !m_Game->m_ClientEntityList)
+    {
+        if (m_EntityGrid.Size() > 0)
+            m_EntityGrid.Clear();
+        return;
+    }
+    if (ShouldThrottle(m_EntityGridLastRefresh, m_EntityGridMaxHz))
+        return;
+
+    const int highestEntityIndex = (std::min)(m_Game->m_ClientEntityList->GetHighestEntityIndex(), m_EntityGrid.GetMaxEntities() - 1);
+    m_EntityGrid.BeginUpdate();
+    for (int entityIndex = 1; entityIndex <= highestEntityIndex; ++entityIndex)
+    {
+        C_BaseEntity* entity = m_Game->GetClientEntity(entityIndex);
+        if (!entity || entity == localPlayer)
+            continue;
+
+        // Team 0 covers the world, props, weapons and projectiles: nothing a proximity search wants.
+        // An entity whose team can't be read stays in as Other, as the linear searches keep it.
+        int team = 0;
+        const bool hasTeam = VR_TryReadI32(reinterpret_cast<const unsigned char*>(entity), kTeamNumOffset, team);
+        if (hasTeam && team == 0)
+            continue;
+        if (!IsEntityAlive(entity))
+            continue;
+
+        Vector origin{};
+        if (!VR_TryGetEntityAbsOrigin(entity, origin))
+            continue;
+
+        const uint32_t tag = !hasTeam ? EntityGridTag_Other
+            : (team == 2) ? EntityGridTag_Survivor : (team == 3) ? EntityGridTag_Infected : EntityGridTag_Other;
+        m_EntityGrid.Update(entityIndex, { origin.x, origin.y, origin.z }, tag);
+    }
+    m_EntityGrid.EndUpdate();
+}
+
+bool VR::TryFindEffectiveAttackRangeMeleeFanTarget(C_BasePlayer* localPlayer, C_WeaponCSBase* weapon, const Vector& start, const Vector& end, float maxDistance, C_BaseEntity*& outTarget, Vector& outTargetPos, float& outDistance)
 {
     outTarget = nullptr;
     outTargetPos = { 0.0f, 0.0f, 0.0f };
@@ -2442,56 +2730,135 @@ bool VR::TryFindEffectiveAttackRangeMeleeFanTarget(C_BasePlayer* localPlayer, C_
     IHandleEntity* safeActiveWeapon = VR_GetSafeTraceSkipEntity(entityList, reinterpret_cast<IHandleEntity*>(weapon));
     CTraceFilterSkipThreeEntities filterThree(reinterpret_cast<IHandleEntity*>(localPlayer), safeMountedUseEnt, safeActiveWeapon, 0);
     CTraceFilter* pFilter = static_cast<CTraceFilter*>(&filterThree);
+    const uint64_t filterKey = VR_AimQueryFilterKey((IHandleEntity*)localPlayer, safeMountedUseEnt, safeActiveWeapon);
 
-    float bestDistance = maxDistance + 1.0f;
-    float bestDot = -1.0f;
-    const int highestEntityIndex = entityList->GetHighestEntityIndex();
-    for (int entityIndex = 1; entityIndex <= highestEntityIndex; ++entityIndex)
-    {
-        C_BaseEntity* candidate = m_Game->GetClientEntity(entityIndex);
-        if (!candidate || candidate == localPlayer)
-            continue;
+    // Exact checks on the current entity state; the grid (when used) only narrows the candidates.
+    auto inspect = [&](int entityIndex, C_BaseEntity*& outCandidate, Vector& outPos, float& outPlanarDistance, float& outDot) -> bool
+        {
+            C_BaseEntity* candidate = m_Game->GetClientEntity(entityIndex);
+            if (!candidate || candidate == localPlayer)
+                return false;
 
-        if (!IsEntityAlive(candidate))
-            continue;
+            if (!IsEntityAlive(candidate))
+                return false;
 
-        const unsigned char* base = reinterpret_cast<const unsigned char*>(candidate);
-        int team = 0;
-        const bool hasTeam = VR_TryReadI32(base, kTeamNumOffset, team);
-        if ((hasTeam && team == 2) || (hasTeam && team == 0))
-            continue;
+            const unsigned char* base = reinterpret_cast<const unsigned char*>(candidate);
+            int team = 0;
+            const bool hasTeam = VR_TryReadI32(base, kTeamNumOffset, team);
+            if ((hasTeam && team == 2) || (hasTeam && team == 0))
+                return false;
 
-        Vector targetPos{};
-        if (!VR_TryGetEntityAbsOrigin(candidate, targetPos))
-            continue;
-        targetPos.z += 36.0f;
+            Vector targetPos{};
+            if (!VR_TryGetEntityAbsOrigin(candidate, targetPos))
+                return false;
+            targetPos.z += 36.0f;
 
-        Vector toTargetPlanar = targetPos - traceStart;
-        toTargetPlanar.z = 0.0f;
-        const float planarDistance = toTargetPlanar.Length();
-        if (!std::isfinite(planarDistance) || planarDistance <= 0.1f || planarDistance > maxDistance)
-            continue;
+            Vector toTargetPlanar = targetPos - traceStart;
+            toTargetPlanar.z = 0.0f;
+            const float planarDistance = toTargetPlanar.Length();
+            if (!std::isfinite(planarDistance) || planarDistance <= 0.1f || planarDistance > maxDistance)
+                return false;
 
-        Vector targetDir = toTargetPlanar;
-        VectorNormalize(targetDir);
-        const float targetDot = DotProduct(forward, targetDir);
-        if (!std::isfinite(targetDot) || targetDot < minDot)
-            continue;
+            Vector targetDir = toTargetPlanar;
+            VectorNormalize(targetDir);
+            const float targetDot = DotProduct(forward, targetDir);
+            if (!std::isfinite(targetDot) || targetDot < minDot)
+                return false;
 
-        if (!IsEffectiveAttackRangeTarget(candidate))
-            continue;
+            if (!IsEffectiveAttackRangeTarget(candidate))
+                return false;
 
-        CGameTrace trace;
-        Ray_t ray;
-        ray.Init(traceStart, targetPos);
-        if (!VR_SafeTraceRay(m_Game->m_EngineTrace, ray, STANDARD_TRACE_MASK, pFilter, trace))
+            outCandidate = candidate;
+            outPos = targetPos;
+            outPlanarDistance = planarDistance;
+            outDot = targetDot;
+            return true;
+        };
+
+    auto unobstructed = [&](C_BaseEntity* candidate, const Vector& targetPos) -> bool
+        {
+            CGameTrace trace;
+            Ray_t ray;
+            ray.Init(traceStart, targetPos);
+            if (!AimTraceRay(ray, STANDARD_TRACE_MASK, pFilter, filterKey, trace))
+                return false;
+
+            const C_BaseEntity* traceEntity = reinterpret_cast<C_BaseEntity*>(trace.m_pEnt);
+            return (!trace.startsolid && !trace.allsolid) &&
+                (traceEntity == candidate || trace.fraction >= 0.999f);
+        };
+
+    if (m_EntityGridEnabled)
+    {
+        // Cone candidates from the grid (positions up to one refresh old, hence the slack), re-checked
+        // exactly, then traced nearest first: the first unobstructed one is the answer, so only the
+        // closest few ever cost a trace.
+        EntitySpatialCone cone;
+        cone.origin = { traceStart.x, traceStart.y, traceStart.z };
+        cone.dir = { forward.x, forward.y, 0.0f };
+        cone.minDot = minDot;
+        cone.minDistance = 0.1f;
+        cone.maxDistance = maxDistance;
+        cone.planar = true;
+        cone.slack = 32.0f;
+        std::vector<EntitySpatialHit>& hits = m_EntityGridHits;
+        m_EntityGrid.QueryCone(cone, EntityGridTag_Infected | EntityGridTag_Other, hits);
+
+        size_t kept = 0;
+        for (const EntitySpatialHit& hit : hits)
+        {
+            C_BaseEntity* candidate = nullptr;
+            Vector targetPos{};
+            float planarDistance = 0.0f;
+            float targetDot = 0.0f;
+            if (!inspect(hit.index, candidate, targetPos, planarDistance, targetDot))
+                continue;
+            hits[kept++] = { hit.index, planarDistance, targetDot };
+        }
+        hits.resize(kept);
+        std::sort(hits.begin(), hits.end(), [](const EntitySpatialHit& a, const EntitySpatialHit& b)
+            {
+                if (std::fabs(a.distance - b.distance) > 0.01f)
+                    return a.distance < b.distance;
+                return a.dot > b.dot;
+            });
+
+        const int maxTraces = std::max(1, m_EntityGridMaxLosTraces);
+        int traces = 0;
+        for (const EntitySpatialHit& hit : hits)
+        {
+            if (traces >= maxTraces)
+                break;
+            C_BaseEntity* candidate = m_Game->GetClientEntity(hit.index);
+            Vector targetPos{};
+            if (!candidate || !VR_TryGetEntityAbsOrigin(candidate, targetPos))
+                continue;
+            targetPos.z += 36.0f;
+            ++traces;
+            if (!unobstructed(candidate, targetPos))
+                continue;
+
+            outTarget = candidate;
+            outTargetPos = targetPos;
+            outDistance = hit.distance;
+            break;
+        }
+        return outTarget != nullptr;
+    }
+
+    float bestDistance = maxDistance + 1.0f;
+    float bestDot = -1.0f;
+    const int highestEntityIndex = entityList->GetHighestEntityIndex();
+    for (int entityIndex = 1; entityIndex <= highestEntityIndex; ++entityIndex)
+    {
+        C_BaseEntity* candidate = nullptr;
+        Vector targetPos{};
+        float planarDistance = 0.0f;
+        float targetDot = 0.0f;
+        if (!inspect(entityIndex, candidate, targetPos, planarDistance, targetDot))
             continue;
 
-        const C_BaseEntity* traceEntity = reinterpret_cast<C_BaseEntity*>(trace.m_pEnt);
-        const bool unobstructed =
-            (!trace.startsolid && !trace.allsolid) &&
-            (traceEntity == candidate || trace.fraction >= 0.999f);
-        if (!unobstructed)
+        if (!unobstructed(candidate, targetPos))
             continue;
 
         const bool betterCandidate =
@@ -3237,7 +3604,7 @@ void VR::RenderDrawGameLaserSight(C_BasePlayer* localPlayer)
 }
 
 
-void VR::DrawThrowArc(const Vector& origin, const Vector& forward, const Vector& pitchSource)
+void VR::DrawThrowArc(const Vector& origin, const Vector& forward, const Vector& pitchSource, C_BasePlayer* localPlayer, C_WeaponCSBase* weapon)
 {
     if (!m_Game->m_DebugOverlay || !m_AimLineEnabled)
         return;
@@ -3255,6 +3622,15 @@ void VR::DrawThrowArc(const Vector& origin, const Vector& forward, const Vector&
     Vector distanceSource = pitchSource.IsZero() ? direction : pitchSource;
     VectorNormalize(distanceSource);
 
+    const float duration = std::max(m_AimLinePersistence, m_LastFrameDuration * m_AimLineFrameDurationMultiplier);
+    if (m_ThrowArcPhysics)
+    {
+        m_HasThrowArc = SolveThrowArc(origin, planarForward, distanceSource, localPlayer, weapon);
+        m_HasAimLine = false;
+        DrawThrowArcFromCache(duration);
+        return;
+    }
+
     bool clampedToMaxDistance = false;
     const float distance = CalculateThrowArcDistance(distanceSource, &clampedToMaxDistance);
     if (clampedToMaxDistance)
@@ -3275,7 +3651,6 @@ void VR::DrawThrowArc(const Vector& origin, const Vector& forward, const Vector&
             return a + (b - a) * t;
         };
 
-    const float duration = std::max(m_AimLinePersistence, m_LastFrameDuration * m_AimLineFrameDurationMultiplier);
     for (int i = 0; i <= THROW_ARC_SEGMENTS; ++i)
     {
         const float t = static_cast<float>(i) / static_cast<float>(THROW_ARC_SEGMENTS);
@@ -3290,6 +3665,75 @@ void VR::DrawThrowArc(const Vector& origin, const Vector& forward, const Vector&
     DrawThrowArcFromCache(duration);
 }
 
+bool VR::SolveThrowArc(const Vector& origin, const Vector& planarForward, const Vector& pitchSource, C_BasePlayer* localPlayer, C_WeaponCSBase* weapon)
+{
+    int profileId = 0;
+    if (weapon)
+    {
+        switch (weapon->GetWeaponID())
+        {
+        case C_WeaponCSBase::PIPE_BOMB: profileId = 1; break;
+        case C_WeaponCSBase::VOMITJAR: profileId = 2; break;
+        default: break;
+        }
+    }
+    const ThrowArcProfile& profile = m_ThrowArcProfiles[profileId];
+
+    // Yaw follows the hand, pitch follows the view (the game throws along the eye angles).
+    const float pitchSin = std::clamp(pitchSource.z, -1.0f, 1.0f);
+    const float pitchCos = std::sqrt(std::max(0.0f, 1.0f - pitchSin * pitchSin));
+    ThrowArcLaunch launch;
+    launch.origin = { origin.x, origin.y, origin.z };
+    launch.velocity = {
+        planarForward.x * pitchCos * profile.speed,
+        planarForward.y * pitchCos * profile.speed,
+        pitchSin * profile.speed };
+
+    const double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    m_ThrowArcCache.m_OriginThreshold = m_ThrowArcCacheMove;
+    if (!m_ThrowArcCache.IsValid(launch, profileId, now))
+    {
+        IClientEntityList* entityList = m_Game ? m_Game->m_ClientEntityList : nullptr;
+        IHandleEntity* safeWeapon = VR_GetSafeTraceSkipEntity(entityList, reinterpret_cast<IHandleEntity*>(weapon));
+        CTraceFilterSkipTwoEntities filter((IHandleEntity*)localPlayer, safeWeapon, 0);
+
+        const ThrowArcHit hit = ThrowArcSolver::FindFirstHit(launch, profile, m_ThrowArcMaxTraces,
+            [&](const ThrowArcVec3& a, const ThrowArcVec3& b, float& fraction, ThrowArcVec3& normal)
+            {
+                Ray_t ray;
+                ray.Init(Vector(a.x, a.y, a.z), Vector(b.x, b.y, b.z));
+                CGameTrace tr;
+                if (!VR_SafeTraceRay(m_Game ? m_Game->m_EngineTrace : nullptr, ray, MASK_SHOT_HULL, &filter, tr))
+                    return false;
+                fraction = tr.fraction;
+                normal = { tr.plane.normal.x, tr.plane.normal.y, tr.plane.normal.z };
+                return tr.fraction < 1.0f && !tr.startsolid;
+            });
+
+        // Nothing hit within the flight time (thrown into the open, or off a ledge): end the arc where
+        // it crosses the heuristic's landing height (ThrowArcLandingOffset below / above the launch),
+        // or draw the whole flight unterminated if it never gets there.
+        float endTime = hit.time;
+        if (!hit.hit)
+        {
+            float planeTime = 0.0f;
+            if (ThrowArcSolver::PlaneCrossingTime(launch, profile, launch.origin.z + m_ThrowArcLandingOffset, planeTime))
+                endTime = planeTime;
+        }
+
+        ThrowArcVec3 points[THROW_ARC_SEGMENTS + 1];
+        ThrowArcSolver::BuildPolyline(launch, profile, endTime, points, THROW_ARC_SEGMENTS + 1);
+        if (hit.hit)
+            points[THROW_ARC_SEGMENTS] = hit.point;
+        m_ThrowArcCache.Store(launch, profileId, now, hit, points, THROW_ARC_SEGMENTS + 1);
+    }
+
+    const ThrowArcVec3* points = m_ThrowArcCache.GetPoints();
+    for (int i = 0; i <= THROW_ARC_SEGMENTS; ++i)
+        m_LastThrowArcPoints[i] = Vector(points[i].x, points[i].y, points[i].z);
+    return true;
+}
+
 void VR::DrawThrowArcFromCache(float duration)
 {
     if (!m_Game->m_DebugOverlay || !m_HasThrowArc)
@@ -3299,9 +3743,42 @@ void VR::DrawThrowArcFromCache(float duration)
     if (ShouldThrottle(m_LastThrowArcDrawTime, m_ThrowArcMaxHz))
         return;
 
+    int colorR = 0;
+    int colorG = 0;
+    int colorB = 0;
+    int colorA = 0;
+    GetAimLineColor(colorR, colorG, colorB, colorA);
+    if (colorA <= 0)
+        return;
+
+    // One flat ribbon facing the HMD, two triangles per segment. The side vector is built from the
+    // view direction, so winding them toward the HMD is enough; no back faces are needed.
+    const float radius = std::max(m_AimLineThickness, 0.0f) * 0.5f;
     for (int i = 0; i < THROW_ARC_SEGMENTS; ++i)
     {
-        DrawLineWithThickness(m_LastThrowArcPoints[i], m_LastThrowArcPoints[i + 1], duration);
+        const Vector& a = m_LastThrowArcPoints[i];
+        const Vector& b = m_LastThrowArcPoints[i + 1];
+        if (radius <= 0.0f)
+        {
+            m_Game->m_DebugOverlay->AddLineOverlay(a, b, colorR, colorG, colorB, false, duration);
+            continue;
+        }
+
+        Vector side = CrossProduct(b - a, a - m_HmdPosAbs);
+        if (side.IsZero())
+        {
+            m_Game->m_DebugOverlay->AddLineOverlay(a, b, colorR, colorG, colorB, false, duration);
+            continue;
+        }
+        VectorNormalize(side);
+        side *= radius;
+
+        const Vector a0 = a - side;
+        const Vector a1 = a + side;
+        const Vector b0 = b - side;
+        const Vector b1 = b + side;
+        m_Game->m_DebugOverlay->AddTriangleOverlay(a0, b1, a1, colorR, colorG, colorB, colorA, false, duration);
+        m_Game->m_DebugOverlay->AddTriangleOverlay(a0, b0, b1, colorR, colorG, colorB, colorA, false, duration);
     }
 }
 
@@ -847,7 +847,10 @@ inline const wchar_t* PickHudFontFaceForText(const std::wstring& ws)
 VR::VR(Game* game)
 {
     m_Game = game;
+}
 
+bool VR::InitRuntime()
+{
     char errorString[MAX_STR_LEN];
 
     vr::HmdError error = vr::VRInitError_None;
@@ -857,14 +860,14 @@ VR::VR(Game* game)
     {
         snprintf(errorString, MAX_STR_LEN, "VR_Init failed: %s", vr::VR_GetVRInitErrorAsEnglishDescription(error));
         Game::errorMsg(errorString);
-        return;
+        return false;
     }
 
     m_Compositor = vr::VRCompositor();
     if (!m_Compositor)
     {
         Game::errorMsg("Compositor initialization failed.");
-        return;
+        return false;
     }
 
     char currentDir[MAX_STR_LEN];
@@ -907,15 +910,51 @@ VR::VR(Game* game)
 
     InstallApplicationManifest("manifest.vrmanifest");
     SetActionManifest("action_manifest.json");
+    return true;
+}
 
+bool VR::StartConfigWatcher()
+{
     std::thread configParser(&VR::WaitForConfigUpdate, this);
     configParser.detach();
 
-    while (!g_D3DVR9)
-        Sleep(10);
+    // Settings read by later startup stages (sound warmup) come from the first pass.
+    while (!m_ConfigInitialPassDone.load(std::memory_order_acquire))
+        Sleep(1);
+    return true;
+}
+
+bool VR::IsD3DDeviceReady()
+{
+    return g_D3DVR9 != nullptr;
+}
 
-    g_D3DVR9->GetBackBufferData(&m_VKBackBuffer);
+bool VR::InitDeviceResources()
+{
+    if (!g_D3DVR9)
+        return false;
+
+    // Mapped-memory trimming is an IDirect3DVR9_1 extension. Without it the VAS budget still tracks
+    // pressure, it just can't hand DXVK's mapped textures back. g_D3DVR9 keeps the object alive.
+    void* trim = nullptr;
+    if (SUCCEEDED(g_D3DVR9->QueryInterface(__uuidof(IDirect3DVR9_1), &trim)) && trim)
+    {
+        m_D3DVR9Trim = static_cast<IDirect3DVR9_1*>(trim);
+        m_D3DVR9Trim->Release();
+    }
+    else
+    {
+        m_D3DVR9Trim = nullptr;
+        Game::logMsg("[VR][VAS] d3d9.dll has no IDirect3DVR9_1; DXVK mapped texture memory won't be trimmed");
+    }
+
+    {
+        std::lock_guard<TextureStateMutex> textureLock(m_TextureMutex);
+        g_D3DVR9->GetBackBufferData(&m_VKBackBuffer);
+        PublishTextureSet();
+    }
     m_Overlay = vr::VROverlay();
+    m_OverlayCache.SetApi(m_Overlay);
     m_Overlay->CreateOverlay("MenuOverlayKey", "MenuOverlay", &m_MainMenuHandle);
     m_Overlay->CreateOverlay("HUDOverlayTopKey", "HUDOverlayTop", &m_HUDTopHandle);
 
@@ -976,6 +1015,7 @@ VR::VR(Game* game)
 
     m_IsInitialized = true;
     m_IsVREnabled = true;
+    return true;
 }
 
 void VR::ConfigureExplicitTiming()
@@ -68,26 +68,30 @@ void VR::PoseWaiterThreadMain()
     }
 }
 
-bool VR::UpdatePosesAndActions()
+void VR::OnMatQueueModeChanged(int previous, int current)
 {
-    if (!m_Compositor)
-        return false;
-    const bool queued = (m_Game && (m_Game->GetMatQueueMode() != 0));
-    uint32_t submitToken = 0;
-    static std::atomic<uint32_t> s_fallbackSubmitToken{ 0 };
-
-	// Pose waiter publishes WaitGetPoses() snapshots on a dedicated thread in queued mode.
-	// Optional render-thread pacing uses this event to wait for a fresh snapshot.
-	if (queued && !m_PoseWaiterEvent)
-		m_PoseWaiterEvent = CreateEventA(nullptr, FALSE, FALSE, nullptr);
+    // Called on whichever thread refreshed the cached thread mode.
+    const bool queued = (current != 0);
 
-    // Start pose waiter once; enable it only in queued mode.
+    // Pose waiter publishes WaitGetPoses() snapshots on a dedicated thread in queued mode.
+    // Optional render-thread pacing uses the event to wait for a fresh snapshot.
     if (queued && !m_PoseWaiterStarted.exchange(true, std::memory_order_acq_rel))
     {
+        if (!m_PoseWaiterEvent)
+            m_PoseWaiterEvent = CreateEventA(nullptr, FALSE, FALSE, nullptr);
         std::thread t(&VR::PoseWaiterThreadMain, this);
         t.detach();
     }
     m_PoseWaiterEnabled.store(queued, std::memory_order_release);
+}
+
+bool VR::UpdatePosesAndActions()
+{
+    if (!m_Compositor)
+        return false;
+    const bool queued = (m_Game && (m_Game->GetMatQueueMode() != 0));
+    uint32_t submitToken = 0;
+    static std::atomic<uint32_t> s_fallbackSubmitToken{ 0 };
 
     bool posesValid = false;
     if (queued && m_System)
@@ -124,6 +128,9 @@ bool VR::UpdatePosesAndActions()
     if (!posesValid && m_CompositorExplicitTiming)
         m_CompositorNeedsHandoff = false;
 
+    const vr::TrackedDevicePose_t& hmdPose = m_Poses[vr::k_unTrackedDeviceIndex_Hmd];
+    m_OverlayFrame.SetHmdPose(hmdPose.mDeviceToAbsoluteTracking, hmdPose.bPoseIsValid);
+
     m_Input->UpdateActionState(&m_ActiveActionSet, sizeof(vr::VRActiveActionSet_t), 1);
     return posesValid;
 }
@@ -219,7 +226,7 @@ void VR::ProcessMenuInput()
     // only activate laser if a controller is pointing at the overlay
     if (isHoveringOverlay)
     {
-        vr::VROverlay()->SetOverlayFlag(currentOverlay, vr::VROverlayFlags_MakeOverlaysInteractiveIfVisible, true);
+        m_OverlayCache.SetFlag(currentOverlay, vr::VROverlayFlags_MakeOverlaysInteractiveIfVisible, true);
 
         int windowWidth, windowHeight;
         m_Game->m_MaterialSystem->GetRenderContext()->GetWindowSize(windowWidth, windowHeight);
@@ -269,7 +276,7 @@ void VR::ProcessMenuInput()
     }
     else
     {
-        vr::VROverlay()->SetOverlayFlag(currentOverlay, vr::VROverlayFlags_MakeOverlaysInteractiveIfVisible, false);
+        m_OverlayCache.SetFlag(currentOverlay, vr::VROverlayFlags_MakeOverlaysInteractiveIfVisible, false);
 
         if (PressedDigitalAction(m_MenuSelect, true))
         {
@@ -706,49 +713,7 @@ void VR::UpdateHandHudOverlays()
 
     auto buildRel = [&](float xOff, float yOff, float zOff, const QAngle& ang) -> vr::HmdMatrix34_t
     {
-        const float deg2rad = 3.14159265358979323846f / 180.0f;
-        const float pitch = ang.x * deg2rad;
-        const float yaw = ang.y * deg2rad;
-        const float roll = ang.z * deg2rad;
-
-        const float cp = cosf(pitch), sp = sinf(pitch);
-        const float cy = cosf(yaw), sy = sinf(yaw);
-        const float cr = cosf(roll), sr = sinf(roll);
-
-        const float Rx[3][3] = {
-            {1.0f, 0.0f, 0.0f},
-            {0.0f, cp,   -sp},
-            {0.0f, sp,   cp}
-        };
-        const float Ry[3][3] = {
-            {cy,   0.0f, sy},
-            {0.0f, 1.0f, 0.0f},
-            {-sy,  0.0f, cy}
-        };
-        const float Rz[3][3] = {
-            {cr,   -sr,  0.0f},
-            {sr,   cr,   0.0f},
-            {0.0f, 0.0f, 1.0f}
-        };
-
-        auto mul33 = [](const float a[3][3], const float b[3][3], float out[3][3])
-        {
-            for (int r = 0; r < 3; ++r)
-                for (int c = 0; c < 3; ++c)
-                    out[r][c] = a[r][0] * b[0][c] + a[r][1] * b[1][c] + a[r][2] * b[2][c];
-        };
-
-        float RyRx[3][3];
-        float R[3][3];
-        mul33(Ry, Rx, RyRx);
-        mul33(Rz, RyRx, R);
-
-        vr::HmdMatrix34_t rel = {
-            R[0][0], R[0][1], R[0][2], xOff,
-            R[1][0], R[1][1], R[1][2], yOff,
-            R[2][0], R[2][1], R[2][2], zOff
-        };
-        return rel;
+        return Mat34::RotationZYXDeg(ang.x, ang.y, ang.z, Vec3(xOff, yOff, zOff)).To<vr::HmdMatrix34_t>();
     };
 
     const bool canShowLeft = m_LeftWristHudEnabled && m_LeftWristHudHandle != vr::k_ulOverlayHandleInvalid && (worldQuad || m_MouseModeEnabled || offHandIndex != vr::k_unTrackedDeviceIndexInvalid);
@@ -1685,25 +1650,9 @@ after_right:
     // Place them side-by-side under the RearMirrorOverlay, inheriting its pose.
     if (m_MouseModeEnabled && (leftVisible || rightVisible) && m_RearMirrorHandle != vr::k_ulOverlayHandleInvalid)
     {
-        auto mul34 = [](const vr::HmdMatrix34_t& a, const vr::HmdMatrix34_t& b) -> vr::HmdMatrix34_t
+        auto belowMirror = [](const Mat34& mirror, float x, float y) -> vr::HmdMatrix34_t
         {
-            vr::HmdMatrix34_t out{};
-            for (int r = 0; r < 3; ++r)
-            {
-                for (int c = 0; c < 3; ++c)
-                    out.m[r][c] = a.m[r][0] * b.m[0][c] + a.m[r][1] * b.m[1][c] + a.m[r][2] * b.m[2][c];
-                out.m[r][3] = a.m[r][0] * b.m[0][3] + a.m[r][1] * b.m[1][3] + a.m[r][2] * b.m[2][3] + a.m[r][3];
-            }
-            return out;
-        };
-
-        auto translate34 = [](float x, float y, float z) -> vr::HmdMatrix34_t
-        {
-            vr::HmdMatrix34_t t{};
-            t.m[0][0] = 1.0f; t.m[0][1] = 0.0f; t.m[0][2] = 0.0f; t.m[0][3] = x;
-            t.m[1][0] = 0.0f; t.m[1][1] = 1.0f; t.m[1][2] = 0.0f; t.m[1][3] = y;
-            t.m[2][0] = 0.0f; t.m[2][1] = 0.0f; t.m[2][2] = 1.0f; t.m[2][3] = z;
-            return t;
+            return Mat34Math::Compose(mirror, Mat34::Translation(x, y, 0.0f)).To<vr::HmdMatrix34_t>();
         };
 
         auto getWidthMeters = [&](vr::VROverlayHandle_t h, float fallback) -> float
@@ -1739,6 +1688,24 @@ after_right:
         const float gapY = 0.01f;
         const float yRow = -(mirrorW * 0.5f + rowH * 0.5f + gapY);
 
+        // The mirror is placed absolutely by UpdateRearMirrorOverlayTransform earlier in the frame;
+        // ask OpenVR only if it hasn't been placed yet.
+        if (m_RearMirrorOverlayTransformValid)
+        {
+            const vr::ETrackingUniverseOrigin origin = vr::VRCompositor()->GetTrackingSpace();
+            if (leftVisible)
+            {
+                const vr::HmdMatrix34_t mat = belowMirror(m_RearMirrorOverlayTransform, xL, yRow);
+                vr::VROverlay()->SetOverlayTransformAbsolute(m_LeftWristHudHandle, origin, &mat);
+            }
+            if (rightVisible)
+            {
+                const vr::HmdMatrix34_t mat = belowMirror(m_RearMirrorOverlayTransform, xR, yRow);
+                vr::VROverlay()->SetOverlayTransformAbsolute(m_RightAmmoHudHandle, origin, &mat);
+            }
+            return;
+        }
+
         vr::VROverlayTransformType parentType{};
         if (vr::VROverlay()->GetOverlayTransformType(m_RearMirrorHandle, &parentType) != vr::VROverlayError_None)
             parentType = vr::VROverlayTransform_Absolute;
@@ -1751,12 +1718,12 @@ after_right:
             {
                 if (leftVisible)
                 {
-                    const vr::HmdMatrix34_t mat = mul34(originToMirror, translate34(xL, yRow, 0.0f));
+                    const vr::HmdMatrix34_t mat = belowMirror(Mat34::From(originToMirror), xL, yRow);
                     vr::VROverlay()->SetOverlayTransformAbsolute(m_LeftWristHudHandle, origin, &mat);
                 }
                 if (rightVisible)
                 {
-                    const vr::HmdMatrix34_t mat = mul34(originToMirror, translate34(xR, yRow, 0.0f));
+                    const vr::HmdMatrix34_t mat = belowMirror(Mat34::From(originToMirror), xR, yRow);
                     vr::VROverlay()->SetOverlayTransformAbsolute(m_RightAmmoHudHandle, origin, &mat);
                 }
             }
@@ -1770,12 +1737,12 @@ after_right:
             {
                 if (leftVisible)
                 {
-                    const vr::HmdMatrix34_t mat = mul34(devToMirror, translate34(xL, yRow, 0.0f));
+                    const vr::HmdMatrix34_t mat = belowMirror(Mat34::From(devToMirror), xL, yRow);
                     vr::VROverlay()->SetOverlayTransformTrackedDeviceRelative(m_LeftWristHudHandle, parentDev, &mat);
                 }
                 if (rightVisible)
                 {
-                    const vr::HmdMatrix34_t mat = mul34(devToMirror, translate34(xR, yRow, 0.0f));
+                    const vr::HmdMatrix34_t mat = belowMirror(Mat34::From(devToMirror), xR, yRow);
                     vr::VROverlay()->SetOverlayTransformTrackedDeviceRelative(m_RightAmmoHudHandle, parentDev, &mat);
                 }
             }
@@ -574,12 +574,24 @@ void VR::Update()
         }
     }
 
+    if (!m_MatQueueModeSubscribed)
+    {
+        m_Game->m_MatQueueModeCache.Subscribe([this](int previous, int current) { OnMatQueueModeChanged(previous, current); });
+        m_MatQueueModeSubscribed = true;
+        const int mode = m_Game->GetMatQueueMode();
+        OnMatQueueModeChanged(mode, mode);
+    }
+    m_Game->RefreshMatQueueMode();
+
     const bool queuedAtFrameStart = (m_Game && (m_Game->GetMatQueueMode() != 0));
     if (!queuedAtFrameStart)
         SubmitVRTextures();
 
     bool posesValid = UpdatePosesAndActions();
     UpdateAutoMatQueueMode();
+    Hooks::UpdateHookMode();
+    UpdateVASBudget();
+    UpdateShadowQualityGovernor();
     ApplyShadowSettingsIfNeeded();
     ApplyFlashlightEnhancementIfNeeded();
     ApplyLocalVScriptConvarsIfNeeded();
@@ -660,6 +672,7 @@ void VR::Update()
     }
 
     UpdateTracking();
+    m_OverlayFrame.SetWorldView(ToVec3(m_HmdPosAbs), ToVec3(m_HmdForward), ToVec3(m_HmdRight), ToVec3(m_HmdUp), m_VRScale);
     UpdateKillSoundFeedback();
     UpdateKillIndicatorOverlays();
     UpdateDamageFeedback();
@@ -676,6 +689,9 @@ void VR::Update()
     else
         ProcessInput();
 
+    // Input handling shows / hides the HUD and toggles overlay interactivity; issue that now rather
+    // than with the next frame's submit.
+    FlushOverlayState();
     FlushHapticMixer();
 }
 
@@ -709,6 +725,96 @@ void VR::LogVAS(const char* tag)
         BytesToMiB(st.committed));
 }
 
+void VR::UpdateVASBudget()
+{
+    if (!m_VASBudgetEnabled)
+        return;
+
+    if (!m_VASBudgetSubscribed)
+    {
+        m_VASBudget.Subscribe([this](VasPressure previous, VasPressure current) { OnVASPressureChanged(previous, current); });
+        m_VASBudgetSubscribed = true;
+    }
+
+    const double now = SteadySeconds(std::chrono::steady_clock::now());
+    if (!m_VASBudget.SampleDue(now))
+        return;
+
+    // GlobalMemoryStatusEx is cheap; the region walk only runs when the budget asks for the largest block.
+    VasSample sample{};
+    MEMORYSTATUSEX status{};
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status))
+        sample.freeTotal = static_cast<uint64_t>(status.ullAvailVirtual);
+    if (sample.freeTotal == 0 || m_VASBudget.WantsRegionWalk(sample.freeTotal, now))
+    {
+        const VASStats st = QueryVASStats();
+        sample.freeTotal = st.freeTotal;
+        sample.freeLargest = st.freeLargest;
+    }
+
+    m_VASBudget.SetTracked(VasCategory::DecodedFrameCache, GetKillIndicatorDecodedFrameBytes());
+    m_VASBudget.Update(sample, now);
+
+    // At the edge, give mapped chunks back again once DXVK has mapped a meaningful amount since the
+    // last trim, not on every sample (a full unmap each time just thrashes the same textures).
+    if (m_VASBudget.GetPressure() == VasPressure::Critical)
+        RetrimDXVKMappedMemoryIfRegrown(now);
+}
+
+void VR::RetrimDXVKMappedMemoryIfRegrown(double now)
+{
+    if (!m_D3DVR9Trim || !m_VASMappedTrim.RetrimDue(m_VASBudget.GetPressure(), now))
+        return;
+
+    UINT mapped = 0;
+    if (FAILED(m_D3DVR9Trim->GetMappedMemory(&mapped)) || !m_VASMappedTrim.Regrown(mapped))
+        return;
+
+    TrimDXVKMappedMemory(VasPressure::Critical);
+}
+
+void VR::OnVASPressureChanged(VasPressure previous, VasPressure current)
+{
+    const VasSample& sample = m_VASBudget.GetLastSample();
+    Game::logMsg(
+        "[VR][VAS] pressure %s -> %s | free %.1f MiB (largest %.1f MiB) | tracked %.1f MiB (eye %.1f, optics %.1f, hud %.1f, killind %.1f, frames %.1f)",
+        VasBudget::PressureName(previous),
+        VasBudget::PressureName(current),
+        BytesToMiB(static_cast<size_t>(sample.freeTotal)),
+        BytesToMiB(static_cast<size_t>(sample.freeLargest)),
+        BytesToMiB(static_cast<size_t>(m_VASBudget.GetTrackedTotal())),
+        BytesToMiB(static_cast<size_t>(m_VASBudget.GetTracked(VasCategory::EyeTargets))),
+        BytesToMiB(static_cast<size_t>(m_VASBudget.GetTracked(VasCategory::OpticsTargets))),
+        BytesToMiB(static_cast<size_t>(m_VASBudget.GetTracked(VasCategory::HudTargets))),
+        BytesToMiB(static_cast<size_t>(m_VASBudget.GetTracked(VasCategory::KillIndicatorTextures))),
+        BytesToMiB(static_cast<size_t>(m_VASBudget.GetTracked(VasCategory::DecodedFrameCache))));
+
+    // Decoded kill-indicator frames are re-decoded on demand, so the cache just gets a smaller budget.
+    static constexpr size_t kDecodedFrameBudgets[] = { SIZE_MAX, 32u << 20, 8u << 20, 0u };
+    SetKillIndicatorDecodedFrameBudget(kDecodedFrameBudgets[static_cast<int>(current)]);
+    m_VASBudget.SetTracked(VasCategory::DecodedFrameCache, GetKillIndicatorDecodedFrameBytes());
+
+    // Named render targets can only be allocated at texture (re)creation, so smaller optics RTTs take
+    // effect from the next map load / lazy creation.
+    m_OpticsRTTPressureShift = current == VasPressure::Critical ? 2 : (current == VasPressure::High ? 1 : 0);
+
+    if (VasMappedTrim::TrimOnTransition(previous, current))
+        TrimDXVKMappedMemory(current);
+}
+
+void VR::TrimDXVKMappedMemory(VasPressure pressure)
+{
+    if (!m_D3DVR9Trim || pressure == VasPressure::Normal)
+        return;
+
+    UINT mapped = 0;
+    m_D3DVR9Trim->TrimMappedMemory(VasMappedTrim::TargetBytes(pressure), &mapped);
+    m_VASMappedTrim.Trimmed(mapped, SteadySeconds(std::chrono::steady_clock::now()));
+    if (m_DebugVASLog)
+        Game::logMsg("[VR][VAS] DXVK mapped texture memory trimmed to %.1f MiB", BytesToMiB(mapped));
+}
+
 void VR::CreateVRTextures()
 {
     // CreateNamedRenderTargetTextureEx re-enters DXVK and populates m_VK* via m_CreatingTextureID.
@@ -763,10 +869,11 @@ void VR::CreateVRTextures()
     {
         // Square RTT for gun-mounted scope lens
         m_CreatingTextureID = Texture_Scope;
+        m_ScopeRTTActiveSize = GetOpticsRTTCreateSize(m_ScopeRTTSize);
         m_ScopeTexture = m_Game->m_MaterialSystem->CreateNamedRenderTargetTextureEx(
             "vrScope",
-            static_cast<int>(m_ScopeRTTSize),
-            static_cast<int>(m_ScopeRTTSize),
+            m_ScopeRTTActiveSize,
+            m_ScopeRTTActiveSize,
             RT_SIZE_NO_CHANGE,
             m_Game->m_MaterialSystem->GetBackBufferFormat(),
             MATERIAL_RT_DEPTH_SEPARATE,
@@ -777,10 +884,11 @@ void VR::CreateVRTextures()
     {
         // Square RTT for off-hand rear mirror
         m_CreatingTextureID = Texture_RearMirror;
+        m_RearMirrorRTTActiveSize = GetOpticsRTTCreateSize(m_RearMirrorRTTSize);
         m_RearMirrorTexture = m_Game->m_MaterialSystem->CreateNamedRenderTargetTextureEx(
             "vrRearMirror",
-            static_cast<int>(m_RearMirrorRTTSize),
-            static_cast<int>(m_RearMirrorRTTSize),
+            m_RearMirrorRTTActiveSize,
+            m_RearMirrorRTTActiveSize,
             RT_SIZE_NO_CHANGE,
             m_Game->m_MaterialSystem->GetBackBufferFormat(),
             MATERIAL_RT_DEPTH_SEPARATE,
@@ -803,8 +911,17 @@ void VR::CreateVRTextures()
     m_LastSubmittedCompositorFrameIndex.store(0, std::memory_order_release);
     m_QueuedSubmitStaleStreak.store(0, std::memory_order_release);
 
+    PublishTextureSet();
     m_CreatedVRTextures.store(true, std::memory_order_release);
 
+    // Estimates for the VAS budget: color + separate depth for eye / optics targets.
+    const uint64_t eyeBytes = static_cast<uint64_t>(m_RenderWidth) * m_RenderHeight * 8u;
+    m_VASBudget.SetTracked(VasCategory::EyeTargets, eyeBytes * (useDedicatedEyeSubmitTextures ? 4u : 2u));
+    m_VASBudget.SetTracked(VasCategory::HudTargets, static_cast<uint64_t>(windowWidth) * windowHeight * 4u + 512u * 512u * 4u);
+    m_VASBudget.SetTracked(VasCategory::OpticsTargets,
+        (m_ScopeTexture ? static_cast<uint64_t>(m_ScopeRTTActiveSize) * m_ScopeRTTActiveSize * 8u : 0u) +
+        (m_RearMirrorTexture ? static_cast<uint64_t>(m_RearMirrorRTTActiveSize) * m_RearMirrorRTTActiveSize * 8u : 0u));
+
     LogVAS("after CreateVRTextures");
 }
 
@@ -828,10 +945,11 @@ void VR::EnsureOpticsRTTTextures()
     if (needScope)
     {
         m_CreatingTextureID = Texture_Scope;
+        m_ScopeRTTActiveSize = GetOpticsRTTCreateSize(m_ScopeRTTSize);
         m_ScopeTexture = m_Game->m_MaterialSystem->CreateNamedRenderTargetTextureEx(
             "vrScope",
-            static_cast<int>(m_ScopeRTTSize),
-            static_cast<int>(m_ScopeRTTSize),
+            m_ScopeRTTActiveSize,
+            m_ScopeRTTActiveSize,
             RT_SIZE_NO_CHANGE,
             m_Game->m_MaterialSystem->GetBackBufferFormat(),
             MATERIAL_RT_DEPTH_SEPARATE,
@@ -841,10 +959,11 @@ void VR::EnsureOpticsRTTTextures()
     if (needRearMirror)
     {
         m_CreatingTextureID = Texture_RearMirror;
+        m_RearMirrorRTTActiveSize = GetOpticsRTTCreateSize(m_RearMirrorRTTSize);
         m_RearMirrorTexture = m_Game->m_MaterialSystem->CreateNamedRenderTargetTextureEx(
             "vrRearMirror",
-            static_cast<int>(m_RearMirrorRTTSize),
-            static_cast<int>(m_RearMirrorRTTSize),
+            m_RearMirrorRTTActiveSize,
+            m_RearMirrorRTTActiveSize,
             RT_SIZE_NO_CHANGE,
             m_Game->m_MaterialSystem->GetBackBufferFormat(),
             MATERIAL_RT_DEPTH_SEPARATE,
@@ -854,14 +973,59 @@ void VR::EnsureOpticsRTTTextures()
     m_CreatingTextureID = Texture_None;
     m_Game->m_MaterialSystem->EndRenderTargetAllocation();
 
+    PublishTextureSet();
+
+    m_VASBudget.SetTracked(VasCategory::OpticsTargets,
+        (m_ScopeTexture ? static_cast<uint64_t>(m_ScopeRTTActiveSize) * m_ScopeRTTActiveSize * 8u : 0u) +
+        (m_RearMirrorTexture ? static_cast<uint64_t>(m_RearMirrorRTTActiveSize) * m_RearMirrorRTTActiveSize * 8u : 0u));
+
     LogVAS("after EnsureOpticsRTTTextures");
 }
 
+void VR::PublishTextureSet()
+{
+    auto next = std::make_unique<SharedTextureSet>();
+    next->leftEye.CopyFrom(m_VKLeftEye);
+    next->rightEye.CopyFrom(m_VKRightEye);
+    next->backBuffer.CopyFrom(m_VKBackBuffer);
+    next->hud.CopyFrom(m_VKHUD);
+    next->scope.CopyFrom(m_VKScope);
+    next->rearMirror.CopyFrom(m_VKRearMirror);
+    next->blank.CopyFrom(m_VKBlankTexture);
+    next->generation = m_TextureSets.GetGeneration() + 1;
+
+    m_TextureSets.Publish(std::move(next));
+    if (m_RenderPipelineDebugLog)
+    {
+        Game::logMsg("[VR][RenderPipe][TextureSet] published gen=%llu retiredPending=%u reclaimed=%llu",
+            (unsigned long long)m_TextureSets.GetGeneration(),
+            (unsigned)m_TextureSets.GetRetiredCount(),
+            (unsigned long long)m_TextureSets.GetReclaimedTotal());
+    }
+}
+
 void VR::SubmitVRTextures()
 {
     if (!m_Compositor)
         return;
 
+    // Lock-free view of the current texture generation. Creation publishes a new set instead of
+    // rewriting descriptors in place, so this stays consistent for the whole submit.
+    static const SharedTextureSet s_EmptyTextureSet{};
+    GenerationPublisher<SharedTextureSet>::ReadGuard textureSetGuard(m_TextureSets);
+    const SharedTextureSet* texSet = textureSetGuard.Get() ? textureSetGuard.Get() : &s_EmptyTextureSet;
+    auto refreshTextureSet = [&]()
+        {
+            texSet = textureSetGuard.Refresh() ? textureSetGuard.Get() : &s_EmptyTextureSet;
+        };
+
+    // Overlay state below is only recorded; this issues the differences once, on every exit path.
+    struct OverlayFlushGuard
+    {
+        VR* vr = nullptr;
+        ~OverlayFlushGuard() { vr->FlushOverlayState(); }
+    } overlayFlushGuard{ this };
+
     const bool inGame = (m_Game && m_Game->m_EngineClient && m_Game->m_EngineClient->IsInGame());
     const bool renderedNewFrame = m_RenderedNewFrame.load(std::memory_order_acquire);
 
@@ -871,18 +1035,19 @@ void VR::SubmitVRTextures()
     // trips driver/runtime instability inside vrclient/vulkan.
     if (!renderedNewFrame && !inGame && m_MenuBlankSubmitted)
     {
-        if (!vr::VROverlay()->IsOverlayVisible(m_MainMenuHandle))
+        if (!m_OverlayCache.IsVisible(m_MainMenuHandle))
             RepositionOverlays();
 
-        vr::VROverlay()->SetOverlayTexture(m_MainMenuHandle, &m_VKBackBuffer.m_VRTexture);
-        vr::VROverlay()->ShowOverlay(m_MainMenuHandle);
-        vr::VROverlay()->HideOverlay(m_HUDTopHandle);
+        // The menu backbuffer changes every frame; key on the submit counter so it is always re-uploaded.
+        m_OverlayCache.SetTexture(m_MainMenuHandle, texSet->backBuffer.m_VRTexture, ++m_OverlayMenuTextureKey);
+        m_OverlayCache.Show(m_MainMenuHandle);
+        m_OverlayCache.Hide(m_HUDTopHandle);
         for (vr::VROverlayHandle_t& overlay : m_HUDBottomHandles)
-            vr::VROverlay()->HideOverlay(overlay);
-        vr::VROverlay()->HideOverlay(m_ScopeHandle);
-        vr::VROverlay()->HideOverlay(m_RearMirrorHandle);
-        vr::VROverlay()->HideOverlay(m_LeftWristHudHandle);
-        vr::VROverlay()->HideOverlay(m_RightAmmoHudHandle);
+            m_OverlayCache.Hide(overlay);
+        m_OverlayCache.Hide(m_ScopeHandle);
+        m_OverlayCache.Hide(m_RearMirrorHandle);
+        m_OverlayCache.Hide(m_LeftWristHudHandle);
+        m_OverlayCache.Hide(m_RightAmmoHudHandle);
         m_CompositorNeedsHandoff = false;
         return;
     }
@@ -897,7 +1062,7 @@ void VR::SubmitVRTextures()
         const uint32_t lastSubmittedFrameId = m_LastSubmittedFrameId.load(std::memory_order_acquire);
         const uint32_t currentPoseToken = m_SubmitPoseToken.load(std::memory_order_acquire);
         const uint32_t lastSubmittedPoseToken = m_LastSubmittedPoseToken.load(std::memory_order_acquire);
-        Game::logMsg("[VR][RenderPipe][Submit] tid=%lu q=%d inGame=%d renderedNew=%d completed=%u submitted=%u pose=%u lastPose=%u submitInFlight=%d renderedHud=%d hudPainted=%d menuBlank=%d",
+        Game::logMsg("[VR][RenderPipe][Submit] tid=%lu q=%d inGame=%d renderedNew=%d completed=%u submitted=%u pose=%u lastPose=%u submitInFlight=%d renderedHud=%d hudPainted=%d menuBlank=%d texGen=%llu",
             GetCurrentThreadId(), queued ? 1 : 0, inGame ? 1 : 0,
             renderedNewFrame ? 1 : 0,
             renderCompletedFrameId, lastSubmittedFrameId,
@@ -905,7 +1070,8 @@ void VR::SubmitVRTextures()
             m_SubmitInFlight.load(std::memory_order_acquire) ? 1 : 0,
             m_RenderedHud.load(std::memory_order_acquire) ? 1 : 0,
             m_HudPaintedThisFrame.load(std::memory_order_acquire) ? 1 : 0,
-            m_MenuBlankSubmitted ? 1 : 0);
+            m_MenuBlankSubmitted ? 1 : 0,
+            (unsigned long long)texSet->generation);
     }
 
     struct SubmitInFlightGuard
@@ -975,7 +1141,6 @@ void VR::SubmitVRTextures()
             if (!m_CompositorExplicitTiming || timingDataSubmitted)
                 return;
 
-            std::lock_guard<TextureStateMutex> textureLock(m_TextureMutex);
             vr::EVRCompositorError timingError = m_Compositor->SubmitExplicitTimingData();
             if (timingError != vr::VRCompositorError_None)
             {
@@ -989,7 +1154,6 @@ void VR::SubmitVRTextures()
         {
             ensureTimingData();
 
-            std::lock_guard<TextureStateMutex> textureLock(m_TextureMutex);
             vr::EVRCompositorError submitError = m_Compositor->Submit(eye, texture, bounds, vr::Submit_Default);
             if (submitError != vr::VRCompositorError_None)
             {
@@ -1018,6 +1182,7 @@ void VR::SubmitVRTextures()
                     return false;
 
                 successfulSubmit = true;
+                m_TextureSets.NoteConsumerFrame();
                 finalizeSubmitState(true);
                 return true;
             }
@@ -1025,39 +1190,44 @@ void VR::SubmitVRTextures()
             const bool leftOk = submitEye(vr::Eye_Left, leftTexture, leftBounds);
             const bool rightOk = submitEye(vr::Eye_Right, rightTexture, rightBounds);
             successfulSubmit = leftOk || rightOk;
+            if (successfulSubmit)
+                m_TextureSets.NoteConsumerFrame();
             return successfulSubmit;
         };
 
     auto hideHudOverlays = [&]()
         {
-            vr::VROverlay()->HideOverlay(m_HUDTopHandle);
+            m_OverlayCache.Hide(m_HUDTopHandle);
             for (vr::VROverlayHandle_t& overlay : m_HUDBottomHandles)
-                vr::VROverlay()->HideOverlay(overlay);
+                m_OverlayCache.Hide(overlay);
+        };
+
+    // Content keys: texture generation in the high half, render counter in the low half.
+    auto textureKey = [&](uint32_t contentVersion) -> uint64_t
+        {
+            return (texSet->generation << 32) | contentVersion;
         };
 
     const vr::VRTextureBounds_t topBounds{ 0.0f, 0.0f, 1.0f, 1.0f };
     auto applyHudTexture = [&](vr::VROverlayHandle_t overlay, const vr::VRTextureBounds_t& bounds)
         {
-            vr::VROverlay()->SetOverlayTextureBounds(overlay, &bounds);
-            std::lock_guard<TextureStateMutex> textureLock(m_TextureMutex);
-            vr::VROverlay()->SetOverlayTexture(overlay, &m_VKHUD.m_VRTexture);
+            m_OverlayCache.SetTextureBounds(overlay, bounds);
+            m_OverlayCache.SetTexture(overlay, texSet->hud.m_VRTexture, textureKey(m_RenderCompletedFrameId.load(std::memory_order_acquire)));
         };
 
     auto applyScopeTexture = [&](vr::VROverlayHandle_t overlay)
         {
             static const vr::VRTextureBounds_t full{ 0.0f, 0.0f, 1.0f, 1.0f };
-            vr::VROverlay()->SetOverlayTextureBounds(overlay, &full);
-            std::lock_guard<TextureStateMutex> textureLock(m_TextureMutex);
-            vr::VROverlay()->SetOverlayTexture(overlay, &m_VKScope.m_VRTexture);
+            m_OverlayCache.SetTextureBounds(overlay, full);
+            m_OverlayCache.SetTexture(overlay, texSet->scope.m_VRTexture, textureKey(m_ScopeRTTContentVersion.load(std::memory_order_acquire)));
         };
     auto applyRearMirrorTexture = [&](vr::VROverlayHandle_t overlay)
         {
             vr::VRTextureBounds_t bounds{ 0.0f, 0.0f, 1.0f, 1.0f };
             if (m_RearMirrorFlipHorizontal)
                 std::swap(bounds.uMin, bounds.uMax);
-            vr::VROverlay()->SetOverlayTextureBounds(overlay, &bounds);
-            std::lock_guard<TextureStateMutex> textureLock(m_TextureMutex);
-            vr::VROverlay()->SetOverlayTexture(overlay, &m_VKRearMirror.m_VRTexture);
+            m_OverlayCache.SetTextureBounds(overlay, bounds);
+            m_OverlayCache.SetTexture(overlay, texSet->rearMirror.m_VRTexture, textureKey(m_RearMirrorRTTContentVersion.load(std::memory_order_acquire)));
         };
 
     //     ֡û       ݣ    ߲˵ /Overlay ·
@@ -1070,22 +1240,24 @@ void VR::SubmitVRTextures()
         if (inGame)
         {
             // Ensure the menu overlay is not left visible while in-game.
-            if (vr::VROverlay()->IsOverlayVisible(m_MainMenuHandle))
-                vr::VROverlay()->HideOverlay(m_MainMenuHandle);
+            m_OverlayCache.Hide(m_MainMenuHandle);
 
             // Submit the most recent stereo textures again (safe even if they didn't change this tick).
             const bool texturesReady = m_CreatedVRTextures.load(std::memory_order_acquire);
             if (texturesReady)
             {
-                submitStereoPair(&m_VKLeftEye.m_VRTexture, &(m_TextureBounds)[0],
-                    &m_VKRightEye.m_VRTexture, &(m_TextureBounds)[1]);
+                submitStereoPair(&texSet->leftEye.m_VRTexture, &(m_TextureBounds)[0],
+                    &texSet->rightEye.m_VRTexture, &(m_TextureBounds)[1]);
             }
             else
             {
                 if (!m_BlankTexture)
+                {
                     CreateVRTextures();
-                submitStereoPair(&m_VKBlankTexture.m_VRTexture, nullptr,
-                    &m_VKBlankTexture.m_VRTexture, nullptr);
+                    refreshTextureSet();
+                }
+                submitStereoPair(&texSet->blank.m_VRTexture, nullptr,
+                    &texSet->blank.m_VRTexture, nullptr);
             }
 
             if (successfulSubmit && m_CompositorExplicitTiming)
@@ -1098,23 +1270,26 @@ void VR::SubmitVRTextures()
         }
 
         if (!m_BlankTexture)
+        {
             CreateVRTextures();
+            refreshTextureSet();
+        }
 
-        if (!vr::VROverlay()->IsOverlayVisible(m_MainMenuHandle))
+        if (!m_OverlayCache.IsVisible(m_MainMenuHandle))
             RepositionOverlays();
 
-        vr::VROverlay()->SetOverlayTexture(m_MainMenuHandle, &m_VKBackBuffer.m_VRTexture);
-        vr::VROverlay()->ShowOverlay(m_MainMenuHandle);
+        m_OverlayCache.SetTexture(m_MainMenuHandle, texSet->backBuffer.m_VRTexture, ++m_OverlayMenuTextureKey);
+        m_OverlayCache.Show(m_MainMenuHandle);
         hideHudOverlays();
-        vr::VROverlay()->HideOverlay(m_ScopeHandle);
-        vr::VROverlay()->HideOverlay(m_RearMirrorHandle);
-        vr::VROverlay()->HideOverlay(m_LeftWristHudHandle);
-        vr::VROverlay()->HideOverlay(m_RightAmmoHudHandle);
+        m_OverlayCache.Hide(m_ScopeHandle);
+        m_OverlayCache.Hide(m_RearMirrorHandle);
+        m_OverlayCache.Hide(m_LeftWristHudHandle);
+        m_OverlayCache.Hide(m_RightAmmoHudHandle);
 
         if (!inGame)
         {
-            submitStereoPair(&m_VKBlankTexture.m_VRTexture, nullptr,
-                &m_VKBlankTexture.m_VRTexture, nullptr);
+            submitStereoPair(&texSet->blank.m_VRTexture, nullptr,
+                &texSet->blank.m_VRTexture, nullptr);
             if (successfulSubmit)
                 m_MenuBlankSubmitted = true;
         }
@@ -1129,23 +1304,19 @@ void VR::SubmitVRTextures()
     }
 
 
-    vr::VROverlay()->HideOverlay(m_MainMenuHandle);
+    m_OverlayCache.Hide(m_MainMenuHandle);
     applyHudTexture(m_HUDTopHandle, topBounds);
     for (vr::VROverlayHandle_t& overlay : m_HUDBottomHandles)
-        vr::VROverlay()->HideOverlay(overlay);
+        m_OverlayCache.Hide(overlay);
     if (m_Game->m_VguiSurface->IsCursorVisible())
-    {
-        vr::VROverlay()->ShowOverlay(m_HUDTopHandle);
-        for (vr::VROverlayHandle_t& overlay : m_HUDBottomHandles)
-            vr::VROverlay()->HideOverlay(overlay);
-    }
+        m_OverlayCache.Show(m_HUDTopHandle);
 
     // Scope overlay independent of HUD cursor mode
     if (m_ScopeTexture && m_ScopeEnabled)
     {
         applyScopeTexture(m_ScopeHandle);
         const float alpha = IsScopeActive() ? 1.0f : std::clamp(m_ScopeOverlayIdleAlpha, 0.0f, 1.0f);
-        vr::VROverlay()->SetOverlayAlpha(m_ScopeHandle, alpha);
+        m_OverlayCache.SetAlpha(m_ScopeHandle, alpha);
 
         vr::TrackedDeviceIndex_t leftControllerIndex = m_System->GetTrackedDeviceIndexForControllerRole(vr::TrackedControllerRole_LeftHand);
         vr::TrackedDeviceIndex_t rightControllerIndex = m_System->GetTrackedDeviceIndexForControllerRole(vr::TrackedControllerRole_RightHand);
@@ -1162,20 +1333,17 @@ void VR::SubmitVRTextures()
 
         const bool canShowScope = ShouldRenderScope()
             && (m_MouseModeEnabled || useThirdPersonBodyAnchor || gunControllerIndex != vr::k_unTrackedDeviceIndexInvalid);
-        if (canShowScope)
-            vr::VROverlay()->ShowOverlay(m_ScopeHandle);
-        else
-            vr::VROverlay()->HideOverlay(m_ScopeHandle);
+        m_OverlayCache.SetVisible(m_ScopeHandle, canShowScope);
     }
     else
     {
-        vr::VROverlay()->HideOverlay(m_ScopeHandle);
+        m_OverlayCache.Hide(m_ScopeHandle);
     }
 
     if (m_RearMirrorTexture && m_RearMirrorEnabled)
     {
         applyRearMirrorTexture(m_RearMirrorHandle);
-        vr::VROverlay()->SetOverlayAlpha(m_RearMirrorHandle, std::clamp(m_RearMirrorAlpha, 0.0f, 1.0f));
+        m_OverlayCache.SetAlpha(m_RearMirrorHandle, std::clamp(m_RearMirrorAlpha, 0.0f, 1.0f));
 
         // Body-anchored rear mirror: update absolute transform every frame.
         UpdateRearMirrorOverlayTransform();
@@ -1252,56 +1420,16 @@ void VR::SubmitVRTextures()
                     + (right * (m_RearMirrorOverlayYOffset * m_VRScale))
                     + (up * (m_RearMirrorOverlayZOffset * m_VRScale));
 
-                const float deg2rad = 3.14159265358979323846f / 180.0f;
-                const float pitch = m_RearMirrorOverlayAngleOffset.x * deg2rad;
-                const float yaw = m_RearMirrorOverlayAngleOffset.y * deg2rad;
-                const float roll = m_RearMirrorOverlayAngleOffset.z * deg2rad;
-
-                const float cp = cosf(pitch), sp = sinf(pitch);
-                const float cy = cosf(yaw), sy = sinf(yaw);
-                const float cr = cosf(roll), sr = sinf(roll);
-
-                const float Rx[3][3] = {
-                    {1.0f, 0.0f, 0.0f},
-                    {0.0f, cp,   -sp},
-                    {0.0f, sp,   cp}
-                };
-                const float Ry[3][3] = {
-                    {cy,   0.0f, sy},
-                    {0.0f, 1.0f, 0.0f},
-                    {-sy,  0.0f, cy}
-                };
-                const float Rz[3][3] = {
-                    {cr,   -sr,  0.0f},
-                    {sr,   cr,   0.0f},
-                    {0.0f, 0.0f, 1.0f}
-                };
-
-                auto mul33 = [](const float a[3][3], const float b[3][3], float out[3][3])
-                    {
-                        for (int r = 0; r < 3; ++r)
-                            for (int c = 0; c < 3; ++c)
-                                out[r][c] = a[r][0] * b[0][c] + a[r][1] * b[1][c] + a[r][2] * b[2][c];
-                    };
-
-                float RyRx[3][3];
-                float Roff[3][3];
-                mul33(Ry, Rx, RyRx);
-                mul33(Rz, RyRx, Roff);
-
-                // Parent yaw-only basis (columns: right, up, back)
-                const float B[3][3] = {
-                    { right.x, up.x, back.x },
-                    { right.y, up.y, back.y },
-                    { right.z, up.z, back.z }
-                };
-
-                float Rworld[3][3];
-                mul33(B, Roff, Rworld);
-
-                Vector axisX = { Rworld[0][0], Rworld[1][0], Rworld[2][0] };
-                Vector axisY = { Rworld[0][1], Rworld[1][1], Rworld[2][1] };
-                Vector axisZ = { Rworld[0][2], Rworld[1][2], Rworld[2][2] };
+                // Parent yaw-only basis (columns: right, up, back) times the configured angle offset.
+                const Mat34 world = Mat34Math::Compose(
+                    Mat34::FromBasis(ToVec3(right), ToVec3(up), ToVec3(back), Vec3()),
+                    Mat34::RotationZYXDeg(m_RearMirrorOverlayAngleOffset.x, m_RearMirrorOverlayAngleOffset.y, m_RearMirrorOverlayAngleOffset.z));
+                const Vec3 colX = world.Column(0);
+                const Vec3 colY = world.Column(1);
+                const Vec3 colZ = world.Column(2);
+                Vector axisX = { colX.x, colX.y, colX.z };
+                Vector axisY = { colY.x, colY.y, colY.z };
+                Vector axisZ = { colZ.x, colZ.y, colZ.z };
                 if (axisX.IsZero() || axisY.IsZero() || axisZ.IsZero())
                     return false;
                 VectorNormalize(axisX);
@@ -1341,20 +1469,21 @@ void VR::SubmitVRTextures()
                 return false;
             };
 
-        if (ShouldRenderRearMirror() && !shouldHideRearMirrorDueToAimLine())
-            vr::VROverlay()->ShowOverlay(m_RearMirrorHandle);
-        else
-            vr::VROverlay()->HideOverlay(m_RearMirrorHandle);
+        m_OverlayCache.SetVisible(m_RearMirrorHandle, ShouldRenderRearMirror() && !shouldHideRearMirrorDueToAimLine());
     }
     else
     {
-        vr::VROverlay()->HideOverlay(m_RearMirrorHandle);
+        m_OverlayCache.Hide(m_RearMirrorHandle);
     }
 
+    // Hand HUDs are driven with direct (error-checked) IVROverlay calls in-game; forget cached state
+    // so the menu-path Hide() is re-issued next time.
+    m_OverlayCache.Invalidate(m_LeftWristHudHandle);
+    m_OverlayCache.Invalidate(m_RightAmmoHudHandle);
     UpdateHandHudOverlays();
 
-    submitStereoPair(&m_VKLeftEye.m_VRTexture, &(m_TextureBounds)[0],
-        &m_VKRightEye.m_VRTexture, &(m_TextureBounds)[1]);
+    submitStereoPair(&texSet->leftEye.m_VRTexture, &(m_TextureBounds)[0],
+        &texSet->rightEye.m_VRTexture, &(m_TextureBounds)[1]);
 
     if (successfulSubmit && m_CompositorExplicitTiming)
     {
@@ -1412,107 +1541,34 @@ void VR::GetPoseData(vr::TrackedDevicePose_t& poseRaw, TrackedDevicePoseData& po
 
 void VR::UpdateRearMirrorOverlayTransform()
 {
+    m_RearMirrorOverlayTransformValid = false;
     if (!m_RearMirrorEnabled || m_RearMirrorHandle == vr::k_ulOverlayHandleInvalid)
         return;
 
     // We place the rear mirror in tracking space (meters), anchored to the same "body origin"
     // used by the inventory system: InventoryBodyOriginOffset is (forward,right,up) in body space.
-    const vr::TrackedDevicePose_t hmdPose = m_Poses[vr::k_unTrackedDeviceIndex_Hmd];
-    if (!hmdPose.bPoseIsValid)
+    if (!m_OverlayFrame.hmdValid)
         return;
 
-    const vr::HmdMatrix34_t hmdMat = hmdPose.mDeviceToAbsoluteTracking;
-    const Vector hmdPos = { hmdMat.m[0][3], hmdMat.m[1][3], hmdMat.m[2][3] };
-
-    const Vector up = { 0.0f, 1.0f, 0.0f }; // OpenVR tracking space: +Y is up
-
-    // Yaw-only forward (flattened to the floor plane).
-    Vector fwd = { -hmdMat.m[0][2], 0.0f, -hmdMat.m[2][2] };
-    if (VectorNormalize(fwd) == 0.0f)
-        fwd = { 0.0f, 0.0f, -1.0f };
-
-    Vector right = CrossProduct(fwd, up);
-    if (VectorNormalize(right) == 0.0f)
-        right = { 1.0f, 0.0f, 0.0f };
-
-    // "Back" axis for a right-handed basis (OpenVR commonly treats +Z as "back").
-    const Vector back = { -fwd.x, -fwd.y, -fwd.z };
-
-    // Body origin in tracking space (meters)
-    const Vector bodyOrigin =
-        hmdPos
-        + (fwd * m_InventoryBodyOriginOffset.x)
-        + (right * m_InventoryBodyOriginOffset.y)
-        + (up * m_InventoryBodyOriginOffset.z);
-
     // Rear mirror overlay position relative to that body origin (meters)
-    const Vector mirrorPos =
-        bodyOrigin
-        + (fwd * m_RearMirrorOverlayXOffset)
-        + (right * m_RearMirrorOverlayYOffset)
-        + (up * m_RearMirrorOverlayZOffset);
-
-    // Build a yaw-only parent rotation from (right, up, back) and then apply the user angle offset.
-    const float deg2rad = 3.14159265358979323846f / 180.0f;
-
-    const float pitch = m_RearMirrorOverlayAngleOffset.x * deg2rad;
-    const float yaw = m_RearMirrorOverlayAngleOffset.y * deg2rad;
-    const float roll = m_RearMirrorOverlayAngleOffset.z * deg2rad;
-
-    const float cp = cosf(pitch), sp = sinf(pitch);
-    const float cy = cosf(yaw), sy = sinf(yaw);
-    const float cr = cosf(roll), sr = sinf(roll);
-
-    const float Rx[3][3] = {
-        {1.0f, 0.0f, 0.0f},
-        {0.0f, cp,   -sp},
-        {0.0f, sp,   cp}
-    };
-    const float Ry[3][3] = {
-        {cy,   0.0f, sy},
-        {0.0f, 1.0f, 0.0f},
-        {-sy,  0.0f, cy}
-    };
-    const float Rz[3][3] = {
-        {cr,   -sr,  0.0f},
-        {sr,   cr,   0.0f},
-        {0.0f, 0.0f, 1.0f}
-    };
-
-    auto mul33 = [](const float a[3][3], const float b[3][3], float out[3][3])
-        {
-            for (int r = 0; r < 3; ++r)
-                for (int c = 0; c < 3; ++c)
-                    out[r][c] = a[r][0] * b[0][c] + a[r][1] * b[1][c] + a[r][2] * b[2][c];
-        };
-
-    float RyRx[3][3];
-    float Roff[3][3];
-    mul33(Ry, Rx, RyRx);
-    mul33(Rz, RyRx, Roff);
-
-    // Parent yaw-only basis (columns: right, up, back)
-    const float B[3][3] = {
-        { right.x, up.x, back.x },
-        { right.y, up.y, back.y },
-        { right.z, up.z, back.z }
-    };
-
-    float Rworld[3][3];
-    mul33(B, Roff, Rworld);
-
-    vr::HmdMatrix34_t mirrorAbs = {
-        Rworld[0][0], Rworld[0][1], Rworld[0][2], mirrorPos.x,
-        Rworld[1][0], Rworld[1][1], Rworld[1][2], mirrorPos.y,
-        Rworld[2][0], Rworld[2][1], Rworld[2][2], mirrorPos.z
-    };
+    const Vec3 mirrorPos = m_OverlayFrame.BodyPoint(
+        m_InventoryBodyOriginOffset.x + m_RearMirrorOverlayXOffset,
+        m_InventoryBodyOriginOffset.y + m_RearMirrorOverlayYOffset,
+        m_InventoryBodyOriginOffset.z + m_RearMirrorOverlayZOffset);
+
+    // Yaw-only parent rotation (right, up, back), then the user angle offset.
+    Mat34 mirrorAbs = Mat34Math::Compose(m_OverlayFrame.trackingFromBody,
+        Mat34::RotationZYXDeg(m_RearMirrorOverlayAngleOffset.x, m_RearMirrorOverlayAngleOffset.y, m_RearMirrorOverlayAngleOffset.z));
+    mirrorAbs.SetOrigin(mirrorPos);
+    m_RearMirrorOverlayTransform = mirrorAbs;
+    m_RearMirrorOverlayTransformValid = true;
 
     const vr::ETrackingUniverseOrigin trackingOrigin = vr::VRCompositor()->GetTrackingSpace();
-    vr::VROverlay()->SetOverlayTransformAbsolute(m_RearMirrorHandle, trackingOrigin, &mirrorAbs);
+    m_OverlayCache.SetTransformAbsolute(m_RearMirrorHandle, trackingOrigin, mirrorAbs.To<vr::HmdMatrix34_t>());
     float mirrorWidth = (std::max)(0.01f, m_RearMirrorOverlayWidthMeters);
     if (m_RearMirrorSpecialWarningDistance > 0.0f && m_RearMirrorSpecialEnlargeActive)
         mirrorWidth *= 2.0f;
-    vr::VROverlay()->SetOverlayWidthInMeters(m_RearMirrorHandle, mirrorWidth);
+    m_OverlayCache.SetWidthInMeters(m_RearMirrorHandle, mirrorWidth);
 }
 
 void VR::UpdateScopeOverlayTransform()
@@ -1536,121 +1592,48 @@ void VR::UpdateScopeOverlayTransform()
     // - Most of our in-game positions (m_HmdPosAbs, viewmodel anchors, etc.) are in Source units.
     // If we feed Source units into SetOverlayTransformAbsolute, the overlay ends up kilometers away.
     // So for mouse mode we build the transform directly from the OpenVR HMD tracking pose.
-
-    const vr::TrackedDevicePose_t hmdPose = m_Poses[vr::k_unTrackedDeviceIndex_Hmd];
-    if (!hmdPose.bPoseIsValid)
+    if (!m_OverlayFrame.hmdValid)
         return;
 
-    const vr::HmdMatrix34_t hmdMat = hmdPose.mDeviceToAbsoluteTracking;
-    const Vector hmdPos = { hmdMat.m[0][3], hmdMat.m[1][3], hmdMat.m[2][3] }; // meters
-
-    // Tracking-space basis (meters): columns of the 3x4 matrix
-    // right = +X, up = +Y, back = +Z (OpenVR commonly treats -Z as forward)
-    Vector parentRight = { hmdMat.m[0][0], hmdMat.m[1][0], hmdMat.m[2][0] };
-    Vector parentUp = { hmdMat.m[0][1], hmdMat.m[1][1], hmdMat.m[2][1] };
-    Vector parentBack = { hmdMat.m[0][2], hmdMat.m[1][2], hmdMat.m[2][2] };
-    if (VectorNormalize(parentRight) == 0.0f || VectorNormalize(parentUp) == 0.0f || VectorNormalize(parentBack) == 0.0f)
-        return;
-
-    Vector overlayPos = hmdPos;
+    // Parent frame: the HMD (mouse mode, third-person front view) or the yaw-only body frame.
+    Mat34 parent = m_OverlayFrame.trackingFromHmd;
+    Vec3 overlayPos;
     if (useThirdPersonBodyAnchor)
     {
         if (useThirdPersonEyeAnchor)
         {
             // Third-person front-view mode: bind scope overlay to eye/HMD.
-            Vector fwd = { -parentBack.x, -parentBack.y, -parentBack.z };
-            if (VectorNormalize(fwd) == 0.0f)
-                fwd = { 0.0f, 0.0f, -1.0f };
-
-            overlayPos = hmdPos
-                + (fwd * m_ThirdPersonScopeOverlayOffset.x)
-                + (parentRight * m_ThirdPersonScopeOverlayOffset.y)
-                + (parentUp * m_ThirdPersonScopeOverlayOffset.z);
+            overlayPos = m_OverlayFrame.HmdPoint(m_ThirdPersonScopeOverlayOffset.x, m_ThirdPersonScopeOverlayOffset.y, m_ThirdPersonScopeOverlayOffset.z);
         }
         else
         {
             // Third-person: anchor scope overlay near the player body, not the gun hand.
-            const Vector up = { 0.0f, 1.0f, 0.0f }; // OpenVR tracking space: +Y is up
-            Vector fwd = { -hmdMat.m[0][2], 0.0f, -hmdMat.m[2][2] }; // yaw-only forward
-            if (VectorNormalize(fwd) == 0.0f)
-                fwd = { 0.0f, 0.0f, -1.0f };
-            Vector right = CrossProduct(fwd, up);
-            if (VectorNormalize(right) == 0.0f)
-                right = { 1.0f, 0.0f, 0.0f };
-            const Vector back = { -fwd.x, -fwd.y, -fwd.z };
-
-            parentRight = right;
-            parentUp = up;
-            parentBack = back;
-
-            const Vector bodyOrigin =
-                hmdPos
-                + (fwd * m_InventoryBodyOriginOffset.x)
-                + (right * m_InventoryBodyOriginOffset.y)
-                + (up * m_InventoryBodyOriginOffset.z);
-
-            overlayPos = bodyOrigin
-                + (fwd * m_ThirdPersonScopeOverlayOffset.x)
-                + (right * m_ThirdPersonScopeOverlayOffset.y)
-                + (up * m_ThirdPersonScopeOverlayOffset.z);
+            parent = m_OverlayFrame.trackingFromBody;
+            overlayPos = m_OverlayFrame.BodyPoint(
+                m_InventoryBodyOriginOffset.x + m_ThirdPersonScopeOverlayOffset.x,
+                m_InventoryBodyOriginOffset.y + m_ThirdPersonScopeOverlayOffset.y,
+                m_InventoryBodyOriginOffset.z + m_ThirdPersonScopeOverlayOffset.z);
         }
     }
     else
     {
-        // Mouse mode: HMD-anchored offset (meters). If not set, fall back to existing scope offsets.
-        if (!m_MouseModeScopeOverlayOffset.IsZero())
-        {
-            overlayPos += parentRight * m_MouseModeScopeOverlayOffset.x;
-            overlayPos += parentUp * m_MouseModeScopeOverlayOffset.y;
-            overlayPos += parentBack * m_MouseModeScopeOverlayOffset.z;
-        }
-        else
-        {
-            overlayPos += parentRight * m_ScopeOverlayXOffset;
-            overlayPos += parentUp * m_ScopeOverlayYOffset;
-            overlayPos += parentBack * m_ScopeOverlayZOffset;
-        }
+        // Mouse mode: HMD-anchored offset (meters) along (right, up, back). If not set, fall back to existing scope offsets.
+        const Vec3 offset = !m_MouseModeScopeOverlayOffset.IsZero()
+            ? ToVec3(m_MouseModeScopeOverlayOffset)
+            : Vec3(m_ScopeOverlayXOffset, m_ScopeOverlayYOffset, m_ScopeOverlayZOffset);
+        overlayPos = Mat34Math::TransformPoint(m_OverlayFrame.trackingFromHmd, offset);
     }
 
     const QAngle a = ((m_MouseModeEnabled && m_MouseModeScopeOverlayAngleOffsetSet)
         ? m_MouseModeScopeOverlayAngleOffset
         : m_ScopeOverlayAngleOffset);
-    const float cx = std::cos(DEG2RAD(a.x)), sx = std::sin(DEG2RAD(a.x));
-    const float cy = std::cos(DEG2RAD(a.y)), sy = std::sin(DEG2RAD(a.y));
-    const float cz = std::cos(DEG2RAD(a.z)), sz = std::sin(DEG2RAD(a.z));
-
-    const float Roff00 = cy * cz;
-    const float Roff01 = -cy * sz;
-    const float Roff02 = sy;
-    const float Roff10 = sx * sy * cz + cx * sz;
-    const float Roff11 = -sx * sy * sz + cx * cz;
-    const float Roff12 = -sx * cy;
-    const float Roff20 = -cx * sy * cz + sx * sz;
-    const float Roff21 = cx * sy * sz + sx * cz;
-    const float Roff22 = cx * cy;
 
     // World basis = ParentBasis * OffsetRotation.
-    const float B00 = parentRight.x, B01 = parentUp.x, B02 = parentBack.x;
-    const float B10 = parentRight.y, B11 = parentUp.y, B12 = parentBack.y;
-    const float B20 = parentRight.z, B21 = parentUp.z, B22 = parentBack.z;
-
-    const float R00 = B00 * Roff00 + B01 * Roff10 + B02 * Roff20;
-    const float R01 = B00 * Roff01 + B01 * Roff11 + B02 * Roff21;
-    const float R02 = B00 * Roff02 + B01 * Roff12 + B02 * Roff22;
-    const float R10 = B10 * Roff00 + B11 * Roff10 + B12 * Roff20;
-    const float R11 = B10 * Roff01 + B11 * Roff11 + B12 * Roff21;
-    const float R12 = B10 * Roff02 + B11 * Roff12 + B12 * Roff22;
-    const float R20 = B20 * Roff00 + B21 * Roff10 + B22 * Roff20;
-    const float R21 = B20 * Roff01 + B21 * Roff11 + B22 * Roff21;
-    const float R22 = B20 * Roff02 + B21 * Roff12 + B22 * Roff22;
-
-    vr::HmdMatrix34_t scopeAbs = {
-        R00, R01, R02, overlayPos.x,
-        R10, R11, R12, overlayPos.y,
-        R20, R21, R22, overlayPos.z
-    };
+    Mat34 scopeAbs = Mat34Math::Compose(parent, Mat34::RotationXYZDeg(a.x, a.y, a.z));
+    scopeAbs.SetOrigin(overlayPos);
+    const vr::HmdMatrix34_t scopeTransform = scopeAbs.To<vr::HmdMatrix34_t>();
     const vr::ETrackingUniverseOrigin trackingOrigin = vr::VRCompositor()->GetTrackingSpace();
-    vr::VROverlay()->SetOverlayTransformAbsolute(m_ScopeHandle, trackingOrigin, &scopeAbs);
+    vr::VROverlay()->SetOverlayTransformAbsolute(m_ScopeHandle, trackingOrigin, &scopeTransform);
     vr::VROverlay()->SetOverlayWidthInMeters(m_ScopeHandle, scopeWidth);
 }
 
@@ -1694,31 +1677,326 @@ void VR::NotifyRearMirrorSpecialWarning()
 
 bool VR::ShouldUpdateScopeRTT()
 {
+    if (m_OpticsRTTAdaptive)
+        return (m_OpticsRTTPlanMask & (1u << OpticsRTTScheduler::Pass_Scope)) != 0;
+
     // Throttle the expensive offscreen render pass; leaving the last rendered texture in place is fine.
     return !ShouldThrottle(m_LastScopeRTTRenderTime, m_ScopeRTTMaxHz);
 }
 bool VR::ShouldUpdateRearMirrorRTT()
 {
+    if (m_OpticsRTTAdaptive)
+        return (m_OpticsRTTPlanMask & (1u << OpticsRTTScheduler::Pass_RearMirror)) != 0;
+
     // The rear mirror is a full extra scene render. Throttling this can significantly reduce CPU spikes.
     return !ShouldThrottle(m_LastRearMirrorRTTRenderTime, m_RearMirrorRTTMaxHz);
 }
+
+void VR::PlanOpticsRTTFrame()
+{
+    UpdateOpticsRenderProfiles();
+
+    m_OpticsRTTPlanMask = 0;
+    if (!m_OpticsRTTAdaptive)
+        return;
+
+    // Config reloads happen on the config watcher thread; drop timing history here on the render thread.
+    if (m_OpticsRTTSettingsDirty.exchange(false, std::memory_order_acq_rel))
+        m_OpticsRTTScheduler.Reset();
+
+    OpticsRTTScheduler::Config& cfg = m_OpticsRTTScheduler.m_Config;
+    cfg.interleave = m_OpticsRTTInterleave;
+    OpticsRTTScheduler::PassConfig& scopeCfg = cfg.passes[OpticsRTTScheduler::Pass_Scope];
+    scopeCfg.maxHz = m_ScopeRTTMaxHz;
+    scopeCfg.minHz = m_ScopeRTTMinHz;
+    scopeCfg.fullRateAngleDeg = m_OpticsRTTFullRateAngleDeg;
+    scopeCfg.fullRateDistance = m_OpticsRTTFullRateDistance;
+    OpticsRTTScheduler::PassConfig& mirrorCfg = cfg.passes[OpticsRTTScheduler::Pass_RearMirror];
+    mirrorCfg.maxHz = m_RearMirrorRTTMaxHz;
+    mirrorCfg.minHz = m_RearMirrorRTTMinHz;
+    mirrorCfg.fullRateAngleDeg = m_OpticsRTTFullRateAngleDeg;
+    mirrorCfg.fullRateDistance = m_OpticsRTTFullRateDistance;
+
+    auto fillPose = [](OpticsRTTScheduler::PassRequest& req, const Vector& pos, const QAngle& ang)
+        {
+            req.pos[0] = pos.x; req.pos[1] = pos.y; req.pos[2] = pos.z;
+            req.ang[0] = ang.x; req.ang[1] = ang.y; req.ang[2] = ang.z;
+        };
+
+    const bool texturesReady = m_CreatedVRTextures.load(std::memory_order_acquire);
+    std::array<OpticsRTTScheduler::PassRequest, OpticsRTTScheduler::Pass_Count> requests{};
+
+    OpticsRTTScheduler::PassRequest& scopeReq = requests[OpticsRTTScheduler::Pass_Scope];
+    scopeReq.wanted = texturesReady && m_ScopeTexture && ShouldRenderScope();
+    // Looking through the scope: aim precision matters more than CPU, keep it at ScopeRTTMaxHz.
+    scopeReq.urgent = IsScopeActive();
+    fillPose(scopeReq, GetScopeCameraAbsPos(), GetScopeCameraAbsAngle());
+
+    OpticsRTTScheduler::PassRequest& mirrorReq = requests[OpticsRTTScheduler::Pass_RearMirror];
+    mirrorReq.wanted = texturesReady && m_RearMirrorTexture && ShouldRenderRearMirror();
+    // Special infected behind us: the mirror is the warning, don't let it lag.
+    mirrorReq.urgent = m_RearMirrorSawSpecialThisPass || m_RearMirrorSpecialEnlargeActive;
+    fillPose(mirrorReq, GetRearMirrorCameraAbsPos(), GetRearMirrorCameraAbsAngle());
+
+    float hmdHz = GetHmdDisplayFrequencyHz();
+    if (!(hmdHz > 1.0f))
+        hmdHz = 90.0f;
+
+    const double nowSec = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    m_OpticsRTTPlanMask = m_OpticsRTTScheduler.PlanFrame(nowSec, 1.0f / hmdHz, requests);
+
+    if (m_OpticsRTTDebugLog && !ShouldThrottle(m_OpticsRTTDebugLastLog, m_OpticsRTTDebugLogHz))
+    {
+        const OpticsRTTScheduler::PassCounters& sc = m_OpticsRTTScheduler.GetCounters(OpticsRTTScheduler::Pass_Scope);
+        const OpticsRTTScheduler::PassCounters& mc = m_OpticsRTTScheduler.GetCounters(OpticsRTTScheduler::Pass_RearMirror);
+        Game::logMsg("[VR][OpticsRTT] headroom=%.2f scale=%.2f | scope req=%llu rend=%llu rate=%llu static=%llu defer=%llu urgent=%llu cost(last/avg/max)=%.2f/%.2f/%.2fms"
+            " | mirror req=%llu rend=%llu rate=%llu static=%llu defer=%llu urgent=%llu cost(last/avg/max)=%.2f/%.2f/%.2fms",
+            m_OpticsRTTScheduler.GetHeadroom(), m_OpticsRTTScheduler.GetHeadroomRateScale(),
+            (unsigned long long)sc.requested, (unsigned long long)sc.rendered, (unsigned long long)sc.skippedRate,
+            (unsigned long long)sc.skippedStatic, (unsigned long long)sc.deferredInterleave, (unsigned long long)sc.urgent,
+            sc.lastCostMs, sc.avgCostMs, sc.maxCostMs,
+            (unsigned long long)mc.requested, (unsigned long long)mc.rendered, (unsigned long long)mc.skippedRate,
+            (unsigned long long)mc.skippedStatic, (unsigned long long)mc.deferredInterleave, (unsigned long long)mc.urgent,
+            mc.lastCostMs, mc.avgCostMs, mc.maxCostMs);
+    }
+}
+
+void VR::UpdateOpticsRenderProfiles()
+{
+    if (!m_OpticsConVarAccess.IsBound() && m_Game)
+    {
+        Game* game = m_Game;
+        m_OpticsConVarAccess.find = [game](const char* name) -> void*
+            {
+                return game->FindConVar(name);
+            };
+        m_OpticsConVarAccess.get = [game](void* convar, float& outValue) -> bool
+            {
+                return game->GetConVarFloatFromPointer(convar, outValue);
+            };
+        m_OpticsConVarAccess.set = [game](void* convar, float value) -> bool
+            {
+                return game->SetConVarFloatFromPointer(convar, value);
+            };
+        m_OpticsConVarAccess.ResetHandles();
+    }
+
+    // ParseConfigFile publishes from the config watcher thread; pick up the newest set, if any.
+    OpticsRenderProfileSet published;
+    if (m_OpticsRenderProfileMailbox.Consume(published, m_OpticsRenderProfileGeneration))
+        m_OpticsRenderProfiles.Apply(published);
+
+    const bool abTest = m_OpticsRenderProfiles.m_ABTest;
+    if (abTest && m_OpticsRTTDebugLog && !ShouldThrottle(m_OpticsRTTProfileLastLog, m_OpticsRTTDebugLogHz))
+    {
+        using Profiles = OpticsRenderProfiles;
+        const Profiles::VariantStats& sf = m_OpticsRenderProfiles.GetStats(OpticsRTTScheduler::Pass_Scope, Profiles::Variant_Full);
+        const Profiles::VariantStats& sr = m_OpticsRenderProfiles.GetStats(OpticsRTTScheduler::Pass_Scope, Profiles::Variant_Reduced);
+        const Profiles::VariantStats& mf = m_OpticsRenderProfiles.GetStats(OpticsRTTScheduler::Pass_RearMirror, Profiles::Variant_Full);
+        const Profiles::VariantStats& mr = m_OpticsRenderProfiles.GetStats(OpticsRTTScheduler::Pass_RearMirror, Profiles::Variant_Reduced);
+        Game::logMsg("[VR][OpticsRTT][AB] scope full=%.2fms(n=%llu) reduced=%.2fms(n=%llu) saved=%.0f%%"
+            " | mirror full=%.2fms(n=%llu) reduced=%.2fms(n=%llu) saved=%.0f%%",
+            sf.avgMs, (unsigned long long)sf.samples, sr.avgMs, (unsigned long long)sr.samples,
+            m_OpticsRenderProfiles.GetSavingsPercent(OpticsRTTScheduler::Pass_Scope),
+            mf.avgMs, (unsigned long long)mf.samples, mr.avgMs, (unsigned long long)mr.samples,
+            m_OpticsRenderProfiles.GetSavingsPercent(OpticsRTTScheduler::Pass_RearMirror));
+    }
+}
+
+void VR::FlushOverlayState()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_VROverlayMutex);
+        m_OverlayCache.Flush();
+    }
+
+    if (m_OverlayCacheDebugLog && !ShouldThrottle(m_OverlayCacheLastLog, 0.2f))
+    {
+        const auto& c = m_OverlayCache.GetCounters();
+        Game::logMsg("[VR][OverlayCache] flushes=%llu requested=%llu issued=%llu elided=%llu",
+            (unsigned long long)c.flushes, (unsigned long long)c.requested,
+            (unsigned long long)c.issued, (unsigned long long)c.Elided());
+    }
+}
+
+void VR::RecordOpticsRTTCost(OpticsRTTScheduler::Pass pass, OpticsRenderProfiles::Variant variant, double costMs)
+{
+    m_OpticsRTTScheduler.RecordCost(pass, costMs);
+    m_OpticsRenderProfiles.RecordCost(pass, variant, costMs);
+}
+
+void VR::BeginStereoVisibilityFrame(uint32_t frameId, const CViewSetup& leftEye, const CViewSetup& rightEye)
+{
+    auto toEyeView = [](const CViewSetup& view)
+        {
+            Vector fwd, right, up;
+            QAngle::AngleVectors(QAngle(view.angles.x, view.angles.y, view.angles.z), &fwd, &right, &up);
+
+            StereoEyeView eye;
+            eye.origin = { view.origin.x, view.origin.y, view.origin.z };
+            eye.forward = { fwd.x, fwd.y, fwd.z };
+            eye.right = { right.x, right.y, right.z };
+            eye.up = { up.x, up.y, up.z };
+            // By the time RenderView sees it, CViewSetup::fov is the final horizontal FOV.
+            eye.fovXDeg = view.fov;
+            eye.aspect = view.m_flAspectRatio;
+            eye.zNear = view.zNear;
+            eye.zFar = view.zFar;
+            return eye;
+        };
+
+    StereoEyeView combined;
+    m_StereoFrameValid = m_StereoVisibilityReuse
+        && BuildCombinedStereoView(toEyeView(leftEye), toEyeView(rightEye), combined, &m_StereoCombinedPullback);
+    if (!m_StereoFrameValid)
+    {
+        m_StereoVisibilityCache.Invalidate();
+        return;
+    }
+    m_StereoFrameId = frameId;
+    m_StereoVisibilityCache.BeginFrame(frameId, combined);
+}
+
+bool VR::BeginStereoEye(bool secondEye)
+{
+    m_StereoDrawPass = StereoDrawPass::None;
+    m_StereoCaptureLists = nullptr;
+    m_StereoReuseLists = nullptr;
+    if (!m_StereoFrameValid)
+        return false;
+
+    m_StereoDrawThreadId = GetCurrentThreadId();
+    if (!secondEye)
+    {
+        m_StereoCaptureLists = &m_StereoVisibilityCache.BeginCapture();
+        m_StereoCaptureLists->Clear();
+        m_StereoDrawPass = StereoDrawPass::Capture;
+        return false;
+    }
+
+    m_StereoReuseLists = m_StereoVisibilityCache.TryReuse(m_StereoFrameId, m_StereoVisibilityCache.GetView());
+    if (!m_StereoReuseLists)
+        return false;
+    m_StereoReuseCursor = 0;
+    m_StereoDrawPass = StereoDrawPass::Reuse;
+    return true;
+}
+
+void VR::EndStereoEye()
+{
+    if (m_StereoDrawPass == StereoDrawPass::Capture)
+        m_StereoVisibilityCache.EndCapture();
+    m_StereoDrawPass = StereoDrawPass::None;
+    m_StereoCaptureLists = nullptr;
+    m_StereoReuseLists = nullptr;
+}
+
+const VR::StereoDrawClass& VR::ClassifyStereoDraw(int entityIndex, void* model)
+{
+    const StereoDrawPass pass = (GetCurrentThreadId() == m_StereoDrawThreadId) ? m_StereoDrawPass : StereoDrawPass::None;
+    const uint64_t key = StereoVisibilityLists::MakeKey(entityIndex, model);
+    if (pass == StereoDrawPass::Reuse)
+    {
+        if (const StereoDrawClass* hit = m_StereoReuseLists->Find(key, m_StereoReuseCursor))
+        {
+            ++m_StereoReuseHits;
+            return *hit;
+        }
+        ++m_StereoReuseMisses;
+    }
+    else if (pass == StereoDrawPass::Capture)
+    {
+        bool inserted = false;
+        StereoDrawClass& slot = m_StereoCaptureLists->Append(key, &inserted);
+        if (inserted)
+            ComputeStereoDrawClass(entityIndex, model, slot);
+        return slot;
+    }
+
+    // Not captured by the first eye (drawn only in the second), or outside the eye passes.
+    static thread_local StereoDrawClass s_scratch;
+    ComputeStereoDrawClass(entityIndex, model, s_scratch);
+    return s_scratch;
+}
+
+void VR::ComputeStereoDrawClass(int entityIndex, void* model, StereoDrawClass& out) const
+{
+    const char* name = m_Game->m_ModelInfo->GetModelName(model);
+    out.modelName.assign(name ? name : "");
+
+    const C_BaseEntity* entity = nullptr;
+    if (m_Game->m_ClientEntityList && entityIndex > 0)
+    {
+        const int maxEntityIndex = m_Game->m_ClientEntityList->GetHighestEntityIndex();
+        if (entityIndex <= maxEntityIndex)
+            entity = m_Game->GetClientEntity(entityIndex);
+    }
+    out.className = entity ? m_Game->GetNetworkClassName(reinterpret_cast<uintptr_t*>(const_cast<C_BaseEntity*>(entity))) : nullptr;
+    const char* className = out.className;
+    out.isPlayerClass = className && (std::strcmp(className, "CTerrorPlayer") == 0 || std::strcmp(className, "C_TerrorPlayer") == 0);
+    out.isViewmodelClass = className && (std::strcmp(className, "CBaseViewModel") == 0 || std::strcmp(className, "C_BaseViewModel") == 0);
+
+    const std::string& modelName = out.modelName;
+    out.isArmsOrHandsModel =
+        (modelName.find("models/weapons/arms/") != std::string::npos) ||
+        (modelName.find("/arms/") != std::string::npos) ||
+        (modelName.find("v_arms") != std::string::npos) ||
+        (modelName.find("models/weapons/hands/") != std::string::npos) ||
+        (modelName.find("/hands/") != std::string::npos) ||
+        (modelName.find("v_hands") != std::string::npos);
+    out.isViewmodelModel =
+        (modelName.find("models/weapons/v_") != std::string::npos) ||
+        (modelName.find("/v_models/") != std::string::npos) ||
+        (modelName.find("models/v_models/") != std::string::npos) ||
+
+        // L4D2 melee viewmodels often live under models/weapons/melee/...
+        (modelName.find("models/weapons/melee/v_") != std::string::npos) ||
+        (modelName.find("models/weapons/melee/") != std::string::npos && modelName.find("/v_") != std::string::npos) ||
+        (modelName.find("/melee/v_") != std::string::npos) ||
+
+        // Arms/hands are frequently separate models from the gun.
+        out.isArmsOrHandsModel;
+
+    out.entityInfectedType = entity ? GetSpecialInfectedType(entity) : SpecialInfectedType::None;
+    out.modelInfectedType = GetSpecialInfectedTypeFromModel(modelName);
+}
+
+void VR::RecordStereoEyeCost(bool secondEye, bool reusedVisibility, double costMs)
+{
+    using Stats = StereoEyeCostStats;
+    if (!secondEye)
+    {
+        m_StereoEyeCosts.Record(Stats::Eye_First, costMs);
+        return;
+    }
+    m_StereoEyeCosts.Record(reusedVisibility ? Stats::Eye_SecondReused : Stats::Eye_Second, costMs);
+
+    if (m_StereoVisibilityDebugLog && !ShouldThrottle(m_StereoVisibilityLastLog, m_StereoVisibilityDebugLogHz))
+    {
+        const Stats::Stats& first = m_StereoEyeCosts.Get(Stats::Eye_First);
+        const Stats::Stats& second = m_StereoEyeCosts.Get(Stats::Eye_Second);
+        const Stats::Stats& reused = m_StereoEyeCosts.Get(Stats::Eye_SecondReused);
+        const auto& c = m_StereoVisibilityCache.GetCounters();
+        Game::logMsg("[VR][StereoVis] eye1=%.2fms eye2=%.2fms (%.0f%% vs eye1) eye2Reused=%.2fms(n=%llu, %.0f%% vs eye1)"
+            " pullback=%.2f frames=%llu captures=%llu reuses=%llu misses=%llu draws=%zu drawHits=%llu drawMisses=%llu",
+            first.avgMs, second.avgMs, m_StereoEyeCosts.GetSecondEyeSavingsPercent(false),
+            reused.avgMs, (unsigned long long)reused.samples, m_StereoEyeCosts.GetSecondEyeSavingsPercent(true),
+            m_StereoCombinedPullback, (unsigned long long)c.frames, (unsigned long long)c.captures,
+            (unsigned long long)c.reuses, (unsigned long long)c.misses,
+            m_StereoVisibilityCache.HasCapture() ? m_StereoVisibilityCache.GetLists().Size() : size_t(0),
+            (unsigned long long)m_StereoReuseHits, (unsigned long long)m_StereoReuseMisses);
+    }
+}
 void VR::RepositionOverlays()
 {
-    vr::TrackedDevicePose_t hmdPose = m_Poses[vr::k_unTrackedDeviceIndex_Hmd];
-    vr::HmdMatrix34_t hmdMat = hmdPose.mDeviceToAbsoluteTracking;
-    Vector hmdPosition = { hmdMat.m[0][3], hmdMat.m[1][3], hmdMat.m[2][3] };
-    Vector hmdForward = { -hmdMat.m[0][2], 0, -hmdMat.m[2][2] };
+    // Yaw-only frame at the HMD; menu and HUD face the player along it.
+    const Mat34& facing = m_OverlayFrame.trackingFromBody;
+    const Vec3 hmdPosition = facing.Origin();
+    const Vec3 hmdForward = -facing.Column(2);
 
     int windowWidth, windowHeight;
     m_Game->m_MaterialSystem->GetRenderContext()->GetWindowSize(windowWidth, windowHeight);
 
-    vr::HmdMatrix34_t menuTransform =
-    {
-        1.0f, 0.0f, 0.0f, 0.0f,
-        0.0f, 1.0f, 0.0f, 1.0f,
-        0.0f, 0.0f, 1.0f, 1.0f
-    };
-
     vr::ETrackingUniverseOrigin trackingOrigin = vr::VRCompositor()->GetTrackingSpace();
 
     // Reposition main menu overlay
@@ -1727,64 +2005,37 @@ void VR::RepositionOverlays()
 
     float widthRatio = windowWidth / renderWidth;
     float heightRatio = windowHeight / renderHeight;
-    menuTransform.m[0][0] *= widthRatio;
-    menuTransform.m[1][1] *= heightRatio;
-
-    hmdForward[1] = 0;
-    VectorNormalize(hmdForward);
-
-    Vector menuDistance = hmdForward * 3;
-    Vector menuNewPos = menuDistance + hmdPosition;
-
-    menuTransform.m[0][3] = menuNewPos.x;
-    menuTransform.m[1][3] = menuNewPos.y - 0.25;
-    menuTransform.m[2][3] = menuNewPos.z;
 
-    float xScale = menuTransform.m[0][0];
-    float hmdRotationDegrees = atan2f(hmdMat.m[0][2], hmdMat.m[2][2]);
+    Vec3 menuNewPos = hmdPosition + hmdForward * 3.0f;
+    menuNewPos.y -= 0.25f;
 
-    menuTransform.m[0][0] *= cos(hmdRotationDegrees);
-    menuTransform.m[0][2] = sin(hmdRotationDegrees);
-    menuTransform.m[2][0] = -sin(hmdRotationDegrees) * xScale;
-    menuTransform.m[2][2] *= cos(hmdRotationDegrees);
+    Mat34 menuTransform = Mat34Math::Compose(facing, Mat34::Scale(widthRatio, heightRatio, 1.0f));
+    menuTransform.SetOrigin(menuNewPos);
 
-    vr::VROverlay()->SetOverlayTransformAbsolute(m_MainMenuHandle, trackingOrigin, &menuTransform);
-    vr::VROverlay()->SetOverlayWidthInMeters(m_MainMenuHandle, 1.5 * (1.0 / heightRatio));
+    m_OverlayCache.SetTransformAbsolute(m_MainMenuHandle, trackingOrigin, menuTransform.To<vr::HmdMatrix34_t>());
+    m_OverlayCache.SetWidthInMeters(m_MainMenuHandle, 1.5 * (1.0 / heightRatio));
 
-    auto buildFacingTransform = [&](const Vector& position)
+    auto buildFacingTransform = [&](const Vec3& position)
         {
-            vr::HmdMatrix34_t transform =
-            {
-                1.0f, 0.0f, 0.0f, position.x,
-                0.0f, 1.0f, 0.0f, position.y,
-                0.0f, 0.0f, 1.0f, position.z
-            };
-
-            float cosYaw = cos(hmdRotationDegrees);
-            float sinYaw = sin(hmdRotationDegrees);
-            transform.m[0][0] *= cosYaw;
-            transform.m[0][2] = sinYaw;
-            transform.m[2][0] = -sinYaw;
-            transform.m[2][2] *= cosYaw;
-
-            return transform;
+            Mat34 transform = facing;
+            transform.SetOrigin(position);
+            return transform.To<vr::HmdMatrix34_t>();
         };
 
     // Reposition HUD overlays
-    Vector hudDistance = hmdForward * (m_HudDistance + m_FixedHudDistanceOffset);
-    Vector hudNewPos = hudDistance + hmdPosition;
+    Vec3 hudNewPos = hmdPosition + hmdForward * (m_HudDistance + m_FixedHudDistanceOffset);
     hudNewPos.y -= 0.25f;
     hudNewPos.y += m_FixedHudYOffset;
 
     vr::HmdMatrix34_t hudTopTransform = buildFacingTransform(hudNewPos);
 
-    vr::VROverlay()->SetOverlayTransformAbsolute(m_HUDTopHandle, trackingOrigin, &hudTopTransform);
-    vr::VROverlay()->SetOverlayWidthInMeters(m_HUDTopHandle, m_HudSize);
-    vr::VROverlay()->SetOverlayCurvature(m_HUDTopHandle, (std::max)(0.0f, m_TopHudCurvature));
+    m_OverlayCache.SetTransformAbsolute(m_HUDTopHandle, trackingOrigin, hudTopTransform);
+    m_OverlayCache.SetWidthInMeters(m_HUDTopHandle, m_HudSize);
+    m_OverlayCache.SetCurvature(m_HUDTopHandle, (std::max)(0.0f, m_TopHudCurvature));
 
     for (size_t i = 0; i < m_HUDBottomHandles.size(); ++i)
     {
-        vr::VROverlay()->HideOverlay(m_HUDBottomHandles[i]);
+        m_OverlayCache.Hide(m_HUDBottomHandles[i]);
     }
 
     // Scope overlay placement:
@@ -1806,52 +2057,11 @@ void VR::RepositionOverlays()
             const vr::TrackedDeviceIndex_t gunControllerIndex = rightControllerIndex;
             if (gunControllerIndex != vr::k_unTrackedDeviceIndexInvalid)
             {
-                const float deg2rad = 3.14159265358979323846f / 180.0f;
-
-                auto mul33 = [](const float a[3][3], const float b[3][3], float out[3][3])
-                    {
-                        for (int r = 0; r < 3; ++r)
-                            for (int c = 0; c < 3; ++c)
-                                out[r][c] = a[r][0] * b[0][c] + a[r][1] * b[1][c] + a[r][2] * b[2][c];
-                    };
-
                 const QAngle scopeAngle = (m_MouseModeEnabled && m_MouseModeScopeOverlayAngleOffsetSet)
                     ? m_MouseModeScopeOverlayAngleOffset
                     : m_ScopeOverlayAngleOffset;
-                const float pitch = scopeAngle.x * deg2rad;
-                const float yaw = scopeAngle.y * deg2rad;
-                const float roll = scopeAngle.z * deg2rad;
-
-                const float cp = cosf(pitch), sp = sinf(pitch);
-                const float cy = cosf(yaw), sy = sinf(yaw);
-                const float cr = cosf(roll), sr = sinf(roll);
-
-                const float Rx[3][3] = {
-                    {1.0f, 0.0f, 0.0f},
-                    {0.0f, cp,   -sp},
-                    {0.0f, sp,   cp}
-                };
-                const float Ry[3][3] = {
-                    {cy,   0.0f, sy},
-                    {0.0f, 1.0f, 0.0f},
-                    {-sy,  0.0f, cy}
-                };
-                const float Rz[3][3] = {
-                    {cr,   -sr,  0.0f},
-                    {sr,   cr,   0.0f},
-                    {0.0f, 0.0f, 1.0f}
-                };
-
-                float RyRx[3][3];
-                float R[3][3];
-                mul33(Ry, Rx, RyRx);
-                mul33(Rz, RyRx, R);
-
-                vr::HmdMatrix34_t scopeRelative = {
-                    R[0][0], R[0][1], R[0][2], m_ScopeOverlayXOffset,
-                    R[1][0], R[1][1], R[1][2], m_ScopeOverlayYOffset,
-                    R[2][0], R[2][1], R[2][2], m_ScopeOverlayZOffset
-                };
+                const vr::HmdMatrix34_t scopeRelative = Mat34::RotationZYXDeg(scopeAngle.x, scopeAngle.y, scopeAngle.z,
+                    Vec3(m_ScopeOverlayXOffset, m_ScopeOverlayYOffset, m_ScopeOverlayZOffset)).To<vr::HmdMatrix34_t>();
 
                 vr::VROverlay()->SetOverlayTransformTrackedDeviceRelative(m_ScopeHandle, gunControllerIndex, &scopeRelative);
                 vr::VROverlay()->SetOverlayWidthInMeters(m_ScopeHandle, (std::max)(0.01f, m_ScopeOverlayWidthMeters));
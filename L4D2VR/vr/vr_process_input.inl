@@ -6,9 +6,9 @@ void VR::ProcessInput()
     // Recomputed every frame from CustomAction bindings.
     m_CustomWalkHeld = false;
 
-    vr::VROverlay()->SetOverlayFlag(m_HUDTopHandle, vr::VROverlayFlags_MakeOverlaysInteractiveIfVisible, false);
+    m_OverlayCache.SetFlag(m_HUDTopHandle, vr::VROverlayFlags_MakeOverlaysInteractiveIfVisible, false);
     for (vr::VROverlayHandle_t& overlay : m_HUDBottomHandles)
-        vr::VROverlay()->SetOverlayFlag(overlay, vr::VROverlayFlags_MakeOverlaysInteractiveIfVisible, false);
+        m_OverlayCache.SetFlag(overlay, vr::VROverlayFlags_MakeOverlaysInteractiveIfVisible, false);
 
     typedef std::chrono::duration<float, std::milli> duration;
     auto currentTime = std::chrono::steady_clock::now();
@@ -1021,12 +1021,12 @@ void VR::ProcessInput()
         m_AdjustStartViewmodelForward = m_ViewmodelForward;
         m_AdjustStartViewmodelRight = m_ViewmodelRight;
         m_AdjustStartViewmodelUp = m_ViewmodelUp;
-        m_AdjustingKey = m_CurrentViewmodelKey;
+        m_AdjustingSlot = m_CurrentViewmodelSlot;
     }
     else if (!adjustViewmodelActive && m_AdjustingViewmodel)
     {
         m_AdjustingViewmodel = false;
-        m_AdjustingKey.clear();
+        m_AdjustingSlot = -1;
         if (m_ViewmodelAdjustmentsDirty)
         {
             SaveViewmodelAdjustments();
@@ -1289,18 +1289,18 @@ void VR::ProcessInput()
 
     auto showTopHud = [&]()
         {
-            vr::VROverlay()->ShowOverlay(m_HUDTopHandle);
+            m_OverlayCache.Show(m_HUDTopHandle);
         };
 
     auto hideTopHud = [&]()
         {
-            vr::VROverlay()->HideOverlay(m_HUDTopHandle);
+            m_OverlayCache.Hide(m_HUDTopHandle);
         };
 
     auto hideBottomHud = [&]()
         {
             for (vr::VROverlayHandle_t& overlay : m_HUDBottomHandles)
-                vr::VROverlay()->HideOverlay(overlay);
+                m_OverlayCache.Hide(overlay);
         };
 
     const bool isControllerVertical =
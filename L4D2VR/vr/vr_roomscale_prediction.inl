@@ -1,50 +1,15 @@
-bool VR::DecodeRoomscale1To1Delta(int weaponsubtype, Vector& outDeltaMeters)
+bool VR::DecodeRoomscale1To1Delta(int buttons, Vector& outDeltaMeters)
 {
-    uint32_t v = (uint32_t)weaponsubtype;
     // Reliable on-wire format: packed into CUserCmd::buttons *unused high bits*.
     // Source's usercmd delta encoding for weaponsubtype is not guaranteed to survive when weaponselect==0.
     // L4D2 button flags are below bit 26 (IN_ATTACK3 is 1<<25), so bits 26..31 are safe for our payload.
-    // Layout: dx_cm: bits 26..28 (signed 3-bit, [-4..3]), dy_cm: bits 29..31 (signed 3-bit, [-4..3]).
-    static constexpr uint32_t kRSButtonsMask = 0xFC000000u; // bits 26..31
-    if (v & kRSButtonsMask)
-    {
-        auto decodeSigned3 = [](int s3) -> int
-            {
-                s3 &= 0x7;
-                if (s3 & 0x4)
-                    s3 -= 8;
-                return s3;
-            };
-        const int dx_cm = decodeSigned3((int)((v >> 26) & 0x7));
-        const int dy_cm = decodeSigned3((int)((v >> 29) & 0x7));
-        if (dx_cm == 0 && dy_cm == 0)
-            return false;
-        outDeltaMeters = Vector(dx_cm * 0.01f, dy_cm * 0.01f, 0.0f);
-        return true;
-    }
-    // Legacy 32-bit format.
-    if ((v & kRSMarker32) != 0)
-    {
-        int rx = (int)(v & kAxisMask32);
-        int ry = (int)((v >> kAxisBits32) & kAxisMask32);
-        int dx = rx - kAxisBias32;
-        int dy = ry - kAxisBias32;
-        outDeltaMeters = Vector(dx * 0.01f, dy * 0.01f, 0.0f);
-        return true;
-    }
-
-    // Compact 15-bit format (survives 16-bit truncation).
-    if ((v & kRSMarker15) != 0)
-    {
-        int rx = (int)(v & kAxisMask15);
-        int ry = (int)((v >> kAxisBits15) & kAxisMask15);
-        int dx = rx - kAxisBias15;
-        int dy = ry - kAxisBias15;
-        outDeltaMeters = Vector(dx * 0.01f, dy * 0.01f, 0.0f);
-        return true;
-    }
-
-    return false;
+    // Layout: one RoomscaleCodec code (adaptive step + ternary direction), see roomscale_codec.h.
+    float dx = 0.0f;
+    float dy = 0.0f;
+    if (!RoomscaleCodec::Decode((uint32_t)buttons, dx, dy))
+        return false;
+    outDeltaMeters = Vector(dx, dy, 0.0f);
+    return true;
 }
 
 void VR::EncodeRoomscale1To1Move(CUserCmd* cmd)
@@ -55,7 +20,7 @@ void VR::EncodeRoomscale1To1Move(CUserCmd* cmd)
     // IMPORTANT: Do NOT rely on weaponsubtype for the 1:1 delta on the wire.
     // It often does not survive usercmd delta encoding when weaponselect==0.
     // Instead, pack into the unused high bits of cmd->buttons.
-    static constexpr uint32_t kRSButtonsMask = 0xFC000000u; // bits 26..31
+    static constexpr uint32_t kRSButtonsMask = RoomscaleCodec::kButtonsMask; // bits 26..31
 
     const uint32_t buttonsBefore = (uint32_t)cmd->buttons;
     // Ensure we never accidentally re-send a previous packed delta.
@@ -77,7 +42,7 @@ void VR::EncodeRoomscale1To1Move(CUserCmd* cmd)
     {
         m_Roomscale1To1PrevCorrectedAbs = m_HmdPosCorrectedPrev;
         m_Roomscale1To1PrevValid = true;
-        m_Roomscale1To1AccumMeters = Vector(0.0f, 0.0f, 0.0f);
+        m_Roomscale1To1Encoder.Reset();
         m_Roomscale1To1ChaseActive = false;
         m_Roomscale1To1LocomotionCooldownCmds = 8;
         return;
@@ -88,7 +53,7 @@ void VR::EncodeRoomscale1To1Move(CUserCmd* cmd)
         --m_Roomscale1To1LocomotionCooldownCmds;
         m_Roomscale1To1PrevCorrectedAbs = m_HmdPosCorrectedPrev;
         m_Roomscale1To1PrevValid = true;
-        m_Roomscale1To1AccumMeters = Vector(0.0f, 0.0f, 0.0f);
+        m_Roomscale1To1Encoder.Reset();
         m_Roomscale1To1ChaseActive = false;
         return;
     }
@@ -103,7 +68,7 @@ void VR::EncodeRoomscale1To1Move(CUserCmd* cmd)
 
         m_Roomscale1To1PrevCorrectedAbs = m_HmdPosCorrectedPrev;
         m_Roomscale1To1PrevValid = true;
-        m_Roomscale1To1AccumMeters = Vector(0.0f, 0.0f, 0.0f);
+        m_Roomscale1To1Encoder.Reset();
         m_Roomscale1To1ChaseActive = false;
         if (locomotionBlock)
             m_Roomscale1To1LocomotionCooldownCmds = 8;
@@ -117,7 +82,7 @@ void VR::EncodeRoomscale1To1Move(CUserCmd* cmd)
 
         m_Roomscale1To1PrevCorrectedAbs = m_HmdPosCorrectedPrev;
         m_Roomscale1To1PrevValid = true;
-        m_Roomscale1To1AccumMeters = Vector(0.0f, 0.0f, 0.0f);
+        m_Roomscale1To1Encoder.Reset();
         m_Roomscale1To1ChaseActive = false;
         return;
     }
@@ -140,7 +105,7 @@ void VR::EncodeRoomscale1To1Move(CUserCmd* cmd)
         if (anyLocomotionNow)
         {
             m_Roomscale1To1ChaseActive = false;
-            m_Roomscale1To1AccumMeters = Vector(0.0f, 0.0f, 0.0f);
+            m_Roomscale1To1Encoder.Reset();
             return;
         }
 
@@ -180,38 +145,26 @@ void VR::EncodeRoomscale1To1Move(CUserCmd* cmd)
         const float stepM = std::min(std::max(0.0f, m_Roomscale1To1MaxStepMeters), needM);
         Vector deltaM((toCamU.x / distU) * stepM, (toCamU.y / distU) * stepM, 0.0f);
 
-        int dx_cm = (int)roundf(deltaM.x * 100.0f);
-        int dy_cm = (int)roundf(deltaM.y * 100.0f);
-        if (dx_cm == 0 && dy_cm == 0)
+        // The drift is re-measured every command, so send the nearest code without carrying a remainder.
+        const uint32_t code = RoomscaleCodec::QuantizeCode(deltaM.x, deltaM.y);
+        if (code == 0)
             return;
-
-        // We have 3 signed bits per axis => [-4..3] cm per cmd.
-        int send_dx_cm = dx_cm;
-        int send_dy_cm = dy_cm;
-        if (send_dx_cm < -4) send_dx_cm = -4;
-        if (send_dx_cm > 3)  send_dx_cm = 3;
-        if (send_dy_cm < -4) send_dy_cm = -4;
-        if (send_dy_cm > 3)  send_dy_cm = 3;
-
-        if (send_dx_cm != 0 || send_dy_cm != 0)
-        {
-            const uint32_t dx3 = (uint32_t)(send_dx_cm & 0x7);
-            const uint32_t dy3 = (uint32_t)(send_dy_cm & 0x7);
-            const uint32_t packed = (dx3 << 26) | (dy3 << 29);
-            cmd->buttons = (int)((cmd->buttons & ~(int)kRSButtonsMask) | (int)packed);
-        }
+        float sendX = 0.0f;
+        float sendY = 0.0f;
+        RoomscaleCodec::DecodeCode(code, sendX, sendY);
+        cmd->buttons = (int)((cmd->buttons & ~(int)kRSButtonsMask) | (int)RoomscaleCodec::Pack(code));
 
         const uint32_t buttonsAfter = (uint32_t)cmd->buttons;
         if (m_Roomscale1To1DebugLog && !ShouldThrottle(m_Roomscale1To1DebugLastEncode, m_Roomscale1To1DebugLogHz))
         {
-            Game::logMsg("[VR][1to1][encode] chase cmd=%d tick=%d cmdptr=%p buttons 0x%08X->0x%08X drift=%.3fm start=%.3fm stop=%.3fm step=%.3fm send=(%d,%d)",
+            Game::logMsg("[VR][1to1][encode] chase cmd=%d tick=%d cmdptr=%p buttons 0x%08X->0x%08X drift=%.3fm start=%.3fm stop=%.3fm step=%.3fm send=(%.4f,%.4f)",
                 +cmd->command_number, cmd->tick_count, (void*)cmd,
                 (unsigned)buttonsBefore, (unsigned)buttonsAfter,
-                distM, start, stop, stepM, send_dx_cm, send_dy_cm);
+                distM, start, stop, stepM, sendX, sendY);
         }
 
         // Chase mode doesn't use the legacy delta accumulator.
-        m_Roomscale1To1AccumMeters = Vector(0.0f, 0.0f, 0.0f);
+        m_Roomscale1To1Encoder.Reset();
         return;
     }
 
@@ -225,7 +178,7 @@ void VR::EncodeRoomscale1To1Move(CUserCmd* cmd)
     {
         m_Roomscale1To1PrevCorrectedAbs = cur;
         m_Roomscale1To1PrevValid = true;
-        m_Roomscale1To1AccumMeters = Vector(0.0f, 0.0f, 0.0f);
+        m_Roomscale1To1Encoder.Reset();
         if (m_Roomscale1To1DebugLog && !ShouldThrottle(m_Roomscale1To1DebugLastEncode, m_Roomscale1To1DebugLogHz))
             Game::logMsg("[VR][1to1][encode] init prev cmd=%d tick=%d cmdptr=%p cur=(%.3f %.3f %.3f)", cmd->command_number, cmd->tick_count, (void*)cmd, cur.x, cur.y, cur.z);
 
@@ -252,41 +205,20 @@ void VR::EncodeRoomscale1To1Move(CUserCmd* cmd)
 
     m_Roomscale1To1PrevCorrectedAbs = cur;
 
-    // Accumulate sub-centimeter movement so slow walking/leaning still moves the player.
-    m_Roomscale1To1AccumMeters = m_Roomscale1To1AccumMeters + d;
-    m_Roomscale1To1AccumMeters.z = 0.0f;
+    // The encoder adds what earlier commands still owe and sends the nearest code; whatever it
+    // couldn't represent is carried, so sub-centimeter movement adds up and nothing drifts.
+    float sendX = 0.0f;
+    float sendY = 0.0f;
+    const uint32_t code = m_Roomscale1To1Encoder.Encode(d.x, d.y, sendX, sendY);
+    if (code != 0)
+        cmd->buttons = (int)((cmd->buttons & ~(int)kRSButtonsMask) | (int)RoomscaleCodec::Pack(code));
 
-    int dx_cm = (int)roundf(m_Roomscale1To1AccumMeters.x * 100.0f);
-    int dy_cm = (int)roundf(m_Roomscale1To1AccumMeters.y * 100.0f);
-
-    if (dx_cm == 0 && dy_cm == 0)
-        return;
-
-    // We have 3 signed bits per axis => [-4..3] cm per cmd.
-    // Keep remainder in m_Roomscale1To1AccumMeters for later cmds.
-    int send_dx_cm = dx_cm;
-    int send_dy_cm = dy_cm;
-    if (send_dx_cm < -4) send_dx_cm = -4;
-    if (send_dx_cm > 3)  send_dx_cm = 3;
-    if (send_dy_cm < -4) send_dy_cm = -4;
-    if (send_dy_cm > 3)  send_dy_cm = 3;
-    const bool willSend = (send_dx_cm != 0 || send_dy_cm != 0);
-    if (willSend)
-    {
-        const uint32_t dx3 = (uint32_t)(send_dx_cm & 0x7);
-        const uint32_t dy3 = (uint32_t)(send_dy_cm & 0x7);
-        const uint32_t packed = (dx3 << 26) | (dy3 << 29);
-        cmd->buttons = (int)((cmd->buttons & ~(int)kRSButtonsMask) | (int)packed);
-        // Keep the fractional remainder for future commands.
-        m_Roomscale1To1AccumMeters.x -= send_dx_cm * 0.01f;
-        m_Roomscale1To1AccumMeters.y -= send_dy_cm * 0.01f;
-    }
     const uint32_t buttonsAfter = (uint32_t)cmd->buttons;
     if (m_Roomscale1To1DebugLog && !ShouldThrottle(m_Roomscale1To1DebugLastEncode, m_Roomscale1To1DebugLogHz))
     {
-        Game::logMsg("[VR][1to1][encode] cmd=%d tick=%d cmdptr=%p buttons 0x%08X->0x%08X cur=(%.3f %.3f) d=(%.3f %.3f) cm=(%d,%d) send=(%d,%d)",
+        Game::logMsg("[VR][1to1][encode] cmd=%d tick=%d cmdptr=%p buttons 0x%08X->0x%08X cur=(%.3f %.3f) d=(%.3f %.3f) send=(%.4f,%.4f) owed=(%.4f,%.4f)",
             +cmd->command_number, cmd->tick_count, (void*)cmd, (unsigned)buttonsBefore, (unsigned)buttonsAfter,
-            +cur.x, cur.y, d.x, d.y, dx_cm, dy_cm, send_dx_cm, send_dy_cm);
+            +cur.x, cur.y, d.x, d.y, sendX, sendY, m_Roomscale1To1Encoder.ResidualX(), m_Roomscale1To1Encoder.ResidualY());
     }
 }
 
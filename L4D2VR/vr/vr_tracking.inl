@@ -14,6 +14,8 @@ void VR::UpdateTracking()
             m_ServerHookFallbackCheckTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_ServerHookFallbackDelayMs);
         else
             m_ServerHookFallbackCheckTime = std::chrono::steady_clock::now();
+        // Weapon scripts can change with the map's addons; reload (usually from the cache) off-thread.
+        StartEffectiveAttackRangeWeaponDataPreload(true);
     }
     m_WasInGamePrev = inGameNow;
     int playerIndex = m_Game->m_EngineClient->GetLocalPlayer();
@@ -1085,8 +1087,11 @@ void VR::UpdateTracking()
         m_RearMirrorCameraAngAbs = mirrorAng;
     }
 
+    RefreshEntityGrid(localPlayer);
+
     // Non-VR servers only understand cmd->viewangles. When ForceNonVRServerMovement is enabled,
     // solve an eye-based aim hit point so rendered aim line and real hit point stay consistent.
+    ++m_AimQueryFrameId;
     UpdateNonVRAimSolution(localPlayer);
     UpdateAimingLaser(localPlayer);
 
@@ -1102,7 +1107,7 @@ void VR::UpdateTracking()
                 return angle;
             };
 
-        if (m_AdjustingKey != m_CurrentViewmodelKey)
+        if (m_AdjustingSlot != m_CurrentViewmodelSlot)
         {
             m_AdjustStartLeftPos = m_LeftControllerPosAbs;
             m_AdjustStartLeftAng = m_LeftControllerAngAbs;
@@ -1111,7 +1116,7 @@ void VR::UpdateTracking()
             m_AdjustStartViewmodelForward = m_ViewmodelForward;
             m_AdjustStartViewmodelRight = m_ViewmodelRight;
             m_AdjustStartViewmodelUp = m_ViewmodelUp;
-            m_AdjustingKey = m_CurrentViewmodelKey;
+            m_AdjustingSlot = m_CurrentViewmodelSlot;
         }
 
         Vector deltaPos = m_LeftControllerPosAbs - m_AdjustStartLeftPos;
@@ -1135,7 +1140,14 @@ void VR::UpdateTracking()
             m_AdjustStartViewmodelAng.y + deltaAng.y,
             m_AdjustStartViewmodelAng.z + deltaAng.z
         };
-        m_ViewmodelAdjustments[m_CurrentViewmodelKey] = { m_ViewmodelPosAdjust, m_ViewmodelAngAdjust };
+        ViewmodelAdjustValue adjusted;
+        adjusted.position[0] = m_ViewmodelPosAdjust.x;
+        adjusted.position[1] = m_ViewmodelPosAdjust.y;
+        adjusted.position[2] = m_ViewmodelPosAdjust.z;
+        adjusted.angle[0] = m_ViewmodelAngAdjust.x;
+        adjusted.angle[1] = m_ViewmodelAngAdjust.y;
+        adjusted.angle[2] = m_ViewmodelAngAdjust.z;
+        m_ViewmodelAdjustments.Set(m_CurrentViewmodelSlot, adjusted);
         m_ViewmodelAdjustmentsDirty = true;
     }
 
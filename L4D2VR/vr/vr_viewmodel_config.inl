@@ -210,147 +210,45 @@ std::string VR::GetMeleeWeaponName(C_WeaponCSBase* weapon) const
 
 std::string VR::WeaponIdToString(int weaponId) const
 {
-    static const std::vector<std::string> weaponNames =
-    {
-        "none",
-        "pistol",
-        "uzi",
-        "pumpshotgun",
-        "autoshotgun",
-        "m16a1",
-        "hunting_rifle",
-        "mac10",
-        "shotgun_chrome",
-        "scar",
-        "sniper_military",
-        "spas",
-        "first_aid_kit",
-        "molotov",
-        "pipe_bomb",
-        "pain_pills",
-        "gascan",
-        "propane_tank",
-        "oxygen_tank",
-        "melee",
-        "chainsaw",
-        "grenade_launcher",
-        "ammo_pack",
-        "adrenaline",
-        "defibrillator",
-        "vomitjar",
-        "ak47",
-        "gnome_chompski",
-        "cola_bottles",
-        "fireworks_box",
-        "incendiary_ammo",
-        "frag_ammo",
-        "magnum",
-        "mp5",
-        "sg552",
-        "awp",
-        "scout",
-        "m60",
-        "tank_claw",
-        "hunter_claw",
-        "charger_claw",
-        "boomer_claw",
-        "smoker_claw",
-        "spitter_claw",
-        "jockey_claw",
-        "machinegun",
-        "vomit",
-        "splat",
-        "pounce",
-        "lounge",
-        "pull",
-        "choke",
-        "rock",
-        "physics",
-        "ammo",
-        "upgrade_item"
-    };
-
-    size_t index = static_cast<size_t>(weaponId);
-    if (index < weaponNames.size())
-        return weaponNames[index];
-
-    return std::string();
+    return ViewmodelAdjustTable::WeaponName(weaponId);
 }
 
-std::string VR::NormalizeViewmodelAdjustKey(const std::string& rawKey) const
-{
-    const std::string weaponPrefix = "weapon:";
-    if (rawKey.rfind(weaponPrefix, 0) == 0)
-    {
-        std::string weaponIdString = rawKey.substr(weaponPrefix.size());
-        if (!weaponIdString.empty() &&
-            std::all_of(weaponIdString.begin(), weaponIdString.end(), [](unsigned char c) { return std::isdigit(c); }))
-        {
-            try
-            {
-                int weaponId = std::stoi(weaponIdString);
-                std::string weaponName = WeaponIdToString(weaponId);
-                if (!weaponName.empty())
-                    return weaponPrefix + weaponName;
-            }
-            catch (...)
-            {
-            }
-        }
-    }
-
-    return rawKey;
-}
-
-std::string VR::BuildViewmodelAdjustKey(C_WeaponCSBase* weapon) const
+int VR::ResolveViewmodelAdjustSlot(C_WeaponCSBase* weapon)
 {
     if (!weapon)
-        return "weapon:none";
-
-    C_WeaponCSBase::WeaponID weaponId = weapon->GetWeaponID();
-
-    if (weaponId == C_WeaponCSBase::WeaponID::MELEE)
-    {
-        std::string meleeName = GetMeleeWeaponName(weapon);
-        if (!meleeName.empty())
-            return "melee:" + meleeName;
-
-        return "melee:unknown";
-    }
-
-    std::string weaponName = WeaponIdToString(static_cast<int>(weaponId));
-    if (!weaponName.empty())
-        return "weapon:" + weaponName;
+        return m_ViewmodelAdjustments.WeaponSlot(0);
 
-    return "weapon:" + std::to_string(static_cast<int>(weaponId));
-}
+    const int weaponId = static_cast<int>(weapon->GetWeaponID());
+    if (weaponId == static_cast<int>(C_WeaponCSBase::WeaponID::MELEE))
+        return m_ViewmodelAdjustments.MeleeSlot(GetMeleeWeaponName(weapon));
 
-ViewmodelAdjustment& VR::EnsureViewmodelAdjustment(const std::string& key)
-{
-    auto [it, inserted] = m_ViewmodelAdjustments.emplace(key, m_DefaultViewmodelAdjust);
-    return it->second;
+    return m_ViewmodelAdjustments.WeaponSlot(weaponId);
 }
 
 void VR::RefreshActiveViewmodelAdjustment(C_BasePlayer* localPlayer)
 {
     C_WeaponCSBase* activeWeapon = localPlayer ? (C_WeaponCSBase*)localPlayer->GetActiveWeapon() : nullptr;
-    std::string adjustKey = BuildViewmodelAdjustKey(activeWeapon);
+    const int weaponId = activeWeapon ? static_cast<int>(activeWeapon->GetWeaponID()) : 0;
 
-    m_CurrentViewmodelKey = adjustKey;
-
-    if (m_LastLoggedViewmodelKey != m_CurrentViewmodelKey)
+    // The melee script lookup and key building only happen when the weapon actually changes;
+    // the id is compared too because a freed weapon's address can be reused by the next one.
+    if (!m_ViewmodelSlotValid || activeWeapon != m_ViewmodelSlotWeapon || weaponId != m_ViewmodelSlotWeaponId)
     {
-        m_LastLoggedViewmodelKey = m_CurrentViewmodelKey;
+        m_CurrentViewmodelSlot = ResolveViewmodelAdjustSlot(activeWeapon);
+        m_ViewmodelSlotWeapon = activeWeapon;
+        m_ViewmodelSlotWeaponId = weaponId;
+        m_ViewmodelSlotValid = true;
     }
 
-    ViewmodelAdjustment& adjustment = EnsureViewmodelAdjustment(adjustKey);
-    m_ViewmodelPosAdjust = adjustment.position;
-    m_ViewmodelAngAdjust = adjustment.angle;
+    const ViewmodelAdjustValue& adjustment = m_ViewmodelAdjustments.Get(m_CurrentViewmodelSlot, m_DefaultViewmodelAdjust);
+    m_ViewmodelPosAdjust = { adjustment.position[0], adjustment.position[1], adjustment.position[2] };
+    m_ViewmodelAngAdjust = { adjustment.angle[0], adjustment.angle[1], adjustment.angle[2] };
 }
 
 void VR::LoadViewmodelAdjustments()
 {
-    m_ViewmodelAdjustments.clear();
+    m_ViewmodelAdjustments.Clear();
+    m_ViewmodelSlotValid = false;
 
     if (m_ViewmodelAdjustmentSavePath.empty())
     {
@@ -358,75 +256,15 @@ void VR::LoadViewmodelAdjustments()
         return;
     }
 
-    std::ifstream adjustmentStream(m_ViewmodelAdjustmentSavePath);
+    std::ifstream adjustmentStream(m_ViewmodelAdjustmentSavePath, std::ios::binary);
     if (!adjustmentStream)
     {
         return;
     }
 
-    auto ltrim = [](std::string& s) {
-        s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) { return !std::isspace(ch); }));
-        };
-    auto rtrim = [](std::string& s) {
-        s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char ch) { return !std::isspace(ch); }).base(), s.end());
-        };
-    auto trim = [&](std::string& s) { ltrim(s); rtrim(s); };
-
-    auto parseVector3 = [&](const std::string& raw, const Vector& defaults)->Vector
-        {
-            Vector result = defaults;
-            std::stringstream ss(raw);
-            std::string token;
-            float* components[3] = { &result.x, &result.y, &result.z };
-            int index = 0;
-
-            while (std::getline(ss, token, ',') && index < 3)
-            {
-                trim(token);
-                if (!token.empty())
-                {
-                    try
-                    {
-                        *components[index] = std::stof(token);
-                    }
-                    catch (...)
-                    {
-                    }
-                }
-                ++index;
-            }
-
-            return result;
-        };
-
-    std::string line;
-    while (std::getline(adjustmentStream, line))
-    {
-        trim(line);
-        if (line.empty())
-            continue;
-
-        size_t eq = line.find('=');
-        size_t separator = line.find(';', eq == std::string::npos ? 0 : eq + 1);
-
-        if (eq == std::string::npos || separator == std::string::npos || separator <= eq)
-            continue;
-
-        std::string key = line.substr(0, eq);
-        trim(key);
-        if (key.empty())
-            continue;
-
-        std::string posStr = line.substr(eq + 1, separator - eq - 1);
-        std::string angStr = line.substr(separator + 1);
-
-        std::string normalizedKey = NormalizeViewmodelAdjustKey(key);
-
-        Vector posAdjust = parseVector3(posStr, m_DefaultViewmodelAdjust.position);
-        Vector angAdjustVec = parseVector3(angStr, Vector{ m_DefaultViewmodelAdjust.angle.x, m_DefaultViewmodelAdjust.angle.y, m_DefaultViewmodelAdjust.angle.z });
-
-        m_ViewmodelAdjustments[normalizedKey] = { posAdjust, { angAdjustVec.x, angAdjustVec.y, angAdjustVec.z } };
-    }
+    std::stringstream contents;
+    contents << adjustmentStream.rdbuf();
+    m_ViewmodelAdjustments.Parse(contents.str(), m_DefaultViewmodelAdjust);
 
     m_ViewmodelAdjustmentsDirty = false;
 }
@@ -438,19 +276,54 @@ void VR::SaveViewmodelAdjustments()
         return;
     }
 
-    std::ofstream adjustmentStream(m_ViewmodelAdjustmentSavePath, std::ios::trunc);
-    if (!adjustmentStream)
-    {
+    // Snapshot here, write on a worker: the file write used to stall the frame that released the combo.
+    std::string snapshot = m_ViewmodelAdjustments.Serialize();
+    m_ViewmodelAdjustmentsDirty = false;
+
+    std::lock_guard<std::mutex> lock(m_ViewmodelAdjustSaveMutex);
+    m_ViewmodelAdjustPendingSave = std::move(snapshot);
+    m_ViewmodelAdjustSavePending = true;
+    if (m_ViewmodelAdjustSaveWorkerRunning)
         return;
-    }
 
-    for (const auto& [key, adjustment] : m_ViewmodelAdjustments)
+    m_ViewmodelAdjustSaveWorkerRunning = true;
+    try
     {
-        adjustmentStream << key << '=' << adjustment.position.x << ',' << adjustment.position.y << ',' << adjustment.position.z;
-        adjustmentStream << ';' << adjustment.angle.x << ',' << adjustment.angle.y << ',' << adjustment.angle.z << "\n";
+        std::thread worker(&VR::ViewmodelAdjustmentSaveWorkerMain, this);
+        worker.detach();
     }
+    catch (const std::system_error&)
+    {
+        m_ViewmodelAdjustSaveWorkerRunning = false;
+        Game::logMsg("[VR] Viewmodel adjustments: couldn't start the save worker, changes stay unsaved.");
+    }
+}
 
-    m_ViewmodelAdjustmentsDirty = false;
+void VR::ViewmodelAdjustmentSaveWorkerMain()
+{
+    const std::string path = m_ViewmodelAdjustmentSavePath;
+    for (;;)
+    {
+        std::string snapshot;
+        {
+            std::lock_guard<std::mutex> lock(m_ViewmodelAdjustSaveMutex);
+            if (!m_ViewmodelAdjustSavePending)
+            {
+                m_ViewmodelAdjustSaveWorkerRunning = false;
+                return;
+            }
+            snapshot = std::move(m_ViewmodelAdjustPendingSave);
+            m_ViewmodelAdjustSavePending = false;
+        }
+
+        const bool saved = ViewmodelAdjustTable::SaveAtomic(path, snapshot,
+            [](const std::string& tmp, const std::string& dst)
+            {
+                return MoveFileExA(tmp.c_str(), dst.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != FALSE;
+            });
+        if (!saved)
+            Game::logMsg("[VR] Viewmodel adjustments: failed to write %s", path.c_str());
+    }
 }
 
 void VR::ParseConfigFile()
@@ -891,6 +764,8 @@ void VR::ParseConfigFile()
         m_ThirdPersonFrontVRCameraOffset.z = getFloat("ThirdPersonFrontVRCameraOffsetZ", m_ThirdPersonFrontVRCameraOffset.z);
     }
     m_ThirdPersonCameraSmoothing = std::clamp(getFloat("ThirdPersonCameraSmoothing", m_ThirdPersonCameraSmoothing), 0.0f, 0.99f);
+    m_EngineCameraInterpDelayTicks = std::clamp(getFloat("EngineCameraInterpDelayTicks", m_EngineCameraInterpDelayTicks), 0.0f, 2.0f);
+    m_EngineCameraMaxExtrapolateTicks = std::clamp(getFloat("EngineCameraMaxExtrapolateTicks", m_EngineCameraMaxExtrapolateTicks), 0.0f, 1.0f);
     m_ThirdPersonMapLoadCooldownMs = std::max(0, getInt("ThirdPersonMapLoadCooldownMs", m_ThirdPersonMapLoadCooldownMs));
     m_ThirdPersonRenderOnCustomWalk = getBool("ThirdPersonRenderOnCustomWalk", m_ThirdPersonRenderOnCustomWalk);
     m_ThirdPersonDefault = getBool("ThirdPersonDefault", m_ThirdPersonDefault);
@@ -1006,6 +881,9 @@ void VR::ParseConfigFile()
     m_AimLineConfigEnabled = m_AimLineEnabled;
     m_BlockFireOnFriendlyAimEnabled = getBool("BlockFireOnFriendlyAimEnabled", m_BlockFireOnFriendlyAimEnabled);
     m_BlockFireOnFriendlyAimRadiusMeters = std::clamp(getFloat("BlockFireOnFriendlyAimRadiusMeters", m_BlockFireOnFriendlyAimRadiusMeters), 0.0f, 0.5f);
+    m_FriendlyFireSpreadGuardEnabled = getBool("FriendlyFireSpreadGuard", m_FriendlyFireSpreadGuardEnabled);
+    m_FriendlyFireSpreadSamples = std::clamp(getInt("FriendlyFireSpreadSamples", m_FriendlyFireSpreadSamples), 8, 128);
+    m_FriendlyFireSpreadBlockChance = std::clamp(getFloat("FriendlyFireSpreadBlockChance", m_FriendlyFireSpreadBlockChance), 0.01f, 1.0f);
     m_AutoRepeatSemiAutoFire = getBool("AutoRepeatSemiAutoFire", m_AutoRepeatSemiAutoFire);
     m_AutoRepeatSemiAutoFireHz = std::max(0.0f, getFloat("AutoRepeatSemiAutoFireHz", m_AutoRepeatSemiAutoFireHz));
     m_AutoRepeatSprayPushEnabled = getBool("AutoRepeatSprayPushEnabled", m_AutoRepeatSprayPushEnabled);
@@ -1020,6 +898,8 @@ void VR::ParseConfigFile()
     m_HitSoundVolume = std::clamp(getFloat("HitSoundVolume", m_HitSoundVolume), 0.0f, 2.0f);
     m_KillSoundEnabled = getBool("KillSoundEnabled", m_KillSoundEnabled);
     m_KillSoundDetectionWindowSeconds = std::clamp(getFloat("KillSoundDetectionWindowSeconds", m_KillSoundDetectionWindowSeconds), 0.05f, 1.0f);
+    m_HitFeedbackPredictConfidence = std::clamp(getFloat("HitFeedbackPredictConfidence", m_HitFeedbackPredictConfidence), 0.0f, 1.01f);
+    m_HitFeedbackMinWindowSeconds = std::clamp(getFloat("HitFeedbackMinWindowSeconds", m_HitFeedbackMinWindowSeconds), 0.02f, 1.0f);
     m_KillSoundPlaybackCooldownSeconds = std::clamp(getFloat("KillSoundPlaybackCooldownSeconds", m_KillSoundPlaybackCooldownSeconds), 0.0f, 0.25f);
     m_KillSoundNormalSpec = getString("KillSoundNormalSpec", m_KillSoundNormalSpec);
     m_KillSoundHeadshotSpec = getString("KillSoundHeadshotSpec", m_KillSoundHeadshotSpec);
@@ -1103,12 +983,45 @@ void VR::ParseConfigFile()
     m_GameLaserSightEndOffset.z = std::clamp(m_GameLaserSightEndOffset.z, -256.0f, 256.0f);
     m_ThrowArcLandingOffset = std::max(-10000.0f, std::min(10000.0f, getFloat("ThrowArcLandingOffset", m_ThrowArcLandingOffset)));
     m_ThrowArcMaxHz = std::max(0.0f, getFloat("ThrowArcMaxHz", m_ThrowArcMaxHz));
+    m_ThrowArcPhysics = getBool("ThrowArcPhysics", m_ThrowArcPhysics);
+    {
+        // "speed,gravity,drag" per throwable.
+        const char* keys[3] = { "ThrowArcMolotovPhysics", "ThrowArcPipeBombPhysics", "ThrowArcVomitJarPhysics" };
+        for (size_t i = 0; i < m_ThrowArcProfiles.size(); ++i)
+        {
+            ThrowArcProfile& profile = m_ThrowArcProfiles[i];
+            const Vector v = getVector3(keys[i], Vector(profile.speed, profile.gravity, profile.drag));
+            profile.speed = std::clamp(v.x, 50.0f, 5000.0f);
+            profile.gravity = std::clamp(v.y, 0.0f, 5000.0f);
+            profile.drag = std::clamp(v.z, 0.0f, 10.0f);
+        }
+    }
+    m_ThrowArcMaxTraces = std::clamp(getInt("ThrowArcMaxTraces", m_ThrowArcMaxTraces), 2, 48);
+    m_ThrowArcCacheMove = std::clamp(getFloat("ThrowArcCacheMove", m_ThrowArcCacheMove), 0.0f, 32.0f);
     // Debug / memory
     const bool prevVASLog = m_DebugVASLog;
     m_DebugVASLog = getBool("DebugVASLog", m_DebugVASLog);
+    m_VASBudgetEnabled = getBool("VASBudgetEnabled", m_VASBudgetEnabled);
     m_LazyScopeRearMirrorRTT = getBool("LazyScopeRearMirrorRTT", m_LazyScopeRearMirrorRTT);
     if (!prevVASLog && m_DebugVASLog)
         LogVAS("DebugVASLog enabled");
+    // Engine console spew rules: SpewFilter1..N = suppress:<text> | redirect:<text> | ratelimit/<n>:<text>
+    {
+        std::vector<SpewRule> spewRules;
+        for (int i = 1; i <= SpewFilter::kMaxConfigRules; ++i)
+        {
+            const std::string key = "SpewFilter" + std::to_string(i);
+            const std::string spec = getString(key.c_str(), "");
+            if (spec.empty())
+                continue;
+            SpewRule rule;
+            if (SpewFilter::ParseRule(spec, rule))
+                spewRules.push_back(std::move(rule));
+            else
+                Game::logMsg("[Spew] ignoring %s=%s (expected suppress:, redirect: or ratelimit/<n>:)", key.c_str(), spec.c_str());
+        }
+        Game::ConfigureSpewFilter(spewRules);
+    }
     const bool prevAutoMatQueueMode = m_AutoMatQueueMode;
     m_AutoMatQueueMode = getBool("AutoMatQueueMode", m_AutoMatQueueMode);
     if (m_AutoMatQueueMode != prevAutoMatQueueMode)
@@ -1157,6 +1070,10 @@ void VR::ParseConfigFile()
     m_QueuedViewmodelStabilizeDebugLogHz = std::max(0.0f, getFloat("QueuedViewmodelStabilizeDebugLogHz", m_QueuedViewmodelStabilizeDebugLogHz));
     m_RenderPipelineDebugLog = getBool("RenderPipelineDebugLog", m_RenderPipelineDebugLog);
     m_RenderPipelineDebugLogHz = std::clamp(getFloat("RenderPipelineDebugLogHz", m_RenderPipelineDebugLogHz), 0.0f, 60.0f);
+    m_OverlayCacheDebugLog = getBool("OverlayCacheDebugLog", m_OverlayCacheDebugLog);
+    m_StereoVisibilityReuse = getBool("StereoVisibilityReuse", m_StereoVisibilityReuse);
+    m_StereoVisibilityDebugLog = getBool("StereoVisibilityDebugLog", m_StereoVisibilityDebugLog);
+    m_StereoVisibilityDebugLogHz = std::clamp(getFloat("StereoVisibilityDebugLogHz", m_StereoVisibilityDebugLogHz), 0.0f, 60.0f);
 
     // Bullet FX alignment: fine-tune client-side tracer/impact visuals.
     // Units: meters in aim-ray space (X=forward, Y=right, Z=up). Visual-only.
@@ -1300,6 +1217,60 @@ void VR::ParseConfigFile()
     m_RearMirrorFov = std::clamp(getFloat("RearMirrorFov", m_RearMirrorFov), 1.0f, 179.0f);
     m_RearMirrorZNear = std::clamp(getFloat("RearMirrorZNear", m_RearMirrorZNear), 0.1f, 64.0f);
 
+    // Optics RTT scheduling (shared by scope + rear mirror)
+    m_OpticsRTTAdaptive = getBool("OpticsRTTAdaptive", m_OpticsRTTAdaptive);
+    m_OpticsRTTInterleave = getBool("OpticsRTTInterleave", m_OpticsRTTInterleave);
+    m_ScopeRTTMinHz = std::clamp(getFloat("ScopeRTTMinHz", m_ScopeRTTMinHz), 0.5f, 240.0f);
+    m_RearMirrorRTTMinHz = std::clamp(getFloat("RearMirrorRTTMinHz", m_RearMirrorRTTMinHz), 0.5f, 240.0f);
+    m_OpticsRTTFullRateAngleDeg = std::clamp(getFloat("OpticsRTTFullRateAngleDeg", m_OpticsRTTFullRateAngleDeg), 0.1f, 90.0f);
+    m_OpticsRTTFullRateDistance = std::clamp(getFloat("OpticsRTTFullRateDistance", m_OpticsRTTFullRateDistance), 0.1f, 256.0f);
+    m_OpticsRTTDebugLog = getBool("OpticsRTTDebugLog", m_OpticsRTTDebugLog);
+    m_OpticsRTTDebugLogHz = std::clamp(getFloat("OpticsRTTDebugLogHz", m_OpticsRTTDebugLogHz), 0.0f, 10.0f);
+    m_OpticsRTTSettingsDirty.store(true, std::memory_order_release);
+
+    // Optics render profiles (what the scope / mirror passes skip)
+    m_OpticsRTTProfilesEnabled = getBool("OpticsRTTProfilesEnabled", m_OpticsRTTProfilesEnabled);
+    m_OpticsRTTProfileABTest = getBool("OpticsRTTProfileABTest", m_OpticsRTTProfileABTest);
+    m_ScopeRTTDrawHud = getBool("ScopeRTTDrawHud", m_ScopeRTTDrawHud);
+    m_ScopeRTTDrawViewmodel = getBool("ScopeRTTDrawViewmodel", m_ScopeRTTDrawViewmodel);
+    m_ScopeRTTFarZ = std::clamp(getFloat("ScopeRTTFarZ", m_ScopeRTTFarZ), 0.0f, 65536.0f);
+    m_ScopeRTTLod = std::clamp(getInt("ScopeRTTLod", m_ScopeRTTLod), -1, 7);
+    m_ScopeRTTDetailProps = getBool("ScopeRTTDetailProps", m_ScopeRTTDetailProps);
+    m_ScopeRTTParticles = getBool("ScopeRTTParticles", m_ScopeRTTParticles);
+    m_ScopeRTTShadows = getBool("ScopeRTTShadows", m_ScopeRTTShadows);
+    m_RearMirrorRTTDrawHud = getBool("RearMirrorRTTDrawHud", m_RearMirrorRTTDrawHud);
+    m_RearMirrorRTTDrawViewmodel = getBool("RearMirrorRTTDrawViewmodel", m_RearMirrorRTTDrawViewmodel);
+    m_RearMirrorRTTFarZ = std::clamp(getFloat("RearMirrorRTTFarZ", m_RearMirrorRTTFarZ), 0.0f, 65536.0f);
+    m_RearMirrorRTTLod = std::clamp(getInt("RearMirrorRTTLod", m_RearMirrorRTTLod), -1, 7);
+    m_RearMirrorRTTDetailProps = getBool("RearMirrorRTTDetailProps", m_RearMirrorRTTDetailProps);
+    m_RearMirrorRTTParticles = getBool("RearMirrorRTTParticles", m_RearMirrorRTTParticles);
+    m_RearMirrorRTTShadows = getBool("RearMirrorRTTShadows", m_RearMirrorRTTShadows);
+    {
+        OpticsRenderProfileSet profiles;
+        profiles.enabled = m_OpticsRTTProfilesEnabled;
+        profiles.abTest = m_OpticsRTTProfileABTest;
+
+        OpticsRenderProfile& scope = profiles.profiles[OpticsRTTScheduler::Pass_Scope];
+        scope.drawHud = m_ScopeRTTDrawHud;
+        scope.drawViewmodel = m_ScopeRTTDrawViewmodel;
+        scope.farZ = m_ScopeRTTFarZ;
+        scope.lod = m_ScopeRTTLod;
+        scope.detailProps = m_ScopeRTTDetailProps;
+        scope.particles = m_ScopeRTTParticles;
+        scope.shadows = m_ScopeRTTShadows;
+
+        OpticsRenderProfile& mirror = profiles.profiles[OpticsRTTScheduler::Pass_RearMirror];
+        mirror.drawHud = m_RearMirrorRTTDrawHud;
+        mirror.drawViewmodel = m_RearMirrorRTTDrawViewmodel;
+        mirror.farZ = m_RearMirrorRTTFarZ;
+        mirror.lod = m_RearMirrorRTTLod;
+        mirror.detailProps = m_RearMirrorRTTDetailProps;
+        mirror.particles = m_RearMirrorRTTParticles;
+        mirror.shadows = m_RearMirrorRTTShadows;
+
+        m_OpticsRenderProfileMailbox.Publish(profiles);
+    }
+
     m_RearMirrorCameraOffset = getVector3("RearMirrorCameraOffset", m_RearMirrorCameraOffset);
     {
         Vector tmp = getVector3(
@@ -1345,6 +1316,24 @@ void VR::ParseConfigFile()
         0.0f, 1.0f);
 
     m_ForceNonVRServerMovement = getBool("ForceNonVRServerMovement", m_ForceNonVRServerMovement);
+    m_UsercmdPayloadVersion = std::clamp(getInt("VRUsercmdPayloadVersion", m_UsercmdPayloadVersion), 1, VRCmdPayloadCodec::kVersion);
+    m_UsercmdPayloadDebugLog = getBool("VRUsercmdPayloadDebugLog", m_UsercmdPayloadDebugLog);
+    m_MeleeSweepAdaptive = getBool("MeleeSweepAdaptive", m_MeleeSweepAdaptive);
+    m_MeleeSweepBroadPhase = getBool("MeleeSweepBroadPhase", m_MeleeSweepBroadPhase);
+    m_MeleeSweepReach = std::clamp(getFloat("MeleeSweepReach", m_MeleeSweepReach), 16.0f, 256.0f);
+    m_MeleeSweepSampleSpacing = std::clamp(getFloat("MeleeSweepSampleSpacing", m_MeleeSweepSampleSpacing), 2.0f, 64.0f);
+    m_MeleeSweepMaxSamples = std::clamp(getInt("MeleeSweepMaxSamples", m_MeleeSweepMaxSamples), 1, 32);
+    m_MeleeSweepMinAngleDeg = std::clamp(getFloat("MeleeSweepMinAngle", m_MeleeSweepMinAngleDeg), 0.0f, 20.0f);
+    m_MeleeSweepCandidateRadius = std::clamp(getFloat("MeleeSweepCandidateRadius", m_MeleeSweepCandidateRadius), 8.0f, 128.0f);
+    m_MeleeSweepDebugLog = getBool("MeleeSweepDebugLog", m_MeleeSweepDebugLog);
+    m_ServerShotPoseLagTicks = std::clamp(getFloat("ServerShotPoseLagTicks", m_ServerShotPoseLagTicks), -1.0f, 8.0f);
+    m_AimQueryDedup = getBool("AimQueryDedup", m_AimQueryDedup);
+    m_AimQueryDebugLog = getBool("AimQueryDebugLog", m_AimQueryDebugLog);
+    m_EntityGridEnabled = getBool("EntityGrid", m_EntityGridEnabled);
+    m_EntityGridCellSize = std::clamp(getFloat("EntityGridCellSize", m_EntityGridCellSize), 64.0f, 2048.0f);
+    m_EntityGridMaxHz = std::clamp(getFloat("EntityGridMaxHz", m_EntityGridMaxHz), 0.0f, 240.0f);
+    m_EntityGridMaxLosTraces = std::clamp(getInt("EntityGridMaxLosTraces", m_EntityGridMaxLosTraces), 1, 32);
+    m_EntityGridPendingCellSize.store(m_EntityGridCellSize, std::memory_order_relaxed);
 
     // Non-VR server movement: make client-side bullet/muzzle effects originate from controller (visual-only).
     m_NonVRServerMovementEffectsFromController = getBool("NonVRServerMovementEffectsFromController", m_NonVRServerMovementEffectsFromController);
@@ -1362,6 +1351,7 @@ void VR::ParseConfigFile()
     m_Roomscale1To1AllowedCameraDriftMeters = std::max(0.0f, getFloat("Roomscale1To1AllowedCameraDriftMeters", m_Roomscale1To1AllowedCameraDriftMeters));
     m_Roomscale1To1ChaseHysteresisMeters = std::max(0.0f, getFloat("Roomscale1To1ChaseHysteresisMeters", m_Roomscale1To1ChaseHysteresisMeters));
     m_Roomscale1To1MinApplyMeters = std::max(0.0f, getFloat("Roomscale1To1MinApplyMeters", m_Roomscale1To1MinApplyMeters));
+    m_Roomscale1To1ServerSmoothFrames = std::clamp(getInt("Roomscale1To1ServerSmoothFrames", m_Roomscale1To1ServerSmoothFrames), 1, 8);
     m_Roomscale1To1ChaseActive = false;
 
     // Mouse mode (desktop-style aiming while staying in VR rendering)
@@ -1538,6 +1528,9 @@ void VR::ParseConfigFile()
     m_ShadowCvarNbShadowBlobbyDist = std::clamp(getFloat("nb_shadow_blobby_dist", m_ShadowCvarNbShadowBlobbyDist), 0.0f, 8192.0f);
     m_ShadowCvarNbShadowCullDist = std::clamp(getFloat("nb_shadow_cull_dist", m_ShadowCvarNbShadowCullDist), 0.0f, 8192.0f);
     m_ShadowCvarFlashlightInfectedShadows = std::clamp(getInt("r_flashlightinfectedshadows", m_ShadowCvarFlashlightInfectedShadows), 0, 1);
+    m_ShadowQualityGovernorEnabled = getBool("ShadowQualityGovernorEnabled", m_ShadowQualityGovernorEnabled);
+    m_ShadowQualityGovernorTiers = std::clamp(getInt("ShadowQualityGovernorTiers", m_ShadowQualityGovernorTiers), 2, ShadowQualityGovernor::kMaxTiers);
+    m_ShadowQualityGovernorReset.store(true, std::memory_order_release);
     m_ShadowEntityTweaksEnabled = getBool("ShadowEntityTweaksEnabled", m_ShadowEntityTweaksEnabled);
     m_ShadowEntityDisableShadows = getBool("ShadowControlDisableShadows", m_ShadowEntityDisableShadows);
     m_ShadowEntityMaxDist = std::clamp(getFloat("ShadowControlMaxDist", m_ShadowEntityMaxDist), 0.0f, 8192.0f);
@@ -1844,6 +1837,56 @@ void VR::ApplyShadowEntityOverrides(bool forceRefresh)
     }
 }
 
+void VR::UpdateShadowQualityGovernor()
+{
+    // A reparse only resets the governor when the top tier or tier count actually changed.
+    if (m_ShadowQualityGovernorReset.exchange(false, std::memory_order_acq_rel))
+    {
+        ShadowQualityTier top;
+        top.flashlightDepthRes = m_ShadowCvarFlashlightDepthRes;
+        top.maxRendered = m_ShadowCvarMaxRendered;
+        top.maxRenderableDist = m_ShadowCvarMaxRenderableDist;
+        top.infectedShadows = m_ShadowCvarInfectedShadows;
+        top.flashlightInfectedShadows = m_ShadowCvarFlashlightInfectedShadows;
+        if (m_ShadowQualityGovernor.Configure(top, m_ShadowQualityGovernorTiers, ShadowGovernorSettings{}))
+        {
+            m_ShadowQualityGovernorLastFrameIndex = 0;
+            Game::logMsg("[VR] Shadow quality tiers rebuilt (%d tiers), back to the top tier", m_ShadowQualityGovernor.GetTierCount());
+            m_ShadowSettingsDirty.store(true, std::memory_order_release);
+        }
+    }
+
+    if (!m_ShadowQualityGovernorEnabled || !m_ShadowTweaksEnabled || !m_IsVREnabled || !m_Compositor)
+        return;
+
+    vr::Compositor_FrameTiming timing{};
+    timing.m_nSize = sizeof(timing);
+    if (!m_Compositor->GetFrameTiming(&timing, 0) || timing.m_nFrameIndex == 0 ||
+        timing.m_nFrameIndex == m_ShadowQualityGovernorLastFrameIndex)
+    {
+        return;
+    }
+    m_ShadowQualityGovernorLastFrameIndex = timing.m_nFrameIndex;
+
+    const float hz = GetHmdDisplayFrequencyHz();
+    if (hz <= 0.0f)
+        return;
+
+    // App CPU time is poses-ready to frame-ready; the GPU side is the total render time.
+    const float cpuMs = (std::max)(0.0f, timing.m_flNewFrameReadyMs - timing.m_flNewPosesReadyMs);
+    const bool missed = timing.m_nNumDroppedFrames > 0 || timing.m_nNumMisPresented > 0;
+    const int step = m_ShadowQualityGovernor.Feed(SteadySeconds(std::chrono::steady_clock::now()),
+        cpuMs, timing.m_flTotalRenderGpuMs, 1000.0f / hz, missed);
+    if (step == 0)
+        return;
+
+    const ShadowQualityTier& tier = m_ShadowQualityGovernor.GetTier();
+    Game::logMsg("[VR] Shadow quality %s to tier %d/%d (depthres %d, maxrendered %d, dist %.0f, infected %d)",
+        step < 0 ? "down" : "up", m_ShadowQualityGovernor.GetTierIndex(), m_ShadowQualityGovernor.GetTierCount() - 1,
+        tier.flashlightDepthRes, tier.maxRendered, tier.maxRenderableDist, tier.infectedShadows);
+    m_ShadowSettingsDirty.store(true, std::memory_order_release);
+}
+
 void VR::ApplyShadowSettingsIfNeeded()
 {
     const bool dirty = m_ShadowSettingsDirty.exchange(false, std::memory_order_acq_rel);
@@ -1896,13 +1939,23 @@ void VR::ApplyShadowSettingsIfNeeded()
             }
         };
 
+    // With the governor on, its current tier replaces the configured quality knobs.
+    ShadowQualityTier quality;
+    quality.flashlightDepthRes = m_ShadowCvarFlashlightDepthRes;
+    quality.maxRendered = m_ShadowCvarMaxRendered;
+    quality.maxRenderableDist = m_ShadowCvarMaxRenderableDist;
+    quality.infectedShadows = m_ShadowCvarInfectedShadows;
+    quality.flashlightInfectedShadows = m_ShadowCvarFlashlightInfectedShadows;
+    if (m_ShadowQualityGovernorEnabled && m_ShadowQualityGovernor.GetTierCount() > 0)
+        quality = m_ShadowQualityGovernor.GetTier();
+
     applyInt("r_shadows", m_ShadowCvarShadows);
     applyInt("r_shadowrendertotexture", m_ShadowCvarRenderToTexture);
     applyInt("r_flashlightdepthtexture", m_ShadowCvarFlashlightDepthTexture);
-    applyInt("r_flashlightdepthres", m_ShadowCvarFlashlightDepthRes);
+    applyInt("r_flashlightdepthres", quality.flashlightDepthRes);
     applyInt("r_shadow_half_update_rate", m_ShadowCvarHalfUpdateRate);
-    applyInt("r_shadowmaxrendered", m_ShadowCvarMaxRendered);
-    if (m_Game->SetConVarFloat("cl_max_shadow_renderable_dist", m_ShadowCvarMaxRenderableDist))
+    applyInt("r_shadowmaxrendered", quality.maxRendered);
+    if (m_Game->SetConVarFloat("cl_max_shadow_renderable_dist", quality.maxRenderableDist))
     {
         ++appliedCount;
         protectedConvars.insert("cl_max_shadow_renderable_dist");
@@ -1918,7 +1971,7 @@ void VR::ApplyShadowSettingsIfNeeded()
         ++appliedCount;
         protectedConvars.insert("cl_player_shadow_dist");
     }
-    applyInt("z_infected_shadows", m_ShadowCvarInfectedShadows);
+    applyInt("z_infected_shadows", quality.infectedShadows);
     if (m_Game->SetConVarFloat("nb_shadow_blobby_dist", m_ShadowCvarNbShadowBlobbyDist))
     {
         ++appliedCount;
@@ -1929,7 +1982,7 @@ void VR::ApplyShadowSettingsIfNeeded()
         ++appliedCount;
         protectedConvars.insert("nb_shadow_cull_dist");
     }
-    applyInt("r_flashlightinfectedshadows", m_ShadowCvarFlashlightInfectedShadows);
+    applyInt("r_flashlightinfectedshadows", quality.flashlightInfectedShadows);
 
     m_ShadowTweaksApplied = (appliedCount > 0);
     {
@@ -2864,6 +2917,7 @@ void VR::WaitForConfigUpdate()
         if (!GetFileAttributesExA("VR\\config.txt", GetFileExInfoStandard, &fileAttributes))
         {
             m_Game->errorMsg("config.txt not found.");
+            m_ConfigInitialPassDone.store(true, std::memory_order_release);
             return;
         }
 
@@ -2922,6 +2976,7 @@ void VR::WaitForConfigUpdate()
             }
         }
 
+        m_ConfigInitialPassDone.store(true, std::memory_order_release);
         FindNextChangeNotification(fileChangeHandle);
         WaitForSingleObject(fileChangeHandle, INFINITE);
         Sleep(100); // Sometimes the thread tries to read config.txt before it's finished writing
@@ -0,0 +1,381 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "vr_usercmd_payload.h"
+
+// ------------------------------------------------------------
+// Server-side VR pose history, one ring of timestamped samples per player.
+//
+// Game::m_PlayersVRInfo only holds the newest decoded pose, so anything evaluated while the server
+// runs a player's queued commands sees the pose of the last command read, not the one being run.
+// This store keeps the last HistorySize samples per player, keyed by command number and client tick
+// (CUserCmd::tick_count, the same clock lag compensation uses), and answers:
+//  - Latest / FindCommand / NextAfter: exact samples,
+//  - SampleAtTick: interpolated pose at a fractional tick (clamped to the recorded range),
+//  - BeginBatch / EndBatch / MeasuredLagTicks: how far behind the newest command read the commands
+//    of the current batch are, on average (commands arrive in batches and run after the whole batch).
+//
+// Layout is structure-of-arrays: every field is its own [player][slot] array, so a query's binary
+// search only touches the player's tick row (HistorySize ints) and the pose arrays are read for two slots.
+// Storage is one allocation made by the constructor; Push / queries never allocate.
+// Written from the server thread (ReadUsercmd) and read from the same thread (command execution).
+// ------------------------------------------------------------
+
+enum VRServerSampleFlags : uint8_t
+{
+	VRServerSample_Melee = 1 << 0,
+	VRServerSample_Relative = 1 << 1   // positions are offsets from the player origin (payload v2)
+};
+
+struct VRServerStateSample
+{
+	int commandNumber = 0;
+	int tick = 0;
+	uint8_t flags = 0;
+	VRCmdPoseSample pose[VRCmdPose_Count];
+};
+
+template <size_t MaxPlayers, size_t HistorySize = 32>
+class VRServerStateStore
+{
+	static_assert(HistorySize >= 2 && (HistorySize & (HistorySize - 1)) == 0, "HistorySize must be a power of two");
+
+public:
+	// A command number this far behind the newest sample means the client restarted (reconnect, map
+	// change) rather than resent a backup command; the engine never resends more than a few dozen.
+	static constexpr int kRestartGap = 64;
+
+	struct Counters
+	{
+		uint64_t pushed = 0;
+		uint64_t duplicates = 0;     // backup / resent commands already recorded
+		uint64_t restarts = 0;
+		uint64_t batches = 0;
+	};
+
+	VRServerStateStore()
+		: m_Tick(MaxPlayers * HistorySize, 0),
+		m_Command(MaxPlayers * HistorySize, 0),
+		m_Flags(MaxPlayers * HistorySize, 0),
+		m_Valid(VRCmdPose_Count * MaxPlayers * HistorySize, 0),
+		m_Pos(VRCmdPose_Count * MaxPlayers * HistorySize * 3, 0.0f),
+		m_Quat(VRCmdPose_Count * MaxPlayers * HistorySize * 4, 0.0f)
+	{
+		ResetAll();
+	}
+
+	static constexpr size_t GetMaxPlayers() { return MaxPlayers; }
+	static constexpr size_t GetHistorySize() { return HistorySize; }
+
+	// Records a sample. Commands at or behind the newest recorded one are dropped (the engine re-reads
+	// backup commands after packet loss), unless far enough behind to be a client restart.
+	bool Push(int player, const VRServerStateSample& s)
+	{
+		if (!ValidPlayer(player))
+			return false;
+
+		const size_t p = static_cast<size_t>(player);
+		if (m_Count[p] > 0)
+		{
+			const size_t newest = Index(p, NewestSlot(p));
+			if (s.commandNumber <= m_Command[newest])
+			{
+				if (m_Command[newest] - s.commandNumber < kRestartGap)
+				{
+					++m_Counters.duplicates;
+					return false;
+				}
+				Reset(player);
+				++m_Counters.restarts;
+			}
+			else if (s.tick < m_Tick[newest])
+			{
+				// Ticks must stay sorted for SampleAtTick; a newer command never has an older tick
+				// unless the client's clock was reset.
+				Reset(player);
+				++m_Counters.restarts;
+			}
+		}
+
+		const uint32_t slot = m_Head[p];
+		const size_t i = Index(p, slot);
+		m_Tick[i] = s.tick;
+		m_Command[i] = s.commandNumber;
+		m_Flags[i] = s.flags;
+		for (int k = 0; k < VRCmdPose_Count; ++k)
+		{
+			const size_t pi = PoseIndex(k, p, slot);
+			const VRCmdPoseSample& pose = s.pose[k];
+			m_Valid[pi] = pose.valid ? 1 : 0;
+			std::copy(pose.pos, pose.pos + 3, &m_Pos[pi * 3]);
+			std::copy(pose.quat, pose.quat + 4, &m_Quat[pi * 4]);
+		}
+
+		m_Head[p] = (slot + 1) & kMask;
+		m_Count[p] = std::min<uint32_t>(m_Count[p] + 1, static_cast<uint32_t>(HistorySize));
+		++m_Counters.pushed;
+		return true;
+	}
+
+	void Reset(int player)
+	{
+		if (!ValidPlayer(player))
+			return;
+		m_Head[player] = 0;
+		m_Count[player] = 0;
+		m_BatchStart[player] = 0;
+		m_LagTicks[player] = -1.0f;
+	}
+
+	void ResetAll()
+	{
+		std::fill(m_Head, m_Head + MaxPlayers, 0u);
+		std::fill(m_Count, m_Count + MaxPlayers, 0u);
+		std::fill(m_BatchStart, m_BatchStart + MaxPlayers, 0);
+		std::fill(m_LagTicks, m_LagTicks + MaxPlayers, -1.0f);
+	}
+
+	size_t Count(int player) const { return ValidPlayer(player) ? m_Count[player] : 0; }
+
+	bool Latest(int player, VRServerStateSample& out) const
+	{
+		if (!ValidPlayer(player) || m_Count[player] == 0)
+			return false;
+		Read(static_cast<size_t>(player), NewestSlot(static_cast<size_t>(player)), out);
+		return true;
+	}
+
+	// Tick of the newest sample; false when the player has no samples.
+	bool LatestTick(int player, int& outTick) const
+	{
+		if (!ValidPlayer(player) || m_Count[player] == 0)
+			return false;
+		outTick = m_Tick[Index(static_cast<size_t>(player), NewestSlot(static_cast<size_t>(player)))];
+		return true;
+	}
+
+	bool FindCommand(int player, int commandNumber, VRServerStateSample& out) const
+	{
+		if (!ValidPlayer(player))
+			return false;
+		const size_t p = static_cast<size_t>(player);
+		// Command numbers are consecutive in practice, so guess the slot first.
+		const uint32_t count = m_Count[p];
+		if (count == 0)
+			return false;
+		const int newestCmd = m_Command[Index(p, NewestSlot(p))];
+		const int back = newestCmd - commandNumber;
+		if (back >= 0 && static_cast<uint32_t>(back) < count)
+		{
+			const uint32_t guess = (m_Head[p] + kMask - static_cast<uint32_t>(back)) & kMask;
+			if (m_Command[Index(p, guess)] == commandNumber)
+			{
+				Read(p, guess, out);
+				return true;
+			}
+		}
+		for (uint32_t n = 0; n < count; ++n)
+		{
+			const uint32_t slot = ChronoSlot(p, n);
+			if (m_Command[Index(p, slot)] == commandNumber)
+			{
+				Read(p, slot, out);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Chronologically first sample with a command number above commandNumber (0 = the oldest).
+	bool NextAfter(int player, int commandNumber, VRServerStateSample& out) const
+	{
+		if (!ValidPlayer(player))
+			return false;
+		const size_t p = static_cast<size_t>(player);
+		const uint32_t count = m_Count[p];
+		if (count == 0 || m_Command[Index(p, NewestSlot(p))] <= commandNumber)
+			return false;
+
+		uint32_t lo = 0;
+		uint32_t hi = count - 1;
+		while (lo < hi)
+		{
+			const uint32_t mid = (lo + hi) >> 1;
+			if (m_Command[Index(p, ChronoSlot(p, mid))] <= commandNumber)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		Read(p, ChronoSlot(p, lo), out);
+		return true;
+	}
+
+	// ProcessUsercmds brackets: the commands read in between are one batch, run by the server after
+	// the whole batch was read. A shot in any of them sees the newest pose unless it is rewound; the
+	// batch's average distance from the newest tick becomes the player's measured lag. The batch that
+	// just ended is the one about to run, so its own lag beats any average over earlier batches.
+	void BeginBatch(int player)
+	{
+		if (!ValidPlayer(player))
+			return;
+		const size_t p = static_cast<size_t>(player);
+		m_BatchStart[p] = (m_Count[p] > 0) ? m_Command[Index(p, NewestSlot(p))] : 0;
+	}
+
+	// Returns the number of new commands in the batch.
+	int EndBatch(int player)
+	{
+		if (!ValidPlayer(player))
+			return 0;
+		const size_t p = static_cast<size_t>(player);
+		const uint32_t count = m_Count[p];
+		int commands = 0;
+		int64_t tickSum = 0;
+		for (uint32_t n = count; n-- > 0;)
+		{
+			const size_t i = Index(p, ChronoSlot(p, n));
+			if (m_Command[i] <= m_BatchStart[p])
+				break;
+			++commands;
+			tickSum += m_Tick[i];
+		}
+		if (commands == 0)
+			return 0;
+
+		const float newestTick = static_cast<float>(m_Tick[Index(p, NewestSlot(p))]);
+		const float lag = newestTick - static_cast<float>(tickSum) / static_cast<float>(commands);
+		m_LagTicks[p] = lag;
+		++m_Counters.batches;
+		return commands;
+	}
+
+	// Average ticks between the newest command and the commands of the last batch; -1 before the first.
+	float MeasuredLagTicks(int player) const { return ValidPlayer(player) ? m_LagTicks[player] : -1.0f; }
+
+	// Pose at a (fractional) tick. Positions are lerped, rotations nlerped along the shorter arc.
+	// Outside the recorded range the oldest / newest sample is returned unchanged. A pose slot is only
+	// valid if both bracketing samples have it; flags and command number come from the later sample.
+	bool SampleAtTick(int player, float tick, VRServerStateSample& out) const
+	{
+		if (!ValidPlayer(player) || !std::isfinite(tick))
+			return false;
+		const size_t p = static_cast<size_t>(player);
+		const uint32_t count = m_Count[p];
+		if (count == 0)
+			return false;
+
+		// First chronological sample with tick > query.
+		uint32_t lo = 0;
+		uint32_t hi = count;
+		while (lo < hi)
+		{
+			const uint32_t mid = (lo + hi) >> 1;
+			if (static_cast<float>(m_Tick[Index(p, ChronoSlot(p, mid))]) <= tick)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		if (lo == 0)
+		{
+			Read(p, ChronoSlot(p, 0), out);
+			return true;
+		}
+		if (lo == count)
+		{
+			Read(p, ChronoSlot(p, count - 1), out);
+			return true;
+		}
+
+		const uint32_t a = ChronoSlot(p, lo - 1);
+		const uint32_t b = ChronoSlot(p, lo);
+		const float ta = static_cast<float>(m_Tick[Index(p, a)]);
+		const float tb = static_cast<float>(m_Tick[Index(p, b)]);
+		const float t = (tb > ta) ? std::clamp((tick - ta) / (tb - ta), 0.0f, 1.0f) : 1.0f;
+
+		Read(p, b, out);
+		out.tick = static_cast<int>(std::floor(tick));
+		for (int k = 0; k < VRCmdPose_Count; ++k)
+		{
+			const size_t ia = PoseIndex(k, p, a);
+			const size_t ib = PoseIndex(k, p, b);
+			VRCmdPoseSample& pose = out.pose[k];
+			pose.valid = m_Valid[ia] && m_Valid[ib];
+			if (!pose.valid)
+				continue;
+			for (int c = 0; c < 3; ++c)
+				pose.pos[c] = m_Pos[ia * 3 + c] + (m_Pos[ib * 3 + c] - m_Pos[ia * 3 + c]) * t;
+			Nlerp(&m_Quat[ia * 4], &m_Quat[ib * 4], t, pose.quat);
+		}
+		return true;
+	}
+
+	const Counters& GetCounters() const { return m_Counters; }
+
+	static void Nlerp(const float* a, const float* b, float t, float out[4])
+	{
+		const float dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+		const float sign = (dot < 0.0f) ? -1.0f : 1.0f;
+		float len2 = 0.0f;
+		for (int c = 0; c < 4; ++c)
+		{
+			out[c] = a[c] + (b[c] * sign - a[c]) * t;
+			len2 += out[c] * out[c];
+		}
+		if (len2 > 1e-12f)
+		{
+			const float inv = 1.0f / std::sqrt(len2);
+			for (int c = 0; c < 4; ++c)
+				out[c] *= inv;
+		}
+		else
+		{
+			std::copy(b, b + 4, out);
+		}
+	}
+
+private:
+	static constexpr uint32_t kMask = static_cast<uint32_t>(HistorySize - 1);
+
+	static bool ValidPlayer(int player) { return player >= 0 && static_cast<size_t>(player) < MaxPlayers; }
+	static size_t Index(size_t player, uint32_t slot) { return player * HistorySize + slot; }
+	static size_t PoseIndex(int pose, size_t player, uint32_t slot)
+	{
+		return (static_cast<size_t>(pose) * MaxPlayers + player) * HistorySize + slot;
+	}
+
+	uint32_t NewestSlot(size_t p) const { return (m_Head[p] + kMask) & kMask; }
+	// n-th sample from the oldest.
+	uint32_t ChronoSlot(size_t p, uint32_t n) const { return (m_Head[p] + static_cast<uint32_t>(HistorySize) - m_Count[p] + n) & kMask; }
+
+	void Read(size_t p, uint32_t slot, VRServerStateSample& out) const
+	{
+		const size_t i = Index(p, slot);
+		out.tick = m_Tick[i];
+		out.commandNumber = m_Command[i];
+		out.flags = m_Flags[i];
+		for (int k = 0; k < VRCmdPose_Count; ++k)
+		{
+			const size_t pi = PoseIndex(k, p, slot);
+			VRCmdPoseSample& pose = out.pose[k];
+			pose.valid = m_Valid[pi] != 0;
+			std::copy(&m_Pos[pi * 3], &m_Pos[pi * 3] + 3, pose.pos);
+			std::copy(&m_Quat[pi * 4], &m_Quat[pi * 4] + 4, pose.quat);
+		}
+	}
+
+	std::vector<int32_t> m_Tick;
+	std::vector<int32_t> m_Command;
+	std::vector<uint8_t> m_Flags;
+	std::vector<uint8_t> m_Valid;
+	std::vector<float> m_Pos;
+	std::vector<float> m_Quat;
+	uint32_t m_Head[MaxPlayers];    // next slot to write
+	uint32_t m_Count[MaxPlayers];
+	int32_t m_BatchStart[MaxPlayers];   // newest command number before the current batch
+	float m_LagTicks[MaxPlayers];
+	Counters m_Counters{};
+};
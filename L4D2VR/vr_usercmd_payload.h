@@ -0,0 +1,602 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// ------------------------------------------------------------
+// Compact VR payload carried inside CUserCmd (payload version 2).
+//
+// Version 1 (legacy) put right controller angles x10 in mousedx/mousedy, roll in command_number and
+// position in viewangles.z / upmove / viewangles.x (packed with pitch), so it lost precision, overflowed
+// past +-21474 units and had no room for the left hand or HMD.
+//
+// Version 2 bit-packs all three tracked poses:
+//  - rotation: smallest-three quaternion (2-bit index + 3 x 12-bit components, ~0.02 deg mean /
+//    ~0.05 deg worst-case aim error; 9 bits measured 0.13 / 0.40 deg, worse than the legacy x10 angles),
+//  - position: 10-bit fixed point per axis (0.25 units) relative to the player's origin,
+//  - each pose is sent absolute, as a delta against the reference state (the payload of the `from`
+//    command both ends already decoded), omitted when unchanged / out of budget, or marked
+//    unavailable (tracking lost, or a position outside the fixed-point range: the server then falls
+//    back to the player's own eye / aim instead of a clamped hand position).
+// Carrier: viewangles.z and upmove hold 29 bits each (always a positive normal float, so the engine's
+// field delta compare and float copies can't alter it), mousedx/mousedy hold 16 bits each: 90 bits.
+// viewangles.x, command_number and the buttons high bits (roomscale 1:1, bits 26..31) are untouched.
+//
+// No engine / Windows dependencies: the hooks translate CUserCmd fields to / from VRCmdCarrier.
+// ------------------------------------------------------------
+
+enum VRCmdPoseSlot
+{
+	VRCmdPose_RightHand = 0,
+	VRCmdPose_LeftHand,
+	VRCmdPose_Hmd,
+	VRCmdPose_Count
+};
+
+// Unquantized pose. pos is relative to the player origin (game units), quat is (x, y, z, w).
+struct VRCmdPoseSample
+{
+	bool valid = false;
+	float pos[3] = { 0.0f, 0.0f, 0.0f };
+	float quat[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+};
+
+struct VRCmdQuantizedPose
+{
+	uint8_t largest = 3;            // index of the dropped (largest) quaternion component
+	int16_t rot[3] = { 0, 0, 0 };   // the other three, in kRotBits signed fixed point
+	int16_t pos[3] = { 0, 0, 0 };   // kPosBits signed fixed point, z biased by kPosZBias
+
+	bool operator==(const VRCmdQuantizedPose& o) const
+	{
+		return largest == o.largest
+			&& rot[0] == o.rot[0] && rot[1] == o.rot[1] && rot[2] == o.rot[2]
+			&& pos[0] == o.pos[0] && pos[1] == o.pos[1] && pos[2] == o.pos[2];
+	}
+	bool operator!=(const VRCmdQuantizedPose& o) const { return !(*this == o); }
+};
+
+// What the decoder knows after a command: the reference for the next command's deltas.
+struct VRCmdPayloadState
+{
+	std::array<bool, VRCmdPose_Count> valid{};
+	std::array<VRCmdQuantizedPose, VRCmdPose_Count> pose{};
+};
+
+// Raw CUserCmd field bits.
+struct VRCmdCarrier
+{
+	uint32_t viewZBits = 0;   // CUserCmd::viewangles.z reinterpreted
+	uint32_t upmoveBits = 0;  // CUserCmd::upmove reinterpreted
+	int16_t mouseDx = 0;
+	int16_t mouseDy = 0;
+};
+
+struct VRCmdEncodeResult
+{
+	int bitsUsed = 0;
+	uint8_t sentMask = 0;         // poses written (absolute, delta or unavailable)
+	uint8_t droppedMask = 0;      // poses that changed but didn't fit this command
+	uint8_t outOfRangeMask = 0;   // valid poses whose position doesn't fit kPosBits (sent as unavailable)
+};
+
+class VRCmdPayloadCodec
+{
+public:
+	static constexpr int kVersion = 2;
+	static constexpr int kVersionBits = 3;
+	static constexpr int kFloatCarrierBits = 29;
+	static constexpr int kCapacityBits = kFloatCarrierBits * 2 + 16 * 2;
+
+	static constexpr int kRotBits = 12;
+	static constexpr int kPosBits = 10;
+	static constexpr float kPosStep = 0.25f;
+	static constexpr float kPosZBias = 64.0f;   // z range [-64, 192) around the origin; x/y [-128, 128)
+	static constexpr int kDeltaWidthBits = 4;   // per-pose width of the rot / pos delta fields (0..15)
+	static constexpr int kAbsolutePoseBits = 2 + 3 * kRotBits + 3 * kPosBits;
+	// A delta with both widths 0 never describes a change, so it encodes "pose unavailable".
+	static constexpr int kUnavailablePoseBits = 2 * kDeltaWidthBits;
+
+	// ---- quantization ----
+
+	// outInRange (optional) is false if a position axis had to be clamped to the kPosBits range.
+	static VRCmdQuantizedPose Quantize(const VRCmdPoseSample& sample, bool* outInRange = nullptr)
+	{
+		VRCmdQuantizedPose q;
+		float c[4] = { sample.quat[0], sample.quat[1], sample.quat[2], sample.quat[3] };
+		float len = std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2] + c[3] * c[3]);
+		if (!(len > 1e-6f))
+		{
+			c[0] = c[1] = c[2] = 0.0f;
+			c[3] = len = 1.0f;
+		}
+
+		int largest = 0;
+		for (int i = 1; i < 4; ++i)
+		{
+			if (std::fabs(c[i]) > std::fabs(c[largest]))
+				largest = i;
+		}
+		// q and -q are the same rotation: make the dropped component positive.
+		const float sign = (c[largest] < 0.0f) ? -1.0f : 1.0f;
+		q.largest = static_cast<uint8_t>(largest);
+
+		const int rotMax = (1 << (kRotBits - 1)) - 1;
+		int out = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			if (i == largest)
+				continue;
+			const float v = (c[i] * sign / len) * kSqrt2;   // [-1, 1]
+			q.rot[out++] = static_cast<int16_t>(Clamp(static_cast<int>(std::lround(v * rotMax)), -rotMax, rotMax));
+		}
+
+		const float bias[3] = { 0.0f, 0.0f, kPosZBias };
+		bool inRange = true;
+		for (int i = 0; i < 3; ++i)
+		{
+			const float steps = (sample.pos[i] - bias[i]) / kPosStep;
+			// Compare as float first: lround of a huge / non-finite value is undefined.
+			if (!(steps >= kPosMin - 0.5f && steps < kPosMax + 0.5f))
+			{
+				inRange = false;
+				q.pos[i] = static_cast<int16_t>((steps < 0.0f) ? kPosMin : kPosMax);
+				continue;
+			}
+			q.pos[i] = static_cast<int16_t>(Clamp(static_cast<int>(std::lround(steps)), kPosMin, kPosMax));
+		}
+		if (outInRange)
+			*outInRange = inRange;
+		return q;
+	}
+
+	static VRCmdPoseSample Dequantize(const VRCmdQuantizedPose& q)
+	{
+		VRCmdPoseSample s;
+		s.valid = true;
+
+		const float rotMax = static_cast<float>((1 << (kRotBits - 1)) - 1);
+		float c[4] = {};
+		float sumSq = 0.0f;
+		int in = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			if (i == q.largest)
+				continue;
+			c[i] = (q.rot[in++] / rotMax) / kSqrt2;
+			sumSq += c[i] * c[i];
+		}
+		c[q.largest & 3] = std::sqrt(std::max(0.0f, 1.0f - sumSq));
+		for (int i = 0; i < 4; ++i)
+			s.quat[i] = c[i];
+
+		const float bias[3] = { 0.0f, 0.0f, kPosZBias };
+		for (int i = 0; i < 3; ++i)
+			s.pos[i] = q.pos[i] * kPosStep + bias[i];
+		return s;
+	}
+
+	// ---- encode / decode ----
+
+	// Budget order for Encode. Only one pose besides a moving right hand fits, and a pose that misses
+	// its turn costs more next time (its delta grows, or it needs an absolute update), so a fixed
+	// order starves the left hand and HMD. The two take turns (one every other command), and on even
+	// commands the one whose turn it is goes before the right hand, which the decoder then carries
+	// forward for that command. The right hand stays first while it is rightHandUrgent (firing /
+	// swinging) or missing from the reference (the first command of a usercmd packet).
+	static std::array<int, VRCmdPose_Count> PlanPriority(const VRCmdPayloadState& ref, int commandNumber, bool rightHandUrgent)
+	{
+		const bool hmdTurn = ((commandNumber >> 1) & 1) != 0;
+		const int preferred = hmdTurn ? VRCmdPose_Hmd : VRCmdPose_LeftHand;
+		const int other = hmdTurn ? VRCmdPose_LeftHand : VRCmdPose_Hmd;
+		if (!rightHandUrgent && (commandNumber & 1) == 0 && ref.valid[VRCmdPose_RightHand])
+			return { preferred, VRCmdPose_RightHand, other };
+		return { VRCmdPose_RightHand, preferred, other };
+	}
+
+	// ref: decoded state of the `from` command (empty if unknown). priority: slot order for handing out
+	// the bit budget; a slot that doesn't fit is dropped this command and carried forward by the decoder.
+	static VRCmdEncodeResult Encode(const VRCmdPoseSample (&poses)[VRCmdPose_Count], bool melee,
+		const VRCmdPayloadState& ref, const std::array<int, VRCmdPose_Count>& priority,
+		VRCmdPayloadState& outState, VRCmdCarrier& outCarrier)
+	{
+		VRCmdEncodeResult result;
+		outState = ref;
+
+		// Decide what each slot would cost; then grant budget in priority order.
+		struct SlotPlan
+		{
+			bool send = false;
+			bool unavailable = false;   // tell the decoder to drop its reference pose
+			bool absolute = false;
+			int cost = 0;   // mode bit + body; presence bits are budgeted up front
+			VRCmdQuantizedPose q;
+			int rotWidth = 0;
+			int posWidth = 0;
+		};
+		std::array<SlotPlan, VRCmdPose_Count> plan{};
+
+		int budget = kCapacityBits - kVersionBits - 1 - VRCmdPose_Count;
+		for (int slot = 0; slot < VRCmdPose_Count; ++slot)
+		{
+			SlotPlan& p = plan[slot];
+			bool inRange = true;
+			if (poses[slot].valid)
+			{
+				p.q = Quantize(poses[slot], &inRange);
+				if (!inRange)
+					result.outOfRangeMask |= static_cast<uint8_t>(1u << slot);
+			}
+			if (!poses[slot].valid || !inRange)
+			{
+				// Nothing to say unless the decoder still holds a pose for this slot.
+				p.unavailable = ref.valid[slot];
+				p.cost = p.unavailable ? (1 + kUnavailablePoseBits) : 0;
+				continue;
+			}
+			if (ref.valid[slot] && ref.pose[slot] == p.q)
+				continue;
+
+			p.absolute = !ref.valid[slot] || !DeltaWidths(ref.pose[slot], p.q, p.rotWidth, p.posWidth);
+			p.cost = 1 + (p.absolute ? kAbsolutePoseBits
+				: (2 * kDeltaWidthBits + 3 * p.rotWidth + 3 * p.posWidth));
+		}
+
+		for (int i = 0; i < VRCmdPose_Count; ++i)
+		{
+			const int slot = priority[i];
+			if (slot < 0 || slot >= VRCmdPose_Count)
+				continue;
+			SlotPlan& p = plan[slot];
+			if (p.cost == 0)
+				continue;
+			if (p.cost > budget)
+			{
+				result.droppedMask |= static_cast<uint8_t>(1u << slot);
+				continue;
+			}
+			budget -= p.cost;
+			p.send = true;
+		}
+
+		BitWriter w;
+		w.Write(static_cast<uint32_t>(kVersion), kVersionBits);
+		w.Write(melee ? 1u : 0u, 1);
+		for (int slot = 0; slot < VRCmdPose_Count; ++slot)
+		{
+			const SlotPlan& p = plan[slot];
+			w.Write(p.send ? 1u : 0u, 1);
+			if (!p.send)
+				continue;
+
+			w.Write(p.absolute ? 1u : 0u, 1);
+			if (p.unavailable)
+			{
+				w.Write(0u, kUnavailablePoseBits);
+				outState.valid[slot] = false;
+				outState.pose[slot] = VRCmdQuantizedPose{};
+				result.sentMask |= static_cast<uint8_t>(1u << slot);
+				continue;
+			}
+			if (p.absolute)
+			{
+				w.Write(p.q.largest, 2);
+				for (int i = 0; i < 3; ++i)
+					w.WriteSigned(p.q.rot[i], kRotBits);
+				for (int i = 0; i < 3; ++i)
+					w.WriteSigned(p.q.pos[i], kPosBits);
+			}
+			else
+			{
+				const VRCmdQuantizedPose& r = ref.pose[slot];
+				w.Write(static_cast<uint32_t>(p.rotWidth), kDeltaWidthBits);
+				w.Write(static_cast<uint32_t>(p.posWidth), kDeltaWidthBits);
+				for (int i = 0; i < 3; ++i)
+					w.WriteSigned(p.q.rot[i] - r.rot[i], p.rotWidth);
+				for (int i = 0; i < 3; ++i)
+					w.WriteSigned(p.q.pos[i] - r.pos[i], p.posWidth);
+			}
+
+			outState.valid[slot] = true;
+			outState.pose[slot] = p.q;
+			result.sentMask |= static_cast<uint8_t>(1u << slot);
+		}
+
+		result.bitsUsed = w.BitCount();
+		outCarrier = ToCarrier(w);
+		return result;
+	}
+
+	// False if the carrier isn't a version-2 payload (e.g. a legacy client); outputs are untouched then.
+	static bool Decode(const VRCmdCarrier& carrier, const VRCmdPayloadState& ref,
+		bool& outMelee, VRCmdPayloadState& outState, uint8_t* outUpdatedMask = nullptr)
+	{
+		if (!IsFloatCarrier(carrier.viewZBits) || !IsFloatCarrier(carrier.upmoveBits))
+			return false;
+
+		BitReader r(carrier);
+		if (r.Read(kVersionBits) != static_cast<uint32_t>(kVersion))
+			return false;
+
+		VRCmdPayloadState state = ref;
+		uint8_t updated = 0;
+		const bool melee = r.Read(1) != 0;
+		for (int slot = 0; slot < VRCmdPose_Count; ++slot)
+		{
+			if (!r.Read(1))
+				continue;
+
+			VRCmdQuantizedPose q;
+			if (r.Read(1))
+			{
+				q.largest = static_cast<uint8_t>(r.Read(2));
+				for (int i = 0; i < 3; ++i)
+					q.rot[i] = static_cast<int16_t>(r.ReadSigned(kRotBits));
+				for (int i = 0; i < 3; ++i)
+					q.pos[i] = static_cast<int16_t>(r.ReadSigned(kPosBits));
+			}
+			else
+			{
+				const int rotWidth = static_cast<int>(r.Read(kDeltaWidthBits));
+				const int posWidth = static_cast<int>(r.Read(kDeltaWidthBits));
+				if (rotWidth == 0 && posWidth == 0)
+				{
+					state.valid[slot] = false;
+					state.pose[slot] = VRCmdQuantizedPose{};
+					updated |= static_cast<uint8_t>(1u << slot);
+					continue;
+				}
+				// A delta against a pose we don't have means the reference chain broke.
+				if (!ref.valid[slot])
+					return false;
+				q = ref.pose[slot];
+				for (int i = 0; i < 3; ++i)
+					q.rot[i] = static_cast<int16_t>(q.rot[i] + r.ReadSigned(rotWidth));
+				for (int i = 0; i < 3; ++i)
+					q.pos[i] = static_cast<int16_t>(q.pos[i] + r.ReadSigned(posWidth));
+			}
+
+			state.valid[slot] = true;
+			state.pose[slot] = q;
+			updated |= static_cast<uint8_t>(1u << slot);
+		}
+
+		if (r.Overrun())
+			return false;
+
+		outMelee = melee;
+		outState = state;
+		if (outUpdatedMask)
+			*outUpdatedMask = updated;
+		return true;
+	}
+
+	// ---- Source Euler <-> quaternion (mathlib AngleQuaternion / QuaternionAngles) ----
+
+	static void AnglesToQuat(float pitch, float yaw, float roll, float outQuat[4])
+	{
+		const float dr = 3.14159265358979f / 180.0f * 0.5f;
+		const float sp = std::sin(pitch * dr), cp = std::cos(pitch * dr);
+		const float sy = std::sin(yaw * dr), cy = std::cos(yaw * dr);
+		const float sr = std::sin(roll * dr), cr = std::cos(roll * dr);
+
+		const float srXcp = sr * cp, crXsp = cr * sp;
+		outQuat[0] = srXcp * cy - crXsp * sy;
+		outQuat[1] = crXsp * cy + srXcp * sy;
+		const float crXcp = cr * cp, srXsp = sr * sp;
+		outQuat[2] = crXcp * sy - srXsp * cy;
+		outQuat[3] = crXcp * cy + srXsp * sy;
+	}
+
+	static void QuatToAngles(const float q[4], float& outPitch, float& outYaw, float& outRoll)
+	{
+		const float x = q[0], y = q[1], z = q[2], w = q[3];
+		const float fwd0 = 1.0f - 2.0f * y * y - 2.0f * z * z;
+		const float fwd1 = 2.0f * x * y + 2.0f * w * z;
+		const float fwd2 = 2.0f * x * z - 2.0f * w * y;
+		const float left0 = 2.0f * x * y - 2.0f * w * z;
+		const float left1 = 1.0f - 2.0f * x * x - 2.0f * z * z;
+		const float left2 = 2.0f * y * z + 2.0f * w * x;
+		const float up2 = 1.0f - 2.0f * x * x - 2.0f * y * y;
+
+		const float rd = 180.0f / 3.14159265358979f;
+		const float xyDist = std::sqrt(fwd0 * fwd0 + fwd1 * fwd1);
+		outPitch = std::atan2(-fwd2, xyDist) * rd;
+		if (xyDist > 0.001f)
+		{
+			outYaw = std::atan2(fwd1, fwd0) * rd;
+			outRoll = std::atan2(left2, up2) * rd;
+		}
+		else
+		{
+			outYaw = std::atan2(-left0, left1) * rd;
+			outRoll = 0.0f;
+		}
+	}
+
+	static bool IsFloatCarrier(uint32_t bits) { return (bits & 0xE0000000u) == 0x20000000u; }
+
+	// Cheap format check (carrier pattern + version), without needing the reference state.
+	static bool IsPayload(const VRCmdCarrier& carrier)
+	{
+		if (!IsFloatCarrier(carrier.viewZBits) || !IsFloatCarrier(carrier.upmoveBits))
+			return false;
+		BitReader r(carrier);
+		return r.Read(kVersionBits) == static_cast<uint32_t>(kVersion);
+	}
+
+private:
+	static constexpr float kSqrt2 = 1.41421356f;
+	static constexpr int kPosMin = -(1 << (kPosBits - 1));
+	static constexpr int kPosMax = (1 << (kPosBits - 1)) - 1;
+
+	static int Clamp(int v, int lo, int hi) { return std::min(std::max(v, lo), hi); }
+
+	// Bits needed to store v as two's complement (0 for v == 0).
+	static int SignedWidth(int v)
+	{
+		if (v == 0)
+			return 0;
+		int width = 1;
+		while (v < -(1 << (width - 1)) || v > (1 << (width - 1)) - 1)
+			++width;
+		return width;
+	}
+
+	static bool DeltaWidths(const VRCmdQuantizedPose& from, const VRCmdQuantizedPose& to, int& rotWidth, int& posWidth)
+	{
+		if (from.largest != to.largest)
+			return false;
+		rotWidth = 0;
+		posWidth = 0;
+		for (int i = 0; i < 3; ++i)
+		{
+			rotWidth = std::max(rotWidth, SignedWidth(to.rot[i] - from.rot[i]));
+			posWidth = std::max(posWidth, SignedWidth(to.pos[i] - from.pos[i]));
+		}
+		const int maxWidth = (1 << kDeltaWidthBits) - 1;
+		if (rotWidth > maxWidth || posWidth > maxWidth)
+			return false;
+		// Not worth it if the delta is as large as the absolute encoding.
+		return 2 * kDeltaWidthBits + 3 * rotWidth + 3 * posWidth < kAbsolutePoseBits;
+	}
+
+	class BitWriter
+	{
+	public:
+		void Write(uint32_t value, int bits)
+		{
+			for (int i = 0; i < bits; ++i, ++m_Pos)
+			{
+				if (m_Pos >= kCapacityBits)
+					continue;
+				if (value & (1u << i))
+					m_Words[m_Pos >> 5] |= (1u << (m_Pos & 31));
+			}
+		}
+		void WriteSigned(int value, int bits)
+		{
+			if (bits > 0)
+				Write(static_cast<uint32_t>(value) & ((bits >= 32) ? 0xFFFFFFFFu : ((1u << bits) - 1u)), bits);
+		}
+		int BitCount() const { return m_Pos; }
+		bool GetBit(int pos) const { return (m_Words[pos >> 5] >> (pos & 31)) & 1u; }
+
+	private:
+		std::array<uint32_t, (kCapacityBits + 31) / 32> m_Words{};
+		int m_Pos = 0;
+	};
+
+	class BitReader
+	{
+	public:
+		explicit BitReader(const VRCmdCarrier& c)
+		{
+			uint32_t mx = static_cast<uint16_t>(c.mouseDx);
+			uint32_t my = static_cast<uint16_t>(c.mouseDy);
+			Append(c.viewZBits, kFloatCarrierBits);
+			Append(c.upmoveBits, kFloatCarrierBits);
+			Append(mx, 16);
+			Append(my, 16);
+		}
+		uint32_t Read(int bits)
+		{
+			uint32_t v = 0;
+			for (int i = 0; i < bits; ++i, ++m_Pos)
+			{
+				if (m_Pos >= kCapacityBits)
+				{
+					m_Overrun = true;
+					continue;
+				}
+				if ((m_Words[m_Pos >> 5] >> (m_Pos & 31)) & 1u)
+					v |= (1u << i);
+			}
+			return v;
+		}
+		int ReadSigned(int bits)
+		{
+			if (bits <= 0)
+				return 0;
+			const uint32_t v = Read(bits);
+			const uint32_t signBit = 1u << (bits - 1);
+			return static_cast<int>((v ^ signBit)) - static_cast<int>(signBit);
+		}
+		bool Overrun() const { return m_Overrun; }
+
+	private:
+		void Append(uint32_t value, int bits)
+		{
+			for (int i = 0; i < bits; ++i, ++m_Fill)
+			{
+				if (value & (1u << i))
+					m_Words[m_Fill >> 5] |= (1u << (m_Fill & 31));
+			}
+		}
+		std::array<uint32_t, (kCapacityBits + 31) / 32> m_Words{};
+		int m_Fill = 0;
+		int m_Pos = 0;
+		bool m_Overrun = false;
+	};
+
+	static VRCmdCarrier ToCarrier(const BitWriter& w)
+	{
+		auto take = [&](int start, int bits)
+			{
+				uint32_t v = 0;
+				for (int i = 0; i < bits; ++i)
+				{
+					if (w.GetBit(start + i))
+						v |= (1u << i);
+				}
+				return v;
+			};
+		VRCmdCarrier c;
+		// Bit 29 set, bits 30/31 clear: a positive normal float in [2^-63, 2), never 0 / NaN / denormal.
+		c.viewZBits = 0x20000000u | take(0, kFloatCarrierBits);
+		c.upmoveBits = 0x20000000u | take(kFloatCarrierBits, kFloatCarrierBits);
+		c.mouseDx = static_cast<int16_t>(static_cast<uint16_t>(take(kFloatCarrierBits * 2, 16)));
+		c.mouseDy = static_cast<int16_t>(static_cast<uint16_t>(take(kFloatCarrierBits * 2 + 16, 16)));
+		return c;
+	}
+};
+
+// Decoded payload states by command number. Deltas reference the `from` command of the same
+// usercmd packet, which both ends have just encoded / decoded.
+template <size_t N = 64>
+class VRCmdPayloadHistory
+{
+public:
+	void Store(int commandNumber, const VRCmdPayloadState& state)
+	{
+		Entry& e = m_Entries[Index(commandNumber)];
+		e.commandNumber = commandNumber;
+		e.used = true;
+		e.state = state;
+	}
+
+	// nullptr if the command isn't known (or is the engine's null command 0).
+	const VRCmdPayloadState* Find(int commandNumber) const
+	{
+		if (commandNumber <= 0)
+			return nullptr;
+		const Entry& e = m_Entries[Index(commandNumber)];
+		return (e.used && e.commandNumber == commandNumber) ? &e.state : nullptr;
+	}
+
+	void Clear() { m_Entries.fill(Entry{}); }
+
+private:
+	struct Entry
+	{
+		int commandNumber = 0;
+		bool used = false;
+		VRCmdPayloadState state{};
+	};
+
+	static size_t Index(int commandNumber) { return static_cast<uint32_t>(commandNumber) % N; }
+
+	std::array<Entry, N> m_Entries{};
+};
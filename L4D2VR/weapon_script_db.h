@@ -0,0 +1,330 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "keyvalues_document.h"
+
+// ------------------------------------------------------------
+// Effective-attack-range weapon data: weapon script parsing and an on-disk cache.
+//
+// The aim path used to read ~20 weapon scripts (loose files, VPKs, workshop VPKs) synchronously the
+// first time an aim line was drawn, and re-tokenized each script once per key. Now the VR side loads
+// them on a background thread at map load and hands the finished table over; this header holds the
+// parts with no engine / Windows dependencies:
+//  - ParseRangeData: the range keys from a script parsed once (keyvalues_document.h),
+//  - Fingerprint: identity of the inputs (every candidate source path with its mtime and size),
+//  - SaveCache / LoadCache: the parsed table as a small binary file, valid only for the fingerprint
+//    it was written with, so an unchanged install never reads a VPK again,
+//  - LoadOrBuild: the loader's choice between the two, with script reading left to the caller.
+// ------------------------------------------------------------
+
+struct WeaponRangeData
+{
+	bool valid = false;
+	float minDuckingSpread = 0.0f;
+	float minStandingSpread = 0.0f;
+	float minInAirSpread = 0.0f;
+	float maxMovementSpread = 0.0f;
+	float pelletScatterPitch = 0.0f;
+	float pelletScatterYaw = 0.0f;
+	float range = 8192.0f;
+	float maxPlayerSpeed = 250.0f;
+	float damage = 0.0f;            // per bullet; 0 = unknown
+	int bullets = 1;
+	std::string source;
+};
+
+// A file the table was (or could have been) built from.
+struct WeaponScriptStamp
+{
+	std::string path;
+	uint64_t writeTime = 0;
+	uint64_t size = 0;
+};
+
+struct WeaponScriptCacheEntry
+{
+	uint16_t slot = 0;          // weapon id
+	WeaponRangeData data;
+};
+
+class WeaponScriptDb
+{
+public:
+	static constexpr uint32_t kCacheMagic = 0x57565234u;   // "4RVW"
+	static constexpr uint32_t kCacheVersion = 2;
+
+	// Reads the range keys from a parsed weapon script. Each key is looked up anywhere in the file
+	// (first occurrence wins, case-insensitive); false if it has none of the spread keys.
+	static bool ParseRangeData(const KeyValuesDocument& doc, WeaponRangeData& out)
+	{
+		enum Field { MinStanding, MinDucking, MinInAir, MaxMovement, PelletPitch, PelletYaw, Range, MaxSpeed, Damage, Bullets, FieldCount };
+		static const char* const kKeys[FieldCount] =
+		{
+			"MinStandingSpread", "MinDuckingSpread", "MinInAirSpread", "MaxMovementSpread",
+			"PelletScatterPitch", "PelletScatterYaw", "Range", "MaxPlayerSpeed", "Damage", "Bullets"
+		};
+
+		WeaponRangeData data{};
+		float* const targets[FieldCount] =
+		{
+			&data.minStandingSpread, &data.minDuckingSpread, &data.minInAirSpread, &data.maxMovementSpread,
+			&data.pelletScatterPitch, &data.pelletScatterYaw, &data.range, &data.maxPlayerSpeed, &data.damage, nullptr
+		};
+		bool parsed[FieldCount] = {};
+		float bulletsValue = 0.0f;
+		for (int f = 0; f < FieldCount; ++f)
+		{
+			float v = 0.0f;
+			if (!doc.GetFloat(doc.FindRecursive(KeyValuesDocument::kRoot, kKeys[f]), v))
+				continue;
+			parsed[f] = true;
+			if (targets[f])
+				*targets[f] = v;
+			else
+				bulletsValue = v;
+		}
+
+		if (parsed[Bullets])
+			data.bullets = static_cast<int>(std::lround(bulletsValue));
+		if (!parsed[MinStanding] && !parsed[MinDucking] && !parsed[MinInAir])
+			return false;
+
+		if (data.minDuckingSpread <= 0.0f)
+			data.minDuckingSpread = data.minStandingSpread;
+		if (data.minInAirSpread <= 0.0f)
+			data.minInAirSpread = data.minStandingSpread;
+		data.minStandingSpread = std::max(0.0f, data.minStandingSpread);
+		data.minDuckingSpread = std::max(0.0f, data.minDuckingSpread);
+		data.minInAirSpread = std::max(0.0f, data.minInAirSpread);
+		data.maxMovementSpread = std::max(0.0f, data.maxMovementSpread);
+		data.pelletScatterPitch = std::max(0.0f, data.pelletScatterPitch);
+		data.pelletScatterYaw = std::max(0.0f, data.pelletScatterYaw);
+		data.range = std::clamp(data.range, 1.0f, 65536.0f);
+		data.maxPlayerSpeed = std::clamp(data.maxPlayerSpeed, 1.0f, 1000.0f);
+		data.damage = std::clamp(data.damage, 0.0f, 10000.0f);
+		data.bullets = std::max(1, data.bullets);
+		data.valid = true;
+		out = data;
+		return true;
+	}
+
+	static bool ParseRangeData(const char* text, size_t length, WeaponRangeData& out)
+	{
+		KeyValuesDocument doc;
+		doc.Parse(std::string_view(text ? text : "", text ? length : 0));
+		return ParseRangeData(doc, out);
+	}
+
+	// FNV-1a over every stamp, in order.
+	static uint64_t Fingerprint(const std::vector<WeaponScriptStamp>& stamps)
+	{
+		uint64_t h = 1469598103934665603ull;
+		auto mix = [&](const void* p, size_t n)
+			{
+				const unsigned char* b = static_cast<const unsigned char*>(p);
+				for (size_t i = 0; i < n; ++i)
+				{
+					h ^= b[i];
+					h *= 1099511628211ull;
+				}
+			};
+		const uint32_t version = kCacheVersion;
+		mix(&version, sizeof(version));
+		for (const WeaponScriptStamp& s : stamps)
+		{
+			const uint32_t len = static_cast<uint32_t>(s.path.size());
+			mix(&len, sizeof(len));
+			mix(s.path.data(), s.path.size());
+			mix(&s.writeTime, sizeof(s.writeTime));
+			mix(&s.size, sizeof(s.size));
+		}
+		return h;
+	}
+
+	// Writes path.tmp and swaps it in, so a crash mid-write never leaves a torn cache behind.
+	static bool SaveCache(const std::string& path, uint64_t fingerprint, const std::vector<WeaponScriptCacheEntry>& entries)
+	{
+		std::string blob;
+		Put(blob, kCacheMagic);
+		Put(blob, kCacheVersion);
+		Put(blob, fingerprint);
+		Put(blob, static_cast<uint32_t>(entries.size()));
+		for (const WeaponScriptCacheEntry& e : entries)
+		{
+			const WeaponRangeData& d = e.data;
+			Put(blob, e.slot);
+			Put(blob, static_cast<uint8_t>(d.valid ? 1 : 0));
+			const float floats[9] = { d.minDuckingSpread, d.minStandingSpread, d.minInAirSpread, d.maxMovementSpread,
+				d.pelletScatterPitch, d.pelletScatterYaw, d.range, d.maxPlayerSpeed, d.damage };
+			for (float f : floats)
+				Put(blob, f);
+			Put(blob, static_cast<int32_t>(d.bullets));
+			const uint16_t sourceLen = static_cast<uint16_t>(std::min<size_t>(d.source.size(), 0xFFFF));
+			Put(blob, sourceLen);
+			blob.append(d.source.data(), sourceLen);
+		}
+		Put(blob, Checksum(blob.data(), blob.size()));
+
+		const std::string tmp = path + ".tmp";
+		FILE* f = std::fopen(tmp.c_str(), "wb");
+		if (!f)
+			return false;
+		const bool written = std::fwrite(blob.data(), 1, blob.size(), f) == blob.size();
+		const bool closed = std::fclose(f) == 0;
+		if (!written || !closed)
+		{
+			std::remove(tmp.c_str());
+			return false;
+		}
+		// rename() won't replace an existing file on Windows.
+		std::remove(path.c_str());
+		if (std::rename(tmp.c_str(), path.c_str()) != 0)
+		{
+			std::remove(tmp.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	// False (and out untouched) if the file is missing, damaged, from another version or was written
+	// for a different fingerprint.
+	static bool LoadCache(const std::string& path, uint64_t fingerprint, std::vector<WeaponScriptCacheEntry>& out)
+	{
+		FILE* f = std::fopen(path.c_str(), "rb");
+		if (!f)
+			return false;
+		std::string blob;
+		char buffer[4096];
+		size_t n = 0;
+		while ((n = std::fread(buffer, 1, sizeof(buffer), f)) > 0 && blob.size() < (1u << 20))
+			blob.append(buffer, n);
+		std::fclose(f);
+
+		if (blob.size() < sizeof(uint32_t) * 4 + sizeof(uint64_t))
+			return false;
+		const size_t payload = blob.size() - sizeof(uint32_t);
+		uint32_t storedSum = 0;
+		std::memcpy(&storedSum, blob.data() + payload, sizeof(storedSum));
+		if (storedSum != Checksum(blob.data(), payload))
+			return false;
+
+		size_t pos = 0;
+		uint32_t magic = 0, version = 0, count = 0;
+		uint64_t storedFingerprint = 0;
+		if (!Get(blob, payload, pos, magic) || magic != kCacheMagic
+			|| !Get(blob, payload, pos, version) || version != kCacheVersion
+			|| !Get(blob, payload, pos, storedFingerprint) || storedFingerprint != fingerprint
+			|| !Get(blob, payload, pos, count) || count > 1024)
+		{
+			return false;
+		}
+
+		std::vector<WeaponScriptCacheEntry> entries(count);
+		for (WeaponScriptCacheEntry& e : entries)
+		{
+			WeaponRangeData& d = e.data;
+			uint8_t valid = 0;
+			float floats[9] = {};
+			int32_t bullets = 1;
+			uint16_t sourceLen = 0;
+			if (!Get(blob, payload, pos, e.slot) || !Get(blob, payload, pos, valid))
+				return false;
+			for (float& v : floats)
+			{
+				if (!Get(blob, payload, pos, v) || !std::isfinite(v))
+					return false;
+			}
+			if (!Get(blob, payload, pos, bullets) || !Get(blob, payload, pos, sourceLen) || payload - pos < sourceLen)
+				return false;
+			d.valid = valid != 0;
+			d.minDuckingSpread = floats[0];
+			d.minStandingSpread = floats[1];
+			d.minInAirSpread = floats[2];
+			d.maxMovementSpread = floats[3];
+			d.pelletScatterPitch = floats[4];
+			d.pelletScatterYaw = floats[5];
+			d.range = floats[6];
+			d.maxPlayerSpeed = floats[7];
+			d.damage = floats[8];
+			d.bullets = bullets;
+			d.source.assign(blob.data() + pos, sourceLen);
+			pos += sourceLen;
+		}
+		if (pos != payload)
+			return false;
+		out = std::move(entries);
+		return true;
+	}
+
+	// One weapon script the table is built from, and the weapon id it fills.
+	struct ScriptSlot
+	{
+		uint16_t slot;
+		const char* path;
+	};
+
+	// The weapon data loader's cache-or-parse step: the cached table if the cache matches fingerprint,
+	// otherwise every script read through readScript(path, text, source), parsed, and the cache
+	// rewritten. Without stamps the cache is neither trusted nor written. Slots at or past slotLimit
+	// are skipped. True if the entries came from the cache.
+	template <typename ReadScript>
+	static bool LoadOrBuild(const std::string& cachePath, bool haveStamps, uint64_t fingerprint, const ScriptSlot* scripts, size_t scriptCount,
+		size_t slotLimit, ReadScript&& readScript, std::vector<WeaponScriptCacheEntry>& entries)
+	{
+		entries.clear();
+		if (haveStamps && LoadCache(cachePath, fingerprint, entries))
+			return true;
+
+		std::string text;
+		std::string source;
+		for (size_t i = 0; i < scriptCount; ++i)
+		{
+			if (scripts[i].slot >= slotLimit)
+				continue;
+			WeaponRangeData data{};
+			source.clear();
+			if (readScript(scripts[i].path, text, source) && ParseRangeData(text.data(), text.size(), data))
+			{
+				data.source = source.empty() ? scripts[i].path : source;
+				entries.push_back({ scripts[i].slot, data });
+			}
+		}
+		if (haveStamps && !entries.empty())
+			SaveCache(cachePath, fingerprint, entries);
+		return false;
+	}
+
+private:
+	static uint32_t Checksum(const char* data, size_t n)
+	{
+		uint32_t h = 2166136261u;
+		for (size_t i = 0; i < n; ++i)
+		{
+			h ^= static_cast<unsigned char>(data[i]);
+			h *= 16777619u;
+		}
+		return h;
+	}
+
+	template <typename T>
+	static void Put(std::string& blob, const T& value)
+	{
+		blob.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	static bool Get(const std::string& blob, size_t limit, size_t& pos, T& value)
+	{
+		if (limit - pos < sizeof(T) || pos > limit)
+			return false;
+		std::memcpy(&value, blob.data() + pos, sizeof(T));
+		pos += sizeof(T);
+		return true;
+	}
+};
@@ -9144,9 +9144,14 @@ namespace dxvk {
             return;
 
         uint32_t threshold = (m_d3d9Options.textureMemory / 4) * 3;
+        TrimMappedTextures(threshold);
+#endif
+    }
 
+    uint32_t D3D9DeviceEx::TrimMappedTextures(uint32_t TargetBytes) {
+#ifdef D3D9_ALLOW_UNMAPPING
         auto iter = m_mappedTextures.leastRecentlyUsedIter();
-        while (m_memoryAllocator.MappedMemory() >= threshold && iter != m_mappedTextures.leastRecentlyUsedEndIter()) {
+        while (m_memoryAllocator.MappedMemory() >= TargetBytes && iter != m_mappedTextures.leastRecentlyUsedEndIter()) {
             if (unlikely((*iter)->IsAnySubresourceLocked() != 0)) {
                 iter++;
                 continue;
@@ -9155,6 +9160,9 @@ namespace dxvk {
 
             iter = m_mappedTextures.remove(iter);
         }
+        return m_memoryAllocator.MappedMemory();
+#else
+        return 0;
 #endif
     }
 
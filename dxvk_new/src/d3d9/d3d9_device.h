@@ -1066,6 +1066,13 @@ namespace dxvk {
       return &m_memoryAllocator;
     }
 
+    /**
+     * \brief Unmaps least recently used textures until less than \p TargetBytes of texture memory stays mapped.
+     * Used by the VR layer to release address space under pressure. Has to be called inside the device lock.
+     * \returns Texture memory still mapped afterwards
+     */
+    uint32_t TrimMappedTextures(uint32_t TargetBytes);
+
     /**
      * \brief Gets the pointer of the system memory copy of the texture
      *
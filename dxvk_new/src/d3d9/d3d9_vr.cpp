@@ -14,7 +14,7 @@
 
 namespace dxvk {
 
-  class D3D9VR final : public ComObjectClamp<IDirect3DVR9> {
+  class D3D9VR final : public ComObjectClamp<IDirect3DVR9_1> {
 
   public:
 
@@ -31,7 +31,8 @@ namespace dxvk {
       *ppvObject = nullptr;
 
       if (riid == __uuidof(IUnknown)
-       || riid == __uuidof(IDirect3DVR9)) {
+       || riid == __uuidof(IDirect3DVR9)
+       || riid == __uuidof(IDirect3DVR9_1)) {
         *ppvObject = ref(this);
         return S_OK;
       }
@@ -146,6 +147,28 @@ namespace dxvk {
       return res;
     }
 
+    HRESULT STDMETHODCALLTYPE TrimMappedMemory(UINT targetBytes, UINT* pMappedBytes) {
+      // Unmappable texture memory only exists on 32-bit; elsewhere nothing is mapped this way.
+      D3D9DeviceLock lock = m_device->LockDevice();
+      const uint32_t mapped = m_device->TrimMappedTextures(targetBytes);
+      if (pMappedBytes != nullptr)
+        *pMappedBytes = mapped;
+      return D3D_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE GetMappedMemory(UINT* pMappedBytes) {
+      if (unlikely(pMappedBytes == nullptr))
+        return D3DERR_INVALIDCALL;
+
+      // Same figure TrimMappedMemory reports; the allocator's counter is atomic, so no device lock.
+#ifdef D3D9_ALLOW_UNMAPPING
+      *pMappedBytes = m_device->GetAllocator()->MappedMemory();
+#else
+      *pMappedBytes = 0;
+#endif
+      return D3D_OK;
+    }
+
   private:
 
     D3D9DeviceEx* m_device;
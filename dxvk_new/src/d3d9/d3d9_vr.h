@@ -7,6 +7,7 @@
 #undef VK_USE_PLATFORM_WIN32_KHR
 
 class IDirect3DVR9;
+class IDirect3DVR9_1;
 class D3D9DeviceEx;
 class SharedTextureHolder;
 inline IDirect3DVR9* g_D3DVR9;
@@ -35,10 +36,32 @@ IDirect3DVR9 : public IUnknown {
   virtual HRESULT STDMETHODCALLTYPE GetBackBufferData(SharedTextureHolder* backBufferData) = 0;
 };
 
+/**
+ * \brief Mapped texture memory control for the VR layer's address space budget
+ *
+ * Added after IDirect3DVR9, so it has its own IID: query it from IDirect3DVR9 and
+ * carry on without trimming when a d3d9.dll doesn't know it.
+ */
+MIDL_INTERFACE("c6cf6dff-f67a-48ce-9033-8148b0f990d6")
+IDirect3DVR9_1 : public IDirect3DVR9 {
+  /**
+   * \brief Unmaps least recently used textures until less than \p targetBytes stay mapped
+   * \param [out] pMappedBytes Texture memory still mapped afterwards (optional)
+   */
+  virtual HRESULT STDMETHODCALLTYPE TrimMappedMemory(UINT targetBytes, UINT* pMappedBytes) = 0;
+
+  /**
+   * \brief Texture memory currently mapped, without unmapping anything
+   */
+  virtual HRESULT STDMETHODCALLTYPE GetMappedMemory(UINT* pMappedBytes) = 0;
+};
+
 #ifdef _MSC_VER
 struct __declspec(uuid("7e272b32-a49c-46c7-b1a4-ef52936bec87")) IDirect3DVR9;
+struct __declspec(uuid("c6cf6dff-f67a-48ce-9033-8148b0f990d6")) IDirect3DVR9_1;
 #else
 __CRT_UUID_DECL(IDirect3DVR9, 0x7e272b32, 0xa49c, 0x46c7, 0xb1, 0xa4, 0xef, 0x52, 0x93, 0x6b, 0xec, 0x87);
+__CRT_UUID_DECL(IDirect3DVR9_1, 0xc6cf6dff, 0xf67a, 0x48ce, 0x90, 0x33, 0x81, 0x48, 0xb0, 0xf9, 0x90, 0xd6);
 #endif
 
 HRESULT __stdcall Direct3DCreateVRImpl(IDirect3DDevice9* pDevice, IDirect3DVR9** pInterface);